@@ -40,6 +40,10 @@
 #include "hpipm/include/hpipm_d_dense_qp.h"
 #include "hpipm/include/hpipm_d_dense_qp_ipm.h"
 #include "hpipm/include/hpipm_d_dense_qp_sol.h"
+#include "hpipm/include/hpipm_s_dense_qp.h"
+#include "hpipm/include/hpipm_s_dense_qp_dim.h"
+#include "hpipm/include/hpipm_s_dense_qp_ipm.h"
+#include "hpipm/include/hpipm_s_dense_qp_sol.h"
 // acados
 #include "acados/dense_qp/dense_qp_common.h"
 #include "acados/dense_qp/dense_qp_hpipm.h"
@@ -61,6 +65,13 @@ int dense_qp_hpipm_opts_calculate_size(void *config_, void *dims_)
     size += sizeof(struct d_dense_qp_ipm_arg);
     size += d_dense_qp_ipm_arg_memsize(dims);
 
+    // mixed precision (the dims struct only holds ints, its layout is the same in both precisions)
+    size += sizeof(struct s_dense_qp_dim);
+    size += s_dense_qp_dim_memsize();
+    size += sizeof(struct s_dense_qp_ipm_arg);
+    size += s_dense_qp_ipm_arg_memsize((struct s_dense_qp_dim *) dims);
+
+    size += 2 * 8;
     return size;
 }
 
@@ -84,7 +95,31 @@ void *dense_qp_hpipm_opts_assign(void *config_, void *dims_, void *raw_memory)
     d_dense_qp_ipm_arg_create(dims, opts->hpipm_opts, c_ptr);
     c_ptr += d_dense_qp_ipm_arg_memsize(dims);
 
-    assert((char *) raw_memory + dense_qp_hpipm_opts_calculate_size(config_, dims) == c_ptr);
+    // mixed precision: single precision copy of the dims
+    opts->s_dims = (struct s_dense_qp_dim *) c_ptr;
+    c_ptr += sizeof(struct s_dense_qp_dim);
+
+    align_char_to(8, &c_ptr);
+
+    s_dense_qp_dim_create(opts->s_dims, c_ptr);
+    c_ptr += s_dense_qp_dim_memsize();
+
+    s_dense_qp_dim_set("nv", dims->nv, opts->s_dims);
+    s_dense_qp_dim_set("ne", dims->ne, opts->s_dims);
+    s_dense_qp_dim_set("nb", dims->nb, opts->s_dims);
+    s_dense_qp_dim_set("ng", dims->ng, opts->s_dims);
+    s_dense_qp_dim_set("nsb", dims->nsb, opts->s_dims);
+    s_dense_qp_dim_set("nsg", dims->nsg, opts->s_dims);
+
+    opts->s_hpipm_opts = (struct s_dense_qp_ipm_arg *) c_ptr;
+    c_ptr += sizeof(struct s_dense_qp_ipm_arg);
+
+    align_char_to(8, &c_ptr);
+
+    s_dense_qp_ipm_arg_create(opts->s_dims, opts->s_hpipm_opts, c_ptr);
+    c_ptr += s_dense_qp_ipm_arg_memsize(opts->s_dims);
+
+    assert((char *) raw_memory + dense_qp_hpipm_opts_calculate_size(config_, dims) >= c_ptr);
 
     return (void *) opts;
 }
@@ -107,6 +142,15 @@ void dense_qp_hpipm_opts_initialize_default(void *config_, void *dims_, void *op
     opts->hpipm_opts->alpha_min = 1e-8;
     opts->hpipm_opts->mu0 = 1e0;
 
+    // mixed precision: residual tolerances of the single precision ipm are limited by its
+    // accuracy, the remaining ones are taken from the double precision options at each call
+    opts->mixed_precision = 0;
+    opts->itref_max = 5;
+    s_dense_qp_ipm_arg_set_default(BALANCE, opts->s_hpipm_opts);
+    opts->s_hpipm_opts->res_g_max = 1e-4;
+    opts->s_hpipm_opts->res_b_max = 1e-4;
+    opts->s_hpipm_opts->res_d_max = 1e-4;
+
     return;
 }
 
@@ -125,7 +169,20 @@ void dense_qp_hpipm_opts_set(void *config_, void *opts_, const char *field, void
 {
     dense_qp_hpipm_opts *opts = opts_;
 
-	d_dense_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+	if (!strcmp(field, "mixed_precision"))
+	{
+		int *tmp_ptr = value;
+		opts->mixed_precision = *tmp_ptr;
+	}
+	else if (!strcmp(field, "mixed_precision_itref_max"))
+	{
+		int *tmp_ptr = value;
+		opts->itref_max = *tmp_ptr;
+	}
+	else
+	{
+		d_dense_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+	}
 
 	return;
 }
@@ -147,6 +204,16 @@ int dense_qp_hpipm_memory_calculate_size(void *config_, void *dims_, void *opts_
 
     size += d_dense_qp_ipm_ws_memsize(dims, opts->hpipm_opts);
 
+    if (opts->mixed_precision)
+    {
+        size += sizeof(struct s_dense_qp) + s_dense_qp_memsize(opts->s_dims);
+        size += sizeof(struct s_dense_qp_sol) + s_dense_qp_sol_memsize(opts->s_dims);
+        size += sizeof(struct s_dense_qp_ipm_ws) + s_dense_qp_ipm_ws_memsize(opts->s_dims, opts->s_hpipm_opts);
+        size += dense_qp_res_calculate_size(dims);
+        size += dense_qp_res_workspace_calculate_size(dims);
+        size += 5 * 8;
+    }
+
     return size;
 }
 
@@ -174,7 +241,42 @@ void *dense_qp_hpipm_memory_assign(void *config_, void *dims_, void *opts_, void
     d_dense_qp_ipm_ws_create(dims, opts->hpipm_opts, ipm_workspace, c_ptr);
     c_ptr += ipm_workspace->memsize;
 
-    assert((char *) raw_memory + dense_qp_hpipm_memory_calculate_size(config_, dims, opts) == c_ptr);
+    mem->mixed_precision = opts->mixed_precision;
+    mem->last_mixed = 0;
+    mem->fallbacks = 0;
+
+    if (opts->mixed_precision)
+    {
+        // single precision qp, solution and ipm workspace
+        mem->s_qp_in = (struct s_dense_qp *) c_ptr;
+        c_ptr += sizeof(struct s_dense_qp);
+        align_char_to(8, &c_ptr);
+        s_dense_qp_create(opts->s_dims, mem->s_qp_in, c_ptr);
+        c_ptr += s_dense_qp_memsize(opts->s_dims);
+
+        mem->s_qp_out = (struct s_dense_qp_sol *) c_ptr;
+        c_ptr += sizeof(struct s_dense_qp_sol);
+        align_char_to(8, &c_ptr);
+        s_dense_qp_sol_create(opts->s_dims, mem->s_qp_out, c_ptr);
+        c_ptr += s_dense_qp_sol_memsize(opts->s_dims);
+
+        mem->s_hpipm_workspace = (struct s_dense_qp_ipm_ws *) c_ptr;
+        c_ptr += sizeof(struct s_dense_qp_ipm_ws);
+        align_char_to(8, &c_ptr);
+        s_dense_qp_ipm_ws_create(opts->s_dims, opts->s_hpipm_opts, mem->s_hpipm_workspace, c_ptr);
+        c_ptr += mem->s_hpipm_workspace->memsize;
+
+        // double precision residuals for the iterative refinement
+        align_char_to(8, &c_ptr);
+        mem->qp_res = dense_qp_res_assign(dims, c_ptr);
+        c_ptr += dense_qp_res_calculate_size(dims);
+
+        align_char_to(8, &c_ptr);
+        mem->qp_res_ws = dense_qp_res_workspace_assign(dims, c_ptr);
+        c_ptr += dense_qp_res_workspace_calculate_size(dims);
+    }
+
+    assert((char *) raw_memory + dense_qp_hpipm_memory_calculate_size(config_, dims, opts) >= c_ptr);
 
     return mem;
 }
@@ -196,6 +298,11 @@ void dense_qp_hpipm_memory_get(void *config_, void *mem_, const char *field, voi
 		int *tmp_ptr = value;
 		*tmp_ptr = mem->iter;
 	}
+	else if (!strcmp(field, "mixed_precision_fallbacks"))
+	{
+		int *tmp_ptr = value;
+		*tmp_ptr = mem->fallbacks;
+	}
 	else
 	{
 		printf("\nerror: dense_qp_hpipm_memory_get: field %s not available\n", field);
@@ -219,6 +326,183 @@ int dense_qp_hpipm_workspace_calculate_size(void *config_, void *dims_, void *op
 
 
 
+/************************************************
+ * mixed precision
+ ************************************************/
+
+// copy qp data into the single precision qp
+static void dense_qp_hpipm_cvt_d2s_qp(dense_qp_in *qp_in, struct s_dense_qp *s_qp_in)
+{
+    int nv = qp_in->dim->nv;
+    int ne = qp_in->dim->ne;
+    int nb = qp_in->dim->nb;
+    int ng = qp_in->dim->ng;
+    int ns = qp_in->dim->ns;
+
+    int jj, kk;
+
+    for (jj = 0; jj < nv; jj++)
+        for (kk = jj; kk < nv; kk++)
+            BLASFEO_SMATEL(s_qp_in->Hv, kk, jj) = BLASFEO_DMATEL(qp_in->Hv, kk, jj);
+    for (jj = 0; jj < nv; jj++)
+        for (kk = 0; kk < ne; kk++)
+            BLASFEO_SMATEL(s_qp_in->A, kk, jj) = BLASFEO_DMATEL(qp_in->A, kk, jj);
+    for (jj = 0; jj < ng; jj++)
+        for (kk = 0; kk < nv; kk++)
+            BLASFEO_SMATEL(s_qp_in->Ct, kk, jj) = BLASFEO_DMATEL(qp_in->Ct, kk, jj);
+
+    for (jj = 0; jj < nv + 2 * ns; jj++)
+        BLASFEO_SVECEL(s_qp_in->gz, jj) = BLASFEO_DVECEL(qp_in->gz, jj);
+    for (jj = 0; jj < ne; jj++)
+        BLASFEO_SVECEL(s_qp_in->b, jj) = BLASFEO_DVECEL(qp_in->b, jj);
+    for (jj = 0; jj < 2 * nb + 2 * ng + 2 * ns; jj++)
+    {
+        BLASFEO_SVECEL(s_qp_in->d, jj) = BLASFEO_DVECEL(qp_in->d, jj);
+        BLASFEO_SVECEL(s_qp_in->m, jj) = BLASFEO_DVECEL(qp_in->m, jj);
+    }
+    for (jj = 0; jj < 2 * ns; jj++)
+        BLASFEO_SVECEL(s_qp_in->Z, jj) = BLASFEO_DVECEL(qp_in->Z, jj);
+
+    for (jj = 0; jj < nb; jj++)
+        s_qp_in->idxb[jj] = qp_in->idxb[jj];
+    for (jj = 0; jj < ns; jj++)
+        s_qp_in->idxs[jj] = qp_in->idxs[jj];
+
+    return;
+}
+
+
+
+// copy (add == 0) or add (add == 1) the single precision solution (or step) to qp_out
+static void dense_qp_hpipm_cvt_s2d_sol(struct s_dense_qp_sol *s_qp_out, dense_qp_out *qp_out, int add)
+{
+    int nv = qp_out->dim->nv;
+    int ne = qp_out->dim->ne;
+    int nb = qp_out->dim->nb;
+    int ng = qp_out->dim->ng;
+    int ns = qp_out->dim->ns;
+
+    double scale = add ? 1.0 : 0.0;
+
+    int jj;
+
+    for (jj = 0; jj < nv + 2 * ns; jj++)
+        BLASFEO_DVECEL(qp_out->v, jj) = scale * BLASFEO_DVECEL(qp_out->v, jj)
+                                        + BLASFEO_SVECEL(s_qp_out->v, jj);
+    for (jj = 0; jj < ne; jj++)
+        BLASFEO_DVECEL(qp_out->pi, jj) = scale * BLASFEO_DVECEL(qp_out->pi, jj)
+                                         + BLASFEO_SVECEL(s_qp_out->pi, jj);
+    for (jj = 0; jj < 2 * nb + 2 * ng + 2 * ns; jj++)
+    {
+        BLASFEO_DVECEL(qp_out->lam, jj) = scale * BLASFEO_DVECEL(qp_out->lam, jj)
+                                          + BLASFEO_SVECEL(s_qp_out->lam, jj);
+        BLASFEO_DVECEL(qp_out->t, jj) = scale * BLASFEO_DVECEL(qp_out->t, jj)
+                                        + BLASFEO_SVECEL(s_qp_out->t, jj);
+    }
+
+    return;
+}
+
+
+
+// copy the vectors of a (parametric) qp into the vectors of the single precision qp
+static void dense_qp_hpipm_cvt_d2s_rhs(struct blasfeo_dvec *g, struct blasfeo_dvec *b,
+                                       struct blasfeo_dvec *d, struct blasfeo_dvec *m,
+                                       struct s_dense_qp *s_qp_in)
+{
+    int nv = s_qp_in->dim->nv;
+    int ne = s_qp_in->dim->ne;
+    int nb = s_qp_in->dim->nb;
+    int ng = s_qp_in->dim->ng;
+    int ns = s_qp_in->dim->ns;
+
+    int jj;
+
+    for (jj = 0; jj < nv + 2 * ns; jj++)
+        BLASFEO_SVECEL(s_qp_in->gz, jj) = BLASFEO_DVECEL(g, jj);
+    for (jj = 0; jj < ne; jj++)
+        BLASFEO_SVECEL(s_qp_in->b, jj) = BLASFEO_DVECEL(b, jj);
+    for (jj = 0; jj < 2 * nb + 2 * ng + 2 * ns; jj++)
+    {
+        BLASFEO_SVECEL(s_qp_in->d, jj) = BLASFEO_DVECEL(d, jj);
+        BLASFEO_SVECEL(s_qp_in->m, jj) = BLASFEO_DVECEL(m, jj);
+    }
+
+    return;
+}
+
+
+
+static int dense_qp_hpipm_positive_lam_t(dense_qp_out *qp_out)
+{
+    int nc = 2 * qp_out->dim->nb + 2 * qp_out->dim->ng + 2 * qp_out->dim->ns;
+
+    for (int jj = 0; jj < nc; jj++)
+    {
+        if (BLASFEO_DVECEL(qp_out->lam, jj) <= 0.0 || BLASFEO_DVECEL(qp_out->t, jj) <= 0.0)
+            return 0;
+    }
+
+    return 1;
+}
+
+
+
+// ipm in single precision, then iterative refinement of the equality parts of the KKT system in
+// double precision, reusing the last single precision factorization (see ocp_qp_hpipm);
+// returns 1 if the double precision tolerances are met
+static int dense_qp_hpipm_mixed_precision(dense_qp_in *qp_in, dense_qp_out *qp_out,
+                                          dense_qp_hpipm_opts *opts, dense_qp_hpipm_memory *mem,
+                                          int *iter)
+{
+    struct d_dense_qp_ipm_arg *arg = opts->hpipm_opts;
+    struct s_dense_qp_ipm_arg *s_arg = opts->s_hpipm_opts;
+
+    s_arg->mu0 = arg->mu0;
+    s_arg->alpha_min = arg->alpha_min;
+    s_arg->res_m_max = arg->res_m_max;
+    s_arg->iter_max = arg->iter_max;
+    s_arg->stat_max = arg->stat_max;
+
+    dense_qp_hpipm_cvt_d2s_qp(qp_in, mem->s_qp_in);
+
+    int s_status;
+    s_dense_qp_ipm_solve(mem->s_qp_in, mem->s_qp_out, s_arg, mem->s_hpipm_workspace);
+    s_dense_qp_ipm_get_status(mem->s_hpipm_workspace, &s_status);
+    *iter = mem->s_hpipm_workspace->iter;
+
+    // no usable iterate (min step length or nan)
+    if (s_status != 0 && s_status != 1)
+        return 0;
+
+    dense_qp_hpipm_cvt_s2d_sol(mem->s_qp_out, qp_out, 0);
+
+    double res[4];
+    for (int kk = 0; ; kk++)
+    {
+        d_dense_qp_res_compute(qp_in, qp_out, mem->qp_res, mem->qp_res_ws);
+        dense_qp_res_compute_nrm_inf(mem->qp_res, res);
+
+        if (res[0] <= arg->res_g_max && res[1] <= arg->res_b_max &&
+            res[2] <= arg->res_d_max && res[3] <= arg->res_m_max)
+            return 1;
+
+        if (kk == opts->itref_max)
+            return 0;
+
+        dense_qp_hpipm_cvt_d2s_rhs(mem->qp_res->res_g, mem->qp_res->res_b, mem->qp_res->res_d,
+                                   mem->qp_res->res_m, mem->s_qp_in);
+        s_dense_qp_ipm_sens(mem->s_qp_in, mem->s_qp_out, s_arg, mem->s_hpipm_workspace);
+        dense_qp_hpipm_cvt_s2d_sol(mem->s_qp_out, qp_out, 1);
+        (*iter)++;
+
+        if (!dense_qp_hpipm_positive_lam_t(qp_out))
+            return 0;
+    }
+}
+
+
+
 /************************************************
  * functions
  ************************************************/
@@ -237,26 +521,46 @@ int dense_qp_hpipm(void *config, void *qp_in_, void *qp_out_, void *opts_, void
     dense_qp_hpipm_opts *opts = opts_;
     dense_qp_hpipm_memory *mem = mem_;
 
-	// zero primal solution
-	// TODO add a check if warm start of first SQP iteration is implemented !!!!!!
-	int nv = qp_in->dim->nv;
-	int ns = qp_in->dim->ns;
-	blasfeo_dvecse(nv+2*ns, 0.0, qp_out->v, 0);
+    int hpipm_status;
+    int iter = 0;
 
-    // solve ipm
     acados_tic(&qp_timer);
-    int hpipm_status;
-	d_dense_qp_ipm_solve(qp_in, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
-	d_dense_qp_ipm_get_status(mem->hpipm_workspace, &hpipm_status);
+
+    // mixed precision solve, with fallback to double precision
+    mem->last_mixed = 0;
+    if (opts->mixed_precision && mem->mixed_precision)
+    {
+        mem->last_mixed = dense_qp_hpipm_mixed_precision(qp_in, qp_out, opts, mem, &iter);
+        if (!mem->last_mixed)
+            mem->fallbacks++;
+    }
+
+    if (mem->last_mixed)
+    {
+        hpipm_status = 0;
+    }
+    else
+    {
+        // zero primal solution
+        // TODO add a check if warm start of first SQP iteration is implemented !!!!!!
+        int nv = qp_in->dim->nv;
+        int ns = qp_in->dim->ns;
+        blasfeo_dvecse(nv+2*ns, 0.0, qp_out->v, 0);
+
+        // solve ipm
+        d_dense_qp_ipm_solve(qp_in, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+        d_dense_qp_ipm_get_status(mem->hpipm_workspace, &hpipm_status);
+        iter += mem->hpipm_workspace->iter;
+    }
 
     info->solve_QP_time = acados_toc(&qp_timer);
     info->interface_time = 0;  // there are no conversions for hpipm
     info->total_time = acados_toc(&tot_timer);
-    info->num_iter = mem->hpipm_workspace->iter;
+    info->num_iter = iter;
     info->t_computed = 1;
 
 	mem->time_qp_solver_call = info->solve_QP_time;
-    mem->iter = mem->hpipm_workspace->iter;
+    mem->iter = iter;
 
     // check exit conditions
     int acados_status = hpipm_status;
@@ -286,7 +590,19 @@ void dense_qp_hpipm_eval_sens(void *config_, void *param_qp_in_, void *sens_qp_o
     // solve ipm
 //    acados_tic(&qp_timer);
     // print_ocp_qp_in(param_qp_in);
-	d_dense_qp_ipm_sens(param_qp_in, sens_qp_out, opts->hpipm_opts, memory->hpipm_workspace);
+	if (memory->last_mixed)
+	{
+		// last factorization is the single precision one
+		dense_qp_hpipm_cvt_d2s_rhs(param_qp_in->gz, param_qp_in->b, param_qp_in->d, param_qp_in->m,
+		                           memory->s_qp_in);
+		s_dense_qp_ipm_sens(memory->s_qp_in, memory->s_qp_out, opts->s_hpipm_opts,
+		                    memory->s_hpipm_workspace);
+		dense_qp_hpipm_cvt_s2d_sol(memory->s_qp_out, sens_qp_out, 0);
+	}
+	else
+	{
+		d_dense_qp_ipm_sens(param_qp_in, sens_qp_out, opts->hpipm_opts, memory->hpipm_workspace);
+	}
 
 //    info->solve_QP_time = acados_toc(&qp_timer);
 //    info->interface_time = 0;  // there are no conversions for hpipm
@@ -43,6 +43,10 @@ extern "C" {
 #include "hpipm/include/hpipm_d_dense_qp.h"
 #include "hpipm/include/hpipm_d_dense_qp_ipm.h"
 #include "hpipm/include/hpipm_d_dense_qp_sol.h"
+#include "hpipm/include/hpipm_s_dense_qp.h"
+#include "hpipm/include/hpipm_s_dense_qp_dim.h"
+#include "hpipm/include/hpipm_s_dense_qp_ipm.h"
+#include "hpipm/include/hpipm_s_dense_qp_sol.h"
 // acados
 #include "acados/dense_qp/dense_qp_common.h"
 #include "acados/utils/types.h"
@@ -52,6 +56,12 @@ extern "C" {
 typedef struct dense_qp_hpipm_opts_
 {
     struct d_dense_qp_ipm_arg *hpipm_opts;
+    // mixed precision: ipm in single precision, iterative refinement of the solution in double
+    // precision, fallback to the double precision ipm if the refinement does not converge
+    struct s_dense_qp_dim *s_dims;
+    struct s_dense_qp_ipm_arg *s_hpipm_opts;
+    int mixed_precision;  // 0: double precision ipm, 1: mixed precision
+    int itref_max;        // max number of iterative refinement steps in mixed precision
 } dense_qp_hpipm_opts;
 
 
@@ -61,6 +71,15 @@ typedef struct dense_qp_hpipm_memory_
     struct d_dense_qp_ipm_ws *hpipm_workspace;
 	double time_qp_solver_call;
 	int iter;
+	// mixed precision
+	struct s_dense_qp *s_qp_in;
+	struct s_dense_qp_sol *s_qp_out;
+	struct s_dense_qp_ipm_ws *s_hpipm_workspace;
+	dense_qp_res *qp_res;
+	dense_qp_res_ws *qp_res_ws;
+	int mixed_precision;  // mixed precision structures are allocated
+	int last_mixed;       // last solution from mixed precision (factorization in s_hpipm_workspace)
+	int fallbacks;        // number of mixed precision solves that fell back to double precision
 
 } dense_qp_hpipm_memory;
 
@@ -398,6 +398,31 @@ int dense_qp_qpoases_workspace_calculate_size(void *config_, dense_qp_dims *dims
  * functions
  ************************************************/
 
+// extract gradient and bounds of the dense qp (no slacks), used in hotstart with constant matrices
+static void dense_qp_qpoases_get_rhs(dense_qp_in *qp_in, double *g, double *d_lb, double *d_ub,
+                                     double *d_lg, double *d_ug)
+{
+    int nv = qp_in->dim->nv;
+    int nb = qp_in->dim->nb;
+    int ng = qp_in->dim->ng;
+
+    blasfeo_unpack_dvec(nv, qp_in->gz, 0, g);
+    blasfeo_unpack_dvec(nb, qp_in->d, 0, d_lb);
+    blasfeo_unpack_dvec(ng, qp_in->d, nb, d_lg);
+    blasfeo_unpack_dvec(nb, qp_in->d, nb+ng, d_ub);
+    blasfeo_unpack_dvec(ng, qp_in->d, 2*nb+ng, d_ug);
+
+    // upper bounds are stored with negative sign in dense_qp
+    for (int ii = 0; ii < nb; ii++)
+        d_ub[ii] = - d_ub[ii];
+    for (int ii = 0; ii < ng; ii++)
+        d_ug[ii] = - d_ug[ii];
+
+    return;
+}
+
+
+
 int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, void *opts_,
                      void *memory_, void *work_)
 {
@@ -457,12 +482,20 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
     int ng2 = (ns > 0) ? ng + nsb : ng;
     int nb2 = nb - nsb + 2 * ns;
 
-    // fill in the upper triangular of H in dense_qp
-    blasfeo_dtrtr_l(nv, qp_in->Hv, 0, 0, qp_in->Hv, 0, 0);
+    if (opts->hotstart == 1 && memory->first_it == 0 && ns == 0)
+    {
+        // data matrices are constant and already in qpOASES: extract vectors only
+        dense_qp_qpoases_get_rhs(qp_in, g, d_lb0, d_ub0, d_lg0, d_ug0);
+    }
+    else
+    {
+        // fill in the upper triangular of H in dense_qp
+        blasfeo_dtrtr_l(nv, qp_in->Hv, 0, 0, qp_in->Hv, 0, 0);
 
-    // extract data from qp_in in row-major
-    d_dense_qp_get_all_rowmaj(qp_in, H, g, A, b, idxb, d_lb0, d_ub0, C, d_lg0, d_ug0,
-                                 Zl, Zu, zl, zu, idxs, d_ls, d_us);
+        // extract data from qp_in in row-major
+        d_dense_qp_get_all_rowmaj(qp_in, H, g, A, b, idxb, d_lb0, d_ub0, C, d_lg0, d_ug0,
+                                     Zl, Zu, zl, zu, idxs, d_ls, d_us);
+    }
 
     // reorder box constraints bounds
     for (int ii = 0; ii < nv2; ii++)
@@ -575,6 +608,10 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
     }
     else
     {  // hotstart = 0
+        // the data matrices may change between calls (e.g. lti switched off in the condensing):
+        // the next hotstart initializes qpOASES again
+        memory->first_it = 1;
+
         if (ng > 0 || ns > 0)
         {
             QProblemCON(QP, nv2, ng2, HST_POSDEF);
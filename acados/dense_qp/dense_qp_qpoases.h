@@ -53,7 +53,7 @@ typedef struct dense_qp_qpoases_opts_
     int warm_start;      // warm start with dual_sol in memory
     int use_precomputed_cholesky;
     int hotstart;  // this option requires constant data matrices! (eg linear MPC, inexact schemes
-                   // with frozen sensitivities)
+                   // with frozen sensitivities); pair with full condensing option lti
     int set_acado_opts;  // use same options as in acado code generation
     int compute_t;       // compute t in qp_out (to have correct residuals in NLP)
     double tolerance;  // terminationTolerance
@@ -154,7 +154,7 @@ static int ocp_nlp_dims_calculate_size_self(int N)
     size += sizeof(ocp_nlp_dims);
 
     // nlp sizes
-    size += 6 * (N + 1) * sizeof(int);  // nv, nx, nu, ni, nz, ns
+    size += 7 * (N + 1) * sizeof(int);  // nv, nx, nu, ni, nz, ns, np
 
     // dynamics
     size += N * sizeof(void *);
@@ -234,6 +234,8 @@ static ocp_nlp_dims *ocp_nlp_dims_assign_self(int N, void *raw_memory)
     assign_and_advance_int(N + 1, &dims->nz, &c_ptr);
     // ns
     assign_and_advance_int(N + 1, &dims->ns, &c_ptr);
+    // np
+    assign_and_advance_int(N + 1, &dims->np, &c_ptr);
 
     // dynamics
     dims->dynamics = (void **) c_ptr;
@@ -284,6 +286,9 @@ static ocp_nlp_dims *ocp_nlp_dims_assign_self(int N, void *raw_memory)
 	// ns
 	for(ii=0; ii<=N; ii++)
 		dims->ns[ii] = 0;
+	// np
+	for(ii=0; ii<=N; ii++)
+		dims->np[ii] = 0;
 	// TODO initialize dims to zero by default also in modules !!!!!!!
 
     // assert
@@ -493,6 +498,14 @@ void ocp_nlp_dims_set_opt_vars(void *config_, void *dims_, const char *field,
                                         &int_array[i]);
         }
     }
+    else if (!strcmp(field, "np"))
+    {
+        // parameters live in the external functions, only the nlp input keeps a copy
+        for (int ii = 0; ii <= N; ii++)
+        {
+            dims->np[ii] = int_array[ii];
+        }
+    }
     else
     {
         printf("error: dims type not available in module ocp_nlp: %s", field);
@@ -660,6 +673,12 @@ int ocp_nlp_in_calculate_size_self(int N)
 
     size += (N + 1) * sizeof(void *);  // constraints
 
+    size += (3 * N + 2) * sizeof(int);  // dynamics_version cost_version constraints_version
+
+    size += (N + 1) * sizeof(double *);  // parameter_values
+
+    size += 8;  // align of parameter_values
+
     return size;
 }
 
@@ -693,6 +712,13 @@ int ocp_nlp_in_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims)
                                                               dims->constraints[ii]);
     }
 
+    // parameter_values
+    for (ii = 0; ii <= N; ii++)
+    {
+        size += dims->np[ii] * sizeof(double);
+    }
+    size += 8;  // align of parameter_values
+
     size += 8;  // initial align
 
     //  make_int_multiple_of(64, &size);
@@ -729,6 +755,29 @@ ocp_nlp_in *ocp_nlp_in_assign_self(int N, void *raw_memory)
     in->constraints = (void **) c_ptr;
     c_ptr += (N + 1) * sizeof(void *);
 
+    // versions
+    in->dynamics_version = (int *) c_ptr;
+    c_ptr += N * sizeof(int);
+    in->cost_version = (int *) c_ptr;
+    c_ptr += (N + 1) * sizeof(int);
+    in->constraints_version = (int *) c_ptr;
+    c_ptr += (N + 1) * sizeof(int);
+
+    // parameter_values
+    align_char_to(8, &c_ptr);
+    in->parameter_values = (double **) c_ptr;
+    c_ptr += (N + 1) * sizeof(double *);
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        if (ii < N)
+            in->dynamics_version[ii] = 0;
+        in->cost_version[ii] = 0;
+        in->constraints_version[ii] = 0;
+    }
+
+    in->ext_fun_batch_num = 0;
+
     return in;
 }
 
@@ -771,6 +820,15 @@ ocp_nlp_in *ocp_nlp_in_assign(ocp_nlp_config *config, ocp_nlp_dims *dims, void *
                                                                dims->constraints[ii]);
     }
 
+    // parameter_values
+    align_char_to(8, &c_ptr);
+    for (ii = 0; ii <= N; ii++)
+    {
+        assign_and_advance_double(dims->np[ii], &in->parameter_values[ii], &c_ptr);
+        for (int jj = 0; jj < dims->np[ii]; jj++)
+            in->parameter_values[ii][jj] = 0.0;
+    }
+
     assert((char *) raw_memory + ocp_nlp_in_calculate_size(config, dims) >= c_ptr);
 
     return in;
@@ -792,21 +850,28 @@ int ocp_nlp_out_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims)
     int *ni = dims->ni;
     int *nz = dims->nz;
 
+    // ring buffer: all buffers are sized for the largest stage
+    int nv_max = 0;
+    int nx_max = 0;
+    int ni_max = 0;
+    int nz_max = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        nv_max = nv[ii] > nv_max ? nv[ii] : nv_max;
+        nx_max = nx[ii] > nx_max ? nx[ii] : nx_max;
+        ni_max = ni[ii] > ni_max ? ni[ii] : ni_max;
+        nz_max = nz[ii] > nz_max ? nz[ii] : nz_max;
+    }
+
     int size = sizeof(ocp_nlp_out);
 
-    size += 4 * (N + 1) * sizeof(struct blasfeo_dvec);  // ux, lam, t, z
-    size += 1 * N * sizeof(struct blasfeo_dvec);        // pi
+    size += 4 * 2 * (N + 1) * sizeof(struct blasfeo_dvec);  // ux, lam, t, z
+    size += 1 * 2 * N * sizeof(struct blasfeo_dvec);        // pi
 
-    for (int ii = 0; ii < N; ii++)
-    {
-        size += 1 * blasfeo_memsize_dvec(nv[ii]);      // ux
-        size += 1 * blasfeo_memsize_dvec(nz[ii]);      // z
-        size += 2 * blasfeo_memsize_dvec(2 * ni[ii]);  // lam, t
-        size += 1 * blasfeo_memsize_dvec(nx[ii + 1]);  // pi
-    }
-    size += 1 * blasfeo_memsize_dvec(nv[N]);      // ux
-    size += 1 * blasfeo_memsize_dvec(nz[N]);     // z
-    size += 2 * blasfeo_memsize_dvec(2 * ni[N]);  // lam, t
+    size += 1 * (N + 1) * blasfeo_memsize_dvec(nv_max);      // ux
+    size += 1 * (N + 1) * blasfeo_memsize_dvec(nz_max);      // z
+    size += 2 * (N + 1) * blasfeo_memsize_dvec(2 * ni_max);  // lam, t
+    size += 1 * N * blasfeo_memsize_dvec(nx_max);            // pi
 
     size += 8;   // initial align
     size += 8;   // blasfeo_struct align
@@ -832,6 +897,19 @@ ocp_nlp_out *ocp_nlp_out_assign(ocp_nlp_config *config, ocp_nlp_dims *dims, void
     int *ni = dims->ni;
     int *nz = dims->nz;
 
+    // ring buffer: all buffers are sized for the largest stage
+    int nv_max = 0;
+    int nx_max = 0;
+    int ni_max = 0;
+    int nz_max = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        nv_max = nv[ii] > nv_max ? nv[ii] : nv_max;
+        nx_max = nx[ii] > nx_max ? nx[ii] : nx_max;
+        ni_max = ni[ii] > ni_max ? ni[ii] : ni_max;
+        nz_max = nz[ii] > nz_max ? nz[ii] : nz_max;
+    }
+
     char *c_ptr = (char *) raw_memory;
 
     // initial align
@@ -845,60 +923,74 @@ ocp_nlp_out *ocp_nlp_out_assign(ocp_nlp_config *config, ocp_nlp_dims *dims, void
 
     // blasfeo_dvec_struct
     // ux
-    assign_and_advance_blasfeo_dvec_structs(N + 1, &out->ux, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(2 * (N + 1), &out->ux_ring, &c_ptr);
     // z
-    assign_and_advance_blasfeo_dvec_structs(N + 1, &out->z, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(2 * (N + 1), &out->z_ring, &c_ptr);
     // pi
-    assign_and_advance_blasfeo_dvec_structs(N, &out->pi, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(2 * N, &out->pi_ring, &c_ptr);
     // lam
-    assign_and_advance_blasfeo_dvec_structs(N + 1, &out->lam, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(2 * (N + 1), &out->lam_ring, &c_ptr);
     // t
-    assign_and_advance_blasfeo_dvec_structs(N + 1, &out->t, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(2 * (N + 1), &out->t_ring, &c_ptr);
 
     // blasfeo_mem align
     align_char_to(64, &c_ptr);
 
     // blasfeo_dvec
     // ux
-    for (int ii = 0; ii <= N; ++ii)
+    for (ii = 0; ii <= N; ++ii)
     {
-        assign_and_advance_blasfeo_dvec_mem(nv[ii], out->ux + ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nv_max, out->ux_ring + ii, &c_ptr);
+        out->ux_ring[N + 1 + ii] = out->ux_ring[ii];
     }
     // z
-    for (int ii = 0; ii <= N; ++ii)
+    for (ii = 0; ii <= N; ++ii)
     {
-        assign_and_advance_blasfeo_dvec_mem(nz[ii], out->z + ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nz_max, out->z_ring + ii, &c_ptr);
+        out->z_ring[N + 1 + ii] = out->z_ring[ii];
     }
     // pi
-    for (int ii = 0; ii < N; ++ii)
+    for (ii = 0; ii < N; ++ii)
     {
-        assign_and_advance_blasfeo_dvec_mem(nx[ii + 1], out->pi + ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nx_max, out->pi_ring + ii, &c_ptr);
+        out->pi_ring[N + ii] = out->pi_ring[ii];
     }
     // lam
-    for (int ii = 0; ii <= N; ++ii)
+    for (ii = 0; ii <= N; ++ii)
     {
-        assign_and_advance_blasfeo_dvec_mem(2 * ni[ii], out->lam + ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(2 * ni_max, out->lam_ring + ii, &c_ptr);
+        out->lam_ring[N + 1 + ii] = out->lam_ring[ii];
     }
     // t
-    for (int ii = 0; ii <= N; ++ii)
+    for (ii = 0; ii <= N; ++ii)
     {
-        assign_and_advance_blasfeo_dvec_mem(2 * ni[ii], out->t + ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(2 * ni_max, out->t_ring + ii, &c_ptr);
+        out->t_ring[N + 1 + ii] = out->t_ring[ii];
     }
 
+    // stage windows
+    out->ring_head = 0;
+    out->ring_head_pi = 0;
+    out->ux = out->ux_ring;
+    out->z = out->z_ring;
+    out->pi = out->pi_ring;
+    out->lam = out->lam_ring;
+    out->t = out->t_ring;
+
 	// zero solution
 	for(ii=0; ii<N; ii++)
 	{
-		blasfeo_dvecse(nv[ii], 0.0, out->ux+ii, 0);
-		blasfeo_dvecse(nz[ii], 0.0, out->z+ii, 0);
-		blasfeo_dvecse(nx[ii+1], 0.0, out->pi+ii, 0);
-		blasfeo_dvecse(2*ni[ii], 0.0, out->lam+ii, 0);
-		blasfeo_dvecse(2*ni[ii], 0.0, out->t+ii, 0);
+		blasfeo_dvecse(nv_max, 0.0, out->ux+ii, 0);
+		blasfeo_dvecse(nz_max, 0.0, out->z+ii, 0);
+		blasfeo_dvecse(nx_max, 0.0, out->pi+ii, 0);
+		blasfeo_dvecse(2*ni_max, 0.0, out->lam+ii, 0);
+		blasfeo_dvecse(2*ni_max, 0.0, out->t+ii, 0);
 	}
 	ii = N;
-	blasfeo_dvecse(nv[ii], 0.0, out->ux+ii, 0);
-	blasfeo_dvecse(nz[ii], 0.0, out->z+ii, 0);
-	blasfeo_dvecse(2*ni[ii], 0.0, out->lam+ii, 0);
-	blasfeo_dvecse(2*ni[ii], 0.0, out->t+ii, 0);
+	blasfeo_dvecse(nv_max, 0.0, out->ux+ii, 0);
+	blasfeo_dvecse(nz_max, 0.0, out->z+ii, 0);
+	blasfeo_dvecse(2*ni_max, 0.0, out->lam+ii, 0);
+	blasfeo_dvecse(2*ni_max, 0.0, out->t+ii, 0);
 
     assert((char *) raw_memory + ocp_nlp_out_calculate_size(config, dims) >= c_ptr);
 
@@ -1037,6 +1129,9 @@ void ocp_nlp_opts_initialize_default(void *config_, void *dims_, void *opts_)
 #endif
 
     opts->step_length = 1.0;
+    opts->shift_policy = SHIFT_COPY;
+    opts->tightening_stage = 0;
+    opts->tightening_mu = 1e-2;
 
     // submodules opts
 
@@ -1137,6 +1232,13 @@ void ocp_nlp_opts_set(void *config_, void *opts_, const char *field, void* value
         config->qp_solver->opts_set(config->qp_solver, opts->qp_solver_opts,
                                     field+module_length+1, value);
     }
+    // pass options to regularization module
+    else if ( ptr_module!=NULL && (!strcmp(ptr_module, "reg")) )
+    {
+        // NOTE the regularization opts_set does not depend on dims
+        config->regularize->opts_set(config->regularize, NULL, opts->regularize,
+                                     (char *) field+module_length+1, value);
+    }
     // pass options to dynamics module
     else // nlp opts
     {
@@ -1155,6 +1257,33 @@ void ocp_nlp_opts_set(void *config_, void *opts_, const char *field, void* value
             double* step_length = (double *) value;
             opts->step_length = *step_length;
         }
+        else if (!strcmp(field, "shift_policy"))
+        {
+            int* shift_policy = (int *) value;
+            if (*shift_policy != SHIFT_COPY && *shift_policy != SHIFT_SIMULATE && *shift_policy != SHIFT_LQR)
+            {
+                printf("\nerror: ocp_nlp_opts_set: invalid value for shift_policy field, got %d.", *shift_policy);
+                printf("possible values are: %d (SHIFT_COPY), %d (SHIFT_SIMULATE), %d (SHIFT_LQR)\n",
+                       SHIFT_COPY, SHIFT_SIMULATE, SHIFT_LQR);
+                exit(1);
+            }
+            opts->shift_policy = *shift_policy;
+        }
+        else if (!strcmp(field, "tightening_stage"))
+        {
+            int* tightening_stage = (int *) value;
+            opts->tightening_stage = *tightening_stage;
+        }
+        else if (!strcmp(field, "tightening_mu"))
+        {
+            double* tightening_mu = (double *) value;
+            if (*tightening_mu <= 0.0)
+            {
+                printf("\nerror: ocp_nlp_opts_set: tightening_mu has to be positive, got %e\n", *tightening_mu);
+                exit(1);
+            }
+            opts->tightening_mu = *tightening_mu;
+        }
         else if (!strcmp(field, "exact_hess"))
         {
             int N = config->N;
@@ -1287,12 +1416,35 @@ int ocp_nlp_memory_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, oc
         size += constraints[ii]->memory_calculate_size(constraints[ii], dims->constraints[ii], opts->constraints[ii]);
     }
 
+    size += (3*N+2)*sizeof(int); // dynamics_version cost_version constraints_version
+
     size += (N+1)*sizeof(bool); // set_sim_guess
 
     size += (N+1)*sizeof(struct blasfeo_dmat); // dzduxt
-    size += 6*(N+1)*sizeof(struct blasfeo_dvec);  // cost_grad ineq_fun ineq_adj dyn_adj sim_guess z_alg
+    size += 5*(N+1)*sizeof(struct blasfeo_dvec);  // cost_grad ineq_fun ineq_adj dyn_adj z_alg
+    size += 2*(N+1)*sizeof(struct blasfeo_dvec);  // sim_guess_ring
     size += 1*N*sizeof(struct blasfeo_dvec);        // dyn_fun
 
+    int nxz_max = 0;
+    int nux_max = 0;
+    int nx_max = 0;
+    int nv_max = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        nxz_max = nx[ii]+nz[ii] > nxz_max ? nx[ii]+nz[ii] : nxz_max;
+        nux_max = nu[ii]+nx[ii] > nux_max ? nu[ii]+nx[ii] : nux_max;
+        nx_max = nx[ii] > nx_max ? nx[ii] : nx_max;
+        nv_max = nv[ii] > nv_max ? nv[ii] : nv_max;
+    }
+    size += (N+1)*blasfeo_memsize_dvec(nxz_max); // sim_guess_ring
+
+    // horizon shift
+    size += blasfeo_memsize_dmat(nx_max, nx_max); // shift_P
+    size += blasfeo_memsize_dmat(nux_max, nx_max); // shift_BAbtP
+    size += blasfeo_memsize_dmat(nux_max, nux_max); // shift_H
+    size += blasfeo_memsize_dvec(nux_max); // shift_dux
+    size += blasfeo_memsize_dvec(nv_max); // shift_tmp
+
     for (int ii = 0; ii < N; ii++)
     {
 		size += 1*blasfeo_memsize_dmat(nu[ii]+nx[ii], nz[ii]); // dzduxt
@@ -1301,14 +1453,12 @@ int ocp_nlp_memory_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, oc
         size += 1*blasfeo_memsize_dvec(nu[ii] + nx[ii]);  // dyn_adj
         size += 1*blasfeo_memsize_dvec(nx[ii + 1]);       // dyn_fun
         size += 1*blasfeo_memsize_dvec(2 * ni[ii]);       // ineq_fun
-        size += 1*blasfeo_memsize_dvec(nx[ii] + nz[ii]); // sim_guess
     }
 	size += 1*blasfeo_memsize_dmat(nu[N]+nx[N], nz[N]); // dzduxt
 	size += 1*blasfeo_memsize_dvec(nz[N]); // z_alg
     size += 2*blasfeo_memsize_dvec(nv[N]);          // cost_grad ineq_adj
     size += 1*blasfeo_memsize_dvec(nu[N] + nx[N]);  // dyn_adj
     size += 1*blasfeo_memsize_dvec(2 * ni[N]);      // ineq_fun
-    size += 1*blasfeo_memsize_dvec(nx[N] + nz[N]);  // sim_guess
 
     size += 8;   // initial align
     size += 8;   // middle align
@@ -1358,6 +1508,22 @@ ocp_nlp_memory *ocp_nlp_memory_assign(ocp_nlp_config *config, ocp_nlp_dims *dims
     mem->constraints = (void **) c_ptr;
     c_ptr += (N+1)*sizeof(void *);
 
+    // versions
+    assign_and_advance_int(N, &mem->dynamics_version, &c_ptr);
+    assign_and_advance_int(N+1, &mem->cost_version, &c_ptr);
+    assign_and_advance_int(N+1, &mem->constraints_version, &c_ptr);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        if (ii < N)
+            mem->dynamics_version[ii] = -1;
+        mem->cost_version[ii] = -1;
+        mem->constraints_version[ii] = -1;
+    }
+    mem->version_in = NULL;
+    mem->qp_mat_const = 0;
+    mem->qp_mat_valid = 0;
+    mem->qp_mat_unchanged = 0;
+
     // middle align
     align_char_to(8, &c_ptr);
 
@@ -1430,7 +1596,7 @@ ocp_nlp_memory *ocp_nlp_memory_assign(ocp_nlp_config *config, ocp_nlp_dims *dims
     // dyn_adj
     assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->dyn_adj, &c_ptr);
     // sim_guess
-    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->sim_guess, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(2 * (N + 1), &mem->sim_guess_ring, &c_ptr);
 
     // blasfeo_mem align
     align_char_to(64, &c_ptr);
@@ -1473,14 +1639,34 @@ ocp_nlp_memory *ocp_nlp_memory_assign(ocp_nlp_config *config, ocp_nlp_dims *dims
     {
         assign_and_advance_blasfeo_dvec_mem(nu[ii] + nx[ii], mem->dyn_adj + ii, &c_ptr);
     }
+    int nxz_max = 0;
+    int nux_max = 0;
+    int nx_max = 0;
+    int nv_max = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        nxz_max = nx[ii]+nz[ii] > nxz_max ? nx[ii]+nz[ii] : nxz_max;
+        nux_max = nu[ii]+nx[ii] > nux_max ? nu[ii]+nx[ii] : nux_max;
+        nx_max = nx[ii] > nx_max ? nx[ii] : nx_max;
+        nv_max = nv[ii] > nv_max ? nv[ii] : nv_max;
+    }
     // sim_guess
     for (int ii = 0; ii <= N; ++ii)
     {
-        assign_and_advance_blasfeo_dvec_mem(nx[ii] + nz[ii], mem->sim_guess + ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nxz_max, mem->sim_guess_ring + ii, &c_ptr);
+        mem->sim_guess_ring[N + 1 + ii] = mem->sim_guess_ring[ii];
         // set to 0;
-		blasfeo_dvecse(nx[ii] + nz[ii], 0.0, mem->sim_guess+ii, 0);
-        // printf("sim_guess ii %d: %p\n", ii, mem->sim_guess+ii);
+		blasfeo_dvecse(nxz_max, 0.0, mem->sim_guess_ring+ii, 0);
     }
+    mem->sim_guess_head = 0;
+    mem->sim_guess = mem->sim_guess_ring;
+
+    // horizon shift
+    assign_and_advance_blasfeo_dmat_mem(nx_max, nx_max, &mem->shift_P, &c_ptr);
+    assign_and_advance_blasfeo_dmat_mem(nux_max, nx_max, &mem->shift_BAbtP, &c_ptr);
+    assign_and_advance_blasfeo_dmat_mem(nux_max, nux_max, &mem->shift_H, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(nux_max, &mem->shift_dux, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(nv_max, &mem->shift_tmp, &c_ptr);
     // printf("created memory %p\n", mem);
 
     return mem;
@@ -1766,6 +1952,33 @@ ocp_nlp_workspace *ocp_nlp_workspace_assign(ocp_nlp_config *config, ocp_nlp_dims
  * functions
  ************************************************/
 
+static int ocp_nlp_stage_constant_qp_matrices(ocp_nlp_config *config, ocp_nlp_dims *dims,
+    ocp_nlp_in *in, ocp_nlp_opts *opts, int stage)
+{
+    ocp_nlp_dynamics_config *dynamics = stage < dims->N ? config->dynamics[stage] : NULL;
+    ocp_nlp_cost_config *cost = config->cost[stage];
+    ocp_nlp_constraints_config *constraints = config->constraints[stage];
+
+    // modules not providing constant_qp_matrices are assumed to depend on the iterate
+    if (dynamics != NULL && (dynamics->constant_qp_matrices == NULL ||
+        !dynamics->constant_qp_matrices(dynamics, dims->dynamics[stage], in->dynamics[stage],
+                                        opts->dynamics[stage])))
+        return 0;
+
+    if (cost->constant_qp_matrices == NULL ||
+        !cost->constant_qp_matrices(cost, dims->cost[stage], in->cost[stage], opts->cost[stage]))
+        return 0;
+
+    if (constraints->constant_qp_matrices == NULL ||
+        !constraints->constant_qp_matrices(constraints, dims->constraints[stage],
+                                           in->constraints[stage], opts->constraints[stage]))
+        return 0;
+
+    return 1;
+}
+
+
+
 void ocp_nlp_initialize_qp(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
          ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
 {
@@ -1774,22 +1987,61 @@ void ocp_nlp_initialize_qp(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_i
 
     int N = dims->N;
 
+    // only modules whose model changed since their last initialization are initialized again
+    int init_all = mem->version_in != in;
+    int changed = init_all;
+    for (ii = 0; ii <= N; ii++)
+    {
+        if (ii < N && mem->dynamics_version[ii] != in->dynamics_version[ii])
+            changed = 1;
+        if (mem->cost_version[ii] != in->cost_version[ii])
+            changed = 1;
+        if (mem->constraints_version[ii] != in->constraints_version[ii])
+            changed = 1;
+    }
+
 #if defined(ACADOS_WITH_OPENMP)
     #pragma omp parallel for
 #endif
     for (ii = 0; ii <= N; ii++)
     {
         // cost
-        config->cost[ii]->initialize(config->cost[ii], dims->cost[ii], in->cost[ii],
-        		opts->cost[ii], mem->cost[ii], work->cost[ii]);
+        if (init_all || mem->cost_version[ii] != in->cost_version[ii])
+        {
+            config->cost[ii]->initialize(config->cost[ii], dims->cost[ii], in->cost[ii],
+                    opts->cost[ii], mem->cost[ii], work->cost[ii]);
+            mem->cost_version[ii] = in->cost_version[ii];
+        }
         // dynamics
-        if (ii < N)
+        if (ii < N && (init_all || mem->dynamics_version[ii] != in->dynamics_version[ii]))
+        {
             config->dynamics[ii]->initialize(config->dynamics[ii], dims->dynamics[ii],
-            		in->dynamics[ii], opts->dynamics[ii], mem->dynamics[ii], work->dynamics[ii]);
+                    in->dynamics[ii], opts->dynamics[ii], mem->dynamics[ii], work->dynamics[ii]);
+            mem->dynamics_version[ii] = in->dynamics_version[ii];
+        }
         // constraints
-        config->constraints[ii]->initialize(config->constraints[ii], dims->constraints[ii],
-        		in->constraints[ii], opts->constraints[ii], mem->constraints[ii], work->constraints[ii]);
+        if (init_all || mem->constraints_version[ii] != in->constraints_version[ii])
+        {
+            config->constraints[ii]->initialize(config->constraints[ii], dims->constraints[ii],
+                    in->constraints[ii], opts->constraints[ii], mem->constraints[ii],
+                    work->constraints[ii]);
+            mem->constraints_version[ii] = in->constraints_version[ii];
+        }
+    }
+    mem->version_in = in;
+
+    // qp matrices independent of the iterate stay valid until the next model change
+    mem->qp_mat_const = 1;
+    for (ii = 0; ii <= N; ii++)
+    {
+        if (!ocp_nlp_stage_constant_qp_matrices(config, dims, in, opts, ii))
+        {
+            mem->qp_mat_const = 0;
+            break;
+        }
     }
+    if (changed || !mem->qp_mat_const)
+        mem->qp_mat_valid = 0;
 
     return;
 }
@@ -1809,6 +2061,13 @@ void ocp_nlp_approximate_qp_matrices(ocp_nlp_config *config, ocp_nlp_dims *dims,
     int *nu = dims->nu;
     int *ni = dims->ni;
 
+    // the qp solver may keep e.g. the condensed Hessian if the matrices did not change
+    mem->qp_mat_unchanged = mem->qp_mat_valid;
+
+    // batched external functions: evaluate all the nodes at once, outside of the parallel loop
+    for (i = 0; i < in->ext_fun_batch_num; i++)
+        external_function_casadi_batch_evaluate(in->ext_fun_batch[i]);
+
     /* stage-wise multiple shooting lagrangian evaluation */
 
 #if defined(ACADOS_WITH_OPENMP)
@@ -1884,6 +2143,8 @@ void ocp_nlp_approximate_qp_matrices(ocp_nlp_config *config, ocp_nlp_dims *dims,
 
     }
 
+    mem->qp_mat_valid = mem->qp_mat_const;
+
     for (i = 0; i <= N; i++)
     {
         // TODO(rien) where should the update happen??? move to qp update ???
@@ -1966,196 +2227,447 @@ void ocp_nlp_embed_initial_value(ocp_nlp_config *config, ocp_nlp_dims *dims,
 
 
 
-double ocp_nlp_evaluate_merit_fun(ocp_nlp_config *config, ocp_nlp_dims *dims,
-                                  ocp_nlp_in *in, ocp_nlp_out *out, ocp_nlp_opts *opts,
-                                  ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+// the inequality constraint jj (of nb + ng) at stage ii is tightened: soft constraints and
+// (almost) equality constraints stay in the qp
+static int ocp_nlp_tightening_constr(ocp_nlp_opts *opts, ocp_nlp_memory *mem, int ii, int jj)
+{
+    int nb = mem->qp_in->dim->nb[ii];
+    int ng = mem->qp_in->dim->ng[ii];
+    int ns = mem->qp_in->dim->ns[ii];
+
+    if (opts->tightening_stage <= 0 || ii < opts->tightening_stage || ns > 0)
+        return 0;
+
+    // s_l + s_u = ub - lb
+    double range = - BLASFEO_DVECEL(mem->ineq_fun+ii, jj) - BLASFEO_DVECEL(mem->ineq_fun+ii, nb+ng+jj);
+
+    return range > 2.0*opts->tightening_mu;
+}
+
+
+
+void ocp_nlp_tightening_qp_matrices(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+    ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
 {
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    if (opts->tightening_stage <= 0 || opts->tightening_stage > N)
+        return;
+
+    double mu = opts->tightening_mu;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (int ii = opts->tightening_stage; ii <= N; ii++)
+    {
+        int nb = mem->qp_in->dim->nb[ii];
+        int ng = mem->qp_in->dim->ng[ii];
+        int nux = nu[ii] + nx[ii];
+        struct blasfeo_dmat *RSQrq = mem->qp_in->RSQrq+ii;
 
-	int i, j;
+        for (int jj = 0; jj < nb + ng; jj++)
+        {
+            if (!ocp_nlp_tightening_constr(opts, mem, ii, jj))
+                continue;
+
+            // slacks at the linearization point, floored at mu
+            double s_l = - BLASFEO_DVECEL(mem->ineq_fun+ii, jj);
+            double s_u = - BLASFEO_DVECEL(mem->ineq_fun+ii, nb+ng+jj);
+            s_l = s_l > mu ? s_l : mu;
+            s_u = s_u > mu ? s_u : mu;
+
+            // hessian of -mu*(log(s_l) + log(s_u)): (mu/s_l^2 + mu/s_u^2) * a * a^T
+            double w = mu / (s_l*s_l) + mu / (s_u*s_u);
+
+            if (jj < nb)
+            {
+                int idx = mem->qp_in->idxb[ii][jj];
+                BLASFEO_DMATEL(RSQrq, idx, idx) += w;
+            }
+            else
+            {
+                struct blasfeo_dmat *DCt = mem->qp_in->DCt+ii;
+                for (int kk = 0; kk < nux; kk++)
+                {
+                    double a_k = BLASFEO_DMATEL(DCt, kk, jj-nb);
+                    if (a_k == 0.0)
+                        continue;
+                    for (int ll = kk; ll < nux; ll++)
+                        BLASFEO_DMATEL(RSQrq, ll, kk) += w * BLASFEO_DMATEL(DCt, ll, jj-nb) * a_k;
+                }
+            }
+        }
+    }
+
+    // the barrier hessian depends on the iterate
+    mem->qp_mat_valid = 0;
+    mem->qp_mat_unchanged = 0;
+
+    return;
+}
+
+
+
+void ocp_nlp_tightening_qp_vectors(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+    ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
 
-	int N = dims->N;
-	int *nx = dims->nx;
-	int *ni = dims->ni;
+    if (opts->tightening_stage <= 0 || opts->tightening_stage > N)
+        return;
 
-	double merit_fun = 0.0;
+    double mu = opts->tightening_mu;
 
-	// compute fun value
 #if defined(ACADOS_WITH_OPENMP)
     #pragma omp parallel for
 #endif
-    for (i=0; i<=N; i++)
+    for (int ii = opts->tightening_stage; ii <= N; ii++)
     {
-        // cost
-        config->cost[i]->compute_fun(config->cost[i], dims->cost[i], in->cost[i], opts->cost[i], mem->cost[i], work->cost[i]);
+        int nb = mem->qp_in->dim->nb[ii];
+        int ng = mem->qp_in->dim->ng[ii];
+        int nux = nu[ii] + nx[ii];
+
+        for (int jj = 0; jj < nb + ng; jj++)
+        {
+            if (!ocp_nlp_tightening_constr(opts, mem, ii, jj))
+                continue;
+
+            double s_l = - BLASFEO_DVECEL(mem->ineq_fun+ii, jj);
+            double s_u = - BLASFEO_DVECEL(mem->ineq_fun+ii, nb+ng+jj);
+            s_l = s_l > mu ? s_l : mu;
+            s_u = s_u > mu ? s_u : mu;
+
+            // gradient of -mu*(log(s_l) + log(s_u)): (mu/s_u - mu/s_l) * a
+            double g = mu / s_u - mu / s_l;
+
+            if (jj < nb)
+            {
+                BLASFEO_DVECEL(mem->qp_in->rqz+ii, mem->qp_in->idxb[ii][jj]) += g;
+            }
+            else
+            {
+                for (int kk = 0; kk < nux; kk++)
+                    BLASFEO_DVECEL(mem->qp_in->rqz+ii, kk) += g * BLASFEO_DMATEL(mem->qp_in->DCt+ii, kk, jj-nb);
+            }
+        }
     }
+
+    // remove the constraints from the qp
+    ocp_nlp_tightening_qp_bounds(config, dims, in, out, opts, mem, work);
+
+    return;
+}
+
+
+
+void ocp_nlp_tightening_qp_bounds(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+    ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int N = dims->N;
+
+    if (opts->tightening_stage <= 0 || opts->tightening_stage > N)
+        return;
+
 #if defined(ACADOS_WITH_OPENMP)
     #pragma omp parallel for
 #endif
-    for (i=0; i<N; i++)
+    for (int ii = opts->tightening_stage; ii <= N; ii++)
     {
-        // cost
-        config->dynamics[i]->compute_fun(config->dynamics[i], dims->dynamics[i], in->dynamics[i], opts->dynamics[i], mem->dynamics[i], work->dynamics[i]);
+        int nb = mem->qp_in->dim->nb[ii];
+        int ng = mem->qp_in->dim->ng[ii];
+
+        for (int jj = 0; jj < nb + ng; jj++)
+        {
+            if (!ocp_nlp_tightening_constr(opts, mem, ii, jj))
+                continue;
+
+            BLASFEO_DVECEL(mem->qp_in->d+ii, jj) = ACADOS_NEG_INFTY;
+            BLASFEO_DVECEL(mem->qp_in->d+ii, nb+ng+jj) = ACADOS_NEG_INFTY;
+        }
     }
+
+    return;
+}
+
+
+
+void ocp_nlp_tightening_qp_sol(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+    ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    if (opts->tightening_stage <= 0 || opts->tightening_stage > N)
+        return;
+
+    double mu = opts->tightening_mu;
+
 #if defined(ACADOS_WITH_OPENMP)
     #pragma omp parallel for
 #endif
-    for (i=0; i<=N; i++)
+    for (int ii = opts->tightening_stage; ii <= N; ii++)
     {
-        // constr
-        config->constraints[i]->compute_fun(config->constraints[i], dims->constraints[i],
-                                            in->constraints[i], opts->constraints[i],
-                                            mem->constraints[i], work->constraints[i]);
+        int nb = mem->qp_in->dim->nb[ii];
+        int ng = mem->qp_in->dim->ng[ii];
+        int nux = nu[ii] + nx[ii];
+
+        for (int jj = 0; jj < nb + ng; jj++)
+        {
+            if (!ocp_nlp_tightening_constr(opts, mem, ii, jj))
+                continue;
+
+            // constraint step a^T * dux
+            double a_dux = 0.0;
+            if (jj < nb)
+            {
+                a_dux = BLASFEO_DVECEL(mem->qp_out->ux+ii, mem->qp_in->idxb[ii][jj]);
+            }
+            else
+            {
+                for (int kk = 0; kk < nux; kk++)
+                    a_dux += BLASFEO_DMATEL(mem->qp_in->DCt+ii, kk, jj-nb) * BLASFEO_DVECEL(mem->qp_out->ux+ii, kk);
+            }
+
+            double s_l = - BLASFEO_DVECEL(mem->ineq_fun+ii, jj);
+            double s_u = - BLASFEO_DVECEL(mem->ineq_fun+ii, nb+ng+jj);
+
+            // linearized slacks
+            BLASFEO_DVECEL(mem->qp_out->t+ii, jj) = s_l + a_dux;
+            BLASFEO_DVECEL(mem->qp_out->t+ii, nb+ng+jj) = s_u - a_dux;
+
+            // linearized barrier multipliers mu/s
+            s_l = s_l > mu ? s_l : mu;
+            s_u = s_u > mu ? s_u : mu;
+            double lam_l = mu / s_l * (1.0 - a_dux / s_l);
+            double lam_u = mu / s_u * (1.0 + a_dux / s_u);
+            BLASFEO_DVECEL(mem->qp_out->lam+ii, jj) = lam_l > 0.0 ? lam_l : 0.0;
+            BLASFEO_DVECEL(mem->qp_out->lam+ii, nb+ng+jj) = lam_u > 0.0 ? lam_u : 0.0;
+        }
     }
 
-	double *tmp_fun;
-	double tmp;
-	struct blasfeo_dvec *tmp_fun_vec;
+    return;
+}
 
-	double cost_fun = 0.0;
-	for(i=0; i<=N; i++)
-	{
-		tmp_fun = config->cost[i]->memory_get_fun_ptr(mem->cost[i]);
-		cost_fun += *tmp_fun;
-	}
 
-	double dyn_fun = 0.0;
-	for(i=0; i<N; i++)
-	{
-//		printf("\ni %d\n", i);
-		tmp_fun_vec = config->dynamics[i]->memory_get_fun_ptr(mem->dynamics[i]);
-//		blasfeo_print_exp_tran_dvec(nx[i+1], tmp_fun_vec, 0);
-//		blasfeo_print_exp_tran_dvec(nx[i+1], work->weights_nlp_out->pi+i, 0);
-		for(j=0; j<nx[i+1]; j++)
-		{
-//			printf("\n%e %e\n", fabs(BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j)), fabs(BLASFEO_DVECEL(tmp_fun_vec, j)));
-			dyn_fun += fabs(BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j)) * fabs(BLASFEO_DVECEL(tmp_fun_vec, j));
-		}
-	}
 
-	double constr_fun = 0.0;
-	for(i=0; i<=N; i++)
-	{
-//		printf("\ni %d\n", i);
-		tmp_fun_vec = config->constraints[i]->memory_get_fun_ptr(mem->constraints[i]);
-//		blasfeo_print_exp_tran_dvec(2*ni[i], tmp_fun_vec, 0);
-//		blasfeo_print_exp_tran_dvec(2*ni[i], work->weights_nlp_out->lam+i, 0);
-		for(j=0; j<2*ni[i]; j++)
-		{
-			tmp = BLASFEO_DVECEL(tmp_fun_vec, j);
-			tmp = tmp>0.0 ? tmp : 0.0;
-//			printf("\n%e %e\n", fabs(BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j)), fabs(BLASFEO_DVECEL(tmp_fun_vec, j)));
-			constr_fun += fabs(BLASFEO_DVECEL(work->weights_nlp_out->lam+i, j)) * tmp;
-		}
-	}
+// l1 penalty of the constraint violation at one stage, weighted with the merit function weights
+static double ocp_nlp_merit_penalty_stage(int nx1, int ni, struct blasfeo_dvec *dyn_fun,
+                                          struct blasfeo_dvec *ineq_fun, struct blasfeo_dvec *w_pi,
+                                          struct blasfeo_dvec *w_lam)
+{
+    int j;
+    double tmp;
+
+    double penalty = 0.0;
 
-	merit_fun = cost_fun + dyn_fun + constr_fun;
+    // dynamics
+    for (j = 0; j < nx1; j++)
+    {
+        penalty += fabs(BLASFEO_DVECEL(w_pi, j)) * fabs(BLASFEO_DVECEL(dyn_fun, j));
+    }
 
-	printf("\n%e %e %e %e\n", merit_fun, cost_fun, dyn_fun, constr_fun);
+    // constraints: only the violated ones
+    for (j = 0; j < 2 * ni; j++)
+    {
+        tmp = BLASFEO_DVECEL(ineq_fun, j);
+        tmp = tmp > 0.0 ? tmp : 0.0;
+        penalty += fabs(BLASFEO_DVECEL(w_lam, j)) * tmp;
+    }
 
-	return merit_fun;
+    return penalty;
 }
 
 
 
-void ocp_nlp_update_variables_sqp(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+void ocp_nlp_update_merit_weights(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
             ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int i, j;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *ni = dims->ni;
+
+    double tmp0, tmp1;
+
+    // weights are the (absolute) qp multipliers at the first sqp iteration, then they are kept
+    // larger than the mean of the previous weights and the new multipliers
+    int init = *mem->sqp_iter == 0;
+
+    for (i = 0; i <= N; i++)
+    {
+        if (i < N)
+        {
+            for (j = 0; j < nx[i+1]; j++)
+            {
+                tmp1 = fabs(BLASFEO_DVECEL(mem->qp_out->pi+i, j));
+                if (!init)
+                {
+                    tmp0 = fabs(BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j));
+                    tmp1 = 0.5 * (tmp0 + tmp1);
+                    tmp1 = tmp0 > tmp1 ? tmp0 : tmp1;
+                }
+                BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j) = tmp1;
+            }
+        }
+        for (j = 0; j < 2*ni[i]; j++)
+        {
+            tmp1 = fabs(BLASFEO_DVECEL(mem->qp_out->lam+i, j));
+            if (!init)
+            {
+                tmp0 = fabs(BLASFEO_DVECEL(work->weights_nlp_out->lam+i, j));
+                tmp1 = 0.5 * (tmp0 + tmp1);
+                tmp1 = tmp0 > tmp1 ? tmp0 : tmp1;
+            }
+            BLASFEO_DVECEL(work->weights_nlp_out->lam+i, j) = tmp1;
+        }
+    }
+
+    return;
+}
+
+
+
+double ocp_nlp_evaluate_merit_fun(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                  ocp_nlp_in *in, ocp_nlp_out *out, ocp_nlp_opts *opts,
+                                  ocp_nlp_memory *mem, ocp_nlp_workspace *work)
 {
     int i;
 
     int N = dims->N;
-    int *nv = dims->nv;
     int *nx = dims->nx;
-    int *nu = dims->nu;
     int *ni = dims->ni;
-    int *nz = dims->nz;
 
-    // ocp_nlp_config *config = (ocp_nlp_config *) config_;
+    // compute fun value at the point in tmp_nlp_out
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i=0; i<=N; i++)
+    {
+        // cost
+        config->cost[i]->compute_fun(config->cost[i], dims->cost[i], in->cost[i], opts->cost[i], mem->cost[i], work->cost[i]);
+
+        // dynamics
+        if (i < N)
+            config->dynamics[i]->compute_fun(config->dynamics[i], dims->dynamics[i], in->dynamics[i], opts->dynamics[i], mem->dynamics[i], work->dynamics[i]);
 
-	// (fixed) step length
-    double alpha = opts->step_length;
+        // constr
+        config->constraints[i]->compute_fun(config->constraints[i], dims->constraints[i],
+                                            in->constraints[i], opts->constraints[i],
+                                            mem->constraints[i], work->constraints[i]);
+    }
 
-#if 0 // XXX test piece of code
-	double tmp0, tmp1;
+    double *tmp_fun;
+    struct blasfeo_dvec *dyn_fun;
+    struct blasfeo_dvec *ineq_fun;
 
-	// current point
-    for (i = 0; i <= N; i++)
+    double merit_fun = 0.0;
+
+    for (i=0; i<=N; i++)
+    {
+        tmp_fun = config->cost[i]->memory_get_fun_ptr(mem->cost[i]);
+        merit_fun += *tmp_fun;
+
+        dyn_fun = i < N ? config->dynamics[i]->memory_get_fun_ptr(mem->dynamics[i]) : NULL;
+        ineq_fun = config->constraints[i]->memory_get_fun_ptr(mem->constraints[i]);
+        merit_fun += ocp_nlp_merit_penalty_stage(i < N ? nx[i+1] : 0, ni[i], dyn_fun, ineq_fun,
+                                                 work->weights_nlp_out->pi+i,
+                                                 work->weights_nlp_out->lam+i);
+    }
+
+    return merit_fun;
+}
+
+
+
+double ocp_nlp_evaluate_merit_fun_lin(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                      ocp_nlp_in *in, ocp_nlp_out *out, ocp_nlp_opts *opts,
+                                      ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int i;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nv = dims->nv;
+    int *ni = dims->ni;
+
+    // cost at the point in out, constraint values from the last linearization
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i=0; i<=N; i++)
+    {
         blasfeo_dveccp(nv[i], out->ux+i, 0, work->tmp_nlp_out->ux+i, 0);
-    
-	for (i = 0; i < N; i++)
-		blasfeo_dveccp(nx[i+1], out->pi+i, 0, work->tmp_nlp_out->pi+i, 0);
+        config->cost[i]->compute_fun(config->cost[i], dims->cost[i], in->cost[i], opts->cost[i], mem->cost[i], work->cost[i]);
+    }
 
-	for (i = 0; i <= N; i++)
-		blasfeo_dveccp(2*ni[i], out->lam+i, 0, work->tmp_nlp_out->lam+i, 0);
+    double *tmp_fun;
 
-        // linear update of algebraic variables using state and input sensitivity
-//        if (i < N)
-//        {
-//            blasfeo_dgemv_t(nu[i]+nx[i], nz[i], alpha, mem->dzduxt+i, 0, 0, mem->qp_out->ux+i, 0, 1.0, mem->z_alg+i, 0, out->z+i, 0); 
-//        }
+    double merit_fun = 0.0;
 
-	// initialize weights
-	if(mem->sqp_iter[0]==0)
-	{
-		for (i = 0; i < N; i++)
-			blasfeo_dveccp(nx[i+1], out->pi+i, 0, work->weights_nlp_out->pi+i, 0);
+    for (i=0; i<=N; i++)
+    {
+        tmp_fun = config->cost[i]->memory_get_fun_ptr(mem->cost[i]);
+        merit_fun += *tmp_fun;
 
-		for (i = 0; i <= N; i++)
-			blasfeo_dveccp(2*ni[i], out->lam+i, 0, work->weights_nlp_out->lam+i, 0);
-	}
+        merit_fun += ocp_nlp_merit_penalty_stage(i < N ? nx[i+1] : 0, ni[i], mem->dyn_fun+i,
+                                                 mem->ineq_fun+i, work->weights_nlp_out->pi+i,
+                                                 work->weights_nlp_out->lam+i);
+    }
 
-	// update weigths
-	for (i = 0; i < N; i++)
-	{
-		for(j=0; j<nx[i+1]; j++)
-		{
-			tmp0 = fabs(BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j));
-			tmp1 = 0.5 * (tmp0 + fabs(BLASFEO_DVECEL(mem->qp_out->pi+i, j)));
-			BLASFEO_DVECEL(work->weights_nlp_out->pi+i, j) = tmp0>tmp1 ? tmp0 : tmp1;
-		}
-	}
-	for (i = 0; i <= N; i++)
-	{
-		for(j=0; j<2*ni[i]; j++)
-		{
-			tmp0 = fabs(BLASFEO_DVECEL(work->weights_nlp_out->lam+i, j));
-			tmp1 = 0.5 * (tmp0 + fabs(BLASFEO_DVECEL(mem->qp_out->lam+i, j)));
-			BLASFEO_DVECEL(work->weights_nlp_out->lam+i, j) = tmp0>tmp1 ? tmp0 : tmp1;
-		}
-	}
+    return merit_fun;
+}
 
-	printf("\n\nmerit fun value\n");
-	double merit_fun0 = ocp_nlp_evaluate_merit_fun(config, dims, in, out, opts, mem, work);
 
-	double alpha_min = 0.2;
 
-	for (j=0; j<10 & alpha>alpha_min; j++)
-	{
+double ocp_nlp_merit_fun_dir_der(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+            ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int i;
 
-		for (i = 0; i <= N; i++)
-			blasfeo_daxpy(nv[i], alpha, mem->qp_out->ux+i, 0, out->ux+i, 0, work->tmp_nlp_out->ux+i, 0);
-
-		printf("\n%d tmp merit fun value\n", j);
-		double merit_fun1 = ocp_nlp_evaluate_merit_fun(config, dims, in, out, opts, mem, work);
-
-		if(merit_fun1 < merit_fun0)
-		{
-			break;
-		}
-		else
-		{
-			alpha *= 0.7;
-		}
-	
-	}
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nv = dims->nv;
+    int *ni = dims->ni;
 
-	printf("\nalpha %f\n", alpha);
+    // cost gradient times step, minus the penalty at the linearization point (the step satisfies
+    // the linearized constraints)
+    double dir_der = 0.0;
 
-#endif
+    for (i=0; i<=N; i++)
+    {
+        dir_der += blasfeo_ddot(nv[i], mem->cost_grad+i, 0, mem->qp_out->ux+i, 0);
 
+        dir_der -= ocp_nlp_merit_penalty_stage(i < N ? nx[i+1] : 0, ni[i], mem->dyn_fun+i,
+                                               mem->ineq_fun+i, work->weights_nlp_out->pi+i,
+                                               work->weights_nlp_out->lam+i);
+    }
+
+    return dir_der;
+}
 
 
 
+void ocp_nlp_update_variables_sqp(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+            ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work,
+            double alpha)
+{
+    int i;
+
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
+    int *nz = dims->nz;
 
+    // ocp_nlp_config *config = (ocp_nlp_config *) config_;
 
 #if defined(ACADOS_WITH_OPENMP)
     #pragma omp parallel for
@@ -2191,6 +2703,237 @@ void ocp_nlp_update_variables_sqp(ocp_nlp_config *config, ocp_nlp_dims *dims, oc
 
 
 
+// stage ii holds the iterate of stage ii+1 after the shift: convert it to the layout of stage ii
+static void ocp_nlp_shift_stage_layout(ocp_nlp_dims *dims, ocp_nlp_out *out, ocp_nlp_memory *mem, int ii)
+{
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ns = dims->ns;
+    int *ni = dims->ni;
+    int *nz = dims->nz;
+
+    int jj = ii + 1;
+
+    // primal variables [u, x, sl, su]
+    if (nu[ii] != nu[jj] || nx[ii] != nx[jj] || ns[ii] != ns[jj])
+    {
+        int nu_min = nu[ii] < nu[jj] ? nu[ii] : nu[jj];
+        int nx_min = nx[ii] < nx[jj] ? nx[ii] : nx[jj];
+
+        blasfeo_dveccp(nv[jj], out->ux+ii, 0, &mem->shift_tmp, 0);
+        blasfeo_dvecse(nv[ii], 0.0, out->ux+ii, 0);
+        blasfeo_dveccp(nu_min, &mem->shift_tmp, 0, out->ux+ii, 0);
+        blasfeo_dveccp(nx_min, &mem->shift_tmp, nu[jj], out->ux+ii, nu[ii]);
+        if (ns[ii] == ns[jj])
+            blasfeo_dveccp(2*ns[ii], &mem->shift_tmp, nu[jj]+nx[jj], out->ux+ii, nu[ii]+nx[ii]);
+    }
+
+    // multipliers and slacks of the inequalities
+    if (ni[ii] != ni[jj])
+    {
+        blasfeo_dvecse(2*ni[ii], 0.0, out->lam+ii, 0);
+        blasfeo_dvecse(2*ni[ii], 0.0, out->t+ii, 0);
+    }
+
+    // algebraic variables and integrator guesses
+    if (nz[ii] != nz[jj])
+        blasfeo_dvecse(nz[ii], 0.0, out->z+ii, 0);
+
+    if (nx[ii] != nx[jj] || nz[ii] != nz[jj])
+    {
+        blasfeo_dvecse(nx[ii]+nz[ii], 0.0, mem->sim_guess+ii, 0);
+        mem->set_sim_guess[ii] = false;
+    }
+
+    return;
+}
+
+
+
+// terminal state from the dynamics of the last stage
+static void ocp_nlp_shift_simulate(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+            ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int N = dims->N;
+
+    // with zero next state the dynamics residual is the simulated state
+    blasfeo_dvecse(dims->nv[N], 0.0, work->tmp_nlp_out->ux+N, 0);
+
+    config->dynamics[N-1]->memory_set_tmp_ux_ptr(out->ux+N-1, mem->dynamics[N-1]);
+    config->dynamics[N-1]->memory_set_tmp_ux1_ptr(work->tmp_nlp_out->ux+N, mem->dynamics[N-1]);
+
+    config->dynamics[N-1]->compute_fun(config->dynamics[N-1], dims->dynamics[N-1], in->dynamics[N-1],
+                                       opts->dynamics[N-1], mem->dynamics[N-1], work->dynamics[N-1]);
+
+    struct blasfeo_dvec *fun = config->dynamics[N-1]->memory_get_fun_ptr(mem->dynamics[N-1]);
+    blasfeo_dveccp(dims->nx[N], fun, 0, out->ux+N, dims->nu[N]);
+
+    // restore alias to the trial iterate
+    config->dynamics[N-1]->memory_set_tmp_ux_ptr(work->tmp_nlp_out->ux+N-1, mem->dynamics[N-1]);
+
+    return;
+}
+
+
+
+// feedback on the controls of the last stage from one Riccati step with the terminal Hessian,
+// terminal state from the linearized dynamics (both from the last qp)
+static void ocp_nlp_shift_lqr(ocp_nlp_dims *dims, ocp_nlp_out *out, ocp_nlp_memory *mem)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int nu0 = nu[N-1];
+    int nx0 = nx[N-1];
+    int nv0 = nu0 + nx0;
+
+    // the last linearization point is at stage N-2 after the shift
+    if (nx[N-2] != nx0)
+        return;
+
+    struct blasfeo_dmat *BAbt = mem->qp_in->BAbt+N-1;
+    struct blasfeo_dmat *RSQrq = mem->qp_in->RSQrq+N-1;
+
+    // state deviation from the linearization point
+    blasfeo_dvecse(nu0, 0.0, &mem->shift_dux, 0);
+    blasfeo_daxpy(nx0, -1.0, out->ux+N-2, nu[N-2], out->ux+N-1, nu0, &mem->shift_dux, nu0);
+
+    // H = RSQ + [B A]^T P [B A]
+    blasfeo_dgecp(nx[N], nx[N], mem->qp_in->RSQrq+N, nu[N], nu[N], &mem->shift_P, 0, 0);
+    blasfeo_dtrtr_l(nx[N], &mem->shift_P, 0, 0, &mem->shift_P, 0, 0);
+    blasfeo_dgemm_nn(nv0, nx[N], nx[N], 1.0, BAbt, 0, 0, &mem->shift_P, 0, 0, 0.0,
+                     &mem->shift_BAbtP, 0, 0, &mem->shift_BAbtP, 0, 0);
+    blasfeo_dsyrk_ln(nv0, nx[N], 1.0, &mem->shift_BAbtP, 0, 0, BAbt, 0, 0, 1.0, RSQrq, 0, 0,
+                     &mem->shift_H, 0, 0);
+
+    // du = - H_uu^{-1} H_xu^T dx
+    blasfeo_dpotrf_l(nu0, &mem->shift_H, 0, 0, &mem->shift_H, 0, 0);
+    blasfeo_dgemv_t(nx0, nu0, -1.0, &mem->shift_H, nu0, 0, &mem->shift_dux, nu0, 0.0, &mem->shift_dux, 0,
+                    &mem->shift_dux, 0);
+    blasfeo_dtrsv_lnn(nu0, &mem->shift_H, 0, 0, &mem->shift_dux, 0, &mem->shift_dux, 0);
+    blasfeo_dtrsv_ltn(nu0, &mem->shift_H, 0, 0, &mem->shift_dux, 0, &mem->shift_dux, 0);
+
+    // u += du, x_N += B du + A dx
+    blasfeo_daxpy(nu0, 1.0, &mem->shift_dux, 0, out->ux+N-1, 0, out->ux+N-1, 0);
+    blasfeo_dgemv_t(nv0, nx[N], 1.0, BAbt, 0, 0, &mem->shift_dux, 0, 1.0, out->ux+N, nu[N], out->ux+N, nu[N]);
+
+    return;
+}
+
+
+
+void ocp_nlp_shift_horizon(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+            ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work)
+{
+    int ii;
+
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ns = dims->ns;
+    int *ni = dims->ni;
+    int *nz = dims->nz;
+
+    if (N < 1)
+        return;
+
+    // move the windows: stage ii now holds the iterate of stage ii+1, stage N the one of stage 0
+    out->ring_head = (out->ring_head + 1) % (N + 1);
+    out->ux = out->ux_ring + out->ring_head;
+    out->z = out->z_ring + out->ring_head;
+    out->lam = out->lam_ring + out->ring_head;
+    out->t = out->t_ring + out->ring_head;
+
+    out->ring_head_pi = (out->ring_head_pi + 1) % N;
+    out->pi = out->pi_ring + out->ring_head_pi;
+
+    mem->sim_guess_head = (mem->sim_guess_head + 1) % (N + 1);
+    mem->sim_guess = mem->sim_guess_ring + mem->sim_guess_head;
+    for (ii = 0; ii < N; ii++)
+        mem->set_sim_guess[ii] = mem->set_sim_guess[ii+1];
+    mem->set_sim_guess[N] = false;
+
+    // terminal stage: previous terminal iterate
+    blasfeo_dveccp(nv[N], out->ux+N-1, 0, out->ux+N, 0);
+    blasfeo_dveccp(nz[N], out->z+N-1, 0, out->z+N, 0);
+    blasfeo_dveccp(2*ni[N], out->lam+N-1, 0, out->lam+N, 0);
+    blasfeo_dveccp(2*ni[N], out->t+N-1, 0, out->t+N, 0);
+    blasfeo_dveccp(nx[N]+nz[N], mem->sim_guess+N-1, 0, mem->sim_guess+N, 0);
+
+    // stages with a layout different from the next one (typically the first)
+    for (ii = 0; ii < N-1; ii++)
+        ocp_nlp_shift_stage_layout(dims, out, mem, ii);
+
+    // last stage: previous terminal state, everything else from the previous last stage
+    blasfeo_dvecse(nv[N-1], 0.0, out->ux+N-1, 0);
+    blasfeo_dveccp(nx[N-1] < nx[N] ? nx[N-1] : nx[N], out->ux+N, nu[N], out->ux+N-1, nu[N-1]);
+    if (N > 1)
+    {
+        if (nu[N-1] == nu[N-2])
+            blasfeo_dveccp(nu[N-1], out->ux+N-2, 0, out->ux+N-1, 0);
+        if (ns[N-1] == ns[N-2])
+            blasfeo_dveccp(2*ns[N-1], out->ux+N-2, nu[N-2]+nx[N-2], out->ux+N-1, nu[N-1]+nx[N-1]);
+        if (nx[N] == nx[N-1])
+            blasfeo_dveccp(nx[N], out->pi+N-2, 0, out->pi+N-1, 0);
+    }
+    if (N > 1 && ni[N-1] == ni[N-2])
+    {
+        blasfeo_dveccp(2*ni[N-1], out->lam+N-2, 0, out->lam+N-1, 0);
+        blasfeo_dveccp(2*ni[N-1], out->t+N-2, 0, out->t+N-1, 0);
+    }
+    else
+    {
+        blasfeo_dvecse(2*ni[N-1], 0.0, out->lam+N-1, 0);
+        blasfeo_dvecse(2*ni[N-1], 0.0, out->t+N-1, 0);
+    }
+    if (N > 1 && nz[N-1] == nz[N-2])
+        blasfeo_dveccp(nz[N-1], out->z+N-2, 0, out->z+N-1, 0);
+    else
+        blasfeo_dvecse(nz[N-1], 0.0, out->z+N-1, 0);
+    if (N > 1 && nx[N-1] == nx[N-2] && nz[N-1] == nz[N-2])
+    {
+        blasfeo_dveccp(nx[N-1]+nz[N-1], mem->sim_guess+N-2, 0, mem->sim_guess+N-1, 0);
+        mem->set_sim_guess[N-1] = mem->set_sim_guess[N-2];
+    }
+
+    // terminal stage policy
+    if (opts->shift_policy == SHIFT_SIMULATE)
+        ocp_nlp_shift_simulate(config, dims, in, out, opts, mem, work);
+    else if (opts->shift_policy == SHIFT_LQR && N > 1)
+        ocp_nlp_shift_lqr(dims, out, mem);
+
+    return;
+}
+
+
+
+// shift of the nlp solvers (config->shift): their opts, memory and workspace start with pointers to
+// the ocp_nlp_opts, ocp_nlp_memory and ocp_nlp_workspace, the latter set when the workspace is
+// cast (in precompute)
+void ocp_nlp_common_shift(void *config_, void *dims_, void *nlp_in_, void *nlp_out_, void *opts_,
+            void *mem_, void *work_)
+{
+    ocp_nlp_opts *nlp_opts = *(ocp_nlp_opts **) opts_;
+    ocp_nlp_memory *nlp_mem = *(ocp_nlp_memory **) mem_;
+    ocp_nlp_workspace *nlp_work = *(ocp_nlp_workspace **) work_;
+
+    // the nlp workspace is cast by the precompute and solve functions of the solvers
+    if (nlp_work == NULL)
+    {
+        printf("\nerror: ocp_nlp_shift: solver workspace not initialized, call ocp_nlp_precompute first\n");
+        exit(1);
+    }
+
+    ocp_nlp_shift_horizon(config_, dims_, nlp_in_, nlp_out_, nlp_opts, nlp_mem, nlp_work);
+
+    return;
+}
+
+
+
 /************************************************
  * residuals
  ************************************************/
@@ -90,6 +90,10 @@ typedef struct
     // evaluate solver // TODO rename into solve
     int (*evaluate)(void *config, void *dims, void *nlp_in, void *nlp_out, void *opts_, void *mem, void *work);
     void (*eval_param_sens)(void *config, void *dims, void *opts_, void *mem, void *work, char *field, int stage, int index, void *sens_nlp_out);
+    // first-order corrected control at stage 0 for a new initial state (NULL if not supported)
+    int (*advanced_step)(void *config, void *dims, void *opts_, void *mem, void *work, double *x0, double *u0);
+    // shift the iterate by one stage (NULL if not supported)
+    void (*shift)(void *config, void *dims, void *nlp_in, void *nlp_out, void *opts_, void *mem, void *work);
     // prepare memory
     int (*precompute)(void *config, void *dims, void *nlp_in, void *nlp_out, void *opts_, void *mem, void *work);
     // initalize this struct with default values
@@ -131,6 +135,7 @@ typedef struct
     int *ni;  // number of two-sided inequality constraints: nb+ng+nh+ns
     int *nz;  // number of algebraic variables
     int *ns;  // number of slack variables
+    int *np;  // number of parameters of the external functions
     int N;    // number of shooting nodes
 } ocp_nlp_dims;
 
@@ -144,7 +149,8 @@ ocp_nlp_dims *ocp_nlp_dims_assign(void *config, void *raw_memory);
 ///
 /// \param config_ The configuration struct.
 /// \param dims_ The dimension struct.
-/// \param field The type of optimization variables, either nx, nu, nz, or ns.
+/// \param field The type of optimization variables, either nx, nu, nz, or ns;
+///              or np, the number of parameters of the external functions.
 /// \param value_array Number of variables for each stage.
 void ocp_nlp_dims_set_opt_vars(void *config_, void *dims_,
                                const char *field, const void* value_array);
@@ -185,6 +191,9 @@ void ocp_nlp_dims_set_dynamics(void *config_, void *dims_, int stage, const char
  * Inputs to the non-linear program
  ************************************************/
 
+/// Maximum number of batched external functions registered in ocp_nlp_in.
+#define OCP_NLP_EXT_FUN_BATCH_MAX 8
+
 /// Struct for storing the inputs of a non-linear program.
 typedef struct
 {
@@ -200,6 +209,21 @@ typedef struct
     /// Pointers to constraints functions (TBC).
     void **constraints;
 
+    /// Stage-wise modification counters of the models, incremented whenever model data entering
+    /// the qp matrices is set (references and bounds only enter the qp vectors and are not counted).
+    int *dynamics_version;
+    int *cost_version;
+    int *constraints_version;
+
+    /// Stage-wise copy of the parameters of the external functions, as set through
+    /// ocp_nlp_in_set "parameter_values" (which also increments the modification counters).
+    double **parameter_values;
+
+    /// External functions batched over the nodes, as set through ocp_nlp_in_set "ext_fun_batch":
+    /// evaluated at all the nodes at once before the stage-wise linearization.
+    external_function_casadi_batch *ext_fun_batch[OCP_NLP_EXT_FUN_BATCH_MAX];
+    int ext_fun_batch_num;
+
 } ocp_nlp_in;
 
 //
@@ -224,6 +248,17 @@ typedef struct
     struct blasfeo_dvec *lam;
     struct blasfeo_dvec *t;  // slacks of inequalities
 
+    // ring buffer layout: the stage arrays above are windows into twice as many vector headers,
+    // headers j and j+N+1 (j+N for pi) share one buffer sized for the largest stage, so that
+    // shifting the horizon moves the windows instead of the data (see ocp_nlp_shift_horizon)
+    struct blasfeo_dvec *ux_ring;
+    struct blasfeo_dvec *z_ring;
+    struct blasfeo_dvec *pi_ring;
+    struct blasfeo_dvec *lam_ring;
+    struct blasfeo_dvec *t_ring;
+    int ring_head;     // buffer of stage 0 (ux, z, lam, t)
+    int ring_head_pi;  // buffer of stage 0 (pi)
+
     int sqp_iter;
     int qp_iter;
     double inf_norm_res;
@@ -243,6 +278,14 @@ ocp_nlp_out *ocp_nlp_out_assign(ocp_nlp_config *config, ocp_nlp_dims *dims,
  * options
  ************************************************/
 
+// initialization of the terminal stage when shifting the horizon
+typedef enum
+{
+    SHIFT_COPY,      // keep the previous terminal state
+    SHIFT_SIMULATE,  // simulate the dynamics of the last stage
+    SHIFT_LQR,       // LQR feedback on the last stage, from the last qp linearization
+} ocp_nlp_shift_t;
+
 typedef struct
 {
 //    void *qp_solver_opts; // xcond solver opts instead ???
@@ -254,6 +297,9 @@ typedef struct
     double step_length;  // (fixed) step length in SQP loop
     int reuse_workspace;
     int num_threads;
+    int shift_policy;    // ocp_nlp_shift_t
+    int tightening_stage;    // partial tightening from this stage on, disabled if <= 0
+    double tightening_mu;    // barrier parameter of the partial tightening
 
 } ocp_nlp_opts;
 
@@ -301,6 +347,25 @@ typedef struct
 
     bool *set_sim_guess; // indicate if there is new explicitly provided guess for integration variables
     struct blasfeo_dvec *sim_guess;
+    struct blasfeo_dvec *sim_guess_ring; // ring buffer layout as in ocp_nlp_out
+    int sim_guess_head;
+
+    // horizon shift
+    struct blasfeo_dmat shift_P;     // terminal Hessian
+    struct blasfeo_dmat shift_BAbtP;
+    struct blasfeo_dmat shift_H;     // cost-to-go Hessian of the last stage
+    struct blasfeo_dvec shift_dux;
+    struct blasfeo_dvec shift_tmp;
+
+    // model versions the modules were last initialized with, modules of unchanged models keep
+    // their precomputed data (e.g. Gauss-Newton Hessian, constant constraint matrix)
+    int *dynamics_version;
+    int *cost_version;
+    int *constraints_version;
+    ocp_nlp_in *version_in;  // nlp_in the versions refer to
+    int qp_mat_const;        // qp matrices do not depend on the iterate
+    int qp_mat_valid;        // qp matrices of the last approximation are still valid
+    int qp_mat_unchanged;    // qp matrices are equal to the ones of the previous qp
 
 	int *sqp_iter; // pointer to iteration number
 
@@ -354,12 +419,42 @@ void ocp_nlp_approximate_qp_vectors_sqp(ocp_nlp_config *config, ocp_nlp_dims *di
 //
 void ocp_nlp_embed_initial_value(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
                  ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// partial tightening: replace the inequality constraints of the stages >= opts->tightening_stage
+// by a log-barrier in the qp hessian (matrices) and gradient (vectors, also relaxes the bounds)
+void ocp_nlp_tightening_qp_matrices(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+                 ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
 //
+void ocp_nlp_tightening_qp_vectors(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+                 ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// relaxes the bounds of the tightened constraints only, e.g. after the qp rhs has been rebuilt
+void ocp_nlp_tightening_qp_bounds(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+                 ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// barrier multipliers and slacks of the tightened constraints in the qp solution
+void ocp_nlp_tightening_qp_sol(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+                 ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// step of length alpha along the qp solution (primal step, absolute duals)
 void ocp_nlp_update_variables_sqp(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
-           ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
-//
+           ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work,
+           double alpha);
+// update the weights of the l1 merit function (in work->weights_nlp_out) from the qp multipliers
+void ocp_nlp_update_merit_weights(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+          ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// l1 merit function at the point in work->tmp_nlp_out (overwrites the fun values in the module memories)
 double ocp_nlp_evaluate_merit_fun(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
           ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// l1 merit function at the linearization point out (only the cost is evaluated)
+double ocp_nlp_evaluate_merit_fun_lin(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+          ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// directional derivative of the l1 merit function along the qp step
+double ocp_nlp_merit_fun_dir_der(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+          ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// shift the iterate (and the integrator guesses) by one stage, the terminal stage is initialized
+// according to opts->shift_policy
+void ocp_nlp_shift_horizon(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+          ocp_nlp_out *out, ocp_nlp_opts *opts, ocp_nlp_memory *mem, ocp_nlp_workspace *work);
+// ocp_nlp_shift_horizon as config->shift of the nlp solvers
+void ocp_nlp_common_shift(void *config_, void *dims_, void *nlp_in_, void *nlp_out_, void *opts_,
+          void *mem_, void *work_);
 
 
 
@@ -665,6 +665,125 @@ int ocp_nlp_constraints_bgh_model_set(void *config_, void *dims_,
 }
 
 
+int ocp_nlp_constraints_bgh_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len)
+{
+    ocp_nlp_constraints_bgh_dims *dims = (ocp_nlp_constraints_bgh_dims *) dims_;
+    ocp_nlp_constraints_bgh_model *model = (ocp_nlp_constraints_bgh_model *) model_;
+
+    int nb = dims->nb;
+    int ng = dims->ng;
+    int nh = dims->nh;
+    int ns = dims->ns;
+    int nsbu = dims->nsbu;
+    int nsbx = dims->nsbx;
+    int nsg = dims->nsg;
+    int nsh = dims->nsh;
+    int nbx = dims->nbx;
+    int nbu = dims->nbu;
+
+    // same layout as in ocp_nlp_constraints_bgh_model_set
+    if (!strcmp(field, "lb"))
+    {
+        *len = nb;
+        *offset = 0;
+    }
+    else if (!strcmp(field, "ub"))
+    {
+        *len = nb;
+        *offset = nb+ng+nh;
+    }
+    else if (!strcmp(field, "lbx"))
+    {
+        *len = nbx;
+        *offset = nbu;
+    }
+    else if (!strcmp(field, "ubx"))
+    {
+        *len = nbx;
+        *offset = nb+ng+nh+nbu;
+    }
+    else if (!strcmp(field, "lbu"))
+    {
+        *len = nbu;
+        *offset = 0;
+    }
+    else if (!strcmp(field, "ubu"))
+    {
+        *len = nbu;
+        *offset = nb+ng+nh;
+    }
+    else if (!strcmp(field, "lg"))
+    {
+        *len = ng;
+        *offset = nb;
+    }
+    else if (!strcmp(field, "ug"))
+    {
+        *len = ng;
+        *offset = 2*nb+ng+nh;
+    }
+    else if (!strcmp(field, "lh"))
+    {
+        *len = nh;
+        *offset = nb+ng;
+    }
+    else if (!strcmp(field, "uh"))
+    {
+        *len = nh;
+        *offset = 2*nb+2*ng+nh;
+    }
+    else if (!strcmp(field, "lsbu"))
+    {
+        *len = nsbu;
+        *offset = 2*nb+2*ng+2*nh;
+    }
+    else if (!strcmp(field, "usbu"))
+    {
+        *len = nsbu;
+        *offset = 2*nb+2*ng+2*nh+ns;
+    }
+    else if (!strcmp(field, "lsbx"))
+    {
+        *len = nsbx;
+        *offset = 2*nb+2*ng+2*nh+nsbu;
+    }
+    else if (!strcmp(field, "usbx"))
+    {
+        *len = nsbx;
+        *offset = 2*nb+2*ng+2*nh+ns+nsbu;
+    }
+    else if (!strcmp(field, "lsg"))
+    {
+        *len = nsg;
+        *offset = 2*nb+2*ng+2*nh+nsbu+nsbx;
+    }
+    else if (!strcmp(field, "usg"))
+    {
+        *len = nsg;
+        *offset = 2*nb+2*ng+2*nh+ns+nsbu+nsbx;
+    }
+    else if (!strcmp(field, "lsh"))
+    {
+        *len = nsh;
+        *offset = 2*nb+2*ng+2*nh+nsbu+nsbx+nsg;
+    }
+    else if (!strcmp(field, "ush"))
+    {
+        *len = nsh;
+        *offset = 2*nb+2*ng+2*nh+ns+nsbu+nsbx+nsg;
+    }
+    else
+    {
+        return ACADOS_FAILURE;
+    }
+
+    *vec = &model->d;
+
+    return ACADOS_SUCCESS;
+}
+
+
 /************************************************
  * options
  ************************************************/
@@ -1283,16 +1402,27 @@ void ocp_nlp_constraints_bgh_compute_fun(void *config_, void *dims_, void *model
     blasfeo_daxpy(nb+ng+nh, -1.0, &model->d, nb+ng+nh, &work->tmp_ni, 0, &memory->fun, nb+ng+nh);
 
     // soft
-    blasfeo_dvecad_sp(ns, -1.0, memory->ux, nu+nx, model->idxs, &memory->fun, 0);
-    blasfeo_dvecad_sp(ns, -1.0, memory->ux, nu+nx+ns, model->idxs, &memory->fun, nb+ng+nh);
+    blasfeo_dvecad_sp(ns, -1.0, memory->tmp_ux, nu+nx, model->idxs, &memory->fun, 0);
+    blasfeo_dvecad_sp(ns, -1.0, memory->tmp_ux, nu+nx+ns, model->idxs, &memory->fun, nb+ng+nh);
 
-    blasfeo_daxpy(2*ns, -1.0, memory->ux, nu+nx, &model->d, 2*nb+2*ng+2*nh, &memory->fun, 2*nb+2*ng+2*nh);
+    blasfeo_daxpy(2*ns, -1.0, memory->tmp_ux, nu+nx, &model->d, 2*nb+2*ng+2*nh, &memory->fun, 2*nb+2*ng+2*nh);
 
     return;
 }
 
 
 
+int ocp_nlp_constraints_bgh_constant_qp_matrices(void *config_, void *dims_, void *model_,
+                                            void *opts_)
+{
+    ocp_nlp_constraints_bgh_dims *dims = dims_;
+
+    // DCt is copied in initialize, only the nonlinear constraints are linearized
+    return dims->nh == 0;
+}
+
+
+
 void ocp_nlp_constraints_bgh_bounds_update(void *config_, void *dims_, void *model_,
                                             void *opts_, void *memory_, void *work_)
 {
@@ -1335,6 +1465,7 @@ void ocp_nlp_constraints_bgh_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_constraints_bgh_model_calculate_size;
     config->model_assign = &ocp_nlp_constraints_bgh_model_assign;
     config->model_set = &ocp_nlp_constraints_bgh_model_set;
+    config->model_get_vec = &ocp_nlp_constraints_bgh_model_get_vec;
     config->opts_calculate_size = &ocp_nlp_constraints_bgh_opts_calculate_size;
     config->opts_assign = &ocp_nlp_constraints_bgh_opts_assign;
     config->opts_initialize_default = &ocp_nlp_constraints_bgh_opts_initialize_default;
@@ -1358,6 +1489,7 @@ void ocp_nlp_constraints_bgh_config_initialize_default(void *config_)
     config->initialize = &ocp_nlp_constraints_bgh_initialize;
     config->update_qp_matrices = &ocp_nlp_constraints_bgh_update_qp_matrices;
     config->compute_fun = &ocp_nlp_constraints_bgh_compute_fun;
+    config->constant_qp_matrices = &ocp_nlp_constraints_bgh_constant_qp_matrices;
     config->bounds_update = &ocp_nlp_constraints_bgh_bounds_update;
     config->config_initialize_default = &ocp_nlp_constraints_bgh_config_initialize_default;
 
@@ -111,6 +111,9 @@ void *ocp_nlp_constraints_bgh_model_assign(void *config, void *dims, void *raw_m
 //
 int ocp_nlp_constraints_bgh_model_set(void *config_, void *dims_,
                          void *model_, const char *field, void *value);
+//
+int ocp_nlp_constraints_bgh_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len);
 
 
 
@@ -219,6 +222,9 @@ void ocp_nlp_constraints_bgh_update_qp_matrices(void *config_, void *dims, void
 void ocp_nlp_constraints_bgh_compute_fun(void *config_, void *dims, void *model_,
                                             void *opts_, void *memory_, void *work_);
 //
+int ocp_nlp_constraints_bgh_constant_qp_matrices(void *config_, void *dims, void *model_,
+                                            void *opts_);
+//
 void ocp_nlp_constraints_bgh_bounds_update(void *config_, void *dims, void *model_,
                                             void *opts_, void *memory_, void *work_);
 
@@ -660,6 +660,126 @@ int ocp_nlp_constraints_bgp_model_set(void *config_, void *dims_,
 
 
 
+int ocp_nlp_constraints_bgp_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len)
+{
+    ocp_nlp_constraints_bgp_dims *dims = (ocp_nlp_constraints_bgp_dims *) dims_;
+    ocp_nlp_constraints_bgp_model *model = (ocp_nlp_constraints_bgp_model *) model_;
+
+    int nb = dims->nb;
+    int ng = dims->ng;
+    int nphi = dims->nphi;
+    int ns = dims->ns;
+    int nsbu = dims->nsbu;
+    int nsbx = dims->nsbx;
+    int nsg = dims->nsg;
+    int nsphi = dims->nsphi;
+    int nbx = dims->nbx;
+    int nbu = dims->nbu;
+
+    // same layout as in ocp_nlp_constraints_bgp_model_set
+    if (!strcmp(field, "lb"))
+    {
+        *len = nb;
+        *offset = 0;
+    }
+    else if (!strcmp(field, "ub"))
+    {
+        *len = nb;
+        *offset = nb+ng+nphi;
+    }
+    else if (!strcmp(field, "lbx"))
+    {
+        *len = nbx;
+        *offset = nbu;
+    }
+    else if (!strcmp(field, "ubx"))
+    {
+        *len = nbx;
+        *offset = nb+ng+nphi+nbu;
+    }
+    else if (!strcmp(field, "lbu"))
+    {
+        *len = nbu;
+        *offset = 0;
+    }
+    else if (!strcmp(field, "ubu"))
+    {
+        *len = nbu;
+        *offset = nb+ng+nphi;
+    }
+    else if (!strcmp(field, "lg"))
+    {
+        *len = ng;
+        *offset = nb;
+    }
+    else if (!strcmp(field, "ug"))
+    {
+        *len = ng;
+        *offset = 2*nb+ng+nphi;
+    }
+    else if (!strcmp(field, "lphi"))
+    {
+        *len = nphi;
+        *offset = nb+ng;
+    }
+    else if (!strcmp(field, "uphi"))
+    {
+        *len = nphi;
+        *offset = 2*nb+2*ng+nphi;
+    }
+    else if (!strcmp(field, "lsbu"))
+    {
+        *len = nsbu;
+        *offset = 2*nb+2*ng+2*nphi;
+    }
+    else if (!strcmp(field, "usbu"))
+    {
+        *len = nsbu;
+        *offset = 2*nb+2*ng+2*nphi+ns;
+    }
+    else if (!strcmp(field, "lsbx"))
+    {
+        *len = nsbx;
+        *offset = 2*nb+2*ng+2*nphi+nsbu;
+    }
+    else if (!strcmp(field, "usbx"))
+    {
+        *len = nsbx;
+        *offset = 2*nb+2*ng+2*nphi+ns+nsbu;
+    }
+    else if (!strcmp(field, "lsg"))
+    {
+        *len = nsg;
+        *offset = 2*nb+2*ng+2*nphi+nsbu+nsbx;
+    }
+    else if (!strcmp(field, "usg"))
+    {
+        *len = nsg;
+        *offset = 2*nb+2*ng+2*nphi+ns+nsbu+nsbx;
+    }
+    else if (!strcmp(field, "lsphi"))
+    {
+        *len = nsphi;
+        *offset = 2*nb+2*ng+2*nphi+nsbu+nsbx+nsg;
+    }
+    else if (!strcmp(field, "usphi"))
+    {
+        *len = nsphi;
+        *offset = 2*nb+2*ng+2*nphi+ns+nsbu+nsbx+nsg;
+    }
+    else
+    {
+        return ACADOS_FAILURE;
+    }
+
+    *vec = &model->d;
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /* options */
 
 int ocp_nlp_constraints_bgp_opts_calculate_size(void *config_, void *dims_)
@@ -1268,10 +1388,10 @@ void ocp_nlp_constraints_bgp_compute_fun(void *config_, void *dims_, void *model
     blasfeo_daxpy(nb+ng+nphi, -1.0, &model->d, nb+ng+nphi, &work->tmp_ni, 0, &memory->fun, nb+ng+nphi);
 
     // soft
-    blasfeo_dvecad_sp(ns, -1.0, memory->ux, nu+nx, model->idxs, &memory->fun, 0);
-    blasfeo_dvecad_sp(ns, -1.0, memory->ux, nu+nx+ns, model->idxs, &memory->fun, nb+ng+nphi);
+    blasfeo_dvecad_sp(ns, -1.0, memory->tmp_ux, nu+nx, model->idxs, &memory->fun, 0);
+    blasfeo_dvecad_sp(ns, -1.0, memory->tmp_ux, nu+nx+ns, model->idxs, &memory->fun, nb+ng+nphi);
 
-    blasfeo_daxpy(2*ns, -1.0, memory->ux, nu+nx, &model->d, 2*nb+2*ng+2*nphi, &memory->fun, 2*nb+2*ng+2*nphi);
+    blasfeo_daxpy(2*ns, -1.0, memory->tmp_ux, nu+nx, &model->d, 2*nb+2*ng+2*nphi, &memory->fun, 2*nb+2*ng+2*nphi);
 
     return;
 
@@ -1279,6 +1399,17 @@ void ocp_nlp_constraints_bgp_compute_fun(void *config_, void *dims_, void *model
 
 
 
+int ocp_nlp_constraints_bgp_constant_qp_matrices(void *config_, void *dims_, void *model_,
+                                            void *opts_)
+{
+    ocp_nlp_constraints_bgp_dims *dims = dims_;
+
+    // DCt is copied in initialize, only the nonlinear constraints are linearized
+    return dims->nphi == 0;
+}
+
+
+
 void ocp_nlp_constraints_bgp_bounds_update(void *config_, void *dims_, void *model_,
                                             void *opts_, void *memory_, void *work_)
 {
@@ -1321,6 +1452,7 @@ void ocp_nlp_constraints_bgp_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_constraints_bgp_model_calculate_size;
     config->model_assign = &ocp_nlp_constraints_bgp_model_assign;
     config->model_set = &ocp_nlp_constraints_bgp_model_set;
+    config->model_get_vec = &ocp_nlp_constraints_bgp_model_get_vec;
     config->opts_calculate_size = &ocp_nlp_constraints_bgp_opts_calculate_size;
     config->opts_assign = &ocp_nlp_constraints_bgp_opts_assign;
     config->opts_initialize_default = &ocp_nlp_constraints_bgp_opts_initialize_default;
@@ -1344,6 +1476,7 @@ void ocp_nlp_constraints_bgp_config_initialize_default(void *config_)
     config->initialize = &ocp_nlp_constraints_bgp_initialize;
     config->update_qp_matrices = &ocp_nlp_constraints_bgp_update_qp_matrices;
     config->compute_fun = &ocp_nlp_constraints_bgp_compute_fun;
+    config->constant_qp_matrices = &ocp_nlp_constraints_bgp_constant_qp_matrices;
     config->bounds_update = &ocp_nlp_constraints_bgp_bounds_update;
     config->config_initialize_default = &ocp_nlp_constraints_bgp_config_initialize_default;
 
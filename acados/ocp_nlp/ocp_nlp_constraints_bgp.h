@@ -104,6 +104,9 @@ void *ocp_nlp_constraints_bgp_assign(void *config, void *dims, void *raw_memory)
 //
 int ocp_nlp_constraints_bgp_model_set(void *config_, void *dims_,
                          void *model_, const char *field, void *value);
+//
+int ocp_nlp_constraints_bgp_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len);
 
 /* options */
 
@@ -199,6 +202,9 @@ void ocp_nlp_constraints_bgp_update_qp_matrices(void *config_, void *dims,
 void ocp_nlp_constraints_bgp_compute_fun(void *config_, void *dims,
         void *model_, void *opts_, void *memory_, void *work_);
 //
+int ocp_nlp_constraints_bgp_constant_qp_matrices(void *config_, void *dims, void *model_,
+        void *opts_);
+//
 void ocp_nlp_constraints_bgp_bounds_update(void *config_, void *dims, void *model_,
         void *opts_, void *memory_, void *work_);
 
@@ -65,6 +65,9 @@ typedef struct
     int (*model_calculate_size)(void *config, void *dims);
     void *(*model_assign)(void *config, void *dims, void *raw_memory);
     int (*model_set)(void *config_, void *dims_, void *model_, const char *field, void *value);
+    // slice (vec, offset, len) of the model data set by the vector field, may be NULL
+    int (*model_get_vec)(void *config_, void *dims_, void *model_, const char *field,
+                         struct blasfeo_dvec **vec, int *offset, int *len);
     int (*opts_calculate_size)(void *config, void *dims);
     void *(*opts_assign)(void *config, void *dims, void *raw_memory);
     void (*opts_initialize_default)(void *config, void *dims, void *opts);
@@ -88,6 +91,8 @@ typedef struct
     void (*initialize)(void *config, void *dims, void *model, void *opts, void *mem, void *work);
     void (*update_qp_matrices)(void *config, void *dims, void *model, void *opts, void *mem, void *work);
     void (*compute_fun)(void *config, void *dims, void *model, void *opts, void *mem, void *work);
+    // 1 if the qp matrices (Hessian contribution, DCt) do not depend on the iterate, may be NULL
+    int (*constant_qp_matrices)(void *config, void *dims, void *model, void *opts);
     void (*bounds_update)(void *config, void *dims, void *model, void *opts, void *mem, void *work);
     void (*config_initialize_default)(void *config);
     // dimension setters
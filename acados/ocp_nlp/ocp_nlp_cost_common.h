@@ -68,6 +68,9 @@ typedef struct
     int (*model_calculate_size)(void *config, void *dims);
     void *(*model_assign)(void *config, void *dims, void *raw_memory);
     int (*model_set)(void *config_, void *dims_, void *model_, const char *field, void *value_);
+    // slice (vec, offset, len) of the model data set by the vector field, may be NULL
+    int (*model_get_vec)(void *config_, void *dims_, void *model_, const char *field,
+                         struct blasfeo_dvec **vec, int *offset, int *len);
     int (*opts_calculate_size)(void *config, void *dims);
     void *(*opts_assign)(void *config, void *dims, void *raw_memory);
     void (*opts_initialize_default)(void *config, void *dims, void *opts);
@@ -87,6 +90,8 @@ typedef struct
     void (*initialize)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
     void (*update_qp_matrices)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
     void (*compute_fun)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
+    // 1 if the Hessian contribution does not depend on the iterate, may be NULL
+    int (*constant_qp_matrices)(void *config_, void *dims, void *model_, void *opts_);
     void (*config_initialize_default)(void *config);
 } ocp_nlp_cost_config;
 
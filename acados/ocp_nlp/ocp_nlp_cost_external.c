@@ -264,6 +264,49 @@ int ocp_nlp_cost_external_model_set(void *config_, void *dims_, void *model_,
 
 
 
+int ocp_nlp_cost_external_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len)
+{
+    ocp_nlp_cost_external_dims *dims = dims_;
+    ocp_nlp_cost_external_model *model = model_;
+
+    int ns = dims->ns;
+
+    // same layout as in ocp_nlp_cost_external_model_set (Z and z set both halves)
+    if (!strcmp(field, "Zl"))
+    {
+        *vec = &model->Z;
+        *offset = 0;
+        *len = ns;
+    }
+    else if (!strcmp(field, "Zu"))
+    {
+        *vec = &model->Z;
+        *offset = ns;
+        *len = ns;
+    }
+    else if (!strcmp(field, "zl"))
+    {
+        *vec = &model->z;
+        *offset = 0;
+        *len = ns;
+    }
+    else if (!strcmp(field, "zu"))
+    {
+        *vec = &model->z;
+        *offset = ns;
+        *len = ns;
+    }
+    else
+    {
+        return ACADOS_FAILURE;
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /************************************************
  * options
  ************************************************/
@@ -716,6 +759,7 @@ void ocp_nlp_cost_external_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_cost_external_model_calculate_size;
     config->model_assign = &ocp_nlp_cost_external_model_assign;
     config->model_set = &ocp_nlp_cost_external_model_set;
+    config->model_get_vec = &ocp_nlp_cost_external_model_get_vec;
     config->opts_calculate_size = &ocp_nlp_cost_external_opts_calculate_size;
     config->opts_assign = &ocp_nlp_cost_external_opts_assign;
     config->opts_initialize_default = &ocp_nlp_cost_external_opts_initialize_default;
@@ -401,6 +401,55 @@ int ocp_nlp_cost_ls_model_set(void *config_, void *dims_, void *model_,
 
 
 
+int ocp_nlp_cost_ls_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len)
+{
+    ocp_nlp_cost_ls_dims *dims = dims_;
+    ocp_nlp_cost_ls_model *model = model_;
+
+    int ns = dims->ns;
+
+    // same layout as in ocp_nlp_cost_ls_model_set (Z and z set both halves)
+    if (!strcmp(field, "y_ref") || !strcmp(field, "yref"))
+    {
+        *vec = &model->y_ref;
+        *offset = 0;
+        *len = dims->ny;
+    }
+    else if (!strcmp(field, "Zl"))
+    {
+        *vec = &model->Z;
+        *offset = 0;
+        *len = ns;
+    }
+    else if (!strcmp(field, "Zu"))
+    {
+        *vec = &model->Z;
+        *offset = ns;
+        *len = ns;
+    }
+    else if (!strcmp(field, "zl"))
+    {
+        *vec = &model->z;
+        *offset = 0;
+        *len = ns;
+    }
+    else if (!strcmp(field, "zu"))
+    {
+        *vec = &model->z;
+        *offset = ns;
+        *len = ns;
+    }
+    else
+    {
+        return ACADOS_FAILURE;
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //                                   options                                  //
 ////////////////////////////////////////////////////////////////////////////////
@@ -725,10 +774,10 @@ void ocp_nlp_cost_ls_initialize(void *config_, void *dims_, void *model_,
 
     // general Cyt
 
-    // TODO(all): recompute factorization only if W are re-tuned ???
+    // NOTE: only called if the model changed since the last initialization, the factorization
+    // and the Gauss-Newton Hessian are kept otherwise
     blasfeo_dpotrf_l(ny, &model->W, 0, 0, &memory->W_chol, 0, 0);
 
-    // TODO(all): avoid recomputing the Hessian if both W and Cyt do not change
     blasfeo_dtrmm_rlnn(nu + nx, ny, 1.0, &memory->W_chol, 0, 0, &model->Cyt,
         0, 0, &work->tmp_nv_ny,
                        0, 0);
@@ -884,6 +933,16 @@ void ocp_nlp_cost_ls_compute_fun(void *config_, void *dims_, void *model_, void
 
 
 
+int ocp_nlp_cost_ls_constant_qp_matrices(void *config_, void *dims_, void *model_, void *opts_)
+{
+    ocp_nlp_cost_ls_dims *dims = dims_;
+
+    // Gauss-Newton Hessian computed in initialize, unless algebraic variables are eliminated
+    return dims->nz == 0;
+}
+
+
+
 void ocp_nlp_cost_ls_config_initialize_default(void *config_)
 {
     ocp_nlp_cost_config *config = config_;
@@ -896,6 +955,7 @@ void ocp_nlp_cost_ls_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_cost_ls_model_calculate_size;
     config->model_assign = &ocp_nlp_cost_ls_model_assign;
     config->model_set = &ocp_nlp_cost_ls_model_set;
+    config->model_get_vec = &ocp_nlp_cost_ls_model_get_vec;
     config->opts_calculate_size = &ocp_nlp_cost_ls_opts_calculate_size;
     config->opts_assign = &ocp_nlp_cost_ls_opts_assign;
     config->opts_initialize_default = &ocp_nlp_cost_ls_opts_initialize_default;
@@ -915,6 +975,7 @@ void ocp_nlp_cost_ls_config_initialize_default(void *config_)
     config->initialize = &ocp_nlp_cost_ls_initialize;
     config->update_qp_matrices = &ocp_nlp_cost_ls_update_qp_matrices;
     config->compute_fun = &ocp_nlp_cost_ls_compute_fun;
+    config->constant_qp_matrices = &ocp_nlp_cost_ls_constant_qp_matrices;
     config->config_initialize_default = &ocp_nlp_cost_ls_config_initialize_default;
 
     return;
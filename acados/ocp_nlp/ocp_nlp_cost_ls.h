@@ -137,6 +137,9 @@ void *ocp_nlp_cost_ls_model_assign(void *config, void *dims, void *raw_memory);
 //
 int ocp_nlp_cost_ls_model_set(void *config_, void *dims_, void *model_,
                               const char *field, void *value_);
+//
+int ocp_nlp_cost_ls_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len);
 
 
 
@@ -248,6 +251,8 @@ void ocp_nlp_cost_ls_update_qp_matrices(void *config_, void *dims, void *model_,
                                         void *opts_, void *memory_, void *work_);
 //
 void ocp_nlp_cost_ls_compute_fun(void *config_, void *dims, void *model_, void *opts_, void *memory_, void *work_);
+//
+int ocp_nlp_cost_ls_constant_qp_matrices(void *config_, void *dims, void *model_, void *opts_);
 
 #ifdef __cplusplus
 } /* extern "C" */
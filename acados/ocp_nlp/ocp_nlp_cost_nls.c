@@ -342,6 +342,55 @@ int ocp_nlp_cost_nls_model_set(void *config_, void *dims_, void *model_,
 
 
 
+int ocp_nlp_cost_nls_model_get_vec(void *config_, void *dims_, void *model_,
+        const char *field, struct blasfeo_dvec **vec, int *offset, int *len)
+{
+    ocp_nlp_cost_nls_dims *dims = dims_;
+    ocp_nlp_cost_nls_model *model = model_;
+
+    int ns = dims->ns;
+
+    // same layout as in ocp_nlp_cost_nls_model_set (Z and z set both halves)
+    if (!strcmp(field, "y_ref") || !strcmp(field, "yref"))
+    {
+        *vec = &model->y_ref;
+        *offset = 0;
+        *len = dims->ny;
+    }
+    else if (!strcmp(field, "Zl"))
+    {
+        *vec = &model->Z;
+        *offset = 0;
+        *len = ns;
+    }
+    else if (!strcmp(field, "Zu"))
+    {
+        *vec = &model->Z;
+        *offset = ns;
+        *len = ns;
+    }
+    else if (!strcmp(field, "zl"))
+    {
+        *vec = &model->z;
+        *offset = 0;
+        *len = ns;
+    }
+    else if (!strcmp(field, "zu"))
+    {
+        *vec = &model->z;
+        *offset = ns;
+        *len = ns;
+    }
+    else
+    {
+        return ACADOS_FAILURE;
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /************************************************
  * options
  ************************************************/
@@ -672,7 +721,7 @@ void ocp_nlp_cost_nls_initialize(void *config_, void *dims_, void *model_, void
     int ny = dims->ny;
     int ns = dims->ns;
 
-    // TODO(all): recompute factorization only if W are re-tuned ???
+    // NOTE: only called if the model changed since the last initialization
     blasfeo_dpotrf_l(ny, &model->W, 0, 0, &memory->W_chol, 0, 0);
 
     blasfeo_dveccpsc(2*ns, model->scaling, &model->Z, 0, memory->Z, 0);
@@ -890,6 +939,7 @@ void ocp_nlp_cost_nls_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_cost_nls_model_calculate_size;
     config->model_assign = &ocp_nlp_cost_nls_model_assign;
     config->model_set = &ocp_nlp_cost_nls_model_set;
+    config->model_get_vec = &ocp_nlp_cost_nls_model_get_vec;
     config->opts_calculate_size = &ocp_nlp_cost_nls_opts_calculate_size;
     config->opts_assign = &ocp_nlp_cost_nls_opts_assign;
     config->opts_initialize_default = &ocp_nlp_cost_nls_opts_initialize_default;
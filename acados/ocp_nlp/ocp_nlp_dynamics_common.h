@@ -102,6 +102,8 @@ typedef struct
     void (*initialize)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
     void (*update_qp_matrices)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
     void (*compute_fun)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
+    // 1 if the qp matrices (Hessian contribution, BAbt) do not depend on the iterate, may be NULL
+    int (*constant_qp_matrices)(void *config_, void *dims, void *model_, void *opts_);
     int (*precompute)(void *config_, void *dims, void *model_, void *opts_, void *mem_, void *work_);
 } ocp_nlp_dynamics_config;
 
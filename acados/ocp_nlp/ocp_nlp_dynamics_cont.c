@@ -758,10 +758,24 @@ void ocp_nlp_dynamics_cont_update_qp_matrices(void *config_, void *dims_, void *
         work->sim_in->S_adj[jj] = 0.0;
     blasfeo_unpack_dvec(nx1, mem->pi, 0, work->sim_in->S_adj);
 
+    // let the integrator add the hessian directly to RSQrq, if supported
+    bool hess_acc = opts->compute_hess && config->sim_solver->hess_acc;
+    if (hess_acc)
+    {
+        config->sim_solver->memory_set(config->sim_solver, work->sim_in->dims, mem->sim_solver,
+                                        "hess_acc", mem->RSQrq);
+    }
+
     // call integrator
     config->sim_solver->evaluate(config->sim_solver, work->sim_in, work->sim_out, opts->sim_solver,
             mem->sim_solver, work->sim_solver);
 
+    if (hess_acc)
+    {
+        config->sim_solver->memory_set(config->sim_solver, work->sim_in->dims, mem->sim_solver,
+                                        "hess_acc", NULL);
+    }
+
     // TODO transition functions for changing dimensions not yet implemented!
 
     // B
@@ -800,7 +814,7 @@ void ocp_nlp_dynamics_cont_update_qp_matrices(void *config_, void *dims_, void *
     }
 
     // hessian
-    if (opts->compute_hess)
+    if (opts->compute_hess && !hess_acc)
     {
 
 //        d_print_mat(nu+nx, nu+nx, work->sim_out->S_hess, nu+nx);
@@ -288,6 +288,7 @@ int ocp_nlp_dynamics_disc_memory_calculate_size(void *config_, void *dims_, void
 
     size += 1 * blasfeo_memsize_dvec(nu + nx + nx1);  // adj
     size += 1 * blasfeo_memsize_dvec(nx1);            // fun
+    size += 1 * blasfeo_memsize_dvec(nx1);            // fun_off
 
     size += 64;  // blasfeo_mem align
 
@@ -320,6 +321,10 @@ void *ocp_nlp_dynamics_disc_memory_assign(void *config_, void *dims_, void *opts
     assign_and_advance_blasfeo_dvec_mem(nu + nx + nx1, &memory->adj, &c_ptr);
     // fun
     assign_and_advance_blasfeo_dvec_mem(nx1, &memory->fun, &c_ptr);
+    // fun_off
+    assign_and_advance_blasfeo_dvec_mem(nx1, &memory->fun_off, &c_ptr);
+
+    memory->lin_valid = 0;
 
     assert((char *) raw_memory +
                ocp_nlp_dynamics_disc_memory_calculate_size(config_, dims, opts_) >=
@@ -555,6 +560,8 @@ void *ocp_nlp_dynamics_disc_model_assign(void *config_, void *dims_, void *raw_m
     ocp_nlp_dynamics_disc_model *model = (ocp_nlp_dynamics_disc_model *) c_ptr;
     c_ptr += sizeof(ocp_nlp_dynamics_disc_model);
 
+    model->linear = 0;
+
     assert((char *) raw_memory + ocp_nlp_dynamics_disc_model_calculate_size(config_, dims_) >=
            c_ptr);
 
@@ -584,6 +591,11 @@ void ocp_nlp_dynamics_disc_model_set(void *config_, void *dims_, void *model_, c
     {
         model->disc_dyn_fun_jac_hess = (external_function_generic *) value;
     }
+    else if (!strcmp(field, "linear"))
+    {
+        int *int_ptr = value;
+        model->linear = *int_ptr;
+    }
     else
     {
         printf("\nerror: field %s not available in ocp_nlp_dynamics_disc_model_set\n", field);
@@ -603,6 +615,11 @@ void ocp_nlp_dynamics_disc_model_set(void *config_, void *dims_, void *model_, c
 void ocp_nlp_dynamics_disc_initialize(void *config_, void *dims_, void *model_, void *opts_,
                                       void *mem_, void *work_)
 {
+    ocp_nlp_dynamics_disc_memory *memory = mem_;
+
+    // the model changed: evaluate the jacobian of linear dynamics again
+    memory->lin_valid = 0;
+
     return;
 }
 
@@ -648,7 +665,13 @@ void ocp_nlp_dynamics_disc_update_qp_matrices(void *config_, void *dims_, void *
     jac_out.ai = 0;
     jac_out.aj = 0;
 
-    if (opts->compute_hess)
+    if (model->linear && memory->lin_valid)
+    {
+        // linear dynamics: keep BAbt, the Hessian contribution is zero
+        blasfeo_dgemv_t(nu+nx, nx1, 1.0, memory->BAbt, 0, 0, memory->ux, 0, 1.0, &memory->fun_off,
+                        0, &memory->fun, 0);
+    }
+    else if (opts->compute_hess)
     {
 
         struct blasfeo_dvec_args pi_in;  // input u of external fun;
@@ -699,6 +722,13 @@ void ocp_nlp_dynamics_disc_update_qp_matrices(void *config_, void *dims_, void *
 
     }
 
+    if (model->linear && !memory->lin_valid)
+    {
+        blasfeo_dgemv_t(nu+nx, nx1, -1.0, memory->BAbt, 0, 0, memory->ux, 0, 1.0, &memory->fun, 0,
+                        &memory->fun_off, 0);
+        memory->lin_valid = 1;
+    }
+
     // fun
     blasfeo_daxpy(nx1, -1.0, memory->ux1, nu1, &memory->fun, 0, &memory->fun, 0);
 
@@ -768,6 +798,15 @@ void ocp_nlp_dynamics_disc_compute_fun(void *config_, void *dims_, void *model_,
 
 
 
+int ocp_nlp_dynamics_disc_constant_qp_matrices(void *config_, void *dims_, void *model_, void *opts_)
+{
+    ocp_nlp_dynamics_disc_model *model = model_;
+
+    return model->linear;
+}
+
+
+
 int ocp_nlp_dynamics_disc_precompute(void *config_, void *dims, void *model_, void *opts_,
                                         void *mem_, void *work_)
 {
@@ -812,6 +851,7 @@ void ocp_nlp_dynamics_disc_config_initialize_default(void *config_)
     config->initialize = &ocp_nlp_dynamics_disc_initialize;
     config->update_qp_matrices = &ocp_nlp_dynamics_disc_update_qp_matrices;
     config->compute_fun = &ocp_nlp_dynamics_disc_compute_fun;
+    config->constant_qp_matrices = &ocp_nlp_dynamics_disc_constant_qp_matrices;
     config->precompute = &ocp_nlp_dynamics_disc_precompute;
     config->config_initialize_default = &ocp_nlp_dynamics_disc_config_initialize_default;
 
@@ -115,6 +115,8 @@ typedef struct
     struct blasfeo_dvec *tmp_pi; // pointer to pi in tmp_nlp_out at current stage
     struct blasfeo_dmat *BAbt;   // pointer to BAbt in qp_in
     struct blasfeo_dmat *RSQrq;  // pointer to RSQrq in qp_in
+    struct blasfeo_dvec fun_off; // offset of linear dynamics, fun - BAbt^T * ux
+    int lin_valid;               // BAbt and fun_off of linear dynamics are valid
 } ocp_nlp_dynamics_disc_memory;
 
 //
@@ -164,6 +166,7 @@ typedef struct
     external_function_generic *disc_dyn_fun;
     external_function_generic *disc_dyn_fun_jac;
     external_function_generic *disc_dyn_fun_jac_hess;
+    int linear;  // disc_dyn_fun is affine in x and u: BAbt is evaluated once per model change
 } ocp_nlp_dynamics_disc_model;
 
 //
@@ -186,6 +189,8 @@ void ocp_nlp_dynamics_disc_initialize(void *config_, void *dims, void *model_, v
 //
 void ocp_nlp_dynamics_disc_update_qp_matrices(void *config_, void *dims, void *model_, void *opts, void *mem, void *work_);
 //
+int ocp_nlp_dynamics_disc_constant_qp_matrices(void *config_, void *dims, void *model_, void *opts_);
+//
 void ocp_nlp_dynamics_disc_compute_fun(void *config_, void *dims, void *model_, void *opts, void *mem, void *work_);
 
 
@@ -0,0 +1,1335 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+
+#include "acados/ocp_nlp/ocp_nlp_ipm.h"
+
+// external
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#if defined(ACADOS_WITH_OPENMP)
+#include <omp.h>
+#endif
+
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+#include "blasfeo/include/blasfeo_d_aux_ext_dep.h"
+#include "blasfeo/include/blasfeo_d_blas.h"
+// hpipm
+#include "hpipm/include/hpipm_d_ocp_qp.h"
+#include "hpipm/include/hpipm_d_ocp_qp_dim.h"
+#include "hpipm/include/hpipm_d_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_d_ocp_qp_sol.h"
+// acados
+#include "acados/ocp_nlp/ocp_nlp_common.h"
+#include "acados/ocp_nlp/ocp_nlp_dynamics_cont.h"
+#include "acados/ocp_nlp/ocp_nlp_reg_common.h"
+#include "acados/ocp_qp/ocp_qp_common.h"
+#include "acados/utils/mem.h"
+#include "acados/utils/print.h"
+#include "acados/utils/timing.h"
+#include "acados/utils/types.h"
+
+
+
+/************************************************
+ * options
+ ************************************************/
+
+int ocp_nlp_ipm_opts_calculate_size(void *config_, void *dims_)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+
+    int size = 0;
+
+    size += sizeof(ocp_nlp_ipm_opts);
+
+    size += ocp_nlp_opts_calculate_size(config, dims);
+
+    // Newton system (the qp dims are an upper bound of the Newton system dims)
+    size += sizeof(struct d_ocp_qp_ipm_arg);
+    size += d_ocp_qp_ipm_arg_memsize(dims->qp_solver->orig_dims);
+
+    size += 8;
+
+    return size;
+}
+
+
+
+void *ocp_nlp_ipm_opts_assign(void *config_, void *dims_, void *raw_memory)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+
+    char *c_ptr = (char *) raw_memory;
+
+    ocp_nlp_ipm_opts *opts = (ocp_nlp_ipm_opts *) c_ptr;
+    c_ptr += sizeof(ocp_nlp_ipm_opts);
+
+    opts->nlp_opts = ocp_nlp_opts_assign(config, dims, c_ptr);
+    c_ptr += ocp_nlp_opts_calculate_size(config, dims);
+
+    // Newton system
+    opts->newton_arg = (struct d_ocp_qp_ipm_arg *) c_ptr;
+    c_ptr += sizeof(struct d_ocp_qp_ipm_arg);
+
+    align_char_to(8, &c_ptr);
+
+    d_ocp_qp_ipm_arg_create(dims->qp_solver->orig_dims, opts->newton_arg, c_ptr);
+    c_ptr += d_ocp_qp_ipm_arg_memsize(dims->qp_solver->orig_dims);
+
+    assert((char *) raw_memory + ocp_nlp_ipm_opts_calculate_size(config, dims) >= c_ptr);
+
+    return opts;
+}
+
+
+
+void ocp_nlp_ipm_opts_initialize_default(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+
+    // this first !!!
+    ocp_nlp_opts_initialize_default(config, dims, nlp_opts);
+
+    // IPM opts
+    opts->max_iter = 50;
+    opts->tol_stat = 1e-8;
+    opts->tol_eq   = 1e-8;
+    opts->tol_ineq = 1e-8;
+    opts->tol_comp = 1e-8;
+
+    opts->rti_phase = 0;
+    opts->print_level = 0;
+
+    // barrier
+    opts->barrier_strategy = BARRIER_MONOTONE;
+    opts->mu_init = 1e-1;
+    opts->mu_min = 1e-9;
+    opts->kappa_mu = 0.2;
+    opts->theta_mu = 1.5;
+    opts->kappa_eps = 10.0;
+    opts->tau_min = 0.99;
+
+    // the Newton system has no inequalities: hpipm factorizes it once
+    d_ocp_qp_ipm_arg_set_default(SPEED, opts->newton_arg);
+
+    return;
+}
+
+
+
+void ocp_nlp_ipm_opts_update(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+
+    ocp_nlp_opts_update(config, dims, nlp_opts);
+
+    return;
+}
+
+
+
+void ocp_nlp_ipm_opts_set(void *config_, void *opts_, const char *field, void* value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = (ocp_nlp_ipm_opts *) opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+
+    if (!strcmp(field, "max_iter"))
+    {
+        int* max_iter = (int *) value;
+        opts->max_iter = *max_iter;
+    }
+    else if (!strcmp(field, "tol_stat"))
+    {
+        double* tol_stat = (double *) value;
+        opts->tol_stat = *tol_stat;
+    }
+    else if (!strcmp(field, "tol_eq"))
+    {
+        double* tol_eq = (double *) value;
+        opts->tol_eq = *tol_eq;
+    }
+    else if (!strcmp(field, "tol_ineq"))
+    {
+        double* tol_ineq = (double *) value;
+        opts->tol_ineq = *tol_ineq;
+    }
+    else if (!strcmp(field, "tol_comp"))
+    {
+        double* tol_comp = (double *) value;
+        opts->tol_comp = *tol_comp;
+    }
+    else if (!strcmp(field, "rti_phase"))
+    {
+        int* rti_phase = (int *) value;
+        if (*rti_phase != 0)
+        {
+            printf("\nerror: ocp_nlp_ipm_opts_set: invalid value for rti_phase field.");
+            printf("possible values are: 0\n");
+            exit(1);
+        }
+        opts->rti_phase = *rti_phase;
+    }
+    else if (!strcmp(field, "print_level"))
+    {
+        int* print_level = (int *) value;
+        if (*print_level < 0)
+        {
+            printf("\nerror: ocp_nlp_ipm_opts_set: invalid value for print_level field, need int >=0, got %d.", *print_level);
+            exit(1);
+        }
+        opts->print_level = *print_level;
+    }
+    else if (!strcmp(field, "barrier_strategy"))
+    {
+        int* barrier_strategy = (int *) value;
+        if (*barrier_strategy != BARRIER_MONOTONE && *barrier_strategy != BARRIER_ADAPTIVE)
+        {
+            printf("\nerror: ocp_nlp_ipm_opts_set: invalid value for barrier_strategy field, got %d.", *barrier_strategy);
+            printf("possible values are: %d (BARRIER_MONOTONE), %d (BARRIER_ADAPTIVE)\n", BARRIER_MONOTONE, BARRIER_ADAPTIVE);
+            exit(1);
+        }
+        opts->barrier_strategy = *barrier_strategy;
+    }
+    else if (!strcmp(field, "mu_init"))
+    {
+        double* mu_init = (double *) value;
+        opts->mu_init = *mu_init;
+    }
+    else if (!strcmp(field, "mu_min"))
+    {
+        double* mu_min = (double *) value;
+        opts->mu_min = *mu_min;
+    }
+    else if (!strcmp(field, "kappa_mu"))
+    {
+        double* kappa_mu = (double *) value;
+        opts->kappa_mu = *kappa_mu;
+    }
+    else if (!strcmp(field, "theta_mu"))
+    {
+        double* theta_mu = (double *) value;
+        opts->theta_mu = *theta_mu;
+    }
+    else if (!strcmp(field, "kappa_eps"))
+    {
+        double* kappa_eps = (double *) value;
+        opts->kappa_eps = *kappa_eps;
+    }
+    else if (!strcmp(field, "tau_min"))
+    {
+        double* tau_min = (double *) value;
+        opts->tau_min = *tau_min;
+    }
+    else
+    {
+        ocp_nlp_opts_set(config, nlp_opts, field, value);
+    }
+
+    return;
+}
+
+
+
+void ocp_nlp_ipm_opts_set_at_stage(void *config_, void *opts_, int stage, const char *field, void* value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = (ocp_nlp_ipm_opts *) opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+
+    ocp_nlp_opts_set_at_stage(config, nlp_opts, stage, field, value);
+
+    return;
+}
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+int ocp_nlp_ipm_memory_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_qp_dims *qp_dims = dims->qp_solver->orig_dims;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
+
+    int ii;
+
+    int size = 0;
+
+    size += sizeof(ocp_nlp_ipm_memory);
+
+    // nlp res
+    size += ocp_nlp_res_calculate_size(dims);
+
+    // nlp mem
+    size += ocp_nlp_memory_calculate_size(config, dims, nlp_opts);
+
+    // Newton system (the qp dims are an upper bound of the Newton system dims)
+    size += ocp_qp_dims_calculate_size(N);
+    size += ocp_qp_in_calculate_size(qp_dims);
+    size += ocp_qp_out_calculate_size(qp_dims);
+    size += sizeof(struct d_ocp_qp_ipm_ws);
+    size += d_ocp_qp_ipm_ws_memsize(qp_dims, opts->newton_arg);
+
+    // barrier terms
+    int nv_max = 0;
+    int ng_max = 0;
+    size += 3*(N+1)*sizeof(struct blasfeo_dvec);  // W q Jdv
+    for (ii = 0; ii <= N; ii++)
+    {
+        size += 3*blasfeo_memsize_dvec(2*ni[ii]);  // W q Jdv
+        nv_max = nu[ii]+nx[ii] > nv_max ? nu[ii]+nx[ii] : nv_max;
+        ng_max = qp_dims->ng[ii] > ng_max ? qp_dims->ng[ii] : ng_max;
+    }
+    size += blasfeo_memsize_dmat(nu[0]+nx[0], nu[0]+nx[0]);  // RSQ0
+    size += 2*blasfeo_memsize_dvec(nu[0]+nx[0]);  // rq0 tmp_nv
+    size += blasfeo_memsize_dvec(nx[0]);  // dx0
+    size += blasfeo_memsize_dmat(nv_max, ng_max);  // tmp_DCt
+    size += blasfeo_memsize_dvec(ng_max);  // tmp_ng
+
+    // stat
+    int stat_m = opts->max_iter+1;
+    int stat_n = 7;
+    size += stat_n*stat_m*sizeof(double);
+
+    size += 3*8;  // initial align, hpipm align, blasfeo_struct align
+    size += 64;  // blasfeo_mem align
+
+    make_int_multiple_of(8, &size);
+
+    return size;
+}
+
+
+
+void *ocp_nlp_ipm_memory_assign(void *config_, void *dims_, void *opts_, void *raw_memory)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_qp_dims *qp_dims = dims->qp_solver->orig_dims;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
+
+    int ii;
+
+    char *c_ptr = (char *) raw_memory;
+
+    // initial align
+    align_char_to(8, &c_ptr);
+
+    ocp_nlp_ipm_memory *mem = (ocp_nlp_ipm_memory *) c_ptr;
+    c_ptr += sizeof(ocp_nlp_ipm_memory);
+
+    // nlp res
+    mem->nlp_res = ocp_nlp_res_assign(dims, c_ptr);
+    c_ptr += mem->nlp_res->memsize;
+
+    // nlp mem
+    mem->nlp_mem = ocp_nlp_memory_assign(config, dims, nlp_opts, c_ptr);
+    c_ptr += ocp_nlp_memory_calculate_size(config, dims, nlp_opts);
+
+    // Newton system: dynamics only, the initial state is eliminated if all its components are bounded
+    mem->elim_x0 = nx[0] > 0 && qp_dims->nbx[0] == nx[0];
+
+    mem->newton_dims = ocp_qp_dims_assign(N, c_ptr);
+    c_ptr += ocp_qp_dims_calculate_size(N);
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int tmp_nx = (ii == 0 && mem->elim_x0) ? 0 : nx[ii];
+        ocp_qp_dims_set(NULL, mem->newton_dims, ii, "nx", &tmp_nx);
+        ocp_qp_dims_set(NULL, mem->newton_dims, ii, "nu", nu+ii);
+    }
+
+    mem->newton_qp_in = ocp_qp_in_assign(mem->newton_dims, c_ptr);
+    c_ptr += ocp_qp_in_calculate_size(qp_dims);
+
+    mem->newton_qp_out = ocp_qp_out_assign(mem->newton_dims, c_ptr);
+    c_ptr += ocp_qp_out_calculate_size(qp_dims);
+
+    mem->newton_ws = (struct d_ocp_qp_ipm_ws *) c_ptr;
+    c_ptr += sizeof(struct d_ocp_qp_ipm_ws);
+
+    // hpipm align
+    align_char_to(8, &c_ptr);
+
+    d_ocp_qp_ipm_ws_create(mem->newton_dims, opts->newton_arg, mem->newton_ws, c_ptr);
+    c_ptr += d_ocp_qp_ipm_ws_memsize(qp_dims, opts->newton_arg);
+
+    // blasfeo_struct align
+    align_char_to(8, &c_ptr);
+
+    assign_and_advance_blasfeo_dvec_structs(N+1, &mem->W, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N+1, &mem->q, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N+1, &mem->Jdv, &c_ptr);
+
+    // stat
+    mem->stat = (double *) c_ptr;
+    mem->stat_m = opts->max_iter+1;
+    mem->stat_n = 7;
+    c_ptr += mem->stat_m*mem->stat_n*sizeof(double);
+
+    // blasfeo_mem align
+    align_char_to(64, &c_ptr);
+
+    int nv_max = 0;
+    int ng_max = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        assign_and_advance_blasfeo_dvec_mem(2*ni[ii], mem->W+ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(2*ni[ii], mem->q+ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(2*ni[ii], mem->Jdv+ii, &c_ptr);
+        nv_max = nu[ii]+nx[ii] > nv_max ? nu[ii]+nx[ii] : nv_max;
+        ng_max = qp_dims->ng[ii] > ng_max ? qp_dims->ng[ii] : ng_max;
+    }
+    assign_and_advance_blasfeo_dmat_mem(nu[0]+nx[0], nu[0]+nx[0], &mem->RSQ0, &c_ptr);
+    assign_and_advance_blasfeo_dmat_mem(nv_max, ng_max, &mem->tmp_DCt, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(nu[0]+nx[0], &mem->rq0, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(nu[0]+nx[0], &mem->tmp_nv, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(nx[0], &mem->dx0, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(ng_max, &mem->tmp_ng, &c_ptr);
+
+    mem->mu = opts->mu_init;
+    mem->alpha_prim = 0.0;
+    mem->alpha_dual = 0.0;
+
+    mem->status = ACADOS_READY;
+
+    assert((char *) raw_memory + ocp_nlp_ipm_memory_calculate_size(config, dims, opts) >= c_ptr);
+
+    return mem;
+}
+
+
+
+/************************************************
+ * workspace
+ ************************************************/
+
+int ocp_nlp_ipm_workspace_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+
+    int size = 0;
+
+    // ipm
+    size += sizeof(ocp_nlp_ipm_workspace);
+
+    // nlp
+    size += ocp_nlp_workspace_calculate_size(config, dims, nlp_opts);
+
+    return size;
+}
+
+
+
+static void ocp_nlp_ipm_cast_workspace(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_ipm_opts *opts,
+                                       ocp_nlp_ipm_memory *mem, ocp_nlp_ipm_workspace *work)
+{
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+
+    // ipm
+    char *c_ptr = (char *) work;
+    c_ptr += sizeof(ocp_nlp_ipm_workspace);
+
+    // nlp
+    work->nlp_work = ocp_nlp_workspace_assign(config, dims, nlp_opts, nlp_mem, c_ptr);
+    c_ptr += ocp_nlp_workspace_calculate_size(config, dims, nlp_opts);
+
+    assert((char *) work + ocp_nlp_ipm_workspace_calculate_size(config, dims, opts) >= c_ptr);
+
+    return;
+}
+
+
+
+/************************************************
+ * barrier
+ ************************************************/
+
+// rows of the initial state bounds, eliminated from the Newton system (no barrier term)
+static int ocp_nlp_ipm_is_x0_row(ocp_nlp_ipm_memory *mem, ocp_qp_dims *qp_dims, int stage, int row)
+{
+    if (stage != 0 || !mem->elim_x0)
+        return 0;
+
+    int nbg = qp_dims->nb[0] + qp_dims->ng[0];
+    int jj = row < nbg ? row : row - nbg;
+
+    return jj >= qp_dims->nbu[0] && jj < qp_dims->nb[0];
+}
+
+
+
+// strictly positive slacks and multipliers for the barrier rows, zero slacks for the initial state
+static void ocp_nlp_ipm_initialize_slacks(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_ipm_opts *opts,
+                                          ocp_nlp_ipm_memory *mem)
+{
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_qp_dims *qp_dims = dims->qp_solver->orig_dims;
+
+    int ii, jj;
+    double h, t;
+
+    for (ii = 0; ii <= dims->N; ii++)
+    {
+        int nbg = qp_dims->nb[ii] + qp_dims->ng[ii];
+        for (jj = 0; jj < 2*nbg; jj++)
+        {
+            if (ocp_nlp_ipm_is_x0_row(mem, qp_dims, ii, jj))
+            {
+                BLASFEO_DVECEL(nlp_out->t+ii, jj) = 0.0;
+                continue;
+            }
+            t = BLASFEO_DVECEL(nlp_out->t+ii, jj);
+            if (t <= 0.0)
+            {
+                h = -BLASFEO_DVECEL(nlp_mem->ineq_fun+ii, jj);
+                t = h > opts->mu_init ? h : opts->mu_init;
+                BLASFEO_DVECEL(nlp_out->t+ii, jj) = t;
+            }
+            if (BLASFEO_DVECEL(nlp_out->lam+ii, jj) <= 0.0)
+                BLASFEO_DVECEL(nlp_out->lam+ii, jj) = mem->mu / t;
+        }
+    }
+
+    return;
+}
+
+
+
+// average, minimum and max deviation from mu of the complementarity products of the barrier rows
+static int ocp_nlp_ipm_complementarity(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_ipm_memory *mem,
+                                       double *avg, double *min, double *dev)
+{
+    ocp_qp_dims *qp_dims = dims->qp_solver->orig_dims;
+
+    int ii, jj;
+    double tmp;
+
+    int m = 0;
+    *avg = 0.0;
+    *min = 0.0;
+    *dev = 0.0;
+
+    for (ii = 0; ii <= dims->N; ii++)
+    {
+        int nbg = qp_dims->nb[ii] + qp_dims->ng[ii];
+        for (jj = 0; jj < 2*nbg; jj++)
+        {
+            if (ocp_nlp_ipm_is_x0_row(mem, qp_dims, ii, jj))
+                continue;
+            tmp = BLASFEO_DVECEL(nlp_out->lam+ii, jj) * BLASFEO_DVECEL(nlp_out->t+ii, jj);
+            *avg += tmp;
+            *min = (m == 0 || tmp < *min) ? tmp : *min;
+            *dev = fabs(tmp - mem->mu) > *dev ? fabs(tmp - mem->mu) : *dev;
+            m++;
+        }
+    }
+
+    if (m > 0)
+        *avg /= m;
+
+    return m;
+}
+
+
+
+static void ocp_nlp_ipm_update_barrier(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_ipm_opts *opts,
+                                       ocp_nlp_ipm_memory *mem)
+{
+    ocp_nlp_res *nlp_res = mem->nlp_res;
+
+    double avg, min, dev, err, tmp;
+
+    int m = ocp_nlp_ipm_complementarity(dims, nlp_out, mem, &avg, &min, &dev);
+    if (m == 0)
+        return;
+
+    if (opts->barrier_strategy == BARRIER_MONOTONE)
+    {
+        // Fiacco-McCormick: decrease mu once the barrier problem is solved accurately enough
+        err = nlp_res->inf_norm_res_g;
+        err = nlp_res->inf_norm_res_b > err ? nlp_res->inf_norm_res_b : err;
+        err = nlp_res->inf_norm_res_d > err ? nlp_res->inf_norm_res_d : err;
+        err = dev > err ? dev : err;
+        if (err <= opts->kappa_eps * mem->mu)
+        {
+            tmp = pow(mem->mu, opts->theta_mu);
+            tmp = opts->kappa_mu * mem->mu < tmp ? opts->kappa_mu * mem->mu : tmp;
+            mem->mu = tmp;
+        }
+    }
+    else
+    {
+        // LOQO: centering parameter from the spread of the complementarity products
+        double xi = min / avg;
+        tmp = 0.05 * (1.0 - xi) / xi;
+        tmp = tmp < 2.0 ? tmp : 2.0;
+        mem->mu = 0.1 * tmp * tmp * tmp * avg;
+    }
+
+    mem->mu = mem->mu > opts->mu_min ? mem->mu : opts->mu_min;
+
+    return;
+}
+
+
+
+/************************************************
+ * Newton system
+ ************************************************/
+
+// eliminate slacks and multipliers: the barrier terms enter Hessian and gradient of a qp with
+// dynamics only, which is solved by a single Riccati recursion
+static int ocp_nlp_ipm_newton_step(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_ipm_opts *opts,
+                                   ocp_nlp_ipm_memory *mem)
+{
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_qp_in *qp_in = nlp_mem->qp_in;
+    ocp_qp_out *qp_out = nlp_mem->qp_out;
+    ocp_qp_in *newton_qp_in = mem->newton_qp_in;
+    ocp_qp_out *newton_qp_out = mem->newton_qp_out;
+    ocp_qp_dims *qp_dims = qp_in->dim;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int ii, jj, kk;
+    double h, t, lam, W, c;
+
+    // barrier terms
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nbg = qp_dims->nb[ii] + qp_dims->ng[ii];
+        for (jj = 0; jj < 2*nbg; jj++)
+        {
+            if (ocp_nlp_ipm_is_x0_row(mem, qp_dims, ii, jj))
+            {
+                BLASFEO_DVECEL(mem->W+ii, jj) = 0.0;
+                BLASFEO_DVECEL(mem->q+ii, jj) = 0.0;
+                continue;
+            }
+            h = -BLASFEO_DVECEL(nlp_mem->ineq_fun+ii, jj);
+            t = BLASFEO_DVECEL(nlp_out->t+ii, jj);
+            lam = BLASFEO_DVECEL(nlp_out->lam+ii, jj);
+            W = lam / t;
+            BLASFEO_DVECEL(mem->W+ii, jj) = W;
+            BLASFEO_DVECEL(mem->q+ii, jj) = lam + mem->mu / t - W * h;
+        }
+    }
+
+    // step of the initial state
+    if (mem->elim_x0)
+    {
+        int nbg = qp_dims->nb[0] + qp_dims->ng[0];
+        for (jj = qp_dims->nbu[0]; jj < qp_dims->nb[0]; jj++)
+        {
+            // lower plus upper row is lb - ub
+            if (BLASFEO_DVECEL(nlp_mem->ineq_fun, jj) + BLASFEO_DVECEL(nlp_mem->ineq_fun, nbg+jj) != 0.0)
+            {
+                printf("\nerror: ocp_nlp_ipm: bounds on x at stage 0 must be equalities (initial state)\n");
+                exit(1);
+            }
+            BLASFEO_DVECEL(&mem->dx0, qp_in->idxb[0][jj]-nu[0]) = BLASFEO_DVECEL(nlp_mem->ineq_fun, jj);
+        }
+    }
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv = nu[ii] + nx[ii];
+        int nb = qp_dims->nb[ii];
+        int ng = qp_dims->ng[ii];
+        int nbg = nb + ng;
+        int elim = ii == 0 && mem->elim_x0;
+
+        struct blasfeo_dmat *RSQ = elim ? &mem->RSQ0 : newton_qp_in->RSQrq+ii;
+        struct blasfeo_dvec *rq = elim ? &mem->rq0 : newton_qp_in->rqz+ii;
+
+        blasfeo_dgecp(nv, nv, qp_in->RSQrq+ii, 0, 0, RSQ, 0, 0);
+        blasfeo_dveccp(nv, qp_in->rqz+ii, 0, rq, 0);
+
+        // bounds: H += W_l + W_u, g -= q_l - q_u on the bounded variables
+        for (jj = 0; jj < nb; jj++)
+        {
+            kk = qp_in->idxb[ii][jj];
+            BLASFEO_DMATEL(RSQ, kk, kk) += BLASFEO_DVECEL(mem->W+ii, jj) + BLASFEO_DVECEL(mem->W+ii, nbg+jj);
+            BLASFEO_DVECEL(rq, kk) -= BLASFEO_DVECEL(mem->q+ii, jj) - BLASFEO_DVECEL(mem->q+ii, nbg+jj);
+        }
+
+        // general constraints: H += DCt (W_l + W_u) DCt^T, g -= DCt (q_l - q_u)
+        if (ng > 0)
+        {
+            for (jj = 0; jj < ng; jj++)
+            {
+                W = BLASFEO_DVECEL(mem->W+ii, nb+jj) + BLASFEO_DVECEL(mem->W+ii, nbg+nb+jj);
+                for (kk = 0; kk < nv; kk++)
+                    BLASFEO_DMATEL(&mem->tmp_DCt, kk, jj) = W * BLASFEO_DMATEL(qp_in->DCt+ii, kk, jj);
+                BLASFEO_DVECEL(&mem->tmp_ng, jj) = BLASFEO_DVECEL(mem->q+ii, nb+jj)
+                                                 - BLASFEO_DVECEL(mem->q+ii, nbg+nb+jj);
+            }
+            blasfeo_dsyrk_ln(nv, ng, 1.0, &mem->tmp_DCt, 0, 0, qp_in->DCt+ii, 0, 0, 1.0, RSQ, 0, 0, RSQ, 0, 0);
+            blasfeo_dgemv_n(nv, ng, -1.0, qp_in->DCt+ii, 0, 0, &mem->tmp_ng, 0, 1.0, rq, 0, rq, 0);
+        }
+
+        if (elim)
+        {
+            // condense the fixed initial state step into the controls
+            blasfeo_dgecp(nu[0], nu[0], RSQ, 0, 0, newton_qp_in->RSQrq, 0, 0);
+            blasfeo_dgemv_t(nx[0], nu[0], 1.0, RSQ, nu[0], 0, &mem->dx0, 0, 1.0, rq, 0, newton_qp_in->rqz, 0);
+            if (N > 0)
+            {
+                blasfeo_dgecp(nu[0], nx[1], qp_in->BAbt, 0, 0, newton_qp_in->BAbt, 0, 0);
+                blasfeo_dgemv_t(nx[0], nx[1], 1.0, qp_in->BAbt, nu[0], 0, &mem->dx0, 0, 1.0, qp_in->b, 0,
+                                newton_qp_in->b, 0);
+                blasfeo_drowin(nx[1], 1.0, newton_qp_in->b, 0, newton_qp_in->BAbt, nu[0], 0);
+            }
+            blasfeo_drowin(nu[0], 1.0, newton_qp_in->rqz, 0, newton_qp_in->RSQrq, nu[0], 0);
+        }
+        else
+        {
+            if (ii < N)
+            {
+                blasfeo_dgecp(nv+1, nx[ii+1], qp_in->BAbt+ii, 0, 0, newton_qp_in->BAbt+ii, 0, 0);
+                blasfeo_dveccp(nx[ii+1], qp_in->b+ii, 0, newton_qp_in->b+ii, 0);
+            }
+            blasfeo_drowin(nv, 1.0, rq, 0, RSQ, nv, 0);
+        }
+    }
+
+    // Riccati recursion (no inequalities: single factorization)
+    int hpipm_status;
+    d_ocp_qp_ipm_solve(newton_qp_in, newton_qp_out, opts->newton_arg, mem->newton_ws);
+    d_ocp_qp_ipm_get_status(mem->newton_ws, &hpipm_status);
+
+    if (hpipm_status == 3)  // NaN in the solution
+        return ACADOS_QP_FAILURE;
+
+    // primal step and dynamics multipliers
+    for (ii = 0; ii <= N; ii++)
+    {
+        if (ii == 0 && mem->elim_x0)
+        {
+            blasfeo_dveccp(nu[0], newton_qp_out->ux, 0, qp_out->ux, 0);
+            blasfeo_dveccp(nx[0], &mem->dx0, 0, qp_out->ux, nu[0]);
+        }
+        else
+        {
+            blasfeo_dveccp(nu[ii]+nx[ii], newton_qp_out->ux+ii, 0, qp_out->ux+ii, 0);
+        }
+        if (ii < N)
+            blasfeo_dveccp(nx[ii+1], newton_qp_out->pi+ii, 0, qp_out->pi+ii, 0);
+    }
+
+    // recover slacks and multipliers of the inequalities
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv = nu[ii] + nx[ii];
+        int nb = qp_dims->nb[ii];
+        int ng = qp_dims->ng[ii];
+        int nbg = nb + ng;
+
+        blasfeo_dvecex_sp(nb, 1.0, qp_in->idxb[ii], qp_out->ux+ii, 0, mem->Jdv+ii, 0);
+        blasfeo_dgemv_t(nv, ng, 1.0, qp_in->DCt+ii, 0, 0, qp_out->ux+ii, 0, 0.0, mem->Jdv+ii, nb, mem->Jdv+ii, nb);
+
+        for (jj = 0; jj < nbg; jj++)
+        {
+            c = BLASFEO_DVECEL(mem->Jdv+ii, jj);
+
+            // lower: h_l + J dv = t, upper: h_u - J dv = t
+            BLASFEO_DVECEL(qp_out->t+ii, jj) = -BLASFEO_DVECEL(nlp_mem->ineq_fun+ii, jj) + c;
+            BLASFEO_DVECEL(qp_out->t+ii, nbg+jj) = -BLASFEO_DVECEL(nlp_mem->ineq_fun+ii, nbg+jj) - c;
+            BLASFEO_DVECEL(qp_out->lam+ii, jj) = BLASFEO_DVECEL(mem->q+ii, jj)
+                                               - BLASFEO_DVECEL(mem->W+ii, jj) * c;
+            BLASFEO_DVECEL(qp_out->lam+ii, nbg+jj) = BLASFEO_DVECEL(mem->q+ii, nbg+jj)
+                                                   + BLASFEO_DVECEL(mem->W+ii, nbg+jj) * c;
+        }
+    }
+
+    // multipliers of the initial state bounds from stationarity at stage 0
+    if (mem->elim_x0)
+    {
+        int nv = nu[0] + nx[0];
+        int nbg = qp_dims->nb[0] + qp_dims->ng[0];
+
+        blasfeo_dsymv_l(nv, nv, 1.0, &mem->RSQ0, 0, 0, qp_out->ux, 0, 1.0, &mem->rq0, 0, &mem->tmp_nv, 0);
+        if (N > 0)
+            blasfeo_dgemv_n(nv, nx[1], 1.0, qp_in->BAbt, 0, 0, qp_out->pi, 0, 1.0, &mem->tmp_nv, 0,
+                            &mem->tmp_nv, 0);
+
+        for (jj = qp_dims->nbu[0]; jj < qp_dims->nb[0]; jj++)
+        {
+            c = BLASFEO_DVECEL(&mem->tmp_nv, qp_in->idxb[0][jj]);
+            BLASFEO_DVECEL(qp_out->lam, jj) = c > 0.0 ? c : 0.0;
+            BLASFEO_DVECEL(qp_out->lam, nbg+jj) = c < 0.0 ? -c : 0.0;
+            BLASFEO_DVECEL(qp_out->t, jj) = 0.0;
+            BLASFEO_DVECEL(qp_out->t, nbg+jj) = 0.0;
+        }
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
+// fraction to the boundary rule on slacks (primal) and multipliers (dual) of the barrier rows
+static void ocp_nlp_ipm_step_length(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_ipm_opts *opts,
+                                    ocp_nlp_ipm_memory *mem)
+{
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_qp_dims *qp_dims = dims->qp_solver->orig_dims;
+
+    int ii, jj;
+    double v, dv;
+
+    double tau = 1.0 - mem->mu;
+    tau = tau > opts->tau_min ? tau : opts->tau_min;
+
+    mem->alpha_prim = 1.0;
+    mem->alpha_dual = 1.0;
+
+    for (ii = 0; ii <= dims->N; ii++)
+    {
+        int nbg = qp_dims->nb[ii] + qp_dims->ng[ii];
+        for (jj = 0; jj < 2*nbg; jj++)
+        {
+            if (ocp_nlp_ipm_is_x0_row(mem, qp_dims, ii, jj))
+                continue;
+
+            v = BLASFEO_DVECEL(nlp_out->t+ii, jj);
+            dv = BLASFEO_DVECEL(nlp_mem->qp_out->t+ii, jj) - v;
+            if (dv < 0.0 && -tau * v < mem->alpha_prim * dv)
+                mem->alpha_prim = -tau * v / dv;
+
+            v = BLASFEO_DVECEL(nlp_out->lam+ii, jj);
+            dv = BLASFEO_DVECEL(nlp_mem->qp_out->lam+ii, jj) - v;
+            if (dv < 0.0 && -tau * v < mem->alpha_dual * dv)
+                mem->alpha_dual = -tau * v / dv;
+        }
+    }
+
+    return;
+}
+
+
+
+static void ocp_nlp_ipm_update_variables(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_ipm_memory *mem)
+{
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_qp_out *qp_out = nlp_mem->qp_out;
+
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
+    int *nz = dims->nz;
+
+    double alpha_p = mem->alpha_prim;
+    double alpha_d = mem->alpha_dual;
+
+    int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        // primal variables and slacks
+        blasfeo_daxpy(nv[ii], alpha_p, qp_out->ux+ii, 0, nlp_out->ux+ii, 0, nlp_out->ux+ii, 0);
+
+        blasfeo_dvecsc(2*ni[ii], 1.0-alpha_p, nlp_out->t+ii, 0);
+        blasfeo_daxpy(2*ni[ii], alpha_p, qp_out->t+ii, 0, nlp_out->t+ii, 0, nlp_out->t+ii, 0);
+
+        // dual variables
+        if (ii < N)
+        {
+            blasfeo_dvecsc(nx[ii+1], 1.0-alpha_d, nlp_out->pi+ii, 0);
+            blasfeo_daxpy(nx[ii+1], alpha_d, qp_out->pi+ii, 0, nlp_out->pi+ii, 0, nlp_out->pi+ii, 0);
+        }
+
+        blasfeo_dvecsc(2*ni[ii], 1.0-alpha_d, nlp_out->lam+ii, 0);
+        blasfeo_daxpy(2*ni[ii], alpha_d, qp_out->lam+ii, 0, nlp_out->lam+ii, 0, nlp_out->lam+ii, 0);
+
+        // linear update of algebraic variables using state and input sensitivity
+        if (ii < N)
+        {
+            blasfeo_dgemv_t(nu[ii]+nx[ii], nz[ii], alpha_p, nlp_mem->dzduxt+ii, 0, 0, qp_out->ux+ii, 0,
+                            1.0, nlp_mem->z_alg+ii, 0, nlp_out->z+ii, 0);
+        }
+    }
+
+    return;
+}
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+int ocp_nlp_ipm(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+                void *opts_, void *mem_, void *work_)
+{
+    acados_timer timer0, timer1;
+
+    acados_tic(&timer0);
+
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_nlp_ipm_memory *mem = mem_;
+    ocp_nlp_in *nlp_in = nlp_in_;
+    ocp_nlp_out *nlp_out = nlp_out_;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+
+    ocp_nlp_ipm_workspace *work = work_;
+    ocp_nlp_ipm_cast_workspace(config, dims, opts, mem, work);
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+
+    // zero timers
+    double total_time = 0.0;
+    mem->time_qp_sol = 0.0;
+    mem->time_lin = 0.0;
+    mem->time_reg = 0.0;
+    mem->time_tot = 0.0;
+
+    int N = dims->N;
+
+    int ii;
+
+    int newton_status = ACADOS_SUCCESS;
+
+#if defined(ACADOS_WITH_OPENMP)
+    // backup number of threads
+    int num_threads_bkp = omp_get_num_threads();
+    // set number of threads
+    omp_set_num_threads(opts->nlp_opts->num_threads);
+    #pragma omp parallel
+    { // beginning of parallel region
+#endif
+
+    // alias to dynamics_memory
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp for
+#endif
+    for (ii = 0; ii < N; ii++)
+    {
+        config->dynamics[ii]->memory_set_ux_ptr(nlp_out->ux+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_tmp_ux_ptr(nlp_work->tmp_nlp_out->ux+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_ux1_ptr(nlp_out->ux+ii+1, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_tmp_ux1_ptr(nlp_work->tmp_nlp_out->ux+ii+1, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_pi_ptr(nlp_out->pi+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_tmp_pi_ptr(nlp_work->tmp_nlp_out->pi+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_BAbt_ptr(nlp_mem->qp_in->BAbt+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_RSQrq_ptr(nlp_mem->qp_in->RSQrq+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_dzduxt_ptr(nlp_mem->dzduxt+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_sim_guess_ptr(nlp_mem->sim_guess+ii, nlp_mem->set_sim_guess+ii, nlp_mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_z_alg_ptr(nlp_mem->z_alg+ii, nlp_mem->dynamics[ii]);
+    }
+
+    // alias to cost_memory
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        config->cost[ii]->memory_set_ux_ptr(nlp_out->ux+ii, nlp_mem->cost[ii]);
+        config->cost[ii]->memory_set_tmp_ux_ptr(nlp_work->tmp_nlp_out->ux+ii, nlp_mem->cost[ii]);
+        config->cost[ii]->memory_set_z_alg_ptr(nlp_mem->z_alg+ii, nlp_mem->cost[ii]);
+        config->cost[ii]->memory_set_dzdux_tran_ptr(nlp_mem->dzduxt+ii, nlp_mem->cost[ii]);
+        config->cost[ii]->memory_set_RSQrq_ptr(nlp_mem->qp_in->RSQrq+ii, nlp_mem->cost[ii]);
+        config->cost[ii]->memory_set_Z_ptr(nlp_mem->qp_in->Z+ii, nlp_mem->cost[ii]);
+    }
+    // alias to constraints_memory
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        config->constraints[ii]->memory_set_ux_ptr(nlp_out->ux+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_tmp_ux_ptr(nlp_work->tmp_nlp_out->ux+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_lam_ptr(nlp_out->lam+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_tmp_lam_ptr(nlp_work->tmp_nlp_out->lam+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_z_alg_ptr(nlp_mem->z_alg+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_dzdux_tran_ptr(nlp_mem->dzduxt+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_DCt_ptr(nlp_mem->qp_in->DCt+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_RSQrq_ptr(nlp_mem->qp_in->RSQrq+ii, nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_idxb_ptr(nlp_mem->qp_in->idxb[ii], nlp_mem->constraints[ii]);
+        config->constraints[ii]->memory_set_idxs_ptr(nlp_mem->qp_in->idxs[ii], nlp_mem->constraints[ii]);
+    }
+
+    // alias to regularize memory
+    config->regularize->memory_set_RSQrq_ptr(dims->regularize, nlp_mem->qp_in->RSQrq, nlp_mem->regularize_mem);
+    config->regularize->memory_set_rq_ptr(dims->regularize, nlp_mem->qp_in->rqz, nlp_mem->regularize_mem);
+    config->regularize->memory_set_BAbt_ptr(dims->regularize, nlp_mem->qp_in->BAbt, nlp_mem->regularize_mem);
+    config->regularize->memory_set_b_ptr(dims->regularize, nlp_mem->qp_in->b, nlp_mem->regularize_mem);
+    config->regularize->memory_set_idxb_ptr(dims->regularize, nlp_mem->qp_in->idxb, nlp_mem->regularize_mem);
+    config->regularize->memory_set_DCt_ptr(dims->regularize, nlp_mem->qp_in->DCt, nlp_mem->regularize_mem);
+    config->regularize->memory_set_ux_ptr(dims->regularize, nlp_mem->qp_out->ux, nlp_mem->regularize_mem);
+    config->regularize->memory_set_pi_ptr(dims->regularize, nlp_mem->qp_out->pi, nlp_mem->regularize_mem);
+    config->regularize->memory_set_lam_ptr(dims->regularize, nlp_mem->qp_out->lam, nlp_mem->regularize_mem);
+
+    // copy sampling times into dynamics model
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp for
+#endif
+    for (ii = 0; ii < N; ii++)
+    {
+        config->dynamics[ii]->model_set(config->dynamics[ii], dims->dynamics[ii],
+                                         nlp_in->dynamics[ii], "T", nlp_in->Ts+ii);
+    }
+
+#if defined(ACADOS_WITH_OPENMP)
+    } // end of parallel region
+#endif
+
+    // initialize QP
+    ocp_nlp_initialize_qp(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+    // main ipm loop
+    int ipm_iter = 0;
+    nlp_mem->sqp_iter = &ipm_iter;
+
+    mem->mu = opts->mu_init;
+
+    for (; ipm_iter < opts->max_iter; ipm_iter++)
+    {
+        if (opts->print_level > 0)
+            printf("\n------- ipm iter %d (max_iter %d), mu %e --------\n", ipm_iter, opts->max_iter, mem->mu);
+
+        // linearizate NLP and update QP matrices
+        acados_tic(&timer1);
+        ocp_nlp_approximate_qp_matrices(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+        mem->time_lin += acados_toc(&timer1);
+
+        // constraint values in ineq_fun, cost gradient in rqz, dynamics residual in b
+        ocp_nlp_approximate_qp_vectors_sqp(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+        if (ipm_iter == 0)
+            ocp_nlp_ipm_initialize_slacks(dims, nlp_out, opts, mem);
+
+        // compute nlp residuals
+        ocp_nlp_res_compute(dims, nlp_in, nlp_out, mem->nlp_res, nlp_mem);
+
+        nlp_out->inf_norm_res = mem->nlp_res->inf_norm_res_g;
+        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_b > nlp_out->inf_norm_res) ?
+                                    mem->nlp_res->inf_norm_res_b :
+                                    nlp_out->inf_norm_res;
+        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_d > nlp_out->inf_norm_res) ?
+                                    mem->nlp_res->inf_norm_res_d :
+                                    nlp_out->inf_norm_res;
+        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_m > nlp_out->inf_norm_res) ?
+                                    mem->nlp_res->inf_norm_res_m :
+                                    nlp_out->inf_norm_res;
+
+        // save statistics
+        if (ipm_iter < mem->stat_m)
+        {
+            mem->stat[mem->stat_n*ipm_iter+0] = mem->nlp_res->inf_norm_res_g;
+            mem->stat[mem->stat_n*ipm_iter+1] = mem->nlp_res->inf_norm_res_b;
+            mem->stat[mem->stat_n*ipm_iter+2] = mem->nlp_res->inf_norm_res_d;
+            mem->stat[mem->stat_n*ipm_iter+3] = mem->nlp_res->inf_norm_res_m;
+            mem->stat[mem->stat_n*ipm_iter+4] = mem->mu;
+        }
+
+        // exit conditions on residuals
+        if ((mem->nlp_res->inf_norm_res_g < opts->tol_stat) &
+            (mem->nlp_res->inf_norm_res_b < opts->tol_eq) &
+            (mem->nlp_res->inf_norm_res_d < opts->tol_ineq) &
+            (mem->nlp_res->inf_norm_res_m < opts->tol_comp))
+        {
+            mem->status = ACADOS_SUCCESS;
+            break;
+        }
+
+        // barrier parameter for this iteration
+        ocp_nlp_ipm_update_barrier(dims, nlp_out, opts, mem);
+
+        // regularize Hessian
+        acados_tic(&timer1);
+        config->regularize->regularize_hessian(config->regularize, dims->regularize,
+                                               opts->nlp_opts->regularize, nlp_mem->regularize_mem);
+        mem->time_reg += acados_toc(&timer1);
+
+        // Newton step
+        acados_tic(&timer1);
+        newton_status = ocp_nlp_ipm_newton_step(dims, nlp_out, opts, mem);
+        mem->time_qp_sol += acados_toc(&timer1);
+
+        if (newton_status != ACADOS_SUCCESS)
+        {
+            printf("ocp_nlp_ipm: Newton system solution failed in iteration %d\n", ipm_iter);
+            mem->status = ACADOS_QP_FAILURE;
+            break;
+        }
+
+        // fraction to the boundary
+        ocp_nlp_ipm_step_length(dims, nlp_out, opts, mem);
+
+        if (ipm_iter+1 < mem->stat_m)
+        {
+            mem->stat[mem->stat_n*(ipm_iter+1)+5] = mem->alpha_prim;
+            mem->stat[mem->stat_n*(ipm_iter+1)+6] = mem->alpha_dual;
+        }
+
+        ocp_nlp_ipm_update_variables(dims, nlp_out, mem);
+
+        if (opts->print_level > 0)
+        {
+            printf("Residuals: stat: %e, eq: %e, ineq: %e, comp: %e, alpha: %e %e.\n",
+                   mem->nlp_res->inf_norm_res_g, mem->nlp_res->inf_norm_res_b,
+                   mem->nlp_res->inf_norm_res_d, mem->nlp_res->inf_norm_res_m,
+                   mem->alpha_prim, mem->alpha_dual);
+        }
+    }
+
+    if (ipm_iter == opts->max_iter)
+    {
+        mem->status = ACADOS_MAXITER;
+        printf("\n ocp_nlp_ipm: maximum iterations reached\n");
+    }
+
+    // stop timer
+    total_time += acados_toc(&timer0);
+
+    // save ipm iterations number
+    mem->ipm_iter = ipm_iter;
+    nlp_out->sqp_iter = ipm_iter;
+
+    // save time
+    mem->time_tot = total_time;
+    nlp_out->total_time = total_time;
+
+#if defined(ACADOS_WITH_OPENMP)
+    // restore number of threads
+    omp_set_num_threads(num_threads_bkp);
+#endif
+
+    return mem->status;
+}
+
+
+
+int ocp_nlp_ipm_precompute(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+                void *opts_, void *mem_, void *work_)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_ipm_opts *opts = opts_;
+    ocp_nlp_ipm_memory *mem = mem_;
+    ocp_nlp_in *nlp_in = nlp_in_;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+
+    ocp_nlp_ipm_workspace *work = work_;
+    ocp_nlp_ipm_cast_workspace(config, dims, opts, mem, work);
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+
+    int N = dims->N;
+    int status = ACADOS_SUCCESS;
+
+    int ii;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        if (dims->ns[ii] > 0)
+        {
+            printf("ocp_nlp_ipm_precompute: soft constraints are not supported, got ns = %d at stage %d.\n",
+                   dims->ns[ii], ii);
+            exit(1);
+        }
+    }
+
+    // precompute
+    for (ii = 0; ii < N; ii++)
+    {
+        // set T
+        config->dynamics[ii]->model_set(config->dynamics[ii], dims->dynamics[ii],
+                                        nlp_in->dynamics[ii], "T", nlp_in->Ts+ii);
+        // dynamics precompute
+        status = config->dynamics[ii]->precompute(config->dynamics[ii], dims->dynamics[ii],
+                                                nlp_in->dynamics[ii], opts->nlp_opts->dynamics[ii],
+                                                nlp_mem->dynamics[ii], nlp_work->dynamics[ii]);
+        if (status != ACADOS_SUCCESS)
+            return status;
+    }
+    return status;
+}
+
+
+
+void ocp_nlp_ipm_get(void *config_, void *dims_, void *mem_, const char *field, void *return_value_)
+{
+    ocp_nlp_ipm_memory *mem = mem_;
+
+    if (!strcmp("sqp_iter", field) || !strcmp("ipm_iter", field))
+    {
+        int *value = return_value_;
+        *value = mem->ipm_iter;
+    }
+    else if (!strcmp("status", field))
+    {
+        int *value = return_value_;
+        *value = mem->status;
+    }
+    else if (!strcmp("time_tot", field) || !strcmp("tot_time", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_tot;
+    }
+    else if (!strcmp("time_qp_sol", field) || !strcmp("time_qp", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_qp_sol;
+    }
+    else if (!strcmp("time_lin", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_lin;
+    }
+    else if (!strcmp("time_reg", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_reg;
+    }
+    else if (!strcmp("mu", field))
+    {
+        double *value = return_value_;
+        *value = mem->mu;
+    }
+    else if (!strcmp("nlp_res", field))
+    {
+        ocp_nlp_res **value = return_value_;
+        *value = mem->nlp_res;
+    }
+    else if (!strcmp("stat", field))
+    {
+        double **value = return_value_;
+        *value = mem->stat;
+    }
+    else if (!strcmp("stat_m", field))
+    {
+        int *value = return_value_;
+        *value = mem->stat_m;
+    }
+    else if (!strcmp("stat_n", field))
+    {
+        int *value = return_value_;
+        *value = mem->stat_n;
+    }
+    else if (!strcmp("nlp_mem", field))
+    {
+        void **value = return_value_;
+        *value = mem->nlp_mem;
+    }
+    else if (!strcmp("qp_in", field))
+    {
+        void **value = return_value_;
+        *value = mem->nlp_mem->qp_in;
+    }
+    else if (!strcmp("qp_out", field))
+    {
+        void **value = return_value_;
+        *value = mem->nlp_mem->qp_out;
+    }
+    else if (!strcmp("qp_iter", field))
+    {
+        // one Newton system per iteration
+        int *value = return_value_;
+        *value = 1;
+    }
+    else
+    {
+        printf("\nerror: field %s not available in ocp_nlp_ipm_get\n", field);
+        exit(1);
+    }
+
+}
+
+
+
+void ocp_nlp_ipm_config_initialize_default(void *config_)
+{
+    ocp_nlp_config *config = (ocp_nlp_config *) config_;
+
+    config->opts_calculate_size = &ocp_nlp_ipm_opts_calculate_size;
+    config->opts_assign = &ocp_nlp_ipm_opts_assign;
+    config->opts_initialize_default = &ocp_nlp_ipm_opts_initialize_default;
+    config->opts_update = &ocp_nlp_ipm_opts_update;
+    config->opts_set = &ocp_nlp_ipm_opts_set;
+    config->opts_set_at_stage = &ocp_nlp_ipm_opts_set_at_stage;
+    config->memory_calculate_size = &ocp_nlp_ipm_memory_calculate_size;
+    config->memory_assign = &ocp_nlp_ipm_memory_assign;
+    config->workspace_calculate_size = &ocp_nlp_ipm_workspace_calculate_size;
+    config->evaluate = &ocp_nlp_ipm;
+    config->config_initialize_default = &ocp_nlp_ipm_config_initialize_default;
+    config->precompute = &ocp_nlp_ipm_precompute;
+    config->shift = &ocp_nlp_common_shift;
+    config->get = &ocp_nlp_ipm_get;
+
+    return;
+}
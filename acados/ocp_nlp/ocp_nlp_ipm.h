@@ -0,0 +1,203 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+
+/// \addtogroup ocp_nlp
+/// @{
+/// \addtogroup ocp_nlp_solver
+/// @{
+/// \addtogroup ocp_nlp_ipm ocp_nlp_ipm
+/// @{
+
+#ifndef ACADOS_OCP_NLP_OCP_NLP_IPM_H_
+#define ACADOS_OCP_NLP_OCP_NLP_IPM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// hpipm
+#include "hpipm/include/hpipm_d_ocp_qp_ipm.h"
+// acados
+#include "acados/ocp_nlp/ocp_nlp_common.h"
+#include "acados/ocp_nlp/ocp_nlp_reg_common.h"
+#include "acados/sim/sim_common.h"
+#include "acados/utils/types.h"
+
+
+
+/************************************************
+ * options
+ ************************************************/
+
+// Primal-dual interior point method on the nlp: the inequalities (bounds, linear and nonlinear
+// constraints) get slacks t >= 0 and multipliers lam >= 0 with lam*t = mu. Each iteration
+// eliminates t and lam from the linearized KKT system and solves the remaining
+// equality-constrained qp with a single Riccati recursion (hpipm). Soft constraints (ns > 0) are
+// not supported. If all states at stage 0 are bounded (nbx[0] == nx[0]), the bounds must be
+// equalities (initial state embedding): they are eliminated from the Newton system.
+typedef enum
+{
+    BARRIER_MONOTONE,  // decrease mu once the barrier problem is solved to accuracy kappa_eps*mu
+    BARRIER_ADAPTIVE,  // mu from the average complementarity and its spread (LOQO rule)
+} ocp_nlp_ipm_barrier_t;
+
+typedef struct
+{
+	ocp_nlp_opts *nlp_opts;
+    double tol_stat;     // exit tolerance on stationarity condition
+    double tol_eq;       // exit tolerance on equality constraints
+    double tol_ineq;     // exit tolerance on inequality constraints
+    double tol_comp;     // exit tolerance on complementarity condition
+    int max_iter;
+    int rti_phase;       // only phase 0 at the moment
+    int print_level;     // possible values 0, 1
+    int barrier_strategy; // ocp_nlp_ipm_barrier_t
+    double mu_init;      // initial barrier parameter (also lower bound on the initial slacks)
+    double mu_min;       // lower bound on the barrier parameter
+    double kappa_mu;     // linear decrease factor of mu (monotone strategy)
+    double theta_mu;     // superlinear decrease exponent of mu (monotone strategy)
+    double kappa_eps;    // barrier problem accuracy relative to mu (monotone strategy)
+    double tau_min;      // lower bound on the fraction-to-the-boundary parameter
+    struct d_ocp_qp_ipm_arg *newton_arg; // hpipm arguments of the Newton system
+
+} ocp_nlp_ipm_opts;
+
+//
+int ocp_nlp_ipm_opts_calculate_size(void *config, void *dims);
+//
+void *ocp_nlp_ipm_opts_assign(void *config, void *dims, void *raw_memory);
+//
+void ocp_nlp_ipm_opts_initialize_default(void *config, void *dims, void *opts);
+//
+void ocp_nlp_ipm_opts_update(void *config, void *dims, void *opts);
+//
+void ocp_nlp_ipm_opts_set(void *config_, void *opts_, const char *field, void* value);
+//
+void ocp_nlp_ipm_opts_set_at_stage(void *config_, void *opts_, int stage, const char *field, void* value);
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+typedef struct
+{
+    // nlp memory
+    ocp_nlp_memory *nlp_mem;
+
+    // residuals
+    ocp_nlp_res *nlp_res;
+
+    // Newton system: equality-constrained qp, without the initial state if eliminated
+    ocp_qp_dims *newton_dims;
+    ocp_qp_in *newton_qp_in;
+    ocp_qp_out *newton_qp_out;
+    struct d_ocp_qp_ipm_ws *newton_ws;
+    int elim_x0;                // the initial state is eliminated from the Newton system
+
+    // barrier terms of the inequalities (lower and upper rows)
+    struct blasfeo_dvec *W;     // lam/t
+    struct blasfeo_dvec *q;     // lam + mu/t - lam/t*h, with h the constraint value (>= 0)
+    struct blasfeo_dvec *Jdv;   // constraint linearization times the primal step
+    struct blasfeo_dmat RSQ0;   // condensed Hessian at stage 0 (initial state elimination)
+    struct blasfeo_dvec rq0;    // condensed gradient at stage 0
+    struct blasfeo_dvec dx0;    // step of the initial state
+    struct blasfeo_dvec tmp_nv; // stationarity at stage 0
+    struct blasfeo_dmat tmp_DCt; // DCt scaled by the barrier weights
+    struct blasfeo_dvec tmp_ng;
+
+    double mu;                  // barrier parameter
+    double alpha_prim;          // last primal step length
+    double alpha_dual;          // last dual step length
+
+    double time_qp_sol;
+    double time_lin;
+    double time_reg;
+    double time_tot;
+
+    // statistics: residuals (4), barrier parameter, primal and dual step length
+    double *stat;
+    int stat_m;
+    int stat_n;
+
+    int status;
+    int ipm_iter;
+
+} ocp_nlp_ipm_memory;
+
+//
+int ocp_nlp_ipm_memory_calculate_size(void *config, void *dims, void *opts_);
+//
+void *ocp_nlp_ipm_memory_assign(void *config, void *dims, void *opts_, void *raw_memory);
+
+
+
+/************************************************
+ * workspace
+ ************************************************/
+
+typedef struct
+{
+	ocp_nlp_workspace *nlp_work;
+
+} ocp_nlp_ipm_workspace;
+
+//
+int ocp_nlp_ipm_workspace_calculate_size(void *config, void *dims, void *opts_);
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+//
+int ocp_nlp_ipm(void *config, void *dims, void *nlp_in, void *nlp_out,
+                void *opts_, void *mem, void *work_);
+//
+void ocp_nlp_ipm_config_initialize_default(void *config_);
+//
+int ocp_nlp_ipm_precompute(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+                void *opts_, void *mem_, void *work_);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // ACADOS_OCP_NLP_OCP_NLP_IPM_H_
+/// @}
+/// @}
+/// @}
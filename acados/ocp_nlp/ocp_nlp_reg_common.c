@@ -41,6 +41,9 @@
 
 #include "acados/ocp_nlp/ocp_nlp_reg_common.h"
 
+#include "blasfeo/include/blasfeo_d_aux.h"
+#include "blasfeo/include/blasfeo_d_blas.h"
+
 
 
 /************************************************
@@ -224,4 +227,25 @@ void acados_project(int dim, double *A, double *V, double *d, double *e, double
 
 
 
+// cholesky test for positive definiteness, no eigen decomposition needed
+int acados_cholesky_check(int dim, struct blasfeo_dmat *A, int ai, int aj, struct blasfeo_dmat *L, double epsilon)
+{
+    int i;
+
+    blasfeo_dgecp(dim, dim, A, ai, aj, L, 0, 0);
+    blasfeo_ddiare(dim, -epsilon, L, 0, 0);
+
+    // blasfeo sets the diagonal of L to zero on non-positive (or nan) pivots
+    blasfeo_dpotrf_l(dim, L, 0, 0, L, 0, 0);
+
+    for (i = 0; i < dim; i++)
+    {
+        if (!(BLASFEO_DMATEL(L, i, i) > 0.0))
+            return 0;
+    }
+
+    return 1;
+}
+
+
 
@@ -97,6 +97,7 @@ typedef struct
     void (*memory_set_ux_ptr)(ocp_nlp_reg_dims *dims, struct blasfeo_dvec *vec, void *memory);
     void (*memory_set_pi_ptr)(ocp_nlp_reg_dims *dims, struct blasfeo_dvec *vec, void *memory);
     void (*memory_set_lam_ptr)(ocp_nlp_reg_dims *dims, struct blasfeo_dvec *vec, void *memory);
+    void (*memory_get)(void *config, ocp_nlp_reg_dims *dims, void *memory, char *field, void* value);
     /* functions */
     void (*regularize_hessian)(void *config, ocp_nlp_reg_dims *dims, void *opts, void *memory);
     void (*correct_dual_sol)(void *config, ocp_nlp_reg_dims *dims, void *opts, void *memory);
@@ -113,6 +114,8 @@ void *ocp_nlp_reg_config_assign(void *raw_memory);
 void acados_reconstruct_A(int dim, double *A, double *V, double *d);
 void acados_mirror(int dim, double *A, double *V, double *d, double *e, double epsilon);
 void acados_project(int dim, double *A, double *V, double *d, double *e, double epsilon);
+// returns 1 if the lower triangle of A - epsilon*I admits a cholesky factorization (stored in L)
+int acados_cholesky_check(int dim, struct blasfeo_dmat *A, int ai, int aj, struct blasfeo_dmat *L, double epsilon);
 
 
 
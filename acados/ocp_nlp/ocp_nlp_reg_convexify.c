@@ -551,7 +551,7 @@ void ocp_nlp_reg_convexify_regularize_hessian(void *config, ocp_nlp_reg_dims *di
     ocp_nlp_reg_convexify_memory *mem = mem_;
     ocp_nlp_reg_convexify_opts *opts = opts_;
 
-    int ii, jj;
+    int ii;
 
     int *nx = dims->nx;
     int *nu = dims->nu;
@@ -613,13 +613,8 @@ void ocp_nlp_reg_convexify_regularize_hessian(void *config, ocp_nlp_reg_dims *di
         // printf("BAQ\n");
         // blasfeo_print_dmat(nx+nu, nx, &BAQ, 0, 0);
 
-        blasfeo_unpack_dmat(nu[ii], nu[ii], mem->RSQrq[ii], 0, 0, mem->R, nu[ii]);
-        acados_eigen_decomposition(nu[ii], mem->R, mem->V, mem->d, mem->e);
-
-        bool needs_regularization = false;
-        for (jj = 0; jj < nu[ii]; jj++)
-            if (mem->d[jj] < 1e-10)
-                needs_regularization = true;
+        // R - 1e-10*I positive definite iff all eigenvalues of R are >= 1e-10
+        bool needs_regularization = !acados_cholesky_check(nu[ii], mem->RSQrq[ii], 0, 0, &mem->L, 1e-10);
 
         if (needs_regularization)
         {
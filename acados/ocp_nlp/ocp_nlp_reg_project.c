@@ -41,6 +41,7 @@
 
 #include "acados/ocp_nlp/ocp_nlp_reg_common.h"
 #include "acados/utils/math.h"
+#include "acados/utils/mem.h"
 
 #include "blasfeo/include/blasfeo_d_aux.h"
 #include "blasfeo/include/blasfeo_d_blas.h"
@@ -70,6 +71,7 @@ void ocp_nlp_reg_project_opts_initialize_default(void *config_, ocp_nlp_reg_dims
     ocp_nlp_reg_project_opts *opts = opts_;
 
     opts->epsilon = 1e-4;
+    opts->chol_first = 1;
 
     return;
 }
@@ -86,6 +88,11 @@ void ocp_nlp_reg_project_opts_set(void *config_, ocp_nlp_reg_dims *dims, void *o
         double *d_ptr = value;
         opts->epsilon = *d_ptr;
     }
+    else if (!strcmp(field, "chol_first"))
+    {
+        int *i_ptr = value;
+        opts->chol_first = *i_ptr;
+    }
     else
     {
         printf("\nerror: field %s not available in ocp_nlp_reg_project_opts_set\n", field);
@@ -123,6 +130,16 @@ int ocp_nlp_reg_project_memory_calculate_size(void *config_, ocp_nlp_reg_dims *d
     size += nuxM*nuxM*sizeof(double);  // V
     size += 2*nuxM*sizeof(double);     // d e
     size += (N+1)*sizeof(struct blasfeo_dmat *); // RSQrq
+    size += (N+1)*sizeof(struct blasfeo_dmat); // L
+    size += (N+1)*sizeof(int); // corrected
+
+    size += 1 * 8;
+    size += 1 * 64;
+
+    for(ii=0; ii<=N; ii++)
+    {
+        size += blasfeo_memsize_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii]); // L
+    }
 
     return size;
 }
@@ -163,6 +180,24 @@ void *ocp_nlp_reg_project_memory_assign(void *config_, ocp_nlp_reg_dims *dims, v
     mem->RSQrq = (struct blasfeo_dmat **) c_ptr;
     c_ptr += (N+1)*sizeof(struct blasfeo_dmat *); // RSQrq
 
+    align_char_to(8, &c_ptr);
+
+    assign_and_advance_blasfeo_dmat_structs(N+1, &mem->L, &c_ptr);
+
+    assign_and_advance_int(N+1, &mem->corrected, &c_ptr);
+    for(ii=0; ii<=N; ii++)
+    {
+        mem->corrected[ii] = 0;
+    }
+    mem->num_corrected = 0;
+
+    align_char_to(64, &c_ptr);
+
+    for(ii=0; ii<=N; ii++)
+    {
+        assign_and_advance_blasfeo_dmat_mem(nu[ii]+nx[ii], nu[ii]+nx[ii], &mem->L[ii], &c_ptr);
+    }
+
     assert((char *) mem + ocp_nlp_reg_project_memory_calculate_size(config_, dims, opts_) >= c_ptr);
 
     return mem;
@@ -266,6 +301,32 @@ void ocp_nlp_reg_project_memory_set(void *config_, ocp_nlp_reg_dims *dims, void
 
 
 
+void ocp_nlp_reg_project_memory_get(void *config_, ocp_nlp_reg_dims *dims, void *memory_, char *field, void *value)
+{
+    ocp_nlp_reg_project_memory *mem = memory_;
+
+    if (!strcmp(field, "corrected"))
+    {
+        int *int_ptr = value;
+        for (int ii=0; ii<=dims->N; ii++)
+            int_ptr[ii] = mem->corrected[ii];
+    }
+    else if (!strcmp(field, "num_corrected"))
+    {
+        int *int_ptr = value;
+        *int_ptr = mem->num_corrected;
+    }
+    else
+    {
+        printf("\nerror: field %s not available in ocp_nlp_reg_project_memory_get\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
 /************************************************
  * functions
  ************************************************/
@@ -279,16 +340,36 @@ void ocp_nlp_reg_project_regularize_hessian(void *config, ocp_nlp_reg_dims *dims
 
     int *nx = dims->nx;
     int *nu = dims->nu;
+    int N = dims->N;
 
-    for(ii=0; ii<=dims->N; ii++)
+    // a block is left untouched by the projection iff all its eigenvalues are >= epsilon,
+    // which is checked stage-wise by a cholesky factorization of block - epsilon*I
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for(ii=0; ii<=N; ii++)
     {
         // make symmetric
         blasfeo_dtrtr_l(nu[ii]+nx[ii], mem->RSQrq[ii], 0, 0, mem->RSQrq[ii], 0, 0);
 
-        // regularize
+        if (opts->chol_first)
+            mem->corrected[ii] = !acados_cholesky_check(nu[ii]+nx[ii], mem->RSQrq[ii], 0, 0,
+                                                        &mem->L[ii], opts->epsilon);
+        else
+            mem->corrected[ii] = 1;
+    }
+
+    // regularize the remaining blocks (shared eigen decomposition workspace)
+    mem->num_corrected = 0;
+    for(ii=0; ii<=N; ii++)
+    {
+        if (!mem->corrected[ii])
+            continue;
+
         blasfeo_unpack_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii], mem->RSQrq[ii], 0, 0, mem->reg_hess, nu[ii]+nx[ii]);
         acados_project(nu[ii]+nx[ii], mem->reg_hess, mem->V, mem->d, mem->e, opts->epsilon);
         blasfeo_pack_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii], mem->reg_hess, nu[ii]+nx[ii], mem->RSQrq[ii], 0, 0);
+        mem->num_corrected++;
     }
 }
 
@@ -325,6 +406,7 @@ void ocp_nlp_reg_project_config_initialize_default(ocp_nlp_reg_config *config)
     config->memory_set_ux_ptr = &ocp_nlp_reg_project_memory_set_ux_ptr;
     config->memory_set_pi_ptr = &ocp_nlp_reg_project_memory_set_pi_ptr;
     config->memory_set_lam_ptr = &ocp_nlp_reg_project_memory_set_lam_ptr;
+    config->memory_get = &ocp_nlp_reg_project_memory_get;
     // functions
     config->regularize_hessian = &ocp_nlp_reg_project_regularize_hessian;
     config->correct_dual_sol = &ocp_nlp_reg_project_correct_dual_sol;
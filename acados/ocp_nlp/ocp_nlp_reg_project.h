@@ -67,6 +67,7 @@ extern "C" {
 typedef struct
 {
     double epsilon;
+    int chol_first;  // try a cholesky of each block first, project only on failure
 } ocp_nlp_reg_project_opts;
 
 //
@@ -91,6 +92,10 @@ typedef struct
     double *d; // TODO move to workspace
     double *e; // TODO move to workspace
 
+    struct blasfeo_dmat *L;  // cholesky factor, one per stage
+    int *corrected;  // 1 if the stage block was projected in the last call
+    int num_corrected;
+
     // giaf's
     struct blasfeo_dmat **RSQrq;  // pointer to RSQrq in qp_in
 } ocp_nlp_reg_project_memory;
@@ -99,6 +104,8 @@ typedef struct
 int ocp_nlp_reg_project_memory_calculate_size(void *config, ocp_nlp_reg_dims *dims, void *opts);
 //
 void *ocp_nlp_reg_project_memory_assign(void *config, ocp_nlp_reg_dims *dims, void *opts, void *raw_memory);
+//
+void ocp_nlp_reg_project_memory_get(void *config_, ocp_nlp_reg_dims *dims, void *memory_, char *field, void *value);
 
 /************************************************
  * workspace
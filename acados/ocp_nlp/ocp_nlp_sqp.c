@@ -128,6 +128,18 @@ void ocp_nlp_sqp_opts_initialize_default(void *config_, void *dims_, void *opts_
     opts->rti_phase = 0;
     opts->print_level = 0;
 
+    // globalization
+    opts->globalization = FIXED_STEP;
+    opts->alpha_min = 0.05;
+    opts->alpha_reduction = 0.7;
+    opts->eps_sufficient_descent = 1e-4;
+    opts->use_SOC = 0;
+
+    // quasi-Newton
+    opts->qn_update = QN_NONE;
+    opts->qn_damping = 0.2;
+    opts->qn_sr1_tol = 1e-8;
+
     // overwrite default submodules opts
 
     // qp tolerance
@@ -254,6 +266,58 @@ void ocp_nlp_sqp_opts_set(void *config_, void *opts_, const char *field, void* v
             }
             opts->print_level = *print_level;
         }
+        else if (!strcmp(field, "globalization"))
+        {
+            int* globalization = (int *) value;
+            if (*globalization != FIXED_STEP && *globalization != MERIT_BACKTRACKING)
+            {
+                printf("\nerror: ocp_nlp_sqp_opts_set: invalid value for globalization field, got %d.", *globalization);
+                printf("possible values are: %d (FIXED_STEP), %d (MERIT_BACKTRACKING)\n", FIXED_STEP, MERIT_BACKTRACKING);
+                exit(1);
+            }
+            opts->globalization = *globalization;
+        }
+        else if (!strcmp(field, "alpha_min"))
+        {
+            double* alpha_min = (double *) value;
+            opts->alpha_min = *alpha_min;
+        }
+        else if (!strcmp(field, "alpha_reduction"))
+        {
+            double* alpha_reduction = (double *) value;
+            opts->alpha_reduction = *alpha_reduction;
+        }
+        else if (!strcmp(field, "eps_sufficient_descent"))
+        {
+            double* eps_sufficient_descent = (double *) value;
+            opts->eps_sufficient_descent = *eps_sufficient_descent;
+        }
+        else if (!strcmp(field, "use_SOC"))
+        {
+            int* use_SOC = (int *) value;
+            opts->use_SOC = *use_SOC;
+        }
+        else if (!strcmp(field, "qn_update"))
+        {
+            int* qn_update = (int *) value;
+            if (*qn_update != QN_NONE && *qn_update != QN_BFGS && *qn_update != QN_SR1)
+            {
+                printf("\nerror: ocp_nlp_sqp_opts_set: invalid value for qn_update field, got %d.", *qn_update);
+                printf("possible values are: %d (QN_NONE), %d (QN_BFGS), %d (QN_SR1)\n", QN_NONE, QN_BFGS, QN_SR1);
+                exit(1);
+            }
+            opts->qn_update = *qn_update;
+        }
+        else if (!strcmp(field, "qn_damping"))
+        {
+            double* qn_damping = (double *) value;
+            opts->qn_damping = *qn_damping;
+        }
+        else if (!strcmp(field, "qn_sr1_tol"))
+        {
+            double* qn_sr1_tol = (double *) value;
+            opts->qn_sr1_tol = *qn_sr1_tol;
+        }
         else
         {
             ocp_nlp_opts_set(config, nlp_opts, field, value);
@@ -293,9 +357,10 @@ int ocp_nlp_sqp_memory_calculate_size(void *config_, void *dims_, void *opts_)
     ocp_nlp_sqp_opts *opts = opts_;
     ocp_nlp_opts *nlp_opts = opts->nlp_opts;
 
-    // int N = dims->N;
-    // int *nx = dims->nx;
-    // int *nu = dims->nu;
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
     // int *nz = dims->nz;
 
     int size = 0;
@@ -313,9 +378,28 @@ int ocp_nlp_sqp_memory_calculate_size(void *config_, void *dims_, void *opts_)
     int stat_n = 6;
     if (opts->ext_qp_res)
         stat_n += 4;
+    if (opts->globalization == MERIT_BACKTRACKING)
+        stat_n += 4;
     size += stat_n*stat_m*sizeof(double);
 
+    // quasi-Newton
+    int nux_max = 0;
+    int ni_max = 0;
+    size += (N+1)*sizeof(struct blasfeo_dmat);     // qn_B
+    size += 2*(N+1)*sizeof(struct blasfeo_dvec);   // qn_s qn_g
+    for (int ii = 0; ii <= N; ii++)
+    {
+        size += blasfeo_memsize_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii]); // qn_B
+        size += 2*blasfeo_memsize_dvec(nu[ii]+nx[ii]);              // qn_s qn_g
+        nux_max = nu[ii]+nx[ii] > nux_max ? nu[ii]+nx[ii] : nux_max;
+        ni_max = ni[ii] > ni_max ? ni[ii] : ni_max;
+    }
+    size += 2*blasfeo_memsize_dvec(nux_max); // qn_y qn_Bs
+    size += blasfeo_memsize_dvec(ni_max);    // qn_tmp
+
     size += 8;  // initial align
+    size += 8;  // blasfeo_struct align
+    size += 64; // blasfeo_mem align
 
     make_int_multiple_of(8, &size);
 
@@ -338,9 +422,10 @@ void *ocp_nlp_sqp_memory_assign(void *config_, void *dims_, void *opts_, void *r
 
     char *c_ptr = (char *) raw_memory;
 
-    // int N = dims->N;
-    // int *nx = dims->nx;
-    // int *nu = dims->nu;
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
     // int *nz = dims->nz;
 
     // initial align
@@ -363,8 +448,37 @@ void *ocp_nlp_sqp_memory_assign(void *config_, void *dims_, void *opts_, void *r
     mem->stat_n = 6;
     if (opts->ext_qp_res)
         mem->stat_n += 4;
+    if (opts->globalization == MERIT_BACKTRACKING)
+        mem->stat_n += 4;
     c_ptr += mem->stat_m*mem->stat_n*sizeof(double);
 
+    // blasfeo_struct align
+    align_char_to(8, &c_ptr);
+
+    // quasi-Newton
+    assign_and_advance_blasfeo_dmat_structs(N+1, &mem->qn_B, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N+1, &mem->qn_s, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N+1, &mem->qn_g, &c_ptr);
+
+    // blasfeo_mem align
+    align_char_to(64, &c_ptr);
+
+    int nux_max = 0;
+    int ni_max = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        assign_and_advance_blasfeo_dmat_mem(nu[ii]+nx[ii], nu[ii]+nx[ii], mem->qn_B+ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nu[ii]+nx[ii], mem->qn_s+ii, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nu[ii]+nx[ii], mem->qn_g+ii, &c_ptr);
+        nux_max = nu[ii]+nx[ii] > nux_max ? nu[ii]+nx[ii] : nux_max;
+        ni_max = ni[ii] > ni_max ? ni[ii] : ni_max;
+    }
+    assign_and_advance_blasfeo_dvec_mem(nux_max, &mem->qn_y, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(nux_max, &mem->qn_Bs, &c_ptr);
+    assign_and_advance_blasfeo_dvec_mem(ni_max, &mem->qn_tmp, &c_ptr);
+    mem->qn_iter = -1;
+    mem->qn_step = 0;
+
     mem->status = ACADOS_READY;
 
     assert((char *) raw_memory + ocp_nlp_sqp_memory_calculate_size(config, dims, opts) >= c_ptr);
@@ -452,10 +566,397 @@ static void ocp_nlp_sqp_cast_workspace(ocp_nlp_config *config, ocp_nlp_dims *dim
 
 
 
+/************************************************
+ * globalization
+ ************************************************/
+
+// trial point out + alpha * step in tmp_nlp_out (primal variables only)
+static void ocp_nlp_sqp_trial_point(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_qp_out *qp_out,
+                                    ocp_nlp_out *tmp_nlp_out, double alpha)
+{
+    int i;
+
+    int N = dims->N;
+    int *nv = dims->nv;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        blasfeo_daxpy(nv[i], alpha, qp_out->ux+i, 0, nlp_out->ux+i, 0, tmp_nlp_out->ux+i, 0);
+    }
+
+    return;
+}
+
+
+
+static void ocp_nlp_sqp_copy_qp_out(ocp_nlp_dims *dims, ocp_qp_out *from, ocp_qp_out *to)
+{
+    int i;
+
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *ni = dims->ni;
+
+    for (i = 0; i <= N; i++)
+    {
+        blasfeo_dveccp(nv[i], from->ux+i, 0, to->ux+i, 0);
+        if (i < N)
+            blasfeo_dveccp(nx[i+1], from->pi+i, 0, to->pi+i, 0);
+        blasfeo_dveccp(2*ni[i], from->lam+i, 0, to->lam+i, 0);
+        blasfeo_dveccp(2*ni[i], from->t+i, 0, to->t+i, 0);
+    }
+
+    return;
+}
+
+
+
+// second order correction: resolve the qp with the constraint values at the (rejected) full step
+// minus their linearization along the step, i.e. c(x+d) + J (d_soc - d); uses the stage
+// evaluations of the last merit function call at x+d; the qp step is backed up in tmp_qp_out
+static int ocp_nlp_sqp_second_order_correction(ocp_nlp_config *config, ocp_nlp_dims *dims,
+            ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts,
+            ocp_nlp_sqp_memory *mem, ocp_nlp_sqp_workspace *work)
+{
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+    ocp_qp_xcond_solver_config *qp_solver = config->qp_solver;
+
+    ocp_qp_in *qp_in = nlp_mem->qp_in;
+    ocp_qp_out *qp_out = nlp_mem->qp_out;
+
+    int i;
+
+    int N = dims->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+    int *ns = qp_in->dim->ns;
+
+    acados_timer timer;
+
+    // backup qp rhs and step
+    for (i = 0; i <= N; i++)
+    {
+        if (i < N)
+            blasfeo_dveccp(nx[i+1], qp_in->b+i, 0, work->tmp_qp_in->b+i, 0);
+        blasfeo_dveccp(2*nb[i]+2*ng[i]+2*ns[i], qp_in->d+i, 0, work->tmp_qp_in->d+i, 0);
+    }
+    ocp_nlp_sqp_copy_qp_out(dims, qp_out, work->tmp_qp_out);
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        int nbg = nb[i] + ng[i];
+
+        // dynamics: b = f(x+d) - (BA^T d_i - d_{i+1})
+        if (i < N)
+        {
+            struct blasfeo_dvec *dyn_fun = config->dynamics[i]->memory_get_fun_ptr(nlp_mem->dynamics[i]);
+            blasfeo_dgemv_t(nu[i]+nx[i], nx[i+1], -1.0, qp_in->BAbt+i, 0, 0, work->tmp_qp_out->ux+i, 0,
+                            1.0, dyn_fun, 0, qp_in->b+i, 0);
+            blasfeo_daxpy(nx[i+1], 1.0, work->tmp_qp_out->ux+i+1, nu[i+1], qp_in->b+i, 0, qp_in->b+i, 0);
+        }
+
+        // constraints: the upper part of d is used as workspace for the constraint linearization
+        struct blasfeo_dvec *ineq_fun = config->constraints[i]->memory_get_fun_ptr(nlp_mem->constraints[i]);
+        blasfeo_dvecex_sp(nb[i], 1.0, qp_in->idxb[i], work->tmp_qp_out->ux+i, 0, qp_in->d+i, nbg);
+        blasfeo_dgemv_t(nu[i]+nx[i], ng[i], 1.0, qp_in->DCt+i, 0, 0, work->tmp_qp_out->ux+i, 0,
+                        0.0, qp_in->d+i, nbg+nb[i], qp_in->d+i, nbg+nb[i]);
+        // lower: fun_l(x+d) + J d
+        blasfeo_daxpy(nbg, 1.0, qp_in->d+i, nbg, ineq_fun, 0, qp_in->d+i, 0);
+        // upper: fun_u(x+d) - J d
+        blasfeo_daxpy(nbg, -1.0, qp_in->d+i, nbg, ineq_fun, nbg, qp_in->d+i, nbg);
+        // slacks
+        blasfeo_dvecad_sp(ns[i], 1.0, work->tmp_qp_out->ux+i, nu[i]+nx[i], qp_in->idxs[i], qp_in->d+i, 0);
+        blasfeo_dvecad_sp(ns[i], 1.0, work->tmp_qp_out->ux+i, nu[i]+nx[i]+ns[i], qp_in->idxs[i], qp_in->d+i, nbg);
+        blasfeo_daxpy(2*ns[i], 1.0, work->tmp_qp_out->ux+i, nu[i]+nx[i], ineq_fun, 2*nbg, qp_in->d+i, 2*nbg);
+    }
+
+    // the tightened constraints stay out of the qp: their barrier terms in the qp hessian and
+    // gradient are the ones of the current iterate, which are unchanged
+    ocp_nlp_tightening_qp_bounds(config, dims, nlp_in, nlp_out, opts->nlp_opts, nlp_mem, nlp_work);
+
+    // solve qp
+    acados_tic(&timer);
+    int qp_status = qp_solver->evaluate(qp_solver, dims->qp_solver, qp_in, qp_out,
+                                        opts->nlp_opts->qp_solver_opts, nlp_mem->qp_solver_mem, nlp_work->qp_work);
+    mem->time_qp_sol += acados_toc(&timer);
+
+    config->regularize->correct_dual_sol(config->regularize, dims->regularize,
+                                         opts->nlp_opts->regularize, nlp_mem->regularize_mem);
+
+    // multipliers and slacks of the tightened constraints
+    ocp_nlp_tightening_qp_sol(config, dims, nlp_in, nlp_out, opts->nlp_opts, nlp_mem, nlp_work);
+
+    // restore qp rhs
+    for (i = 0; i <= N; i++)
+    {
+        if (i < N)
+            blasfeo_dveccp(nx[i+1], work->tmp_qp_in->b+i, 0, qp_in->b+i, 0);
+        blasfeo_dveccp(2*nb[i]+2*ng[i]+2*ns[i], work->tmp_qp_in->d+i, 0, qp_in->d+i, 0);
+    }
+
+    return qp_status;
+}
+
+
+
+// backtracking line search on the l1 merit function, returns the step length
+static double ocp_nlp_sqp_line_search(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+            ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts, ocp_nlp_sqp_memory *mem,
+            ocp_nlp_sqp_workspace *work)
+{
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+
+    int sqp_iter = *nlp_mem->sqp_iter;
+
+    ocp_nlp_update_merit_weights(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+    double merit_fun0 = ocp_nlp_evaluate_merit_fun_lin(config, dims, nlp_in, nlp_out, nlp_opts,
+                                                       nlp_mem, nlp_work);
+    double dir_der = ocp_nlp_merit_fun_dir_der(config, dims, nlp_in, nlp_out, nlp_opts,
+                                               nlp_mem, nlp_work);
+    // not a descent direction (e.g. non-convex qp): only require decrease
+    if (dir_der > 0.0)
+        dir_der = 0.0;
+
+    double alpha = nlp_opts->step_length;
+    double merit_fun1;
+    int ls_iter = 0;
+    int soc = 0;
+
+    while (1)
+    {
+        ocp_nlp_sqp_trial_point(dims, nlp_out, nlp_mem->qp_out, nlp_work->tmp_nlp_out, alpha);
+        merit_fun1 = ocp_nlp_evaluate_merit_fun(config, dims, nlp_in, nlp_out, nlp_opts,
+                                                nlp_mem, nlp_work);
+        ls_iter++;
+
+        if (merit_fun1 <= merit_fun0 + opts->eps_sufficient_descent * alpha * dir_der)
+            break;
+
+        // second order correction of the rejected full step
+        if (opts->use_SOC && ls_iter == 1 && alpha == 1.0)
+        {
+            int qp_status = ocp_nlp_sqp_second_order_correction(config, dims, nlp_in, nlp_out, opts,
+                                                                mem, work);
+            if (qp_status == ACADOS_SUCCESS || qp_status == ACADOS_MAXITER)
+            {
+                ocp_nlp_sqp_trial_point(dims, nlp_out, nlp_mem->qp_out, nlp_work->tmp_nlp_out, 1.0);
+                merit_fun1 = ocp_nlp_evaluate_merit_fun(config, dims, nlp_in, nlp_out, nlp_opts,
+                                                        nlp_mem, nlp_work);
+                ls_iter++;
+
+                if (merit_fun1 <= merit_fun0 + opts->eps_sufficient_descent * dir_der)
+                {
+                    soc = 1;
+                    break;
+                }
+            }
+            // back to the original step
+            ocp_nlp_sqp_copy_qp_out(dims, work->tmp_qp_out, nlp_mem->qp_out);
+        }
+
+        // take the smallest step if the line search fails
+        if (alpha * opts->alpha_reduction < opts->alpha_min)
+            break;
+
+        alpha *= opts->alpha_reduction;
+    }
+
+    // save statistics
+    if (sqp_iter+1 < mem->stat_m)
+    {
+        int stat_i = opts->ext_qp_res ? 10 : 6;
+        mem->stat[mem->stat_n*(sqp_iter+1)+stat_i+0] = alpha;
+        mem->stat[mem->stat_n*(sqp_iter+1)+stat_i+1] = merit_fun1;
+        mem->stat[mem->stat_n*(sqp_iter+1)+stat_i+2] = ls_iter;
+        mem->stat[mem->stat_n*(sqp_iter+1)+stat_i+3] = soc;
+    }
+
+    if (opts->print_level > 0)
+    {
+        printf("Line search: alpha %e, merit fun %e -> %e, ls iter %d, soc %d.\n", alpha,
+               merit_fun0, merit_fun1, ls_iter, soc);
+    }
+
+    return alpha;
+}
+
+
+
 /************************************************
  * functions
  ************************************************/
 
+// gradient of the lagrangian w.r.t. (u, x) of one stage, from the current qp matrices; the term of
+// the multipliers of the previous dynamics is omitted, it cancels in the difference of gradients
+static void ocp_nlp_sqp_qn_lagrangian_grad(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out,
+    ocp_nlp_memory *nlp_mem, ocp_nlp_sqp_memory *mem, int stage, struct blasfeo_dvec *grad)
+{
+    ocp_qp_in *qp_in = nlp_mem->qp_in;
+
+    int nux = dims->nu[stage] + dims->nx[stage];
+    int nb = qp_in->dim->nb[stage];
+    int ng = qp_in->dim->ng[stage];
+
+    blasfeo_dveccp(nux, nlp_mem->cost_grad+stage, 0, grad, 0);
+
+    // dynamics
+    if (stage < dims->N)
+        blasfeo_dgemv_n(nux, dims->nx[stage+1], 1.0, qp_in->BAbt+stage, 0, 0, nlp_out->pi+stage, 0,
+                        1.0, grad, 0, grad, 0);
+
+    // general constraints, the bounds do not contribute to the difference
+    if (ng > 0)
+    {
+        blasfeo_daxpy(ng, -1.0, nlp_out->lam+stage, 2*nb+ng, nlp_out->lam+stage, nb,
+                      &mem->qn_tmp, 0);
+        blasfeo_dgemv_n(nux, ng, -1.0, qp_in->DCt+stage, 0, 0, &mem->qn_tmp, 0, 1.0, grad, 0,
+                        grad, 0);
+    }
+
+    return;
+}
+
+
+
+// lower triangle of B += alpha * v * v'
+static void ocp_nlp_sqp_qn_rank_one(int n, double alpha, struct blasfeo_dvec *v,
+    struct blasfeo_dmat *B)
+{
+    for (int jj = 0; jj < n; jj++)
+    {
+        for (int ii = jj; ii < n; ii++)
+        {
+            BLASFEO_DMATEL(B, ii, jj) += alpha * BLASFEO_DVECEL(v, ii) * BLASFEO_DVECEL(v, jj);
+        }
+    }
+    return;
+}
+
+
+
+// step and gradient of the lagrangian at the previous iterate with the new multipliers,
+// to be called after the update of the variables with the previous iterate in qn_s
+static void ocp_nlp_sqp_qn_store_step(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out,
+    ocp_nlp_memory *nlp_mem, ocp_nlp_sqp_memory *mem)
+{
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        int nux = dims->nu[ii] + dims->nx[ii];
+        blasfeo_daxpy(nux, -1.0, mem->qn_s+ii, 0, nlp_out->ux+ii, 0, mem->qn_s+ii, 0);
+        ocp_nlp_sqp_qn_lagrangian_grad(dims, nlp_out, nlp_mem, mem, ii, mem->qn_g+ii);
+    }
+    mem->qn_step = 1;
+
+    return;
+}
+
+
+
+// update the stage Hessian blocks with the last step and replace the Hessian of the modules in
+// the qp, to be called after the linearization at the new iterate and before the regularization
+static void ocp_nlp_sqp_qn_update(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out,
+    ocp_nlp_sqp_opts *opts, ocp_nlp_memory *nlp_mem, ocp_nlp_sqp_memory *mem)
+{
+    int N = dims->N;
+
+    if (mem->qn_iter < 0)
+    {
+        for (int ii = 0; ii <= N; ii++)
+        {
+            int nux = dims->nu[ii] + dims->nx[ii];
+            blasfeo_dgese(nux, nux, 0.0, mem->qn_B+ii, 0, 0);
+            blasfeo_ddiare(nux, 1.0, mem->qn_B+ii, 0, 0);
+        }
+        mem->qn_iter = 0;
+    }
+
+    if (mem->qn_step)
+    {
+        for (int ii = 0; ii <= N; ii++)
+        {
+            int nux = dims->nu[ii] + dims->nx[ii];
+            struct blasfeo_dmat *B = mem->qn_B+ii;
+            struct blasfeo_dvec *s = mem->qn_s+ii;
+            struct blasfeo_dvec *y = &mem->qn_y;
+            struct blasfeo_dvec *Bs = &mem->qn_Bs;
+
+            ocp_nlp_sqp_qn_lagrangian_grad(dims, nlp_out, nlp_mem, mem, ii, y);
+            blasfeo_daxpy(nux, -1.0, mem->qn_g+ii, 0, y, 0, y, 0);
+
+            double ss = blasfeo_ddot(nux, s, 0, s, 0);
+            double sy = blasfeo_ddot(nux, s, 0, y, 0);
+            if (ss == 0.0)
+                continue;
+
+            // first update: scale the initial identity (Shanno-Phua)
+            if (mem->qn_iter == 0 && sy > 0.0)
+                blasfeo_dgesc(nux, nux, blasfeo_ddot(nux, y, 0, y, 0) / sy, B, 0, 0);
+
+            blasfeo_dsymv_l(nux, nux, 1.0, B, 0, 0, s, 0, 0.0, Bs, 0, Bs, 0);
+            double sBs = blasfeo_ddot(nux, s, 0, Bs, 0);
+
+            if (opts->qn_update == QN_BFGS)
+            {
+                if (sBs <= 0.0)
+                    continue;
+
+                // Powell damping: r = theta y + (1-theta) Bs keeps B positive definite
+                double theta = 1.0;
+                if (sy < opts->qn_damping * sBs)
+                    theta = (1.0 - opts->qn_damping) * sBs / (sBs - sy);
+                blasfeo_dvecsc(nux, theta, y, 0);
+                blasfeo_daxpy(nux, 1.0 - theta, Bs, 0, y, 0, y, 0);
+                double sr = theta * sy + (1.0 - theta) * sBs;
+
+                ocp_nlp_sqp_qn_rank_one(nux, -1.0 / sBs, Bs, B);
+                ocp_nlp_sqp_qn_rank_one(nux, 1.0 / sr, y, B);
+            }
+            else // QN_SR1
+            {
+                // d = y - Bs
+                blasfeo_daxpy(nux, -1.0, Bs, 0, y, 0, y, 0);
+                double sd = sy - sBs;
+                double dd = blasfeo_ddot(nux, y, 0, y, 0);
+                if (fabs(sd) < opts->qn_sr1_tol * sqrt(ss * dd) || sd == 0.0)
+                    continue;
+
+                ocp_nlp_sqp_qn_rank_one(nux, 1.0 / sd, y, B);
+            }
+            blasfeo_dtrtr_l(nux, B, 0, 0, B, 0, 0);
+        }
+        mem->qn_iter++;
+        mem->qn_step = 0;
+    }
+
+    // the regularization gets the quasi-Newton blocks
+    for (int ii = 0; ii <= N; ii++)
+    {
+        int nux = dims->nu[ii] + dims->nx[ii];
+        blasfeo_dgecp(nux, nux, mem->qn_B+ii, 0, 0, nlp_mem->qp_in->RSQrq+ii, 0, 0);
+    }
+
+    // the qp Hessian changes at every iteration
+    nlp_mem->qp_mat_valid = 0;
+    nlp_mem->qp_mat_unchanged = 0;
+
+    return;
+}
+
+
+
 int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
                 void *opts_, void *mem_, void *work_)
 {
@@ -485,8 +986,12 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
     mem->time_qp_solver_call = 0.0;
     mem->time_lin = 0.0;
     mem->time_reg = 0.0;
+    mem->time_glob = 0.0;
     mem->time_tot = 0.0;
 
+    // the quasi-Newton blocks are kept, the last step is not valid for the new problem
+    mem->qn_step = 0;
+
     int N = dims->N;
 
     int ii;
@@ -602,6 +1107,10 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
         // linearizate NLP and update QP matrices
         acados_tic(&timer1);
         ocp_nlp_approximate_qp_matrices(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+        // quasi-Newton update of the stage Hessian blocks
+        if (opts->qn_update != QN_NONE)
+            ocp_nlp_sqp_qn_update(dims, nlp_out, opts, nlp_mem, mem);
         mem->time_lin += acados_toc(&timer1);
 
         // update QP rhs for SQP (step prim var, abs dual var)
@@ -656,6 +1165,10 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
         }
 
 
+        // partial tightening of the far-horizon constraints
+        ocp_nlp_tightening_qp_matrices(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+        ocp_nlp_tightening_qp_vectors(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+
         // regularize Hessian
         acados_tic(&timer1);
         config->regularize->regularize_hessian(config->regularize, dims->regularize,
@@ -670,6 +1183,11 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
                                          "warm_start", &tmp_int);
         }
 
+        // keep the condensed Hessian in the qp solver if the qp matrices did not change
+        int cond_hess = !nlp_mem->qp_mat_unchanged;
+        config->qp_solver->opts_set(config->qp_solver, opts->nlp_opts->qp_solver_opts,
+                                    "cond_cond_hess", &cond_hess);
+
         // solve qp
         acados_tic(&timer1);
         qp_status = qp_solver->evaluate(qp_solver, dims->qp_solver, nlp_mem->qp_in, nlp_mem->qp_out,
@@ -685,6 +1203,9 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
                                              opts->nlp_opts->regularize, nlp_mem->regularize_mem);
         mem->time_reg += acados_toc(&timer1);
 
+        // multipliers and slacks of the tightened constraints
+        ocp_nlp_tightening_qp_sol(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+
         // restore default warm start
         if (sqp_iter==0)
         {
@@ -747,7 +1268,26 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
             return mem->status;
         }
 
-        ocp_nlp_update_variables_sqp(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work);
+        // globalization
+        double alpha = nlp_opts->step_length;
+        if (opts->globalization == MERIT_BACKTRACKING)
+        {
+            acados_tic(&timer1);
+            alpha = ocp_nlp_sqp_line_search(config, dims, nlp_in, nlp_out, opts, mem, work);
+            mem->time_glob += acados_toc(&timer1);
+        }
+
+        // previous iterate for the quasi-Newton step
+        if (opts->qn_update != QN_NONE)
+        {
+            for (ii = 0; ii <= N; ii++)
+                blasfeo_dveccp(dims->nu[ii]+dims->nx[ii], nlp_out->ux+ii, 0, mem->qn_s+ii, 0);
+        }
+
+        ocp_nlp_update_variables_sqp(config, dims, nlp_in, nlp_out, nlp_opts, nlp_mem, nlp_work, alpha);
+
+        if (opts->qn_update != QN_NONE)
+            ocp_nlp_sqp_qn_store_step(dims, nlp_out, nlp_mem, mem);
 
         // ocp_nlp_dims_print(nlp_out->dims);
         // ocp_nlp_out_print(nlp_out);
@@ -830,6 +1370,10 @@ int ocp_nlp_sqp_precompute(void *config_, void *dims_, void *nlp_in_, void *nlp_
 
     int ii;
 
+    // quasi-Newton blocks are initialized at the first iteration
+    mem->qn_iter = -1;
+    mem->qn_step = 0;
+
     // TODO(all) add flag to enable/disable checks
     for (ii = 0; ii <= N; ii++)
     {
@@ -971,6 +1515,11 @@ void ocp_nlp_sqp_get(void *config_, void *dims_, void *mem_, const char *field,
         double *value = return_value_;
         *value = mem->time_reg;
     }
+    else if (!strcmp("time_glob", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_glob;
+    }
     else if (!strcmp("nlp_res", field))
     {
         ocp_nlp_res **value = return_value_;
@@ -1025,6 +1574,17 @@ void ocp_nlp_sqp_get(void *config_, void *dims_, void *mem_, const char *field,
     {
 		config->qp_solver->memory_get(config->qp_solver, mem->nlp_mem->qp_solver_mem, "iter", return_value_);
     }
+    else if (!strcmp("reg_corrected", field) || !strcmp("reg_num_corrected", field))
+    {
+        if (config->regularize->memory_get == NULL)
+        {
+            printf("\nerror: field %s not available for this regularization\n", field);
+            exit(1);
+        }
+        // strip "reg_"
+        config->regularize->memory_get(config->regularize, dims->regularize,
+            mem->nlp_mem->regularize_mem, (char *) field + 4, return_value_);
+    }
     else
     {
         printf("\nerror: field %s not available in ocp_nlp_sqp_get\n", field);
@@ -1052,6 +1612,7 @@ void ocp_nlp_sqp_config_initialize_default(void *config_)
     config->eval_param_sens = &ocp_nlp_sqp_eval_param_sens;
     config->config_initialize_default = &ocp_nlp_sqp_config_initialize_default;
     config->precompute = &ocp_nlp_sqp_precompute;
+    config->shift = &ocp_nlp_common_shift;
     config->get = &ocp_nlp_sqp_get;
 
     return;
@@ -58,6 +58,19 @@ extern "C" {
  * options
  ************************************************/
 
+typedef enum
+{
+    FIXED_STEP,          // fixed step length (step_length in ocp_nlp_opts)
+    MERIT_BACKTRACKING,  // backtracking line search on the l1 merit function
+} ocp_nlp_globalization_t;
+
+typedef enum
+{
+    QN_NONE,  // Hessian of the modules (Gauss-Newton, exact)
+    QN_BFGS,  // stage-wise damped BFGS update
+    QN_SR1,   // stage-wise SR1 update (possibly indefinite, convexify by regularization)
+} ocp_nlp_qn_t;
+
 typedef struct
 {
 	ocp_nlp_opts *nlp_opts;
@@ -71,6 +84,14 @@ typedef struct
     bool warm_start_first_qp; // to set qp_warm_start in first iteration
     int rti_phase;       // only phase 0 at the moment 
     int print_level;     // possible values 0, 1 
+    int globalization;   // ocp_nlp_globalization_t
+    double alpha_min;    // minimum step length in line search
+    double alpha_reduction; // step length reduction factor in line search
+    double eps_sufficient_descent; // sufficient decrease (Armijo) constant in line search
+    int use_SOC;         // second order correction if the full step is rejected in line search
+    int qn_update;       // ocp_nlp_qn_t, quasi-Newton update of the stage Hessian blocks
+    double qn_damping;   // Powell damping of the BFGS update
+    double qn_sr1_tol;   // SR1 update is skipped if |s'(y-Bs)| < qn_sr1_tol |s| |y-Bs|
 
 } ocp_nlp_sqp_opts;
 
@@ -105,13 +126,25 @@ typedef struct
     double time_qp_solver_call;
     double time_lin;
     double time_reg;
+    double time_glob;
     double time_tot;
 
-    // statistics
+    // statistics: residuals (4), qp status and iter (2), qp residuals (4, ext_qp_res only),
+    // step length, merit fun, line search iter and second order correction (4, globalization only)
     double *stat;
     int stat_m;
     int stat_n;
 
+    // block-wise quasi-Newton Hessian approximation (only the nu+nx blocks of RSQrq)
+    struct blasfeo_dmat *qn_B;  // stage Hessian approximations, kept across calls
+    struct blasfeo_dvec *qn_s;  // last primal step
+    struct blasfeo_dvec *qn_g;  // gradient of the lagrangian at the previous iterate
+    struct blasfeo_dvec qn_y;
+    struct blasfeo_dvec qn_Bs;
+    struct blasfeo_dvec qn_tmp;
+    int qn_iter;   // number of updates since initialization of qn_B, -1 if not initialized
+    int qn_step;   // qn_s and qn_g hold the last step
+
     int status;
     int sqp_iter;
 
@@ -127,6 +127,12 @@ void ocp_nlp_sqp_rti_opts_initialize_default(void *config_,
     opts->rti_phase = 0;
     opts->print_level = 0;
 
+    // multi-level iteration: full linearization at every sample
+    strcpy(opts->mli_schedule, "D");
+    opts->mli_kappa_max = 0.0;
+
+    opts->advanced_step = 0;
+
     // overwrite default submodules opts
 
     // do not compute adjoint in dynamics and constraints
@@ -233,6 +239,37 @@ void ocp_nlp_sqp_rti_opts_set(void *config_, void *opts_,
             }
             opts->print_level = *print_level;
         }
+        else if (!strcmp(field, "mli_schedule"))
+        {
+            char* mli_schedule = (char *) value;
+            int len = strlen(mli_schedule);
+            if (len == 0 || len >= MAX_STR_LEN)
+            {
+                printf("\nerror: ocp_nlp_sqp_rti_opts_set: invalid length of mli_schedule, need 1 to %d levels, got %d.\n",
+                    MAX_STR_LEN-1, len);
+                exit(1);
+            }
+            for (ii = 0; ii < len; ii++)
+            {
+                if (mli_schedule[ii] != 'A' && mli_schedule[ii] != 'B' && mli_schedule[ii] != 'D')
+                {
+                    printf("\nerror: ocp_nlp_sqp_rti_opts_set: invalid level %c in mli_schedule.", mli_schedule[ii]);
+                    printf("possible values are: A, B, D\n");
+                    exit(1);
+                }
+            }
+            strcpy(opts->mli_schedule, mli_schedule);
+        }
+        else if (!strcmp(field, "mli_kappa_max"))
+        {
+            double* mli_kappa_max = (double *) value;
+            opts->mli_kappa_max = *mli_kappa_max;
+        }
+        else if (!strcmp(field, "advanced_step"))
+        {
+            int* advanced_step = (int *) value;
+            opts->advanced_step = *advanced_step;
+        }
         else
         {
             ocp_nlp_opts_set(config, nlp_opts, field, value);
@@ -292,11 +329,21 @@ int ocp_nlp_sqp_rti_memory_calculate_size(void *config_,
     // nlp mem
     size += ocp_nlp_memory_calculate_size(config, dims, nlp_opts);
 
+    // multi-level iteration
+    size += 2*ocp_nlp_out_calculate_size(config, dims);
+
+    // advanced step (always allocated, the option can be set after the memory is created)
+    size += ocp_qp_in_calculate_size(dims->qp_solver->orig_dims);
+    size += ocp_qp_out_calculate_size(dims->qp_solver->orig_dims);
+    size += (dims->nx[0]+dims->nu[0])*sizeof(double);
+
     // stat
     int stat_m = 1+1;
     int stat_n = 2;
     if (opts->ext_qp_res)
         stat_n += 4;
+    if (strcmp(opts->mli_schedule, "D"))
+        stat_n += 1;
     size += stat_n*stat_m*sizeof(double);
 
     size += 8;  // initial align
@@ -340,14 +387,42 @@ void *ocp_nlp_sqp_rti_memory_assign(void *config_, void *dims_,
     mem->nlp_mem = ocp_nlp_memory_assign(config, dims, nlp_opts, c_ptr);
     c_ptr += ocp_nlp_memory_calculate_size(config, dims, nlp_opts);
 
+    // multi-level iteration
+    mem->lin_out = ocp_nlp_out_assign(config, dims, c_ptr);
+    c_ptr += ocp_nlp_out_calculate_size(config, dims);
+
+    mem->lin_fun = ocp_nlp_out_assign(config, dims, c_ptr);
+    c_ptr += ocp_nlp_out_calculate_size(config, dims);
+
+    mem->mli_iter = 0;
+    mem->mli_level = MLI_LEVEL_D;
+    mem->lin_valid = 0;
+    mem->step_norm = 0.0;
+    mem->step_norm_prev = 0.0;
+
+    // advanced step
+    mem->as_qp_in = ocp_qp_in_assign(dims->qp_solver->orig_dims, c_ptr);
+    c_ptr += ocp_qp_in_calculate_size(dims->qp_solver->orig_dims);
+
+    mem->as_qp_out = ocp_qp_out_assign(dims->qp_solver->orig_dims, c_ptr);
+    c_ptr += ocp_qp_out_calculate_size(dims->qp_solver->orig_dims);
+
+    mem->as_ready = 0;
+    mem->time_as = 0.0;
+
     // stat
     mem->stat = (double *) c_ptr;
     mem->stat_m = 1+1;
     mem->stat_n = 2;
     if (opts->ext_qp_res)
         mem->stat_n += 4;
+    if (strcmp(opts->mli_schedule, "D"))
+        mem->stat_n += 1;
     c_ptr += mem->stat_m*mem->stat_n*sizeof(double);
 
+    assign_and_advance_double(dims->nx[0], &mem->as_x0, &c_ptr);
+    assign_and_advance_double(dims->nu[0], &mem->as_u0, &c_ptr);
+
     mem->status = ACADOS_READY;
 
     assert((char *) raw_memory+ocp_nlp_sqp_rti_memory_calculate_size(
@@ -443,6 +518,205 @@ static void ocp_nlp_sqp_rti_cast_workspace(
 
 
 
+/************************************************
+ * multi-level iteration
+ ************************************************/
+
+static int ocp_nlp_sqp_rti_mli_next_level(ocp_nlp_sqp_rti_opts *opts, ocp_nlp_sqp_rti_memory *mem)
+{
+    int len = strlen(opts->mli_schedule);
+
+    if (mem->mli_iter >= len)
+        mem->mli_iter = 0;
+
+    char c = opts->mli_schedule[mem->mli_iter];
+    mem->mli_iter = (mem->mli_iter+1) % len;
+
+    int level = c == 'A' ? MLI_LEVEL_A : c == 'B' ? MLI_LEVEL_B : MLI_LEVEL_D;
+
+    // full linearization at the first call
+    if (!mem->lin_valid)
+        level = MLI_LEVEL_D;
+
+    // full linearization if the iterates stop contracting
+    if (opts->mli_kappa_max > 0.0 && mem->step_norm_prev > 0.0 &&
+        mem->step_norm > opts->mli_kappa_max * mem->step_norm_prev)
+        level = MLI_LEVEL_D;
+
+    return level;
+}
+
+
+
+// qp vectors at nlp_out for the qp matrices at lin_out; cost gradient from the quadratic model,
+// dynamics and constraints from their linearization (level A) or evaluated (level B)
+static void ocp_nlp_sqp_rti_mli_update_vectors(ocp_nlp_config *config, ocp_nlp_dims *dims,
+            ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
+            ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_workspace *work, int level)
+{
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+
+    ocp_qp_in *qp_in = nlp_mem->qp_in;
+
+    int i;
+
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+    int *ns = qp_in->dim->ns;
+
+    // deviation from the linearization point
+    struct blasfeo_dvec *delta = work->tmp_qp_out->ux;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        blasfeo_daxpy(nv[i], -1.0, mem->lin_out->ux+i, 0, nlp_out->ux+i, 0, delta+i, 0);
+        blasfeo_dveccp(nv[i], nlp_out->ux+i, 0, nlp_work->tmp_nlp_out->ux+i, 0);
+    }
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        int nbg = nb[i] + ng[i];
+
+        // cost gradient
+        blasfeo_dsymv_l(nu[i]+nx[i], nu[i]+nx[i], 1.0, qp_in->RSQrq+i, 0, 0, delta+i, 0,
+                        1.0, mem->lin_fun->ux+i, 0, nlp_mem->cost_grad+i, 0);
+        blasfeo_dveccp(2*ns[i], mem->lin_fun->ux+i, nu[i]+nx[i], nlp_mem->cost_grad+i, nu[i]+nx[i]);
+        blasfeo_dvecmulacc(2*ns[i], qp_in->Z+i, 0, delta+i, nu[i]+nx[i], nlp_mem->cost_grad+i, nu[i]+nx[i]);
+
+        if (level == MLI_LEVEL_B)
+        {
+            // dynamics and constraints residuals (no sensitivities)
+            if (i < N)
+            {
+                config->dynamics[i]->compute_fun(config->dynamics[i], dims->dynamics[i],
+                        nlp_in->dynamics[i], nlp_opts->dynamics[i], nlp_mem->dynamics[i],
+                        nlp_work->dynamics[i]);
+                struct blasfeo_dvec *dyn_fun = config->dynamics[i]->memory_get_fun_ptr(nlp_mem->dynamics[i]);
+                blasfeo_dveccp(nx[i+1], dyn_fun, 0, nlp_mem->dyn_fun+i, 0);
+            }
+
+            config->constraints[i]->compute_fun(config->constraints[i], dims->constraints[i],
+                    nlp_in->constraints[i], nlp_opts->constraints[i], nlp_mem->constraints[i],
+                    nlp_work->constraints[i]);
+            struct blasfeo_dvec *ineq_fun = config->constraints[i]->memory_get_fun_ptr(nlp_mem->constraints[i]);
+            blasfeo_dveccp(2*dims->ni[i], ineq_fun, 0, nlp_mem->ineq_fun+i, 0);
+        }
+        else
+        {
+            // dynamics: f_lin + BA^T delta_i - delta_{i+1}
+            if (i < N)
+            {
+                blasfeo_dgemv_t(nu[i]+nx[i], nx[i+1], 1.0, qp_in->BAbt+i, 0, 0, delta+i, 0,
+                                1.0, mem->lin_fun->pi+i, 0, nlp_mem->dyn_fun+i, 0);
+                blasfeo_daxpy(nx[i+1], -1.0, delta+i+1, nu[i+1], nlp_mem->dyn_fun+i, 0,
+                              nlp_mem->dyn_fun+i, 0);
+            }
+
+            // constraints: the upper part is used as workspace for the constraint linearization
+            struct blasfeo_dvec *ineq_fun = nlp_mem->ineq_fun+i;
+            blasfeo_dvecex_sp(nb[i], 1.0, qp_in->idxb[i], delta+i, 0, ineq_fun, nbg);
+            blasfeo_dgemv_t(nu[i]+nx[i], ng[i], 1.0, qp_in->DCt+i, 0, 0, delta+i, 0,
+                            0.0, ineq_fun, nbg+nb[i], ineq_fun, nbg+nb[i]);
+            // lower: fun_l - J delta
+            blasfeo_daxpy(nbg, -1.0, ineq_fun, nbg, mem->lin_fun->lam+i, 0, ineq_fun, 0);
+            // upper: fun_u + J delta
+            blasfeo_daxpy(nbg, 1.0, ineq_fun, nbg, mem->lin_fun->lam+i, nbg, ineq_fun, nbg);
+            // slacks
+            blasfeo_dvecad_sp(ns[i], -1.0, delta+i, nu[i]+nx[i], qp_in->idxs[i], ineq_fun, 0);
+            blasfeo_dvecad_sp(ns[i], -1.0, delta+i, nu[i]+nx[i]+ns[i], qp_in->idxs[i], ineq_fun, nbg);
+            blasfeo_daxpy(2*ns[i], -1.0, delta+i, nu[i]+nx[i], mem->lin_fun->lam+i, 2*nbg, ineq_fun, 2*nbg);
+        }
+    }
+
+    return;
+}
+
+
+
+/************************************************
+ * advanced step
+ ************************************************/
+
+// solves the qp at the predicted initial state (the one currently set in nlp_in), so that the
+// qp solver keeps its factorization for the sensitivity wrt the initial state
+static int ocp_nlp_sqp_rti_advanced_step_prepare(ocp_nlp_config *config, ocp_nlp_dims *dims,
+    ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
+    ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_workspace *work)
+{
+    ocp_nlp_opts *nlp_opts = opts->nlp_opts;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+    ocp_qp_xcond_solver_config *qp_solver = config->qp_solver;
+
+    int ii;
+
+    int nx0 = dims->nx[0];
+    int nu0 = dims->nu[0];
+
+    // embed predicted initial value and update the qp rhs
+    ocp_nlp_embed_initial_value(config, dims, nlp_in,
+        nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+    ocp_nlp_approximate_qp_vectors_sqp(config, dims, nlp_in,
+        nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+    ocp_nlp_tightening_qp_vectors(config, dims, nlp_in,
+        nlp_out, nlp_opts, nlp_mem, nlp_work);
+
+    if (!opts->warm_start_first_qp)
+    {
+        int tmp_int = 0;
+        qp_solver->opts_set(qp_solver, nlp_opts->qp_solver_opts, "warm_start", &tmp_int);
+    }
+
+    // a solution from the active set cache does not refresh the factorization:
+    // disable the cache for this solve and restore the user setting afterwards
+    ocp_qp_xcond_solver_opts *qp_solver_opts = nlp_opts->qp_solver_opts;
+    int as_cache_size = qp_solver_opts->as_cache_opts->size;
+    int no_cache = 0;
+    qp_solver->opts_set(qp_solver, nlp_opts->qp_solver_opts, "as_cache_size", &no_cache);
+
+    int qp_status = qp_solver->evaluate(qp_solver, dims->qp_solver,
+        nlp_mem->qp_in, nlp_mem->qp_out, nlp_opts->qp_solver_opts,
+        nlp_mem->qp_solver_mem, nlp_work->qp_work);
+
+    qp_solver->opts_set(qp_solver, nlp_opts->qp_solver_opts, "as_cache_size", &as_cache_size);
+
+    if ((qp_status!=ACADOS_SUCCESS) & (qp_status!=ACADOS_MAXITER))
+    {
+        printf("QP solver returned error status %d in advanced step preparation\n", qp_status);
+        return ACADOS_QP_FAILURE;
+    }
+
+    // predicted initial state and the corresponding control
+    for (ii = 0; ii < nx0; ii++)
+        mem->as_x0[ii] = BLASFEO_DVECEL(nlp_out->ux+0, nu0+ii)
+                       + BLASFEO_DVECEL(nlp_mem->qp_out->ux+0, nu0+ii);
+    for (ii = 0; ii < nu0; ii++)
+        mem->as_u0[ii] = BLASFEO_DVECEL(nlp_out->ux+0, ii)
+                       + nlp_opts->step_length * BLASFEO_DVECEL(nlp_mem->qp_out->ux+0, ii);
+
+    // parametric qp: only the initial state bounds are set in the feedback
+    d_ocp_qp_copy_all(nlp_mem->qp_in, mem->as_qp_in);
+    d_ocp_qp_set_rhs_zero(mem->as_qp_in);
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /************************************************
  * functions
  ************************************************/
@@ -695,19 +969,68 @@ int ocp_nlp_sqp_rti_preparation_step(void *config_, void *dims_,
 	int sqp_iter = 0;
 	nlp_mem->sqp_iter = &sqp_iter;
 
-    // linearizate NLP and update QP matrices
-    acados_tic(&timer1);
-    ocp_nlp_approximate_qp_matrices(config, dims, nlp_in,
-        nlp_out, nlp_opts, nlp_mem, nlp_work);
+    // level of this sample
+    int level = ocp_nlp_sqp_rti_mli_next_level(opts, mem);
 
-    mem->time_lin += acados_toc(&timer1);
+    if (level == MLI_LEVEL_D)
+    {
+        // linearizate NLP and update QP matrices
+        acados_tic(&timer1);
+        ocp_nlp_approximate_qp_matrices(config, dims, nlp_in,
+            nlp_out, nlp_opts, nlp_mem, nlp_work);
 
-    // regularize Hessian
-    acados_tic(&timer1);
-    config->regularize->regularize_hessian(config->regularize,
-        dims->regularize, opts->nlp_opts->regularize, nlp_mem->regularize_mem);
+        // partial tightening of the far-horizon constraints
+        ocp_nlp_tightening_qp_matrices(config, dims, nlp_in,
+            nlp_out, nlp_opts, nlp_mem, nlp_work);
 
-    mem->time_reg += acados_toc(&timer1);
+        mem->time_lin += acados_toc(&timer1);
+
+        // regularize Hessian
+        acados_tic(&timer1);
+        config->regularize->regularize_hessian(config->regularize,
+            dims->regularize, opts->nlp_opts->regularize, nlp_mem->regularize_mem);
+
+        mem->time_reg += acados_toc(&timer1);
+
+        // save linearization point
+        for (ii = 0; ii <= N; ii++)
+        {
+            blasfeo_dveccp(dims->nv[ii], nlp_out->ux+ii, 0, mem->lin_out->ux+ii, 0);
+            blasfeo_dveccp(dims->nv[ii], nlp_mem->cost_grad+ii, 0, mem->lin_fun->ux+ii, 0);
+            if (ii < N)
+                blasfeo_dveccp(dims->nx[ii+1], nlp_mem->dyn_fun+ii, 0, mem->lin_fun->pi+ii, 0);
+            blasfeo_dveccp(2*dims->ni[ii], nlp_mem->ineq_fun+ii, 0, mem->lin_fun->lam+ii, 0);
+        }
+        mem->lin_valid = 1;
+    }
+    else
+    {
+        // update qp vectors only
+        acados_tic(&timer1);
+        ocp_nlp_sqp_rti_mli_update_vectors(config, dims, nlp_in, nlp_out, opts, mem, work, level);
+
+        mem->time_lin += acados_toc(&timer1);
+    }
+
+    // keep the condensed matrices in the qp solver if they did not change
+    int cond_hess = level == MLI_LEVEL_D && !nlp_mem->qp_mat_unchanged;
+    config->qp_solver->opts_set(config->qp_solver, opts->nlp_opts->qp_solver_opts,
+                                "cond_cond_hess", &cond_hess);
+
+    mem->mli_level = level;
+    if (strcmp(opts->mli_schedule, "D"))
+        mem->stat[mem->stat_n*1+mem->stat_n-1] = level;
+
+    // advanced step: qp at the predicted initial state
+    mem->as_ready = 0;
+    if (opts->advanced_step)
+    {
+        mem->status = ocp_nlp_sqp_rti_advanced_step_prepare(config, dims, nlp_in, nlp_out,
+            opts, mem, work);
+        mem->as_ready = mem->status == ACADOS_SUCCESS;
+    }
+
+    return mem->status;
 }
 
 int ocp_nlp_sqp_rti_feedback_step(void *config_, void *dims_,
@@ -735,6 +1058,9 @@ int ocp_nlp_sqp_rti_feedback_step(void *config_, void *dims_,
     mem->time_qp_sol = 0.0;
     mem->time_qp_solver_call = 0.0;
 
+    // the qp solve below replaces the factorization at the predicted initial state
+    mem->as_ready = 0;
+
     // embed initial value (this actually updates all bounds at stage 0...)
     ocp_nlp_embed_initial_value(config, dims, nlp_in,
         nlp_out, nlp_opts, nlp_mem, nlp_work);
@@ -743,6 +1069,9 @@ int ocp_nlp_sqp_rti_feedback_step(void *config_, void *dims_,
     ocp_nlp_approximate_qp_vectors_sqp(config, dims, nlp_in,
         nlp_out, nlp_opts, nlp_mem, nlp_work);
 
+    ocp_nlp_tightening_qp_vectors(config, dims, nlp_in,
+        nlp_out, nlp_opts, nlp_mem, nlp_work);
+
     if (opts->print_level > 0) {
         printf("\n------- qp_in --------\n");
         print_ocp_qp_in(nlp_mem->qp_in);
@@ -776,6 +1105,10 @@ int ocp_nlp_sqp_rti_feedback_step(void *config_, void *dims_,
 
     mem->time_reg += acados_toc(&timer1);
 
+    // multipliers and slacks of the tightened constraints
+    ocp_nlp_tightening_qp_sol(config, dims, nlp_in,
+        nlp_out, nlp_opts, nlp_mem, nlp_work);
+
     // TODO move into QP solver memory ???
     qp_info *qp_info_;
     ocp_qp_out_get(nlp_mem->qp_out, "qp_info", &qp_info_);
@@ -816,7 +1149,17 @@ int ocp_nlp_sqp_rti_feedback_step(void *config_, void *dims_,
     }
 
     ocp_nlp_update_variables_sqp(config, dims, nlp_in,
-        nlp_out, nlp_opts, nlp_mem, nlp_work);
+        nlp_out, nlp_opts, nlp_mem, nlp_work, nlp_opts->step_length);
+
+    // contraction monitor for multi-level iteration
+    mem->step_norm_prev = mem->step_norm;
+    mem->step_norm = 0.0;
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        double tmp = 0.0;
+        blasfeo_dvecnrm_inf(dims->nv[ii], nlp_mem->qp_out->ux+ii, 0, &tmp);
+        mem->step_norm = tmp > mem->step_norm ? tmp : mem->step_norm;
+    }
 
     // ocp_nlp_dims_print(nlp_out->dims);
     // ocp_nlp_out_print(nlp_out);
@@ -968,6 +1311,62 @@ void ocp_nlp_sqp_rti_eval_param_sens(void *config_, void *dims_, void *opts_,
 
 
 
+int ocp_nlp_sqp_rti_advanced_step(void *config_, void *dims_, void *opts_,
+    void *mem_, void *work_, double *x0, double *u0)
+{
+    acados_timer timer0;
+    acados_tic(&timer0);
+
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_rti_opts *opts = opts_;
+    ocp_nlp_sqp_rti_memory *mem = mem_;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+
+    // NOTE: the workspace pointers are set by the preparation step
+    ocp_nlp_sqp_rti_workspace *work = work_;
+    ocp_nlp_workspace *nlp_work = work->nlp_work;
+
+    ocp_qp_in *qp_in = mem->as_qp_in;
+
+    if (!mem->as_ready)
+    {
+        printf("\nerror: ocp_nlp_sqp_rti_advanced_step: no factorization at the predicted initial state,");
+        printf(" set advanced_step and call the preparation phase first.\n");
+        return ACADOS_FAILURE;
+    }
+
+    int ii, jj;
+    double tmp;
+
+    int nu0 = dims->nu[0];
+    int nbu0 = qp_in->dim->nbu[0];
+    int nbx0 = qp_in->dim->nbx[0];
+
+    // deviation of the initial state from the prediction
+    for (jj = 0; jj < nbx0; jj++)
+    {
+        ii = qp_in->idxb[0][nbu0+jj] - nu0;
+        tmp = x0[ii] - mem->as_x0[ii];
+        d_ocp_qp_set_el("lbx", 0, jj, &tmp, qp_in);
+        d_ocp_qp_set_el("ubx", 0, jj, &tmp, qp_in);
+    }
+
+    // single backsolve with the factorization of the last qp solve
+    config->qp_solver->eval_sens(config->qp_solver, dims->qp_solver,
+        qp_in, mem->as_qp_out, opts->nlp_opts->qp_solver_opts,
+        nlp_mem->qp_solver_mem, nlp_work->qp_work);
+
+    for (ii = 0; ii < nu0; ii++)
+        u0[ii] = mem->as_u0[ii] + opts->nlp_opts->step_length * BLASFEO_DVECEL(mem->as_qp_out->ux+0, ii);
+
+    mem->time_as = acados_toc(&timer0);
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 // TODO rename memory_get ???
 void ocp_nlp_sqp_rti_get(void *config_, void *dims_, void *mem_,
     const char *field, void *return_value_)
@@ -1011,6 +1410,16 @@ void ocp_nlp_sqp_rti_get(void *config_, void *dims_, void *mem_,
         double *value = return_value_;
         *value = mem->time_reg;
     }
+    else if (!strcmp("mli_level", field))
+    {
+        int *value = return_value_;
+        *value = mem->mli_level;
+    }
+    else if (!strcmp("time_as", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_as;
+    }
     else if (!strcmp("stat", field))
     {
         double **value = return_value_;
@@ -1061,6 +1470,17 @@ void ocp_nlp_sqp_rti_get(void *config_, void *dims_, void *mem_,
 		config->qp_solver->memory_get(config->qp_solver,
             mem->nlp_mem->qp_solver_mem, "iter", return_value_);
     }
+    else if (!strcmp("reg_corrected", field) || !strcmp("reg_num_corrected", field))
+    {
+        if (config->regularize->memory_get == NULL)
+        {
+            printf("\nerror: field %s not available for this regularization\n", field);
+            exit(1);
+        }
+        // strip "reg_"
+        config->regularize->memory_get(config->regularize, dims->regularize,
+            mem->nlp_mem->regularize_mem, (char *) field + 4, return_value_);
+    }
     else
     {
         printf("\nerror: output type %s not available in \
@@ -1086,8 +1506,10 @@ void ocp_nlp_sqp_rti_config_initialize_default(void *config_)
     config->workspace_calculate_size = &ocp_nlp_sqp_rti_workspace_calculate_size;
     config->evaluate = &ocp_nlp_sqp_rti;
     config->eval_param_sens = &ocp_nlp_sqp_rti_eval_param_sens;
+    config->advanced_step = &ocp_nlp_sqp_rti_advanced_step;
     config->config_initialize_default = &ocp_nlp_sqp_rti_config_initialize_default;
     config->precompute = &ocp_nlp_sqp_rti_precompute;
+    config->shift = &ocp_nlp_common_shift;
     config->get = &ocp_nlp_sqp_rti_get;
 
     return;
@@ -57,6 +57,14 @@ extern "C" {
  * options
  ************************************************/
 
+// multi-level iteration: amount of work in the preparation step
+typedef enum
+{
+    MLI_LEVEL_A,  // no evaluations: qp vectors from the linear model at the last linearization point
+    MLI_LEVEL_B,  // feasibility: residuals of dynamics and constraints, gradient from the quadratic model
+    MLI_LEVEL_D,  // full linearization (Jacobians and Hessian) and regularization
+} ocp_nlp_sqp_rti_mli_level;
+
 
 typedef struct
 {
@@ -67,6 +75,9 @@ typedef struct
     bool warm_start_first_qp; // to set qp_warm_start in first iteration
     int rti_phase;            // phase of RTI. Possible values 1 (preparation), 2 (feedback) 0 (both)
     int print_level;          // possible values 0, 1 
+    char mli_schedule[MAX_STR_LEN]; // cyclic level schedule, one of 'A', 'B', 'D' per sample (default "D")
+    double mli_kappa_max;     // full linearization if the step norm ratio exceeds it (<= 0: disabled)
+    int advanced_step;        // solve the qp at the predicted initial state in the preparation phase
 
 } ocp_nlp_sqp_rti_opts;
 
@@ -110,6 +121,23 @@ typedef struct
 
     int status;
 
+    // multi-level iteration
+    ocp_nlp_out *lin_out;     // linearization point of the qp matrices
+    ocp_nlp_out *lin_fun;     // cost_grad (ux), dyn_fun (pi) and ineq_fun (lam) at lin_out
+    int mli_iter;             // position in the level schedule
+    int mli_level;            // level of the last preparation step
+    int lin_valid;            // qp matrices and lin_* from a full linearization are available
+    double step_norm;         // inf norm of the last two primal steps (contraction monitor)
+    double step_norm_prev;
+
+    // advanced step
+    ocp_qp_in *as_qp_in;      // parametric qp (zero rhs but the initial state) for the sensitivity
+    ocp_qp_out *as_qp_out;    // sensitivity wrt the initial state
+    double *as_x0;            // predicted initial state
+    double *as_u0;            // control at stage 0 for the predicted initial state
+    int as_ready;             // the qp solver holds the factorization at the predicted initial state
+    double time_as;
+
 } ocp_nlp_sqp_rti_memory;
 
 //
@@ -166,6 +194,9 @@ void ocp_nlp_sqp_rti_config_initialize_default(void *config_);
 //
 int ocp_nlp_sqp_rti_precompute(void *config_, void *dims_,
     void *nlp_in_, void *nlp_out_, void *opts_, void *mem_, void *work_);
+//
+int ocp_nlp_sqp_rti_advanced_step(void *config_, void *dims_, void *opts_,
+    void *mem_, void *work_, double *x0, double *u0);
 
 
 
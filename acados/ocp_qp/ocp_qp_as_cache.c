@@ -0,0 +1,772 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+// external
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// hpipm
+#include "hpipm/include/hpipm_d_ocp_qp.h"
+#include "hpipm/include/hpipm_d_ocp_qp_sol.h"
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+// acados
+#include "acados/ocp_qp/ocp_qp_as_cache.h"
+#include "acados/ocp_qp/ocp_qp_common.h"
+#include "acados/utils/math.h"
+#include "acados/utils/mem.h"
+#include "acados/utils/types.h"
+
+
+
+/************************************************
+ * opts
+ ************************************************/
+
+void ocp_qp_as_cache_opts_initialize_default(ocp_qp_as_cache_opts *opts)
+{
+    opts->size = 0;
+    opts->tol = 1e-8;
+
+    return;
+}
+
+
+
+void ocp_qp_as_cache_opts_set(ocp_qp_as_cache_opts *opts, const char *field, void *value)
+{
+    if (!strcmp(field, "cache_size"))
+    {
+        int *tmp_ptr = value;
+        opts->size = *tmp_ptr;
+    }
+    else if (!strcmp(field, "cache_tol"))
+    {
+        double *tmp_ptr = value;
+        opts->tol = *tmp_ptr;
+    }
+    else
+    {
+        printf("\nerror: ocp_qp_as_cache_opts_set: wrong field: as_%s\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+// dimensions of the stacked qp: primal variables, dynamics, inequalities, data matrices
+static void ocp_qp_as_cache_stacked_dims(ocp_qp_dims *dims, int *nv, int *ne, int *nc, int *nRSQ,
+                                         int *nBA, int *nDC, int *nidxb)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *nb = dims->nb;
+    int *ng = dims->ng;
+
+    *nv = 0;
+    *ne = 0;
+    *nc = 0;
+    *nRSQ = 0;
+    *nBA = 0;
+    *nDC = 0;
+    *nidxb = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        *nv += nv0;
+        *ne += nx1;
+        *nc += nb[ii] + ng[ii];
+        *nRSQ += nv0 * nv0;
+        *nBA += nx1 * nv0;
+        *nDC += ng[ii] * nv0;
+        *nidxb += nb[ii];
+    }
+}
+
+
+
+// max size of a reduced KKT system: active inequalities and dynamics are linearly independent
+static int ocp_qp_as_cache_nk_max(int nv, int ne, int nc)
+{
+    return nv + ne + (nc < nv - ne ? nc : nv - ne);
+}
+
+
+
+int ocp_qp_as_cache_memory_calculate_size(ocp_qp_dims *dims, ocp_qp_as_cache_opts *opts)
+{
+    int nv, ne, nc, nRSQ, nBA, nDC, nidxb;
+    ocp_qp_as_cache_stacked_dims(dims, &nv, &ne, &nc, &nRSQ, &nBA, &nDC, &nidxb);
+    int nk_max = ocp_qp_as_cache_nk_max(nv, ne, nc);
+    int size_cache = opts->size;
+
+    int size = 0;
+
+    size += sizeof(ocp_qp_as_cache_memory);
+
+    // disabled cache: no copy of the data matrices and no workspace
+    if (size_cache <= 0)
+    {
+        size += 8;
+        return size;
+    }
+
+    size += 2 * size_cache * sizeof(int *);     // as, ipiv
+    size += 1 * size_cache * sizeof(double *);  // LU
+
+    size += size_cache * nk_max * nk_max * sizeof(double);  // LU
+    size += (nRSQ + nBA + nDC) * sizeof(double);            // RSQ, BA, DC
+    size += nk_max * sizeof(double);                        // sol
+
+    size += 2 * size_cache * sizeof(int);          // order, nk
+    size += size_cache * (nc + nk_max) * sizeof(int);  // as, ipiv
+    size += nidxb * sizeof(int);                   // idxb
+    size += nc * sizeof(int);                      // as_tmp
+
+    size += 2 * 8;
+    return size;
+}
+
+
+
+ocp_qp_as_cache_memory *ocp_qp_as_cache_memory_assign(ocp_qp_dims *dims, ocp_qp_as_cache_opts *opts,
+                                                      void *raw_memory)
+{
+    int nv, ne, nc, nRSQ, nBA, nDC, nidxb;
+    ocp_qp_as_cache_stacked_dims(dims, &nv, &ne, &nc, &nRSQ, &nBA, &nDC, &nidxb);
+    int nk_max = ocp_qp_as_cache_nk_max(nv, ne, nc);
+    int size_cache = opts->size;
+
+    int ii;
+
+    char *c_ptr = (char *) raw_memory;
+
+    // initial alignment
+    align_char_to(8, &c_ptr);
+
+    ocp_qp_as_cache_memory *mem = (ocp_qp_as_cache_memory *) c_ptr;
+    c_ptr += sizeof(ocp_qp_as_cache_memory);
+
+    mem->nv = nv;
+    mem->ne = ne;
+    mem->nc = nc;
+    mem->nk_max = nk_max;
+    mem->capacity = size_cache;
+
+    mem->active = 1;
+    for (ii = 0; ii <= dims->N; ii++)
+    {
+        if (dims->ns[ii] > 0)
+            mem->active = 0;
+    }
+
+    mem->num_entries = 0;
+    mem->data_init = 0;
+    mem->calls = 0;
+    mem->hits = 0;
+
+    // disabled cache: no copy of the data matrices and no workspace
+    if (size_cache <= 0)
+    {
+        mem->capacity = 0;
+        mem->order = NULL;
+        mem->as = NULL;
+        mem->nk = NULL;
+        mem->LU = NULL;
+        mem->ipiv = NULL;
+        mem->RSQ = NULL;
+        mem->BA = NULL;
+        mem->DC = NULL;
+        mem->idxb = NULL;
+        mem->sol = NULL;
+        mem->as_tmp = NULL;
+
+        assert((char *) raw_memory + ocp_qp_as_cache_memory_calculate_size(dims, opts) >= c_ptr);
+
+        return mem;
+    }
+
+    align_char_to(8, &c_ptr);
+
+    // pointers
+    assign_and_advance_int_ptrs(size_cache, &mem->as, &c_ptr);
+    assign_and_advance_int_ptrs(size_cache, &mem->ipiv, &c_ptr);
+    assign_and_advance_double_ptrs(size_cache, &mem->LU, &c_ptr);
+
+    align_char_to(8, &c_ptr);
+
+    // doubles
+    for (ii = 0; ii < size_cache; ii++)
+        assign_and_advance_double(nk_max * nk_max, &mem->LU[ii], &c_ptr);
+    assign_and_advance_double(nRSQ, &mem->RSQ, &c_ptr);
+    assign_and_advance_double(nBA, &mem->BA, &c_ptr);
+    assign_and_advance_double(nDC, &mem->DC, &c_ptr);
+    assign_and_advance_double(nk_max, &mem->sol, &c_ptr);
+
+    // ints
+    assign_and_advance_int(size_cache, &mem->order, &c_ptr);
+    assign_and_advance_int(size_cache, &mem->nk, &c_ptr);
+    for (ii = 0; ii < size_cache; ii++)
+    {
+        assign_and_advance_int(nc, &mem->as[ii], &c_ptr);
+        assign_and_advance_int(nk_max, &mem->ipiv[ii], &c_ptr);
+    }
+    assign_and_advance_int(nidxb, &mem->idxb, &c_ptr);
+    assign_and_advance_int(nc, &mem->as_tmp, &c_ptr);
+
+    // all slots free
+    for (ii = 0; ii < size_cache; ii++)
+        mem->order[ii] = ii;
+
+    assert((char *) raw_memory + ocp_qp_as_cache_memory_calculate_size(dims, opts) >= c_ptr);
+
+    return mem;
+}
+
+
+
+void ocp_qp_as_cache_memory_get(ocp_qp_as_cache_memory *mem, const char *field, void *value)
+{
+    if (!strcmp(field, "cache_calls"))
+    {
+        int *ptr = value;
+        *ptr = mem->calls;
+    }
+    else if (!strcmp(field, "cache_hits"))
+    {
+        int *ptr = value;
+        *ptr = mem->hits;
+    }
+    else if (!strcmp(field, "cache_hit_rate"))
+    {
+        double *ptr = value;
+        *ptr = mem->calls > 0 ? (double) mem->hits / mem->calls : 0.0;
+    }
+    else if (!strcmp(field, "cache_entries"))
+    {
+        int *ptr = value;
+        *ptr = mem->num_entries;
+    }
+    else
+    {
+        printf("\nerror: ocp_qp_as_cache_memory_get: field as_%s not available\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+/************************************************
+ * helpers
+ ************************************************/
+
+// compare the data matrices of qp_in with the cached copy; on change, update the copy and
+// invalidate all cached factorizations
+static void ocp_qp_as_cache_check_data(ocp_qp_in *qp_in, ocp_qp_as_cache_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    double *RSQ = mem->RSQ;
+    double *BA = mem->BA;
+    double *DC = mem->DC;
+    int *idxb = mem->idxb;
+
+    int changed = !mem->data_init;
+    double tmp;
+
+    int ii, jj, kk;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int ng0 = ng[ii];
+
+        // Hessian, lower triangle stored in hpipm
+        for (jj = 0; jj < nv0; jj++)
+        {
+            for (kk = jj; kk < nv0; kk++)
+            {
+                tmp = BLASFEO_DMATEL(qp_in->RSQrq + ii, kk, jj);
+                if (RSQ[kk + jj * nv0] != tmp)
+                {
+                    changed = 1;
+                    RSQ[kk + jj * nv0] = tmp;
+                    RSQ[jj + kk * nv0] = tmp;
+                }
+            }
+        }
+        for (jj = 0; jj < nv0; jj++)
+        {
+            for (kk = 0; kk < nx1; kk++)
+            {
+                tmp = BLASFEO_DMATEL(qp_in->BAbt + ii, jj, kk);
+                if (BA[kk + jj * nx1] != tmp)
+                {
+                    changed = 1;
+                    BA[kk + jj * nx1] = tmp;
+                }
+            }
+            for (kk = 0; kk < ng0; kk++)
+            {
+                tmp = BLASFEO_DMATEL(qp_in->DCt + ii, jj, kk);
+                if (DC[kk + jj * ng0] != tmp)
+                {
+                    changed = 1;
+                    DC[kk + jj * ng0] = tmp;
+                }
+            }
+        }
+        for (jj = 0; jj < nb[ii]; jj++)
+        {
+            if (idxb[jj] != qp_in->idxb[ii][jj])
+            {
+                changed = 1;
+                idxb[jj] = qp_in->idxb[ii][jj];
+            }
+        }
+
+        RSQ += nv0 * nv0;
+        BA += nx1 * nv0;
+        DC += ng0 * nv0;
+        idxb += nb[ii];
+    }
+
+    if (changed)
+        mem->num_entries = 0;
+    mem->data_init = 1;
+
+    return;
+}
+
+
+
+// move the slot at position pos of the cache order to the front (most recently used)
+static void ocp_qp_as_cache_move_to_front(ocp_qp_as_cache_memory *mem, int pos)
+{
+    int slot = mem->order[pos];
+    for (int ii = pos; ii > 0; ii--)
+        mem->order[ii] = mem->order[ii - 1];
+    mem->order[0] = slot;
+}
+
+
+
+// reduced KKT matrix of the active set as, variables ordered as [v; pi; nu_act]
+static void ocp_qp_as_cache_build_kkt(ocp_qp_in *qp_in, ocp_qp_as_cache_memory *mem, int *as,
+                                      int nk, double *K)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    double *RSQ = mem->RSQ;
+    double *BA = mem->BA;
+    double *DC = mem->DC;
+    int *idxb = mem->idxb;
+
+    int v_off = 0;
+    int e_off = mem->nv;
+    int a_off = mem->nv + mem->ne;
+    int c_off = 0;
+
+    int ii, jj, kk;
+
+    for (jj = 0; jj < nk * nk; jj++)
+        K[jj] = 0.0;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nb0 = nb[ii];
+        int ng0 = ng[ii];
+
+        // Hessian
+        for (jj = 0; jj < nv0; jj++)
+            for (kk = 0; kk < nv0; kk++)
+                K[(v_off + kk) + (v_off + jj) * nk] = RSQ[kk + jj * nv0];
+
+        // dynamics: [B A] [u; x] - x_next = - b
+        for (kk = 0; kk < nx1; kk++)
+        {
+            for (jj = 0; jj < nv0; jj++)
+            {
+                K[(e_off + kk) + (v_off + jj) * nk] = BA[kk + jj * nx1];
+                K[(v_off + jj) + (e_off + kk) * nk] = BA[kk + jj * nx1];
+            }
+            K[(e_off + kk) + (v_off + nv0 + nu[ii + 1] + kk) * nk] = -1.0;
+            K[(v_off + nv0 + nu[ii + 1] + kk) + (e_off + kk) * nk] = -1.0;
+        }
+
+        // active inequalities
+        for (jj = 0; jj < nb0; jj++)
+        {
+            if (as[c_off + jj])
+            {
+                K[a_off + (v_off + idxb[jj]) * nk] = 1.0;
+                K[(v_off + idxb[jj]) + a_off * nk] = 1.0;
+                a_off++;
+            }
+        }
+        for (jj = 0; jj < ng0; jj++)
+        {
+            if (as[c_off + nb0 + jj])
+            {
+                for (kk = 0; kk < nv0; kk++)
+                {
+                    K[a_off + (v_off + kk) * nk] = DC[jj + kk * ng0];
+                    K[(v_off + kk) + a_off * nk] = DC[jj + kk * ng0];
+                }
+                a_off++;
+            }
+        }
+
+        v_off += nv0;
+        e_off += nx1;
+        c_off += nb0 + ng0;
+        RSQ += nv0 * nv0;
+        BA += nx1 * nv0;
+        DC += ng0 * nv0;
+        idxb += nb0;
+    }
+
+    return;
+}
+
+
+
+// value of the inequality constraint jj of stage ii at the stage primal variables v
+static double ocp_qp_as_cache_eval_constr(ocp_qp_in *qp_in, double *DC, int *idxb, int ii, int jj,
+                                          double *v)
+{
+    int nv0 = qp_in->dim->nu[ii] + qp_in->dim->nx[ii];
+    int nb0 = qp_in->dim->nb[ii];
+    int ng0 = qp_in->dim->ng[ii];
+
+    if (jj < nb0)
+        return v[idxb[jj]];
+
+    double c = 0.0;
+    for (int kk = 0; kk < nv0; kk++)
+        c += DC[(jj - nb0) + kk * ng0] * v[kk];
+    return c;
+}
+
+
+
+// solve the reduced KKT system of a cache slot for the vectors of qp_in and check primal and dual
+// feasibility of the solution; on success, write it into qp_out
+static int ocp_qp_as_cache_try_slot(ocp_qp_in *qp_in, ocp_qp_out *qp_out, ocp_qp_as_cache_opts *opts,
+                                    ocp_qp_as_cache_memory *mem, int slot)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int *as = mem->as[slot];
+    int nk = mem->nk[slot];
+    double *sol = mem->sol;
+    double tol = opts->tol;
+
+    int v_off, e_off, a_off, c_off;
+    double *DC;
+    int *idxb;
+
+    int ii, jj;
+
+    // right hand side
+    v_off = 0;
+    e_off = mem->nv;
+    a_off = mem->nv + mem->ne;
+    c_off = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+
+        for (jj = 0; jj < nv0; jj++)
+            sol[v_off + jj] = -BLASFEO_DVECEL(qp_in->rqz + ii, jj);
+        for (jj = 0; jj < nx1; jj++)
+            sol[e_off + jj] = -BLASFEO_DVECEL(qp_in->b + ii, jj);
+        // upper bounds are stored with negative sign in hpipm
+        for (jj = 0; jj < nc0; jj++)
+        {
+            if (as[c_off + jj] == 1)
+                sol[a_off++] = BLASFEO_DVECEL(qp_in->d + ii, jj);
+            else if (as[c_off + jj] == 2)
+                sol[a_off++] = -BLASFEO_DVECEL(qp_in->d + ii, nc0 + jj);
+        }
+
+        v_off += nv0;
+        e_off += nx1;
+        c_off += nc0;
+    }
+
+    dgetrs_3l(nk, 1, mem->LU[slot], nk, mem->ipiv[slot], sol, nk);
+
+    // primal feasibility of the inactive and dual feasibility of the active inequalities
+    v_off = 0;
+    a_off = mem->nv + mem->ne;
+    c_off = 0;
+    DC = mem->DC;
+    idxb = mem->idxb;
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nc0 = nb[ii] + ng[ii];
+
+        for (jj = 0; jj < nc0; jj++)
+        {
+            double lb = BLASFEO_DVECEL(qp_in->d + ii, jj);
+            double ub = -BLASFEO_DVECEL(qp_in->d + ii, nc0 + jj);
+            if (as[c_off + jj] == 0)
+            {
+                double c = ocp_qp_as_cache_eval_constr(qp_in, DC, idxb, ii, jj, sol + v_off);
+                if (c < lb - tol || c > ub + tol)
+                    return 0;
+            }
+            else
+            {
+                // multiplier of an equality (lb == ub) can have any sign
+                double nu_act = sol[a_off++];
+                if (ub - lb > tol &&
+                    ((as[c_off + jj] == 1 && nu_act > tol) || (as[c_off + jj] == 2 && nu_act < -tol)))
+                    return 0;
+            }
+        }
+
+        v_off += nv0;
+        c_off += nc0;
+        DC += ng[ii] * nv0;
+        idxb += nb[ii];
+    }
+
+    // write solution, lam and t in the hpipm layout [lb, lg, ub, ug]
+    v_off = 0;
+    e_off = mem->nv;
+    a_off = mem->nv + mem->ne;
+    c_off = 0;
+    DC = mem->DC;
+    idxb = mem->idxb;
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+
+        for (jj = 0; jj < nv0; jj++)
+            BLASFEO_DVECEL(qp_out->ux + ii, jj) = sol[v_off + jj];
+        for (jj = 0; jj < nx1; jj++)
+            BLASFEO_DVECEL(qp_out->pi + ii, jj) = sol[e_off + jj];
+        for (jj = 0; jj < nc0; jj++)
+        {
+            double c = ocp_qp_as_cache_eval_constr(qp_in, DC, idxb, ii, jj, sol + v_off);
+            double nu_act = as[c_off + jj] ? sol[a_off++] : 0.0;
+            BLASFEO_DVECEL(qp_out->lam + ii, jj) = nu_act < 0.0 ? -nu_act : 0.0;
+            BLASFEO_DVECEL(qp_out->lam + ii, nc0 + jj) = nu_act > 0.0 ? nu_act : 0.0;
+            BLASFEO_DVECEL(qp_out->t + ii, jj) = c - BLASFEO_DVECEL(qp_in->d + ii, jj);
+            BLASFEO_DVECEL(qp_out->t + ii, nc0 + jj) = - BLASFEO_DVECEL(qp_in->d + ii, nc0 + jj) - c;
+        }
+
+        v_off += nv0;
+        e_off += nx1;
+        c_off += nc0;
+        DC += ng[ii] * nv0;
+        idxb += nb[ii];
+    }
+
+    return 1;
+}
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+// number of usable cache slots: the cache size can be changed through opts_set after the memory
+// has been allocated, it is clamped to the allocated capacity
+static int ocp_qp_as_cache_size(ocp_qp_as_cache_opts *opts, ocp_qp_as_cache_memory *mem)
+{
+    return opts->size < mem->capacity ? opts->size : mem->capacity;
+}
+
+
+
+int ocp_qp_as_cache_enabled(ocp_qp_as_cache_opts *opts, ocp_qp_as_cache_memory *mem)
+{
+    return ocp_qp_as_cache_size(opts, mem) > 0 && mem->active;
+}
+
+
+
+int ocp_qp_as_cache_lookup(ocp_qp_in *qp_in, ocp_qp_out *qp_out, ocp_qp_as_cache_opts *opts,
+                           ocp_qp_as_cache_memory *mem)
+{
+    if (!ocp_qp_as_cache_enabled(opts, mem))
+        return 0;
+
+    mem->calls++;
+
+    ocp_qp_as_cache_check_data(qp_in, mem);
+
+    for (int pos = 0; pos < mem->num_entries; pos++)
+    {
+        if (ocp_qp_as_cache_try_slot(qp_in, qp_out, opts, mem, mem->order[pos]))
+        {
+            ocp_qp_as_cache_move_to_front(mem, pos);
+            mem->hits++;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+
+void ocp_qp_as_cache_insert(ocp_qp_in *qp_in, ocp_qp_out *qp_out, ocp_qp_as_cache_opts *opts,
+                            ocp_qp_as_cache_memory *mem)
+{
+    int size_cache = ocp_qp_as_cache_size(opts, mem);
+
+    if (size_cache <= 0 || !mem->active)
+        return;
+
+    int N = qp_in->dim->N;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int *as = mem->as_tmp;
+    int nk = mem->nv + mem->ne;
+    int c_off = 0;
+
+    int ii, jj, pos;
+
+    // active set of the solution: lam > t classifies the constraint as active
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nc0 = nb[ii] + ng[ii];
+        for (jj = 0; jj < nc0; jj++)
+        {
+            double lam_l = BLASFEO_DVECEL(qp_out->lam + ii, jj);
+            double lam_u = BLASFEO_DVECEL(qp_out->lam + ii, nc0 + jj);
+            double t_l = BLASFEO_DVECEL(qp_out->t + ii, jj);
+            double t_u = BLASFEO_DVECEL(qp_out->t + ii, nc0 + jj);
+            if (lam_l > t_l && lam_l >= lam_u)
+                as[c_off + jj] = 1;
+            else if (lam_u > t_u)
+                as[c_off + jj] = 2;
+            else
+                as[c_off + jj] = 0;
+            if (as[c_off + jj])
+                nk++;
+        }
+        c_off += nc0;
+    }
+
+    if (nk > mem->nk_max)
+        return;
+
+    // already cached (candidate rejected only by the feasibility tolerance)
+    for (pos = 0; pos < mem->num_entries; pos++)
+    {
+        if (!memcmp(as, mem->as[mem->order[pos]], mem->nc * sizeof(int)))
+        {
+            ocp_qp_as_cache_move_to_front(mem, pos);
+            return;
+        }
+    }
+
+    // take a free slot, or replace the least recently used one
+    // the cache size was reduced: drop the least recently used entries
+    if (mem->num_entries > size_cache)
+        mem->num_entries = size_cache;
+    if (mem->num_entries < size_cache)
+        mem->num_entries++;
+    pos = mem->num_entries - 1;
+    ocp_qp_as_cache_move_to_front(mem, pos);
+    int slot = mem->order[0];
+
+    memcpy(mem->as[slot], as, mem->nc * sizeof(int));
+    mem->nk[slot] = nk;
+
+    double *LU = mem->LU[slot];
+    ocp_qp_as_cache_build_kkt(qp_in, mem, as, nk, LU);
+
+    int info = 0;
+    dgetf2_3l(nk, nk, LU, nk, mem->ipiv[slot], &info);
+
+    // reject (numerically) singular KKT systems, e.g. from degenerate active sets
+    double diag_max = 0.0;
+    double diag_min = 0.0;
+    for (jj = 0; jj < nk; jj++)
+    {
+        double tmp = fabs(LU[jj + jj * nk]);
+        diag_max = jj == 0 || tmp > diag_max ? tmp : diag_max;
+        diag_min = jj == 0 || tmp < diag_min ? tmp : diag_min;
+    }
+    if (info != 0 || diag_min <= 1e-12 * diag_max)
+    {
+        // move the slot behind the valid entries
+        for (pos = 0; pos < mem->num_entries - 1; pos++)
+            mem->order[pos] = mem->order[pos + 1];
+        mem->order[mem->num_entries - 1] = slot;
+        mem->num_entries--;
+    }
+
+    return;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+#ifndef ACADOS_OCP_QP_OCP_QP_AS_CACHE_H_
+#define ACADOS_OCP_QP_OCP_QP_AS_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// acados
+#include "acados/ocp_qp/ocp_qp_common.h"
+#include "acados/utils/types.h"
+
+
+
+// Cache of the most recently used active sets of an ocp qp, each with the LU factorization of the
+// corresponding reduced KKT system (equality-constrained qp with the active inequalities fixed).
+// For a new qp with the same data matrices, a cached active set gives the solution with a single
+// back substitution; it is accepted if it is primal and dual feasible, otherwise the qp solver is
+// called and its active set is added to the cache. Slack variables (ns > 0) are not supported:
+// the cache is then inactive.
+typedef struct ocp_qp_as_cache_opts_
+{
+    int size;    // max number of cached active sets, 0: cache disabled
+    double tol;  // tolerance on primal and dual feasibility of a cached candidate
+} ocp_qp_as_cache_opts;
+
+
+
+typedef struct ocp_qp_as_cache_memory_
+{
+    int nv;           // primal variables of the stacked qp
+    int ne;           // equality constraints (dynamics) of the stacked qp
+    int nc;           // two-sided inequality constraints of the stacked qp
+    int nk_max;       // max size of a reduced KKT system
+    int capacity;     // number of allocated cache slots (opts->size at memory_assign, 0: none)
+    int active;       // 0 if the qp is not supported (ns > 0)
+    int num_entries;  // number of valid cache entries
+    int *order;       // cache slots, most recently used first
+    int **as;         // active set of each slot: 0 inactive, 1 at lower, 2 at upper bound
+    int *nk;          // size of the reduced KKT system of each slot
+    double **LU;      // LU factorization of the reduced KKT system of each slot
+    int **ipiv;       // pivots of the LU factorization of each slot
+    // copy of the data matrices the factorizations are built on (column-major)
+    double *RSQ;
+    double *BA;
+    double *DC;
+    int *idxb;
+    int data_init;
+    // workspace
+    double *sol;
+    int *as_tmp;
+    // statistics
+    int calls;
+    int hits;
+} ocp_qp_as_cache_memory;
+
+
+
+//
+void ocp_qp_as_cache_opts_initialize_default(ocp_qp_as_cache_opts *opts);
+//
+void ocp_qp_as_cache_opts_set(ocp_qp_as_cache_opts *opts, const char *field, void *value);
+//
+int ocp_qp_as_cache_memory_calculate_size(ocp_qp_dims *dims, ocp_qp_as_cache_opts *opts);
+//
+ocp_qp_as_cache_memory *ocp_qp_as_cache_memory_assign(ocp_qp_dims *dims, ocp_qp_as_cache_opts *opts,
+                                                      void *raw_memory);
+//
+void ocp_qp_as_cache_memory_get(ocp_qp_as_cache_memory *mem, const char *field, void *value);
+// returns 1 if the cache is in use: opts->size > 0, memory allocated with a cache size > 0, no slacks
+int ocp_qp_as_cache_enabled(ocp_qp_as_cache_opts *opts, ocp_qp_as_cache_memory *mem);
+// returns 1 and writes qp_out if a cached active set gives the solution of qp_in, 0 otherwise
+int ocp_qp_as_cache_lookup(ocp_qp_in *qp_in, ocp_qp_out *qp_out, ocp_qp_as_cache_opts *opts,
+                           ocp_qp_as_cache_memory *mem);
+// adds the active set of the solution qp_out of qp_in to the cache
+void ocp_qp_as_cache_insert(ocp_qp_in *qp_in, ocp_qp_out *qp_out, ocp_qp_as_cache_opts *opts,
+                            ocp_qp_as_cache_memory *mem);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // ACADOS_OCP_QP_OCP_QP_AS_CACHE_H_
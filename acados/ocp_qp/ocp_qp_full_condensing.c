@@ -216,6 +216,9 @@ void ocp_qp_full_condensing_opts_initialize_default(void *dims_, void *opts_)
 
 	opts->mem_qp_in = 1;
 
+	// condense Hessian and constraint matrices at every call by default
+	opts->lti = 0;
+
 	return;
 }
 
@@ -253,6 +256,11 @@ void ocp_qp_full_condensing_opts_set(void *opts_, const char *field, void* value
 		int *tmp_ptr = value;
 		opts->expand_dual_sol = *tmp_ptr;
 	}
+	else if(!strcmp(field, "lti"))
+	{
+		int *tmp_ptr = value;
+		opts->lti = *tmp_ptr;
+	}
 	else
 	{
 		printf("\nerror: field %s not available in ocp_qp_full_condensing_opts_set\n", field);
@@ -330,6 +338,8 @@ void *ocp_qp_full_condensing_memory_assign(void *dims_, void *opts_, void *raw_m
 
 	mem->qp_out_info = (qp_info *) mem->fcond_qp_out->misc;
 
+	mem->lti_cond_done = 0;
+
     assert((char *) raw_memory + ocp_qp_full_condensing_memory_calculate_size(dims, opts) >= c_ptr);
 
     return mem;
@@ -396,15 +406,18 @@ int ocp_qp_full_condensing(void *qp_in_, void *fcond_qp_in_, void *opts_, void *
     mem->ptr_qp_in = qp_in;
 
     // convert to dense qp structure
-    if (opts->cond_hess == 0)
+    if (opts->cond_hess == 0 || (opts->lti == 1 && mem->lti_cond_done == 1))
     {
         // condense gradient only
+        // (LTI: Hessian and constraint matrices in fcond_qp_in and hpipm workspace are kept)
         d_cond_qp_cond_rhs(qp_in, fcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
     }
     else
     {
         // condense gradient and Hessian
         d_cond_qp_cond(qp_in, fcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+        // LTI: condense matrices only once; switching lti off and on forces a new condensing
+        mem->lti_cond_done = opts->lti;
     }
 
 	return ACADOS_SUCCESS;
@@ -62,6 +62,7 @@ typedef struct ocp_qp_full_condensing_opts_
     int expand_dual_sol; // 0 primal sol only, 1 primal + dual sol
 	int ric_alg;
 	int mem_qp_in; // allocate qp_in in memory
+	int lti; // 0 cond hess at every call, 1 cond hess only at first call (LTI), then only rhs
 } ocp_qp_full_condensing_opts;
 
 
@@ -75,6 +76,7 @@ typedef struct ocp_qp_full_condensing_memory_
 	// only pointer
     ocp_qp_in *ptr_qp_in;
 	qp_info *qp_out_info; // info in fcond_qp_in
+	int lti_cond_done; // hess and constr matrices condensed once and kept in fcond_qp_in (LTI)
 } ocp_qp_full_condensing_memory;
 
 
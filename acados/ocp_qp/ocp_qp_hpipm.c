@@ -40,6 +40,10 @@
 #include "hpipm/include/hpipm_d_ocp_qp.h"
 #include "hpipm/include/hpipm_d_ocp_qp_ipm.h"
 #include "hpipm/include/hpipm_d_ocp_qp_sol.h"
+#include "hpipm/include/hpipm_s_ocp_qp.h"
+#include "hpipm/include/hpipm_s_ocp_qp_dim.h"
+#include "hpipm/include/hpipm_s_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_s_ocp_qp_sol.h"
 // acados
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/ocp_qp/ocp_qp_hpipm.h"
@@ -63,7 +67,11 @@ int ocp_qp_hpipm_opts_calculate_size(void *config_, void *dims_)
     size += sizeof(struct d_ocp_qp_ipm_arg);
     size += d_ocp_qp_ipm_arg_memsize(dims);
 
-    size += 1 * 8;
+    // mixed precision (the ipm arguments only depend on the dims through ints)
+    size += sizeof(struct s_ocp_qp_ipm_arg);
+    size += s_ocp_qp_ipm_arg_memsize((struct s_ocp_qp_dim *) dims);
+
+    size += 2 * 8;
     return size;
 }
 
@@ -88,6 +96,16 @@ void *ocp_qp_hpipm_opts_assign(void *config_, void *dims_, void *raw_memory)
     d_ocp_qp_ipm_arg_create(dims, opts->hpipm_opts, c_ptr);
     c_ptr += d_ocp_qp_ipm_arg_memsize(dims);
 
+    // mixed precision: the ipm arguments do not depend on the stage dims, the single precision
+    // dims are created in memory_assign from the dims of the qp actually solved
+    opts->s_hpipm_opts = (struct s_ocp_qp_ipm_arg *) c_ptr;
+    c_ptr += sizeof(struct s_ocp_qp_ipm_arg);
+
+    align_char_to(8, &c_ptr);
+
+    s_ocp_qp_ipm_arg_create((struct s_ocp_qp_dim *) dims, opts->s_hpipm_opts, c_ptr);
+    c_ptr += s_ocp_qp_ipm_arg_memsize((struct s_ocp_qp_dim *) dims);
+
     assert((char *) raw_memory + ocp_qp_hpipm_opts_calculate_size(config_, dims) >= c_ptr);
 
     return (void *) opts;
@@ -112,6 +130,15 @@ void ocp_qp_hpipm_opts_initialize_default(void *config_, void *dims_, void *opts
     opts->hpipm_opts->alpha_min = 1e-8;
     opts->hpipm_opts->mu0 = 1e0;
 
+    // mixed precision: residual tolerances of the single precision ipm are limited by its
+    // accuracy, the remaining ones are taken from the double precision options at each call
+    opts->mixed_precision = 0;
+    opts->itref_max = 5;
+    s_ocp_qp_ipm_arg_set_default(BALANCE, opts->s_hpipm_opts);
+    opts->s_hpipm_opts->res_g_max = 1e-4;
+    opts->s_hpipm_opts->res_b_max = 1e-4;
+    opts->s_hpipm_opts->res_d_max = 1e-4;
+
     return;
 }
 
@@ -130,7 +157,20 @@ void ocp_qp_hpipm_opts_set(void *config_, void *opts_, const char *field, void *
 {
     ocp_qp_hpipm_opts *opts = opts_;
 
-	d_ocp_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+	if (!strcmp(field, "mixed_precision"))
+	{
+		int *tmp_ptr = value;
+		opts->mixed_precision = *tmp_ptr;
+	}
+	else if (!strcmp(field, "mixed_precision_itref_max"))
+	{
+		int *tmp_ptr = value;
+		opts->itref_max = *tmp_ptr;
+	}
+	else
+	{
+		d_ocp_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+	}
 
 	return;
 }
@@ -153,6 +193,22 @@ int ocp_qp_hpipm_memory_calculate_size(void *config_, void *dims_, void *opts_)
 
     size += d_ocp_qp_ipm_ws_memsize(dims, opts->hpipm_opts);
 
+    if (opts->mixed_precision)
+    {
+        // the single precision structures are sized from the dims of the qp actually solved
+        // (e.g. the partially condensed one), the dims struct only holds ints and its layout
+        // is the same in both precisions
+        struct s_ocp_qp_dim *s_dims = (struct s_ocp_qp_dim *) dims;
+
+        size += sizeof(struct s_ocp_qp_dim) + s_ocp_qp_dim_memsize(dims->N);
+        size += sizeof(struct s_ocp_qp) + s_ocp_qp_memsize(s_dims);
+        size += sizeof(struct s_ocp_qp_sol) + s_ocp_qp_sol_memsize(s_dims);
+        size += sizeof(struct s_ocp_qp_ipm_ws) + s_ocp_qp_ipm_ws_memsize(s_dims, opts->s_hpipm_opts);
+        size += ocp_qp_res_calculate_size(dims);
+        size += ocp_qp_res_workspace_calculate_size(dims);
+        size += 6 * 8;
+    }
+
     size += 1 * 8;
     return size;
 }
@@ -183,6 +239,60 @@ void *ocp_qp_hpipm_memory_assign(void *config_, void *dims_, void *opts_, void *
     d_ocp_qp_ipm_ws_create(dims, opts->hpipm_opts, ipm_workspace, c_ptr);
     c_ptr += ipm_workspace->memsize;
 
+    mem->mixed_precision = opts->mixed_precision;
+    mem->last_mixed = 0;
+    mem->fallbacks = 0;
+
+    if (opts->mixed_precision)
+    {
+        // single precision copy of the dims
+        mem->s_dims = (struct s_ocp_qp_dim *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_dim);
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_dim_create(dims->N, mem->s_dims, c_ptr);
+        c_ptr += s_ocp_qp_dim_memsize(dims->N);
+
+        for (int ii = 0; ii <= dims->N; ii++)
+        {
+            s_ocp_qp_dim_set("nx", ii, dims->nx[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nu", ii, dims->nu[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nbx", ii, dims->nbx[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nbu", ii, dims->nbu[ii], mem->s_dims);
+            s_ocp_qp_dim_set("ng", ii, dims->ng[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nsbx", ii, dims->nsbx[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nsbu", ii, dims->nsbu[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nsg", ii, dims->nsg[ii], mem->s_dims);
+        }
+
+        // single precision qp, solution and ipm workspace
+        mem->s_qp_in = (struct s_ocp_qp *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp);
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_create(mem->s_dims, mem->s_qp_in, c_ptr);
+        c_ptr += s_ocp_qp_memsize(mem->s_dims);
+
+        mem->s_qp_out = (struct s_ocp_qp_sol *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_sol);
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_sol_create(mem->s_dims, mem->s_qp_out, c_ptr);
+        c_ptr += s_ocp_qp_sol_memsize(mem->s_dims);
+
+        mem->s_hpipm_workspace = (struct s_ocp_qp_ipm_ws *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_ipm_ws);
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_ipm_ws_create(mem->s_dims, opts->s_hpipm_opts, mem->s_hpipm_workspace, c_ptr);
+        c_ptr += mem->s_hpipm_workspace->memsize;
+
+        // double precision residuals for the iterative refinement
+        align_char_to(8, &c_ptr);
+        mem->qp_res = ocp_qp_res_assign(dims, c_ptr);
+        c_ptr += ocp_qp_res_calculate_size(dims);
+
+        align_char_to(8, &c_ptr);
+        mem->qp_res_ws = ocp_qp_res_workspace_assign(dims, c_ptr);
+        c_ptr += ocp_qp_res_workspace_calculate_size(dims);
+    }
+
     assert((char *) raw_memory + ocp_qp_hpipm_memory_calculate_size(config_, dims, opts_) >= c_ptr);
 
     return mem;
@@ -205,6 +315,11 @@ void ocp_qp_hpipm_memory_get(void *config_, void *mem_, const char *field, void*
 		int *tmp_ptr = value;
 		*tmp_ptr = mem->iter;
 	}
+	else if (!strcmp(field, "mixed_precision_fallbacks"))
+	{
+		int *tmp_ptr = value;
+		*tmp_ptr = mem->fallbacks;
+	}
 	else
 	{
 		printf("\nerror: ocp_qp_hpipm_memory_get: field %s not available\n", field);
@@ -228,6 +343,212 @@ int ocp_qp_hpipm_workspace_calculate_size(void *config_, void *dims_, void *opts
 
 
 
+/************************************************
+ * mixed precision
+ ************************************************/
+
+// copy qp data into the single precision qp
+static void ocp_qp_hpipm_cvt_d2s_qp(ocp_qp_in *qp_in, struct s_ocp_qp *s_qp_in)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+    int *ns = qp_in->dim->ns;
+
+    int ii, jj, kk;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = 2 * nb[ii] + 2 * ng[ii] + 2 * ns[ii];
+
+        for (jj = 0; jj < nx1; jj++)
+            for (kk = 0; kk <= nv0; kk++)
+                BLASFEO_SMATEL(s_qp_in->BAbt + ii, kk, jj) = BLASFEO_DMATEL(qp_in->BAbt + ii, kk, jj);
+        for (jj = 0; jj < nv0; jj++)
+            for (kk = jj; kk <= nv0; kk++)
+                BLASFEO_SMATEL(s_qp_in->RSQrq + ii, kk, jj) = BLASFEO_DMATEL(qp_in->RSQrq + ii, kk, jj);
+        for (jj = 0; jj < ng[ii]; jj++)
+            for (kk = 0; kk < nv0; kk++)
+                BLASFEO_SMATEL(s_qp_in->DCt + ii, kk, jj) = BLASFEO_DMATEL(qp_in->DCt + ii, kk, jj);
+
+        for (jj = 0; jj < nx1; jj++)
+            BLASFEO_SVECEL(s_qp_in->b + ii, jj) = BLASFEO_DVECEL(qp_in->b + ii, jj);
+        for (jj = 0; jj < nv0 + 2 * ns[ii]; jj++)
+            BLASFEO_SVECEL(s_qp_in->rqz + ii, jj) = BLASFEO_DVECEL(qp_in->rqz + ii, jj);
+        for (jj = 0; jj < nc0; jj++)
+        {
+            BLASFEO_SVECEL(s_qp_in->d + ii, jj) = BLASFEO_DVECEL(qp_in->d + ii, jj);
+            BLASFEO_SVECEL(s_qp_in->m + ii, jj) = BLASFEO_DVECEL(qp_in->m + ii, jj);
+        }
+        for (jj = 0; jj < 2 * ns[ii]; jj++)
+            BLASFEO_SVECEL(s_qp_in->Z + ii, jj) = BLASFEO_DVECEL(qp_in->Z + ii, jj);
+
+        for (jj = 0; jj < nb[ii]; jj++)
+            s_qp_in->idxb[ii][jj] = qp_in->idxb[ii][jj];
+        for (jj = 0; jj < ns[ii]; jj++)
+            s_qp_in->idxs[ii][jj] = qp_in->idxs[ii][jj];
+    }
+
+    return;
+}
+
+
+
+// copy (add == 0) or add (add == 1) the single precision solution (or step) to qp_out
+static void ocp_qp_hpipm_cvt_s2d_sol(struct s_ocp_qp_sol *s_qp_out, ocp_qp_out *qp_out, int add)
+{
+    int N = qp_out->dim->N;
+    int *nx = qp_out->dim->nx;
+    int *nu = qp_out->dim->nu;
+    int *nb = qp_out->dim->nb;
+    int *ng = qp_out->dim->ng;
+    int *ns = qp_out->dim->ns;
+
+    double scale = add ? 1.0 : 0.0;
+
+    int ii, jj;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = 2 * nb[ii] + 2 * ng[ii] + 2 * ns[ii];
+
+        for (jj = 0; jj < nu[ii] + nx[ii] + 2 * ns[ii]; jj++)
+            BLASFEO_DVECEL(qp_out->ux + ii, jj) = scale * BLASFEO_DVECEL(qp_out->ux + ii, jj)
+                                                  + BLASFEO_SVECEL(s_qp_out->ux + ii, jj);
+        for (jj = 0; jj < nx1; jj++)
+            BLASFEO_DVECEL(qp_out->pi + ii, jj) = scale * BLASFEO_DVECEL(qp_out->pi + ii, jj)
+                                                  + BLASFEO_SVECEL(s_qp_out->pi + ii, jj);
+        for (jj = 0; jj < nc0; jj++)
+        {
+            BLASFEO_DVECEL(qp_out->lam + ii, jj) = scale * BLASFEO_DVECEL(qp_out->lam + ii, jj)
+                                                   + BLASFEO_SVECEL(s_qp_out->lam + ii, jj);
+            BLASFEO_DVECEL(qp_out->t + ii, jj) = scale * BLASFEO_DVECEL(qp_out->t + ii, jj)
+                                                 + BLASFEO_SVECEL(s_qp_out->t + ii, jj);
+        }
+    }
+
+    return;
+}
+
+
+
+// copy the vectors of a (parametric) qp into the vectors of the single precision qp
+static void ocp_qp_hpipm_cvt_d2s_rhs(struct blasfeo_dvec *g, struct blasfeo_dvec *b,
+                                     struct blasfeo_dvec *d, struct blasfeo_dvec *m,
+                                     struct s_ocp_qp *s_qp_in)
+{
+    int N = s_qp_in->dim->N;
+    int *nx = s_qp_in->dim->nx;
+    int *nu = s_qp_in->dim->nu;
+    int *nb = s_qp_in->dim->nb;
+    int *ng = s_qp_in->dim->ng;
+    int *ns = s_qp_in->dim->ns;
+
+    int ii, jj;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = 2 * nb[ii] + 2 * ng[ii] + 2 * ns[ii];
+
+        for (jj = 0; jj < nu[ii] + nx[ii] + 2 * ns[ii]; jj++)
+            BLASFEO_SVECEL(s_qp_in->rqz + ii, jj) = BLASFEO_DVECEL(g + ii, jj);
+        for (jj = 0; jj < nx1; jj++)
+            BLASFEO_SVECEL(s_qp_in->b + ii, jj) = BLASFEO_DVECEL(b + ii, jj);
+        for (jj = 0; jj < nc0; jj++)
+        {
+            BLASFEO_SVECEL(s_qp_in->d + ii, jj) = BLASFEO_DVECEL(d + ii, jj);
+            BLASFEO_SVECEL(s_qp_in->m + ii, jj) = BLASFEO_DVECEL(m + ii, jj);
+        }
+    }
+
+    return;
+}
+
+
+
+static int ocp_qp_hpipm_positive_lam_t(ocp_qp_out *qp_out)
+{
+    int N = qp_out->dim->N;
+    int *nb = qp_out->dim->nb;
+    int *ng = qp_out->dim->ng;
+    int *ns = qp_out->dim->ns;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        for (int jj = 0; jj < 2 * nb[ii] + 2 * ng[ii] + 2 * ns[ii]; jj++)
+        {
+            if (BLASFEO_DVECEL(qp_out->lam + ii, jj) <= 0.0 || BLASFEO_DVECEL(qp_out->t + ii, jj) <= 0.0)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+
+// ipm in single precision, then iterative refinement of the equality parts of the KKT system in
+// double precision, reusing the last single precision factorization (sensitivity solve with the
+// residuals as right hand side and the linearized complementarity kept);
+// returns 1 if the double precision tolerances are met
+static int ocp_qp_hpipm_mixed_precision(ocp_qp_in *qp_in, ocp_qp_out *qp_out,
+                                        ocp_qp_hpipm_opts *opts, ocp_qp_hpipm_memory *mem,
+                                        int *iter)
+{
+    struct d_ocp_qp_ipm_arg *arg = opts->hpipm_opts;
+    struct s_ocp_qp_ipm_arg *s_arg = opts->s_hpipm_opts;
+
+    s_arg->mu0 = arg->mu0;
+    s_arg->alpha_min = arg->alpha_min;
+    s_arg->res_m_max = arg->res_m_max;
+    s_arg->iter_max = arg->iter_max;
+    s_arg->stat_max = arg->stat_max;
+
+    ocp_qp_hpipm_cvt_d2s_qp(qp_in, mem->s_qp_in);
+
+    int s_status;
+    s_ocp_qp_ipm_solve(mem->s_qp_in, mem->s_qp_out, s_arg, mem->s_hpipm_workspace);
+    s_ocp_qp_ipm_get_status(mem->s_hpipm_workspace, &s_status);
+    *iter = mem->s_hpipm_workspace->iter;
+
+    // no usable iterate (min step length or nan)
+    if (s_status != 0 && s_status != 1)
+        return 0;
+
+    ocp_qp_hpipm_cvt_s2d_sol(mem->s_qp_out, qp_out, 0);
+
+    double res[4];
+    for (int kk = 0; ; kk++)
+    {
+        d_ocp_qp_res_compute(qp_in, qp_out, mem->qp_res, mem->qp_res_ws);
+        ocp_qp_res_compute_nrm_inf(mem->qp_res, res);
+
+        if (res[0] <= arg->res_g_max && res[1] <= arg->res_b_max &&
+            res[2] <= arg->res_d_max && res[3] <= arg->res_m_max)
+            return 1;
+
+        if (kk == opts->itref_max)
+            return 0;
+
+        ocp_qp_hpipm_cvt_d2s_rhs(mem->qp_res->res_g, mem->qp_res->res_b, mem->qp_res->res_d,
+                                 mem->qp_res->res_m, mem->s_qp_in);
+        s_ocp_qp_ipm_sens(mem->s_qp_in, mem->s_qp_out, s_arg, mem->s_hpipm_workspace);
+        ocp_qp_hpipm_cvt_s2d_sol(mem->s_qp_out, qp_out, 1);
+        (*iter)++;
+
+        if (!ocp_qp_hpipm_positive_lam_t(qp_out))
+            return 0;
+    }
+}
+
+
+
 /************************************************
  * functions
  ************************************************/
@@ -245,33 +566,53 @@ int ocp_qp_hpipm(void *config_, void *qp_in_, void *qp_out_, void *opts_, void *
     ocp_qp_hpipm_opts *opts = opts_;
     ocp_qp_hpipm_memory *mem = mem_;
 
-	// zero primal solution
-	// TODO add a check if warm start of first SQP iteration is implemented !!!!!!
-	int ii;
-	int N = qp_in->dim->N;
-	int *nx = qp_in->dim->nx;
-	int *nu = qp_in->dim->nu;
-	int *ns = qp_in->dim->ns;
-	for(ii=0; ii<=N; ii++)
-	{
-		blasfeo_dvecse(nu[ii]+nx[ii]+2*ns[ii], 0.0, qp_out->ux+ii, 0);
-	}
+    int hpipm_status;
+    int iter = 0;
 
-    // solve ipm
     acados_tic(&qp_timer);
-    // print_ocp_qp_in(qp_in);
-    int hpipm_status;
-	d_ocp_qp_ipm_solve(qp_in, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
-	d_ocp_qp_ipm_get_status(mem->hpipm_workspace, &hpipm_status);
+
+    // mixed precision solve, with fallback to double precision
+    mem->last_mixed = 0;
+    if (opts->mixed_precision && mem->mixed_precision)
+    {
+        mem->last_mixed = ocp_qp_hpipm_mixed_precision(qp_in, qp_out, opts, mem, &iter);
+        if (!mem->last_mixed)
+            mem->fallbacks++;
+    }
+
+    if (mem->last_mixed)
+    {
+        hpipm_status = 0;
+    }
+    else
+    {
+        // zero primal solution
+        // TODO add a check if warm start of first SQP iteration is implemented !!!!!!
+        int ii;
+        int N = qp_in->dim->N;
+        int *nx = qp_in->dim->nx;
+        int *nu = qp_in->dim->nu;
+        int *ns = qp_in->dim->ns;
+        for(ii=0; ii<=N; ii++)
+        {
+            blasfeo_dvecse(nu[ii]+nx[ii]+2*ns[ii], 0.0, qp_out->ux+ii, 0);
+        }
+
+        // solve ipm
+        // print_ocp_qp_in(qp_in);
+        d_ocp_qp_ipm_solve(qp_in, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+        d_ocp_qp_ipm_get_status(mem->hpipm_workspace, &hpipm_status);
+        iter += mem->hpipm_workspace->iter;
+    }
 
     info->solve_QP_time = acados_toc(&qp_timer);
     info->interface_time = 0;  // there are no conversions for hpipm
     info->total_time = acados_toc(&tot_timer);
-    info->num_iter = mem->hpipm_workspace->iter;
+    info->num_iter = iter;
     info->t_computed = 1;
 
 	mem->time_qp_solver_call = info->solve_QP_time;
-	mem->iter = mem->hpipm_workspace->iter;
+	mem->iter = iter;
 
     // check exit conditions
     int acados_status = hpipm_status;
@@ -300,7 +641,18 @@ void ocp_qp_hpipm_eval_sens(void *config_, void *param_qp_in_, void *sens_qp_out
     // solve ipm
 //    acados_tic(&qp_timer);
     // print_ocp_qp_in(param_qp_in);
-	d_ocp_qp_ipm_sens(param_qp_in, sens_qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+	if (mem->last_mixed)
+	{
+		// last factorization is the single precision one
+		ocp_qp_hpipm_cvt_d2s_rhs(param_qp_in->rqz, param_qp_in->b, param_qp_in->d, param_qp_in->m,
+		                         mem->s_qp_in);
+		s_ocp_qp_ipm_sens(mem->s_qp_in, mem->s_qp_out, opts->s_hpipm_opts, mem->s_hpipm_workspace);
+		ocp_qp_hpipm_cvt_s2d_sol(mem->s_qp_out, sens_qp_out, 0);
+	}
+	else
+	{
+		d_ocp_qp_ipm_sens(param_qp_in, sens_qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+	}
 
 //    info->solve_QP_time = acados_toc(&qp_timer);
 //    info->interface_time = 0;  // there are no conversions for hpipm
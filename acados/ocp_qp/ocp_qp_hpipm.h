@@ -41,6 +41,10 @@ extern "C" {
 
 // hpipm
 #include "hpipm/include/hpipm_d_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_s_ocp_qp.h"
+#include "hpipm/include/hpipm_s_ocp_qp_dim.h"
+#include "hpipm/include/hpipm_s_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_s_ocp_qp_sol.h"
 // acados
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/utils/types.h"
@@ -52,6 +56,11 @@ extern "C" {
 typedef struct ocp_qp_hpipm_opts_
 {
     struct d_ocp_qp_ipm_arg *hpipm_opts;
+    // mixed precision: ipm in single precision, iterative refinement of the solution in double
+    // precision, fallback to the double precision ipm if the refinement does not converge
+    struct s_ocp_qp_ipm_arg *s_hpipm_opts;
+    int mixed_precision;  // 0: double precision ipm, 1: mixed precision
+    int itref_max;        // max number of iterative refinement steps in mixed precision
 } ocp_qp_hpipm_opts;
 
 
@@ -63,6 +72,16 @@ typedef struct ocp_qp_hpipm_memory_
     struct d_ocp_qp_ipm_ws *hpipm_workspace;
 	double time_qp_solver_call;
 	int iter;
+	// mixed precision (sized from the dims of the qp passed to memory_assign)
+	struct s_ocp_qp_dim *s_dims;
+	struct s_ocp_qp *s_qp_in;
+	struct s_ocp_qp_sol *s_qp_out;
+	struct s_ocp_qp_ipm_ws *s_hpipm_workspace;
+	ocp_qp_res *qp_res;
+	ocp_qp_res_ws *qp_res_ws;
+	int mixed_precision;  // mixed precision structures are allocated
+	int last_mixed;       // last solution from mixed precision (factorization in s_hpipm_workspace)
+	int fallbacks;        // number of mixed precision solves that fell back to double precision
 
 } ocp_qp_hpipm_memory;
 
@@ -40,8 +40,11 @@
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/ocp_qp/ocp_qp_partial_condensing.h"
 #include "acados/utils/mem.h"
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
 // hpipm
 #include "hpipm/include/hpipm_d_cond.h"
+#include "hpipm/include/hpipm_d_cond_aux.h"
 #include "hpipm/include/hpipm_d_dense_qp.h"
 #include "hpipm/include/hpipm_d_dense_qp_sol.h"
 #include "hpipm/include/hpipm_d_ocp_qp.h"
@@ -244,6 +247,10 @@ void ocp_qp_partial_condensing_opts_initialize_default(void *dims_, void *opts_)
 
 	opts->mem_qp_in = 1;
 
+	opts->par_blocks = 0;
+
+	opts->cond_hess = 1;
+
 	return;
 }
 
@@ -285,6 +292,16 @@ void ocp_qp_partial_condensing_opts_set(void *opts_, const char *field, void* va
 		int *tmp_ptr = value;
 		opts->ric_alg = *tmp_ptr;
 	}
+	else if(!strcmp(field, "par_blocks"))
+	{
+		int *tmp_ptr = value;
+		opts->par_blocks = *tmp_ptr;
+	}
+	else if(!strcmp(field, "cond_hess"))
+	{
+		int *tmp_ptr = value;
+		opts->cond_hess = *tmp_ptr;
+	}
 	else
 	{
 		printf("\nerror: field %s not available in ocp_qp_partial_condensing_opts_set\n", field);
@@ -324,6 +341,9 @@ int ocp_qp_partial_condensing_memory_calculate_size(void *dims_, void *opts_)
     size += sizeof(struct d_part_cond_qp_ws);
     size += d_part_cond_qp_ws_memsize(dims->orig_dims, dims->block_size, dims->pcond_dims, opts->hpipm_opts);
 
+	// block_start
+	size += (dims->orig_dims->N + 1) * sizeof(int);
+
     size += 2 * 8;
 
     return size;
@@ -362,6 +382,12 @@ void *ocp_qp_partial_condensing_memory_assign(void *dims_, void *opts_, void *ra
 
 	mem->qp_out_info = (qp_info *) mem->pcond_qp_out->misc;
 
+	// block_start
+	assign_and_advance_int(dims->orig_dims->N + 1, &mem->block_start, &c_ptr);
+	mem->block_start[0] = 0;
+	for (int ii = 0; ii < opts->N2; ii++)
+		mem->block_start[ii+1] = mem->block_start[ii] + dims->block_size[ii];
+
     assert((char *) raw_memory + ocp_qp_partial_condensing_memory_calculate_size(dims, opts) >= c_ptr);
 
     return mem;
@@ -411,6 +437,170 @@ int ocp_qp_partial_condensing_workspace_calculate_size(void *dims_, void *opts_)
 
 
 
+/************************************************
+ * block-parallel condensing and expansion
+ ************************************************/
+
+// alias stages N_tmp to N_tmp+bs of qp_in as an ocp qp with horizon bs
+static void ocp_qp_partial_condensing_alias_block(ocp_qp_in *qp_in, int N_tmp, int bs,
+		ocp_qp_dims *tmp_dims, ocp_qp_in *tmp_qp_in)
+{
+	ocp_qp_dims *dims = qp_in->dim;
+
+	// alias dims
+	tmp_dims->N = bs;
+	tmp_dims->nx = dims->nx+N_tmp;
+	tmp_dims->nu = dims->nu+N_tmp;
+	tmp_dims->nb = dims->nb+N_tmp;
+	tmp_dims->nbx = dims->nbx+N_tmp;
+	tmp_dims->nbu = dims->nbu+N_tmp;
+	tmp_dims->ng = dims->ng+N_tmp;
+	tmp_dims->ns = dims->ns+N_tmp;
+	tmp_dims->nsbx = dims->nsbx+N_tmp;
+	tmp_dims->nsbu = dims->nsbu+N_tmp;
+	tmp_dims->nsg = dims->nsg+N_tmp;
+
+	// alias qp_in
+	tmp_qp_in->dim = tmp_dims;
+	tmp_qp_in->idxb = qp_in->idxb+N_tmp;
+	tmp_qp_in->BAbt = qp_in->BAbt+N_tmp;
+	tmp_qp_in->b = qp_in->b+N_tmp;
+	tmp_qp_in->RSQrq = qp_in->RSQrq+N_tmp;
+	tmp_qp_in->rqz = qp_in->rqz+N_tmp;
+	tmp_qp_in->DCt = qp_in->DCt+N_tmp;
+	tmp_qp_in->d = qp_in->d+N_tmp;
+	tmp_qp_in->m = qp_in->m+N_tmp;
+	tmp_qp_in->Z = qp_in->Z+N_tmp;
+	tmp_qp_in->idxs = qp_in->idxs+N_tmp;
+
+	return;
+}
+
+
+
+// same as d_part_cond_qp_cond, but the blocks are condensed concurrently;
+// each block has its own hpipm cond arg and workspace, so blocks are independent
+static void ocp_qp_partial_condensing_par_blocks(ocp_qp_in *qp_in, ocp_qp_in *pcond_qp_in,
+		ocp_qp_partial_condensing_opts *opts, ocp_qp_partial_condensing_memory *mem)
+{
+	struct d_part_cond_qp_arg *arg = opts->hpipm_opts;
+	struct d_part_cond_qp_ws *ws = mem->hpipm_workspace;
+
+	int N = qp_in->dim->N;
+	int N2 = pcond_qp_in->dim->N;
+	int *block_start = mem->block_start;
+
+	int *nx = qp_in->dim->nx;
+	int *nu = qp_in->dim->nu;
+	int *nb = qp_in->dim->nb;
+	int *ng = qp_in->dim->ng;
+	int *ns = qp_in->dim->ns;
+
+	int ii, jj;
+
+#if defined(ACADOS_WITH_OPENMP)
+	#pragma omp parallel for
+#endif
+	for (ii = 0; ii < N2; ii++)
+	{
+		ocp_qp_dims tmp_dims;
+		ocp_qp_in tmp_qp_in;
+
+		ocp_qp_partial_condensing_alias_block(qp_in, block_start[ii],
+				block_start[ii+1]-block_start[ii], &tmp_dims, &tmp_qp_in);
+
+		d_cond_BAbt(&tmp_qp_in, pcond_qp_in->BAbt+ii, pcond_qp_in->b+ii, arg->cond_arg+ii,
+				ws->cond_workspace+ii);
+		d_cond_RSQrq(&tmp_qp_in, pcond_qp_in->RSQrq+ii, pcond_qp_in->rqz+ii, arg->cond_arg+ii,
+				ws->cond_workspace+ii);
+		d_cond_DCtd(&tmp_qp_in, pcond_qp_in->idxb[ii], pcond_qp_in->DCt+ii, pcond_qp_in->d+ii,
+				pcond_qp_in->m+ii, pcond_qp_in->idxs[ii], pcond_qp_in->Z+ii, pcond_qp_in->rqz+ii,
+				arg->cond_arg+ii, ws->cond_workspace+ii);
+	}
+
+	// copy last stage
+	blasfeo_dgecp(nu[N]+nx[N]+1, nu[N]+nx[N], qp_in->RSQrq+N, 0, 0, pcond_qp_in->RSQrq+N2, 0, 0);
+	blasfeo_dveccp(2*ns[N], qp_in->Z+N, 0, pcond_qp_in->Z+N2, 0);
+	blasfeo_dveccp(nu[N]+nx[N]+2*ns[N], qp_in->rqz+N, 0, pcond_qp_in->rqz+N2, 0);
+	blasfeo_dgecp(nu[N]+nx[N], ng[N], qp_in->DCt+N, 0, 0, pcond_qp_in->DCt+N2, 0, 0);
+	blasfeo_dveccp(2*nb[N]+2*ng[N]+2*ns[N], qp_in->d+N, 0, pcond_qp_in->d+N2, 0);
+	blasfeo_dveccp(2*nb[N]+2*ng[N]+2*ns[N], qp_in->m+N, 0, pcond_qp_in->m+N2, 0);
+	for (jj = 0; jj < nb[N]; jj++)
+		pcond_qp_in->idxb[N2][jj] = qp_in->idxb[N][jj];
+	for (jj = 0; jj < ns[N]; jj++)
+		pcond_qp_in->idxs[N2][jj] = qp_in->idxs[N][jj];
+
+	return;
+}
+
+
+
+// same as d_part_cond_qp_expand_sol, but the blocks are expanded concurrently
+static void ocp_qp_partial_expansion_par_blocks(ocp_qp_in *qp_in, ocp_qp_out *pcond_qp_out,
+		ocp_qp_out *qp_out, ocp_qp_partial_condensing_opts *opts,
+		ocp_qp_partial_condensing_memory *mem)
+{
+	struct d_part_cond_qp_arg *arg = opts->hpipm_opts;
+	struct d_part_cond_qp_ws *ws = mem->hpipm_workspace;
+
+	int N = qp_in->dim->N;
+	int N2 = pcond_qp_out->dim->N;
+	int *block_start = mem->block_start;
+
+	int *nx = qp_in->dim->nx;
+	int *nu = qp_in->dim->nu;
+	int *nb = qp_in->dim->nb;
+	int *ng = qp_in->dim->ng;
+	int *ns = qp_in->dim->ns;
+
+	int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+	#pragma omp parallel for
+#endif
+	for (ii = 0; ii < N2; ii++)
+	{
+		ocp_qp_dims tmp_dims;
+		ocp_qp_in tmp_qp_in;
+		ocp_qp_out tmp_qp_out;
+		struct d_dense_qp_sol dense_qp_sol;
+
+		ocp_qp_partial_condensing_alias_block(qp_in, block_start[ii],
+				block_start[ii+1]-block_start[ii], &tmp_dims, &tmp_qp_in);
+
+		// alias qp_out
+		tmp_qp_out.dim = &tmp_dims;
+		tmp_qp_out.ux = qp_out->ux+block_start[ii];
+		tmp_qp_out.pi = qp_out->pi+block_start[ii];
+		tmp_qp_out.lam = qp_out->lam+block_start[ii];
+		tmp_qp_out.t = qp_out->t+block_start[ii];
+
+		// alias stage ii of pcond_qp_out as dense qp solution
+		dense_qp_sol.v = pcond_qp_out->ux+ii;
+		dense_qp_sol.pi = pcond_qp_out->pi+ii;
+		dense_qp_sol.lam = pcond_qp_out->lam+ii;
+		dense_qp_sol.t = pcond_qp_out->t+ii;
+
+		d_expand_sol(&tmp_qp_in, &dense_qp_sol, &tmp_qp_out, arg->cond_arg+ii,
+				ws->cond_workspace+ii);
+
+		// multiplier of the last dynamics in the block, after the expansion and not for the last
+		// block, as in d_part_cond_qp_expand_sol
+		if (ii < N2-1)
+			blasfeo_dveccp(nx[block_start[ii+1]], pcond_qp_out->pi+ii, 0,
+					qp_out->pi+block_start[ii+1]-1, 0);
+	}
+
+	// copy last stage
+	blasfeo_dveccp(nu[N]+nx[N]+2*ns[N], pcond_qp_out->ux+N2, 0, qp_out->ux+N, 0);
+	blasfeo_dveccp(2*nb[N]+2*ng[N]+2*ns[N], pcond_qp_out->lam+N2, 0, qp_out->lam+N, 0);
+	blasfeo_dveccp(2*nb[N]+2*ng[N]+2*ns[N], pcond_qp_out->t+N2, 0, qp_out->t+N, 0);
+
+	return;
+}
+
+
+
 /************************************************
  * functions
  ************************************************/
@@ -430,7 +620,13 @@ int ocp_qp_partial_condensing(void *qp_in_, void *pcond_qp_in_, void *opts_, voi
 
     // convert to partially condensed qp structure
 	// TODO only if N2<N
-    d_part_cond_qp_cond(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+	if (opts->par_blocks)
+		ocp_qp_partial_condensing_par_blocks(qp_in, pcond_qp_in, opts, mem);
+	else if (opts->cond_hess == 0)
+		// condense gradient only (Hessian and constraint matrices in pcond_qp_in and hpipm workspace are kept)
+		d_part_cond_qp_cond_rhs(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+	else
+		d_part_cond_qp_cond(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
 
 	return ACADOS_SUCCESS;
 }
@@ -469,7 +665,10 @@ int ocp_qp_partial_expansion(void *pcond_qp_out_, void *qp_out_, void *opts_, vo
     assert(opts->N2 == opts->N2_bkp);
 
 	// TODO only if N2<N
-    d_part_cond_qp_expand_sol(mem->ptr_qp_in, mem->ptr_pcond_qp_in, pcond_qp_out, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+	if (opts->par_blocks)
+		ocp_qp_partial_expansion_par_blocks(mem->ptr_qp_in, pcond_qp_out, qp_out, opts, mem);
+	else
+		d_part_cond_qp_expand_sol(mem->ptr_qp_in, mem->ptr_pcond_qp_in, pcond_qp_out, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
 
 	return ACADOS_SUCCESS;
 }
@@ -64,6 +64,8 @@ typedef struct ocp_qp_partial_condensing_opts_
     int N2_bkp;
 	int ric_alg;
 	int mem_qp_in; // allocate qp_in in memory
+	int par_blocks; // condense and expand the blocks concurrently (needs ACADOS_WITH_OPENMP)
+	int cond_hess; // 0 cond only rhs (not with par_blocks), 1 cond hess + rhs
 } ocp_qp_partial_condensing_opts;
 
 
@@ -74,6 +76,7 @@ typedef struct ocp_qp_partial_condensing_memory_
 	// in memory
 	ocp_qp_in *pcond_qp_in;
 	ocp_qp_out *pcond_qp_out;
+	int *block_start; // first stage of each block (plus N at the end)
 	// only pointer
     ocp_qp_in *ptr_qp_in;
     ocp_qp_in *ptr_pcond_qp_in;
@@ -0,0 +1,1367 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+// external
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// hpipm
+#include "hpipm/include/hpipm_d_ocp_qp.h"
+#include "hpipm/include/hpipm_d_ocp_qp_sol.h"
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+#include "blasfeo/include/blasfeo_d_blas.h"
+// acados
+#include "acados/ocp_qp/ocp_qp_common.h"
+#include "acados/ocp_qp/ocp_qp_partitioned_ipm.h"
+#include "acados/utils/mem.h"
+#include "acados/utils/timing.h"
+#include "acados/utils/types.h"
+
+
+
+/************************************************
+ * helpers
+ ************************************************/
+
+static int ocp_qp_partitioned_ipm_num_segments(int N, ocp_qp_partitioned_ipm_opts *opts)
+{
+    int P = opts->num_segments;
+    if (P < 1) P = 1;
+    if (P > N + 1) P = N + 1;
+    return P;
+}
+
+
+
+// first stage of segment jj, the stages 0,...,N are distributed evenly
+static int ocp_qp_partitioned_ipm_seg_start(int N, int P, int jj)
+{
+    return (jj * (N + 1)) / P;
+}
+
+
+
+// soft constraints are not eliminated by the Newton system of this solver
+static void ocp_qp_partitioned_ipm_check_dims(ocp_qp_dims *dims)
+{
+    int ii;
+
+    for (ii = 0; ii <= dims->N; ii++)
+    {
+        if (dims->ns[ii] > 0)
+        {
+            printf("\nerror: ocp_qp_partitioned_ipm: soft constraints are not supported, "
+                   "got ns = %d at stage %d\n", dims->ns[ii], ii);
+            exit(1);
+        }
+    }
+}
+
+
+
+/************************************************
+ * opts
+ ************************************************/
+
+int ocp_qp_partitioned_ipm_opts_calculate_size(void *config_, void *dims_)
+{
+    int size = 0;
+    size += sizeof(ocp_qp_partitioned_ipm_opts);
+
+    return size;
+}
+
+
+
+void *ocp_qp_partitioned_ipm_opts_assign(void *config_, void *dims_, void *raw_memory)
+{
+    ocp_qp_partitioned_ipm_opts *opts;
+
+    char *c_ptr = (char *) raw_memory;
+
+    opts = (ocp_qp_partitioned_ipm_opts *) c_ptr;
+    c_ptr += sizeof(ocp_qp_partitioned_ipm_opts);
+
+    assert((char *) raw_memory + ocp_qp_partitioned_ipm_opts_calculate_size(config_, dims_) >= c_ptr);
+
+    return (void *) opts;
+}
+
+
+
+void ocp_qp_partitioned_ipm_opts_initialize_default(void *config_, void *dims_, void *opts_)
+{
+    ocp_qp_partitioned_ipm_opts *opts = opts_;
+
+    opts->mu0 = 1e0;
+    opts->alpha_min = 1e-8;
+    opts->res_g_max = 1e-6;
+    opts->res_b_max = 1e-8;
+    opts->res_d_max = 1e-8;
+    opts->res_m_max = 1e-8;
+    opts->iter_max = 50;
+    opts->warm_start = 0;
+#if defined(ACADOS_WITH_OPENMP)
+    opts->num_segments = ACADOS_NUM_THREADS;
+#else
+    opts->num_segments = 1;
+#endif
+
+    return;
+}
+
+
+
+void ocp_qp_partitioned_ipm_opts_update(void *config_, void *dims_, void *opts_)
+{
+    ocp_qp_partitioned_ipm_check_dims(dims_);
+
+    return;
+}
+
+
+
+void ocp_qp_partitioned_ipm_opts_set(void *config_, void *opts_, const char *field, void *value)
+{
+    ocp_qp_partitioned_ipm_opts *opts = opts_;
+
+    if (!strcmp(field, "iter_max"))
+    {
+        int *tmp_ptr = value;
+        opts->iter_max = *tmp_ptr;
+    }
+    else if (!strcmp(field, "mu0"))
+    {
+        double *tmp_ptr = value;
+        opts->mu0 = *tmp_ptr;
+    }
+    else if (!strcmp(field, "alpha_min"))
+    {
+        double *tmp_ptr = value;
+        opts->alpha_min = *tmp_ptr;
+    }
+    else if (!strcmp(field, "tol_stat"))
+    {
+        double *tmp_ptr = value;
+        opts->res_g_max = *tmp_ptr;
+    }
+    else if (!strcmp(field, "tol_eq"))
+    {
+        double *tmp_ptr = value;
+        opts->res_b_max = *tmp_ptr;
+    }
+    else if (!strcmp(field, "tol_ineq"))
+    {
+        double *tmp_ptr = value;
+        opts->res_d_max = *tmp_ptr;
+    }
+    else if (!strcmp(field, "tol_comp"))
+    {
+        double *tmp_ptr = value;
+        opts->res_m_max = *tmp_ptr;
+    }
+    else if (!strcmp(field, "warm_start"))
+    {
+        int *tmp_ptr = value;
+        opts->warm_start = *tmp_ptr;
+    }
+    else if (!strcmp(field, "num_segments"))
+    {
+        // NOTE: memory is allocated for the number of segments set at creation time
+        int *tmp_ptr = value;
+        opts->num_segments = *tmp_ptr;
+    }
+    else
+    {
+        printf("\nerror: ocp_qp_partitioned_ipm_opts_set: wrong field: %s\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+int ocp_qp_partitioned_ipm_memory_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    ocp_qp_dims *dims = dims_;
+    ocp_qp_partitioned_ipm_opts *opts = opts_;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *nb = dims->nb;
+    int *ng = dims->ng;
+
+    ocp_qp_partitioned_ipm_check_dims(dims);
+
+    int P = ocp_qp_partitioned_ipm_num_segments(N, opts);
+
+    int ii, jj;
+
+    int nxM = 0;
+    int nuM = 0;
+    int ngM = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        nxM = nx[ii] > nxM ? nx[ii] : nxM;
+        nuM = nu[ii] > nuM ? nu[ii] : nuM;
+        ngM = ng[ii] > ngM ? ng[ii] : ngM;
+    }
+    int nvM = nuM + nxM;
+    int nqM = nuM + 2 * nxM;
+
+    int size = 0;
+
+    size += sizeof(ocp_qp_partitioned_ipm_memory);
+
+    size += 16 * (N + 1) * sizeof(struct blasfeo_dvec);  // stage-wise
+    size += 1 * (N + 1) * sizeof(struct blasfeo_dmat);   // L
+    size += 1 * (N + 1 + P) * sizeof(struct blasfeo_dvec);  // Vv
+    size += 1 * (N + 1 + P) * sizeof(struct blasfeo_dmat);  // V
+    size += 6 * P * sizeof(struct blasfeo_dvec);         // segment-wise
+    size += 5 * P * sizeof(struct blasfeo_dmat);         // segment-wise
+    size += 1 * P * sizeof(int *);                       // M_ipiv
+
+    for (jj = 0; jj < P; jj++)
+    {
+        int s0 = ocp_qp_partitioned_ipm_seg_start(N, P, jj);
+        int s1 = ocp_qp_partitioned_ipm_seg_start(N, P, jj + 1);
+        int nl = jj < P - 1 ? nx[s1] : 0;
+
+        for (ii = s0; ii < s1; ii++)
+        {
+            int nv0 = nu[ii] + nx[ii];
+            int nx1 = ii < N ? nx[ii + 1] : 0;
+            int nc0 = nb[ii] + ng[ii];
+
+            size += 2 * blasfeo_memsize_dvec(nv0);        // v, dv
+            size += 2 * blasfeo_memsize_dvec(nx1);        // pi, dpi
+            size += 4 * blasfeo_memsize_dvec(2 * nc0);    // lam, t, dlam, dt
+            size += 1 * blasfeo_memsize_dvec(nv0);        // res_g
+            size += 1 * blasfeo_memsize_dvec(nx1);        // res_b
+            size += 2 * blasfeo_memsize_dvec(2 * nc0);    // res_d, res_m
+            size += 1 * blasfeo_memsize_dvec(nv0);        // g
+            size += 1 * blasfeo_memsize_dvec(nu[ii]);     // k
+            size += 2 * blasfeo_memsize_dvec(nc0);        // w, gc
+            size += 1 * blasfeo_memsize_dmat(nv0 + nl, nu[ii]);  // L
+            size += 1 * blasfeo_memsize_dmat(nx[ii] + nl, nx[ii] + nl);  // V
+            size += 1 * blasfeo_memsize_dvec(nx[ii] + nl);  // Vv
+        }
+        // terminal slot
+        size += 1 * blasfeo_memsize_dmat(2 * nl, 2 * nl);
+        size += 1 * blasfeo_memsize_dvec(2 * nl);
+
+        int nxs = nx[s0];
+        size += 1 * blasfeo_memsize_dmat(nxs, nxs);      // P_red
+        size += 1 * blasfeo_memsize_dvec(nxs);           // p_red
+        size += 1 * blasfeo_memsize_dmat(nl, nl);        // M_lu
+        size += 1 * blasfeo_memsize_dmat(nl, nxs);       // X_red
+        size += 1 * blasfeo_memsize_dvec(nl);            // x_red
+        size += 1 * blasfeo_memsize_dvec(nxs);           // x_seg
+        size += 1 * blasfeo_memsize_dvec(nl);            // l_seg
+        size += 1 * blasfeo_memsize_dmat(nqM, nqM);      // tmp_Q
+        size += 1 * blasfeo_memsize_dmat(nvM, nxM > ngM ? nxM : ngM);  // tmp_nv
+        size += 1 * blasfeo_memsize_dvec(nqM);           // tmp_q
+        size += 1 * blasfeo_memsize_dvec(2 * nxM);       // tmp_xl
+        size += nl * sizeof(int);                        // M_ipiv
+    }
+    size += blasfeo_memsize_dmat(nx[0], nx[0]);  // P0_lu
+
+    size += (P + 1) * sizeof(int);  // seg_start
+    size += nx[0] * sizeof(int);    // P0_ipiv
+
+    size += 1 * 8 + 64;
+    return size;
+}
+
+
+
+void *ocp_qp_partitioned_ipm_memory_assign(void *config_, void *dims_, void *opts_, void *raw_memory)
+{
+    ocp_qp_dims *dims = dims_;
+    ocp_qp_partitioned_ipm_opts *opts = opts_;
+    ocp_qp_partitioned_ipm_memory *mem;
+
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *nb = dims->nb;
+    int *ng = dims->ng;
+
+    int P = ocp_qp_partitioned_ipm_num_segments(N, opts);
+
+    int ii, jj;
+
+    int nxM = 0;
+    int nuM = 0;
+    int ngM = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        nxM = nx[ii] > nxM ? nx[ii] : nxM;
+        nuM = nu[ii] > nuM ? nu[ii] : nuM;
+        ngM = ng[ii] > ngM ? ng[ii] : ngM;
+    }
+    int nvM = nuM + nxM;
+    int nqM = nuM + 2 * nxM;
+
+    // char pointer
+    char *c_ptr = (char *) raw_memory;
+
+    mem = (ocp_qp_partitioned_ipm_memory *) c_ptr;
+    c_ptr += sizeof(ocp_qp_partitioned_ipm_memory);
+
+    mem->num_segments = P;
+
+    align_char_to(8, &c_ptr);
+
+    // stage-wise
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->v, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->pi, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->lam, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->t, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->dv, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->dpi, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->dlam, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->dt, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->res_g, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->res_b, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->res_d, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->res_m, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->g, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->k, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->w, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1, &mem->gc, &c_ptr);
+    assign_and_advance_blasfeo_dmat_structs(N + 1, &mem->L, &c_ptr);
+    // value function slots
+    assign_and_advance_blasfeo_dmat_structs(N + 1 + P, &mem->V, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(N + 1 + P, &mem->Vv, &c_ptr);
+    // segment-wise
+    assign_and_advance_blasfeo_dmat_structs(P, &mem->P_red, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(P, &mem->p_red, &c_ptr);
+    assign_and_advance_blasfeo_dmat_structs(P, &mem->M_lu, &c_ptr);
+    assign_and_advance_blasfeo_dmat_structs(P, &mem->X_red, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(P, &mem->x_red, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(P, &mem->x_seg, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(P, &mem->l_seg, &c_ptr);
+    assign_and_advance_blasfeo_dmat_structs(P, &mem->tmp_Q, &c_ptr);
+    assign_and_advance_blasfeo_dmat_structs(P, &mem->tmp_nv, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(P, &mem->tmp_q, &c_ptr);
+    assign_and_advance_blasfeo_dvec_structs(P, &mem->tmp_xl, &c_ptr);
+    assign_and_advance_int_ptrs(P, &mem->M_ipiv, &c_ptr);
+
+    align_char_to(64, &c_ptr);
+
+    for (jj = 0; jj < P; jj++)
+    {
+        int s0 = ocp_qp_partitioned_ipm_seg_start(N, P, jj);
+        int s1 = ocp_qp_partitioned_ipm_seg_start(N, P, jj + 1);
+        int nl = jj < P - 1 ? nx[s1] : 0;
+
+        for (ii = s0; ii < s1; ii++)
+        {
+            int nv0 = nu[ii] + nx[ii];
+            int nx1 = ii < N ? nx[ii + 1] : 0;
+            int nc0 = nb[ii] + ng[ii];
+
+            assign_and_advance_blasfeo_dvec_mem(nv0, mem->v + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nx1, mem->pi + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(2 * nc0, mem->lam + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(2 * nc0, mem->t + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nv0, mem->dv + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nx1, mem->dpi + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(2 * nc0, mem->dlam + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(2 * nc0, mem->dt + ii, &c_ptr);
+
+            assign_and_advance_blasfeo_dvec_mem(nv0, mem->res_g + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nx1, mem->res_b + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(2 * nc0, mem->res_d + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(2 * nc0, mem->res_m + ii, &c_ptr);
+
+            assign_and_advance_blasfeo_dvec_mem(nv0, mem->g + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nu[ii], mem->k + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nc0, mem->w + ii, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nc0, mem->gc + ii, &c_ptr);
+            assign_and_advance_blasfeo_dmat_mem(nv0 + nl, nu[ii], mem->L + ii, &c_ptr);
+
+            assign_and_advance_blasfeo_dmat_mem(nx[ii] + nl, nx[ii] + nl, mem->V + ii + jj, &c_ptr);
+            assign_and_advance_blasfeo_dvec_mem(nx[ii] + nl, mem->Vv + ii + jj, &c_ptr);
+        }
+        // terminal slot: V(x, l) = x^T l, with x the initial state of the next segment
+        assign_and_advance_blasfeo_dmat_mem(2 * nl, 2 * nl, mem->V + s1 + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(2 * nl, mem->Vv + s1 + jj, &c_ptr);
+        blasfeo_dgese(2 * nl, 2 * nl, 0.0, mem->V + s1 + jj, 0, 0);
+        for (ii = 0; ii < nl; ii++)
+        {
+            BLASFEO_DMATEL(mem->V + s1 + jj, nl + ii, ii) = 1.0;
+            BLASFEO_DMATEL(mem->V + s1 + jj, ii, nl + ii) = 1.0;
+        }
+        blasfeo_dvecse(2 * nl, 0.0, mem->Vv + s1 + jj, 0);
+
+        int nxs = nx[s0];
+        assign_and_advance_blasfeo_dmat_mem(nxs, nxs, mem->P_red + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nxs, mem->p_red + jj, &c_ptr);
+        assign_and_advance_blasfeo_dmat_mem(nl, nl, mem->M_lu + jj, &c_ptr);
+        assign_and_advance_blasfeo_dmat_mem(nl, nxs, mem->X_red + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nl, mem->x_red + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nxs, mem->x_seg + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nl, mem->l_seg + jj, &c_ptr);
+        assign_and_advance_blasfeo_dmat_mem(nqM, nqM, mem->tmp_Q + jj, &c_ptr);
+        assign_and_advance_blasfeo_dmat_mem(nvM, nxM > ngM ? nxM : ngM, mem->tmp_nv + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(nqM, mem->tmp_q + jj, &c_ptr);
+        assign_and_advance_blasfeo_dvec_mem(2 * nxM, mem->tmp_xl + jj, &c_ptr);
+    }
+    assign_and_advance_blasfeo_dmat_mem(nx[0], nx[0], &mem->P0_lu, &c_ptr);
+
+    // ints
+    assign_and_advance_int(P + 1, &mem->seg_start, &c_ptr);
+    for (jj = 0; jj <= P; jj++)
+        mem->seg_start[jj] = ocp_qp_partitioned_ipm_seg_start(N, P, jj);
+    for (jj = 0; jj < P; jj++)
+    {
+        int nl = jj < P - 1 ? nx[mem->seg_start[jj + 1]] : 0;
+        assign_and_advance_int(nl, &mem->M_ipiv[jj], &c_ptr);
+    }
+    assign_and_advance_int(nx[0], &mem->P0_ipiv, &c_ptr);
+
+    mem->iter = 0;
+    mem->time_qp_solver_call = 0.0;
+
+    assert((char *) raw_memory + ocp_qp_partitioned_ipm_memory_calculate_size(config_, dims, opts_) >= c_ptr);
+
+    return mem;
+}
+
+
+
+void ocp_qp_partitioned_ipm_memory_get(void *config_, void *mem_, const char *field, void* value)
+{
+    ocp_qp_partitioned_ipm_memory *mem = mem_;
+
+    if (!strcmp(field, "time_qp_solver_call"))
+    {
+        double *tmp_ptr = value;
+        *tmp_ptr = mem->time_qp_solver_call;
+    }
+    else if (!strcmp(field, "iter"))
+    {
+        int *tmp_ptr = value;
+        *tmp_ptr = mem->iter;
+    }
+    else
+    {
+        printf("\nerror: ocp_qp_partitioned_ipm_memory_get: field %s not available\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+/************************************************
+ * workspace
+ ************************************************/
+
+int ocp_qp_partitioned_ipm_workspace_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    return 0;
+}
+
+
+
+/************************************************
+ * stage-wise operations
+ ************************************************/
+
+// c = [D C] v, for the box and general constraints of stage ii
+static void ocp_qp_partitioned_ipm_eval_constr(ocp_qp_in *qp_in, int ii, struct blasfeo_dvec *v,
+                                                struct blasfeo_dvec *c)
+{
+    int nv0 = qp_in->dim->nu[ii] + qp_in->dim->nx[ii];
+    int nb0 = qp_in->dim->nb[ii];
+    int ng0 = qp_in->dim->ng[ii];
+
+    blasfeo_dvecex_sp(nb0, 1.0, qp_in->idxb[ii], v, 0, c, 0);
+    if (ng0 > 0)
+        blasfeo_dgemv_t(nv0, ng0, 1.0, qp_in->DCt + ii, 0, 0, v, 0, 0.0, c, nb0, c, nb0);
+}
+
+
+
+static void ocp_qp_partitioned_ipm_init_iterate(ocp_qp_in *qp_in, ocp_qp_out *qp_out,
+                               ocp_qp_partitioned_ipm_opts *opts, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    double thr = 1e0;
+
+    int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+        struct blasfeo_dvec *lam = mem->lam + ii;
+        struct blasfeo_dvec *t = mem->t + ii;
+        int jj;
+
+        if (opts->warm_start)
+            blasfeo_dveccp(nv0, qp_out->ux + ii, 0, mem->v + ii, 0);
+        else
+            blasfeo_dvecse(nv0, 0.0, mem->v + ii, 0);
+        blasfeo_dvecse(nx1, 0.0, mem->pi + ii, 0);
+
+        // slacks of the initial guess, bounded away from zero
+        ocp_qp_partitioned_ipm_eval_constr(qp_in, ii, mem->v + ii, t);
+        // upper bounds are stored with negative sign in hpipm
+        blasfeo_daxpby(nc0, -1.0, t, 0, -1.0, qp_in->d + ii, nc0, t, nc0);
+        blasfeo_daxpy(nc0, -1.0, qp_in->d + ii, 0, t, 0, t, 0);
+        for (jj = 0; jj < 2 * nc0; jj++)
+        {
+            BLASFEO_DVECEL(t, jj) = BLASFEO_DVECEL(t, jj) > thr ? BLASFEO_DVECEL(t, jj) : thr;
+            BLASFEO_DVECEL(lam, jj) = opts->mu0 / BLASFEO_DVECEL(t, jj);
+        }
+    }
+
+    return;
+}
+
+
+
+// residuals of the KKT conditions at the current iterate
+static void ocp_qp_partitioned_ipm_compute_res(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int ii, jj;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nu0 = nu[ii];
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nb0 = nb[ii];
+        int ng0 = ng[ii];
+        int nc0 = nb0 + ng0;
+        int *idxb = qp_in->idxb[ii];
+        struct blasfeo_dvec *v = mem->v + ii;
+        struct blasfeo_dvec *lam = mem->lam + ii;
+        struct blasfeo_dvec *res_g = mem->res_g + ii;
+        struct blasfeo_dvec *res_b = mem->res_b + ii;
+        struct blasfeo_dvec *res_d = mem->res_d + ii;
+
+        // stationarity
+        blasfeo_dsymv_l(nv0, nv0, 1.0, qp_in->RSQrq + ii, 0, 0, v, 0, 1.0, qp_in->rqz + ii, 0,
+                        res_g, 0);
+        if (ii < N)
+            blasfeo_dgemv_n(nv0, nx1, 1.0, qp_in->BAbt + ii, 0, 0, mem->pi + ii, 0, 1.0, res_g, 0,
+                            res_g, 0);
+        if (ii > 0)
+            blasfeo_daxpy(nx[ii], -1.0, mem->pi + ii - 1, 0, res_g, nu0, res_g, nu0);
+        blasfeo_dvecad_sp(nb0, -1.0, lam, 0, idxb, res_g, 0);
+        blasfeo_dvecad_sp(nb0, 1.0, lam, nc0, idxb, res_g, 0);
+        if (ng0 > 0)
+        {
+            blasfeo_dgemv_n(nv0, ng0, 1.0, qp_in->DCt + ii, 0, 0, lam, nc0 + nb0, 1.0, res_g, 0,
+                            res_g, 0);
+            blasfeo_dgemv_n(nv0, ng0, -1.0, qp_in->DCt + ii, 0, 0, lam, nb0, 1.0, res_g, 0,
+                            res_g, 0);
+        }
+
+        // dynamics
+        if (ii < N)
+        {
+            blasfeo_dgemv_t(nv0, nx1, 1.0, qp_in->BAbt + ii, 0, 0, v, 0, 1.0, qp_in->b + ii, 0,
+                            res_b, 0);
+            blasfeo_daxpy(nx1, -1.0, mem->v + ii + 1, nu[ii + 1], res_b, 0, res_b, 0);
+        }
+
+        // inequalities and complementarity
+        ocp_qp_partitioned_ipm_eval_constr(qp_in, ii, v, res_d);
+        blasfeo_daxpby(nc0, -1.0, res_d, 0, -1.0, qp_in->d + ii, nc0, res_d, nc0);
+        blasfeo_daxpy(nc0, -1.0, qp_in->d + ii, 0, res_d, 0, res_d, 0);
+        blasfeo_daxpy(2 * nc0, -1.0, mem->t + ii, 0, res_d, 0, res_d, 0);
+        blasfeo_dvecmul(2 * nc0, lam, 0, mem->t + ii, 0, mem->res_m + ii, 0);
+    }
+
+    // inf-norms and duality measure
+    double res_max[4] = {0.0, 0.0, 0.0, 0.0};
+    double res_tmp[4];
+    double mu = 0.0;
+    int nc_tot = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+
+        blasfeo_dvecnrm_inf(nv0, mem->res_g + ii, 0, &res_tmp[0]);
+        blasfeo_dvecnrm_inf(nx1, mem->res_b + ii, 0, &res_tmp[1]);
+        blasfeo_dvecnrm_inf(2 * nc0, mem->res_d + ii, 0, &res_tmp[2]);
+        blasfeo_dvecnrm_inf(2 * nc0, mem->res_m + ii, 0, &res_tmp[3]);
+        for (jj = 0; jj < 4; jj++)
+            res_max[jj] = fmax(res_max[jj], res_tmp[jj]);
+        for (jj = 0; jj < 2 * nc0; jj++)
+            mu += BLASFEO_DVECEL(mem->res_m + ii, jj);
+        nc_tot += 2 * nc0;
+    }
+    mu = nc_tot > 0 ? mu / nc_tot : 0.0;
+
+    for (jj = 0; jj < 4; jj++) mem->res_max[jj] = res_max[jj];
+    mem->mu = mu;
+
+    return;
+}
+
+
+
+// weights of the inequalities eliminated from the Newton system
+static void ocp_qp_partitioned_ipm_compute_hess(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nc0 = nb[ii] + ng[ii];
+        double *lam = mem->lam[ii].pa;
+        double *t = mem->t[ii].pa;
+        double *w = mem->w[ii].pa;
+        int jj;
+
+        for (jj = 0; jj < nc0; jj++)
+            w[jj] = lam[jj] / t[jj] + lam[nc0 + jj] / t[nc0 + jj];
+    }
+
+    return;
+}
+
+
+
+// gradient of the Newton system, for the current residuals res_g, res_d and res_m
+static void ocp_qp_partitioned_ipm_compute_grad(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nb0 = nb[ii];
+        int ng0 = ng[ii];
+        int nc0 = nb0 + ng0;
+        double *lam = mem->lam[ii].pa;
+        double *t = mem->t[ii].pa;
+        double *res_d = mem->res_d[ii].pa;
+        double *res_m = mem->res_m[ii].pa;
+        double *gc = mem->gc[ii].pa;
+        int jj;
+
+        for (jj = 0; jj < nc0; jj++)
+            gc[jj] = (res_m[jj] + lam[jj] * res_d[jj]) / t[jj]
+                   - (res_m[nc0 + jj] + lam[nc0 + jj] * res_d[nc0 + jj]) / t[nc0 + jj];
+
+        blasfeo_dveccp(nv0, mem->res_g + ii, 0, mem->g + ii, 0);
+        blasfeo_dvecad_sp(nb0, 1.0, mem->gc + ii, 0, qp_in->idxb[ii], mem->g + ii, 0);
+        if (ng0 > 0)
+            blasfeo_dgemv_n(nv0, ng0, 1.0, qp_in->DCt + ii, 0, 0, mem->gc + ii, nb0, 1.0,
+                            mem->g + ii, 0, mem->g + ii, 0);
+    }
+
+    return;
+}
+
+
+
+// recover the step in the inequality multipliers and slacks
+static void ocp_qp_partitioned_ipm_expand_step(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nc0 = nb[ii] + ng[ii];
+        double *lam = mem->lam[ii].pa;
+        double *t = mem->t[ii].pa;
+        double *dlam = mem->dlam[ii].pa;
+        double *dt = mem->dt[ii].pa;
+        double *res_m = mem->res_m[ii].pa;
+        int jj;
+
+        ocp_qp_partitioned_ipm_eval_constr(qp_in, ii, mem->dv + ii, mem->dt + ii);
+        blasfeo_daxpby(nc0, -1.0, mem->dt + ii, 0, 1.0, mem->res_d + ii, nc0, mem->dt + ii, nc0);
+        blasfeo_daxpy(nc0, 1.0, mem->res_d + ii, 0, mem->dt + ii, 0, mem->dt + ii, 0);
+        for (jj = 0; jj < 2 * nc0; jj++)
+            dlam[jj] = -(res_m[jj] + lam[jj] * dt[jj]) / t[jj];
+    }
+
+    return;
+}
+
+
+
+// largest step in (0, 1] keeping lam and t nonnegative
+static double ocp_qp_partitioned_ipm_step_length(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int N = qp_in->dim->N;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    double alpha = 1.0;
+
+    int ii, jj;
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nc0 = nb[ii] + ng[ii];
+        double *lam = mem->lam[ii].pa;
+        double *t = mem->t[ii].pa;
+        double *dlam = mem->dlam[ii].pa;
+        double *dt = mem->dt[ii].pa;
+
+        for (jj = 0; jj < 2 * nc0; jj++)
+        {
+            if (dlam[jj] < 0.0)
+                alpha = fmin(alpha, -lam[jj] / dlam[jj]);
+            if (dt[jj] < 0.0)
+                alpha = fmin(alpha, -t[jj] / dt[jj]);
+        }
+    }
+
+    return alpha;
+}
+
+
+
+/************************************************
+ * partitioned Riccati recursion
+ ************************************************/
+
+// backward factorization of segment jj, parametric in its coupling multiplier
+static void ocp_qp_partitioned_ipm_fact_segment(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem,
+                                                 int jj)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int P = mem->num_segments;
+    int s0 = mem->seg_start[jj];
+    int s1 = mem->seg_start[jj + 1];
+    int nl = jj < P - 1 ? nx[s1] : 0;
+
+    struct blasfeo_dmat *Q = mem->tmp_Q + jj;
+    struct blasfeo_dmat *tmp = mem->tmp_nv + jj;
+
+    int ii;
+
+    for (ii = s1 - 1; ii >= s0; ii--)
+    {
+        int nu0 = nu[ii];
+        int nx0 = nx[ii];
+        int nv0 = nu0 + nx0;
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nb0 = nb[ii];
+        int ng0 = ng[ii];
+        struct blasfeo_dmat *BAbt = qp_in->BAbt + ii;
+        // value function of the next stage, [x; l] ordering
+        struct blasfeo_dmat *V1 = mem->V + ii + 1 + jj;
+        // value function of this stage
+        struct blasfeo_dmat *V = mem->V + ii + jj;
+        struct blasfeo_dmat *L = mem->L + ii;
+
+        // Q = [RSQ + D^T W D + BA^T Vxx1 BA, *; Vlx1 BA, Vll1] (lower triangle)
+        blasfeo_dtrcp_l(nv0, qp_in->RSQrq + ii, 0, 0, Q, 0, 0);
+        blasfeo_ddiaad_sp(nb0, 1.0, mem->w + ii, 0, qp_in->idxb[ii], Q, 0, 0);
+        if (ng0 > 0)
+        {
+            blasfeo_dgemm_nd(nv0, ng0, 1.0, qp_in->DCt + ii, 0, 0, mem->w + ii, nb0, 0.0, tmp, 0, 0,
+                             tmp, 0, 0);
+            blasfeo_dsyrk_ln(nv0, ng0, 1.0, tmp, 0, 0, qp_in->DCt + ii, 0, 0, 1.0, Q, 0, 0, Q, 0, 0);
+        }
+        if (ii < N)
+        {
+            blasfeo_dgemm_nn(nv0, nx1, nx1, 1.0, BAbt, 0, 0, V1, 0, 0, 0.0, tmp, 0, 0, tmp, 0, 0);
+            blasfeo_dsyrk_ln(nv0, nx1, 1.0, tmp, 0, 0, BAbt, 0, 0, 1.0, Q, 0, 0, Q, 0, 0);
+            if (nl > 0)
+            {
+                blasfeo_dgemm_nt(nl, nv0, nx1, 1.0, V1, nx1, 0, BAbt, 0, 0, 0.0, Q, nv0, 0, Q, nv0, 0);
+                blasfeo_dtrcp_l(nl, V1, nx1, nx1, Q, nv0, nv0);
+            }
+        }
+
+        // [L; K^T], with L L^T = Q_uu and K = L^{-1} [Q_ux Q_ul]
+        if (nu0 > 0)
+            blasfeo_dpotrf_l_mn(nv0 + nl, nu0, Q, 0, 0, L, 0, 0);
+
+        // Schur complement w.r.t. u
+        blasfeo_dtrcp_l(nx0 + nl, Q, nu0, nu0, V, 0, 0);
+        if (nu0 > 0)
+            blasfeo_dsyrk_ln(nx0 + nl, nu0, -1.0, L, nu0, 0, L, nu0, 0, 1.0, V, 0, 0, V, 0, 0);
+        blasfeo_dtrtr_l(nx0 + nl, V, 0, 0, V, 0, 0);
+    }
+
+    return;
+}
+
+
+
+// backward substitution of segment jj, for the gradient g and the dynamics residual res_b
+static void ocp_qp_partitioned_ipm_solve_segment_backward(ocp_qp_in *qp_in,
+                                                           ocp_qp_partitioned_ipm_memory *mem, int jj)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+
+    int P = mem->num_segments;
+    int s0 = mem->seg_start[jj];
+    int s1 = mem->seg_start[jj + 1];
+    int nl = jj < P - 1 ? nx[s1] : 0;
+
+    struct blasfeo_dvec *q = mem->tmp_q + jj;
+    struct blasfeo_dvec *tmp = mem->tmp_xl + jj;
+
+    int ii;
+
+    for (ii = s1 - 1; ii >= s0; ii--)
+    {
+        int nu0 = nu[ii];
+        int nx0 = nx[ii];
+        int nv0 = nu0 + nx0;
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        struct blasfeo_dvec *bb = mem->res_b + ii;
+        struct blasfeo_dmat *V1 = mem->V + ii + 1 + jj;
+        struct blasfeo_dvec *Vv1 = mem->Vv + ii + 1 + jj;
+        struct blasfeo_dmat *L = mem->L + ii;
+
+        // q = [g + BA^T (Vxx1 b + Vx1); Vlx1 b + Vl1]
+        blasfeo_dveccp(nv0, mem->g + ii, 0, q, 0);
+        if (ii < N)
+        {
+            blasfeo_dgemv_n(nx1, nx1, 1.0, V1, 0, 0, bb, 0, 1.0, Vv1, 0, tmp, 0);
+            blasfeo_dgemv_n(nv0, nx1, 1.0, qp_in->BAbt + ii, 0, 0, tmp, 0, 1.0, q, 0, q, 0);
+            if (nl > 0)
+                blasfeo_dgemv_n(nl, nx1, 1.0, V1, nx1, 0, bb, 0, 1.0, Vv1, nx1, q, nv0);
+        }
+
+        // k = L^{-1} q_u, Vv = q_xl - K^T k
+        if (nu0 > 0)
+        {
+            blasfeo_dtrsv_lnn(nu0, L, 0, 0, q, 0, mem->k + ii, 0);
+            blasfeo_dgemv_n(nx0 + nl, nu0, -1.0, L, nu0, 0, mem->k + ii, 0, 1.0, q, nu0,
+                            mem->Vv + ii + jj, 0);
+        }
+        else
+        {
+            blasfeo_dveccp(nx0 + nl, q, nu0, mem->Vv + ii + jj, 0);
+        }
+    }
+
+    return;
+}
+
+
+
+// forward substitution of segment jj, for given initial state and coupling multiplier
+static void ocp_qp_partitioned_ipm_solve_segment_forward(ocp_qp_in *qp_in,
+                                                          ocp_qp_partitioned_ipm_memory *mem, int jj)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+
+    int P = mem->num_segments;
+    int s0 = mem->seg_start[jj];
+    int s1 = mem->seg_start[jj + 1];
+    int nl = jj < P - 1 ? nx[s1] : 0;
+    struct blasfeo_dvec *l = mem->l_seg + jj;
+    struct blasfeo_dvec *xl = mem->tmp_xl + jj;
+
+    int ii;
+
+    blasfeo_dveccp(nx[s0], mem->x_seg + jj, 0, mem->dv + s0, nu[s0]);
+
+    for (ii = s0; ii < s1; ii++)
+    {
+        int nu0 = nu[ii];
+        int nx0 = nx[ii];
+        int nv0 = nu0 + nx0;
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        struct blasfeo_dvec *dv = mem->dv + ii;
+        struct blasfeo_dmat *L = mem->L + ii;
+
+        // u = - L^{-T} (K [x; l] + k)
+        if (nu0 > 0)
+        {
+            blasfeo_dveccp(nx0, dv, nu0, xl, 0);
+            blasfeo_dveccp(nl, l, 0, xl, nx0);
+            blasfeo_dgemv_t(nx0 + nl, nu0, 1.0, L, nu0, 0, xl, 0, 1.0, mem->k + ii, 0, dv, 0);
+            blasfeo_dtrsv_ltn(nu0, L, 0, 0, dv, 0, dv, 0);
+            blasfeo_dvecsc(nu0, -1.0, dv, 0);
+        }
+
+        if (ii == s1 - 1)
+        {
+            // the next state belongs to the next segment, the multiplier is the coupling one
+            blasfeo_dveccp(nx1, l, 0, mem->dpi + ii, 0);
+        }
+        else
+        {
+            struct blasfeo_dvec *dv1 = mem->dv + ii + 1;
+
+            // x1 = BA v + b, pi = [Vxx1 Vxl1] [x1; l] + Vx1
+            blasfeo_dgemv_t(nv0, nx1, 1.0, qp_in->BAbt + ii, 0, 0, dv, 0, 1.0, mem->res_b + ii, 0,
+                            dv1, nu[ii + 1]);
+            blasfeo_dveccp(nx1, dv1, nu[ii + 1], xl, 0);
+            blasfeo_dveccp(nl, l, 0, xl, nx1);
+            blasfeo_dgemv_n(nx1, nx1 + nl, 1.0, mem->V + ii + 1 + jj, 0, 0, xl, 0, 1.0,
+                            mem->Vv + ii + 1 + jj, 0, mem->dpi + ii, 0);
+        }
+    }
+
+    return;
+}
+
+
+
+// factorization of the reduced system in the segment initial states and coupling multipliers
+static void ocp_qp_partitioned_ipm_fact_reduced(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int *nx = qp_in->dim->nx;
+
+    int P = mem->num_segments;
+    int *seg_start = mem->seg_start;
+
+    int jj;
+
+    int s0 = seg_start[P - 1];
+    int nxs = nx[s0];
+    blasfeo_dgecp(nxs, nxs, mem->V + s0 + P - 1, 0, 0, mem->P_red + P - 1, 0, 0);
+
+    for (jj = P - 2; jj >= 0; jj--)
+    {
+        s0 = seg_start[jj];
+        nxs = nx[s0];
+        int nl = nx[seg_start[jj + 1]];
+        // [Vxx F; F^T Vll] value function of the segment initial stage
+        struct blasfeo_dmat *Vs = mem->V + s0 + jj;
+        struct blasfeo_dmat *P1 = mem->P_red + jj + 1;
+        struct blasfeo_dmat *M = mem->M_lu + jj;
+        struct blasfeo_dmat *X = mem->X_red + jj;
+        struct blasfeo_dmat *tmp = mem->tmp_Q + jj;
+
+        // M = I + W P1, with W = - Vll
+        blasfeo_dgemm_nn(nl, nl, nl, -1.0, Vs, nxs, nxs, P1, 0, 0, 0.0, M, 0, 0, M, 0, 0);
+        blasfeo_ddiare(nl, 1.0, M, 0, 0);
+        blasfeo_dgetrf_rp(nl, nl, M, 0, 0, M, 0, 0, mem->M_ipiv[jj]);
+
+        // X = M^{-1} F^T
+        blasfeo_dgecp(nl, nxs, Vs, nxs, 0, X, 0, 0);
+        blasfeo_drowpe(nl, mem->M_ipiv[jj], X);
+        blasfeo_dtrsm_llnu(nl, nxs, 1.0, M, 0, 0, X, 0, 0, X, 0, 0);
+        blasfeo_dtrsm_lunn(nl, nxs, 1.0, M, 0, 0, X, 0, 0, X, 0, 0);
+
+        // P = Vxx + F P1 X
+        blasfeo_dgemm_nn(nl, nxs, nl, 1.0, P1, 0, 0, X, 0, 0, 0.0, tmp, 0, 0, tmp, 0, 0);
+        blasfeo_dgemm_nn(nxs, nxs, nl, 1.0, Vs, 0, nxs, tmp, 0, 0, 1.0, Vs, 0, 0, mem->P_red + jj, 0, 0);
+        blasfeo_dtrtr_l(nxs, mem->P_red + jj, 0, 0, mem->P_red + jj, 0, 0);
+    }
+
+    // initial state
+    blasfeo_dgecp(nx[0], nx[0], mem->P_red, 0, 0, &mem->P0_lu, 0, 0);
+    blasfeo_dgetrf_rp(nx[0], nx[0], &mem->P0_lu, 0, 0, &mem->P0_lu, 0, 0, mem->P0_ipiv);
+
+    return;
+}
+
+
+
+static void ocp_qp_partitioned_ipm_solve_reduced(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int *nx = qp_in->dim->nx;
+
+    int P = mem->num_segments;
+    int *seg_start = mem->seg_start;
+
+    int jj;
+
+    // backward
+    int s0 = seg_start[P - 1];
+    int nxs = nx[s0];
+    blasfeo_dveccp(nxs, mem->Vv + s0 + P - 1, 0, mem->p_red + P - 1, 0);
+
+    for (jj = P - 2; jj >= 0; jj--)
+    {
+        s0 = seg_start[jj];
+        nxs = nx[s0];
+        int nl = nx[seg_start[jj + 1]];
+        struct blasfeo_dmat *Vs = mem->V + s0 + jj;
+        struct blasfeo_dvec *Vvs = mem->Vv + s0 + jj;
+        struct blasfeo_dmat *M = mem->M_lu + jj;
+        struct blasfeo_dvec *p1 = mem->p_red + jj + 1;
+        struct blasfeo_dvec *xr = mem->x_red + jj;
+        struct blasfeo_dvec *tmp = mem->tmp_q + jj;
+
+        // xr = M^{-1} (w - W p1)
+        blasfeo_dgemv_n(nl, nl, 1.0, Vs, nxs, nxs, p1, 0, 1.0, Vvs, nxs, xr, 0);
+        blasfeo_dvecpe(nl, mem->M_ipiv[jj], xr, 0);
+        blasfeo_dtrsv_lnu(nl, M, 0, 0, xr, 0, xr, 0);
+        blasfeo_dtrsv_unn(nl, M, 0, 0, xr, 0, xr, 0);
+
+        // p = Vx1 + F (P1 xr + p1)
+        blasfeo_dgemv_n(nl, nl, 1.0, mem->P_red + jj + 1, 0, 0, xr, 0, 1.0, p1, 0, tmp, 0);
+        blasfeo_dgemv_n(nxs, nl, 1.0, Vs, 0, nxs, tmp, 0, 1.0, Vvs, 0, mem->p_red + jj, 0);
+    }
+
+    // forward
+    blasfeo_dveccpsc(nx[0], -1.0, mem->p_red, 0, mem->x_seg, 0);
+    blasfeo_dvecpe(nx[0], mem->P0_ipiv, mem->x_seg, 0);
+    blasfeo_dtrsv_lnu(nx[0], &mem->P0_lu, 0, 0, mem->x_seg, 0, mem->x_seg, 0);
+    blasfeo_dtrsv_unn(nx[0], &mem->P0_lu, 0, 0, mem->x_seg, 0, mem->x_seg, 0);
+
+    for (jj = 0; jj < P - 1; jj++)
+    {
+        nxs = nx[seg_start[jj]];
+        int nl = nx[seg_start[jj + 1]];
+
+        // x1 = xr + X x0, l = P1 x1 + p1
+        blasfeo_dgemv_n(nl, nxs, 1.0, mem->X_red + jj, 0, 0, mem->x_seg + jj, 0, 1.0,
+                        mem->x_red + jj, 0, mem->x_seg + jj + 1, 0);
+        blasfeo_dgemv_n(nl, nl, 1.0, mem->P_red + jj + 1, 0, 0, mem->x_seg + jj + 1, 0, 1.0,
+                        mem->p_red + jj + 1, 0, mem->l_seg + jj, 0);
+    }
+
+    return;
+}
+
+
+
+// factorize the Newton system for the current Hessian
+static void ocp_qp_partitioned_ipm_fact(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int jj;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (jj = 0; jj < mem->num_segments; jj++)
+        ocp_qp_partitioned_ipm_fact_segment(qp_in, mem, jj);
+
+    ocp_qp_partitioned_ipm_fact_reduced(qp_in, mem);
+
+    return;
+}
+
+
+
+// solve the factorized Newton system for the current gradient and dynamics residual
+static void ocp_qp_partitioned_ipm_solve(ocp_qp_in *qp_in, ocp_qp_partitioned_ipm_memory *mem)
+{
+    int jj;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (jj = 0; jj < mem->num_segments; jj++)
+        ocp_qp_partitioned_ipm_solve_segment_backward(qp_in, mem, jj);
+
+    ocp_qp_partitioned_ipm_solve_reduced(qp_in, mem);
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (jj = 0; jj < mem->num_segments; jj++)
+        ocp_qp_partitioned_ipm_solve_segment_forward(qp_in, mem, jj);
+
+    ocp_qp_partitioned_ipm_expand_step(qp_in, mem);
+
+    return;
+}
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+int ocp_qp_partitioned_ipm(void *config_, void *qp_in_, void *qp_out_, void *opts_, void *mem_, void *work_)
+{
+    ocp_qp_in *qp_in = qp_in_;
+    ocp_qp_out *qp_out = qp_out_;
+
+    qp_info *info = qp_out->misc;
+    acados_timer tot_timer, qp_timer;
+
+    acados_tic(&tot_timer);
+    // cast data structures
+    ocp_qp_partitioned_ipm_opts *opts = opts_;
+    ocp_qp_partitioned_ipm_memory *mem = mem_;
+
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+
+    int ii, jj;
+
+    // number of segments is fixed at memory creation
+    assert(mem->num_segments == ocp_qp_partitioned_ipm_num_segments(N, opts) &&
+           "num_segments changed after memory creation!");
+
+    // the qp data is used in the hpipm format, no interface conversion
+    info->interface_time = 0.0;
+
+    // solve ipm
+    acados_tic(&qp_timer);
+
+    int nc_tot = 0;
+    for (ii = 0; ii <= N; ii++)
+        nc_tot += nb[ii] + ng[ii];
+
+    ocp_qp_partitioned_ipm_init_iterate(qp_in, qp_out, opts, mem);
+
+    int acados_status = ACADOS_MAXITER;
+    int iter;
+    double alpha, mu_aff, sigma;
+
+    for (iter = 0; ; iter++)
+    {
+        ocp_qp_partitioned_ipm_compute_res(qp_in, mem);
+
+        if (mem->res_max[0] <= opts->res_g_max && mem->res_max[1] <= opts->res_b_max &&
+            mem->res_max[2] <= opts->res_d_max && mem->res_max[3] <= opts->res_m_max)
+        {
+            acados_status = ACADOS_SUCCESS;
+            break;
+        }
+        if (iter >= opts->iter_max)
+        {
+            acados_status = ACADOS_MAXITER;
+            break;
+        }
+
+        ocp_qp_partitioned_ipm_compute_hess(qp_in, mem);
+        ocp_qp_partitioned_ipm_fact(qp_in, mem);
+
+        // affine scaling (predictor) step
+        ocp_qp_partitioned_ipm_compute_grad(qp_in, mem);
+        ocp_qp_partitioned_ipm_solve(qp_in, mem);
+        alpha = ocp_qp_partitioned_ipm_step_length(qp_in, mem);
+
+        if (nc_tot > 0)
+        {
+            // centering and Mehrotra corrector step
+            mu_aff = 0.0;
+            for (ii = 0; ii <= N; ii++)
+            {
+                for (jj = 0; jj < 2 * (nb[ii] + ng[ii]); jj++)
+                    mu_aff += (BLASFEO_DVECEL(mem->lam + ii, jj) + alpha * BLASFEO_DVECEL(mem->dlam + ii, jj)) *
+                              (BLASFEO_DVECEL(mem->t + ii, jj) + alpha * BLASFEO_DVECEL(mem->dt + ii, jj));
+            }
+            mu_aff /= 2 * nc_tot;
+            sigma = mu_aff / mem->mu;
+            sigma = sigma * sigma * sigma;
+
+            for (ii = 0; ii <= N; ii++)
+            {
+                int nc0 = nb[ii] + ng[ii];
+                blasfeo_dvecmulacc(2 * nc0, mem->dlam + ii, 0, mem->dt + ii, 0, mem->res_m + ii, 0);
+                for (jj = 0; jj < 2 * nc0; jj++)
+                    BLASFEO_DVECEL(mem->res_m + ii, jj) -= sigma * mem->mu;
+            }
+            ocp_qp_partitioned_ipm_compute_grad(qp_in, mem);
+            ocp_qp_partitioned_ipm_solve(qp_in, mem);
+            alpha = ocp_qp_partitioned_ipm_step_length(qp_in, mem);
+            alpha = fmin(1.0, 0.995 * alpha);
+        }
+
+        if (alpha < opts->alpha_min)
+        {
+            acados_status = ACADOS_MINSTEP;
+            break;
+        }
+
+#if defined(ACADOS_WITH_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (ii = 0; ii <= N; ii++)
+        {
+            int nv0 = nu[ii] + nx[ii];
+            int nx1 = ii < N ? nx[ii + 1] : 0;
+            int nc0 = nb[ii] + ng[ii];
+            blasfeo_daxpy(nv0, alpha, mem->dv + ii, 0, mem->v + ii, 0, mem->v + ii, 0);
+            blasfeo_daxpy(nx1, alpha, mem->dpi + ii, 0, mem->pi + ii, 0, mem->pi + ii, 0);
+            blasfeo_daxpy(2 * nc0, alpha, mem->dlam + ii, 0, mem->lam + ii, 0, mem->lam + ii, 0);
+            blasfeo_daxpy(2 * nc0, alpha, mem->dt + ii, 0, mem->t + ii, 0, mem->t + ii, 0);
+        }
+    }
+
+    // copy solution
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+        blasfeo_dveccp(nv0, mem->v + ii, 0, qp_out->ux + ii, 0);
+        blasfeo_dveccp(nx1, mem->pi + ii, 0, qp_out->pi + ii, 0);
+        blasfeo_dveccp(2 * nc0, mem->lam + ii, 0, qp_out->lam + ii, 0);
+        blasfeo_dveccp(2 * nc0, mem->t + ii, 0, qp_out->t + ii, 0);
+    }
+
+    info->solve_QP_time = acados_toc(&qp_timer);
+    info->total_time = acados_toc(&tot_timer);
+    info->num_iter = iter;
+    info->t_computed = 1;
+
+    mem->time_qp_solver_call = info->solve_QP_time;
+    mem->iter = iter;
+
+    return acados_status;
+}
+
+
+
+void ocp_qp_partitioned_ipm_eval_sens(void *config_, void *param_qp_in_, void *sens_qp_out_, void *opts_, void *mem_, void *work_)
+{
+    ocp_qp_in *param_qp_in = param_qp_in_;
+    ocp_qp_out *sens_qp_out = sens_qp_out_;
+
+    ocp_qp_partitioned_ipm_memory *mem = mem_;
+
+    int N = param_qp_in->dim->N;
+    int *nx = param_qp_in->dim->nx;
+    int *nu = param_qp_in->dim->nu;
+    int *nb = param_qp_in->dim->nb;
+    int *ng = param_qp_in->dim->ng;
+
+    int ii;
+
+    // the factorization of the last iteration is reused, the parametric qp provides the rhs
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+        blasfeo_dveccp(nv0, param_qp_in->rqz + ii, 0, mem->res_g + ii, 0);
+        blasfeo_dveccp(nx1, param_qp_in->b + ii, 0, mem->res_b + ii, 0);
+        blasfeo_dveccpsc(2 * nc0, -1.0, param_qp_in->d + ii, 0, mem->res_d + ii, 0);
+        blasfeo_dveccp(2 * nc0, param_qp_in->m + ii, 0, mem->res_m + ii, 0);
+    }
+
+    ocp_qp_partitioned_ipm_compute_grad(param_qp_in, mem);
+    ocp_qp_partitioned_ipm_solve(param_qp_in, mem);
+
+    for (ii = 0; ii <= N; ii++)
+    {
+        int nv0 = nu[ii] + nx[ii];
+        int nx1 = ii < N ? nx[ii + 1] : 0;
+        int nc0 = nb[ii] + ng[ii];
+        blasfeo_dveccp(nv0, mem->dv + ii, 0, sens_qp_out->ux + ii, 0);
+        blasfeo_dveccp(nx1, mem->dpi + ii, 0, sens_qp_out->pi + ii, 0);
+        blasfeo_dveccp(2 * nc0, mem->dlam + ii, 0, sens_qp_out->lam + ii, 0);
+        blasfeo_dveccp(2 * nc0, mem->dt + ii, 0, sens_qp_out->t + ii, 0);
+    }
+
+    return;
+}
+
+
+
+void ocp_qp_partitioned_ipm_config_initialize_default(void *config_)
+{
+    qp_solver_config *config = config_;
+
+    config->dims_set = &ocp_qp_dims_set;
+    config->opts_calculate_size = &ocp_qp_partitioned_ipm_opts_calculate_size;
+    config->opts_assign = &ocp_qp_partitioned_ipm_opts_assign;
+    config->opts_initialize_default = &ocp_qp_partitioned_ipm_opts_initialize_default;
+    config->opts_update = &ocp_qp_partitioned_ipm_opts_update;
+    config->opts_set = &ocp_qp_partitioned_ipm_opts_set;
+    config->memory_calculate_size = &ocp_qp_partitioned_ipm_memory_calculate_size;
+    config->memory_assign = &ocp_qp_partitioned_ipm_memory_assign;
+    config->memory_get = &ocp_qp_partitioned_ipm_memory_get;
+    config->workspace_calculate_size = &ocp_qp_partitioned_ipm_workspace_calculate_size;
+    config->evaluate = &ocp_qp_partitioned_ipm;
+    config->eval_sens = &ocp_qp_partitioned_ipm_eval_sens;
+
+    return;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+#ifndef ACADOS_OCP_QP_OCP_QP_PARTITIONED_IPM_H_
+#define ACADOS_OCP_QP_OCP_QP_PARTITIONED_IPM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// acados
+#include "acados/ocp_qp/ocp_qp_common.h"
+#include "acados/utils/types.h"
+
+
+
+// Primal-dual interior point method for ocp qps, where the Newton system of each iteration is
+// solved by Schur-complement partitioning of the horizon: the stages are split into
+// num_segments segments which are factorized and solved concurrently (parametric in the
+// coupling variables), and only a small block tridiagonal system with one block per segment
+// is solved serially.
+typedef struct ocp_qp_partitioned_ipm_opts_
+{
+    double mu0;        // initial value for complementarity slackness
+    double alpha_min;  // exit if step length gets smaller
+    double res_g_max;  // exit tolerance on stationarity
+    double res_b_max;  // exit tolerance on equality constraints
+    double res_d_max;  // exit tolerance on inequality constraints
+    double res_m_max;  // exit tolerance on complementarity slackness
+    int iter_max;
+    int warm_start;    // 0: cold start, 1: primal warm start from qp_out
+    int num_segments;  // number of horizon segments (solved in parallel with ACADOS_WITH_OPENMP)
+} ocp_qp_partitioned_ipm_opts;
+
+
+
+typedef struct ocp_qp_partitioned_ipm_memory_
+{
+    // horizon partition
+    int num_segments;
+    int *seg_start;   // first stage of each segment (plus N+1 at the end)
+
+    // iterate and Newton step
+    struct blasfeo_dvec *v;
+    struct blasfeo_dvec *pi;
+    struct blasfeo_dvec *lam;     // [lam_lb; lam_ub]
+    struct blasfeo_dvec *t;       // [t_lb; t_ub]
+    struct blasfeo_dvec *dv;
+    struct blasfeo_dvec *dpi;
+    struct blasfeo_dvec *dlam;
+    struct blasfeo_dvec *dt;
+
+    // residuals
+    struct blasfeo_dvec *res_g;
+    struct blasfeo_dvec *res_b;
+    struct blasfeo_dvec *res_d;
+    struct blasfeo_dvec *res_m;
+
+    // Newton system and its stage-wise factorization
+    struct blasfeo_dvec *g;
+    struct blasfeo_dvec *w;       // weights of the eliminated inequalities
+    struct blasfeo_dvec *gc;      // gradient contribution of the eliminated inequalities
+    struct blasfeo_dmat *L;       // [L; K^T], L L^T = Q_uu and K = L^{-1} [Q_ux Q_ul]
+    struct blasfeo_dvec *k;       // L^{-1} q_u
+
+    // value function, parametric in the coupling multiplier of the segment (one slot per
+    // stage, plus one terminal slot per segment)
+    struct blasfeo_dmat *V;       // [Vxx Vxl; Vlx Vll]
+    struct blasfeo_dvec *Vv;      // [Vx1; Vl1]
+
+    // reduced system (one block per segment)
+    struct blasfeo_dmat *P_red;
+    struct blasfeo_dvec *p_red;
+    struct blasfeo_dmat *M_lu;    // LU factorization of I + W P_red_next
+    int **M_ipiv;
+    struct blasfeo_dmat *X_red;   // M^{-1} F^T
+    struct blasfeo_dvec *x_red;   // M^{-1} (w - W p_red_next)
+    struct blasfeo_dvec *x_seg;   // initial state of the segment
+    struct blasfeo_dvec *l_seg;   // coupling multiplier at the end of the segment
+    struct blasfeo_dmat P0_lu;
+    int *P0_ipiv;
+
+    // per-segment temporaries
+    struct blasfeo_dmat *tmp_Q;
+    struct blasfeo_dmat *tmp_nv;
+    struct blasfeo_dvec *tmp_q;
+    struct blasfeo_dvec *tmp_xl;
+
+    double res_max[4];
+    double mu;
+    double time_qp_solver_call;
+    int iter;
+
+} ocp_qp_partitioned_ipm_memory;
+
+
+
+//
+int ocp_qp_partitioned_ipm_opts_calculate_size(void *config, void *dims);
+//
+void *ocp_qp_partitioned_ipm_opts_assign(void *config, void *dims, void *raw_memory);
+//
+void ocp_qp_partitioned_ipm_opts_initialize_default(void *config, void *dims, void *opts_);
+//
+void ocp_qp_partitioned_ipm_opts_update(void *config, void *dims, void *opts_);
+//
+void ocp_qp_partitioned_ipm_opts_set(void *config_, void *opts_, const char *field, void *value);
+//
+int ocp_qp_partitioned_ipm_memory_calculate_size(void *config, void *dims, void *opts_);
+//
+void *ocp_qp_partitioned_ipm_memory_assign(void *config, void *dims, void *opts_, void *raw_memory);
+//
+void ocp_qp_partitioned_ipm_memory_get(void *config_, void *mem_, const char *field, void* value);
+//
+int ocp_qp_partitioned_ipm_workspace_calculate_size(void *config, void *dims, void *opts_);
+//
+int ocp_qp_partitioned_ipm(void *config, void *qp_in, void *qp_out, void *opts_, void *mem_, void *work_);
+//
+void ocp_qp_partitioned_ipm_eval_sens(void *config, void *qp_in, void *qp_out, void *opts_, void *mem_, void *work_);
+//
+void ocp_qp_partitioned_ipm_config_initialize_default(void *config);
+
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // ACADOS_OCP_QP_OCP_QP_PARTITIONED_IPM_H_
@@ -163,6 +163,8 @@ int ocp_qp_xcond_solver_opts_calculate_size(void *config_, ocp_qp_xcond_solver_d
 
     size += qp_solver->opts_calculate_size(qp_solver, xcond_qp_dims);
 
+    size += sizeof(ocp_qp_as_cache_opts);
+
     return size;
 }
 
@@ -192,6 +194,9 @@ void *ocp_qp_xcond_solver_opts_assign(void *config_, ocp_qp_xcond_solver_dims *d
     opts->qp_solver_opts = qp_solver->opts_assign(qp_solver, xcond_qp_dims, c_ptr);
     c_ptr += qp_solver->opts_calculate_size(qp_solver, xcond_qp_dims);
 
+    opts->as_cache_opts = (ocp_qp_as_cache_opts *) c_ptr;
+    c_ptr += sizeof(ocp_qp_as_cache_opts);
+
     assert((char *) raw_memory + ocp_qp_xcond_solver_opts_calculate_size(config_, dims) == c_ptr);
 
     return (void *) opts;
@@ -214,6 +219,8 @@ void ocp_qp_xcond_solver_opts_initialize_default(void *config_, ocp_qp_xcond_sol
     xcond->opts_initialize_default(dims->xcond_dims, opts->xcond_opts);
     // qp solver opts
     qp_solver->opts_initialize_default(qp_solver, xcond_qp_dims, opts->qp_solver_opts);
+    // active set cache opts
+    ocp_qp_as_cache_opts_initialize_default(opts->as_cache_opts);
 }
 
 
@@ -265,6 +272,10 @@ void ocp_qp_xcond_solver_opts_set(void *config_, void *opts_, const char *field,
 	{
 		xcond->opts_set(opts->xcond_opts, field+module_length+1, value);
 	}
+	else if( ptr_module!=NULL && (!strcmp(ptr_module, "as")) ) // pass options to active set cache
+	{
+		ocp_qp_as_cache_opts_set(opts->as_cache_opts, field+module_length+1, value);
+	}
 	else // pass options to QP module
 	{
 		qp_solver->opts_set(qp_solver, opts->qp_solver_opts, field, value);
@@ -299,6 +310,8 @@ int ocp_qp_xcond_solver_memory_calculate_size(void *config_, ocp_qp_xcond_solver
 
     size += qp_solver->memory_calculate_size(qp_solver, xcond_qp_dims, opts->qp_solver_opts);
 
+    size += ocp_qp_as_cache_memory_calculate_size(dims->orig_dims, opts->as_cache_opts);
+
     return size;
 }
 
@@ -332,6 +345,10 @@ void *ocp_qp_xcond_solver_memory_assign(void *config_, ocp_qp_xcond_solver_dims
     mem->solver_memory = qp_solver->memory_assign(qp_solver, xcond_qp_dims, opts->qp_solver_opts, c_ptr);
     c_ptr += qp_solver->memory_calculate_size(qp_solver, xcond_qp_dims, opts->qp_solver_opts);
 
+    mem->as_cache_memory = ocp_qp_as_cache_memory_assign(dims->orig_dims, opts->as_cache_opts, c_ptr);
+    c_ptr += ocp_qp_as_cache_memory_calculate_size(dims->orig_dims, opts->as_cache_opts);
+    mem->as_qp_in = NULL;
+
 	xcond->memory_get(xcond, mem->xcond_memory, "xcond_qp_in", &mem->xcond_qp_in);
 	xcond->memory_get(xcond, mem->xcond_memory, "xcond_qp_out", &mem->xcond_qp_out);
 
@@ -360,6 +377,10 @@ void ocp_qp_xcond_solver_memory_get(void *config_, void *mem_, const char *field
 	{
 		qp_solver->memory_get(qp_solver, mem->solver_memory, field, value);
 	}
+	else if (!strncmp(field, "as_", 3))
+	{
+		ocp_qp_as_cache_memory_get(mem->as_cache_memory, field+3, value);
+	}
 	else
 	{
 		printf("\nerror: ocp_qp_xcond_solver_memory_get: field %s not available\n", field);
@@ -453,6 +474,27 @@ int ocp_qp_xcond_solver(void *config_, ocp_qp_xcond_solver_dims *dims, ocp_qp_in
 
     int solver_status = ACADOS_SUCCESS;
 
+	// active set cache: skipped if disabled or if its memory was allocated without cache slots
+	int as_cache = ocp_qp_as_cache_enabled(opts->as_cache_opts, memory->as_cache_memory);
+
+	// active set cache: solution from a cached active set, if primal and dual feasible
+	if (as_cache && ocp_qp_as_cache_lookup(qp_in, qp_out, opts->as_cache_opts, memory->as_cache_memory))
+	{
+		// the qp solver memory still holds the factorization of the previous solve
+		memory->as_qp_in = qp_in;
+
+		info->total_time = acados_toc(&tot_timer);
+		info->solve_QP_time = info->total_time;
+		info->condensing_time = 0.0;
+		info->interface_time = 0.0;
+		info->num_iter = 0;
+		info->t_computed = 1;
+
+		return solver_status;
+	}
+
+	memory->as_qp_in = NULL;
+
 	// condensing
 	acados_tic(&cond_timer);
 	xcond->condensing(qp_in, memory->xcond_qp_in, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
@@ -466,6 +508,10 @@ int ocp_qp_xcond_solver(void *config_, ocp_qp_xcond_solver_dims *dims, ocp_qp_in
 	xcond->expansion(memory->xcond_qp_out, qp_out, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
 	info->condensing_time += acados_toc(&cond_timer);
 
+	// active set cache: add active set of the solution
+	if (as_cache && solver_status == ACADOS_SUCCESS)
+		ocp_qp_as_cache_insert(qp_in, qp_out, opts->as_cache_opts, memory->as_cache_memory);
+
 	// output qp info
 	qp_info *info_mem;
 	xcond->memory_get(xcond, memory->xcond_memory, "qp_out_info", &info_mem);
@@ -500,6 +546,14 @@ void ocp_qp_xcond_solver_eval_sens(void *config_, ocp_qp_xcond_solver_dims *dims
     // cast workspace
     cast_workspace(config_, dims, opts, memory, work);
 
+	// the last solution came from the active set cache: solve that qp again, so that the qp
+	// solver holds its factorization
+	if (memory->as_qp_in != NULL)
+	{
+		xcond->condensing(memory->as_qp_in, memory->xcond_qp_in, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+		qp_solver->evaluate(qp_solver, memory->xcond_qp_in, memory->xcond_qp_out, opts->qp_solver_opts, memory->solver_memory, work->qp_solver_work);
+		memory->as_qp_in = NULL;
+	}
 
 	// condensing
 //	acados_tic(&cond_timer);
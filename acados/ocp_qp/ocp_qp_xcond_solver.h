@@ -40,6 +40,7 @@ extern "C" {
 #endif
 
 // acados
+#include "acados/ocp_qp/ocp_qp_as_cache.h"
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/utils/types.h"
 
@@ -57,6 +58,7 @@ typedef struct ocp_qp_xcond_solver_opts_
 {
     void *xcond_opts;
     void *qp_solver_opts;
+    ocp_qp_as_cache_opts *as_cache_opts;
 } ocp_qp_xcond_solver_opts;
 
 
@@ -67,6 +69,8 @@ typedef struct ocp_qp_xcond_solver_memory_
     void *solver_memory;
     void *xcond_qp_in;
     void *xcond_qp_out;
+    ocp_qp_as_cache_memory *as_cache_memory;
+    ocp_qp_in *as_qp_in;  // qp solved from the active set cache, NULL if solved by the qp solver
 } ocp_qp_xcond_solver_memory;
 
 
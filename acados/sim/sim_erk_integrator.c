@@ -42,6 +42,8 @@
 #include "acados/sim/sim_erk_integrator.h"
 #include "acados/utils/mem.h"
 
+#include "blasfeo/include/blasfeo_d_aux.h"
+
 /************************************************
  * dims
  ************************************************/
@@ -443,19 +445,43 @@ void sim_erk_opts_update(void *config_, void *dims, void *opts_)
 
 int sim_erk_memory_calculate_size(void *config, void *dims, void *opts_)
 {
-    return 0;
+    int size = sizeof(sim_erk_memory);
+
+    return size;
 }
 
 
 void *sim_erk_memory_assign(void *config, void *dims, void *opts_, void *raw_memory)
 {
-    return NULL;
+    char *c_ptr = (char *) raw_memory;
+
+    sim_erk_memory *mem = (sim_erk_memory *) c_ptr;
+    c_ptr += sizeof(sim_erk_memory);
+
+    mem->hess_acc = NULL;
+
+    assert((char *) raw_memory + sim_erk_memory_calculate_size(config, dims, opts_) >= c_ptr);
+
+    return mem;
 }
 
 int sim_erk_memory_set(void *config_, void *dims_, void *mem_, const char *field, void *value)
 {
-    printf("sim_erk_memory_set field %s is not supported! \n", field);
-    exit(1);
+    sim_erk_memory *mem = (sim_erk_memory *) mem_;
+
+    int status = ACADOS_SUCCESS;
+
+    if (!strcmp(field, "hess_acc"))
+    {
+        mem->hess_acc = (struct blasfeo_dmat *) value;
+    }
+    else
+    {
+        printf("sim_erk_memory_set field %s is not supported! \n", field);
+        exit(1);
+    }
+
+    return status;
 }
 
 int sim_erk_memory_set_to_zero(void *config_, void * dims_, void *opts_, void *mem_, const char *field)
@@ -600,6 +626,7 @@ int sim_erk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
 {
     sim_config *config = config_;
     sim_opts *opts = opts_;
+    sim_erk_memory *mem = (sim_erk_memory *) mem_;
 
     if ( opts->ns != opts->tableau_size )
     {
@@ -912,7 +939,31 @@ int sim_erk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
         for (i = 0; i < nx + nu; i++)
             S_adj_out[i] = adj_tmp[i];
         // store hessian
-        if (opts->sens_hess)
+        if (opts->sens_hess && mem->hess_acc != NULL)
+        {
+            if (nf != nx + nu)
+            {
+                printf("sim_erk: hess_acc requires num_forw_sens = nx + nu\n");
+                exit(1);
+            }
+            // add the packed lower triangle directly to hess_acc in (u, x) ordering
+            struct blasfeo_dmat *hess_acc = mem->hess_acc;
+            int count_upper = 0;
+            for (int j = 0; j < nx + nu; j++)
+            {
+                int jj = j < nx ? nu + j : j - nx;
+                for (int i = j; i < nx + nu; i++)
+                {
+                    int ii = i < nx ? nu + i : i - nx;
+                    double tmp = adj_tmp[nx + nu + count_upper];
+                    BLASFEO_DMATEL(hess_acc, ii, jj) += tmp;
+                    if (ii != jj)
+                        BLASFEO_DMATEL(hess_acc, jj, ii) += tmp;
+                    count_upper++;
+                }
+            }
+        }
+        else if (opts->sens_hess)
         {
             // former line for tridiagonal export was
             //            for (i = 0; i < nhess; i++) S_hess_out[i] = adj_tmp[nx + nu + i];
@@ -965,5 +1016,6 @@ void sim_erk_config_initialize_default(void *config_)
     config->dims_assign = &sim_erk_dims_assign;
     config->dims_set = &sim_erk_dims_set;
     config->dims_get = &sim_erk_dims_get;
+    config->hess_acc = true;
     return;
 }
@@ -42,6 +42,8 @@ extern "C" {
 #include "acados/sim/sim_common.h"
 #include "acados/utils/types.h"
 
+#include "blasfeo/include/blasfeo_common.h"
+
 
 
 typedef struct
@@ -71,8 +73,8 @@ typedef struct
 
 typedef struct
 {
-    // no memory
-    void *dummy;
+    // if set, the hessian is added to this matrix in (u, x) ordering, instead of S_hess
+    struct blasfeo_dmat *hess_acc;
 } sim_erk_memory;
 
 
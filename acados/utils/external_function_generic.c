@@ -33,6 +33,7 @@
 
 
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 
 #include "acados/utils/external_function_generic.h"
@@ -75,9 +76,101 @@ static int casadi_nnz(const int *sparsity)
 
 
 
-static void d_cvt_casadi_to_colmaj(double *in, int *sparsity_in, double *out)
+// number of nonzeros of a sparse (non-dense and non-empty) casadi matrix, 0 otherwise
+static int casadi_sparse_nnz(const int *sparsity)
 {
-    int ii, jj, idx;
+    if (sparsity == NULL || sparsity[0] <= 0 || sparsity[1] <= 0 || sparsity[2])
+        return 0;
+
+    return casadi_nnz(sparsity);
+}
+
+
+
+// total size of the index tables of the sparse casadi matrices 0, ..., num-1
+static int casadi_idx_size(int num, const int *(*sparsity)(int))
+{
+    int size = 0;
+
+    for (int ii = 0; ii < num; ii++)
+        size += casadi_sparse_nnz(sparsity(ii));
+
+    return size;
+}
+
+
+
+// assign and build the index tables of one casadi matrix: column-major index of the nonzeros
+// (fixed), and the offset of the nonzeros in a blasfeo_dmat (resolved on first use for a given
+// matrix geometry)
+static void casadi_assign_idx_one(const int *sp, int **idx, int **pm_idx, int *pm_key,
+                                  char **c_ptr)
+{
+    int jj, kk;
+
+    int nnz = casadi_sparse_nnz(sp);
+
+    assign_and_advance_int(nnz, idx, c_ptr);
+    assign_and_advance_int(nnz, pm_idx, c_ptr);
+
+    // invalid key
+    pm_key[0] = -1;
+    pm_key[1] = -1;
+    pm_key[2] = -1;
+
+    if (nnz > 0)
+    {
+        int nrow = sp[0];
+        int ncol = sp[1];
+        const int *idxcol = sp + 2;
+        const int *row = sp + ncol + 3;
+        for (jj = 0; jj < ncol; jj++)
+            for (kk = idxcol[jj]; kk != idxcol[jj + 1]; kk++)
+                (*idx)[kk] = row[kk] + jj * nrow;
+    }
+
+    return;
+}
+
+
+
+// assign and build the index tables of the casadi matrices 0, ..., num-1;
+// the pointer arrays idx and pm_idx have to be assigned already
+static void casadi_assign_idx(int num, const int *(*sparsity)(int), int **idx, int **pm_idx,
+                              int **pm_key, char **c_ptr)
+{
+    assign_and_advance_int(3 * num, pm_key, c_ptr);
+
+    for (int ii = 0; ii < num; ii++)
+        casadi_assign_idx_one(sparsity(ii), &idx[ii], &pm_idx[ii], *pm_key + 3 * ii, c_ptr);
+
+    return;
+}
+
+
+
+// offsets of the nonzeros in the blasfeo_dmat A, recomputed only if the geometry of A changed
+static void casadi_resolve_pm_idx(int nnz, int nrow, int *idx, struct blasfeo_dmat *A,
+                                  int *pm_idx, int *pm_key)
+{
+    if (pm_key[0] == A->m && pm_key[1] == A->pm && pm_key[2] == A->cn)
+        return;
+
+    for (int kk = 0; kk < nnz; kk++)
+        pm_idx[kk] = &BLASFEO_DMATEL(A, idx[kk] % nrow, idx[kk] / nrow) - A->pA;
+
+    pm_key[0] = A->m;
+    pm_key[1] = A->pm;
+    pm_key[2] = A->cn;
+
+    return;
+}
+
+
+
+static void d_cvt_casadi_to_colmaj(double *in, int *sparsity_in, int *idx, double *out)
+{
+    int ii;
 
     int nrow = sparsity_in[0];
     int ncol = sparsity_in[1];
@@ -92,21 +185,11 @@ static void d_cvt_casadi_to_colmaj(double *in, int *sparsity_in, double *out)
     }
     else
     {
-        double *ptr = in;
-        int *idxcol = sparsity_in + 2;
-        int *row = sparsity_in + ncol + 3;
+        int nnz = sparsity_in[ncol + 2];
         // Fill with zeros
-        for (jj = 0; jj < ncol; jj++)
-            for (ii = 0; ii < nrow; ii++) out[ii + jj * nrow] = 0.0;
+        for (ii = 0; ii < ncol * nrow; ii++) out[ii] = 0.0;
         // Copy nonzeros
-        for (jj = 0; jj < ncol; jj++)
-        {
-            for (idx = idxcol[jj]; idx != idxcol[jj + 1]; idx++)
-            {
-                out[row[idx] + jj * nrow] = ptr[0];
-                ptr++;
-            }
-        }
+        for (ii = 0; ii < nnz; ii++) out[idx[ii]] = in[ii];
     }
 
     return;
@@ -114,9 +197,9 @@ static void d_cvt_casadi_to_colmaj(double *in, int *sparsity_in, double *out)
 
 
 
-static void d_cvt_colmaj_to_casadi(double *in, double *out, int *sparsity_out)
+static void d_cvt_colmaj_to_casadi(double *in, double *out, int *sparsity_out, int *idx)
 {
-    int ii, jj, idx;
+    int ii;
 
     int nrow = sparsity_out[0];
     int ncol = sparsity_out[1];
@@ -131,18 +214,9 @@ static void d_cvt_colmaj_to_casadi(double *in, double *out, int *sparsity_out)
     }
     else
     {
-        double *ptr = out;
-        int *idxcol = sparsity_out + 2;
-        int *row = sparsity_out + ncol + 3;
+        int nnz = sparsity_out[ncol + 2];
         // Copy nonzeros
-        for (jj = 0; jj < ncol; jj++)
-        {
-            for (idx = idxcol[jj]; idx != idxcol[jj + 1]; idx++)
-            {
-                ptr[0] = in[row[idx] + jj * nrow];
-                ptr++;
-            }
-        }
+        for (ii = 0; ii < nnz; ii++) out[ii] = in[idx[ii]];
     }
 
     return;
@@ -151,9 +225,12 @@ static void d_cvt_colmaj_to_casadi(double *in, double *out, int *sparsity_out)
 
 
 // TODO(all): detect if dense from number of elements per column !!!
-static void d_cvt_casadi_to_dmat(double *in, int *sparsity_in, struct blasfeo_dmat *out)
+// NOTE the whole target is zeroed (vectorized), since it can be a scratch matrix shared with
+// other functions; the nonzeros are scattered through the precomputed offsets
+static void d_cvt_casadi_to_dmat(double *in, int *sparsity_in, int *idx, int *pm_idx,
+                                 int *pm_key, struct blasfeo_dmat *out)
 {
-    int jj, idx;
+    int ii;
 
     int nrow = sparsity_in[0];
     int ncol = sparsity_in[1];
@@ -168,20 +245,13 @@ static void d_cvt_casadi_to_dmat(double *in, int *sparsity_in, struct blasfeo_dm
     }
     else
     {
-        double *ptr = in;
-        int *idxcol = sparsity_in + 2;
-        int *row = sparsity_in + ncol + 3;
+        int nnz = sparsity_in[ncol + 2];
+        casadi_resolve_pm_idx(nnz, nrow, idx, out, pm_idx, pm_key);
+        double *pA = out->pA;
         // Fill with zeros
         blasfeo_dgese(nrow, ncol, 0.0, out, 0, 0);
         // Copy nonzeros
-        for (jj = 0; jj < ncol; jj++)
-        {
-            for (idx = idxcol[jj]; idx != idxcol[jj + 1]; idx++)
-            {
-                BLASFEO_DMATEL(out, row[idx], jj) = ptr[0];
-                ptr++;
-            }
-        }
+        for (ii = 0; ii < nnz; ii++) pA[pm_idx[ii]] = in[ii];
     }
 
     return;
@@ -190,9 +260,10 @@ static void d_cvt_casadi_to_dmat(double *in, int *sparsity_in, struct blasfeo_dm
 
 
 // TODO(all): detect if dense from number of elements per column !!!
-static void d_cvt_dmat_to_casadi(struct blasfeo_dmat *in, double *out, int *sparsity_out)
+static void d_cvt_dmat_to_casadi(struct blasfeo_dmat *in, double *out, int *sparsity_out,
+                                 int *idx, int *pm_idx, int *pm_key)
 {
-    int jj, idx;
+    int ii;
 
     int nrow = sparsity_out[0];
     int ncol = sparsity_out[1];
@@ -207,18 +278,11 @@ static void d_cvt_dmat_to_casadi(struct blasfeo_dmat *in, double *out, int *spar
     }
     else
     {
-        double *ptr = out;
-        int *idxcol = sparsity_out + 2;
-        int *row = sparsity_out + ncol + 3;
+        int nnz = sparsity_out[ncol + 2];
+        casadi_resolve_pm_idx(nnz, nrow, idx, in, pm_idx, pm_key);
+        double *pA = in->pA;
         // Copy nonzeros
-        for (jj = 0; jj < ncol; jj++)
-        {
-            for (idx = idxcol[jj]; idx != idxcol[jj + 1]; idx++)
-            {
-                ptr[0] = BLASFEO_DMATEL(in, row[idx], jj);
-                ptr++;
-            }
-        }
+        for (ii = 0; ii < nnz; ii++) out[ii] = pA[pm_idx[ii]];
     }
 
     return;
@@ -456,7 +520,7 @@ static void d_cvt_dmat_args_to_casadi(struct blasfeo_dmat_args *in, double *out,
         {
             for (idx = idxcol[jj]; idx != idxcol[jj + 1]; idx++)
             {
-                ptr[0] = BLASFEO_DMATEL(A, ai + row[idx], aj + nrow);
+                ptr[0] = BLASFEO_DMATEL(A, ai + row[idx], aj + jj);
                 ptr++;
             }
         }
@@ -629,16 +693,27 @@ int external_function_casadi_calculate_size(external_function_casadi *fun)
     for (ii = 0; ii < fun->res_num; ii++)
         fun->res_size_tot += casadi_nnz(fun->casadi_sparsity_out(ii));
 
+    // index tables
+    fun->idx_size_tot = casadi_idx_size(fun->in_num, fun->casadi_sparsity_in)
+                      + casadi_idx_size(fun->out_num, fun->casadi_sparsity_out);
+
     int size = 0;
 
     // double pointers
     size += fun->args_num * sizeof(double *);  // args
     size += fun->res_num * sizeof(double *);   // res
 
+    // int pointers
+    size += 2 * fun->in_num * sizeof(int *);   // args_idx args_pm_idx
+    size += 2 * fun->out_num * sizeof(int *);  // res_idx res_pm_idx
+
     // ints
     size += fun->args_num * sizeof(int);  // args_size
     size += fun->res_num * sizeof(int);   // res_size
     size += fun->iw_size * sizeof(int);   // iw
+    size += 3 * fun->in_num * sizeof(int);   // args_pm_key
+    size += 3 * fun->out_num * sizeof(int);  // res_pm_key
+    size += 2 * fun->idx_size_tot * sizeof(int);  // args_idx args_pm_idx res_idx res_pm_idx
 
     // doubles
     size += fun->args_size_tot * sizeof(double);  // args
@@ -676,6 +751,12 @@ void external_function_casadi_assign(external_function_casadi *fun, void *raw_me
     // res
     assign_and_advance_double_ptrs(fun->res_num, &fun->res, &c_ptr);
 
+    // int pointers
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_pm_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_pm_idx, &c_ptr);
+
     // args_size
     assign_and_advance_int(fun->args_num, &fun->args_size, &c_ptr);
     for (ii = 0; ii < fun->args_num; ii++)
@@ -687,6 +768,12 @@ void external_function_casadi_assign(external_function_casadi *fun, void *raw_me
     // iw
     assign_and_advance_int(fun->iw_size, &fun->iw, &c_ptr);
 
+    // index tables of sparse inputs and outputs
+    casadi_assign_idx(fun->in_num, fun->casadi_sparsity_in, fun->args_idx, fun->args_pm_idx,
+                      &fun->args_pm_key, &c_ptr);
+    casadi_assign_idx(fun->out_num, fun->casadi_sparsity_out, fun->res_idx, fun->res_pm_idx,
+                      &fun->res_pm_key, &c_ptr);
+
     // align to double
     align_char_to(8, &c_ptr);
 
@@ -722,12 +809,13 @@ void external_function_casadi_wrapper(void *self, ext_fun_arg_t *type_in, void *
         {
             case COLMAJ:
                 d_cvt_colmaj_to_casadi(in[ii], (double *) fun->args[ii],
-                                       (int *) fun->casadi_sparsity_in(ii));
+                                       (int *) fun->casadi_sparsity_in(ii), fun->args_idx[ii]);
                 break;
 
             case BLASFEO_DMAT:
                 d_cvt_dmat_to_casadi(in[ii], (double *) fun->args[ii],
-                                     (int *) fun->casadi_sparsity_in(ii));
+                                     (int *) fun->casadi_sparsity_in(ii), fun->args_idx[ii],
+                                     fun->args_pm_idx[ii], fun->args_pm_key + 3 * ii);
                 break;
 
             case BLASFEO_DVEC:
@@ -769,12 +857,14 @@ void external_function_casadi_wrapper(void *self, ext_fun_arg_t *type_in, void *
         {
             case COLMAJ:
                 d_cvt_casadi_to_colmaj((double *) fun->res[ii],
-                                       (int *) fun->casadi_sparsity_out(ii), out[ii]);
+                                       (int *) fun->casadi_sparsity_out(ii), fun->res_idx[ii],
+                                       out[ii]);
                 break;
 
             case BLASFEO_DMAT:
                 d_cvt_casadi_to_dmat((double *) fun->res[ii], (int *) fun->casadi_sparsity_out(ii),
-                                     out[ii]);
+                                     fun->res_idx[ii], fun->res_pm_idx[ii],
+                                     fun->res_pm_key + 3 * ii, out[ii]);
                 break;
 
             case BLASFEO_DVEC:
@@ -898,16 +988,27 @@ int external_function_param_casadi_calculate_size(external_function_param_casadi
     for (ii = 0; ii < fun->res_num; ii++)
         fun->res_size_tot += casadi_nnz(fun->casadi_sparsity_out(ii));
 
+    // index tables
+    fun->idx_size_tot = casadi_idx_size(fun->in_num, fun->casadi_sparsity_in)
+                      + casadi_idx_size(fun->out_num, fun->casadi_sparsity_out);
+
     int size = 0;
 
     // double pointers
     size += fun->args_num * sizeof(double *);  // args
     size += fun->res_num * sizeof(double *);   // res
 
+    // int pointers
+    size += 2 * fun->in_num * sizeof(int *);   // args_idx args_pm_idx
+    size += 2 * fun->out_num * sizeof(int *);  // res_idx res_pm_idx
+
     // ints
     size += fun->args_num * sizeof(int);  // args_size
     size += fun->res_num * sizeof(int);   // res_size
     size += fun->iw_size * sizeof(int);   // iw
+    size += 3 * fun->in_num * sizeof(int);   // args_pm_key
+    size += 3 * fun->out_num * sizeof(int);  // res_pm_key
+    size += 2 * fun->idx_size_tot * sizeof(int);  // args_idx args_pm_idx res_idx res_pm_idx
 
     // doubles
     size += fun->args_size_tot * sizeof(double);  // args
@@ -946,6 +1047,12 @@ void external_function_param_casadi_assign(external_function_param_casadi *fun,
     // res
     assign_and_advance_double_ptrs(fun->res_num, &fun->res, &c_ptr);
 
+    // int pointers
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_pm_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_pm_idx, &c_ptr);
+
     // args_size
     assign_and_advance_int(fun->args_num, &fun->args_size, &c_ptr);
     for (ii = 0; ii < fun->args_num; ii++)
@@ -957,6 +1064,12 @@ void external_function_param_casadi_assign(external_function_param_casadi *fun,
     // iw
     assign_and_advance_int(fun->iw_size, &fun->iw, &c_ptr);
 
+    // index tables of sparse inputs and outputs
+    casadi_assign_idx(fun->in_num, fun->casadi_sparsity_in, fun->args_idx, fun->args_pm_idx,
+                      &fun->args_pm_key, &c_ptr);
+    casadi_assign_idx(fun->out_num, fun->casadi_sparsity_out, fun->res_idx, fun->res_pm_idx,
+                      &fun->res_pm_key, &c_ptr);
+
     // align to double
     align_char_to(8, &c_ptr);
 
@@ -996,12 +1109,13 @@ void external_function_param_casadi_wrapper(void *self, ext_fun_arg_t *type_in,
         {
             case COLMAJ:
                 d_cvt_colmaj_to_casadi(in[ii], (double *) fun->args[ii],
-                                       (int *) fun->casadi_sparsity_in(ii));
+                                       (int *) fun->casadi_sparsity_in(ii), fun->args_idx[ii]);
                 break;
 
             case BLASFEO_DMAT:
                 d_cvt_dmat_to_casadi(in[ii], (double *) fun->args[ii],
-                                     (int *) fun->casadi_sparsity_in(ii));
+                                     (int *) fun->casadi_sparsity_in(ii), fun->args_idx[ii],
+                                     fun->args_pm_idx[ii], fun->args_pm_key + 3 * ii);
                 break;
 
             case BLASFEO_DVEC:
@@ -1046,12 +1160,14 @@ void external_function_param_casadi_wrapper(void *self, ext_fun_arg_t *type_in,
         {
             case COLMAJ:
                 d_cvt_casadi_to_colmaj((double *) fun->res[ii],
-                                       (int *) fun->casadi_sparsity_out(ii), out[ii]);
+                                       (int *) fun->casadi_sparsity_out(ii), fun->res_idx[ii],
+                                       out[ii]);
                 break;
 
             case BLASFEO_DMAT:
                 d_cvt_casadi_to_dmat((double *) fun->res[ii], (int *) fun->casadi_sparsity_out(ii),
-                                     out[ii]);
+                                     fun->res_idx[ii], fun->res_pm_idx[ii],
+                                     fun->res_pm_key + 3 * ii, out[ii]);
                 break;
 
             case BLASFEO_DVEC:
@@ -1102,3 +1218,850 @@ void external_function_param_casadi_set_param(void *self, double *p)
 
     return;
 }
+
+
+
+/************************************************
+ * casadi external function batched over nodes
+ ************************************************/
+
+static void casadi_cvt_arg_in(ext_fun_arg_t type, void *in, double *out, int *sparsity, int *idx,
+                                int *pm_idx, int *pm_key)
+{
+    switch (type)
+    {
+        case COLMAJ:
+            d_cvt_colmaj_to_casadi(in, out, sparsity, idx);
+            break;
+
+        case BLASFEO_DMAT:
+            d_cvt_dmat_to_casadi(in, out, sparsity, idx, pm_idx, pm_key);
+            break;
+
+        case BLASFEO_DVEC:
+            d_cvt_dvec_to_casadi(in, out, sparsity);
+            break;
+
+        case COLMAJ_ARGS:
+            d_cvt_colmaj_args_to_casadi(in, out, sparsity);
+            break;
+
+        case BLASFEO_DMAT_ARGS:
+            d_cvt_dmat_args_to_casadi(in, out, sparsity);
+            break;
+
+        case BLASFEO_DVEC_ARGS:
+            d_cvt_dvec_args_to_casadi(in, out, sparsity);
+            break;
+
+        case IGNORE_ARGUMENT:
+            // do nothing
+            break;
+
+        default:
+            printf("\nUnknown external function argument type %d\n\n", type);
+            exit(1);
+    }
+
+    return;
+}
+
+
+
+static void casadi_cvt_arg_out(ext_fun_arg_t type, double *in, int *sparsity, int *idx,
+                                 int *pm_idx, int *pm_key, void *out)
+{
+    switch (type)
+    {
+        case COLMAJ:
+            d_cvt_casadi_to_colmaj(in, sparsity, idx, out);
+            break;
+
+        case BLASFEO_DMAT:
+            d_cvt_casadi_to_dmat(in, sparsity, idx, pm_idx, pm_key, out);
+            break;
+
+        case BLASFEO_DVEC:
+            d_cvt_casadi_to_dvec(in, sparsity, out);
+            break;
+
+        case COLMAJ_ARGS:
+            d_cvt_casadi_to_colmaj_args(in, sparsity, out);
+            break;
+
+        case BLASFEO_DMAT_ARGS:
+            d_cvt_casadi_to_dmat_args(in, sparsity, out);
+            break;
+
+        case BLASFEO_DVEC_ARGS:
+            d_cvt_casadi_to_dvec_args(in, sparsity, out);
+            break;
+
+        case IGNORE_ARGUMENT:
+            // do nothing
+            break;
+
+        default:
+            printf("\nUnknown external function argument type %d\n\n", type);
+            exit(1);
+    }
+
+    return;
+}
+
+
+
+int external_function_casadi_batch_struct_size()
+{
+    return sizeof(external_function_casadi_batch);
+}
+
+
+
+void external_function_casadi_batch_set_fun(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_fun = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_work(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_work = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_fun_single(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_fun_single = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_work_single(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_work_single = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_sparsity_in(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_sparsity_in = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_sparsity_out(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_sparsity_out = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_n_in(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_n_in = value;
+    return;
+}
+
+
+
+void external_function_casadi_batch_set_n_out(external_function_casadi_batch *fun, void *value)
+{
+    fun->casadi_n_out = value;
+    return;
+}
+
+
+
+int external_function_casadi_batch_calculate_size(external_function_casadi_batch *fun, int num_nodes,
+                                                  int np)
+{
+    // loop index
+    int ii;
+
+    if (fun->casadi_fun == NULL || fun->casadi_fun_single == NULL)
+    {
+        printf("\nexternal_function_casadi_batch: both the map and the single point function have to be set\n\n");
+        exit(1);
+    }
+
+    fun->num_nodes = num_nodes;
+    fun->np = np;
+
+    fun->casadi_work(&fun->args_num, &fun->res_num, &fun->iw_size, &fun->w_size);
+    fun->casadi_work_single(&fun->args_num_single, &fun->res_num_single, &fun->iw_size_single,
+                            &fun->w_size_single);
+
+    fun->in_num = fun->casadi_n_in();
+    fun->out_num = fun->casadi_n_out();
+
+    if (fun->in_num < 1 || casadi_nnz(fun->casadi_sparsity_in(fun->in_num - 1)) != np)
+    {
+        printf("\nexternal_function_casadi_batch: the last input has to be the parameter vector of size %d\n\n",
+               np);
+        exit(1);
+    }
+
+    // args
+    fun->args_size_tot = 0;
+    for (ii = 0; ii < fun->in_num; ii++)
+        fun->args_size_tot += casadi_nnz(fun->casadi_sparsity_in(ii));
+
+    // res
+    fun->res_size_tot = 0;
+    for (ii = 0; ii < fun->out_num; ii++)
+        fun->res_size_tot += casadi_nnz(fun->casadi_sparsity_out(ii));
+
+    // index tables
+    fun->idx_size_tot = casadi_idx_size(fun->in_num, fun->casadi_sparsity_in)
+                      + casadi_idx_size(fun->out_num, fun->casadi_sparsity_out);
+
+    int size = 0;
+
+    // double pointers
+    size += fun->args_num * sizeof(double *);  // args
+    size += fun->res_num * sizeof(double *);   // res
+    size += num_nodes * fun->args_num_single * sizeof(double *);  // args_single
+    size += num_nodes * fun->res_num_single * sizeof(double *);   // res_single
+
+    // int pointers
+    size += 2 * fun->in_num * sizeof(int *);   // args_idx args_pm_idx
+    size += 2 * fun->out_num * sizeof(int *);  // res_idx res_pm_idx
+
+    // recorded inputs
+    size += num_nodes * fun->in_num * sizeof(void *);  // in
+    size += num_nodes * fun->in_num * sizeof(struct colmaj_args);  // in_colmaj
+    size += num_nodes * fun->in_num * sizeof(struct blasfeo_dmat_args);  // in_dmat
+    size += num_nodes * fun->in_num * sizeof(struct blasfeo_dvec_args);  // in_dvec
+    size += num_nodes * fun->in_num * sizeof(ext_fun_arg_t);  // type_in
+
+    // ints
+    size += fun->in_num * sizeof(int);   // args_size
+    size += fun->out_num * sizeof(int);  // res_size
+    size += fun->iw_size * sizeof(int);  // iw
+    size += num_nodes * fun->iw_size_single * sizeof(int);  // iw_single
+    size += 2 * num_nodes * sizeof(int);  // node_seen node_valid
+    size += 3 * fun->in_num * sizeof(int);   // args_pm_key
+    size += 3 * fun->out_num * sizeof(int);  // res_pm_key
+    size += 2 * fun->idx_size_tot * sizeof(int);  // args_idx args_pm_idx res_idx res_pm_idx
+
+    // doubles
+    size += num_nodes * fun->args_size_tot * sizeof(double);  // args
+    size += num_nodes * fun->res_size_tot * sizeof(double);   // res
+    size += num_nodes * fun->args_size_tot * sizeof(double);  // in_tmp
+    size += fun->w_size * sizeof(double);  // w
+    size += num_nodes * fun->w_size_single * sizeof(double);  // w_single
+
+    size += 2 * 8;  // initial align, align to double
+
+    //  make_int_multiple_of(64, &size);
+
+    return size;
+}
+
+
+
+void external_function_casadi_batch_assign(external_function_casadi_batch *fun, void *raw_memory)
+{
+    // loop index
+    int ii;
+
+    int num_nodes = fun->num_nodes;
+    int in_num = fun->in_num;
+
+    // save initial pointer to external memory
+    fun->ptr_ext_mem = raw_memory;
+
+    // char pointer for byte advances
+    char *c_ptr = raw_memory;
+
+    // double pointers
+
+    // initial align
+    align_char_to(8, &c_ptr);
+
+    // args
+    assign_and_advance_double_ptrs(fun->args_num, &fun->args, &c_ptr);
+    // res
+    assign_and_advance_double_ptrs(fun->res_num, &fun->res, &c_ptr);
+    // args_single
+    assign_and_advance_double_ptrs(num_nodes * fun->args_num_single, &fun->args_single, &c_ptr);
+    // res_single
+    assign_and_advance_double_ptrs(num_nodes * fun->res_num_single, &fun->res_single, &c_ptr);
+
+    // int pointers
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_pm_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_pm_idx, &c_ptr);
+
+    // recorded inputs
+    fun->in = (void **) c_ptr;
+    c_ptr += num_nodes * in_num * sizeof(void *);
+    fun->in_colmaj = (struct colmaj_args *) c_ptr;
+    c_ptr += num_nodes * in_num * sizeof(struct colmaj_args);
+    fun->in_dmat = (struct blasfeo_dmat_args *) c_ptr;
+    c_ptr += num_nodes * in_num * sizeof(struct blasfeo_dmat_args);
+    fun->in_dvec = (struct blasfeo_dvec_args *) c_ptr;
+    c_ptr += num_nodes * in_num * sizeof(struct blasfeo_dvec_args);
+    fun->type_in = (ext_fun_arg_t *) c_ptr;
+    c_ptr += num_nodes * in_num * sizeof(ext_fun_arg_t);
+
+    // args_size
+    assign_and_advance_int(fun->in_num, &fun->args_size, &c_ptr);
+    for (ii = 0; ii < fun->in_num; ii++)
+        fun->args_size[ii] = casadi_nnz(fun->casadi_sparsity_in(ii));
+    // res_size
+    assign_and_advance_int(fun->out_num, &fun->res_size, &c_ptr);
+    for (ii = 0; ii < fun->out_num; ii++)
+        fun->res_size[ii] = casadi_nnz(fun->casadi_sparsity_out(ii));
+    // iw
+    assign_and_advance_int(fun->iw_size, &fun->iw, &c_ptr);
+    // iw_single
+    assign_and_advance_int(num_nodes * fun->iw_size_single, &fun->iw_single, &c_ptr);
+    // node flags
+    assign_and_advance_int(num_nodes, &fun->node_seen, &c_ptr);
+    assign_and_advance_int(num_nodes, &fun->node_valid, &c_ptr);
+    for (ii = 0; ii < num_nodes; ii++)
+    {
+        fun->node_seen[ii] = 0;
+        fun->node_valid[ii] = 0;
+    }
+    fun->num_refresh = 0;
+
+    // index tables of sparse inputs and outputs
+    casadi_assign_idx(fun->in_num, fun->casadi_sparsity_in, fun->args_idx, fun->args_pm_idx,
+                      &fun->args_pm_key, &c_ptr);
+    casadi_assign_idx(fun->out_num, fun->casadi_sparsity_out, fun->res_idx, fun->res_pm_idx,
+                      &fun->res_pm_key, &c_ptr);
+
+    // align to double
+    align_char_to(8, &c_ptr);
+
+    // args (of all nodes)
+    for (ii = 0; ii < fun->args_num; ii++)
+    {
+        if (ii < fun->in_num)
+            assign_and_advance_double(num_nodes * fun->args_size[ii], &fun->args[ii], &c_ptr);
+        else
+            fun->args[ii] = NULL;
+    }
+    // parameters
+    for (ii = 0; ii < num_nodes * fun->np; ii++)
+        fun->args[fun->in_num - 1][ii] = 0.0;
+    // res (of all nodes)
+    for (ii = 0; ii < fun->res_num; ii++)
+    {
+        if (ii < fun->out_num)
+            assign_and_advance_double(num_nodes * fun->res_size[ii], &fun->res[ii], &c_ptr);
+        else
+            fun->res[ii] = NULL;
+    }
+    for (ii = 0; ii < num_nodes * fun->args_num_single; ii++)
+        fun->args_single[ii] = NULL;
+    for (ii = 0; ii < num_nodes * fun->res_num_single; ii++)
+        fun->res_single[ii] = NULL;
+    // in_tmp
+    assign_and_advance_double(num_nodes * fun->args_size_tot, &fun->in_tmp, &c_ptr);
+    // w
+    assign_and_advance_double(fun->w_size, &fun->w, &c_ptr);
+    // w_single
+    assign_and_advance_double(num_nodes * fun->w_size_single, &fun->w_single, &c_ptr);
+
+    assert((char *) raw_memory + external_function_casadi_batch_calculate_size(fun, num_nodes, fun->np) >= c_ptr);
+
+    return;
+}
+
+
+
+void external_function_casadi_batch_node_set(external_function_casadi_batch_node *fun,
+                                             external_function_casadi_batch *batch, int node)
+{
+    if (node < 0 || node >= batch->num_nodes)
+    {
+        printf("\nexternal_function_casadi_batch_node_set: node %d out of range [0, %d)\n\n",
+               node, batch->num_nodes);
+        exit(1);
+    }
+
+    fun->evaluate = &external_function_casadi_batch_node_wrapper;
+    fun->set_param = &external_function_casadi_batch_node_set_param;
+    fun->batch = batch;
+    fun->node = node;
+
+    return;
+}
+
+
+
+// store the input descriptors of node k (the *_ARGS structs are usually on the caller's stack)
+static void casadi_batch_record(external_function_casadi_batch *fun, int k, ext_fun_arg_t *type_in,
+                                void **in)
+{
+    int ii;
+    int jj = k * fun->in_num;
+
+    // the parameters are not passed by the caller
+    for (ii = 0; ii < fun->in_num - 1; ii++, jj++)
+    {
+        fun->type_in[jj] = type_in[ii];
+        switch (type_in[ii])
+        {
+            case COLMAJ_ARGS:
+                fun->in_colmaj[jj] = *((struct colmaj_args *) in[ii]);
+                fun->in[jj] = &fun->in_colmaj[jj];
+                break;
+
+            case BLASFEO_DMAT_ARGS:
+                fun->in_dmat[jj] = *((struct blasfeo_dmat_args *) in[ii]);
+                fun->in[jj] = &fun->in_dmat[jj];
+                break;
+
+            case BLASFEO_DVEC_ARGS:
+                fun->in_dvec[jj] = *((struct blasfeo_dvec_args *) in[ii]);
+                fun->in[jj] = &fun->in_dvec[jj];
+                break;
+
+            default:
+                fun->in[jj] = in[ii];
+        }
+    }
+
+    fun->node_seen[k] = 1;
+
+    return;
+}
+
+
+
+void external_function_casadi_batch_evaluate(external_function_casadi_batch *fun)
+{
+    int ii, kk;
+
+    // the inputs of a node are known after its first call
+    for (kk = 0; kk < fun->num_nodes; kk++)
+    {
+        if (!fun->node_seen[kk])
+            return;
+    }
+
+    for (kk = 0; kk < fun->num_nodes; kk++)
+    {
+        for (ii = 0; ii < fun->in_num - 1; ii++)
+        {
+            casadi_cvt_arg_in(fun->type_in[kk * fun->in_num + ii], fun->in[kk * fun->in_num + ii],
+                                fun->args[ii] + kk * fun->args_size[ii],
+                                (int *) fun->casadi_sparsity_in(ii), fun->args_idx[ii],
+                                fun->args_pm_idx[ii], fun->args_pm_key + 3 * ii);
+        }
+        fun->node_valid[kk] = 1;
+    }
+
+    fun->casadi_fun((const double **) fun->args, fun->res, fun->iw, fun->w, NULL);
+
+    fun->num_refresh++;
+
+    return;
+}
+
+
+
+void external_function_casadi_batch_node_wrapper(void *self, ext_fun_arg_t *type_in, void **in,
+                                                 ext_fun_arg_t *type_out, void **out)
+{
+    // cast into batch node
+    external_function_casadi_batch_node *node = self;
+    external_function_casadi_batch *fun = node->batch;
+    int k = node->node;
+
+    // loop index
+    int ii, jj;
+
+    // only the slots of node k are accessed: the nodes can be evaluated in parallel
+    casadi_batch_record(fun, k, type_in, in);
+
+    // gather the current inputs and compare them with the ones the batch was evaluated at
+    int hit = fun->node_valid[k];
+    double *in_k = fun->in_tmp + k * fun->args_size_tot;
+    double *ptr = in_k;
+    for (ii = 0; ii < fun->in_num - 1; ii++)
+    {
+        casadi_cvt_arg_in(type_in[ii], in[ii], ptr, (int *) fun->casadi_sparsity_in(ii),
+                            fun->args_idx[ii], fun->args_pm_idx[ii], fun->args_pm_key + 3 * ii);
+        double *arg_k = fun->args[ii] + k * fun->args_size[ii];
+        for (jj = 0; jj < fun->args_size[ii] && hit; jj++)
+            hit = ptr[jj] == arg_k[jj];
+        ptr += fun->args_size[ii];
+    }
+
+    if (!hit)
+    {
+        // inputs changed since the last evaluation of the map: evaluate this node only
+        double **args_k = fun->args_single + k * fun->args_num_single;
+        double **res_k = fun->res_single + k * fun->res_num_single;
+
+        ptr = in_k;
+        for (ii = 0; ii < fun->in_num; ii++)
+        {
+            args_k[ii] = fun->args[ii] + k * fun->args_size[ii];
+            // the parameters are already in place
+            if (ii < fun->in_num - 1)
+            {
+                for (jj = 0; jj < fun->args_size[ii]; jj++)
+                    args_k[ii][jj] = ptr[jj];
+            }
+            ptr += fun->args_size[ii];
+        }
+        for (ii = 0; ii < fun->out_num; ii++)
+            res_k[ii] = fun->res[ii] + k * fun->res_size[ii];
+
+        fun->casadi_fun_single((const double **) args_k, res_k,
+                               fun->iw_single + k * fun->iw_size_single,
+                               fun->w_single + k * fun->w_size_single, NULL);
+        fun->node_valid[k] = 1;
+    }
+
+    // scatter the outputs of node k
+    for (ii = 0; ii < fun->out_num; ii++)
+    {
+        casadi_cvt_arg_out(type_out[ii], fun->res[ii] + k * fun->res_size[ii],
+                             (int *) fun->casadi_sparsity_out(ii), fun->res_idx[ii],
+                             fun->res_pm_idx[ii], fun->res_pm_key + 3 * ii, out[ii]);
+    }
+
+    return;
+}
+
+
+
+void external_function_casadi_batch_node_set_param(void *self, double *p)
+{
+    // cast into batch node
+    external_function_casadi_batch_node *node = self;
+    external_function_casadi_batch *fun = node->batch;
+    int k = node->node;
+
+    double *p_k = fun->args[fun->in_num - 1] + k * fun->np;
+    for (int ii = 0; ii < fun->np; ii++)
+        p_k[ii] = p[ii];
+
+    // the outputs of node k have to be recomputed
+    fun->node_valid[k] = 0;
+
+    return;
+}
+
+
+
+/************************************************
+ * bytecode external function
+ ************************************************/
+
+int external_function_bytecode_struct_size()
+{
+    return sizeof(external_function_bytecode);
+}
+
+
+
+void external_function_bytecode_set_program(external_function_bytecode *fun, int in_num,
+        const int **sparsity_in, int out_num, const int **sparsity_out, int reg_num, int op_num,
+        const int *op, const int *op_arg, const double *op_cst)
+{
+    int ii;
+
+    fun->ptr_program = NULL;
+    fun->in_num = in_num;
+    fun->sparsity_in = sparsity_in;
+    fun->out_num = out_num;
+    fun->sparsity_out = sparsity_out;
+    fun->reg_num = reg_num;
+    fun->op_num = op_num;
+    fun->op = op;
+    fun->op_arg = op_arg;
+    fun->op_cst = op_cst;
+
+    // validate once, the virtual machine does not check indices
+    for (ii = 0; ii < op_num; ii++)
+    {
+        int dst = op_arg[3 * ii + 0];
+        int a = op_arg[3 * ii + 1];
+        int b = op_arg[3 * ii + 2];
+        int valid;
+
+        switch (op[ii])
+        {
+            case BYTECODE_CONST:
+                valid = dst >= 0 && dst < reg_num;
+                break;
+
+            case BYTECODE_INPUT:
+                valid = dst >= 0 && dst < reg_num && a >= 0 && a < in_num &&
+                        b >= 0 && b < casadi_nnz(sparsity_in[a]);
+                break;
+
+            case BYTECODE_OUTPUT:
+                valid = dst >= 0 && dst < out_num && b >= 0 && b < casadi_nnz(sparsity_out[dst]) &&
+                        a >= 0 && a < reg_num;
+                break;
+
+            default:
+                valid = op[ii] > BYTECODE_OUTPUT && op[ii] < BYTECODE_OP_NUM && dst >= 0 &&
+                        dst < reg_num && a >= 0 && a < reg_num && b >= 0 && b < reg_num;
+        }
+
+        if (!valid)
+        {
+            printf("\nexternal_function_bytecode: invalid instruction %d (op %d, %d %d %d)\n\n",
+                   ii, op[ii], dst, a, b);
+            exit(1);
+        }
+    }
+
+    return;
+}
+
+
+
+int external_function_bytecode_calculate_size(external_function_bytecode *fun)
+{
+    // bytecode wrapper as evaluate
+    fun->evaluate = &external_function_bytecode_wrapper;
+
+    // loop index
+    int ii;
+
+    // args
+    fun->args_size_tot = 0;
+    for (ii = 0; ii < fun->in_num; ii++)
+        fun->args_size_tot += casadi_nnz(fun->sparsity_in[ii]);
+
+    // res
+    fun->res_size_tot = 0;
+    for (ii = 0; ii < fun->out_num; ii++)
+        fun->res_size_tot += casadi_nnz(fun->sparsity_out[ii]);
+
+    // index tables
+    fun->idx_size_tot = 0;
+    for (ii = 0; ii < fun->in_num; ii++)
+        fun->idx_size_tot += casadi_sparse_nnz(fun->sparsity_in[ii]);
+    for (ii = 0; ii < fun->out_num; ii++)
+        fun->idx_size_tot += casadi_sparse_nnz(fun->sparsity_out[ii]);
+
+    int size = 0;
+
+    // double pointers
+    size += fun->in_num * sizeof(double *);   // args
+    size += fun->out_num * sizeof(double *);  // res
+
+    // int pointers
+    size += 2 * fun->in_num * sizeof(int *);   // args_idx args_pm_idx
+    size += 2 * fun->out_num * sizeof(int *);  // res_idx res_pm_idx
+
+    // ints
+    size += fun->in_num * sizeof(int);   // args_size
+    size += fun->out_num * sizeof(int);  // res_size
+    size += 3 * fun->in_num * sizeof(int);   // args_pm_key
+    size += 3 * fun->out_num * sizeof(int);  // res_pm_key
+    size += 2 * fun->idx_size_tot * sizeof(int);  // args_idx args_pm_idx res_idx res_pm_idx
+
+    // doubles
+    size += fun->args_size_tot * sizeof(double);  // args
+    size += fun->res_size_tot * sizeof(double);   // res
+    size += fun->reg_num * sizeof(double);        // reg
+
+    size += 2 * 8;  // initial align, align to double
+
+    //  make_int_multiple_of(64, &size);
+
+    return size;
+}
+
+
+
+void external_function_bytecode_assign(external_function_bytecode *fun, void *raw_memory)
+{
+    // loop index
+    int ii;
+
+    // save initial pointer to external memory
+    fun->ptr_ext_mem = raw_memory;
+
+    // char pointer for byte advances
+    char *c_ptr = raw_memory;
+
+    // double pointers
+
+    // initial align
+    align_char_to(8, &c_ptr);
+
+    // args
+    assign_and_advance_double_ptrs(fun->in_num, &fun->args, &c_ptr);
+    // res
+    assign_and_advance_double_ptrs(fun->out_num, &fun->res, &c_ptr);
+
+    // int pointers
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->in_num, &fun->args_pm_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_idx, &c_ptr);
+    assign_and_advance_int_ptrs(fun->out_num, &fun->res_pm_idx, &c_ptr);
+
+    // args_size
+    assign_and_advance_int(fun->in_num, &fun->args_size, &c_ptr);
+    for (ii = 0; ii < fun->in_num; ii++)
+        fun->args_size[ii] = casadi_nnz(fun->sparsity_in[ii]);
+    // res_size
+    assign_and_advance_int(fun->out_num, &fun->res_size, &c_ptr);
+    for (ii = 0; ii < fun->out_num; ii++)
+        fun->res_size[ii] = casadi_nnz(fun->sparsity_out[ii]);
+
+    // index tables of sparse inputs and outputs
+    assign_and_advance_int(3 * fun->in_num, &fun->args_pm_key, &c_ptr);
+    for (ii = 0; ii < fun->in_num; ii++)
+        casadi_assign_idx_one(fun->sparsity_in[ii], &fun->args_idx[ii], &fun->args_pm_idx[ii],
+                              fun->args_pm_key + 3 * ii, &c_ptr);
+    assign_and_advance_int(3 * fun->out_num, &fun->res_pm_key, &c_ptr);
+    for (ii = 0; ii < fun->out_num; ii++)
+        casadi_assign_idx_one(fun->sparsity_out[ii], &fun->res_idx[ii], &fun->res_pm_idx[ii],
+                              fun->res_pm_key + 3 * ii, &c_ptr);
+
+    // align to double
+    align_char_to(8, &c_ptr);
+
+    // args
+    for (ii = 0; ii < fun->in_num; ii++)
+        assign_and_advance_double(fun->args_size[ii], &fun->args[ii], &c_ptr);
+    // res
+    for (ii = 0; ii < fun->out_num; ii++)
+        assign_and_advance_double(fun->res_size[ii], &fun->res[ii], &c_ptr);
+    // reg
+    assign_and_advance_double(fun->reg_num, &fun->reg, &c_ptr);
+
+    assert((char *) raw_memory + external_function_bytecode_calculate_size(fun) >= c_ptr);
+
+    return;
+}
+
+
+
+static double bytecode_sign(double x)
+{
+    return x < 0 ? -1.0 : x > 0 ? 1.0 : x;
+}
+
+
+
+static void bytecode_run(external_function_bytecode *fun)
+{
+    const int *op = fun->op;
+    const int *arg = fun->op_arg;
+    const double *cst = fun->op_cst;
+    double *r = fun->reg;
+    double **args = fun->args;
+    double **res = fun->res;
+
+    for (int ii = 0; ii < fun->op_num; ii++, arg += 3)
+    {
+        int d = arg[0];
+        int a = arg[1];
+        int b = arg[2];
+
+        switch (op[ii])
+        {
+            case BYTECODE_CONST: r[d] = cst[ii]; break;
+            case BYTECODE_INPUT: r[d] = args[a][b]; break;
+            case BYTECODE_OUTPUT: res[d][b] = r[a]; break;
+            case BYTECODE_ASSIGN: r[d] = r[a]; break;
+            case BYTECODE_ADD: r[d] = r[a] + r[b]; break;
+            case BYTECODE_SUB: r[d] = r[a] - r[b]; break;
+            case BYTECODE_MUL: r[d] = r[a] * r[b]; break;
+            case BYTECODE_DIV: r[d] = r[a] / r[b]; break;
+            case BYTECODE_NEG: r[d] = -r[a]; break;
+            case BYTECODE_EXP: r[d] = exp(r[a]); break;
+            case BYTECODE_LOG: r[d] = log(r[a]); break;
+            case BYTECODE_POW: r[d] = pow(r[a], r[b]); break;
+            case BYTECODE_SQRT: r[d] = sqrt(r[a]); break;
+            case BYTECODE_SQ: r[d] = r[a] * r[a]; break;
+            case BYTECODE_TWICE: r[d] = 2.0 * r[a]; break;
+            case BYTECODE_SIN: r[d] = sin(r[a]); break;
+            case BYTECODE_COS: r[d] = cos(r[a]); break;
+            case BYTECODE_TAN: r[d] = tan(r[a]); break;
+            case BYTECODE_ASIN: r[d] = asin(r[a]); break;
+            case BYTECODE_ACOS: r[d] = acos(r[a]); break;
+            case BYTECODE_ATAN: r[d] = atan(r[a]); break;
+            case BYTECODE_LT: r[d] = r[a] < r[b]; break;
+            case BYTECODE_LE: r[d] = r[a] <= r[b]; break;
+            case BYTECODE_EQ: r[d] = r[a] == r[b]; break;
+            case BYTECODE_NE: r[d] = r[a] != r[b]; break;
+            case BYTECODE_NOT: r[d] = !r[a]; break;
+            case BYTECODE_AND: r[d] = r[a] && r[b]; break;
+            case BYTECODE_OR: r[d] = r[a] || r[b]; break;
+            case BYTECODE_FLOOR: r[d] = floor(r[a]); break;
+            case BYTECODE_CEIL: r[d] = ceil(r[a]); break;
+            case BYTECODE_FMOD: r[d] = fmod(r[a], r[b]); break;
+            case BYTECODE_FABS: r[d] = fabs(r[a]); break;
+            case BYTECODE_SIGN: r[d] = bytecode_sign(r[a]); break;
+            case BYTECODE_COPYSIGN: r[d] = copysign(r[a], r[b]); break;
+            case BYTECODE_IF_ELSE_ZERO: r[d] = r[a] ? r[b] : 0.0; break;
+            case BYTECODE_ERF: r[d] = erf(r[a]); break;
+            case BYTECODE_FMIN: r[d] = fmin(r[a], r[b]); break;
+            case BYTECODE_FMAX: r[d] = fmax(r[a], r[b]); break;
+            case BYTECODE_INV: r[d] = 1.0 / r[a]; break;
+            case BYTECODE_SINH: r[d] = sinh(r[a]); break;
+            case BYTECODE_COSH: r[d] = cosh(r[a]); break;
+            case BYTECODE_TANH: r[d] = tanh(r[a]); break;
+            case BYTECODE_ASINH: r[d] = asinh(r[a]); break;
+            case BYTECODE_ACOSH: r[d] = acosh(r[a]); break;
+            case BYTECODE_ATANH: r[d] = atanh(r[a]); break;
+            case BYTECODE_ATAN2: r[d] = atan2(r[a], r[b]); break;
+            case BYTECODE_LOG1P: r[d] = log1p(r[a]); break;
+            case BYTECODE_EXPM1: r[d] = expm1(r[a]); break;
+            case BYTECODE_HYPOT: r[d] = hypot(r[a], r[b]); break;
+        }
+    }
+
+    return;
+}
+
+
+
+void external_function_bytecode_wrapper(void *self, ext_fun_arg_t *type_in, void **in,
+                                        ext_fun_arg_t *type_out, void **out)
+{
+    // cast into external bytecode function
+    external_function_bytecode *fun = self;
+
+    // loop index
+    int ii, jj;
+
+    // in as args
+    for (ii = 0; ii < fun->in_num; ii++)
+        casadi_cvt_arg_in(type_in[ii], in[ii], fun->args[ii], (int *) fun->sparsity_in[ii],
+                          fun->args_idx[ii], fun->args_pm_idx[ii], fun->args_pm_key + 3 * ii);
+
+    // nonzeros not written by the program are zero
+    for (ii = 0; ii < fun->out_num; ii++)
+        for (jj = 0; jj < fun->res_size[ii]; jj++)
+            fun->res[ii][jj] = 0.0;
+
+    // run program
+    bytecode_run(fun);
+
+    // res as out
+    for (ii = 0; ii < fun->out_num; ii++)
+        casadi_cvt_arg_out(type_out[ii], fun->res[ii], (int *) fun->sparsity_out[ii],
+                           fun->res_idx[ii], fun->res_pm_idx[ii], fun->res_pm_key + 3 * ii,
+                           out[ii]);
+
+    return;
+}
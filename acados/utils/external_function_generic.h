@@ -106,10 +106,17 @@ typedef struct
     int *iw;
     int *args_size;     // size of args[i]
     int *res_size;      // size of res[i]
+    int **args_idx;     // column-major index of the nonzeros of sparse args[i]
+    int **res_idx;      // column-major index of the nonzeros of sparse res[i]
+    int **args_pm_idx;  // blasfeo_dmat offset of the nonzeros of sparse args[i]
+    int **res_pm_idx;   // blasfeo_dmat offset of the nonzeros of sparse res[i]
+    int *args_pm_key;   // (m, pm, cn) of the blasfeo_dmat args_pm_idx[i] refers to
+    int *res_pm_key;    // (m, pm, cn) of the blasfeo_dmat res_pm_idx[i] refers to
     int args_num;       // number of args arrays
     int args_size_tot;  // total size of args arrays
     int res_num;        // number of res arrays
     int res_size_tot;   // total size of res arrays
+    int idx_size_tot;   // total size of the index tables of sparse inputs and outputs
     int in_num;         // number of input arrays
     int out_num;        // number of output arrays
     int iw_size;        // number of ints for worksapce
@@ -162,10 +169,17 @@ typedef struct
     int *iw;
     int *args_size;     // size of args[i]
     int *res_size;      // size of res[i]
+    int **args_idx;     // column-major index of the nonzeros of sparse args[i]
+    int **res_idx;      // column-major index of the nonzeros of sparse res[i]
+    int **args_pm_idx;  // blasfeo_dmat offset of the nonzeros of sparse args[i]
+    int **res_pm_idx;   // blasfeo_dmat offset of the nonzeros of sparse res[i]
+    int *args_pm_key;   // (m, pm, cn) of the blasfeo_dmat args_pm_idx[i] refers to
+    int *res_pm_key;    // (m, pm, cn) of the blasfeo_dmat res_pm_idx[i] refers to
     int args_num;       // number of args arrays
     int args_size_tot;  // total size of args arrays
     int res_num;        // number of res arrays
     int res_size_tot;   // total size of res arrays
+    int idx_size_tot;   // total size of the index tables of sparse inputs and outputs
     int in_num;         // number of input arrays
     int out_num;        // number of output arrays
     int iw_size;        // number of ints for worksapce
@@ -197,6 +211,237 @@ void external_function_param_casadi_wrapper(void *self, ext_fun_arg_t *type_in,
 //
 void external_function_param_casadi_set_param(void *self, double *p);
 
+/************************************************
+ * casadi external function batched over nodes
+ ************************************************/
+
+// Evaluates the same casadi function at num_nodes points (e.g. the shooting nodes) with a single
+// call of its casadi map, e.g. generated from f.map(num_nodes), whose inputs and outputs are the
+// horizontal concatenation of the num_nodes point-wise ones; args[i] and res[i] thus hold the
+// i-th argument of all the nodes (structure of arrays), node k at offset k * args_size[i]. As for
+// external_function_param_casadi, the last input is the parameter vector, set per node.
+//
+// Each node is accessed through an external_function_casadi_batch_node, which can be passed to
+// the nlp modules as any other external function. The input descriptors of each node are recorded
+// at its calls, they have to point to persistent memory (as e.g. the ux, pi and lam vectors of the
+// nlp modules). external_function_casadi_batch_evaluate gathers the inputs of all the nodes from
+// the recorded descriptors and evaluates the map once; it is called by the nlp solver before the
+// stage-wise loops (outside of parallel regions). A node then only scatters its outputs, unless its
+// inputs differ from the gathered ones (or were not yet recorded), in which case it is evaluated
+// point-wise with the single-point casadi function. A node only accesses its own slots of the
+// buffers, so the nodes can be evaluated in parallel.
+typedef struct
+{
+    void *ptr_ext_mem;  // pointer to external memory
+    // map over the nodes
+    int (*casadi_fun)(const double **, double **, int *, double *, void *);
+    int (*casadi_work)(int *, int *, int *, int *);
+    // single point
+    int (*casadi_fun_single)(const double **, double **, int *, double *, void *);
+    int (*casadi_work_single)(int *, int *, int *, int *);
+    const int *(*casadi_sparsity_in)(int);
+    const int *(*casadi_sparsity_out)(int);
+    int (*casadi_n_in)();
+    int (*casadi_n_out)();
+    double **args;
+    double **res;
+    double **args_single;  // pointers into args and res at each node, [num_nodes][args_num_single]
+    double **res_single;   // [num_nodes][res_num_single]
+    double *w;             // workspace of the map
+    double *w_single;      // workspace of the single point function, [num_nodes][w_size_single]
+    double *in_tmp;        // gathered inputs, [num_nodes][args_size_tot]
+    int *iw;               // workspace of the map
+    int *iw_single;        // workspace of the single point function, [num_nodes][iw_size_single]
+    int *args_size;     // size of args[i] per node
+    int *res_size;      // size of res[i] per node
+    int **args_idx;     // column-major index of the nonzeros of sparse args[i]
+    int **res_idx;      // column-major index of the nonzeros of sparse res[i]
+    int **args_pm_idx;  // blasfeo_dmat offset of the nonzeros of sparse args[i]
+    int **res_pm_idx;   // blasfeo_dmat offset of the nonzeros of sparse res[i]
+    int *args_pm_key;   // (m, pm, cn) of the blasfeo_dmat args_pm_idx[i] refers to
+    int *res_pm_key;    // (m, pm, cn) of the blasfeo_dmat res_pm_idx[i] refers to
+    ext_fun_arg_t *type_in;  // recorded input types, [num_nodes][in_num]
+    void **in;               // recorded input descriptors, [num_nodes][in_num]
+    struct colmaj_args *in_colmaj;  // copies of the *_ARGS descriptors
+    struct blasfeo_dmat_args *in_dmat;
+    struct blasfeo_dvec_args *in_dvec;
+    int *node_seen;     // inputs of the node recorded
+    int *node_valid;    // res of the node computed from its args
+    int num_refresh;    // number of evaluations of the map
+    int num_nodes;      // number of points of the map
+    int args_num;       // number of args arrays of the map
+    int res_num;        // number of res arrays of the map
+    int args_num_single;  // number of args arrays of the single point function
+    int res_num_single;   // number of res arrays of the single point function
+    int args_size_tot;  // total size of args arrays per node
+    int res_size_tot;   // total size of res arrays per node
+    int idx_size_tot;   // total size of the index tables of sparse inputs and outputs
+    int in_num;         // number of input arrays (including the parameters)
+    int out_num;        // number of output arrays
+    int iw_size;        // number of ints for workspace of the map
+    int w_size;         // number of doubles for workspace of the map
+    int iw_size_single; // number of ints for workspace of the single point function
+    int w_size_single;  // number of doubles for workspace of the single point function
+    int np;             // number of parameters
+} external_function_casadi_batch;
+
+typedef struct
+{
+    // public members (have to be the same as in the prototype, and before the private ones)
+    void (*evaluate)(void *, ext_fun_arg_t *, void **, ext_fun_arg_t *, void **);
+    // private members
+    void (*set_param)(void *, double *);
+    external_function_casadi_batch *batch;
+    int node;
+} external_function_casadi_batch_node;
+
+//
+int external_function_casadi_batch_struct_size();
+//
+void external_function_casadi_batch_set_fun(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_work(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_fun_single(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_work_single(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_sparsity_in(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_sparsity_out(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_n_in(external_function_casadi_batch *fun, void *value);
+//
+void external_function_casadi_batch_set_n_out(external_function_casadi_batch *fun, void *value);
+//
+int external_function_casadi_batch_calculate_size(external_function_casadi_batch *fun, int num_nodes,
+                                                  int np);
+//
+void external_function_casadi_batch_assign(external_function_casadi_batch *fun, void *mem);
+// evaluates the map at the current values of the recorded inputs, once all the nodes have been
+// called; not thread safe, call it outside of parallel regions
+void external_function_casadi_batch_evaluate(external_function_casadi_batch *fun);
+//
+void external_function_casadi_batch_node_set(external_function_casadi_batch_node *fun,
+                                             external_function_casadi_batch *batch, int node);
+//
+void external_function_casadi_batch_node_wrapper(void *self, ext_fun_arg_t *type_in, void **in,
+                                                 ext_fun_arg_t *type_out, void **out);
+//
+void external_function_casadi_batch_node_set_param(void *self, double *p);
+
+/************************************************
+ * bytecode external function
+ ************************************************/
+
+// Evaluates an expression graph (e.g. exported from a casadi SX function by
+// acados_template/generate_bytecode.py) in a register-based virtual machine, without generating
+// and compiling C code. Inputs and outputs use the casadi sparsity format; each instruction
+// reads the registers a and b (or the nonzero b of input a, or the constant) and writes the
+// register dst (or the nonzero b of output dst).
+
+// instruction set (the values are part of the bytecode format)
+typedef enum {
+    BYTECODE_CONST = 0,
+    BYTECODE_INPUT,
+    BYTECODE_OUTPUT,
+    BYTECODE_ASSIGN,
+    BYTECODE_ADD,
+    BYTECODE_SUB,
+    BYTECODE_MUL,
+    BYTECODE_DIV,
+    BYTECODE_NEG,
+    BYTECODE_EXP,
+    BYTECODE_LOG,
+    BYTECODE_POW,
+    BYTECODE_SQRT,
+    BYTECODE_SQ,
+    BYTECODE_TWICE,
+    BYTECODE_SIN,
+    BYTECODE_COS,
+    BYTECODE_TAN,
+    BYTECODE_ASIN,
+    BYTECODE_ACOS,
+    BYTECODE_ATAN,
+    BYTECODE_LT,
+    BYTECODE_LE,
+    BYTECODE_EQ,
+    BYTECODE_NE,
+    BYTECODE_NOT,
+    BYTECODE_AND,
+    BYTECODE_OR,
+    BYTECODE_FLOOR,
+    BYTECODE_CEIL,
+    BYTECODE_FMOD,
+    BYTECODE_FABS,
+    BYTECODE_SIGN,
+    BYTECODE_COPYSIGN,
+    BYTECODE_IF_ELSE_ZERO,
+    BYTECODE_ERF,
+    BYTECODE_FMIN,
+    BYTECODE_FMAX,
+    BYTECODE_INV,
+    BYTECODE_SINH,
+    BYTECODE_COSH,
+    BYTECODE_TANH,
+    BYTECODE_ASINH,
+    BYTECODE_ACOSH,
+    BYTECODE_ATANH,
+    BYTECODE_ATAN2,
+    BYTECODE_LOG1P,
+    BYTECODE_EXPM1,
+    BYTECODE_HYPOT,
+    BYTECODE_OP_NUM
+} ext_fun_bytecode_op;
+
+typedef struct
+{
+    // public members (have to be the same as in the prototype, and before the private ones)
+    void (*evaluate)(void *, ext_fun_arg_t *, void **, ext_fun_arg_t *, void **);
+    // private members
+    void *ptr_ext_mem;  // pointer to external memory
+    void *ptr_program;  // pointer to the program memory, if owned (e.g. read from file)
+    // program (not copied, has to outlive the function)
+    const int **sparsity_in;   // casadi sparsity of the inputs
+    const int **sparsity_out;  // casadi sparsity of the outputs
+    const int *op;             // instructions
+    const int *op_arg;         // (dst, a, b) of each instruction
+    const double *op_cst;      // constant of each instruction
+    int op_num;         // number of instructions
+    int reg_num;        // number of registers
+    // memory
+    double **args;
+    double **res;
+    double *reg;        // registers
+    int *args_size;     // size of args[i]
+    int *res_size;      // size of res[i]
+    int **args_idx;     // column-major index of the nonzeros of sparse args[i]
+    int **res_idx;      // column-major index of the nonzeros of sparse res[i]
+    int **args_pm_idx;  // blasfeo_dmat offset of the nonzeros of sparse args[i]
+    int **res_pm_idx;   // blasfeo_dmat offset of the nonzeros of sparse res[i]
+    int *args_pm_key;   // (m, pm, cn) of the blasfeo_dmat args_pm_idx[i] refers to
+    int *res_pm_key;    // (m, pm, cn) of the blasfeo_dmat res_pm_idx[i] refers to
+    int args_size_tot;  // total size of args arrays
+    int res_size_tot;   // total size of res arrays
+    int idx_size_tot;   // total size of the index tables of sparse inputs and outputs
+    int in_num;         // number of input arrays
+    int out_num;        // number of output arrays
+} external_function_bytecode;
+
+//
+int external_function_bytecode_struct_size();
+//
+void external_function_bytecode_set_program(external_function_bytecode *fun, int in_num,
+        const int **sparsity_in, int out_num, const int **sparsity_out, int reg_num, int op_num,
+        const int *op, const int *op_arg, const double *op_cst);
+//
+int external_function_bytecode_calculate_size(external_function_bytecode *fun);
+//
+void external_function_bytecode_assign(external_function_bytecode *fun, void *mem);
+//
+void external_function_bytecode_wrapper(void *self, ext_fun_arg_t *type_in, void **in,
+                                        ext_fun_arg_t *type_out, void **out);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,149 @@
+#
+# Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+# Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+# Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+# Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+#
+# This file is part of acados.
+#
+# The 2-Clause BSD License
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.;
+#
+
+
+# compare the generic ERK integrator of acados with the SPECIALIZED code target,
+# which unrolls the integration step into fixed-dimension discrete dynamics
+
+import sys
+sys.path.insert(0, '../common')
+
+from acados_template import AcadosOcp, AcadosOcpSolver
+from export_pendulum_ode_model import export_pendulum_ode_model
+import numpy as np
+import scipy.linalg
+
+Tf = 1.0
+N = 20
+Fmax = 80
+N_RUNS = 100
+
+def create_ocp_solver(code_target):
+
+    ocp = AcadosOcp()
+
+    model = export_pendulum_ode_model()
+    model.name = model.name + '_' + code_target.lower()
+    ocp.model = model
+
+    nx = model.x.size()[0]
+    nu = model.u.size()[0]
+    ny = nx + nu
+    ny_e = nx
+
+    # set dimensions
+    ocp.dims.nx = nx
+    ocp.dims.ny = ny
+    ocp.dims.ny_e = ny_e
+    ocp.dims.nbu = nu
+    ocp.dims.nu = nu
+    ocp.dims.N = N
+
+    # set cost
+    Q = 2*np.diag([1e3, 1e3, 1e-2, 1e-2])
+    R = 2*np.diag([1e-2])
+
+    ocp.cost.W_e = Q
+    ocp.cost.W = scipy.linalg.block_diag(Q, R)
+
+    ocp.cost.cost_type = 'LINEAR_LS'
+    ocp.cost.cost_type_e = 'LINEAR_LS'
+
+    ocp.cost.Vx = np.zeros((ny, nx))
+    ocp.cost.Vx[:nx,:nx] = np.eye(nx)
+
+    Vu = np.zeros((ny, nu))
+    Vu[4,0] = 1.0
+    ocp.cost.Vu = Vu
+
+    ocp.cost.Vx_e = np.eye(nx)
+
+    ocp.cost.yref  = np.zeros((ny, ))
+    ocp.cost.yref_e = np.zeros((ny_e, ))
+
+    # set constraints
+    ocp.constraints.lbu = np.array([-Fmax])
+    ocp.constraints.ubu = np.array([+Fmax])
+    ocp.constraints.x0 = np.array([0.0, np.pi, 0.0, 0.0])
+    ocp.constraints.idxbu = np.array([0])
+
+    ocp.solver_options.qp_solver = 'PARTIAL_CONDENSING_HPIPM'
+    ocp.solver_options.hessian_approx = 'GAUSS_NEWTON'
+    ocp.solver_options.integrator_type = 'ERK'
+    ocp.solver_options.sim_method_num_stages = 4
+    ocp.solver_options.sim_method_num_steps = 1
+    ocp.solver_options.code_target = code_target
+    ocp.solver_options.print_level = 0
+
+    ocp.solver_options.tf = Tf
+    ocp.solver_options.nlp_solver_type = 'SQP'
+
+    return AcadosOcpSolver(ocp, json_file = 'acados_ocp_' + model.name + '.json')
+
+
+results = {}
+for code_target in ['GENERIC', 'SPECIALIZED']:
+    ocp_solver = create_ocp_solver(code_target)
+
+    time_tot = []
+    time_lin = []
+    for i in range(N_RUNS):
+        # cold start
+        for stage in range(N+1):
+            ocp_solver.set(stage, 'x', np.zeros((4,)))
+        for stage in range(N):
+            ocp_solver.set(stage, 'u', np.zeros((1,)))
+
+        status = ocp_solver.solve()
+        if status != 0:
+            raise Exception('acados returned status {} for code_target {}. Exiting.'.format(status, code_target))
+
+        time_tot.append(ocp_solver.get_stats('time_tot')[0])
+        time_lin.append(ocp_solver.get_stats('time_lin')[0])
+
+    results[code_target] = dict(
+        sqp_iter = ocp_solver.get_stats('sqp_iter')[0],
+        time_tot = min(time_tot),
+        time_lin = min(time_lin),
+        x = np.array([ocp_solver.get(stage, 'x') for stage in range(N+1)]),
+    )
+
+print('code_target    sqp_iter    time_tot [ms]    time_lin [ms]')
+for code_target, res in results.items():
+    print('{:12s}   {:8d}    {:13.4f}    {:13.4f}'.format(code_target, res['sqp_iter'], \
+        1e3*res['time_tot'], 1e3*res['time_lin']))
+
+diff = np.max(np.abs(results['GENERIC']['x'] - results['SPECIALIZED']['x']))
+print('max difference in state trajectory: {:.3e}'.format(diff))
+if diff > 1e-6:
+    raise Exception('GENERIC and SPECIALIZED solutions differ by {}. Exiting.'.format(diff))
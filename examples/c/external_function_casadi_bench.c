@@ -0,0 +1,237 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// micro-benchmark of the conversion of sparse casadi outputs into blasfeo_dmat:
+// precomputed scatter tables (external_function_casadi_wrapper) vs. per-element BLASFEO_DMATEL
+
+// external
+#include <stdio.h>
+#include <stdlib.h>
+
+// blasfeo
+#include <blasfeo/include/blasfeo.h>
+
+// acados
+#include <acados/utils/external_function_generic.h>
+#include <acados/utils/timing.h>
+
+#define NX 40     // rows of the jacobian
+#define NV 60     // columns of the jacobian (and size of the input)
+#define NREP 10000
+
+
+
+/************************************************
+ * casadi-like function: banded jacobian plus a dense last column
+ ************************************************/
+
+static int sparsity_x[3 + NV + 1 + NV];
+static int sparsity_jac[3 + NV + 1 + 3 * NV + NX];
+
+static void init_sparsity()
+{
+    int ii, jj, nnz;
+
+    // dense column vector
+    sparsity_x[0] = NV;
+    sparsity_x[1] = 1;
+    sparsity_x[2] = 1;
+
+    // sparse jacobian in CCS format: nrow, ncol, dense flag, colind[ncol+1], row[nnz]
+    sparsity_jac[0] = NX;
+    sparsity_jac[1] = NV;
+    sparsity_jac[2] = 0;
+    int *colind = sparsity_jac + 2;
+    int *row = sparsity_jac + NV + 3;
+    nnz = 0;
+    for (jj = 0; jj < NV; jj++)
+    {
+        colind[jj] = nnz;
+        if (jj == NV - 1)
+        {
+            for (ii = 0; ii < NX; ii++) row[nnz++] = ii;
+        }
+        else
+        {
+            for (ii = jj - 1; ii <= jj + 1; ii++)
+                if (ii >= 0 && ii < NX) row[nnz++] = ii;
+        }
+    }
+    colind[NV] = nnz;
+}
+
+static int bench_fun(const double **arg, double **res, int *iw, double *w, void *mem)
+{
+    int nnz = sparsity_jac[NV + 2];
+    for (int ii = 0; ii < nnz; ii++) res[0][ii] = arg[0][ii % NV] + ii;
+    return 0;
+}
+
+static int bench_work(int *sz_arg, int *sz_res, int *sz_iw, int *sz_w)
+{
+    if (sz_arg) *sz_arg = 1;
+    if (sz_res) *sz_res = 1;
+    if (sz_iw) *sz_iw = 0;
+    if (sz_w) *sz_w = 0;
+    return 0;
+}
+
+static const int *bench_sparsity_in(int ii) { return sparsity_x; }
+
+static const int *bench_sparsity_out(int ii) { return sparsity_jac; }
+
+static int bench_n_in() { return 1; }
+
+static int bench_n_out() { return 1; }
+
+
+
+/************************************************
+ * reference conversion (per-element panel-major index arithmetic)
+ ************************************************/
+
+static void d_cvt_casadi_to_dmat_ref(double *in, const int *sparsity_in, struct blasfeo_dmat *out)
+{
+    int jj, idx;
+
+    int nrow = sparsity_in[0];
+    int ncol = sparsity_in[1];
+
+    const double *ptr = in;
+    const int *idxcol = sparsity_in + 2;
+    const int *row = sparsity_in + ncol + 3;
+    blasfeo_dgese(nrow, ncol, 0.0, out, 0, 0);
+    for (jj = 0; jj < ncol; jj++)
+    {
+        for (idx = idxcol[jj]; idx != idxcol[jj + 1]; idx++)
+        {
+            BLASFEO_DMATEL(out, row[idx], jj) = ptr[0];
+            ptr++;
+        }
+    }
+}
+
+
+
+int main()
+{
+    int ii, jj, rep;
+
+    printf("\nexternal function casadi conversion benchmark\n\n");
+
+    init_sparsity();
+
+    /************************************************
+     * external function
+     ************************************************/
+
+    external_function_casadi ext_fun;
+    ext_fun.casadi_fun = &bench_fun;
+    ext_fun.casadi_work = &bench_work;
+    ext_fun.casadi_sparsity_in = &bench_sparsity_in;
+    ext_fun.casadi_sparsity_out = &bench_sparsity_out;
+    ext_fun.casadi_n_in = &bench_n_in;
+    ext_fun.casadi_n_out = &bench_n_out;
+
+    int fun_size = external_function_casadi_calculate_size(&ext_fun);
+    void *fun_mem = malloc(fun_size);
+    external_function_casadi_assign(&ext_fun, fun_mem);
+
+    /************************************************
+     * data
+     ************************************************/
+
+    double x[NV];
+    for (ii = 0; ii < NV; ii++) x[ii] = 0.1 * ii;
+
+    struct blasfeo_dmat jac, jac_ref;
+    void *jac_mem = malloc(blasfeo_memsize_dmat(NX, NV));
+    void *jac_ref_mem = malloc(blasfeo_memsize_dmat(NX, NV));
+    blasfeo_create_dmat(NX, NV, &jac, jac_mem);
+    blasfeo_create_dmat(NX, NV, &jac_ref, jac_ref_mem);
+
+    ext_fun_arg_t type_in[1] = {COLMAJ};
+    void *in[1] = {x};
+    ext_fun_arg_t type_out[1] = {BLASFEO_DMAT};
+    void *out[1] = {&jac};
+
+    const double *arg[1] = {x};
+    double *res[1] = {ext_fun.res[0]};
+
+    /************************************************
+     * benchmark
+     ************************************************/
+
+    acados_timer timer;
+    double time_tables, time_ref;
+
+    // precomputed scatter tables
+    acados_tic(&timer);
+    for (rep = 0; rep < NREP; rep++)
+        ext_fun.evaluate(&ext_fun, type_in, in, type_out, out);
+    time_tables = acados_toc(&timer) / NREP;
+
+    // per-element index arithmetic
+    acados_tic(&timer);
+    for (rep = 0; rep < NREP; rep++)
+    {
+        bench_fun(arg, res, NULL, NULL, NULL);
+        d_cvt_casadi_to_dmat_ref(res[0], sparsity_jac, &jac_ref);
+    }
+    time_ref = acados_toc(&timer) / NREP;
+
+    /************************************************
+     * check
+     ************************************************/
+
+    int err = 0;
+    for (jj = 0; jj < NV; jj++)
+        for (ii = 0; ii < NX; ii++)
+            if (BLASFEO_DMATEL(&jac, ii, jj) != BLASFEO_DMATEL(&jac_ref, ii, jj))
+                err++;
+
+    printf("jacobian %d x %d, nnz %d\n", NX, NV, sparsity_jac[NV + 2]);
+    printf("scatter tables:   %e s per call\n", time_tables);
+    printf("element indexing: %e s per call\n", time_ref);
+    printf("speedup:          %f\n", time_ref / time_tables);
+    printf("mismatches:       %d\n\n", err);
+
+    free(fun_mem);
+    free(jac_mem);
+    free(jac_ref_mem);
+
+    if (err > 0)
+        return 1;
+
+    return 0;
+}
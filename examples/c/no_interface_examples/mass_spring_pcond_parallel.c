@@ -0,0 +1,167 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// external
+#include <stdio.h>
+#include <stdlib.h>
+
+// acados
+#include <acados/utils/print.h>
+
+// c interface
+#include <acados_c/ocp_qp_interface.h>
+
+// mass spring helper functions
+ocp_qp_xcond_solver_dims *create_ocp_qp_dims_mass_spring(ocp_qp_xcond_solver_config *config, int N, int nx_, int nu_, int nb_, int ng_, int ngN);
+ocp_qp_in *create_ocp_qp_in_mass_spring(ocp_qp_dims *dims);
+
+#define NREP 20
+
+
+
+int main() {
+    printf("\n");
+    printf("\n");
+    printf("\n");
+    printf(" mass spring example: serial vs block-parallel partial condensing\n");
+    printf("\n");
+    printf("\n");
+    printf("\n");
+
+    /************************************************
+     * set up dimensions
+     ************************************************/
+
+    int nx_ = 8;   // number of states (it has to be even for the mass-spring system test problem)
+
+    int nu_ = 3;   // number of inputs (controllers) (it has to be at least 1 and
+                   // at most nx_/2 for the mass-spring system test problem)
+
+    int nb_ = 11;  // number of box constrained inputs and states
+    int ng_ = 0;   // number of general constraints
+    int ngN = 0;   // number of general constraints at last stage
+
+    int num_N_values = 4;
+    int N_values[4] = {100, 200, 300, 400};
+
+    int max_iter = 30;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    int status = 0;
+
+    printf("\n%5s %5s %15s %15s %10s %15s\n", "N", "N2", "cond serial", "cond parallel",
+           "speedup", "max res diff");
+
+    for (int jj = 0; jj < num_N_values; jj++)
+    {
+        int N = N_values[jj];
+        int N2 = N / 10;
+
+        double min_cond_time[2];
+        double res[2][4];
+
+        for (int par_blocks = 0; par_blocks < 2; par_blocks++)
+        {
+            ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+            ocp_qp_xcond_solver_dims *qp_dims = create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+            ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+
+            ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+            ocp_qp_xcond_solver_opts *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+
+            config->opts_set(config, opts, "cond_N", &N2);
+            config->opts_set(config, opts, "cond_par_blocks", &par_blocks);
+            config->opts_set(config, opts, "iter_max", &max_iter);
+
+            ocp_qp_solver *qp_solver = ocp_qp_create(config, qp_dims, opts);
+
+            qp_info *info = (qp_info *) qp_out->misc;
+
+            int acados_return = 0;
+
+            // run QP solver NREP times and record min condensing time
+            for (int rep = 0; rep < NREP; rep++)
+            {
+                acados_return += ocp_qp_solve(qp_solver, qp_in, qp_out);
+
+                if (rep == 0 || info->condensing_time < min_cond_time[par_blocks])
+                    min_cond_time[par_blocks] = info->condensing_time;
+            }
+
+            if (acados_return != 0)
+            {
+                printf("\nerror: mass_spring_pcond_parallel: QP solver failed, N = %d, par_blocks = %d\n",
+                       N, par_blocks);
+                status = 1;
+            }
+
+            ocp_qp_inf_norm_residuals(qp_dims->orig_dims, qp_in, qp_out, res[par_blocks]);
+
+            free(qp_solver);
+            ocp_qp_xcond_solver_opts_free(opts);
+            ocp_qp_out_free(qp_out);
+            ocp_qp_in_free(qp_in);
+            ocp_qp_xcond_solver_dims_free(qp_dims);
+            ocp_qp_xcond_solver_config_free(config);
+        }
+
+        // both variants have to converge to the same solution
+        double max_res_diff = 0.0;
+        for (int ii = 0; ii < 4; ii++)
+        {
+            double tmp = res[1][ii] - res[0][ii];
+            tmp = tmp > 0.0 ? tmp : -tmp;
+            max_res_diff = tmp > max_res_diff ? tmp : max_res_diff;
+        }
+
+        printf("%5d %5d %15e %15e %10.2f %15e\n", N, N2, min_cond_time[0], min_cond_time[1],
+               min_cond_time[0] / min_cond_time[1], max_res_diff);
+
+        if (max_res_diff > 1e-8)
+        {
+            printf("\nerror: mass_spring_pcond_parallel: serial and parallel residuals differ, N = %d\n",
+                   N);
+            status = 1;
+        }
+    }
+
+    if (status == 0)
+        printf("\nsuccess!\n\n");
+
+    return status;
+}
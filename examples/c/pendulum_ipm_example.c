@@ -0,0 +1,300 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// getting started with the interior point nlp solver: swing-up of the pendulum on a cart from an
+// initial angle, solved with IPM and with SQP (partial condensing hpipm), the solutions are compared
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "acados/utils/timing.h"
+
+#include "acados_c/ocp_nlp_interface.h"
+#include "acados_c/external_function_interface.h"
+
+#include "pendulum_model/pendulum_model.h"
+
+#define NX 4
+#define NU 1
+#define N 20
+
+
+
+// solves the pendulum ocp with the given nlp solver, returns the solver status
+static int pendulum_solve(ocp_nlp_solver_t nlp_solver, double *x_sol, double *u_sol)
+{
+    int nx[N+1], nu[N+1], nz[N+1], ns[N+1];
+    int ny[N+1], nbx[N+1], nbu[N+1];
+    int zero = 0;
+
+    for (int i = 0; i <= N; i++)
+    {
+        nx[i] = NX;
+        nu[i] = i < N ? NU : 0;
+        nz[i] = 0;
+        ns[i] = 0;
+        ny[i] = i < N ? NX + NU : NX;
+        nbx[i] = i == 0 ? NX : 0;
+        nbu[i] = i < N ? NU : 0;
+    }
+
+    /************************************************
+    * plan + config
+    ************************************************/
+
+    ocp_nlp_plan *plan = ocp_nlp_plan_create(N);
+
+    plan->nlp_solver = nlp_solver;
+    plan->ocp_qp_solver_plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    for (int i = 0; i <= N; i++)
+    {
+        plan->nlp_cost[i] = LINEAR_LS;
+        plan->nlp_constraints[i] = BGH;
+    }
+    for (int i = 0; i < N; i++)
+    {
+        plan->nlp_dynamics[i] = CONTINUOUS_MODEL;
+        plan->sim_solver_plan[i].sim_solver = ERK;
+    }
+
+    ocp_nlp_config *config = ocp_nlp_config_create(*plan);
+
+    /************************************************
+    * dims
+    ************************************************/
+
+    ocp_nlp_dims *dims = ocp_nlp_dims_create(config);
+
+    ocp_nlp_dims_set_opt_vars(config, dims, "nx", nx);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nu", nu);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nz", nz);
+    ocp_nlp_dims_set_opt_vars(config, dims, "ns", ns);
+
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_dims_set_cost(config, dims, i, "ny", &ny[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nbx", &nbx[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nbu", &nbu[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "ng", &zero);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nh", &zero);
+    }
+
+    /************************************************
+    * dynamics
+    ************************************************/
+
+    external_function_casadi expl_vde_for;
+    expl_vde_for.casadi_fun = &pendulum_ode_expl_vde_forw;
+    expl_vde_for.casadi_work = &pendulum_ode_expl_vde_forw_work;
+    expl_vde_for.casadi_sparsity_in = &pendulum_ode_expl_vde_forw_sparsity_in;
+    expl_vde_for.casadi_sparsity_out = &pendulum_ode_expl_vde_forw_sparsity_out;
+    expl_vde_for.casadi_n_in = &pendulum_ode_expl_vde_forw_n_in;
+    expl_vde_for.casadi_n_out = &pendulum_ode_expl_vde_forw_n_out;
+    external_function_casadi_create(&expl_vde_for);
+
+    /************************************************
+    * nlp_in
+    ************************************************/
+
+    ocp_nlp_in *nlp_in = ocp_nlp_in_create(config, dims);
+
+    double Ts = 0.05;
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_in_set(config, dims, nlp_in, i, "Ts", &Ts);
+        ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "expl_vde_for", &expl_vde_for);
+    }
+
+    // cost: y = [x; u], W = diag(1e3, 1e3, 1e-2, 1e-2, 1e-2)
+    double Vx[(NX+NU)*NX] = {0};
+    double Vu[(NX+NU)*NU] = {0};
+    double W[(NX+NU)*(NX+NU)] = {0};
+    double yref[NX+NU] = {0};
+    double VxN[NX*NX] = {0};
+    double WN[NX*NX] = {0};
+
+    for (int ii = 0; ii < NX; ii++)
+    {
+        Vx[ii+(NX+NU)*ii] = 1.0;
+        VxN[ii+NX*ii] = 1.0;
+    }
+    Vu[NX] = 1.0;
+    W[0+(NX+NU)*0] = 1e3;
+    W[1+(NX+NU)*1] = 1e3;
+    W[2+(NX+NU)*2] = 1e-2;
+    W[3+(NX+NU)*3] = 1e-2;
+    W[4+(NX+NU)*4] = 1e-2;
+    for (int ii = 0; ii < NX; ii++)
+        WN[ii+NX*ii] = W[ii+(NX+NU)*ii];
+
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "Vx", Vx);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "Vu", Vu);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "W", W);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "yref", yref);
+    }
+    ocp_nlp_cost_model_set(config, dims, nlp_in, N, "Vx", VxN);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, N, "W", WN);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, N, "yref", yref);
+
+    // constraints: initial state, input bounds (active in the first stages)
+    int idxbx0[NX] = {0, 1, 2, 3};
+    double x0[NX] = {0.0, 0.3, 0.0, 0.0};
+    int idxbu[NU] = {0};
+    double lbu[NU] = {-20.0};
+    double ubu[NU] = {20.0};
+
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbx", x0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubx", x0);
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "idxbu", idxbu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "lbu", lbu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "ubu", ubu);
+    }
+
+    /************************************************
+    * nlp_out
+    ************************************************/
+
+    ocp_nlp_out *nlp_out = ocp_nlp_out_create(config, dims);
+
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_out_set(config, dims, nlp_out, i, "x", x0);
+
+    /************************************************
+    * opts
+    ************************************************/
+
+    void *nlp_opts = ocp_nlp_solver_opts_create(config, dims);
+
+    int num_steps = 2;
+    int ns_erk = 4;
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_solver_opts_set_at_stage(config, nlp_opts, i, "dynamics_num_steps", &num_steps);
+        ocp_nlp_solver_opts_set_at_stage(config, nlp_opts, i, "dynamics_ns", &ns_erk);
+    }
+
+    int max_iter = 100;
+    double tol = 1e-8;
+    ocp_nlp_solver_opts_set(config, nlp_opts, "max_iter", &max_iter);
+    ocp_nlp_solver_opts_set(config, nlp_opts, "tol_stat", &tol);
+    ocp_nlp_solver_opts_set(config, nlp_opts, "tol_eq", &tol);
+    ocp_nlp_solver_opts_set(config, nlp_opts, "tol_ineq", &tol);
+    ocp_nlp_solver_opts_set(config, nlp_opts, "tol_comp", &tol);
+
+    ocp_nlp_solver_opts_update(config, dims, nlp_opts);
+
+    /************************************************
+    * solve
+    ************************************************/
+
+    ocp_nlp_solver *solver = ocp_nlp_solver_create(config, dims, nlp_opts);
+
+    int status = ocp_nlp_precompute(solver, nlp_in, nlp_out);
+    if (status == 0)
+    {
+        acados_timer timer;
+        acados_tic(&timer);
+        status = ocp_nlp_solve(solver, nlp_in, nlp_out);
+        double time = acados_toc(&timer);
+
+        int iter;
+        ocp_nlp_get(config, solver, "sqp_iter", &iter);
+        printf("\n%s: status = %d, iterations = %d, time = %f ms\n",
+               nlp_solver == IPM ? "IPM" : "SQP", status, iter, 1e3*time);
+    }
+
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_out_get(config, dims, nlp_out, i, "x", x_sol + i*NX);
+    for (int i = 0; i < N; i++)
+        ocp_nlp_out_get(config, dims, nlp_out, i, "u", u_sol + i*NU);
+
+    /************************************************
+    * free memory
+    ************************************************/
+
+    ocp_nlp_solver_destroy(solver);
+    ocp_nlp_solver_opts_destroy(nlp_opts);
+    ocp_nlp_out_destroy(nlp_out);
+    ocp_nlp_in_destroy(nlp_in);
+    ocp_nlp_dims_destroy(dims);
+    ocp_nlp_config_destroy(config);
+    ocp_nlp_plan_destroy(plan);
+    external_function_casadi_free(&expl_vde_for);
+
+    return status;
+}
+
+
+
+int main()
+{
+    double x_ipm[(N+1)*NX], u_ipm[N*NU];
+    double x_sqp[(N+1)*NX], u_sqp[N*NU];
+
+    int status_ipm = pendulum_solve(IPM, x_ipm, u_ipm);
+    int status_sqp = pendulum_solve(SQP, x_sqp, u_sqp);
+
+    printf("\nu (IPM)\n");
+    for (int i = 0; i < N; i++)
+        printf("%e\n", u_ipm[i*NU]);
+
+    if (status_ipm != 0 || status_sqp != 0)
+    {
+        printf("\nerror: pendulum_ipm_example: solver failed, status IPM %d, SQP %d\n",
+               status_ipm, status_sqp);
+        return 1;
+    }
+
+    double err = 0.0;
+    for (int ii = 0; ii < (N+1)*NX; ii++)
+        err = fmax(err, fabs(x_ipm[ii] - x_sqp[ii]));
+    for (int ii = 0; ii < N*NU; ii++)
+        err = fmax(err, fabs(u_ipm[ii] - u_sqp[ii]));
+
+    printf("\nmax difference between the IPM and SQP solutions: %e\n\n", err);
+
+    if (err > 1e-4)
+    {
+        printf("error: pendulum_ipm_example: IPM and SQP solutions differ\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -59,6 +59,11 @@
 #define MAX_SQP_ITERS 10
 #define NREP 1
 
+// partial tightening: the constraints of the stages >= TIGHTENING_STAGE are replaced by a
+// log-barrier in the qp, 0 keeps all constraints hard (compare the total qp iterations)
+#define TIGHTENING_STAGE 0
+#define TIGHTENING_MU 1e-2
+
 
 
 static void shift_states(ocp_nlp_dims *dims, ocp_nlp_out *out, double *x_end)
@@ -233,6 +238,7 @@ int main()
     int nu[NN+1] = {}; // inputs
     int nz[NN+1] = {}; // algebraic variables
     int ns[NN+1] = {}; // slacks
+    int np_stage[NN+1] = {}; // parameters of the external functions (wind)
     // cost
     int ny[NN+1] = {}; // measurements
     // constraints
@@ -267,6 +273,7 @@ int main()
         ns[i] = nsh[i];
         ny[i] = 4;
         nz[i] = 0;
+        np_stage[i] = np;
     }
 
     nx[NN] = nx_;
@@ -576,6 +583,7 @@ int main()
     ocp_nlp_dims_set_opt_vars(config, dims, "nu", nu);
     ocp_nlp_dims_set_opt_vars(config, dims, "nz", nz);
     ocp_nlp_dims_set_opt_vars(config, dims, "ns", ns);
+    ocp_nlp_dims_set_opt_vars(config, dims, "np", np_stage);
 
     for (int i = 0; i <= NN; i++)
     {
@@ -821,6 +829,21 @@ int main()
 		ocp_nlp_solver_opts_set(config, nlp_opts, "tol_ineq", &tol_ineq);
 		ocp_nlp_solver_opts_set(config, nlp_opts, "tol_comp", &tol_comp);
     }
+
+	if (TIGHTENING_STAGE > 0)
+	{
+		int tightening_stage = TIGHTENING_STAGE;
+		double tightening_mu = TIGHTENING_MU;
+		ocp_nlp_solver_opts_set(config, nlp_opts, "tightening_stage", &tightening_stage);
+		ocp_nlp_solver_opts_set(config, nlp_opts, "tightening_mu", &tightening_mu);
+
+		// the barrier terms keep the complementarity residual at the order of mu
+		if (plan->nlp_solver == SQP)
+		{
+			double tol_comp = 10*TIGHTENING_MU;
+			ocp_nlp_solver_opts_set(config, nlp_opts, "tol_comp", &tol_comp);
+		}
+	}
     else if (plan->nlp_solver == SQP_RTI)
     {
 
@@ -920,6 +943,8 @@ int main()
 	double *x_sim = malloc(nx_*(n_sim+1)*sizeof(double));
 	double *u_sim = malloc(nu_*(n_sim+0)*sizeof(double));
 
+	int qp_iter_tot = 0;
+
     acados_timer timer;
     acados_tic(&timer);
 
@@ -970,6 +995,7 @@ int main()
                     printf("\nWrong sim name\n\n");
                     exit(1);
                 }
+                ocp_nlp_in_set(config, dims, nlp_in, ii, "parameter_values", wind0_ref+idx+ii);
             }
             // update reference
             for (int i = 0; i <= NN; i++)
@@ -1009,6 +1035,21 @@ int main()
                 printf("\nproblem #%d, status %d, iters %d, time (total %f, lin %f, qp_sol %f) ms\n",
                     idx, status, sqp_iter, time_tot*1e3, time_lin*1e3, time_qp_sol*1e3);
 
+				if (plan->nlp_solver == SQP)
+				{
+					double *stat;
+					int stat_m, stat_n;
+					ocp_nlp_get(config, solver, "stat", &stat);
+					ocp_nlp_get(config, solver, "stat_m", &stat_m);
+					ocp_nlp_get(config, solver, "stat_n", &stat_n);
+					for (int ii = 1; ii <= sqp_iter && ii < stat_m; ii++)
+						qp_iter_tot += (int) stat[stat_n*ii+5];
+				}
+				else
+				{
+					qp_iter_tot += nlp_out->qp_iter;
+				}
+
                 printf("xsim = \n");
                 ocp_nlp_out_get(config, dims, nlp_out, 0, "x", x_end);
                 d_print_mat(1, nx[0], x_end, 1);
@@ -1041,6 +1082,7 @@ int main()
     double time = acados_toc(&timer)/NREP;
 
     printf("\n\ntotal time (including printing) = %f ms (time per SQP = %f)\n\n", time*1e3, time*1e3/n_sim);
+	printf("total qp iterations = %d (tightening stage %d)\n\n", qp_iter_tot, TIGHTENING_STAGE);
 
 #if 0
 	d_print_mat(nx_, n_sim+1, x_sim, nx_);
@@ -36,6 +36,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
 #include "acados_c/external_function_interface.h"
 
 #include "acados/utils/external_function_generic.h"
@@ -182,3 +188,420 @@ void external_function_param_casadi_free_array(int size, external_function_param
 
     return;
 }
+
+
+
+/************************************************
+ * casadi external function batched over nodes
+ ************************************************/
+
+void external_function_casadi_batch_create(external_function_casadi_batch *fun, int num_nodes,
+                                           int np, external_function_casadi_batch_node *nodes)
+{
+    int fun_size = external_function_casadi_batch_calculate_size(fun, num_nodes, np);
+    void *fun_mem = acados_malloc(1, fun_size);
+    external_function_casadi_batch_assign(fun, fun_mem);
+
+    for (int ii = 0; ii < num_nodes; ii++)
+        external_function_casadi_batch_node_set(nodes + ii, fun, ii);
+
+    return;
+}
+
+
+
+void external_function_casadi_batch_free(external_function_casadi_batch *fun)
+{
+    free(fun->ptr_ext_mem);
+
+    return;
+}
+
+
+
+/************************************************
+ * bytecode external function
+ ************************************************/
+
+void external_function_bytecode_create(external_function_bytecode *fun)
+{
+    int fun_size = external_function_bytecode_calculate_size(fun);
+    void *fun_mem = acados_malloc(1, fun_size);
+    external_function_bytecode_assign(fun, fun_mem);
+
+    return;
+}
+
+
+
+// reads the sparsity patterns of num matrices: length followed by the casadi sparsity
+static int bytecode_read_sparsity(FILE *file, int num, int **sparsity, int *buf, int buf_len,
+                                  int *pos)
+{
+    int ii, jj, len;
+
+    for (ii = 0; ii < num; ii++)
+    {
+        if (fscanf(file, "%d", &len) != 1 || len < 3 || *pos + len > buf_len)
+            return 1;
+        sparsity[ii] = buf + *pos;
+        for (jj = 0; jj < len; jj++)
+            if (fscanf(file, "%d", buf + *pos + jj) != 1)
+                return 1;
+        // dense: nrow, ncol, 1; sparse: nrow, ncol, colind[ncol+1], row[nnz]
+        int *sp = sparsity[ii];
+        if (sp[0] < 0 || sp[1] < 0)
+            return 1;
+        if (sp[2] ? len != 3 : (sp[1] + 3 > len || len != sp[1] + 3 + sp[sp[1] + 2]))
+            return 1;
+        if (!sp[2])
+        {
+            // column pointers nondecreasing from 0 to nnz, row indices within the rows
+            int *colind = sp + 2;
+            int *row = sp + sp[1] + 3;
+            if (colind[0] != 0)
+                return 1;
+            for (jj = 0; jj < sp[1]; jj++)
+                if (colind[jj + 1] < colind[jj])
+                    return 1;
+            for (jj = 0; jj < colind[sp[1]]; jj++)
+                if (row[jj] < 0 || row[jj] >= sp[0])
+                    return 1;
+        }
+        *pos += len;
+    }
+
+    return 0;
+}
+
+
+
+int external_function_bytecode_create_from_file(external_function_bytecode *fun, const char *path)
+{
+    int ii, version, in_num, out_num, sp_len, reg_num, op_num;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        printf("\nexternal_function_bytecode_create_from_file: cannot open %s\n\n", path);
+        return 1;
+    }
+
+    // header: version, number of inputs and outputs, total length of the sparsity patterns,
+    // number of registers and of instructions
+    if (fscanf(file, "acados_bytecode %d %d %d %d %d %d", &version, &in_num, &out_num, &sp_len,
+               &reg_num, &op_num) != 6 || version != 1 || in_num < 0 || out_num < 0 ||
+        sp_len < 0 || reg_num < 0 || op_num < 0)
+    {
+        printf("\nexternal_function_bytecode_create_from_file: invalid header in %s\n\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    // program memory
+    int size = (in_num + out_num) * sizeof(int *) + op_num * sizeof(double)
+             + (sp_len + 4 * op_num) * sizeof(int);
+    char *program_mem = acados_malloc(1, size);
+    char *c_ptr = program_mem;
+
+    int **sparsity_in = (int **) c_ptr;
+    c_ptr += in_num * sizeof(int *);
+    int **sparsity_out = (int **) c_ptr;
+    c_ptr += out_num * sizeof(int *);
+    double *op_cst = (double *) c_ptr;
+    c_ptr += op_num * sizeof(double);
+    int *op = (int *) c_ptr;
+    c_ptr += op_num * sizeof(int);
+    int *op_arg = (int *) c_ptr;
+    c_ptr += 3 * op_num * sizeof(int);
+    int *sp = (int *) c_ptr;
+
+    int sp_pos = 0;
+    int status = bytecode_read_sparsity(file, in_num, sparsity_in, sp, sp_len, &sp_pos);
+    if (!status)
+        status = bytecode_read_sparsity(file, out_num, sparsity_out, sp, sp_len, &sp_pos);
+
+    // instructions: op dst a b constant
+    for (ii = 0; ii < op_num && !status; ii++)
+    {
+        if (fscanf(file, "%d %d %d %d %lf", op + ii, op_arg + 3 * ii, op_arg + 3 * ii + 1,
+                   op_arg + 3 * ii + 2, op_cst + ii) != 5)
+            status = 1;
+    }
+
+    fclose(file);
+
+    if (status)
+    {
+        printf("\nexternal_function_bytecode_create_from_file: invalid program in %s\n\n", path);
+        free(program_mem);
+        return 1;
+    }
+
+    external_function_bytecode_set_program(fun, in_num, (const int **) sparsity_in, out_num,
+            (const int **) sparsity_out, reg_num, op_num, op, op_arg, op_cst);
+    fun->ptr_program = program_mem;
+
+    external_function_bytecode_create(fun);
+
+    return 0;
+}
+
+
+
+void external_function_bytecode_free(external_function_bytecode *fun)
+{
+    free(fun->ptr_ext_mem);
+    free(fun->ptr_program);
+
+    return;
+}
+
+
+
+/************************************************
+ * dynamic loading of generated model libraries
+ ************************************************/
+
+void *external_function_library_open(const char *path)
+{
+#if defined(_WIN32)
+    void *lib = (void *) LoadLibraryA(path);
+    if (lib == NULL)
+        printf("\nexternal_function_library_open: cannot open %s\n\n", path);
+#else
+    void *lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (lib == NULL)
+        printf("\nexternal_function_library_open: %s\n\n", dlerror());
+#endif
+
+    return lib;
+}
+
+
+
+void external_function_library_close(void *lib)
+{
+    if (lib == NULL)
+        return;
+
+#if defined(_WIN32)
+    FreeLibrary((HMODULE) lib);
+#else
+    dlclose(lib);
+#endif
+
+    return;
+}
+
+
+
+// the functions exported by casadi generated code
+typedef struct
+{
+    int (*fun)(const double **, double **, int *, double *, void *);
+    int (*work)(int *, int *, int *, int *);
+    const int *(*sparsity_in)(int);
+    const int *(*sparsity_out)(int);
+    int (*n_in)();
+    int (*n_out)();
+} casadi_symbols;
+
+
+
+static void *library_symbol(void *lib, const char *name, const char *suffix)
+{
+    char sym_name[256];
+    snprintf(sym_name, sizeof(sym_name), "%s%s", name, suffix);
+
+#if defined(_WIN32)
+    void *sym = (void *) GetProcAddress((HMODULE) lib, sym_name);
+#else
+    void *sym = dlsym(lib, sym_name);
+#endif
+
+    if (sym == NULL)
+        printf("\nexternal_function_casadi_load: symbol %s not found\n\n", sym_name);
+
+    return sym;
+}
+
+
+
+static int casadi_symbols_load(void *lib, const char *name, casadi_symbols *sym)
+{
+    if (lib == NULL)
+        return 1;
+
+    *(void **) (&sym->fun) = library_symbol(lib, name, "");
+    *(void **) (&sym->work) = library_symbol(lib, name, "_work");
+    *(void **) (&sym->sparsity_in) = library_symbol(lib, name, "_sparsity_in");
+    *(void **) (&sym->sparsity_out) = library_symbol(lib, name, "_sparsity_out");
+    *(void **) (&sym->n_in) = library_symbol(lib, name, "_n_in");
+    *(void **) (&sym->n_out) = library_symbol(lib, name, "_n_out");
+
+    if (sym->fun == NULL || sym->work == NULL || sym->sparsity_in == NULL ||
+        sym->sparsity_out == NULL || sym->n_in == NULL || sym->n_out == NULL)
+        return 1;
+
+    return 0;
+}
+
+
+
+static int casadi_sparsity_equal(const int *sp0, const int *sp1)
+{
+    int ii;
+
+    if (sp0 == NULL || sp1 == NULL)
+        return sp0 == sp1;
+
+    // nrow, ncol, dense flag
+    for (ii = 0; ii < 3; ii++)
+        if (sp0[ii] != sp1[ii])
+            return 0;
+
+    if (sp0[2])  // dense
+        return 1;
+
+    // column pointers and row indices
+    int ncol = sp0[1];
+    int len = ncol + 1 + sp0[2 + ncol];
+    for (ii = 0; ii < len; ii++)
+        if (sp0[2 + ii] != sp1[2 + ii])
+            return 0;
+
+    return 1;
+}
+
+
+
+// check that the new symbols fit in the memory allocated for the old ones
+static int casadi_symbols_compatible(casadi_symbols *sym, const int *(*sparsity_in)(int),
+                                     const int *(*sparsity_out)(int), int in_num, int out_num,
+                                     int args_num, int res_num, int iw_size, int w_size)
+{
+    int ii;
+    int args_num_new, res_num_new, iw_size_new, w_size_new;
+
+    if (sym->n_in() != in_num || sym->n_out() != out_num)
+    {
+        printf("\nexternal_function_casadi_swap: number of inputs or outputs differs\n\n");
+        return 0;
+    }
+
+    sym->work(&args_num_new, &res_num_new, &iw_size_new, &w_size_new);
+    if (args_num_new != args_num || res_num_new != res_num || iw_size_new > iw_size ||
+        w_size_new > w_size)
+    {
+        printf("\nexternal_function_casadi_swap: work space does not fit\n\n");
+        return 0;
+    }
+
+    for (ii = 0; ii < in_num; ii++)
+    {
+        if (!casadi_sparsity_equal(sym->sparsity_in(ii), sparsity_in(ii)))
+        {
+            printf("\nexternal_function_casadi_swap: sparsity of input %d differs\n\n", ii);
+            return 0;
+        }
+    }
+    for (ii = 0; ii < out_num; ii++)
+    {
+        if (!casadi_sparsity_equal(sym->sparsity_out(ii), sparsity_out(ii)))
+        {
+            printf("\nexternal_function_casadi_swap: sparsity of output %d differs\n\n", ii);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+
+int external_function_casadi_load(external_function_casadi *fun, void *lib, const char *name)
+{
+    casadi_symbols sym;
+
+    if (casadi_symbols_load(lib, name, &sym))
+        return 1;
+
+    external_function_casadi_set_fun(fun, sym.fun);
+    external_function_casadi_set_work(fun, sym.work);
+    external_function_casadi_set_sparsity_in(fun, sym.sparsity_in);
+    external_function_casadi_set_sparsity_out(fun, sym.sparsity_out);
+    external_function_casadi_set_n_in(fun, sym.n_in);
+    external_function_casadi_set_n_out(fun, sym.n_out);
+
+    return 0;
+}
+
+
+
+int external_function_casadi_swap(external_function_casadi *fun, void *lib, const char *name)
+{
+    casadi_symbols sym;
+
+    if (casadi_symbols_load(lib, name, &sym))
+        return 1;
+
+    if (!casadi_symbols_compatible(&sym, fun->casadi_sparsity_in, fun->casadi_sparsity_out,
+            fun->in_num, fun->out_num, fun->args_num, fun->res_num, fun->iw_size, fun->w_size))
+        return 1;
+
+    // the index tables and the argument sizes only depend on the (unchanged) sparsity patterns
+    external_function_casadi_set_fun(fun, sym.fun);
+    external_function_casadi_set_work(fun, sym.work);
+    external_function_casadi_set_sparsity_in(fun, sym.sparsity_in);
+    external_function_casadi_set_sparsity_out(fun, sym.sparsity_out);
+    external_function_casadi_set_n_in(fun, sym.n_in);
+    external_function_casadi_set_n_out(fun, sym.n_out);
+
+    return 0;
+}
+
+
+
+int external_function_param_casadi_load(external_function_param_casadi *fun, void *lib,
+                                        const char *name)
+{
+    casadi_symbols sym;
+
+    if (casadi_symbols_load(lib, name, &sym))
+        return 1;
+
+    external_function_param_casadi_set_fun(fun, sym.fun);
+    external_function_param_casadi_set_work(fun, sym.work);
+    external_function_param_casadi_set_sparsity_in(fun, sym.sparsity_in);
+    external_function_param_casadi_set_sparsity_out(fun, sym.sparsity_out);
+    external_function_param_casadi_set_n_in(fun, sym.n_in);
+    external_function_param_casadi_set_n_out(fun, sym.n_out);
+
+    return 0;
+}
+
+
+
+int external_function_param_casadi_swap(external_function_param_casadi *fun, void *lib,
+                                        const char *name)
+{
+    casadi_symbols sym;
+
+    if (casadi_symbols_load(lib, name, &sym))
+        return 1;
+
+    // the parameters are the last input, so the number of parameters is checked as well
+    if (!casadi_symbols_compatible(&sym, fun->casadi_sparsity_in, fun->casadi_sparsity_out,
+            fun->in_num, fun->out_num, fun->args_num, fun->res_num, fun->iw_size, fun->w_size))
+        return 1;
+
+    external_function_param_casadi_set_fun(fun, sym.fun);
+    external_function_param_casadi_set_work(fun, sym.work);
+    external_function_param_casadi_set_sparsity_in(fun, sym.sparsity_in);
+    external_function_param_casadi_set_sparsity_out(fun, sym.sparsity_out);
+    external_function_param_casadi_set_n_in(fun, sym.n_in);
+    external_function_param_casadi_set_n_out(fun, sym.n_out);
+
+    return 0;
+}
@@ -68,6 +68,52 @@ void external_function_param_casadi_create_array(int size, external_function_par
 //
 void external_function_param_casadi_free_array(int size, external_function_param_casadi *funs);
 
+/************************************************
+ * casadi external function batched over nodes
+ ************************************************/
+
+// allocates the batch of functions with np parameters and sets nodes[k] as the handle of node k,
+// k = 0, ..., num_nodes-1
+void external_function_casadi_batch_create(external_function_casadi_batch *fun, int num_nodes,
+                                           int np, external_function_casadi_batch_node *nodes);
+//
+void external_function_casadi_batch_free(external_function_casadi_batch *fun);
+
+/************************************************
+ * bytecode external function
+ ************************************************/
+
+//
+void external_function_bytecode_create(external_function_bytecode *fun);
+// reads the program written by acados_template/generate_bytecode.py and creates the function;
+// returns 0 on success
+int external_function_bytecode_create_from_file(external_function_bytecode *fun, const char *path);
+//
+void external_function_bytecode_free(external_function_bytecode *fun);
+
+/************************************************
+ * dynamic loading of generated model libraries
+ ************************************************/
+
+// opens the shared library at path; returns NULL on failure
+void *external_function_library_open(const char *path);
+//
+void external_function_library_close(void *lib);
+// sets the casadi function name (and name_work, name_sparsity_in, ...) from lib into fun, to be
+// called before create; returns 0 on success
+int external_function_casadi_load(external_function_casadi *fun, void *lib, const char *name);
+// replaces the casadi function of the created fun by name from lib, if it has the same inputs,
+// outputs and sparsity patterns and fits in the allocated work space; the memory of fun is kept,
+// so it can be called between two solves; returns 0 on success, otherwise fun is unchanged;
+// the library of the replaced function has to be closed only after the swap
+int external_function_casadi_swap(external_function_casadi *fun, void *lib, const char *name);
+//
+int external_function_param_casadi_load(external_function_param_casadi *fun, void *lib,
+                                        const char *name);
+//
+int external_function_param_casadi_swap(external_function_param_casadi *fun, void *lib,
+                                        const char *name);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -56,6 +56,7 @@
 #include "acados/ocp_nlp/ocp_nlp_reg_noreg.h"
 #include "acados/ocp_nlp/ocp_nlp_sqp.h"
 #include "acados/ocp_nlp/ocp_nlp_sqp_rti.h"
+#include "acados/ocp_nlp/ocp_nlp_ipm.h"
 #include "acados/utils/mem.h"
 
 
@@ -63,7 +64,7 @@
 * plan
 ************************************************/
 
-static int ocp_nlp_plan_calculate_size(int N)
+int ocp_nlp_plan_calculate_size(int N)
 {
     // N - number of shooting nodes
     int bytes = sizeof(ocp_nlp_plan);
@@ -76,7 +77,7 @@ static int ocp_nlp_plan_calculate_size(int N)
 
 
 
-static ocp_nlp_plan *ocp_nlp_plan_assign(int N, void *raw_memory)
+static ocp_nlp_plan *ocp_nlp_plan_assign_self(int N, void *raw_memory)
 {
     char *c_ptr = (char *) raw_memory;
 
@@ -143,6 +144,17 @@ static void ocp_nlp_plan_initialize_default(ocp_nlp_plan *plan)
 
 
 
+ocp_nlp_plan *ocp_nlp_plan_assign(int N, void *raw_memory)
+{
+    ocp_nlp_plan *plan = ocp_nlp_plan_assign_self(N, raw_memory);
+
+    ocp_nlp_plan_initialize_default(plan);
+
+    return plan;
+}
+
+
+
 ocp_nlp_plan *ocp_nlp_plan_create(int N)
 {
     int bytes = ocp_nlp_plan_calculate_size(N);
@@ -150,8 +162,6 @@ ocp_nlp_plan *ocp_nlp_plan_create(int N)
 
     ocp_nlp_plan *plan = ocp_nlp_plan_assign(N, ptr);
 
-    ocp_nlp_plan_initialize_default(plan);
-
     return plan;
 }
 
@@ -168,15 +178,15 @@ void ocp_nlp_plan_destroy(void* plan_)
 * config
 ************************************************/
 
-ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
+ocp_nlp_config *ocp_nlp_config_assign_from_plan(ocp_nlp_plan plan, void *raw_memory)
 {
     int N = plan.N;
 
-    /* calculate_size & malloc & assign */
+    /* assign into zeroed memory: unset function pointers have to be NULL */
 
     int bytes = ocp_nlp_config_calculate_size(N);
-    void *config_mem = acados_calloc(1, bytes);
-    ocp_nlp_config *config = ocp_nlp_config_assign(N, config_mem);
+    memset(raw_memory, 0, bytes);
+    ocp_nlp_config *config = ocp_nlp_config_assign(N, raw_memory);
 
     /* initialize config according plan */
 
@@ -189,6 +199,9 @@ ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
         case SQP_RTI:
             ocp_nlp_sqp_rti_config_initialize_default(config);
             break;
+        case IPM:
+            ocp_nlp_ipm_config_initialize_default(config);
+            break;
         case INVALID_NLP_SOLVER:
             break;
             printf("\nerror: ocp_nlp_config_create: forgot to initialize plan->nlp_solver\n");
@@ -318,6 +331,19 @@ ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
 
 
 
+ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
+{
+    /* calculate_size & malloc & assign */
+
+    int bytes = ocp_nlp_config_calculate_size(plan.N);
+    void *config_mem = acados_calloc(1, bytes);
+    ocp_nlp_config *config = ocp_nlp_config_assign_from_plan(plan, config_mem);
+
+    return config;
+}
+
+
+
 void ocp_nlp_config_destroy(void *config_)
 {
     free(config_);
@@ -385,7 +411,34 @@ void ocp_nlp_in_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
     {
         double *Ts_values = value;
         for (ii=0; ii<N; ii++)
+        {
             in->Ts[ii] = *Ts_values;
+            in->dynamics_version[ii]++;
+        }
+    }
+    else if (!strcmp(field, "parameter_values"))
+    {
+        // the parameters themselves are set in the external functions, e.g. through set_param;
+        // keep a copy and mark all the models of the stage as modified
+        double *p = value;
+        for (ii = 0; ii < dims->np[stage]; ii++)
+            in->parameter_values[stage][ii] = p[ii];
+        if (stage < N)
+            in->dynamics_version[stage]++;
+        in->cost_version[stage]++;
+        in->constraints_version[stage]++;
+    }
+    else if (!strcmp(field, "ext_fun_batch"))
+    {
+        // evaluated at all the nodes before the linearization, independently of the stage
+        if (in->ext_fun_batch_num >= OCP_NLP_EXT_FUN_BATCH_MAX)
+        {
+            printf("\nerror: ocp_nlp_in_set: at most %d batched external functions\n",
+                   OCP_NLP_EXT_FUN_BATCH_MAX);
+            exit(1);
+        }
+        in->ext_fun_batch[in->ext_fun_batch_num] = value;
+        in->ext_fun_batch_num++;
     }
     else
     {
@@ -403,6 +456,7 @@ int ocp_nlp_dynamics_model_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_n
     ocp_nlp_dynamics_config *dynamics_config = config->dynamics[stage];
 
     dynamics_config->model_set(dynamics_config, dims->dynamics[stage], in->dynamics[stage], field, value);
+    in->dynamics_version[stage]++;
 
     return ACADOS_SUCCESS;
 }
@@ -414,6 +468,11 @@ int ocp_nlp_cost_model_set(ocp_nlp_config *config, ocp_nlp_dims *dims,
 {
     ocp_nlp_cost_config *cost_config = config->cost[stage];
 
+    // references and linear slack penalties only enter the qp vectors
+    if (strcmp(field, "y_ref") && strcmp(field, "yref") && strcmp(field, "z") &&
+        strcmp(field, "zl") && strcmp(field, "zu"))
+        in->cost_version[stage]++;
+
     return cost_config->model_set(cost_config, dims->cost[stage], in->cost[stage], field, value);
 
 }
@@ -425,6 +484,10 @@ int ocp_nlp_constraints_model_set(ocp_nlp_config *config, ocp_nlp_dims *dims,
 {
     ocp_nlp_constraints_config *constr_config = config->constraints[stage];
 
+    // bounds (lb*, ub*, lg, ug, ls*, us*, ...) only enter the qp vectors
+    if (field[0] != 'l' && field[0] != 'u')
+        in->constraints_version[stage]++;
+
     return constr_config->model_set(constr_config, dims->constraints[stage],
             in->constraints[stage], field, value);
 }
@@ -477,6 +540,11 @@ void ocp_nlp_out_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *ou
         double *double_values = value;
         blasfeo_pack_dvec(dims->nx[stage+1], double_values, &out->pi[stage], 0);
     }
+    else if (!strcmp(field, "lam"))
+    {
+        double *double_values = value;
+        blasfeo_pack_dvec(2*dims->ni[stage], double_values, &out->lam[stage], 0);
+    }
     else
     {
         printf("\nerror: ocp_nlp_out_set: field %s not available\n", field);
@@ -509,6 +577,11 @@ void ocp_nlp_out_get(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *ou
         double *double_values = value;
         blasfeo_unpack_dvec(dims->nx[stage+1], &out->pi[stage], 0, double_values);
     }
+    else if (!strcmp(field, "lam"))
+    {
+        double *double_values = value;
+        blasfeo_unpack_dvec(2*dims->ni[stage], &out->lam[stage], 0, double_values);
+    }
     else if ((!strcmp(field, "kkt_norm_inf")) || (!strcmp(field, "kkt_norm")))
     {
         double *double_values = value;
@@ -523,6 +596,388 @@ void ocp_nlp_out_get(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *ou
 
 
 
+/************************************************
+* field handles
+************************************************/
+
+static ocp_nlp_field_handle *ocp_nlp_field_handle_alloc(int N)
+{
+    int size = sizeof(ocp_nlp_field_handle);
+    size += (N + 1) * sizeof(struct blasfeo_dvec *);  // vec
+    size += 2 * (N + 1) * sizeof(int);                 // offset len
+    size += 8;
+
+    char *c_ptr = acados_calloc(1, size);
+
+    ocp_nlp_field_handle *handle = (ocp_nlp_field_handle *) c_ptr;
+    c_ptr += sizeof(ocp_nlp_field_handle);
+
+    align_char_to(8, &c_ptr);
+    handle->vec = (struct blasfeo_dvec **) c_ptr;
+    c_ptr += (N + 1) * sizeof(struct blasfeo_dvec *);
+    assign_and_advance_int(N + 1, &handle->offset, &c_ptr);
+    assign_and_advance_int(N + 1, &handle->len, &c_ptr);
+
+    handle->N = N;
+    handle->version = NULL;
+    handle->window = NULL;
+    handle->ptr = NULL;
+    handle->in = NULL;
+
+    return handle;
+}
+
+
+
+static void ocp_nlp_field_handle_finalize(ocp_nlp_field_handle *handle)
+{
+    handle->len_tot = 0;
+    for (int ii = 0; ii <= handle->N; ii++)
+        handle->len_tot += handle->len[ii];
+}
+
+
+
+ocp_nlp_field_handle *ocp_nlp_cost_model_field_create(ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_in *in, const char *field)
+{
+    int N = dims->N;
+
+    ocp_nlp_field_handle *handle = ocp_nlp_field_handle_alloc(N);
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        ocp_nlp_cost_config *cost_config = config->cost[ii];
+        if (cost_config->model_get_vec == NULL ||
+            cost_config->model_get_vec(cost_config, dims->cost[ii], in->cost[ii], field,
+                handle->vec + ii, handle->offset + ii, handle->len + ii) != ACADOS_SUCCESS)
+        {
+            printf("\nerror: ocp_nlp_cost_model_field_create: field %s not available as vector"
+                   " at stage %d\n", field, ii);
+            exit(1);
+        }
+    }
+
+    // same rule as in ocp_nlp_cost_model_set
+    if (strcmp(field, "y_ref") && strcmp(field, "yref") && strcmp(field, "z") &&
+        strcmp(field, "zl") && strcmp(field, "zu"))
+        handle->version = in->cost_version;
+
+    ocp_nlp_field_handle_finalize(handle);
+
+    return handle;
+}
+
+
+
+ocp_nlp_field_handle *ocp_nlp_constraints_model_field_create(ocp_nlp_config *config,
+        ocp_nlp_dims *dims, ocp_nlp_in *in, const char *field)
+{
+    int N = dims->N;
+
+    ocp_nlp_field_handle *handle = ocp_nlp_field_handle_alloc(N);
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        ocp_nlp_constraints_config *constr_config = config->constraints[ii];
+        if (constr_config->model_get_vec == NULL ||
+            constr_config->model_get_vec(constr_config, dims->constraints[ii],
+                in->constraints[ii], field, handle->vec + ii, handle->offset + ii,
+                handle->len + ii) != ACADOS_SUCCESS)
+        {
+            printf("\nerror: ocp_nlp_constraints_model_field_create: field %s not available as"
+                   " vector at stage %d\n", field, ii);
+            exit(1);
+        }
+    }
+
+    // same rule as in ocp_nlp_constraints_model_set
+    if (field[0] != 'l' && field[0] != 'u')
+        handle->version = in->constraints_version;
+
+    ocp_nlp_field_handle_finalize(handle);
+
+    return handle;
+}
+
+
+
+ocp_nlp_field_handle *ocp_nlp_in_field_create(ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_in *in, const char *field)
+{
+    int N = dims->N;
+
+    if (strcmp(field, "parameter_values"))
+    {
+        printf("\nerror: ocp_nlp_in_field_create: field %s not available\n", field);
+        exit(1);
+    }
+
+    ocp_nlp_field_handle *handle = ocp_nlp_field_handle_alloc(N);
+
+    handle->ptr = in->parameter_values;
+    handle->in = in;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        handle->vec[ii] = NULL;
+        handle->offset[ii] = 0;
+        handle->len[ii] = dims->np[ii];
+    }
+
+    ocp_nlp_field_handle_finalize(handle);
+
+    return handle;
+}
+
+
+
+// trajectory fields of ocp_nlp_out
+enum { OUT_TRAJ_X, OUT_TRAJ_U, OUT_TRAJ_Z, OUT_TRAJ_PI, OUT_TRAJ_LAM };
+
+static int ocp_nlp_out_traj_field(const char *field)
+{
+    if (!strcmp(field, "x"))
+        return OUT_TRAJ_X;
+    else if (!strcmp(field, "u"))
+        return OUT_TRAJ_U;
+    else if (!strcmp(field, "z"))
+        return OUT_TRAJ_Z;
+    else if (!strcmp(field, "pi"))
+        return OUT_TRAJ_PI;
+    else if (!strcmp(field, "lam"))
+        return OUT_TRAJ_LAM;
+    return -1;
+}
+
+
+
+// the stage arrays of out move along the ring buffer when shifting, so return their address
+static struct blasfeo_dvec **ocp_nlp_out_traj_window(ocp_nlp_out *out, int traj_field)
+{
+    switch (traj_field)
+    {
+        case OUT_TRAJ_X:
+        case OUT_TRAJ_U:
+            return &out->ux;
+        case OUT_TRAJ_Z:
+            return &out->z;
+        case OUT_TRAJ_PI:
+            return &out->pi;
+        default:
+            return &out->lam;
+    }
+}
+
+
+
+static void ocp_nlp_out_traj_slice(ocp_nlp_dims *dims, int traj_field, int stage, int *offset,
+                                   int *len)
+{
+    *offset = 0;
+    switch (traj_field)
+    {
+        case OUT_TRAJ_X:
+            *offset = dims->nu[stage];
+            *len = dims->nx[stage];
+            break;
+        case OUT_TRAJ_U:
+            *len = dims->nu[stage];
+            break;
+        case OUT_TRAJ_Z:
+            *len = dims->nz[stage];
+            break;
+        case OUT_TRAJ_PI:
+            // no multipliers of the dynamics at the last stage
+            *len = stage < dims->N ? dims->nx[stage + 1] : 0;
+            break;
+        default:
+            *len = 2 * dims->ni[stage];
+    }
+}
+
+
+
+ocp_nlp_field_handle *ocp_nlp_out_field_create(ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_out *out, const char *field)
+{
+    int N = dims->N;
+
+    int traj_field = ocp_nlp_out_traj_field(field);
+    if (traj_field < 0)
+    {
+        printf("\nerror: ocp_nlp_out_field_create: field %s not available\n", field);
+        exit(1);
+    }
+
+    ocp_nlp_field_handle *handle = ocp_nlp_field_handle_alloc(N);
+
+    handle->window = ocp_nlp_out_traj_window(out, traj_field);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        handle->vec[ii] = NULL;
+        ocp_nlp_out_traj_slice(dims, traj_field, ii, handle->offset + ii, handle->len + ii);
+    }
+
+    ocp_nlp_field_handle_finalize(handle);
+
+    return handle;
+}
+
+
+
+void ocp_nlp_field_handle_destroy(void *handle)
+{
+    free(handle);
+}
+
+
+
+static inline struct blasfeo_dvec *ocp_nlp_field_vec(ocp_nlp_field_handle *handle, int stage)
+{
+    return handle->window ? *handle->window + stage : handle->vec[stage];
+}
+
+
+
+void ocp_nlp_field_set(ocp_nlp_field_handle *handle, int stage, double *value)
+{
+    if (handle->ptr)
+    {
+        for (int ii = 0; ii < handle->len[stage]; ii++)
+            handle->ptr[stage][handle->offset[stage] + ii] = value[ii];
+    }
+    else if (handle->len[stage] > 0)
+    {
+        blasfeo_pack_dvec(handle->len[stage], value, ocp_nlp_field_vec(handle, stage),
+                          handle->offset[stage]);
+    }
+
+    if (handle->version)
+        handle->version[stage]++;
+
+    // same rule as in ocp_nlp_in_set
+    if (handle->in)
+    {
+        if (stage < handle->N)
+            handle->in->dynamics_version[stage]++;
+        handle->in->cost_version[stage]++;
+        handle->in->constraints_version[stage]++;
+    }
+}
+
+
+
+void ocp_nlp_field_get(ocp_nlp_field_handle *handle, int stage, double *value)
+{
+    if (handle->ptr)
+    {
+        for (int ii = 0; ii < handle->len[stage]; ii++)
+            value[ii] = handle->ptr[stage][handle->offset[stage] + ii];
+    }
+    else if (handle->len[stage] > 0)
+    {
+        blasfeo_unpack_dvec(handle->len[stage], ocp_nlp_field_vec(handle, stage),
+                            handle->offset[stage], value);
+    }
+}
+
+
+
+void ocp_nlp_field_set_all(ocp_nlp_field_handle *handle, double *value)
+{
+    for (int ii = 0; ii <= handle->N; ii++)
+    {
+        ocp_nlp_field_set(handle, ii, value);
+        value += handle->len[ii];
+    }
+}
+
+
+
+void ocp_nlp_field_get_all(ocp_nlp_field_handle *handle, double *value)
+{
+    for (int ii = 0; ii <= handle->N; ii++)
+    {
+        ocp_nlp_field_get(handle, ii, value);
+        value += handle->len[ii];
+    }
+}
+
+
+
+/************************************************
+* trajectories
+************************************************/
+
+int ocp_nlp_dims_get_trajectory(ocp_nlp_config *config, ocp_nlp_dims *dims, const char *field,
+        int *len)
+{
+    int traj_field = ocp_nlp_out_traj_field(field);
+    if (traj_field < 0)
+    {
+        printf("\nerror: ocp_nlp_dims_get_trajectory: field %s not available\n", field);
+        exit(1);
+    }
+
+    int offset, len_tot = 0;
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        ocp_nlp_out_traj_slice(dims, traj_field, ii, &offset, len + ii);
+        len_tot += len[ii];
+    }
+
+    return len_tot;
+}
+
+
+
+void ocp_nlp_out_get_trajectory(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
+        const char *field, double *value)
+{
+    int traj_field = ocp_nlp_out_traj_field(field);
+    if (traj_field < 0)
+    {
+        printf("\nerror: ocp_nlp_out_get_trajectory: field %s not available\n", field);
+        exit(1);
+    }
+
+    struct blasfeo_dvec *window = *ocp_nlp_out_traj_window(out, traj_field);
+
+    int offset, len;
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        ocp_nlp_out_traj_slice(dims, traj_field, ii, &offset, &len);
+        if (len > 0)
+            blasfeo_unpack_dvec(len, window + ii, offset, value);
+        value += len;
+    }
+}
+
+
+
+void ocp_nlp_out_set_trajectory(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
+        const char *field, double *value)
+{
+    int traj_field = ocp_nlp_out_traj_field(field);
+    if (traj_field < 0)
+    {
+        printf("\nerror: ocp_nlp_out_set_trajectory: field %s not available\n", field);
+        exit(1);
+    }
+
+    struct blasfeo_dvec *window = *ocp_nlp_out_traj_window(out, traj_field);
+
+    int offset, len;
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        ocp_nlp_out_traj_slice(dims, traj_field, ii, &offset, &len);
+        if (len > 0)
+            blasfeo_pack_dvec(len, value, window + ii, offset);
+        value += len;
+    }
+}
+
+
 int ocp_nlp_dims_get_from_attr(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
         int stage, const char *field)
 {
@@ -731,13 +1186,16 @@ void ocp_nlp_cost_dims_get_from_attr(ocp_nlp_config *config, ocp_nlp_dims *dims,
 * opts
 ************************************************/
 
-void *ocp_nlp_solver_opts_create(ocp_nlp_config *config, ocp_nlp_dims *dims)
+int ocp_nlp_solver_opts_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims)
 {
-    int bytes = config->opts_calculate_size(config, dims);
+    return config->opts_calculate_size(config, dims);
+}
 
-    void *ptr = acados_calloc(1, bytes);
 
-    void *opts = config->opts_assign(config, dims, ptr);
+
+void *ocp_nlp_solver_opts_assign(ocp_nlp_config *config, ocp_nlp_dims *dims, void *raw_memory)
+{
+    void *opts = config->opts_assign(config, dims, raw_memory);
 
     config->opts_initialize_default(config, dims, opts);
 
@@ -746,6 +1204,19 @@ void *ocp_nlp_solver_opts_create(ocp_nlp_config *config, ocp_nlp_dims *dims)
 
 
 
+void *ocp_nlp_solver_opts_create(ocp_nlp_config *config, ocp_nlp_dims *dims)
+{
+    int bytes = ocp_nlp_solver_opts_calculate_size(config, dims);
+
+    void *ptr = acados_calloc(1, bytes);
+
+    void *opts = ocp_nlp_solver_opts_assign(config, dims, ptr);
+
+    return opts;
+}
+
+
+
 void ocp_nlp_solver_opts_set(ocp_nlp_config *config, void *opts_, const char *field, void *value)
 {
     config->opts_set(config, opts_, field, value);
@@ -778,7 +1249,7 @@ void ocp_nlp_solver_opts_destroy(void *opts)
 * solver
 ************************************************/
 
-static int ocp_nlp_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_)
+int ocp_nlp_solver_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_)
 {
     int bytes = sizeof(ocp_nlp_solver);
 
@@ -790,7 +1261,7 @@ static int ocp_nlp_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, vo
 
 
 
-static ocp_nlp_solver *ocp_nlp_assign(ocp_nlp_config *config, ocp_nlp_dims *dims,
+ocp_nlp_solver *ocp_nlp_solver_assign(ocp_nlp_config *config, ocp_nlp_dims *dims,
                                       void *opts_, void *raw_memory)
 {
     char *c_ptr = (char *) raw_memory;
@@ -809,7 +1280,11 @@ static ocp_nlp_solver *ocp_nlp_assign(ocp_nlp_config *config, ocp_nlp_dims *dims
     solver->work = (void *) c_ptr;
     c_ptr += config->workspace_calculate_size(config, dims, opts_);
 
-    assert((char *) raw_memory + ocp_nlp_calculate_size(config, dims, opts_) == c_ptr);
+    // the first member of the solver workspace points to the nlp workspace, which is only cast in
+    // precompute and solve: mark it as not cast yet, also for memory not zeroed by the caller
+    *(ocp_nlp_workspace **) solver->work = NULL;
+
+    assert((char *) raw_memory + ocp_nlp_solver_calculate_size(config, dims, opts_) == c_ptr);
 
     return solver;
 }
@@ -820,11 +1295,11 @@ ocp_nlp_solver *ocp_nlp_solver_create(ocp_nlp_config *config, ocp_nlp_dims *dims
 {
     config->opts_update(config, dims, opts_);
 
-    int bytes = ocp_nlp_calculate_size(config, dims, opts_);
+    int bytes = ocp_nlp_solver_calculate_size(config, dims, opts_);
 
     void *ptr = acados_calloc(1, bytes);
 
-    ocp_nlp_solver *solver = ocp_nlp_assign(config, dims, opts_, ptr);
+    ocp_nlp_solver *solver = ocp_nlp_solver_assign(config, dims, opts_, ptr);
 
     return solver;
 }
@@ -863,6 +1338,34 @@ void ocp_nlp_eval_param_sens(ocp_nlp_solver *solver, char *field, int stage, int
 
 
 
+int ocp_nlp_advanced_step(ocp_nlp_solver *solver, double *x0, double *u0)
+{
+    if (solver->config->advanced_step == NULL)
+    {
+        printf("\nerror: ocp_nlp_advanced_step: not supported by the nlp solver, use SQP_RTI\n");
+        exit(1);
+    }
+
+    return solver->config->advanced_step(solver->config, solver->dims, solver->opts, solver->mem,
+                                         solver->work, x0, u0);
+}
+
+
+
+void ocp_nlp_shift(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out)
+{
+    if (solver->config->shift == NULL)
+    {
+        printf("\nerror: ocp_nlp_shift: not supported by the nlp solver\n");
+        exit(1);
+    }
+
+    solver->config->shift(solver->config, solver->dims, nlp_in, nlp_out, solver->opts, solver->mem,
+                          solver->work);
+}
+
+
+
 void ocp_nlp_get(ocp_nlp_config *config, ocp_nlp_solver *solver,
                  const char *field, void *return_value_)
 {
@@ -912,3 +1415,385 @@ void ocp_nlp_set(ocp_nlp_config *config, ocp_nlp_solver *solver,
     }
     // printf("exit ocp_nlp_set\n");
 }
+
+
+
+/************************************************
+* snapshot
+************************************************/
+
+// binary layout: header, stage dimensions, then one section per vector, each section holding its
+// id, stage, length and tag (the index of the model field) followed by the doubles; all sizes are
+// multiples of 8 bytes, so that the doubles are aligned also when the file is mapped into memory
+#define SNAPSHOT_MAGIC "ACDSNAP"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_NUM_STAGE_DIMS 6
+
+typedef struct
+{
+    char magic[SNAPSHOT_MAGIC_SIZE];
+    int version;
+    int N;
+    int size;  // total size in bytes
+    int num_sec;
+} ocp_nlp_snapshot_header;
+
+typedef struct
+{
+    int id;
+    int stage;
+    int len;
+    int tag;   // index of the model field, checked on restore
+    int flag;  // data attached to the section (e.g. whether the integrator guess is set)
+    int pad;
+} ocp_nlp_snapshot_section;
+
+enum
+{
+    SNAPSHOT_OUT_UX,
+    SNAPSHOT_OUT_Z,
+    SNAPSHOT_OUT_PI,
+    SNAPSHOT_OUT_LAM,
+    SNAPSHOT_OUT_T,
+    SNAPSHOT_QP_UX,
+    SNAPSHOT_QP_PI,
+    SNAPSHOT_QP_LAM,
+    SNAPSHOT_QP_T,
+    SNAPSHOT_SIM_GUESS,
+    SNAPSHOT_CONSTRAINTS,
+    SNAPSHOT_COST,
+    SNAPSHOT_PARAM,
+};
+
+enum
+{
+    SNAPSHOT_SIZE,
+    SNAPSHOT_WRITE,
+    SNAPSHOT_CHECK,  // validates the buffer without modifying the solver
+    SNAPSHOT_READ,
+};
+
+
+
+// processes the header of one section and returns in data the location of its doubles in the
+// buffer (NULL in SIZE mode); returns -1 if the section does not match the snapshot
+static int ocp_nlp_snapshot_sec(int mode, char **c_ptr, char *end, int id, int stage, int tag,
+                                int *flag, int len, double **data)
+{
+    int size = sizeof(ocp_nlp_snapshot_section) + len * sizeof(double);
+
+    *data = NULL;
+
+    if (mode == SNAPSHOT_SIZE)
+    {
+        *c_ptr += size;
+        return 0;
+    }
+
+    if (end - *c_ptr < size)
+        return -1;
+
+    ocp_nlp_snapshot_section *sec = (ocp_nlp_snapshot_section *) *c_ptr;
+
+    if (mode == SNAPSHOT_WRITE)
+    {
+        sec->id = id;
+        sec->stage = stage;
+        sec->len = len;
+        sec->tag = tag;
+        sec->flag = flag ? *flag : 0;
+        sec->pad = 0;
+    }
+    else
+    {
+        if (sec->id != id || sec->stage != stage || sec->len != len || sec->tag != tag)
+            return -1;
+        if (mode == SNAPSHOT_READ && flag)
+            *flag = sec->flag;
+    }
+
+    *data = (double *) (*c_ptr + sizeof(ocp_nlp_snapshot_section));
+    *c_ptr += size;
+    return 0;
+}
+
+
+
+// processes one section holding a whole blasfeo vector
+static int ocp_nlp_snapshot_vec(int mode, char **c_ptr, char *end, int id, int stage, int tag,
+                                int *flag, struct blasfeo_dvec *vec)
+{
+    double *data;
+    int len = vec->m;
+
+    if (ocp_nlp_snapshot_sec(mode, c_ptr, end, id, stage, tag, flag, len, &data))
+        return -1;
+
+    if (mode == SNAPSHOT_WRITE)
+        blasfeo_unpack_dvec(len, vec, 0, data);
+    else if (mode == SNAPSHOT_READ)
+        blasfeo_pack_dvec(len, data, vec, 0);
+
+    return 0;
+}
+
+
+
+// walks through the numerical state of the solver in a fixed order, returns the size in bytes
+// of the snapshot, or -1 if the buffer does not match the solver;
+// the solver is only modified in READ mode, which has to be preceded by a successful CHECK
+static int ocp_nlp_snapshot_process(int mode, ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_in *in, ocp_nlp_out *out, ocp_nlp_solver *solver, char *buffer, int size)
+{
+    int N = dims->N;
+
+    ocp_nlp_memory *mem;
+    config->get(config, solver->dims, solver->mem, "nlp_mem", &mem);
+    ocp_qp_out *qp_out = mem->qp_out;
+
+    char *c_ptr = buffer;
+    char *end = buffer + size;
+
+    // header
+    ocp_nlp_snapshot_header *header = (ocp_nlp_snapshot_header *) c_ptr;
+    if (mode == SNAPSHOT_WRITE)
+    {
+        memset(header, 0, sizeof(ocp_nlp_snapshot_header));
+        memcpy(header->magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+        header->version = SNAPSHOT_VERSION;
+        header->N = N;
+        header->size = size;
+    }
+    else if (mode != SNAPSHOT_SIZE)
+    {
+        if (size < (int) sizeof(ocp_nlp_snapshot_header) ||
+            memcmp(header->magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) ||
+            header->version != SNAPSHOT_VERSION || header->N != N || header->size != size)
+            return -1;
+    }
+    c_ptr += sizeof(ocp_nlp_snapshot_header);
+
+    // stage dimensions
+    int stage_dims_size = SNAPSHOT_NUM_STAGE_DIMS * (N + 1) * sizeof(int);
+    stage_dims_size = (stage_dims_size + 7) / 8 * 8;
+    if (mode != SNAPSHOT_SIZE)
+    {
+        if (end - c_ptr < stage_dims_size)
+            return -1;
+        int *stage_dims = (int *) c_ptr;
+        for (int ii = 0; ii <= N; ii++)
+        {
+            int tmp[SNAPSHOT_NUM_STAGE_DIMS] = {dims->nx[ii], dims->nu[ii], dims->nz[ii],
+                                                dims->ni[ii], dims->ns[ii], dims->np[ii]};
+            for (int jj = 0; jj < SNAPSHOT_NUM_STAGE_DIMS; jj++)
+            {
+                if (mode == SNAPSHOT_WRITE)
+                    stage_dims[SNAPSHOT_NUM_STAGE_DIMS * ii + jj] = tmp[jj];
+                else if (stage_dims[SNAPSHOT_NUM_STAGE_DIMS * ii + jj] != tmp[jj])
+                    return -1;
+            }
+        }
+    }
+    c_ptr += stage_dims_size;
+
+    int num_sec = 0;
+    int status = 0;
+    double *data;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        // iterate
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_OUT_UX, ii, 0, NULL,
+                                       out->ux + ii);
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_OUT_Z, ii, 0, NULL, out->z + ii);
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_OUT_LAM, ii, 0, NULL,
+                                       out->lam + ii);
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_OUT_T, ii, 0, NULL, out->t + ii);
+        num_sec += 4;
+        if (ii < N)
+        {
+            status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_OUT_PI, ii, 0, NULL,
+                                           out->pi + ii);
+            num_sec++;
+        }
+
+        // qp solution, warm start of the qp solver
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_QP_UX, ii, 0, NULL,
+                                       qp_out->ux + ii);
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_QP_LAM, ii, 0, NULL,
+                                       qp_out->lam + ii);
+        status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_QP_T, ii, 0, NULL,
+                                       qp_out->t + ii);
+        num_sec += 3;
+        if (ii < N)
+        {
+            status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_QP_PI, ii, 0, NULL,
+                                           qp_out->pi + ii);
+            num_sec++;
+        }
+
+        // integrator guesses
+        if (ii < N)
+        {
+            int set_sim_guess = mem->set_sim_guess[ii];
+            status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_SIM_GUESS, ii, 0,
+                                           &set_sim_guess, mem->sim_guess + ii);
+            if (mode == SNAPSHOT_READ)
+                mem->set_sim_guess[ii] = set_sim_guess;
+            num_sec++;
+        }
+
+        // model data: whole bound vector of the constraints, references and slack penalties
+        struct blasfeo_dvec *vec;
+        int offset, len;
+        ocp_nlp_constraints_config *constr_config = config->constraints[ii];
+        if (constr_config->model_get_vec &&
+            constr_config->model_get_vec(constr_config, dims->constraints[ii], in->constraints[ii],
+                "lb", &vec, &offset, &len) == ACADOS_SUCCESS)
+        {
+            status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_CONSTRAINTS, ii, 0, NULL,
+                                           vec);
+            num_sec++;
+        }
+
+        const char *cost_fields[] = {"y_ref", "Zl", "zl"};
+        ocp_nlp_cost_config *cost_config = config->cost[ii];
+        for (int jj = 0; jj < 3; jj++)
+        {
+            if (cost_config->model_get_vec &&
+                cost_config->model_get_vec(cost_config, dims->cost[ii], in->cost[ii],
+                    cost_fields[jj], &vec, &offset, &len) == ACADOS_SUCCESS)
+            {
+                status |= ocp_nlp_snapshot_vec(mode, &c_ptr, end, SNAPSHOT_COST, ii, jj, NULL,
+                                               vec);
+                num_sec++;
+            }
+        }
+
+        // parameters of the external functions (copy kept in nlp_in)
+        if (dims->np[ii] > 0)
+        {
+            status |= ocp_nlp_snapshot_sec(mode, &c_ptr, end, SNAPSHOT_PARAM, ii, 0, NULL,
+                                           dims->np[ii], &data);
+            if (mode == SNAPSHOT_WRITE)
+                memcpy(data, in->parameter_values[ii], dims->np[ii] * sizeof(double));
+            else if (mode == SNAPSHOT_READ)
+                ocp_nlp_in_set(config, dims, in, ii, "parameter_values", data);
+            num_sec++;
+        }
+
+        if (mode == SNAPSHOT_READ)
+        {
+            // the slack penalties enter the qp matrices
+            in->cost_version[ii]++;
+        }
+
+        if (status)
+            return -1;
+    }
+
+    if (mode == SNAPSHOT_WRITE)
+        header->num_sec = num_sec;
+    else if (mode != SNAPSHOT_SIZE && header->num_sec != num_sec)
+        return -1;
+
+    return c_ptr - buffer;
+}
+
+
+
+int ocp_nlp_snapshot_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver)
+{
+    return ocp_nlp_snapshot_process(SNAPSHOT_SIZE, config, dims, in, out, solver, NULL, 0);
+}
+
+
+
+int ocp_nlp_snapshot_write(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, void *buffer, int size)
+{
+    int size_snapshot = ocp_nlp_snapshot_calculate_size(config, dims, in, out, solver);
+    if (size < size_snapshot)
+        return ACADOS_FAILURE;
+
+    size = size_snapshot;
+    if (ocp_nlp_snapshot_process(SNAPSHOT_WRITE, config, dims, in, out, solver, buffer, size) < 0)
+        return ACADOS_FAILURE;
+
+    return ACADOS_SUCCESS;
+}
+
+
+
+int ocp_nlp_snapshot_restore(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, const void *buffer, int size)
+{
+    // validate the whole snapshot first, so that a mismatching one leaves the solver untouched
+    if (ocp_nlp_snapshot_process(SNAPSHOT_CHECK, config, dims, in, out, solver,
+                                 (char *) buffer, size) < 0)
+        return ACADOS_FAILURE;
+
+    ocp_nlp_snapshot_process(SNAPSHOT_READ, config, dims, in, out, solver, (char *) buffer, size);
+
+    return ACADOS_SUCCESS;
+}
+
+
+
+int ocp_nlp_snapshot_save(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, const char *file_name)
+{
+    int size = ocp_nlp_snapshot_calculate_size(config, dims, in, out, solver);
+    void *buffer = acados_malloc(size, 1);
+
+    int status = ocp_nlp_snapshot_write(config, dims, in, out, solver, buffer, size);
+
+    if (status == ACADOS_SUCCESS)
+    {
+        FILE *file = fopen(file_name, "wb");
+        if (!file || fwrite(buffer, 1, size, file) != (size_t) size)
+        {
+            printf("\nerror: ocp_nlp_snapshot_save: cannot write %s\n", file_name);
+            status = ACADOS_FAILURE;
+        }
+        if (file)
+            fclose(file);
+    }
+
+    free(buffer);
+
+    return status;
+}
+
+
+
+int ocp_nlp_snapshot_load(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, const char *file_name)
+{
+    int size = ocp_nlp_snapshot_calculate_size(config, dims, in, out, solver);
+
+    FILE *file = fopen(file_name, "rb");
+    if (!file)
+    {
+        printf("\nerror: ocp_nlp_snapshot_load: cannot open %s\n", file_name);
+        return ACADOS_FAILURE;
+    }
+
+    // a file of a different size does not match the solver, read past the size to detect it
+    void *buffer = acados_malloc(size + 8, 1);
+    int size_file = fread(buffer, 1, size + 8, file);
+    fclose(file);
+
+    int status = ACADOS_FAILURE;
+    if (size_file == size)
+        status = ocp_nlp_snapshot_restore(config, dims, in, out, solver, buffer, size);
+
+    if (status != ACADOS_SUCCESS)
+        printf("\nerror: ocp_nlp_snapshot_load: %s does not match the solver\n", file_name);
+
+    free(buffer);
+
+    return status;
+}
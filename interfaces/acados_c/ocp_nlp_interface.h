@@ -56,6 +56,7 @@ typedef enum
 {
     SQP,
     SQP_RTI,
+    IPM,
     INVALID_NLP_SOLVER,
 } ocp_nlp_solver_t;
 
@@ -153,6 +154,18 @@ typedef struct
 /// \param N Horizon length
 ocp_nlp_plan *ocp_nlp_plan_create(int N);
 
+/// Returns the size in bytes of a plan struct, see ocp_nlp_plan_assign.
+///
+/// \param N Horizon length
+int ocp_nlp_plan_calculate_size(int N);
+
+/// Constructs a plan struct as ocp_nlp_plan_create, in user provided memory of
+/// ocp_nlp_plan_calculate_size bytes (8-byte aligned).
+///
+/// \param N Horizon length
+/// \param raw_memory Pointer to the memory.
+ocp_nlp_plan *ocp_nlp_plan_assign(int N, void *raw_memory);
+
 /// Destructor for plan struct, frees memory.
 ///
 /// \param plan_ The plan struct to destroy.
@@ -164,6 +177,13 @@ void ocp_nlp_plan_destroy(void* plan_);
 /// \param plan The plan (user nlp configuration).
 ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan);
 
+/// Constructs an nlp configuration struct from a plan as ocp_nlp_config_create, in user provided
+/// memory of ocp_nlp_config_calculate_size(plan.N) bytes (8-byte aligned).
+///
+/// \param plan The plan (user nlp configuration).
+/// \param raw_memory Pointer to the memory.
+ocp_nlp_config *ocp_nlp_config_assign_from_plan(ocp_nlp_plan plan, void *raw_memory);
+
 /// Desctructor of the nlp configuration.
 ///
 /// \param config_ The configuration struct.
@@ -193,14 +213,17 @@ ocp_nlp_in *ocp_nlp_in_create(ocp_nlp_config *config, ocp_nlp_dims *dims);
 void ocp_nlp_in_destroy(void *in);
 
 
-/// Sets the sampling times for the given stage.
+/// Sets the sampling times, or the parameter values of the given stage.
+/// "parameter_values" has to be called whenever the parameters of the external functions of a
+/// stage are changed (e.g. with set_param), so that the qp matrices of the stage are recomputed.
 ///
 /// \param config The configuration struct.
 /// \param dims The dimension struct.
 /// \param in The inputs struct.
 /// \param stage Stage number.
-/// \param field Has to be "Ts" (TBC other options).
-/// \param value The sampling times (floating point).
+/// \param field Either "Ts", "parameter_values" or "ext_fun_batch".
+/// \param value The sampling times, the dims->np[stage] parameters (floating point), or an
+///     external_function_casadi_batch whose node handles are set in the modules (stage ignored).
 void ocp_nlp_in_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in, int stage,
         const char *field, void *value);
 
@@ -262,7 +285,7 @@ void ocp_nlp_out_destroy(void *out);
 /// \param dims The dimension struct.
 /// \param out The output struct.
 /// \param stage Stage number.
-/// \param field The name of the field, either x, u, pi.
+/// \param field The name of the field, either x, u, pi, lam.
 /// \param value Initialization values.
 void ocp_nlp_out_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
         int stage, const char *field, void *value);
@@ -274,10 +297,134 @@ void ocp_nlp_out_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *ou
 /// \param dims The dimension struct.
 /// \param out The output struct.
 /// \param stage Stage number.
-/// \param field The name of the field, either x, u, z, pi.
+/// \param field The name of the field, either x, u, z, pi, lam.
 /// \param value Pointer to the output memory.
 void ocp_nlp_out_get(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
         int stage, const char *field, void *value);
+
+/* trajectories */
+
+/// Returns the stage-wise lengths of a trajectory field of the output struct (x, u, z, pi, lam).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param field The name of the field.
+/// \param len Pointer to the output memory (N+1 ints).
+/// \return The total length of the trajectory.
+int ocp_nlp_dims_get_trajectory(ocp_nlp_config *config, ocp_nlp_dims *dims, const char *field,
+        int *len);
+
+/// Gets a field of the output struct at all the stages in one call, i.e. the trajectory in a
+/// contiguous buffer holding stages 0, ..., N one after the other (row-major if the stage
+/// dimensions agree).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param out The output struct.
+/// \param field The name of the field (x, u, z, pi, lam).
+/// \param value Pointer to the output memory (total length from ocp_nlp_dims_get_trajectory).
+void ocp_nlp_out_get_trajectory(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
+        const char *field, double *value);
+
+/// Sets a field of the output struct at all the stages from one contiguous buffer, laid out as in
+/// ocp_nlp_out_get_trajectory.
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param out The output struct.
+/// \param field The name of the field (x, u, z, pi, lam).
+/// \param value The values.
+void ocp_nlp_out_set_trajectory(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
+        const char *field, double *value);
+
+/* field handles */
+
+/// Handle of a vector field, resolved once from its name for all the stages, to set and get the
+/// field without string comparisons in the loop.
+typedef struct
+{
+    struct blasfeo_dvec **vec;  // vector holding the field at each stage
+    int *offset;                // offset of the field in vec
+    int *len;                   // length of the field at each stage
+    int *version;               // model version counters to bump on set, NULL if not needed
+    struct blasfeo_dvec **window;  // ring buffer window of ocp_nlp_out holding the field, NULL
+                                   // for model fields (vec then is used)
+    double **ptr;               // arrays holding the field at each stage if not in a blasfeo
+                                // vector (parameter values), NULL otherwise
+    ocp_nlp_in *in;             // marks all the models of the stage as modified on set (parameter
+                                // values), NULL if not needed
+    int len_tot;                // sum of len over the stages
+    int N;
+} ocp_nlp_field_handle;
+
+/// Resolves a vector field of the cost model (y_ref/yref, Zl, Zu, zl, zu).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param in The inputs struct.
+/// \param field The name of the field.
+ocp_nlp_field_handle *ocp_nlp_cost_model_field_create(ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_in *in, const char *field);
+
+/// Resolves a vector field of the constraints model (lbx, ubx, lbu, ubu, lg, ug, lh, uh, ...).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param in The inputs struct.
+/// \param field The name of the field.
+ocp_nlp_field_handle *ocp_nlp_constraints_model_field_create(ocp_nlp_config *config,
+        ocp_nlp_dims *dims, ocp_nlp_in *in, const char *field);
+
+/// Resolves a field of the inputs struct (parameter_values). As with ocp_nlp_in_set, setting
+/// the parameter values marks all the models of the stage as modified; the parameters themselves
+/// are set in the external functions (e.g. with set_param).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param in The inputs struct.
+/// \param field The name of the field.
+ocp_nlp_field_handle *ocp_nlp_in_field_create(ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_in *in, const char *field);
+
+/// Resolves a field of the output struct (x, u, z, pi, lam).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param out The output struct.
+/// \param field The name of the field.
+ocp_nlp_field_handle *ocp_nlp_out_field_create(ocp_nlp_config *config, ocp_nlp_dims *dims,
+        ocp_nlp_out *out, const char *field);
+
+/// Destructor of a field handle.
+///
+/// \param handle The field handle.
+void ocp_nlp_field_handle_destroy(void *handle);
+
+/// Sets the field at the given stage.
+///
+/// \param handle The field handle.
+/// \param stage Stage number.
+/// \param value The values (len[stage] doubles).
+void ocp_nlp_field_set(ocp_nlp_field_handle *handle, int stage, double *value);
+
+/// Gets the field at the given stage.
+///
+/// \param handle The field handle.
+/// \param stage Stage number.
+/// \param value Pointer to the output memory (len[stage] doubles).
+void ocp_nlp_field_get(ocp_nlp_field_handle *handle, int stage, double *value);
+
+/// Sets the field at all the stages from one contiguous array.
+///
+/// \param handle The field handle.
+/// \param value The values of stages 0, ..., N one after the other (len_tot doubles).
+void ocp_nlp_field_set_all(ocp_nlp_field_handle *handle, double *value);
+
+/// Gets the field at all the stages into one contiguous array.
+///
+/// \param handle The field handle.
+/// \param value Pointer to the output memory (len_tot doubles).
+void ocp_nlp_field_get_all(ocp_nlp_field_handle *handle, double *value);
 //
 // TODO(andrea): remove this once/if the MATLAB interface uses the new setters below?
 int ocp_nlp_dims_get_from_attr(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out,
@@ -296,6 +443,20 @@ void ocp_nlp_cost_dims_get_from_attr(ocp_nlp_config *config, ocp_nlp_dims *dims,
 /// \param dims The dimension struct.
 void *ocp_nlp_solver_opts_create(ocp_nlp_config *config, ocp_nlp_dims *dims);
 
+/// Returns the size in bytes of the options struct, see ocp_nlp_solver_opts_assign.
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+int ocp_nlp_solver_opts_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims);
+
+/// Creates an options struct with default values as ocp_nlp_solver_opts_create, in user
+/// provided memory of ocp_nlp_solver_opts_calculate_size bytes (8-byte aligned).
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param raw_memory Pointer to the memory.
+void *ocp_nlp_solver_opts_assign(ocp_nlp_config *config, ocp_nlp_dims *dims, void *raw_memory);
+
 /// Destructor of the options.
 ///
 /// \param opts The options struct.
@@ -332,6 +493,26 @@ void ocp_nlp_solver_opts_update(ocp_nlp_config *config, ocp_nlp_dims *dims, void
 /// \return The solver.
 ocp_nlp_solver *ocp_nlp_solver_create(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_);
 
+/// Returns the size in bytes of the solver (memory and workspace), see ocp_nlp_solver_assign.
+/// The options have to be updated (ocp_nlp_solver_opts_update) before.
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param opts_ The options struct.
+int ocp_nlp_solver_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_);
+
+/// Creates an ocp solver in user provided memory of ocp_nlp_solver_calculate_size bytes
+/// (zeroed, 8-byte aligned). Unlike ocp_nlp_solver_create, the options are not updated here.
+/// The solver allocates no further memory.
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param opts_ The options struct.
+/// \param raw_memory Pointer to the memory.
+/// \return The solver.
+ocp_nlp_solver *ocp_nlp_solver_assign(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_,
+                                      void *raw_memory);
+
 /// Destructor of the solver.
 ///
 /// \param solver The solver struct.
@@ -356,6 +537,27 @@ int ocp_nlp_precompute(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *
 //
 void ocp_nlp_eval_param_sens(ocp_nlp_solver *solver, char *field, int stage, int index, ocp_nlp_out *sens_nlp_out);
 
+/// Advanced-step feedback: computes the control at stage 0 for a new initial state as a
+/// first-order correction of the solution at the predicted initial state, by a single
+/// backsolve with the factorization kept from the preparation phase (SQP_RTI with option
+/// "advanced_step"). Call it between the preparation (rti_phase 1) and the feedback
+/// (rti_phase 2) phase; the latter then solves the full QP as refinement.
+///
+/// \param solver The solver struct.
+/// \param x0 The new initial state.
+/// \param u0 Output: the corrected control at stage 0.
+int ocp_nlp_advanced_step(ocp_nlp_solver *solver, double *x0, double *u0);
+
+/// Shifts the iterate (primal and dual variables, integrator guesses) by one stage for the
+/// next sample, without copying the stages (ring buffer layout of nlp_out). The terminal stage
+/// is initialized according to the option "shift_policy" (SHIFT_COPY, SHIFT_SIMULATE, SHIFT_LQR).
+/// To be called after ocp_nlp_precompute.
+///
+/// \param solver The solver struct.
+/// \param nlp_in The inputs struct.
+/// \param nlp_out The output struct.
+void ocp_nlp_shift(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out);
+
 /* get */
 /// \param config The configuration struct.
 /// \param solver The solver struct.
@@ -376,6 +578,55 @@ void ocp_nlp_set(ocp_nlp_config *config, ocp_nlp_solver *solver,
         int stage, const char *field, void *value);
 
 
+/* snapshot */
+
+/// Returns the size in bytes of a snapshot of the numerical state of the solver: the iterate
+/// (nlp_out), the last qp solution, the integrator guesses, the model vectors of nlp_in
+/// (constraint bounds, references and slack penalties) and its copy of the parameter values.
+///
+/// \param config The configuration struct.
+/// \param dims The dimension struct.
+/// \param in The inputs struct.
+/// \param out The output struct.
+/// \param solver The solver struct.
+int ocp_nlp_snapshot_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver);
+
+/// Writes a snapshot of the solver into a buffer, in a versioned binary format whose doubles are
+/// 8-byte aligned (so that a snapshot file can be memory-mapped and passed to
+/// ocp_nlp_snapshot_restore).
+///
+/// \param buffer Pointer to the output memory.
+/// \param size Size of the output memory in bytes.
+/// \return ACADOS_SUCCESS, or ACADOS_FAILURE if the buffer is too small.
+int ocp_nlp_snapshot_write(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, void *buffer, int size);
+
+/// Restores a snapshot into a solver of the same problem, created and precomputed as usual, so
+/// that the next solve resumes from the saved iterate. The whole snapshot is validated before
+/// anything is restored, a mismatching snapshot leaves the solver untouched.
+/// The parameter values are restored into in->parameter_values and still have to be passed to
+/// the external functions (e.g. with set_param), as they are not accessible from nlp_in.
+///
+/// \param buffer The snapshot.
+/// \param size Size of the snapshot in bytes.
+/// \return ACADOS_SUCCESS, or ACADOS_FAILURE if the snapshot does not match the solver.
+int ocp_nlp_snapshot_restore(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, const void *buffer, int size);
+
+/// Writes a snapshot of the solver to a binary file.
+///
+/// \param file_name The name of the file.
+int ocp_nlp_snapshot_save(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, const char *file_name);
+
+/// Restores a snapshot of the solver from a binary file written by ocp_nlp_snapshot_save.
+///
+/// \param file_name The name of the file.
+int ocp_nlp_snapshot_load(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in,
+        ocp_nlp_out *out, ocp_nlp_solver *solver, const char *file_name);
+
+
 
 #ifdef __cplusplus
 } /* extern "C" */
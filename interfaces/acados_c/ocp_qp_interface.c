@@ -56,6 +56,7 @@
 #endif
 
 #include "acados/ocp_qp/ocp_qp_hpipm.h"
+#include "acados/ocp_qp/ocp_qp_partitioned_ipm.h"
 #ifdef ACADOS_WITH_HPMPC
 #include "acados/ocp_qp/ocp_qp_hpmpc.h"
 #endif
@@ -138,6 +139,11 @@ void ocp_qp_xcond_solver_config_initialize_from_plan(ocp_qp_solver_t solver_name
 			ocp_qp_full_condensing_config_initialize_default(solver_config->xcond);
             break;
 #endif
+        case PARTIAL_CONDENSING_PARTITIONED_IPM:
+			ocp_qp_xcond_solver_config_initialize_default(solver_config);
+            ocp_qp_partitioned_ipm_config_initialize_default(solver_config->qp_solver);
+			ocp_qp_partial_condensing_config_initialize_default(solver_config->xcond);
+            break;
         case INVALID_QP_SOLVER:
             printf("\nerror: ocp_qp_config_create: forgot to initialize plan->qp_solver\n");
             exit(1);
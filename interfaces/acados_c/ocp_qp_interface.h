@@ -55,10 +55,13 @@ extern "C" {
 ///   FULL_CONDENSING_QPOASES
 ///   FULL_CONDENSING_QORE
 ///   FULL_CONDENSING_OOQP
+///   PARTIAL_CONDENSING_PARTITIONED_IPM
 ///   INVALID_QP_SOLVER
 ///
 /// Note: In this enumeration the partial condensing solvers have to be
-///       specified before the full condensing solvers.
+///       specified before the full condensing solvers. The only exception is
+///       PARTIAL_CONDENSING_PARTITIONED_IPM, appended before INVALID_QP_SOLVER
+///       to keep the values of the existing solvers.
 typedef enum {
     PARTIAL_CONDENSING_HPIPM,
 #ifdef ACADOS_WITH_HPMPC
@@ -83,6 +86,7 @@ typedef enum {
 #ifdef ACADOS_WITH_OOQP
     FULL_CONDENSING_OOQP,
 #endif
+    PARTIAL_CONDENSING_PARTITIONED_IPM,
     INVALID_QP_SOLVER,
 } ocp_qp_solver_t;
 
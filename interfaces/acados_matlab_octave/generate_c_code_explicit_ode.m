@@ -157,12 +157,14 @@ adj = jtimes(f_expl, [x;u], lambdaX, true);
 expl_vde_adj = Function([model_name,'_expl_vde_adj'], {x, lambdaX, u, p}, {adj});
 
 S_forw = vertcat(horzcat(Sx, Su), horzcat(zeros(nu,nx), eye(nu)));
-hess = S_forw.'*jtimes(adj, [x;u], S_forw);
-% TODO uncompress it ?????
+% symmetric second order sweep: use the (sparse) hessian of lambdaX'*f_expl
+% and only form the lower triangle of S_forw'*hess_lag*S_forw
+hess_lag = hessian(lambdaX.'*f_expl, [x;u]);
+hess_S = hess_lag*S_forw;
 hess2 = [];
 for j = 1:nx+nu
     for i = j:nx+nu
-        hess2 = [hess2; hess(i,j)];
+        hess2 = [hess2; S_forw(:,i).'*hess_S(:,j)];
     end
 end
 
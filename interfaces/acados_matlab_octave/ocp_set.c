@@ -479,6 +479,12 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                 Nf_sum += NN[jj];
             }
         }
+        // mark the models of the modified stages (terminal stage included if no stage is given)
+        int s1 = nrhs==min_nrhs ? N+1 : se;
+        for (int ii=s0; ii<s1; ii++)
+        {
+            ocp_nlp_in_set(config, dims, in, ii, "parameter_values", value);
+        }
     }
     else if (!strcmp(field, "nlp_solver_max_iter"))
     {
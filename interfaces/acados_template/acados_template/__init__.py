@@ -33,9 +33,11 @@
 
 from .acados_model import *
 from .generate_c_code_explicit_ode import *
+from .generate_c_code_erk_specialized import *
 from .generate_c_code_implicit_ode import *
 from .generate_c_code_constraint import *
 from .generate_c_code_nls_cost import *
+from .generate_bytecode import *
 from .acados_ocp import *
 from .acados_sim import *
 from .acados_ocp_solver import *
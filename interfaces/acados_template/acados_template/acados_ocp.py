@@ -1542,6 +1542,9 @@ class AcadosOcpOptions:
         self.__qp_solver        = 'PARTIAL_CONDENSING_HPIPM'  # qp solver to be used in the NLP solver
         self.__hessian_approx   = 'GAUSS_NEWTON'              # hessian approximation
         self.__integrator_type  = 'ERK'                       # integrator type
+        self.__code_target      = 'GENERIC'                   # generated code: generic library modules or specialized
+        self.__memory_allocation = 'DYNAMIC'                  # memory of the generated solver: heap or static
+        self.__nls_cost_evaluation = 'STAGE_WISE'             # nonlinear least squares cost: per stage or batched
         self.__tf               = None                        # prediction horizon
         self.__nlp_solver_type  = 'SQP_RTI'                   # NLP solver
         self.__nlp_solver_step_length = 1.0                   # fixed Newton step length
@@ -1583,6 +1586,29 @@ class AcadosOcpOptions:
         """Integrator type"""
         return self.__integrator_type
 
+    @property
+    def code_target(self):
+        """Code target: 'GENERIC' uses the generic integrator module of the library,
+        'SPECIALIZED' (ERK only) generates the integration step with fixed dimensions,
+        stages and steps as one CasADi function used as discrete dynamics"""
+        return self.__code_target
+
+    @property
+    def memory_allocation(self):
+        """Memory allocation of the generated solver: 'DYNAMIC' allocates on the heap,
+        'STATIC' uses a static buffer (single solver instance) whose size is computed at
+        code generation, no heap memory is allocated in initialization and solver calls.
+        The size is measured by running a probe on the build host (make ocp_solver_memory_size),
+        when cross-compiling the probe has to be run on the target instead"""
+        return self.__memory_allocation
+
+    @property
+    def nls_cost_evaluation(self):
+        """Evaluation of the NONLINEAR_LS stage cost: 'STAGE_WISE' evaluates the residual
+        function of each stage separately, 'BATCH' evaluates all the stages with a single call
+        of its CasADi map over the shooting nodes before the stage-wise loops"""
+        return self.__nls_cost_evaluation
+
     @property
     def nlp_solver_type(self):
         """NLP solver"""
@@ -1701,7 +1727,7 @@ class AcadosOcpOptions:
     @qp_solver.setter
     def qp_solver(self, qp_solver):
         qp_solvers = ('PARTIAL_CONDENSING_HPIPM', 'PARTIAL_CONDENSING_QPOASES', \
-                'FULL_CONDENSING_QPOASES', 'FULL_CONDENSING_HPIPM')
+                'PARTIAL_CONDENSING_PARTITIONED_IPM', 'FULL_CONDENSING_QPOASES', 'FULL_CONDENSING_HPIPM')
 
         if type(qp_solver) == str and qp_solver in qp_solvers:
             self.__qp_solver = qp_solver
@@ -1728,6 +1754,36 @@ class AcadosOcpOptions:
             raise Exception('Invalid integrator_type value. Possible values are:\n\n' \
                     + ',\n'.join(integrator_types) + '.\n\nYou have: ' + integrator_type + '.\n\nExiting.')
 
+    @code_target.setter
+    def code_target(self, code_target):
+        code_targets = ('GENERIC', 'SPECIALIZED')
+
+        if type(code_target) == str and code_target in code_targets:
+            self.__code_target = code_target
+        else:
+            raise Exception('Invalid code_target value. Possible values are:\n\n' \
+                    + ',\n'.join(code_targets) + '.\n\nYou have: ' + code_target + '.\n\nExiting.')
+
+    @nls_cost_evaluation.setter
+    def nls_cost_evaluation(self, nls_cost_evaluation):
+        nls_cost_evaluations = ('STAGE_WISE', 'BATCH')
+
+        if type(nls_cost_evaluation) == str and nls_cost_evaluation in nls_cost_evaluations:
+            self.__nls_cost_evaluation = nls_cost_evaluation
+        else:
+            raise Exception('Invalid nls_cost_evaluation value. Possible values are:\n\n' \
+                    + ',\n'.join(nls_cost_evaluations) + '.\n\nYou have: ' + nls_cost_evaluation + '.\n\nExiting.')
+
+    @memory_allocation.setter
+    def memory_allocation(self, memory_allocation):
+        memory_allocations = ('DYNAMIC', 'STATIC')
+
+        if type(memory_allocation) == str and memory_allocation in memory_allocations:
+            self.__memory_allocation = memory_allocation
+        else:
+            raise Exception('Invalid memory_allocation value. Possible values are:\n\n' \
+                    + ',\n'.join(memory_allocations) + '.\n\nYou have: ' + memory_allocation + '.\n\nExiting.')
+
     @tf.setter
     def tf(self, tf):
         self.__tf = tf
@@ -41,6 +41,7 @@ from casadi import CasadiMeta, Function
 from copy import deepcopy
 
 from .generate_c_code_explicit_ode import generate_c_code_explicit_ode
+from .generate_c_code_erk_specialized import generate_c_code_erk_specialized
 from .generate_c_code_implicit_ode import generate_c_code_implicit_ode
 from .generate_c_code_gnsf import generate_c_code_gnsf
 from .generate_c_code_constraint import generate_c_code_constraint
@@ -205,6 +206,10 @@ def ocp_generate_external_functions(acados_ocp, model):
     if acados_ocp.solver_options.integrator_type == 'ERK':
         # explicit model -- generate C code
         generate_c_code_explicit_ode(model)
+        if acados_ocp.solver_options.code_target == 'SPECIALIZED':
+            opts = acados_ocp.solver_options
+            generate_c_code_erk_specialized(model, opts.Tsim, opts.sim_method_num_stages, \
+                opts.sim_method_num_steps, opts.hessian_approx == 'EXACT')
     elif acados_ocp.solver_options.integrator_type == 'IRK':
         # implicit model -- generate C code
         opts = dict(generate_hess=1)
@@ -214,6 +219,10 @@ def ocp_generate_external_functions(acados_ocp, model):
     else:
         raise Exception("ocp_generate_external_functions: unknown integrator type.")
 
+    if acados_ocp.solver_options.code_target == 'SPECIALIZED' and \
+        acados_ocp.solver_options.integrator_type != 'ERK':
+        raise Exception("ocp_generate_external_functions: code_target 'SPECIALIZED' requires integrator_type 'ERK'.")
+
 
     if acados_ocp.dims.nphi > 0 or acados_ocp.dims.nh > 0:
         generate_c_code_constraint(model, model.name, False)
@@ -230,7 +239,10 @@ def ocp_generate_external_functions(acados_ocp, model):
 
 
     if acados_ocp.cost.cost_type == 'NONLINEAR_LS':
-        generate_c_code_nls_cost(model, model.name, False)
+        if acados_ocp.solver_options.nls_cost_evaluation == 'BATCH':
+            generate_c_code_nls_cost(model, model.name, False, acados_ocp.dims.N)
+        else:
+            generate_c_code_nls_cost(model, model.name, False)
     elif acados_ocp.cost.cost_type == 'EXTERNAL':
         generate_c_code_external_cost(model, False)
 
@@ -271,6 +283,15 @@ def ocp_render_templates(acados_ocp, json_file):
     out_file = 'Makefile'
     render_template(in_file, out_file, template_dir, json_path)
 
+    if acados_ocp.solver_options.memory_allocation == 'STATIC':
+        in_file = 'memory_size.in.c'
+        out_file = 'memory_size_{}.c'.format(name)
+        render_template(in_file, out_file, template_dir, json_path)
+
+        in_file = 'no_malloc_test.in.c'
+        out_file = 'no_malloc_test_{}.c'.format(name)
+        render_template(in_file, out_file, template_dir, json_path)
+
     in_file = 'acados_solver_sfun.in.c'
     out_file = 'acados_solver_sfunction_{}.c'.format(name)
     render_template(in_file, out_file, template_dir, json_path)
@@ -359,7 +380,12 @@ class AcadosOcpSolver:
     """
     class to interact with the acados ocp solver C object
     """
-    def __init__(self, acados_ocp, json_file='acados_ocp_nlp.json'):
+    def __init__(self, acados_ocp, json_file='acados_ocp_nlp.json', build=True):
+        """
+        :param build: generate and compile the solver; pass False to create a further
+         instance of a solver already built in this process (each instance owns its own
+         solver capsule, so instances can be used concurrently, e.g. one per thread)
+        """
 
         model = acados_ocp.model
 
@@ -372,48 +398,63 @@ class AcadosOcpSolver:
         # set integrator time automatically
         acados_ocp.solver_options.Tsim = acados_ocp.solver_options.tf / acados_ocp.dims.N
 
-        # generate external functions
-        ocp_generate_external_functions(acados_ocp, model)
+        if build:
+            # generate external functions
+            ocp_generate_external_functions(acados_ocp, model)
 
-        # dump to json
-        ocp_formulation_json_dump(acados_ocp, json_file)
+            # dump to json
+            ocp_formulation_json_dump(acados_ocp, json_file)
 
-        # render templates
-        ocp_render_templates(acados_ocp, json_file)
+            # render templates
+            ocp_render_templates(acados_ocp, json_file)
 
-        ## Compile solver
-        os.chdir('c_generated_code')
-        os.system('make clean_ocp_shared_lib')
-        os.system('make ocp_shared_lib')
-        os.chdir('..')
+            ## Compile solver
+            os.chdir('c_generated_code')
+            os.system('make clean_ocp_shared_lib')
+            os.system('make ocp_shared_lib')
+            os.chdir('..')
 
         self.shared_lib_name = 'c_generated_code/libacados_ocp_solver_' + model.name + '.so'
+        self.model_name = model.name
 
         # get
         self.shared_lib = CDLL(self.shared_lib_name)
-        self.shared_lib.acados_create()
-
-        self.shared_lib.acados_get_nlp_opts.restype = c_void_p
-        self.nlp_opts = self.shared_lib.acados_get_nlp_opts()
 
-        self.shared_lib.acados_get_nlp_dims.restype = c_void_p
-        self.nlp_dims = self.shared_lib.acados_get_nlp_dims()
+        getattr(self.shared_lib, f"{model.name}_acados_create_capsule").restype = c_void_p
+        self.capsule = getattr(self.shared_lib, f"{model.name}_acados_create_capsule")()
 
-        self.shared_lib.acados_get_nlp_config.restype = c_void_p
-        self.nlp_config = self.shared_lib.acados_get_nlp_config()
+        getattr(self.shared_lib, f"{model.name}_acados_create").argtypes = [c_void_p]
+        getattr(self.shared_lib, f"{model.name}_acados_create").restype = c_int
+        getattr(self.shared_lib, f"{model.name}_acados_create")(self.capsule)
 
-        self.shared_lib.acados_get_nlp_out.restype = c_void_p
-        self.nlp_out = self.shared_lib.acados_get_nlp_out()
+        self.nlp_opts = self._capsule_get('nlp_opts')
+        self.nlp_dims = self._capsule_get('nlp_dims')
+        self.nlp_config = self._capsule_get('nlp_config')
+        self.nlp_out = self._capsule_get('nlp_out')
+        self.nlp_in = self._capsule_get('nlp_in')
+        self.nlp_solver = self._capsule_get('nlp_solver')
 
-        self.shared_lib.acados_get_nlp_in.restype = c_void_p
-        self.nlp_in = self.shared_lib.acados_get_nlp_in()
+        self.shared_lib.ocp_nlp_dims_get_trajectory.argtypes = \
+            [c_void_p, c_void_p, c_char_p, POINTER(c_int)]
+        self.shared_lib.ocp_nlp_dims_get_trajectory.restype = c_int
+        self.shared_lib.ocp_nlp_out_get_trajectory.argtypes = \
+            [c_void_p, c_void_p, c_void_p, c_char_p, POINTER(c_double)]
+        self.shared_lib.ocp_nlp_out_set_trajectory.argtypes = \
+            [c_void_p, c_void_p, c_void_p, c_char_p, POINTER(c_double)]
 
-        self.shared_lib.acados_get_nlp_solver.restype = c_void_p
-        self.nlp_solver = self.shared_lib.acados_get_nlp_solver()
+        # trajectory buffers, allocated on first use: field -> (array, data pointer)
+        self.trajectory_buffers = {}
 
         self.acados_ocp = acados_ocp
 
 
+    def _capsule_get(self, field_):
+        getter = getattr(self.shared_lib, f"{self.model_name}_acados_get_{field_}")
+        getter.argtypes = [c_void_p]
+        getter.restype = c_void_p
+        return getter(self.capsule)
+
+
     def solve(self, rti_phase=0):
         """
         solve the ocp with current input
@@ -426,12 +467,24 @@ class AcadosOcpSolver:
         if self.acados_ocp.solver_options.nlp_solver_type != 'SQP_RTI' and rti_phase > 0:
             raise Exception('AcadosOcpSolver.solve(): argument \'rti_phase\' can ' 
                 'take only value 0 for SQP-type solvers')
-        self.shared_lib.acados_solve.argtypes = [c_int]
-
-        status = self.shared_lib.acados_solve(rti_phase)
+        getattr(self.shared_lib, f"{self.model_name}_acados_solve").argtypes = [c_void_p]
+        getattr(self.shared_lib, f"{self.model_name}_acados_solve").restype = c_int
+        status = getattr(self.shared_lib, f"{self.model_name}_acados_solve")(self.capsule)
         return status
 
 
+    def shift(self):
+        """
+        shift the solution by one stage, as initial guess for the next sample;
+        the terminal stage is initialized according to the solver option 'shift_policy'
+        (0 = copy, 1 = simulate, 2 = LQR)
+        """
+        self.shared_lib.ocp_nlp_shift.argtypes = [c_void_p, c_void_p, c_void_p]
+        self.shared_lib.ocp_nlp_shift(self.nlp_solver, self.nlp_in, self.nlp_out)
+
+        return
+
+
     def get(self, stage_, field_):
         """
         get the last solution of the solver:
@@ -466,6 +519,106 @@ class AcadosOcpSolver:
 
         return out
 
+    def _trajectory_buffer(self, field_):
+        if field_ not in self.trajectory_buffers:
+            out_fields = ['x', 'u', 'z', 'pi', 'lam']
+            if field_ not in out_fields:
+                raise Exception('AcadosOcpSolver: {} is not a valid trajectory field.\
+                        \n Possible values are {}. Exiting.'.format(field_, out_fields))
+
+            N = self.acados_ocp.dims.N
+            lens = np.zeros((N+1,), dtype=np.intc)
+            len_tot = self.shared_lib.ocp_nlp_dims_get_trajectory(self.nlp_config, \
+                self.nlp_dims, field_.encode('utf-8'), lens.ctypes.data_as(POINTER(c_int)))
+
+            # stages one per row if their dimensions agree, flat otherwise
+            lens = lens[lens > 0]
+            if lens.size > 0 and np.all(lens == lens[0]):
+                shape = (lens.size, lens[0])
+            else:
+                shape = (len_tot,)
+
+            buf = np.zeros(shape, dtype=np.float64)
+            self.trajectory_buffers[field_] = (buf, buf.ctypes.data_as(POINTER(c_double)))
+
+        return self.trajectory_buffers[field_]
+
+
+    def get_trajectory(self, field_):
+        """
+        get the last solution of the solver at all the shooting nodes in one call:
+            :param field_: string in ['x', 'u', 'z', 'pi', 'lam']
+
+        returns an array with one row per shooting node (nodes of dimension zero, e.g. u at
+        node N, are skipped); the array is a buffer of the solver, overwritten by the next call
+        of get_trajectory for the same field, copy it to keep the values
+        """
+        buf, buf_data = self._trajectory_buffer(field_)
+
+        self.shared_lib.ocp_nlp_out_get_trajectory(self.nlp_config, \
+            self.nlp_dims, self.nlp_out, field_.encode('utf-8'), buf_data)
+
+        return buf
+
+
+    def set_trajectory(self, field_, value_):
+        """
+        set the initial guess at all the shooting nodes in one call:
+            :param field_: string in ['x', 'u', 'z', 'pi', 'lam']
+            :param value_: array laid out as returned by get_trajectory
+        """
+        buf, buf_data = self._trajectory_buffer(field_)
+
+        value_ = np.asarray(value_, dtype=np.float64)
+        if value_.size != buf.size:
+            raise Exception('AcadosOcpSolver.set_trajectory(): mismatching dimension' \
+                ' for field "{}" with dimension {} (you have {})'.format(field_, buf.shape, value_.shape))
+
+        # no copy if value_ already is a contiguous array of doubles
+        value_ = np.ascontiguousarray(value_)
+        self.shared_lib.ocp_nlp_out_set_trajectory(self.nlp_config, \
+            self.nlp_dims, self.nlp_out, field_.encode('utf-8'), \
+            value_.ctypes.data_as(POINTER(c_double)))
+
+        return
+
+
+    def snapshot_save(self, file_name):
+        """
+        write the numerical state of the solver (iterate, qp solution, integrator guesses,
+        bounds, references) to a binary file
+            :param file_name: name of the file
+        """
+        self.shared_lib.ocp_nlp_snapshot_save.argtypes = \
+            [c_void_p, c_void_p, c_void_p, c_void_p, c_void_p, c_char_p]
+        self.shared_lib.ocp_nlp_snapshot_save.restype = c_int
+        status = self.shared_lib.ocp_nlp_snapshot_save(self.nlp_config, self.nlp_dims, \
+            self.nlp_in, self.nlp_out, self.nlp_solver, file_name.encode('utf-8'))
+
+        if status != 0:
+            raise Exception('AcadosOcpSolver.snapshot_save(): cannot write {}.'.format(file_name))
+
+        return
+
+
+    def snapshot_load(self, file_name):
+        """
+        restore the numerical state of the solver from a file written by snapshot_save,
+        the next call to solve resumes from the saved iterate
+            :param file_name: name of the file
+        """
+        self.shared_lib.ocp_nlp_snapshot_load.argtypes = \
+            [c_void_p, c_void_p, c_void_p, c_void_p, c_void_p, c_char_p]
+        self.shared_lib.ocp_nlp_snapshot_load.restype = c_int
+        status = self.shared_lib.ocp_nlp_snapshot_load(self.nlp_config, self.nlp_dims, \
+            self.nlp_in, self.nlp_out, self.nlp_solver, file_name.encode('utf-8'))
+
+        if status != 0:
+            raise Exception('AcadosOcpSolver.snapshot_load(): {} does not match the solver.'.format(file_name))
+
+        return
+
+
     def get_stats(self, field_):
         """
         get the information of the last solver call:
@@ -515,10 +668,12 @@ class AcadosOcpSolver:
 
         # treat parameters separately
         if field_ is 'p':
-            self.shared_lib.acados_update_params.argtypes = [c_int, POINTER(c_double)]
-            self.shared_lib.acados_update_params.restype = c_int
+            getattr(self.shared_lib, f"{self.model_name}_acados_update_params").argtypes = \
+                [c_void_p, c_int, POINTER(c_double), c_int]
+            getattr(self.shared_lib, f"{self.model_name}_acados_update_params").restype = c_int
             value_data = cast(value_.ctypes.data, POINTER(c_double))
-            self.shared_lib.acados_update_params(stage, value_data, value_.shape[0])
+            getattr(self.shared_lib, f"{self.model_name}_acados_update_params")(self.capsule, \
+                stage, value_data, value_.shape[0])
         else:
             if (field_ not in constraints_fields) and \
                     (field_ not in cost_fields) and (field_ not in out_fields):
@@ -672,7 +827,10 @@ class AcadosOcpSolver:
         return
 
     def __del__(self):
-        self.shared_lib.acados_free()
+        getattr(self.shared_lib, f"{self.model_name}_acados_free").argtypes = [c_void_p]
+        getattr(self.shared_lib, f"{self.model_name}_acados_free")(self.capsule)
+        getattr(self.shared_lib, f"{self.model_name}_acados_free_capsule").argtypes = [c_void_p]
+        getattr(self.shared_lib, f"{self.model_name}_acados_free_capsule")(self.capsule)
         del self.shared_lib
 
         # NOTE: DLL cannot be easily unloaded!!!
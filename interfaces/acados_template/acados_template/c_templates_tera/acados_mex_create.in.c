@@ -68,6 +68,7 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     ocp_nlp_out *nlp_out = acados_get_nlp_out();
     ocp_nlp_solver *nlp_solver = acados_get_nlp_solver();
     void *nlp_opts = acados_get_nlp_opts();
+    {{ model.name }}_solver_capsule *capsule = acados_get_capsule();
 
     // mexPrintf("acados: got pointer to objectes!\n");
 
@@ -173,22 +174,22 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {% if solver_options.integrator_type == "ERK" %}
     {# TODO: remove _casadi from these names.. #}
     l_ptr = mxGetData(forw_vde_mat);
-    l_ptr[0] = (long long) forw_vde_casadi;
+    l_ptr[0] = (long long) capsule->forw_vde_casadi;
     // mexPrintf("\nforw vde %p\n", forw_vde_casadi);
 {% if solver_options.hessian_approx == "EXACT" %}
     l_ptr = mxGetData(hess_vde_mat);
-    l_ptr[0] = (long long) hess_vde_casadi;
+    l_ptr[0] = (long long) capsule->hess_vde_casadi;
 {%- endif %}
 {% elif solver_options.integrator_type == "IRK" %}
     // extern external_function_param_casadi * impl_dae_fun;
     l_ptr = mxGetData(impl_dae_fun_mat);
-    l_ptr[0] = (long long) impl_dae_fun;
+    l_ptr[0] = (long long) capsule->impl_dae_fun;
     // extern external_function_param_casadi * impl_dae_fun_jac_x_xdot_z;
     l_ptr = mxGetData(impl_dae_fun_jac_x_xdot_z_mat);
-    l_ptr[0] = (long long) impl_dae_fun_jac_x_xdot_z;
+    l_ptr[0] = (long long) capsule->impl_dae_fun_jac_x_xdot_z;
     // extern external_function_param_casadi * impl_dae_jac_x_xdot_u_z;
     l_ptr = mxGetData(impl_dae_jac_x_xdot_u_z_mat);
-    l_ptr[0] = (long long) impl_dae_jac_x_xdot_u_z;
+    l_ptr[0] = (long long) capsule->impl_dae_jac_x_xdot_u_z;
 {%- endif %}
     mxSetField(plhs[1], 0, "forw_vde", forw_vde_mat);
     mxSetField(plhs[1], 0, "hess_vde", hess_vde_mat);
@@ -201,20 +202,20 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     mxArray *phi_constraint_mat = mxCreateNumericMatrix(1, 2, mxINT64_CLASS, mxREAL);
     l_ptr = mxGetData(phi_constraint_mat);
 {%- if constraints.constr_type == "BGP" %}
-    l_ptr[0] = (long long) phi_constraint;
+    l_ptr[0] = (long long) capsule->phi_constraint;
 {% endif %}
 {% if constraints.constr_type_e == "BGP" %}
-    l_ptr[1] = (long long) &phi_e_constraint;
+    l_ptr[1] = (long long) &capsule->phi_e_constraint;
 {% endif %}
     mxSetField(plhs[1], 0, "phi_constraint", phi_constraint_mat);
 
     mxArray *h_constraint_mat  = mxCreateNumericMatrix(1, 2, mxINT64_CLASS, mxREAL);
     l_ptr = mxGetData(h_constraint_mat);
 {% if constraints.constr_type == "BGH" and dims.nh > 0 %}
-    l_ptr[0] = (long long) h_constraint;
+    l_ptr[0] = (long long) capsule->h_constraint;
 {% endif %}
 {% if constraints.constr_type_e == "BGH" and dims.nh_e > 0 %}
-    l_ptr[1] = (long long) &h_e_constraint;
+    l_ptr[1] = (long long) &capsule->h_e_constraint;
 {%- endif %}
     mxSetField(plhs[1], 0, "h_constraint", h_constraint_mat);
 
@@ -34,13 +34,20 @@
 // standard
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 // acados
 #include "acados/utils/print.h"
+#include "acados/utils/mem.h"
 #include "acados_c/ocp_nlp_interface.h"
 #include "acados_c/external_function_interface.h"
 
 // example specific
 #include "{{ model.name }}_model/{{ model.name }}_model.h"
+{%- if solver_options.memory_allocation == "STATIC" %}
+#ifndef {{ model.name }}_MEMORY_SIZE_PROBE
+#include "acados_solver_{{ model.name }}_memory.h"
+#endif
+{%- endif %}
 {% if constraints.constr_type == "BGP" and dims.nphi %}
 #include "{{ model.name }}_constraints/{{ model.name }}_phi_constraint.h"
 // #include "{{ model.name }}_r_constraint/{{ model.name }}_r_constraint.h"
@@ -97,61 +104,88 @@
 #define NR     {{ dims.nr }}
 
 
-// ** global data **
-ocp_nlp_in * nlp_in;
-ocp_nlp_out * nlp_out;
-ocp_nlp_solver * nlp_solver;
-void * nlp_opts;
-ocp_nlp_plan * nlp_solver_plan;
-ocp_nlp_config * nlp_config;
-ocp_nlp_dims * nlp_dims;
+/************************************************
+* memory
+************************************************/
+{%- if solver_options.memory_allocation == "STATIC" %}
+#ifndef {{ model.name }}_MEMORY_SIZE_PROBE
+// single static instance, the memory size is computed at code generation by the
+// memory size probe (make ocp_solver_memory_size)
+static {{ model.name }}_solver_capsule {{ model.name }}_static_capsule;
+static int {{ model.name }}_static_capsule_in_use = 0;
+// 64 bytes more than needed, aligned to 64 bytes in {{ model.name }}_acados_alloc
+static char {{ model.name }}_static_memory[{{ model.name }}_STATIC_MEMORY_SIZE + 64];
+#endif
+{%- endif %}
 
-{% if solver_options.integrator_type == "ERK" %}
-external_function_param_casadi * forw_vde_casadi;
-{% if solver_options.hessian_approx == "EXACT" %}
-external_function_param_casadi * hess_vde_casadi;
+// zeroed memory for the acados objects and the external functions of the capsule,
+// capsule->memory_size accumulates the size in multiples of 64 bytes
+static void *{{ model.name }}_acados_alloc({{ model.name }}_solver_capsule *capsule, int bytes)
+{
+    int aligned_bytes = (bytes + 63) / 64 * 64;
+{%- if solver_options.memory_allocation == "STATIC" %}
+#ifndef {{ model.name }}_MEMORY_SIZE_PROBE
+    if (capsule->memory_size + aligned_bytes > {{ model.name }}_STATIC_MEMORY_SIZE)
+    {
+        printf("{{ model.name }}_acados_alloc: static memory of %d bytes exceeded. Exiting.\n",
+               {{ model.name }}_STATIC_MEMORY_SIZE);
+        exit(1);
+    }
+    char *static_memory = {{ model.name }}_static_memory;
+    align_char_to(64, &static_memory);
+    void *ptr = static_memory + capsule->memory_size;
+    memset(ptr, 0, aligned_bytes);
+    capsule->memory_size += aligned_bytes;
+    return ptr;
+#endif
 {%- endif %}
-{% elif solver_options.integrator_type == "IRK" -%}
-external_function_param_casadi * impl_dae_fun;
-external_function_param_casadi * impl_dae_fun_jac_x_xdot_z;
-external_function_param_casadi * impl_dae_jac_x_xdot_u_z;
-{% elif solver_options.integrator_type == "GNSF" -%}
-external_function_param_casadi * gnsf_phi_fun;
-external_function_param_casadi * gnsf_phi_fun_jac_y;
-external_function_param_casadi * gnsf_phi_jac_y_uhat;
-external_function_param_casadi * gnsf_f_lo_jac_x1_x1dot_u_z;
-external_function_param_casadi * gnsf_get_matrices_fun;
+    capsule->memory_size += aligned_bytes;
+    return calloc(1, bytes);
+}
+
+
+static void {{ model.name }}_acados_external_function_create({{ model.name }}_solver_capsule *capsule,
+                                                 external_function_param_casadi *fun, int np)
+{
+    int bytes = external_function_param_casadi_calculate_size(fun, np);
+    external_function_param_casadi_assign(fun, {{ model.name }}_acados_alloc(capsule, bytes));
+}
+
+
+{{ model.name }}_solver_capsule * {{ model.name }}_acados_create_capsule()
+{
+{%- if solver_options.memory_allocation == "STATIC" %}
+#ifndef {{ model.name }}_MEMORY_SIZE_PROBE
+    if ({{ model.name }}_static_capsule_in_use)
+    {
+        printf("{{ model.name }}_acados_create_capsule: the static capsule is already in use.\n");
+        return NULL;
+    }
+    {{ model.name }}_static_capsule_in_use = 1;
+    memset(&{{ model.name }}_static_capsule, 0, sizeof({{ model.name }}_solver_capsule));
+    return &{{ model.name }}_static_capsule;
+#endif
 {%- endif %}
+    {{ model.name }}_solver_capsule *capsule = calloc(1, sizeof({{ model.name }}_solver_capsule));
 
-{% if constraints.constr_type == "BGH" %}
-external_function_param_casadi * h_constraint;
-{%- elif constraints.constr_type == "BGP" %}
-external_function_param_casadi * phi_constraint;
-// external_function_param_casadi * r_constraint;
-{% endif %}
+    return capsule;
+}
 
-{% if constraints.constr_type_e == "BGH" %}
-external_function_param_casadi h_e_constraint;
-{% elif constraints.constr_type_e == "BGP" %}
-external_function_param_casadi phi_e_constraint;
-// external_function_param_casadi r_e_constraint;
-{% endif %}
 
-{% if cost.cost_type == "NONLINEAR_LS" %}
-external_function_param_casadi * r_cost;
-{% elif cost.cost_type == "EXTERNAL" %}
-external_function_param_casadi * ext_cost_fun;
-external_function_param_casadi * ext_cost_fun_jac_hess;
-{% endif %}
-{% if cost.cost_type_e == "NONLINEAR_LS" %}
-external_function_param_casadi r_e_cost;
-{% elif cost.cost_type_e == "EXTERNAL" %}
-external_function_param_casadi ext_cost_e_fun;
-external_function_param_casadi ext_cost_e_fun_jac_hess;
-{% endif %}
+int {{ model.name }}_acados_free_capsule({{ model.name }}_solver_capsule *capsule)
+{
+{%- if solver_options.memory_allocation == "STATIC" %}
+#ifndef {{ model.name }}_MEMORY_SIZE_PROBE
+    {{ model.name }}_static_capsule_in_use = 0;
+    return 0;
+#endif
+{%- endif %}
+    free(capsule);
+    return 0;
+}
 
 
-int acados_create()
+int {{ model.name }}_acados_create({{ model.name }}_solver_capsule *capsule)
 {
     int status = 0;
 
@@ -160,44 +194,51 @@ int acados_create()
     /************************************************
     *  plan & config
     ************************************************/
-    nlp_solver_plan = ocp_nlp_plan_create(N);
+    capsule->nlp_solver_plan = ocp_nlp_plan_assign(N,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_plan_calculate_size(N)));
     {%- if solver_options.nlp_solver_type == "SQP" %}
-    nlp_solver_plan->nlp_solver = SQP;
+    capsule->nlp_solver_plan->nlp_solver = SQP;
     {% else %}
-    nlp_solver_plan->nlp_solver = SQP_RTI;
+    capsule->nlp_solver_plan->nlp_solver = SQP_RTI;
     {%- endif %}
 
-    nlp_solver_plan->ocp_qp_solver_plan.qp_solver = {{ solver_options.qp_solver }};
+    capsule->nlp_solver_plan->ocp_qp_solver_plan.qp_solver = {{ solver_options.qp_solver }};
     for (int i = 0; i < N; i++)
-        nlp_solver_plan->nlp_cost[i] = {{ cost.cost_type }};
+        capsule->nlp_solver_plan->nlp_cost[i] = {{ cost.cost_type }};
 
-    nlp_solver_plan->nlp_cost[N] = {{ cost.cost_type_e }};
+    capsule->nlp_solver_plan->nlp_cost[N] = {{ cost.cost_type_e }};
 
     for (int i = 0; i < N; i++)
     {
-        nlp_solver_plan->nlp_dynamics[i] = CONTINUOUS_MODEL;
-        nlp_solver_plan->sim_solver_plan[i].sim_solver = {{ solver_options.integrator_type }};
+    {%- if solver_options.code_target == "SPECIALIZED" %}
+        // integrator unrolled into discrete dynamics at code generation
+        capsule->nlp_solver_plan->nlp_dynamics[i] = DISCRETE_MODEL;
+    {%- else %}
+        capsule->nlp_solver_plan->nlp_dynamics[i] = CONTINUOUS_MODEL;
+        capsule->nlp_solver_plan->sim_solver_plan[i].sim_solver = {{ solver_options.integrator_type }};
+    {%- endif %}
     }
 
     for (int i = 0; i < N; i++)
     {
         {% if constraints.constr_type == "BGP" %}
-        nlp_solver_plan->nlp_constraints[i] = BGP;
+        capsule->nlp_solver_plan->nlp_constraints[i] = BGP;
         {%- else -%}
-        nlp_solver_plan->nlp_constraints[i] = BGH;
+        capsule->nlp_solver_plan->nlp_constraints[i] = BGH;
         {%- endif %}
     }
 
     {%- if constraints.constr_type_e == "BGP" %}
-    nlp_solver_plan->nlp_constraints[N] = BGP;
+    capsule->nlp_solver_plan->nlp_constraints[N] = BGP;
     {% else %}
-    nlp_solver_plan->nlp_constraints[N] = BGH;
+    capsule->nlp_solver_plan->nlp_constraints[N] = BGH;
     {%- endif %}
 
     {% if solver_options.hessian_approx == "EXACT" %} 
-    nlp_solver_plan->regularization = CONVEXIFY;
+    capsule->nlp_solver_plan->regularization = CONVEXIFY;
     {%- endif %}
-    nlp_config = ocp_nlp_config_create(*nlp_solver_plan);
+    capsule->nlp_config = ocp_nlp_config_assign_from_plan(*capsule->nlp_solver_plan,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_config_calculate_size(N)));
 
 
     /************************************************
@@ -216,6 +257,7 @@ int acados_create()
     int nh[N+1];
     int nphi[N+1];
     int nz[N+1];
+    int np[N+1];
     int ny[N+1];
     int nr[N+1];
     int nr_e[N+1];
@@ -227,6 +269,7 @@ int acados_create()
         nu[i]     = NU;
         nz[i]     = NZ;
         ns[i]     = NS;
+        np[i]     = NP;
         // cost
         ny[i]     = NY;
         // constraints
@@ -267,47 +310,49 @@ int acados_create()
     nsphi[N] = NSPHIN;
 
     /* create and set ocp_nlp_dims */
-    nlp_dims = ocp_nlp_dims_create(nlp_config);
+    capsule->nlp_dims = ocp_nlp_dims_assign(capsule->nlp_config,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_dims_calculate_size(capsule->nlp_config)));
 
-    ocp_nlp_dims_set_opt_vars(nlp_config, nlp_dims, "nx", nx);
-    ocp_nlp_dims_set_opt_vars(nlp_config, nlp_dims, "nu", nu);
-    ocp_nlp_dims_set_opt_vars(nlp_config, nlp_dims, "nz", nz);
-    ocp_nlp_dims_set_opt_vars(nlp_config, nlp_dims, "ns", ns);
+    ocp_nlp_dims_set_opt_vars(capsule->nlp_config, capsule->nlp_dims, "nx", nx);
+    ocp_nlp_dims_set_opt_vars(capsule->nlp_config, capsule->nlp_dims, "nu", nu);
+    ocp_nlp_dims_set_opt_vars(capsule->nlp_config, capsule->nlp_dims, "nz", nz);
+    ocp_nlp_dims_set_opt_vars(capsule->nlp_config, capsule->nlp_dims, "ns", ns);
+    ocp_nlp_dims_set_opt_vars(capsule->nlp_config, capsule->nlp_dims, "np", np);
 
     for (int i = 0; i <= N; i++)
     {
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nbx", &nbx[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nbu", &nbu[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nsbx", &nsbx[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nsbu", &nsbu[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "ng", &ng[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nbx", &nbx[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nbu", &nbu[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nsbx", &nsbx[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nsbu", &nsbu[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "ng", &ng[i]);
     }
 
     for (int i = 0; i < N; i++)
     {
         {%- if constraints.constr_type == "BGH" and dims.nh > 0 %}
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nh", &nh[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nsh", &nsh[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nh", &nh[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nsh", &nsh[i]);
         {%- elif constraints.constr_type == "BGP" and dims.nphi > 0 %}
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nr", &nr[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nphi", &nphi[i]);
-        ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, i, "nsphi", &nsphi[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nr", &nr[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nphi", &nphi[i]);
+        ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, i, "nsphi", &nsphi[i]);
         {%- endif %}
         {%- if cost.cost_type == "NONLINEAR_LS" or cost.cost_type == "LINEAR_LS" %}
-        ocp_nlp_dims_set_cost(nlp_config, nlp_dims, i, "ny", &ny[i]);
+        ocp_nlp_dims_set_cost(capsule->nlp_config, capsule->nlp_dims, i, "ny", &ny[i]);
         {%- endif %}
     }
 
     {%- if constraints.constr_type_e == "BGH" %}
-    ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, N, "nh", &nh[N]);
-    ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, N, "nsh", &nsh[N]);
+    ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, N, "nh", &nh[N]);
+    ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, N, "nsh", &nsh[N]);
     {%- elif constraints.constr_type_e == "BGP" %}
-    ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, N, "nr", &nr[N]);
-    ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, N, "nphi", &nphi[N]);
-    ocp_nlp_dims_set_constraints(nlp_config, nlp_dims, N, "nsphi", &nsphi[N]);
+    ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, N, "nr", &nr[N]);
+    ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, N, "nphi", &nphi[N]);
+    ocp_nlp_dims_set_constraints(capsule->nlp_config, capsule->nlp_dims, N, "nsphi", &nsphi[N]);
     {%- endif %}
     {%- if cost.cost_type_e == "NONLINEAR_LS" or cost.cost_type_e == "LINEAR_LS" %}
-    ocp_nlp_dims_set_cost(nlp_config, nlp_dims, N, "ny", &ny[N]);
+    ocp_nlp_dims_set_cost(capsule->nlp_config, capsule->nlp_dims, N, "ny", &ny[N]);
     {%- endif %}
 
 {% if solver_options.integrator_type == "GNSF" -%}
@@ -320,13 +365,13 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        if (nlp_solver_plan->sim_solver_plan[i].sim_solver == GNSF)
+        if (capsule->nlp_solver_plan->sim_solver_plan[i].sim_solver == GNSF)
         {
-            ocp_nlp_dims_set_dynamics(nlp_config, nlp_dims, i, "gnsf_nx1", &gnsf_nx1);
-            ocp_nlp_dims_set_dynamics(nlp_config, nlp_dims, i, "gnsf_nz1", &gnsf_nz1);
-            ocp_nlp_dims_set_dynamics(nlp_config, nlp_dims, i, "gnsf_nout", &gnsf_nout);
-            ocp_nlp_dims_set_dynamics(nlp_config, nlp_dims, i, "gnsf_ny", &gnsf_ny);
-            ocp_nlp_dims_set_dynamics(nlp_config, nlp_dims, i, "gnsf_nuhat", &gnsf_nuhat);
+            ocp_nlp_dims_set_dynamics(capsule->nlp_config, capsule->nlp_dims, i, "gnsf_nx1", &gnsf_nx1);
+            ocp_nlp_dims_set_dynamics(capsule->nlp_config, capsule->nlp_dims, i, "gnsf_nz1", &gnsf_nz1);
+            ocp_nlp_dims_set_dynamics(capsule->nlp_config, capsule->nlp_dims, i, "gnsf_nout", &gnsf_nout);
+            ocp_nlp_dims_set_dynamics(capsule->nlp_config, capsule->nlp_dims, i, "gnsf_ny", &gnsf_ny);
+            ocp_nlp_dims_set_dynamics(capsule->nlp_config, capsule->nlp_dims, i, "gnsf_nuhat", &gnsf_nuhat);
         }
     }
 {%- endif %}
@@ -335,20 +380,20 @@ int acados_create()
     *  external functions
     ************************************************/
     {%- if constraints.constr_type == "BGP" %}
-    phi_constraint = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->phi_constraint = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++)
     {
         // nonlinear part of convex-composite constraint
-        phi_constraint[i].casadi_fun = &{{ model.name }}_phi_constraint;
-        phi_constraint[i].casadi_n_in = &{{ model.name }}_phi_constraint_n_in;
-        phi_constraint[i].casadi_n_out = &{{ model.name }}_phi_constraint_n_out;
-        phi_constraint[i].casadi_sparsity_in = &{{ model.name }}_phi_constraint_sparsity_in;
-        phi_constraint[i].casadi_sparsity_out = &{{ model.name }}_phi_constraint_sparsity_out;
-        phi_constraint[i].casadi_work = &{{ model.name }}_phi_constraint_work;
-
-        external_function_param_casadi_create(&phi_constraint[i], {{ dims.np }});
+        capsule->phi_constraint[i].casadi_fun = &{{ model.name }}_phi_constraint;
+        capsule->phi_constraint[i].casadi_n_in = &{{ model.name }}_phi_constraint_n_in;
+        capsule->phi_constraint[i].casadi_n_out = &{{ model.name }}_phi_constraint_n_out;
+        capsule->phi_constraint[i].casadi_sparsity_in = &{{ model.name }}_phi_constraint_sparsity_in;
+        capsule->phi_constraint[i].casadi_sparsity_out = &{{ model.name }}_phi_constraint_sparsity_out;
+        capsule->phi_constraint[i].casadi_work = &{{ model.name }}_phi_constraint_work;
+
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->phi_constraint[i], {{ dims.np }});
     }
-    // r_constraint = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    // r_constraint = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     // for (int i = 0; i < N; i++) {
     //     // nonlinear part of convex-composite constraint
     //     r_constraint[i].casadi_fun = &{{ model.name }}_r_constraint;
@@ -364,14 +409,14 @@ int acados_create()
 
     {%- if constraints.constr_type_e == "BGP" %}
     // nonlinear part of convex-composite constraint
-    phi_e_constraint.casadi_fun = &{{ model.name }}_phi_e_constraint;
-    phi_e_constraint.casadi_n_in = &{{ model.name }}_phi_e_constraint_n_in;
-    phi_e_constraint.casadi_n_out = &{{ model.name }}_phi_e_constraint_n_out;
-    phi_e_constraint.casadi_sparsity_in = &{{ model.name }}_phi_e_constraint_sparsity_in;
-    phi_e_constraint.casadi_sparsity_out = &{{ model.name }}_phi_e_constraint_sparsity_out;
-    phi_e_constraint.casadi_work = &{{ model.name }}_phi_e_constraint_work;
-
-    external_function_param_casadi_create(&phi_e_constraint, {{ dims.np }});
+    capsule->phi_e_constraint.casadi_fun = &{{ model.name }}_phi_e_constraint;
+    capsule->phi_e_constraint.casadi_n_in = &{{ model.name }}_phi_e_constraint_n_in;
+    capsule->phi_e_constraint.casadi_n_out = &{{ model.name }}_phi_e_constraint_n_out;
+    capsule->phi_e_constraint.casadi_sparsity_in = &{{ model.name }}_phi_e_constraint_sparsity_in;
+    capsule->phi_e_constraint.casadi_sparsity_out = &{{ model.name }}_phi_e_constraint_sparsity_out;
+    capsule->phi_e_constraint.casadi_work = &{{ model.name }}_phi_e_constraint_work;
+
+    {{ model.name }}_acados_external_function_create(capsule, &capsule->phi_e_constraint, {{ dims.np }});
     
     // nonlinear part of convex-composite constraint
     // r_e_constraint.casadi_fun = &{{ model.name }}_r_e_constraint;
@@ -385,262 +430,324 @@ int acados_create()
     {% endif %}
 
     {%- if constraints.constr_type == "BGH" and dims.nh > 0  %}
-    h_constraint = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->h_constraint = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
         // nonlinear constraint
-        h_constraint[i].casadi_fun = &{{ model.name }}_constr_h_fun_jac_uxt_zt;
-        h_constraint[i].casadi_n_in = &{{ model.name }}_constr_h_fun_jac_uxt_zt_n_in;
-        h_constraint[i].casadi_n_out = &{{ model.name }}_constr_h_fun_jac_uxt_zt_n_out;
-        h_constraint[i].casadi_sparsity_in = &{{ model.name }}_constr_h_fun_jac_uxt_zt_sparsity_in;
-        h_constraint[i].casadi_sparsity_out = &{{ model.name }}_constr_h_fun_jac_uxt_zt_sparsity_out;
-        h_constraint[i].casadi_work = &{{ model.name }}_constr_h_fun_jac_uxt_zt_work;
-
-        external_function_param_casadi_create(&h_constraint[i], {{ dims.np }});
+        capsule->h_constraint[i].casadi_fun = &{{ model.name }}_constr_h_fun_jac_uxt_zt;
+        capsule->h_constraint[i].casadi_n_in = &{{ model.name }}_constr_h_fun_jac_uxt_zt_n_in;
+        capsule->h_constraint[i].casadi_n_out = &{{ model.name }}_constr_h_fun_jac_uxt_zt_n_out;
+        capsule->h_constraint[i].casadi_sparsity_in = &{{ model.name }}_constr_h_fun_jac_uxt_zt_sparsity_in;
+        capsule->h_constraint[i].casadi_sparsity_out = &{{ model.name }}_constr_h_fun_jac_uxt_zt_sparsity_out;
+        capsule->h_constraint[i].casadi_work = &{{ model.name }}_constr_h_fun_jac_uxt_zt_work;
+
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->h_constraint[i], {{ dims.np }});
     }
     {% endif %}
 
     {%- if constraints.constr_type_e == "BGH" and dims.nh_e > 0 %}
     // nonlinear constraint
-    h_e_constraint.casadi_fun = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt;
-    h_e_constraint.casadi_n_in = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_n_in;
-    h_e_constraint.casadi_n_out = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_n_out;
-    h_e_constraint.casadi_sparsity_in = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_sparsity_in;
-    h_e_constraint.casadi_sparsity_out = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_sparsity_out;
-    h_e_constraint.casadi_work = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_work;
-
-    external_function_param_casadi_create(&h_e_constraint, {{ dims.np }});
+    capsule->h_e_constraint.casadi_fun = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt;
+    capsule->h_e_constraint.casadi_n_in = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_n_in;
+    capsule->h_e_constraint.casadi_n_out = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_n_out;
+    capsule->h_e_constraint.casadi_sparsity_in = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_sparsity_in;
+    capsule->h_e_constraint.casadi_sparsity_out = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_sparsity_out;
+    capsule->h_e_constraint.casadi_work = &{{ model.name }}_constr_h_e_fun_jac_uxt_zt_work;
+
+    {{ model.name }}_acados_external_function_create(capsule, &capsule->h_e_constraint, {{ dims.np }});
+    {%- endif %}
+
+{% if solver_options.integrator_type == "ERK" and solver_options.code_target == "SPECIALIZED" %}
+    // discrete dynamics: one ERK step with fixed dimensions, stages and steps
+    capsule->disc_dyn_fun = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
+    for (int i = 0; i < N; i++) {
+        capsule->disc_dyn_fun[i].casadi_fun = &{{ model.name }}_dyn_disc_phi_fun;
+        capsule->disc_dyn_fun[i].casadi_n_in = &{{ model.name }}_dyn_disc_phi_fun_n_in;
+        capsule->disc_dyn_fun[i].casadi_n_out = &{{ model.name }}_dyn_disc_phi_fun_n_out;
+        capsule->disc_dyn_fun[i].casadi_sparsity_in = &{{ model.name }}_dyn_disc_phi_fun_sparsity_in;
+        capsule->disc_dyn_fun[i].casadi_sparsity_out = &{{ model.name }}_dyn_disc_phi_fun_sparsity_out;
+        capsule->disc_dyn_fun[i].casadi_work = &{{ model.name }}_dyn_disc_phi_fun_work;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->disc_dyn_fun[i], {{ dims.np }});
+    }
+
+    capsule->disc_dyn_fun_jac = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
+    for (int i = 0; i < N; i++) {
+        capsule->disc_dyn_fun_jac[i].casadi_fun = &{{ model.name }}_dyn_disc_phi_fun_jac;
+        capsule->disc_dyn_fun_jac[i].casadi_n_in = &{{ model.name }}_dyn_disc_phi_fun_jac_n_in;
+        capsule->disc_dyn_fun_jac[i].casadi_n_out = &{{ model.name }}_dyn_disc_phi_fun_jac_n_out;
+        capsule->disc_dyn_fun_jac[i].casadi_sparsity_in = &{{ model.name }}_dyn_disc_phi_fun_jac_sparsity_in;
+        capsule->disc_dyn_fun_jac[i].casadi_sparsity_out = &{{ model.name }}_dyn_disc_phi_fun_jac_sparsity_out;
+        capsule->disc_dyn_fun_jac[i].casadi_work = &{{ model.name }}_dyn_disc_phi_fun_jac_work;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->disc_dyn_fun_jac[i], {{ dims.np }});
+    }
+
+    {%- if solver_options.hessian_approx == "EXACT" %}
+    capsule->disc_dyn_fun_jac_hess = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
+    for (int i = 0; i < N; i++) {
+        capsule->disc_dyn_fun_jac_hess[i].casadi_fun = &{{ model.name }}_dyn_disc_phi_fun_jac_hess;
+        capsule->disc_dyn_fun_jac_hess[i].casadi_n_in = &{{ model.name }}_dyn_disc_phi_fun_jac_hess_n_in;
+        capsule->disc_dyn_fun_jac_hess[i].casadi_n_out = &{{ model.name }}_dyn_disc_phi_fun_jac_hess_n_out;
+        capsule->disc_dyn_fun_jac_hess[i].casadi_sparsity_in = &{{ model.name }}_dyn_disc_phi_fun_jac_hess_sparsity_in;
+        capsule->disc_dyn_fun_jac_hess[i].casadi_sparsity_out = &{{ model.name }}_dyn_disc_phi_fun_jac_hess_sparsity_out;
+        capsule->disc_dyn_fun_jac_hess[i].casadi_work = &{{ model.name }}_dyn_disc_phi_fun_jac_hess_work;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->disc_dyn_fun_jac_hess[i], {{ dims.np }});
+    }
     {%- endif %}
 
-{% if solver_options.integrator_type == "ERK" %}
+{% elif solver_options.integrator_type == "ERK" %}
     // explicit ode
-    forw_vde_casadi = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->forw_vde_casadi = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
 
     for (int i = 0; i < N; i++) {
-        forw_vde_casadi[i].casadi_fun = &{{ model.name }}_expl_vde_forw;
-        forw_vde_casadi[i].casadi_n_in = &{{ model.name }}_expl_vde_forw_n_in;
-        forw_vde_casadi[i].casadi_n_out = &{{ model.name }}_expl_vde_forw_n_out;
-        forw_vde_casadi[i].casadi_sparsity_in = &{{ model.name }}_expl_vde_forw_sparsity_in;
-        forw_vde_casadi[i].casadi_sparsity_out = &{{ model.name }}_expl_vde_forw_sparsity_out;
-        forw_vde_casadi[i].casadi_work = &{{ model.name }}_expl_vde_forw_work;
-        external_function_param_casadi_create(&forw_vde_casadi[i], {{ dims.np }});
+        capsule->forw_vde_casadi[i].casadi_fun = &{{ model.name }}_expl_vde_forw;
+        capsule->forw_vde_casadi[i].casadi_n_in = &{{ model.name }}_expl_vde_forw_n_in;
+        capsule->forw_vde_casadi[i].casadi_n_out = &{{ model.name }}_expl_vde_forw_n_out;
+        capsule->forw_vde_casadi[i].casadi_sparsity_in = &{{ model.name }}_expl_vde_forw_sparsity_in;
+        capsule->forw_vde_casadi[i].casadi_sparsity_out = &{{ model.name }}_expl_vde_forw_sparsity_out;
+        capsule->forw_vde_casadi[i].casadi_work = &{{ model.name }}_expl_vde_forw_work;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->forw_vde_casadi[i], {{ dims.np }});
     }
 
     {%- if solver_options.hessian_approx == "EXACT" %} 
-    hess_vde_casadi = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->hess_vde_casadi = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        hess_vde_casadi[i].casadi_fun = &{{ model.name }}_expl_ode_hess;
-        hess_vde_casadi[i].casadi_n_in = &{{ model.name }}_expl_ode_hess_n_in;
-        hess_vde_casadi[i].casadi_n_out = &{{ model.name }}_expl_ode_hess_n_out;
-        hess_vde_casadi[i].casadi_sparsity_in = &{{ model.name }}_expl_ode_hess_sparsity_in;
-        hess_vde_casadi[i].casadi_sparsity_out = &{{ model.name }}_expl_ode_hess_sparsity_out;
-        hess_vde_casadi[i].casadi_work = &{{ model.name }}_expl_ode_hess_work;
-        external_function_param_casadi_create(&hess_vde_casadi[i], {{ dims.np }});
+        capsule->hess_vde_casadi[i].casadi_fun = &{{ model.name }}_expl_ode_hess;
+        capsule->hess_vde_casadi[i].casadi_n_in = &{{ model.name }}_expl_ode_hess_n_in;
+        capsule->hess_vde_casadi[i].casadi_n_out = &{{ model.name }}_expl_ode_hess_n_out;
+        capsule->hess_vde_casadi[i].casadi_sparsity_in = &{{ model.name }}_expl_ode_hess_sparsity_in;
+        capsule->hess_vde_casadi[i].casadi_sparsity_out = &{{ model.name }}_expl_ode_hess_sparsity_out;
+        capsule->hess_vde_casadi[i].casadi_work = &{{ model.name }}_expl_ode_hess_work;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->hess_vde_casadi[i], {{ dims.np }});
     }
     {%- endif %}
 
 {% elif solver_options.integrator_type == "IRK" %}
     // implicit dae
-    impl_dae_fun = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->impl_dae_fun = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        impl_dae_fun[i].casadi_fun = &{{ model.name }}_impl_dae_fun;
-        impl_dae_fun[i].casadi_work = &{{ model.name }}_impl_dae_fun_work;
-        impl_dae_fun[i].casadi_sparsity_in = &{{ model.name }}_impl_dae_fun_sparsity_in;
-        impl_dae_fun[i].casadi_sparsity_out = &{{ model.name }}_impl_dae_fun_sparsity_out;
-        impl_dae_fun[i].casadi_n_in = &{{ model.name }}_impl_dae_fun_n_in;
-        impl_dae_fun[i].casadi_n_out = &{{ model.name }}_impl_dae_fun_n_out;
-        external_function_param_casadi_create(&impl_dae_fun[i], {{ dims.np }});
+        capsule->impl_dae_fun[i].casadi_fun = &{{ model.name }}_impl_dae_fun;
+        capsule->impl_dae_fun[i].casadi_work = &{{ model.name }}_impl_dae_fun_work;
+        capsule->impl_dae_fun[i].casadi_sparsity_in = &{{ model.name }}_impl_dae_fun_sparsity_in;
+        capsule->impl_dae_fun[i].casadi_sparsity_out = &{{ model.name }}_impl_dae_fun_sparsity_out;
+        capsule->impl_dae_fun[i].casadi_n_in = &{{ model.name }}_impl_dae_fun_n_in;
+        capsule->impl_dae_fun[i].casadi_n_out = &{{ model.name }}_impl_dae_fun_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->impl_dae_fun[i], {{ dims.np }});
     }
 
-    impl_dae_fun_jac_x_xdot_z = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->impl_dae_fun_jac_x_xdot_z = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        impl_dae_fun_jac_x_xdot_z[i].casadi_fun = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z;
-        impl_dae_fun_jac_x_xdot_z[i].casadi_work = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_work;
-        impl_dae_fun_jac_x_xdot_z[i].casadi_sparsity_in = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_sparsity_in;
-        impl_dae_fun_jac_x_xdot_z[i].casadi_sparsity_out = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_sparsity_out;
-        impl_dae_fun_jac_x_xdot_z[i].casadi_n_in = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_n_in;
-        impl_dae_fun_jac_x_xdot_z[i].casadi_n_out = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_n_out;
-        external_function_param_casadi_create(&impl_dae_fun_jac_x_xdot_z[i], {{ dims.np }});
+        capsule->impl_dae_fun_jac_x_xdot_z[i].casadi_fun = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z;
+        capsule->impl_dae_fun_jac_x_xdot_z[i].casadi_work = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_work;
+        capsule->impl_dae_fun_jac_x_xdot_z[i].casadi_sparsity_in = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_sparsity_in;
+        capsule->impl_dae_fun_jac_x_xdot_z[i].casadi_sparsity_out = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_sparsity_out;
+        capsule->impl_dae_fun_jac_x_xdot_z[i].casadi_n_in = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_n_in;
+        capsule->impl_dae_fun_jac_x_xdot_z[i].casadi_n_out = &{{ model.name }}_impl_dae_fun_jac_x_xdot_z_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->impl_dae_fun_jac_x_xdot_z[i], {{ dims.np }});
     }
 
-    impl_dae_jac_x_xdot_u_z = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->impl_dae_jac_x_xdot_u_z = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        impl_dae_jac_x_xdot_u_z[i].casadi_fun = &{{ model.name }}_impl_dae_jac_x_xdot_u_z;
-        impl_dae_jac_x_xdot_u_z[i].casadi_work = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_work;
-        impl_dae_jac_x_xdot_u_z[i].casadi_sparsity_in = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_sparsity_in;
-        impl_dae_jac_x_xdot_u_z[i].casadi_sparsity_out = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_sparsity_out;
-        impl_dae_jac_x_xdot_u_z[i].casadi_n_in = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_n_in;
-        impl_dae_jac_x_xdot_u_z[i].casadi_n_out = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_n_out;
-        external_function_param_casadi_create(&impl_dae_jac_x_xdot_u_z[i], {{ dims.np }});
+        capsule->impl_dae_jac_x_xdot_u_z[i].casadi_fun = &{{ model.name }}_impl_dae_jac_x_xdot_u_z;
+        capsule->impl_dae_jac_x_xdot_u_z[i].casadi_work = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_work;
+        capsule->impl_dae_jac_x_xdot_u_z[i].casadi_sparsity_in = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_sparsity_in;
+        capsule->impl_dae_jac_x_xdot_u_z[i].casadi_sparsity_out = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_sparsity_out;
+        capsule->impl_dae_jac_x_xdot_u_z[i].casadi_n_in = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_n_in;
+        capsule->impl_dae_jac_x_xdot_u_z[i].casadi_n_out = &{{ model.name }}_impl_dae_jac_x_xdot_u_z_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->impl_dae_jac_x_xdot_u_z[i], {{ dims.np }});
     }
 
 {% elif solver_options.integrator_type == "GNSF" %}
-    gnsf_phi_fun = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->gnsf_phi_fun = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        gnsf_phi_fun[i].casadi_fun = &{{ model.name }}_gnsf_phi_fun;
-        gnsf_phi_fun[i].casadi_work = &{{ model.name }}_gnsf_phi_fun_work;
-        gnsf_phi_fun[i].casadi_sparsity_in = &{{ model.name }}_gnsf_phi_fun_sparsity_in;
-        gnsf_phi_fun[i].casadi_sparsity_out = &{{ model.name }}_gnsf_phi_fun_sparsity_out;
-        gnsf_phi_fun[i].casadi_n_in = &{{ model.name }}_gnsf_phi_fun_n_in;
-        gnsf_phi_fun[i].casadi_n_out = &{{ model.name }}_gnsf_phi_fun_n_out;
-        external_function_param_casadi_create(&gnsf_phi_fun[i], {{ dims.np }});
+        capsule->gnsf_phi_fun[i].casadi_fun = &{{ model.name }}_gnsf_phi_fun;
+        capsule->gnsf_phi_fun[i].casadi_work = &{{ model.name }}_gnsf_phi_fun_work;
+        capsule->gnsf_phi_fun[i].casadi_sparsity_in = &{{ model.name }}_gnsf_phi_fun_sparsity_in;
+        capsule->gnsf_phi_fun[i].casadi_sparsity_out = &{{ model.name }}_gnsf_phi_fun_sparsity_out;
+        capsule->gnsf_phi_fun[i].casadi_n_in = &{{ model.name }}_gnsf_phi_fun_n_in;
+        capsule->gnsf_phi_fun[i].casadi_n_out = &{{ model.name }}_gnsf_phi_fun_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->gnsf_phi_fun[i], {{ dims.np }});
     }
 
-    gnsf_phi_fun_jac_y = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->gnsf_phi_fun_jac_y = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        gnsf_phi_fun_jac_y[i].casadi_fun = &{{ model.name }}_gnsf_phi_fun_jac_y;
-        gnsf_phi_fun_jac_y[i].casadi_work = &{{ model.name }}_gnsf_phi_fun_jac_y_work;
-        gnsf_phi_fun_jac_y[i].casadi_sparsity_in = &{{ model.name }}_gnsf_phi_fun_jac_y_sparsity_in;
-        gnsf_phi_fun_jac_y[i].casadi_sparsity_out = &{{ model.name }}_gnsf_phi_fun_jac_y_sparsity_out;
-        gnsf_phi_fun_jac_y[i].casadi_n_in = &{{ model.name }}_gnsf_phi_fun_jac_y_n_in;
-        gnsf_phi_fun_jac_y[i].casadi_n_out = &{{ model.name }}_gnsf_phi_fun_jac_y_n_out;
-        external_function_param_casadi_create(&gnsf_phi_fun_jac_y[i], {{ dims.np }});
+        capsule->gnsf_phi_fun_jac_y[i].casadi_fun = &{{ model.name }}_gnsf_phi_fun_jac_y;
+        capsule->gnsf_phi_fun_jac_y[i].casadi_work = &{{ model.name }}_gnsf_phi_fun_jac_y_work;
+        capsule->gnsf_phi_fun_jac_y[i].casadi_sparsity_in = &{{ model.name }}_gnsf_phi_fun_jac_y_sparsity_in;
+        capsule->gnsf_phi_fun_jac_y[i].casadi_sparsity_out = &{{ model.name }}_gnsf_phi_fun_jac_y_sparsity_out;
+        capsule->gnsf_phi_fun_jac_y[i].casadi_n_in = &{{ model.name }}_gnsf_phi_fun_jac_y_n_in;
+        capsule->gnsf_phi_fun_jac_y[i].casadi_n_out = &{{ model.name }}_gnsf_phi_fun_jac_y_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->gnsf_phi_fun_jac_y[i], {{ dims.np }});
     }
 
-    gnsf_phi_jac_y_uhat = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->gnsf_phi_jac_y_uhat = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        gnsf_phi_jac_y_uhat[i].casadi_fun = &{{ model.name }}_gnsf_phi_jac_y_uhat;
-        gnsf_phi_jac_y_uhat[i].casadi_work = &{{ model.name }}_gnsf_phi_jac_y_uhat_work;
-        gnsf_phi_jac_y_uhat[i].casadi_sparsity_in = &{{ model.name }}_gnsf_phi_jac_y_uhat_sparsity_in;
-        gnsf_phi_jac_y_uhat[i].casadi_sparsity_out = &{{ model.name }}_gnsf_phi_jac_y_uhat_sparsity_out;
-        gnsf_phi_jac_y_uhat[i].casadi_n_in = &{{ model.name }}_gnsf_phi_jac_y_uhat_n_in;
-        gnsf_phi_jac_y_uhat[i].casadi_n_out = &{{ model.name }}_gnsf_phi_jac_y_uhat_n_out;
-        external_function_param_casadi_create(&gnsf_phi_jac_y_uhat[i], {{ dims.np }});
+        capsule->gnsf_phi_jac_y_uhat[i].casadi_fun = &{{ model.name }}_gnsf_phi_jac_y_uhat;
+        capsule->gnsf_phi_jac_y_uhat[i].casadi_work = &{{ model.name }}_gnsf_phi_jac_y_uhat_work;
+        capsule->gnsf_phi_jac_y_uhat[i].casadi_sparsity_in = &{{ model.name }}_gnsf_phi_jac_y_uhat_sparsity_in;
+        capsule->gnsf_phi_jac_y_uhat[i].casadi_sparsity_out = &{{ model.name }}_gnsf_phi_jac_y_uhat_sparsity_out;
+        capsule->gnsf_phi_jac_y_uhat[i].casadi_n_in = &{{ model.name }}_gnsf_phi_jac_y_uhat_n_in;
+        capsule->gnsf_phi_jac_y_uhat[i].casadi_n_out = &{{ model.name }}_gnsf_phi_jac_y_uhat_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->gnsf_phi_jac_y_uhat[i], {{ dims.np }});
     }
 
-    gnsf_f_lo_jac_x1_x1dot_u_z = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->gnsf_f_lo_jac_x1_x1dot_u_z = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_fun = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz;
-        gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_work = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_work;
-        gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_sparsity_in = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_sparsity_in;
-        gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_sparsity_out = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_sparsity_out;
-        gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_n_in = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_n_in;
-        gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_n_out = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_n_out;
-        external_function_param_casadi_create(&gnsf_f_lo_jac_x1_x1dot_u_z[i], {{ dims.np }});
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_fun = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz;
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_work = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_work;
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_sparsity_in = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_sparsity_in;
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_sparsity_out = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_sparsity_out;
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_n_in = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_n_in;
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i].casadi_n_out = &{{ model.name }}_gnsf_f_lo_fun_jac_x1k1uz_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i], {{ dims.np }});
     }
 
-    gnsf_get_matrices_fun = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->gnsf_get_matrices_fun = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++) {
-        gnsf_get_matrices_fun[i].casadi_fun = &{{ model.name }}_gnsf_get_matrices_fun;
-        gnsf_get_matrices_fun[i].casadi_work = &{{ model.name }}_gnsf_get_matrices_fun_work;
-        gnsf_get_matrices_fun[i].casadi_sparsity_in = &{{ model.name }}_gnsf_get_matrices_fun_sparsity_in;
-        gnsf_get_matrices_fun[i].casadi_sparsity_out = &{{ model.name }}_gnsf_get_matrices_fun_sparsity_out;
-        gnsf_get_matrices_fun[i].casadi_n_in = &{{ model.name }}_gnsf_get_matrices_fun_n_in;
-        gnsf_get_matrices_fun[i].casadi_n_out = &{{ model.name }}_gnsf_get_matrices_fun_n_out;
-        external_function_param_casadi_create(&gnsf_get_matrices_fun[i], {{ dims.np }});
+        capsule->gnsf_get_matrices_fun[i].casadi_fun = &{{ model.name }}_gnsf_get_matrices_fun;
+        capsule->gnsf_get_matrices_fun[i].casadi_work = &{{ model.name }}_gnsf_get_matrices_fun_work;
+        capsule->gnsf_get_matrices_fun[i].casadi_sparsity_in = &{{ model.name }}_gnsf_get_matrices_fun_sparsity_in;
+        capsule->gnsf_get_matrices_fun[i].casadi_sparsity_out = &{{ model.name }}_gnsf_get_matrices_fun_sparsity_out;
+        capsule->gnsf_get_matrices_fun[i].casadi_n_in = &{{ model.name }}_gnsf_get_matrices_fun_n_in;
+        capsule->gnsf_get_matrices_fun[i].casadi_n_out = &{{ model.name }}_gnsf_get_matrices_fun_n_out;
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->gnsf_get_matrices_fun[i], {{ dims.np }});
     }
 {%- endif %}
 
-{%- if cost.cost_type == "NONLINEAR_LS" %}
+{%- if cost.cost_type == "NONLINEAR_LS" and solver_options.nls_cost_evaluation == "BATCH" %}
+    // nonlinear least squares cost, residual function evaluated by its map over the stages
+    capsule->r_cost_batch.casadi_fun = &{{ model.name }}_r_cost_map;
+    capsule->r_cost_batch.casadi_work = &{{ model.name }}_r_cost_map_work;
+    capsule->r_cost_batch.casadi_fun_single = &{{ model.name }}_r_cost;
+    capsule->r_cost_batch.casadi_work_single = &{{ model.name }}_r_cost_work;
+    capsule->r_cost_batch.casadi_n_in = &{{ model.name }}_r_cost_n_in;
+    capsule->r_cost_batch.casadi_n_out = &{{ model.name }}_r_cost_n_out;
+    capsule->r_cost_batch.casadi_sparsity_in = &{{ model.name }}_r_cost_sparsity_in;
+    capsule->r_cost_batch.casadi_sparsity_out = &{{ model.name }}_r_cost_sparsity_out;
+    int r_cost_batch_size = external_function_casadi_batch_calculate_size(&capsule->r_cost_batch, N, {{ dims.np }});
+    external_function_casadi_batch_assign(&capsule->r_cost_batch, {{ model.name }}_acados_alloc(capsule, r_cost_batch_size));
+
+    capsule->r_cost = (external_function_casadi_batch_node *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_casadi_batch_node)*N);
+    for (int i = 0; i < N; i++)
+    {
+        external_function_casadi_batch_node_set(&capsule->r_cost[i], &capsule->r_cost_batch, i);
+    }
+{%- elif cost.cost_type == "NONLINEAR_LS" %}
     // nonlinear least squares cost
-    r_cost = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->r_cost = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++)
     {
         // residual function
-        r_cost[i].casadi_fun = &{{ model.name }}_r_cost;
-        r_cost[i].casadi_n_in = &{{ model.name }}_r_cost_n_in;
-        r_cost[i].casadi_n_out = &{{ model.name }}_r_cost_n_out;
-        r_cost[i].casadi_sparsity_in = &{{ model.name }}_r_cost_sparsity_in;
-        r_cost[i].casadi_sparsity_out = &{{ model.name }}_r_cost_sparsity_out;
-        r_cost[i].casadi_work = &{{ model.name }}_r_cost_work;
-
-        external_function_param_casadi_create(&r_cost[i], {{ dims.np }});
+        capsule->r_cost[i].casadi_fun = &{{ model.name }}_r_cost;
+        capsule->r_cost[i].casadi_n_in = &{{ model.name }}_r_cost_n_in;
+        capsule->r_cost[i].casadi_n_out = &{{ model.name }}_r_cost_n_out;
+        capsule->r_cost[i].casadi_sparsity_in = &{{ model.name }}_r_cost_sparsity_in;
+        capsule->r_cost[i].casadi_sparsity_out = &{{ model.name }}_r_cost_sparsity_out;
+        capsule->r_cost[i].casadi_work = &{{ model.name }}_r_cost_work;
+
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->r_cost[i], {{ dims.np }});
     }
 {%- elif cost.cost_type == "EXTERNAL" %}
     // external cost
-    ext_cost_fun = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->ext_cost_fun = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++)
     {
         // residual function
-        ext_cost_fun[i].casadi_fun = &{{ model.name }}_ext_cost_fun;
-        ext_cost_fun[i].casadi_n_in = &{{ model.name }}_ext_cost_fun_n_in;
-        ext_cost_fun[i].casadi_n_out = &{{ model.name }}_ext_cost_fun_n_out;
-        ext_cost_fun[i].casadi_sparsity_in = &{{ model.name }}_ext_cost_fun_sparsity_in;
-        ext_cost_fun[i].casadi_sparsity_out = &{{ model.name }}_ext_cost_fun_sparsity_out;
-        ext_cost_fun[i].casadi_work = &{{ model.name }}_ext_cost_fun_work;
-
-        external_function_param_casadi_create(&ext_cost_fun[i], {{ dims.np }});
+        capsule->ext_cost_fun[i].casadi_fun = &{{ model.name }}_ext_cost_fun;
+        capsule->ext_cost_fun[i].casadi_n_in = &{{ model.name }}_ext_cost_fun_n_in;
+        capsule->ext_cost_fun[i].casadi_n_out = &{{ model.name }}_ext_cost_fun_n_out;
+        capsule->ext_cost_fun[i].casadi_sparsity_in = &{{ model.name }}_ext_cost_fun_sparsity_in;
+        capsule->ext_cost_fun[i].casadi_sparsity_out = &{{ model.name }}_ext_cost_fun_sparsity_out;
+        capsule->ext_cost_fun[i].casadi_work = &{{ model.name }}_ext_cost_fun_work;
+
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->ext_cost_fun[i], {{ dims.np }});
     }
-    ext_cost_fun_jac_hess = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    capsule->ext_cost_fun_jac_hess = (external_function_param_casadi *) {{ model.name }}_acados_alloc(capsule, sizeof(external_function_param_casadi)*N);
     for (int i = 0; i < N; i++)
     {
         // residual function
-        ext_cost_fun_jac_hess[i].casadi_fun = &{{ model.name }}_ext_cost_fun_jac_hess;
-        ext_cost_fun_jac_hess[i].casadi_n_in = &{{ model.name }}_ext_cost_fun_jac_hess_n_in;
-        ext_cost_fun_jac_hess[i].casadi_n_out = &{{ model.name }}_ext_cost_fun_jac_hess_n_out;
-        ext_cost_fun_jac_hess[i].casadi_sparsity_in = &{{ model.name }}_ext_cost_fun_jac_hess_sparsity_in;
-        ext_cost_fun_jac_hess[i].casadi_sparsity_out = &{{ model.name }}_ext_cost_fun_jac_hess_sparsity_out;
-        ext_cost_fun_jac_hess[i].casadi_work = &{{ model.name }}_ext_cost_fun_jac_hess_work;
-
-        external_function_param_casadi_create(&ext_cost_fun_jac_hess[i], {{ dims.np }});
+        capsule->ext_cost_fun_jac_hess[i].casadi_fun = &{{ model.name }}_ext_cost_fun_jac_hess;
+        capsule->ext_cost_fun_jac_hess[i].casadi_n_in = &{{ model.name }}_ext_cost_fun_jac_hess_n_in;
+        capsule->ext_cost_fun_jac_hess[i].casadi_n_out = &{{ model.name }}_ext_cost_fun_jac_hess_n_out;
+        capsule->ext_cost_fun_jac_hess[i].casadi_sparsity_in = &{{ model.name }}_ext_cost_fun_jac_hess_sparsity_in;
+        capsule->ext_cost_fun_jac_hess[i].casadi_sparsity_out = &{{ model.name }}_ext_cost_fun_jac_hess_sparsity_out;
+        capsule->ext_cost_fun_jac_hess[i].casadi_work = &{{ model.name }}_ext_cost_fun_jac_hess_work;
+
+        {{ model.name }}_acados_external_function_create(capsule, &capsule->ext_cost_fun_jac_hess[i], {{ dims.np }});
     }
 {%- endif %}
 
 {%- if cost.cost_type_e == "NONLINEAR_LS" %}
     // residual function
-    r_e_cost.casadi_fun = &{{ model.name }}_r_e_cost;
-    r_e_cost.casadi_n_in = &{{ model.name }}_r_e_cost_n_in;
-    r_e_cost.casadi_n_out = &{{ model.name }}_r_e_cost_n_out;
-    r_e_cost.casadi_sparsity_in = &{{ model.name }}_r_e_cost_sparsity_in;
-    r_e_cost.casadi_sparsity_out = &{{ model.name }}_r_e_cost_sparsity_out;
-    r_e_cost.casadi_work = &{{ model.name }}_r_e_cost_work;
-
-    external_function_param_casadi_create(&r_e_cost, {{ dims.np }});
+    capsule->r_e_cost.casadi_fun = &{{ model.name }}_r_e_cost;
+    capsule->r_e_cost.casadi_n_in = &{{ model.name }}_r_e_cost_n_in;
+    capsule->r_e_cost.casadi_n_out = &{{ model.name }}_r_e_cost_n_out;
+    capsule->r_e_cost.casadi_sparsity_in = &{{ model.name }}_r_e_cost_sparsity_in;
+    capsule->r_e_cost.casadi_sparsity_out = &{{ model.name }}_r_e_cost_sparsity_out;
+    capsule->r_e_cost.casadi_work = &{{ model.name }}_r_e_cost_work;
+
+    {{ model.name }}_acados_external_function_create(capsule, &capsule->r_e_cost, {{ dims.np }});
 {%- elif cost.cost_type_e == "EXTERNAL" %}
     // external cost
-    ext_cost_e_fun.casadi_fun = &{{ model.name }}_ext_cost_e_fun;
-    ext_cost_e_fun.casadi_n_in = &{{ model.name }}_ext_cost_e_fun_n_in;
-    ext_cost_e_fun.casadi_n_out = &{{ model.name }}_ext_cost_e_fun_n_out;
-    ext_cost_e_fun.casadi_sparsity_in = &{{ model.name }}_ext_cost_e_fun_sparsity_in;
-    ext_cost_e_fun.casadi_sparsity_out = &{{ model.name }}_ext_cost_e_fun_sparsity_out;
-    ext_cost_e_fun.casadi_work = &{{ model.name }}_ext_cost_e_fun_work;
+    capsule->ext_cost_e_fun.casadi_fun = &{{ model.name }}_ext_cost_e_fun;
+    capsule->ext_cost_e_fun.casadi_n_in = &{{ model.name }}_ext_cost_e_fun_n_in;
+    capsule->ext_cost_e_fun.casadi_n_out = &{{ model.name }}_ext_cost_e_fun_n_out;
+    capsule->ext_cost_e_fun.casadi_sparsity_in = &{{ model.name }}_ext_cost_e_fun_sparsity_in;
+    capsule->ext_cost_e_fun.casadi_sparsity_out = &{{ model.name }}_ext_cost_e_fun_sparsity_out;
+    capsule->ext_cost_e_fun.casadi_work = &{{ model.name }}_ext_cost_e_fun_work;
 
-    external_function_param_casadi_create(&ext_cost_e_fun, {{ dims.np }});
+    {{ model.name }}_acados_external_function_create(capsule, &capsule->ext_cost_e_fun, {{ dims.np }});
 
     // external cost
-    ext_cost_e_fun_jac_hess.casadi_fun = &{{ model.name }}_ext_cost_e_fun_jac_hess;
-    ext_cost_e_fun_jac_hess.casadi_n_in = &{{ model.name }}_ext_cost_e_fun_jac_hess_n_in;
-    ext_cost_e_fun_jac_hess.casadi_n_out = &{{ model.name }}_ext_cost_e_fun_jac_hess_n_out;
-    ext_cost_e_fun_jac_hess.casadi_sparsity_in = &{{ model.name }}_ext_cost_e_fun_jac_hess_sparsity_in;
-    ext_cost_e_fun_jac_hess.casadi_sparsity_out = &{{ model.name }}_ext_cost_e_fun_jac_hess_sparsity_out;
-    ext_cost_e_fun_jac_hess.casadi_work = &{{ model.name }}_ext_cost_e_fun_jac_hess_work;
-
-    external_function_param_casadi_create(&ext_cost_e_fun_jac_hess, {{ dims.np }});
+    capsule->ext_cost_e_fun_jac_hess.casadi_fun = &{{ model.name }}_ext_cost_e_fun_jac_hess;
+    capsule->ext_cost_e_fun_jac_hess.casadi_n_in = &{{ model.name }}_ext_cost_e_fun_jac_hess_n_in;
+    capsule->ext_cost_e_fun_jac_hess.casadi_n_out = &{{ model.name }}_ext_cost_e_fun_jac_hess_n_out;
+    capsule->ext_cost_e_fun_jac_hess.casadi_sparsity_in = &{{ model.name }}_ext_cost_e_fun_jac_hess_sparsity_in;
+    capsule->ext_cost_e_fun_jac_hess.casadi_sparsity_out = &{{ model.name }}_ext_cost_e_fun_jac_hess_sparsity_out;
+    capsule->ext_cost_e_fun_jac_hess.casadi_work = &{{ model.name }}_ext_cost_e_fun_jac_hess_work;
+
+    {{ model.name }}_acados_external_function_create(capsule, &capsule->ext_cost_e_fun_jac_hess, {{ dims.np }});
 {%- endif %}
 
     /************************************************
-    *  nlp_in
+    *  capsule->nlp_in
     ************************************************/
-    nlp_in = ocp_nlp_in_create(nlp_config, nlp_dims);
+    capsule->nlp_in = ocp_nlp_in_assign(capsule->nlp_config, capsule->nlp_dims,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_in_calculate_size(capsule->nlp_config, capsule->nlp_dims)));
 
     double Ts = Tf/N;
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_in_set(nlp_config, nlp_dims, nlp_in, i, "Ts", &Ts);
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "scaling", &Ts);
+        ocp_nlp_in_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "Ts", &Ts);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "scaling", &Ts);
     }
 
     /**** Dynamics ****/
     for (int i = 0; i < N; i++)
     {
-    {%- if solver_options.integrator_type == "ERK" %}
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "expl_vde_for", &forw_vde_casadi[i]);
+    {%- if solver_options.integrator_type == "ERK" and solver_options.code_target == "SPECIALIZED" %}
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "disc_dyn_fun", &capsule->disc_dyn_fun[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "disc_dyn_fun_jac", &capsule->disc_dyn_fun_jac[i]);
+        {%- if solver_options.hessian_approx == "EXACT" %}
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "disc_dyn_fun_jac_hess", &capsule->disc_dyn_fun_jac_hess[i]);
+        {%- endif %}
+    {%- elif solver_options.integrator_type == "ERK" %}
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "expl_vde_for", &capsule->forw_vde_casadi[i]);
         {%- if solver_options.hessian_approx == "EXACT" %} 
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "expl_ode_hes", &hess_vde_casadi[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "expl_ode_hes", &capsule->hess_vde_casadi[i]);
         {%- endif %}
     {% elif solver_options.integrator_type == "IRK" %}
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "impl_ode_fun", &impl_dae_fun[i]);
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i,
-                                   "impl_ode_fun_jac_x_xdot", &impl_dae_fun_jac_x_xdot_z[i]);
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i,
-                                   "impl_ode_jac_x_xdot_u", &impl_dae_jac_x_xdot_u_z[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "impl_ode_fun", &capsule->impl_dae_fun[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i,
+                                   "impl_ode_fun_jac_x_xdot", &capsule->impl_dae_fun_jac_x_xdot_z[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i,
+                                   "impl_ode_jac_x_xdot_u", &capsule->impl_dae_jac_x_xdot_u_z[i]);
     {% elif solver_options.integrator_type == "GNSF" %}
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "phi_fun", &gnsf_phi_fun[i]);
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "phi_fun_jac_y", &gnsf_phi_fun_jac_y[i]);
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "phi_jac_y_uhat", &gnsf_phi_jac_y_uhat[i]);
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "f_lo_jac_x1_x1dot_u_z",
-                                   &gnsf_f_lo_jac_x1_x1dot_u_z[i]);
-        ocp_nlp_dynamics_model_set(nlp_config, nlp_dims, nlp_in, i, "gnsf_get_matrices_fun",
-                                   &gnsf_get_matrices_fun[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "phi_fun", &capsule->gnsf_phi_fun[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "phi_fun_jac_y", &capsule->gnsf_phi_fun_jac_y[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "phi_jac_y_uhat", &capsule->gnsf_phi_jac_y_uhat[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "f_lo_jac_x1_x1dot_u_z",
+                                   &capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i]);
+        ocp_nlp_dynamics_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "gnsf_get_matrices_fun",
+                                   &capsule->gnsf_get_matrices_fun[i]);
     {%- endif %}
     }
 
@@ -662,8 +769,8 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "W", W);
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "yref", yref);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "W", W);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "yref", yref);
     }
 {% endif %}
 {% endif %}
@@ -677,7 +784,7 @@ int acados_create()
     {%- endfor %}
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "Vx", Vx);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "Vx", Vx);
     }
 
 {% if dims.ny > 0 and dims.nu > 0 %}
@@ -690,7 +797,7 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "Vu", Vu);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "Vu", Vu);
     }
 {% endif %}
 
@@ -704,7 +811,7 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "Vz", Vz);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "Vz", Vz);
     }
 {%- endif %}
 {%- endif %}{# LINEAR LS #}
@@ -712,13 +819,17 @@ int acados_create()
 {%- if cost.cost_type == "NONLINEAR_LS" %}
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "nls_res_jac", &r_cost[i]);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "nls_res_jac", &capsule->r_cost[i]);
     }
+{%- if solver_options.nls_cost_evaluation == "BATCH" %}
+    // evaluate the map before the stage-wise loops of the nlp solver
+    ocp_nlp_in_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "ext_fun_batch", &capsule->r_cost_batch);
+{%- endif %}
 {%- elif cost.cost_type == "EXTERNAL" %}
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "ext_cost_fun", &ext_cost_fun[i]);
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "ext_cost_fun_jac_hess", &ext_cost_fun_jac_hess[i]);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "ext_cost_fun", &capsule->ext_cost_fun[i]);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "ext_cost_fun_jac_hess", &capsule->ext_cost_fun_jac_hess[i]);
     }
 {%- endif %}
 
@@ -746,10 +857,10 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "Zl", Zl);
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "Zu", Zu);
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "zl", zl);
-        ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, i, "zu", zu);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "Zl", Zl);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "Zu", Zu);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "zl", zl);
+        ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "zu", zu);
     }
 {% endif %}
 
@@ -760,7 +871,7 @@ int acados_create()
     {% for j in range(end=dims.ny_e) %}
     yref_e[{{ j }}] = {{ cost.yref_e[j] }}; 
     {%- endfor %}
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "yref", yref_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "yref", yref_e);
 
     double W_e[NYN*NYN];
     {% for j in range(end=dims.ny_e) %}
@@ -768,7 +879,7 @@ int acados_create()
     W_e[{{ j }}+(NYN) * {{ k }}] = {{ cost.W_e[j][k] }}; 
         {%- endfor %}
     {%- endfor %}
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "W", W_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "W", W_e);
 
     {%- if cost.cost_type_e == "LINEAR_LS" %}
     double Vx_e[NYN*NX];
@@ -777,17 +888,17 @@ int acados_create()
     Vx_e[{{ j }}+(NYN) * {{ k }}] = {{ cost.Vx_e[j][k] }}; 
         {%- endfor %}
     {%- endfor %}
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "Vx", Vx_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "Vx", Vx_e);
     {%- endif %}
 
     {%- if cost.cost_type_e == "NONLINEAR_LS" %}
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "nls_res_jac", &r_e_cost);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "nls_res_jac", &capsule->r_e_cost);
     {%- endif %}
 {%- endif %}{# ny_e > 0 #}
 
 {%- elif cost.cost_type_e == "EXTERNAL" %}
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "ext_cost_fun", &ext_cost_e_fun);
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "ext_cost_fun_jac_hess", &ext_cost_e_fun_jac_hess);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "ext_cost_fun", &capsule->ext_cost_e_fun);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "ext_cost_fun_jac_hess", &capsule->ext_cost_e_fun_jac_hess);
 {%- endif %}
 
 {% if dims.ns_e > 0 %}
@@ -812,10 +923,10 @@ int acados_create()
     zu_e[{{ j }}] = {{ cost.zu_e[j] }}; 
     {%- endfor %}
 
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "Zl", Zl_e);
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "Zu", Zu_e);
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "zl", zl_e);
-    ocp_nlp_cost_model_set(nlp_config, nlp_dims, nlp_in, N, "zu", zu_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "Zl", Zl_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "Zu", Zu_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "zl", zl_e);
+    ocp_nlp_cost_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "zu", zu_e);
 {%- endif %}
 
     /**** Constraints ****/
@@ -835,18 +946,18 @@ int acados_create()
     ubx0[{{ i }}] = {{ constraints.ubx_0[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "idxbx", idxbx0);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "lbx", lbx0);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "ubx", ubx0);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "lbx", lbx0);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "ubx", ubx0);
 {% endif %}
 
 
     /* constraints that are the same for initial and intermediate */
 {%- if dims.nsbx > 0 %}
 {# TODO: introduce nsbx0 & REMOVE SETTING lsbx, usbx for stage 0!!! move this block down!! #}
-    // ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "idxsbx", idxsbx);
-    // ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "lsbx", lsbx);
-    // ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "usbx", usbx);
+    // ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "idxsbx", idxsbx);
+    // ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "lsbx", lsbx);
+    // ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, 0, "usbx", usbx);
 
     // soft bounds on x
     int idxsbx[NSBX];
@@ -862,9 +973,9 @@ int acados_create()
 
     for (int i = 1; i < N; i++)
     {       
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "idxsbx", idxsbx);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lsbx", lsbx);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "usbx", usbx);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "idxsbx", idxsbx);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lsbx", lsbx);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "usbx", usbx);
     }
 {%- endif %}
 
@@ -884,9 +995,9 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "idxbu", idxbu);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lbu", lbu);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "ubu", ubu);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "idxbu", idxbu);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lbu", lbu);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "ubu", ubu);
     }
 {% endif %}
 
@@ -904,9 +1015,9 @@ int acados_create()
     {%- endfor %}
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "idxsbu", idxsbu);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lsbu", lsbu);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "usbu", usbu);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "idxsbu", idxsbu);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lsbu", lsbu);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "usbu", usbu);
     }
 {% endif %}
 
@@ -925,9 +1036,9 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "idxsh", idxsh);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lsh", lsh);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "ush", ush);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "idxsh", idxsh);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lsh", lsh);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "ush", ush);
     }
 {% endif %}
 
@@ -946,9 +1057,9 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "idxsphi", idxsphi);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lsphi", lsphi);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "usphi", usphi);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "idxsphi", idxsphi);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lsphi", lsphi);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "usphi", usphi);
     }
 {% endif %}
 
@@ -967,9 +1078,9 @@ int acados_create()
 
     for (int i = 1; i < N; i++)
     {
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "idxbx", idxbx);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lbx", lbx);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "ubx", ubx);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "idxbx", idxbx);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lbx", lbx);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "ubx", ubx);
     }
 {% endif %}
 
@@ -1002,10 +1113,10 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "D", D);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "C", C);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lg", lg);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "ug", ug);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "D", D);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "C", C);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lg", lg);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "ug", ug);
     }
 {% endif %}
 
@@ -1025,9 +1136,9 @@ int acados_create()
     for (int i = 0; i < N; i++)
     {
         // nonlinear constraints for stages 0 to N-1
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "nl_constr_h_fun_jac", &h_constraint[i]);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lh", lh);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "uh", uh);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "nl_constr_h_fun_jac", &capsule->h_constraint[i]);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lh", lh);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "uh", uh);
     }
 {% endif %}
 
@@ -1046,11 +1157,11 @@ int acados_create()
 
     for (int i = 0; i < N; i++)
     {
-        // ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "nl_constr_r_fun_jac", &r_constraint[i]);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i,
-                      "nl_constr_phi_o_r_fun_phi_jac_ux_z_phi_hess_r_jac_ux", &phi_constraint[i]);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "lphi", lphi);
-        ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, i, "uphi", uphi);
+        // ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "nl_constr_r_fun_jac", &r_constraint[i]);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i,
+                      "nl_constr_phi_o_r_fun_phi_jac_ux_z_phi_hess_r_jac_ux", &capsule->phi_constraint[i]);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "lphi", lphi);
+        ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, i, "uphi", uphi);
     }
 {% endif %}
 
@@ -1068,9 +1179,9 @@ int acados_create()
     lbx_e[{{ i }}] = {{ constraints.lbx_e[i] }};
     ubx_e[{{ i }}] = {{ constraints.ubx_e[i] }};
     {%- endfor %}
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "idxbx", idxbx_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lbx", lbx_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "ubx", ubx_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "idxbx", idxbx_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lbx", lbx_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "ubx", ubx_e);
 {%- endif %}
 
 {% if dims.nsh_e > 0 %}
@@ -1086,9 +1197,9 @@ int acados_create()
     ush_e[{{ i }}] = {{ constraints.ush_e[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "idxsh", idxsh_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lsh", lsh_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "ush", ush_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "idxsh", idxsh_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lsh", lsh_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "ush", ush_e);
 {%- endif %}
 
 {% if dims.nsphi_e > 0 %}
@@ -1104,9 +1215,9 @@ int acados_create()
     usphi_e[{{ i }}] = {{ constraints.usphi_e[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "idxsphi", idxsphi_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lsphi", lsphi_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "usphi", usphi_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "idxsphi", idxsphi_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lsphi", lsphi_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "usphi", usphi_e);
 {%- endif %}
 
 {% if dims.nsbx_e > 0 %}
@@ -1122,9 +1233,9 @@ int acados_create()
     usbx_e[{{ i }}] = {{ constraints.usbx_e[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "idxsbx", idxsbx_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lsbx", lsbx_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "usbx", usbx_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "idxsbx", idxsbx_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lsbx", lsbx_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "usbx", usbx_e);
 {% endif %}
 
 {% if dims.ng_e > 0 %}
@@ -1144,9 +1255,9 @@ int acados_create()
     ug_e[{{ i }}] = {{ constraints.ug_e[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "C", C_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lg", lg_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "ug", ug_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "C", C_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lg", lg_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "ug", ug_e);
 {%- endif %}
 
 {% if dims.nh_e > 0 %}
@@ -1162,9 +1273,9 @@ int acados_create()
     uh_e[{{ i }}] = {{ constraints.uh_e[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "nl_constr_h_fun_jac", &h_e_constraint);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lh", lh_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "uh", uh_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "nl_constr_h_fun_jac", &capsule->h_e_constraint);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lh", lh_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "uh", uh_e);
 {%- endif %}
 
 {% if dims.nphi_e > 0 and constraints.constr_type_e == "BGP" %}
@@ -1180,11 +1291,11 @@ int acados_create()
     uphi_e[{{ i }}] = {{ constraints.uphi_e[i] }};
     {%- endfor %}
 
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "lphi", lphi_e);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "uphi", uphi_e);
-    // ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "nl_constr_r_fun_jac", &r_e_constraint);
-    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N,
-                       "nl_constr_phi_o_r_fun_phi_jac_ux_z_phi_hess_r_jac_ux", &phi_e_constraint);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "lphi", lphi_e);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "uphi", uphi_e);
+    // ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N, "nl_constr_r_fun_jac", &r_e_constraint);
+    ocp_nlp_constraints_model_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, N,
+                       "nl_constr_phi_o_r_fun_phi_jac_ux_z_phi_hess_r_jac_ux", &capsule->phi_e_constraint);
 {% endif %}
 
 
@@ -1192,32 +1303,35 @@ int acados_create()
     *  opts
     ************************************************/
 
-    nlp_opts = ocp_nlp_solver_opts_create(nlp_config, nlp_dims);
+    capsule->nlp_opts = ocp_nlp_solver_opts_assign(capsule->nlp_config, capsule->nlp_dims,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_solver_opts_calculate_size(capsule->nlp_config, capsule->nlp_dims)));
 
 {%- if dims.nz > 0 %}
     bool output_z_val = true; 
     bool sens_algebraic_val = true; 
 
     for (int i = 0; i < N; i++)
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_output_z", &output_z_val);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_output_z", &output_z_val);
     for (int i = 0; i < N; i++)
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_sens_algebraic", &sens_algebraic_val);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_sens_algebraic", &sens_algebraic_val);
 {%- endif -%}
 
+{%- if solver_options.code_target != "SPECIALIZED" %}
     int num_steps_val = {{ solver_options.sim_method_num_steps }};
     for (int i = 0; i < N; i++)
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_num_steps", &num_steps_val);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_num_steps", &num_steps_val);
 
     int ns_val = {{ solver_options.sim_method_num_stages }};
     for (int i = 0; i < N; i++)
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_num_stages", &ns_val);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_num_stages", &ns_val);
 
     int newton_iter_val = {{ solver_options.sim_method_newton_iter }};
     for (int i = 0; i < N; i++)
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_newton_iter", &newton_iter_val);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_newton_iter", &newton_iter_val);
+{%- endif %}
 
     double nlp_solver_step_length = {{ solver_options.nlp_solver_step_length }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "step_length", &nlp_solver_step_length);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "step_length", &nlp_solver_step_length);
 
     /* options QP solver */
 {%- if solver_options.qp_solver is starting_with("PARTIAL_CONDENSING") %}
@@ -1229,66 +1343,76 @@ int acados_create()
     // NOTE: there is no condensing happening here!
     qp_solver_cond_N = N;
     {%- endif %}
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "qp_cond_N", &qp_solver_cond_N);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "qp_cond_N", &qp_solver_cond_N);
 {% endif %}
 
     int qp_solver_iter_max = {{ solver_options.qp_solver_iter_max }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "qp_iter_max", &qp_solver_iter_max);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "qp_iter_max", &qp_solver_iter_max);
 
     {%- if solver_options.qp_solver_tol_stat %}
     double qp_solver_tol_stat = {{ solver_options.qp_solver_tol_stat }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "qp_tol_stat", &qp_solver_tol_stat);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "qp_tol_stat", &qp_solver_tol_stat);
     {%- endif -%}
 
     {%- if solver_options.qp_solver_tol_eq %}
     double qp_solver_tol_eq = {{ solver_options.qp_solver_tol_eq }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "qp_tol_eq", &qp_solver_tol_eq);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "qp_tol_eq", &qp_solver_tol_eq);
     {%- endif -%}
 
     {%- if solver_options.qp_solver_tol_ineq %}
     double qp_solver_tol_ineq = {{ solver_options.qp_solver_tol_ineq }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "qp_tol_ineq", &qp_solver_tol_ineq);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "qp_tol_ineq", &qp_solver_tol_ineq);
     {%- endif -%}
 
     {%- if solver_options.qp_solver_tol_comp %}
     double qp_solver_tol_comp = {{ solver_options.qp_solver_tol_comp }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "qp_tol_comp", &qp_solver_tol_comp);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "qp_tol_comp", &qp_solver_tol_comp);
     {%- endif -%}
 
-    {%- if solver_options.hessian_approx == "EXACT" -%}
+    {%- if solver_options.hessian_approx == "EXACT" and solver_options.code_target == "SPECIALIZED" -%}
+    for (int i = 0; i < N; i++)
+    {
+        int compute_hess = 1;
+        int compute_adj = 1;
+
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_compute_hess", &compute_hess);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_compute_adj", &compute_adj);
+    }
+    {%- elif solver_options.hessian_approx == "EXACT" -%}
     for (int i = 0; i < N; i++)
     {
         bool sens_hess = true;
         bool sens_adj = true;
 
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_sens_hess", &sens_hess);
-        ocp_nlp_solver_opts_set_at_stage(nlp_config, nlp_opts, i, "dynamics_sens_adj", &sens_adj);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_sens_hess", &sens_hess);
+        ocp_nlp_solver_opts_set_at_stage(capsule->nlp_config, capsule->nlp_opts, i, "dynamics_sens_adj", &sens_adj);
     }
     {%- endif %}
 
 {% if solver_options.nlp_solver_type == "SQP" -%}
     // set SQP specific options
     double nlp_solver_tol_stat = {{ solver_options.nlp_solver_tol_stat }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "tol_stat", &nlp_solver_tol_stat);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "tol_stat", &nlp_solver_tol_stat);
 
     double nlp_solver_tol_eq = {{ solver_options.nlp_solver_tol_eq }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "tol_eq", &nlp_solver_tol_eq);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "tol_eq", &nlp_solver_tol_eq);
 
     double nlp_solver_tol_ineq = {{ solver_options.nlp_solver_tol_ineq }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "tol_ineq", &nlp_solver_tol_ineq);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "tol_ineq", &nlp_solver_tol_ineq);
 
     double nlp_solver_tol_comp = {{ solver_options.nlp_solver_tol_comp }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "tol_comp", &nlp_solver_tol_comp);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "tol_comp", &nlp_solver_tol_comp);
 
     int nlp_solver_max_iter = {{ solver_options.nlp_solver_max_iter }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "max_iter", &nlp_solver_max_iter);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "max_iter", &nlp_solver_max_iter);
 {%- endif %}
 
     int print_level = {{ solver_options.print_level }};
-    ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "print_level", &print_level);
+    ocp_nlp_solver_opts_set(capsule->nlp_config, capsule->nlp_opts, "print_level", &print_level);
 
     /* out */
-    nlp_out = ocp_nlp_out_create(nlp_config, nlp_dims);
+    capsule->nlp_out = ocp_nlp_out_assign(capsule->nlp_config, capsule->nlp_dims,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_out_calculate_size(capsule->nlp_config, capsule->nlp_dims)));
 
     // initialize primal solution
     double x0[{{ dims.nx }}];
@@ -1312,13 +1436,16 @@ int acados_create()
     for (int i = 0; i < N; i++)
     {
         // x0
-        ocp_nlp_out_set(nlp_config, nlp_dims, nlp_out, i, "x", x0);
+        ocp_nlp_out_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_out, i, "x", x0);
         // u0
-        ocp_nlp_out_set(nlp_config, nlp_dims, nlp_out, i, "u", u0);
+        ocp_nlp_out_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_out, i, "u", u0);
     }
-    ocp_nlp_out_set(nlp_config, nlp_dims, nlp_out, N, "x", x0);
+    ocp_nlp_out_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_out, N, "x", x0);
     
-    nlp_solver = ocp_nlp_solver_create(nlp_config, nlp_dims, nlp_opts);
+    ocp_nlp_solver_opts_update(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_opts);
+    capsule->nlp_solver = ocp_nlp_solver_assign(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_opts,
+            {{ model.name }}_acados_alloc(capsule, ocp_nlp_solver_calculate_size(capsule->nlp_config,
+                                               capsule->nlp_dims, capsule->nlp_opts)));
 
     {% if dims.np > 0 %}
     // initialize parameters to nominal value
@@ -1330,44 +1457,53 @@ int acados_create()
 {% if solver_options.integrator_type == "IRK" %}
     for (int ii = 0; ii < N; ii++)
     {
-        impl_dae_fun[ii].set_param(impl_dae_fun+ii, p);
-        impl_dae_fun_jac_x_xdot_z[ii].set_param(impl_dae_fun_jac_x_xdot_z+ii, p);
-        impl_dae_jac_x_xdot_u_z[ii].set_param(impl_dae_jac_x_xdot_u_z+ii, p);
+        capsule->impl_dae_fun[ii].set_param(capsule->impl_dae_fun+ii, p);
+        capsule->impl_dae_fun_jac_x_xdot_z[ii].set_param(capsule->impl_dae_fun_jac_x_xdot_z+ii, p);
+        capsule->impl_dae_jac_x_xdot_u_z[ii].set_param(capsule->impl_dae_jac_x_xdot_u_z+ii, p);
+    }
+{% elif solver_options.integrator_type == "ERK" and solver_options.code_target == "SPECIALIZED" %}
+    for (int ii = 0; ii < N; ii++)
+    {
+        capsule->disc_dyn_fun[ii].set_param(capsule->disc_dyn_fun+ii, p);
+        capsule->disc_dyn_fun_jac[ii].set_param(capsule->disc_dyn_fun_jac+ii, p);
+    {%- if solver_options.hessian_approx == "EXACT" %}
+        capsule->disc_dyn_fun_jac_hess[ii].set_param(capsule->disc_dyn_fun_jac_hess+ii, p);
+    {%- endif %}
     }
 {% elif solver_options.integrator_type == "ERK" %}
     for (int ii = 0; ii < N; ii++)
     {
-        forw_vde_casadi[ii].set_param(forw_vde_casadi+ii, p);
+        capsule->forw_vde_casadi[ii].set_param(capsule->forw_vde_casadi+ii, p);
     }
 {% elif solver_options.integrator_type == "GNSF" %}
     for (int ii = 0; ii < N; ii++)
     {
-        gnsf_phi_fun[ii].set_param(gnsf_phi_fun+ii, p);
-        gnsf_phi_fun_jac_y[ii].set_param(gnsf_phi_fun_jac_y+ii, p);
-        gnsf_phi_jac_y_uhat[ii].set_param(gnsf_phi_jac_y_uhat+ii, p);
-        gnsf_f_lo_jac_x1_x1dot_u_z[ii].set_param(gnsf_f_lo_jac_x1_x1dot_u_z+ii, p);
+        capsule->gnsf_phi_fun[ii].set_param(capsule->gnsf_phi_fun+ii, p);
+        capsule->gnsf_phi_fun_jac_y[ii].set_param(capsule->gnsf_phi_fun_jac_y+ii, p);
+        capsule->gnsf_phi_jac_y_uhat[ii].set_param(capsule->gnsf_phi_jac_y_uhat+ii, p);
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[ii].set_param(capsule->gnsf_f_lo_jac_x1_x1dot_u_z+ii, p);
     }
 {% endif %}
 
     for (int ii = 0; ii < N; ii++) {
         {%- if constraints.constr_type == "BGP" %}
         // r_constraint[ii].set_param(r_constraint+ii, p);
-        phi_constraint[ii].set_param(phi_constraint+ii, p);
+        capsule->phi_constraint[ii].set_param(capsule->phi_constraint+ii, p);
         {% endif %}
         {%- if dims.nh > 0 %}
-        h_constraint[ii].set_param(h_constraint+ii, p);
+        capsule->h_constraint[ii].set_param(capsule->h_constraint+ii, p);
         {% endif %}
     }
     {%- if constraints.constr_type_e == "BGP" %}
     // r_e_constraint.set_param(&r_e_constraint, p);
-    phi_e_constraint.set_param(&phi_e_constraint, p);
+    capsule->phi_e_constraint.set_param(&capsule->phi_e_constraint, p);
     {% endif %}
     {%- if dims.nh_e > 0 %}
-    h_e_constraint.set_param(&h_e_constraint, p);
+    capsule->h_e_constraint.set_param(&capsule->h_e_constraint, p);
     {%- endif %}
     {% endif %}{# if dims.np #}
 
-    status = ocp_nlp_precompute(nlp_solver, nlp_in, nlp_out);
+    status = ocp_nlp_precompute(capsule->nlp_solver, capsule->nlp_in, capsule->nlp_out);
 
     if (status != ACADOS_SUCCESS)
     {
@@ -1378,7 +1514,7 @@ int acados_create()
 }
 
 
-int acados_update_params(int stage, double *p, int np)
+int {{ model.name }}_acados_update_params({{ model.name }}_solver_capsule *capsule, int stage, double *p, int np)
 {
     int solver_status = 0;
     int casadi_np = 0;
@@ -1387,71 +1523,84 @@ int acados_update_params(int stage, double *p, int np)
     if (stage < {{ dims.N }})
     {
     {%- if solver_options.integrator_type == "IRK" %}
-        casadi_np = (impl_dae_fun+stage)->np;
+        casadi_np = (capsule->impl_dae_fun+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in impl_dae_fun which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        impl_dae_fun[stage].set_param(impl_dae_fun+stage, p);
+        capsule->impl_dae_fun[stage].set_param(capsule->impl_dae_fun+stage, p);
 
-        casadi_np = (impl_dae_fun_jac_x_xdot_z+stage)->np;
+        casadi_np = (capsule->impl_dae_fun_jac_x_xdot_z+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in impl_dae_fun_jac_x_xdot_z which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        impl_dae_fun_jac_x_xdot_z[stage].set_param(impl_dae_fun_jac_x_xdot_z+stage, p);
+        capsule->impl_dae_fun_jac_x_xdot_z[stage].set_param(capsule->impl_dae_fun_jac_x_xdot_z+stage, p);
 
-        casadi_np = (impl_dae_jac_x_xdot_u_z+stage)->np;
+        casadi_np = (capsule->impl_dae_jac_x_xdot_u_z+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in impl_dae_jac_x_xdot_u_z which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        impl_dae_jac_x_xdot_u_z[stage].set_param(impl_dae_jac_x_xdot_u_z+stage, p);
+        capsule->impl_dae_jac_x_xdot_u_z[stage].set_param(capsule->impl_dae_jac_x_xdot_u_z+stage, p);
+
+    {% elif solver_options.integrator_type == "ERK" and solver_options.code_target == "SPECIALIZED" %}
+        casadi_np = (capsule->disc_dyn_fun+stage)->np;
+        if (casadi_np != np) {
+            printf("acados_update_params: trying to set %i parameters "
+                "in disc_dyn_fun which only has %i. Exiting.\n", np, casadi_np);
+            exit(1);
+        }
+        capsule->disc_dyn_fun[stage].set_param(capsule->disc_dyn_fun+stage, p);
+        capsule->disc_dyn_fun_jac[stage].set_param(capsule->disc_dyn_fun_jac+stage, p);
+        {%- if solver_options.hessian_approx == "EXACT" %}
+        capsule->disc_dyn_fun_jac_hess[stage].set_param(capsule->disc_dyn_fun_jac_hess+stage, p);
+        {%- endif %}
 
     {% elif solver_options.integrator_type == "ERK" %}
-        casadi_np = (forw_vde_casadi+stage)->np;
+        casadi_np = (capsule->forw_vde_casadi+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in forw_vde_casadi which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        forw_vde_casadi[stage].set_param(forw_vde_casadi+stage, p);
+        capsule->forw_vde_casadi[stage].set_param(capsule->forw_vde_casadi+stage, p);
 
     {% elif solver_options.integrator_type == "GNSF" %}
-        casadi_np = (gnsf_phi_fun+stage)->np;
+        casadi_np = (capsule->gnsf_phi_fun+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in forw_vde_casad which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        gnsf_phi_fun[stage].set_param(gnsf_phi_fun+stage, p);
+        capsule->gnsf_phi_fun[stage].set_param(capsule->gnsf_phi_fun+stage, p);
 
-        casadi_np = (gnsf_phi_fun_jac_y+stage)->np;
+        casadi_np = (capsule->gnsf_phi_fun_jac_y+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in gnsf_phi_fun_jac_y which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        gnsf_phi_fun_jac_y[stage].set_param(gnsf_phi_fun_jac_y+stage, p);
+        capsule->gnsf_phi_fun_jac_y[stage].set_param(capsule->gnsf_phi_fun_jac_y+stage, p);
 
-        casadi_np = (gnsf_phi_jac_y_uhat+stage)->np;
+        casadi_np = (capsule->gnsf_phi_jac_y_uhat+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in gnsf_phi_jac_y_uhat which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        gnsf_phi_jac_y_uhat[stage].set_param(gnsf_phi_jac_y_uhat+stage, p);
+        capsule->gnsf_phi_jac_y_uhat[stage].set_param(capsule->gnsf_phi_jac_y_uhat+stage, p);
 
-        casadi_np = (gnsf_f_lo_jac_x1_x1dot_u_z+stage)->np;
+        casadi_np = (capsule->gnsf_f_lo_jac_x1_x1dot_u_z+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in gnsf_f_lo_jac_x1_x1dot_u_z which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        gnsf_f_lo_jac_x1_x1dot_u_z[stage].set_param(gnsf_f_lo_jac_x1_x1dot_u_z+stage, p);
+        capsule->gnsf_f_lo_jac_x1_x1dot_u_z[stage].set_param(capsule->gnsf_f_lo_jac_x1_x1dot_u_z+stage, p);
 
     {%- endif %}{# integrator_type #}
         {% if constraints.constr_type == "BGP" %}
@@ -1462,43 +1611,51 @@ int acados_update_params(int stage, double *p, int np)
         //     exit(1);
         // }
         // r_constraint[stage].set_param(r_constraint+stage, p);
-        casadi_np = (phi_constraint+stage)->np;
+        casadi_np = (capsule->phi_constraint+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in phi_constraint which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        phi_constraint[stage].set_param(phi_constraint+stage, p);
+        capsule->phi_constraint[stage].set_param(capsule->phi_constraint+stage, p);
 
         {% elif constraints.constr_type == "BGH" and dims.nh > 0 %}
-        casadi_np = (h_constraint+stage)->np;
+        casadi_np = (capsule->h_constraint+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in h_constraint which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        h_constraint[stage].set_param(h_constraint+stage, p);
+        capsule->h_constraint[stage].set_param(capsule->h_constraint+stage, p);
         {%- endif %}
 
-    {%- if cost.cost_type == "NONLINEAR_LS" %}
-        casadi_np = (r_cost+stage)->np;
+    {%- if cost.cost_type == "NONLINEAR_LS" and solver_options.nls_cost_evaluation == "BATCH" %}
+        casadi_np = capsule->r_cost_batch.np;
+        if (casadi_np != np) {
+            printf("acados_update_params: trying to set %i parameters "
+                "in r_cost which only has %i. Exiting.\n", np, casadi_np);
+            exit(1);
+        }
+        capsule->r_cost[stage].set_param(capsule->r_cost+stage, p);
+    {%- elif cost.cost_type == "NONLINEAR_LS" %}
+        casadi_np = (capsule->r_cost+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in r_cost which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        r_cost[stage].set_param(r_cost+stage, p);
+        capsule->r_cost[stage].set_param(capsule->r_cost+stage, p);
 
     {%- elif cost.cost_type == "NONLINEAR_LS" %}
-        casadi_np = (ext_cost_fun+stage)->np;
+        casadi_np = (capsule->ext_cost_fun+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in ext_cost_fun which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        ext_cost_fun[stage].set_param(ext_cost_fun+stage, p);
+        capsule->ext_cost_fun[stage].set_param(capsule->ext_cost_fun+stage, p);
 
-        casadi_np = (ext_cost_fun_jac_hess+stage)->np;
+        casadi_np = (capsule->ext_cost_fun_jac_hess+stage)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in ext_cost_fun_jac_hess which only has %i. Exiting.\n", np, casadi_np);
@@ -1509,29 +1666,29 @@ int acados_update_params(int stage, double *p, int np)
     else // stage == N
     {
     {%- if cost.cost_type_e == "NONLINEAR_LS" %}
-        casadi_np = (&r_e_cost)->np;
+        casadi_np = (&capsule->r_e_cost)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in r_e_cost which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        r_e_cost.set_param(&r_e_cost, p);
+        capsule->r_e_cost.set_param(&capsule->r_e_cost, p);
     {%- elif cost.cost_type_e == "EXTERNAL" %}
-        casadi_np = (&ext_cost_e_fun)->np;
+        casadi_np = (&capsule->ext_cost_e_fun)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in ext_cost_e_fun which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        ext_cost_e_fun.set_param(&ext_cost_e_fun, p);
+        capsule->ext_cost_e_fun.set_param(&capsule->ext_cost_e_fun, p);
 
-        casadi_np = (&ext_cost_e_fun_jac_hess)->np;
+        casadi_np = (&capsule->ext_cost_e_fun_jac_hess)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in ext_cost_e_fun_jac_hess which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        ext_cost_e_fun_jac_hess.set_param(&ext_cost_e_fun_jac_hess, p);
+        capsule->ext_cost_e_fun_jac_hess.set_param(&capsule->ext_cost_e_fun_jac_hess, p);
     {% endif %}
         {% if constraints.constr_type_e == "BGP" %}
         // casadi_np = (&r_e_constraint)->np;
@@ -1541,23 +1698,27 @@ int acados_update_params(int stage, double *p, int np)
         //     exit(1);
         // }
         // r_e_constraint.set_param(&r_e_constraint, p);
-        casadi_np = (&phi_e_constraint)->np;
+        casadi_np = (&capsule->phi_e_constraint)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in phi_e_constraint which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        phi_e_constraint.set_param(&phi_e_constraint, p);
+        capsule->phi_e_constraint.set_param(&capsule->phi_e_constraint, p);
         {% elif constraints.constr_type_e == "BGH" and dims.nh_e > 0 %}
-        casadi_np = (&h_e_constraint)->np;
+        casadi_np = (&capsule->h_e_constraint)->np;
         if (casadi_np != np) {
             printf("acados_update_params: trying to set %i parameters "
                 "in h_e_constraint which only has %i. Exiting.\n", np, casadi_np);
             exit(1);
         }
-        h_e_constraint.set_param(&h_e_constraint, p);
+        capsule->h_e_constraint.set_param(&capsule->h_e_constraint, p);
         {% endif %}
     }
+
+    // keep a copy in the nlp input and mark the models of the stage as modified
+    ocp_nlp_in_set(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in, stage,
+                   "parameter_values", p);
 {% endif %}{# if dims.np #}
 
     return solver_status;
@@ -1565,51 +1726,201 @@ int acados_update_params(int stage, double *p, int np)
 
 
 
-int acados_solve()
+int {{ model.name }}_acados_solve({{ model.name }}_solver_capsule *capsule)
 {
     // solve NLP 
-    int solver_status = ocp_nlp_solve(nlp_solver, nlp_in, nlp_out);
+    int solver_status = ocp_nlp_solve(capsule->nlp_solver, capsule->nlp_in, capsule->nlp_out);
 
     return solver_status;
 }
 
 
-int acados_free()
+int {{ model.name }}_acados_snapshot_save({{ model.name }}_solver_capsule *capsule, const char *file_name)
 {
+    return ocp_nlp_snapshot_save(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in,
+                                 capsule->nlp_out, capsule->nlp_solver, file_name);
+}
+
+
+int {{ model.name }}_acados_snapshot_load({{ model.name }}_solver_capsule *capsule, const char *file_name)
+{
+    int status = ocp_nlp_snapshot_load(capsule->nlp_config, capsule->nlp_dims, capsule->nlp_in,
+                                       capsule->nlp_out, capsule->nlp_solver, file_name);
+{%- if dims.np > 0 %}
+
+    // pass the restored parameters to the external functions
+    if (status == ACADOS_SUCCESS)
+    {
+        for (int ii = 0; ii <= {{ dims.N }}; ii++)
+        {
+            {{ model.name }}_acados_update_params(capsule, ii,
+                capsule->nlp_in->parameter_values[ii], NP);
+        }
+    }
+{%- endif %}
+
+    return status;
+}
+
+
+int {{ model.name }}_acados_free({{ model.name }}_solver_capsule *capsule)
+{
+{%- if solver_options.memory_allocation == "STATIC" %}
+#ifndef {{ model.name }}_MEMORY_SIZE_PROBE
+    // all memory is in the static buffer
+    capsule->memory_size = 0;
+    return 0;
+#endif
+{%- endif %}
     // free memory
-    ocp_nlp_solver_opts_destroy(nlp_opts);
-    ocp_nlp_in_destroy(nlp_in);
-    ocp_nlp_out_destroy(nlp_out);
-    ocp_nlp_solver_destroy(nlp_solver);
-    ocp_nlp_dims_destroy(nlp_dims);
-    ocp_nlp_config_destroy(nlp_config);
-    ocp_nlp_plan_destroy(nlp_solver_plan);
-
-    // free external function 
-    {% if solver_options.integrator_type == "IRK" %}
-    for (int i = 0; i < {{ dims.N }}; i++)
+    ocp_nlp_solver_opts_destroy(capsule->nlp_opts);
+    ocp_nlp_in_destroy(capsule->nlp_in);
+    ocp_nlp_out_destroy(capsule->nlp_out);
+    ocp_nlp_solver_destroy(capsule->nlp_solver);
+    ocp_nlp_dims_destroy(capsule->nlp_dims);
+    ocp_nlp_config_destroy(capsule->nlp_config);
+    ocp_nlp_plan_destroy(capsule->nlp_solver_plan);
+
+    // free external function
+    {%- if solver_options.integrator_type == "IRK" %}
+    for (int i = 0; i < N; i++)
     {
-        external_function_param_casadi_free(&impl_dae_fun[i]);
-        external_function_param_casadi_free(&impl_dae_fun_jac_x_xdot_z[i]);
-        external_function_param_casadi_free(&impl_dae_jac_x_xdot_u_z[i]);
+        external_function_param_casadi_free(&capsule->impl_dae_fun[i]);
+        external_function_param_casadi_free(&capsule->impl_dae_fun_jac_x_xdot_z[i]);
+        external_function_param_casadi_free(&capsule->impl_dae_jac_x_xdot_u_z[i]);
     }
-    {% elif solver_options.integrator_type == "ERK"%}
-    for (int i = 0; i < {{ dims.N }}; i++)
+    free(capsule->impl_dae_fun);
+    free(capsule->impl_dae_fun_jac_x_xdot_z);
+    free(capsule->impl_dae_jac_x_xdot_u_z);
+    {%- elif solver_options.integrator_type == "ERK" and solver_options.code_target == "SPECIALIZED" %}
+    for (int i = 0; i < N; i++)
     {
-        external_function_param_casadi_free(&forw_vde_casadi[i]);
-    {% if solver_options.hessian_approx == "EXACT" %}
-        external_function_param_casadi_free(&hess_vde_casadi[i]);
-    {% endif %}
+        external_function_param_casadi_free(&capsule->disc_dyn_fun[i]);
+        external_function_param_casadi_free(&capsule->disc_dyn_fun_jac[i]);
+    {%- if solver_options.hessian_approx == "EXACT" %}
+        external_function_param_casadi_free(&capsule->disc_dyn_fun_jac_hess[i]);
+    {%- endif %}
     }
-    {% endif %}
+    free(capsule->disc_dyn_fun);
+    free(capsule->disc_dyn_fun_jac);
+    {%- if solver_options.hessian_approx == "EXACT" %}
+    free(capsule->disc_dyn_fun_jac_hess);
+    {%- endif %}
+    {%- elif solver_options.integrator_type == "ERK" %}
+    for (int i = 0; i < N; i++)
+    {
+        external_function_param_casadi_free(&capsule->forw_vde_casadi[i]);
+    {%- if solver_options.hessian_approx == "EXACT" %}
+        external_function_param_casadi_free(&capsule->hess_vde_casadi[i]);
+    {%- endif %}
+    }
+    free(capsule->forw_vde_casadi);
+    {%- if solver_options.hessian_approx == "EXACT" %}
+    free(capsule->hess_vde_casadi);
+    {%- endif %}
+    {%- elif solver_options.integrator_type == "GNSF" %}
+    for (int i = 0; i < N; i++)
+    {
+        external_function_param_casadi_free(&capsule->gnsf_phi_fun[i]);
+        external_function_param_casadi_free(&capsule->gnsf_phi_fun_jac_y[i]);
+        external_function_param_casadi_free(&capsule->gnsf_phi_jac_y_uhat[i]);
+        external_function_param_casadi_free(&capsule->gnsf_f_lo_jac_x1_x1dot_u_z[i]);
+        external_function_param_casadi_free(&capsule->gnsf_get_matrices_fun[i]);
+    }
+    free(capsule->gnsf_phi_fun);
+    free(capsule->gnsf_phi_fun_jac_y);
+    free(capsule->gnsf_phi_jac_y_uhat);
+    free(capsule->gnsf_f_lo_jac_x1_x1dot_u_z);
+    free(capsule->gnsf_get_matrices_fun);
+    {%- endif %}
+
+    {%- if constraints.constr_type == "BGH" and dims.nh > 0 %}
+    for (int i = 0; i < N; i++)
+        external_function_param_casadi_free(&capsule->h_constraint[i]);
+    free(capsule->h_constraint);
+    {%- elif constraints.constr_type == "BGP" %}
+    for (int i = 0; i < N; i++)
+        external_function_param_casadi_free(&capsule->phi_constraint[i]);
+    free(capsule->phi_constraint);
+    {%- endif %}
+    {%- if constraints.constr_type_e == "BGH" and dims.nh_e > 0 %}
+    external_function_param_casadi_free(&capsule->h_e_constraint);
+    {%- elif constraints.constr_type_e == "BGP" %}
+    external_function_param_casadi_free(&capsule->phi_e_constraint);
+    {%- endif %}
+
+    {%- if cost.cost_type == "NONLINEAR_LS" and solver_options.nls_cost_evaluation == "BATCH" %}
+    external_function_casadi_batch_free(&capsule->r_cost_batch);
+    free(capsule->r_cost);
+    {%- elif cost.cost_type == "NONLINEAR_LS" %}
+    for (int i = 0; i < N; i++)
+        external_function_param_casadi_free(&capsule->r_cost[i]);
+    free(capsule->r_cost);
+    {%- elif cost.cost_type == "EXTERNAL" %}
+    for (int i = 0; i < N; i++)
+    {
+        external_function_param_casadi_free(&capsule->ext_cost_fun[i]);
+        external_function_param_casadi_free(&capsule->ext_cost_fun_jac_hess[i]);
+    }
+    free(capsule->ext_cost_fun);
+    free(capsule->ext_cost_fun_jac_hess);
+    {%- endif %}
+    {%- if cost.cost_type_e == "NONLINEAR_LS" %}
+    external_function_param_casadi_free(&capsule->r_e_cost);
+    {%- elif cost.cost_type_e == "EXTERNAL" %}
+    external_function_param_casadi_free(&capsule->ext_cost_e_fun);
+    external_function_param_casadi_free(&capsule->ext_cost_e_fun_jac_hess);
+    {%- endif %}
+    capsule->memory_size = 0;
 
     return 0;
 }
 
-ocp_nlp_in * acados_get_nlp_in() { return  nlp_in; }
-ocp_nlp_out * acados_get_nlp_out() { return  nlp_out; }
-ocp_nlp_solver * acados_get_nlp_solver() { return  nlp_solver; }
-ocp_nlp_config * acados_get_nlp_config() { return  nlp_config; }
-void * acados_get_nlp_opts() { return  nlp_opts; }
-ocp_nlp_dims * acados_get_nlp_dims() { return  nlp_dims; }
-ocp_nlp_plan * acados_get_nlp_plan() { return  nlp_solver_plan; }
+ocp_nlp_in * {{ model.name }}_acados_get_nlp_in({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_in; }
+ocp_nlp_out * {{ model.name }}_acados_get_nlp_out({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_out; }
+ocp_nlp_solver * {{ model.name }}_acados_get_nlp_solver({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_solver; }
+ocp_nlp_config * {{ model.name }}_acados_get_nlp_config({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_config; }
+void * {{ model.name }}_acados_get_nlp_opts({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_opts; }
+ocp_nlp_dims * {{ model.name }}_acados_get_nlp_dims({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_dims; }
+ocp_nlp_plan * {{ model.name }}_acados_get_nlp_plan({{ model.name }}_solver_capsule *capsule) { return capsule->nlp_solver_plan; }
+
+
+
+/************************************************
+* single instance interface
+************************************************/
+
+static {{ model.name }}_solver_capsule *default_capsule = NULL;
+
+int acados_create()
+{
+    default_capsule = {{ model.name }}_acados_create_capsule();
+    return {{ model.name }}_acados_create(default_capsule);
+}
+
+int acados_update_params(int stage, double *p, int np)
+{
+    return {{ model.name }}_acados_update_params(default_capsule, stage, p, np);
+}
+
+int acados_solve()
+{
+    return {{ model.name }}_acados_solve(default_capsule);
+}
+
+int acados_free()
+{
+    int status = {{ model.name }}_acados_free(default_capsule);
+    {{ model.name }}_acados_free_capsule(default_capsule);
+    default_capsule = NULL;
+    return status;
+}
+
+ocp_nlp_in * acados_get_nlp_in() { return default_capsule->nlp_in; }
+ocp_nlp_out * acados_get_nlp_out() { return default_capsule->nlp_out; }
+ocp_nlp_solver * acados_get_nlp_solver() { return default_capsule->nlp_solver; }
+ocp_nlp_config * acados_get_nlp_config() { return default_capsule->nlp_config; }
+void * acados_get_nlp_opts() { return default_capsule->nlp_opts; }
+ocp_nlp_dims * acados_get_nlp_dims() { return default_capsule->nlp_dims; }
+ocp_nlp_plan * acados_get_nlp_plan() { return default_capsule->nlp_solver_plan; }
+{{ model.name }}_solver_capsule * acados_get_capsule() { return default_capsule; }
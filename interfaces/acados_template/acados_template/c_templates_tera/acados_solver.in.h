@@ -41,6 +41,95 @@
 extern "C" {
 #endif
 
+// solver instance: all the data of one solver, several instances can be used concurrently
+typedef struct {{ model.name }}_solver_capsule
+{
+    // acados objects
+    ocp_nlp_in *nlp_in;
+    ocp_nlp_out *nlp_out;
+    ocp_nlp_solver *nlp_solver;
+    void *nlp_opts;
+    ocp_nlp_plan *nlp_solver_plan;
+    ocp_nlp_config *nlp_config;
+    ocp_nlp_dims *nlp_dims;
+
+    // bytes of memory used by the acados objects and external functions
+    int memory_size;
+
+    // external functions
+{%- if solver_options.integrator_type == "ERK" and solver_options.code_target == "SPECIALIZED" %}
+    external_function_param_casadi *disc_dyn_fun;
+    external_function_param_casadi *disc_dyn_fun_jac;
+{%- if solver_options.hessian_approx == "EXACT" %}
+    external_function_param_casadi *disc_dyn_fun_jac_hess;
+{%- endif %}
+{%- elif solver_options.integrator_type == "ERK" %}
+    external_function_param_casadi *forw_vde_casadi;
+{%- if solver_options.hessian_approx == "EXACT" %}
+    external_function_param_casadi *hess_vde_casadi;
+{%- endif %}
+{%- elif solver_options.integrator_type == "IRK" %}
+    external_function_param_casadi *impl_dae_fun;
+    external_function_param_casadi *impl_dae_fun_jac_x_xdot_z;
+    external_function_param_casadi *impl_dae_jac_x_xdot_u_z;
+{%- elif solver_options.integrator_type == "GNSF" %}
+    external_function_param_casadi *gnsf_phi_fun;
+    external_function_param_casadi *gnsf_phi_fun_jac_y;
+    external_function_param_casadi *gnsf_phi_jac_y_uhat;
+    external_function_param_casadi *gnsf_f_lo_jac_x1_x1dot_u_z;
+    external_function_param_casadi *gnsf_get_matrices_fun;
+{%- endif %}
+
+{%- if constraints.constr_type == "BGH" %}
+    external_function_param_casadi *h_constraint;
+{%- elif constraints.constr_type == "BGP" %}
+    external_function_param_casadi *phi_constraint;
+{%- endif %}
+
+{%- if constraints.constr_type_e == "BGH" %}
+    external_function_param_casadi h_e_constraint;
+{%- elif constraints.constr_type_e == "BGP" %}
+    external_function_param_casadi phi_e_constraint;
+{%- endif %}
+
+{%- if cost.cost_type == "NONLINEAR_LS" and solver_options.nls_cost_evaluation == "BATCH" %}
+    external_function_casadi_batch_node *r_cost;
+    external_function_casadi_batch r_cost_batch;
+{%- elif cost.cost_type == "NONLINEAR_LS" %}
+    external_function_param_casadi *r_cost;
+{%- elif cost.cost_type == "EXTERNAL" %}
+    external_function_param_casadi *ext_cost_fun;
+    external_function_param_casadi *ext_cost_fun_jac_hess;
+{%- endif %}
+
+{%- if cost.cost_type_e == "NONLINEAR_LS" %}
+    external_function_param_casadi r_e_cost;
+{%- elif cost.cost_type_e == "EXTERNAL" %}
+    external_function_param_casadi ext_cost_e_fun;
+    external_function_param_casadi ext_cost_e_fun_jac_hess;
+{%- endif %}
+} {{ model.name }}_solver_capsule;
+
+{{ model.name }}_solver_capsule * {{ model.name }}_acados_create_capsule();
+int {{ model.name }}_acados_free_capsule({{ model.name }}_solver_capsule *capsule);
+
+int {{ model.name }}_acados_create({{ model.name }}_solver_capsule *capsule);
+int {{ model.name }}_acados_update_params({{ model.name }}_solver_capsule *capsule, int stage, double *value, int np);
+int {{ model.name }}_acados_solve({{ model.name }}_solver_capsule *capsule);
+// snapshot of the numerical state of the solver, see ocp_nlp_snapshot_save / ocp_nlp_snapshot_load
+int {{ model.name }}_acados_snapshot_save({{ model.name }}_solver_capsule *capsule, const char *file_name);
+int {{ model.name }}_acados_snapshot_load({{ model.name }}_solver_capsule *capsule, const char *file_name);
+int {{ model.name }}_acados_free({{ model.name }}_solver_capsule *capsule);
+
+ocp_nlp_in * {{ model.name }}_acados_get_nlp_in({{ model.name }}_solver_capsule *capsule);
+ocp_nlp_out * {{ model.name }}_acados_get_nlp_out({{ model.name }}_solver_capsule *capsule);
+ocp_nlp_solver * {{ model.name }}_acados_get_nlp_solver({{ model.name }}_solver_capsule *capsule);
+ocp_nlp_config * {{ model.name }}_acados_get_nlp_config({{ model.name }}_solver_capsule *capsule);
+void * {{ model.name }}_acados_get_nlp_opts({{ model.name }}_solver_capsule *capsule);
+ocp_nlp_dims * {{ model.name }}_acados_get_nlp_dims({{ model.name }}_solver_capsule *capsule);
+ocp_nlp_plan * {{ model.name }}_acados_get_nlp_plan({{ model.name }}_solver_capsule *capsule);
+
+// single instance interface, operating on a default capsule
 int acados_create();
 int acados_update_params(int stage, double *value, int np);
 int acados_solve();
@@ -53,53 +142,11 @@ ocp_nlp_config * acados_get_nlp_config();
 void * acados_get_nlp_opts();
 ocp_nlp_dims * acados_get_nlp_dims();
 ocp_nlp_plan * acados_get_nlp_plan();
+{{ model.name }}_solver_capsule * acados_get_capsule();
 
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
 
-// ** global data **
-// acados objects
-extern ocp_nlp_in * nlp_in;
-extern ocp_nlp_out * nlp_out;
-extern ocp_nlp_solver * nlp_solver;
-extern void * nlp_opts;
-extern ocp_nlp_plan * nlp_solver_plan;
-extern ocp_nlp_config * nlp_config;
-extern ocp_nlp_dims * nlp_dims;
-
-// external functions
-{% if solver_options.integrator_type == "ERK" %}
-extern external_function_param_casadi * forw_vde_casadi;
-{% if solver_options.hessian_approx == "EXACT" %}
-extern external_function_param_casadi * hess_vde_casadi;
-{%- endif %}
-{% elif solver_options.integrator_type == "IRK" %}
-extern external_function_param_casadi * impl_dae_fun;
-extern external_function_param_casadi * impl_dae_fun_jac_x_xdot_z;
-extern external_function_param_casadi * impl_dae_jac_x_xdot_u_z;
-{%- endif %}
-
-{%- if constraints.constr_type == "BGP" %}
-extern external_function_param_casadi * phi_constraint;
-// extern external_function_param_casadi * r_constraint;
-{% elif constraints.constr_type == "BGH" and dims.nh > 0 %}
-extern external_function_param_casadi * h_constraint;
-{% endif %}
-
-{% if constraints.constr_type_e == "BGP" %}
-extern external_function_param_casadi phi_e_constraint;
-// extern external_function_param_casadi r_e_constraint;
-{% elif constraints.constr_type_e == "BGH" and dims.nh_e > 0 %}
-extern external_function_param_casadi h_e_constraint;
-{%- endif %}
-
-{% if cost.cost_type == "NONLINEAR_LS" %}
-extern external_function_param_casadi * r_cost;
-{% endif %}
-{% if cost.cost_type_e == "NONLINEAR_LS" %}
-extern external_function_param_casadi r_e_cost;
-{%- endif %}
-
 
 #endif  // ACADOS_SOLVER_{{ model.name }}_H_
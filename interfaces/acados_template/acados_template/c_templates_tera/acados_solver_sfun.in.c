@@ -162,6 +162,9 @@ static void mdlInitializeSizes (SimStruct *S)
 
     // one sample time
     ssSetNumSampleTimes(S, 1);
+
+    // solver capsule of this block
+    ssSetNumPWork(S, 1);
 }
 
 
@@ -194,11 +197,22 @@ static void mdlInitializeSampleTimes(SimStruct *S)
 
 static void mdlStart(SimStruct *S)
 {
-    acados_create();
+    {{ model.name }}_solver_capsule *capsule = {{ model.name }}_acados_create_capsule();
+    {{ model.name }}_acados_create(capsule);
+
+    ssGetPWork(S)[0] = (void *) capsule;
 }
 
 static void mdlOutputs(SimStruct *S, int_T tid)
 {
+    {{ model.name }}_solver_capsule *capsule = ssGetPWork(S)[0];
+    ocp_nlp_config *nlp_config = {{ model.name }}_acados_get_nlp_config(capsule);
+    ocp_nlp_dims *nlp_dims = {{ model.name }}_acados_get_nlp_dims(capsule);
+    ocp_nlp_in *nlp_in = {{ model.name }}_acados_get_nlp_in(capsule);
+    ocp_nlp_out *nlp_out = {{ model.name }}_acados_get_nlp_out(capsule);
+    ocp_nlp_solver *nlp_solver = {{ model.name }}_acados_get_nlp_solver(capsule);
+    void *nlp_opts = {{ model.name }}_acados_get_nlp_opts(capsule);
+
     InputRealPtrsType in_sign;
     {% set input_sizes = [dims.nx, dims.ny, dims.ny_e, dims.np, dims.nbx, dims.nbu, dims.ng, dims.nh] %}
 
@@ -251,7 +265,7 @@ static void mdlOutputs(SimStruct *S, int_T tid)
     {
         for (int jj = 0; jj < {{ dims.np }}; jj++)
             buffer[jj] = (double)(*in_sign[ii*{{dims.np}}+jj]);
-        acados_update_params(ii, buffer, {{ dims.np }});
+        {{ model.name }}_acados_update_params(capsule, ii, buffer, {{ dims.np }});
     }
 {%- endif %}
 
@@ -347,7 +361,7 @@ static void mdlOutputs(SimStruct *S, int_T tid)
     /* call solver */
     int rti_phase = 0;
     ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "rti_phase", rti_phase);
-    int acados_status = acados_solve();
+    int acados_status = {{ model.name }}_acados_solve(capsule);
 
 
     /* set outputs */
@@ -385,7 +399,10 @@ static void mdlOutputs(SimStruct *S, int_T tid)
 
 static void mdlTerminate(SimStruct *S)
 {
-    acados_free();
+    {{ model.name }}_solver_capsule *capsule = ssGetPWork(S)[0];
+
+    {{ model.name }}_acados_free(capsule);
+    {{ model.name }}_acados_free_capsule(capsule);
 }
 
 
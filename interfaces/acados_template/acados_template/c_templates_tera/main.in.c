@@ -46,8 +46,8 @@
 int main()
 {
 
-    int status = 0;
-    status = acados_create();
+    {{ model.name }}_solver_capsule *acados_ocp_capsule = {{ model.name }}_acados_create_capsule();
+    int status = {{ model.name }}_acados_create(acados_ocp_capsule);
 
     if (status)
     {
@@ -55,6 +55,13 @@ int main()
         exit(1);
     }
 
+    ocp_nlp_config *nlp_config = {{ model.name }}_acados_get_nlp_config(acados_ocp_capsule);
+    ocp_nlp_dims *nlp_dims = {{ model.name }}_acados_get_nlp_dims(acados_ocp_capsule);
+    ocp_nlp_in *nlp_in = {{ model.name }}_acados_get_nlp_in(acados_ocp_capsule);
+    ocp_nlp_out *nlp_out = {{ model.name }}_acados_get_nlp_out(acados_ocp_capsule);
+    ocp_nlp_solver *nlp_solver = {{ model.name }}_acados_get_nlp_solver(acados_ocp_capsule);
+    void *nlp_opts = {{ model.name }}_acados_get_nlp_opts(acados_ocp_capsule);
+
     // initial condition
     int idxbx0[{{ dims.nbx_0 }}];
     {% for i in range(end=dims.nbx_0) %}
@@ -93,35 +100,10 @@ int main()
     {% endfor %}
 
 
-    {%- if solver_options.integrator_type == "IRK" -%}
-    for (int ii = 0; ii < {{ dims.N }}; ii++)
-    {
-        impl_dae_fun[ii].set_param(impl_dae_fun+ii, p);
-        impl_dae_fun_jac_x_xdot_z[ii].set_param(impl_dae_fun_jac_x_xdot_z+ii, p);
-        impl_dae_jac_x_xdot_u_z[ii].set_param(impl_dae_jac_x_xdot_u_z+ii, p);
-    }
-    {% elif solver_options.integrator_type == "ERK" %}
-    for (int ii = 0; ii < {{ dims.N }}; ii++)
+    for (int ii = 0; ii <= {{ dims.N }}; ii++)
     {
-        forw_vde_casadi[ii].set_param(forw_vde_casadi+ii, p);
+        {{ model.name }}_acados_update_params(acados_ocp_capsule, ii, p, {{ dims.np }});
     }
-    {%- endif %}
-    for (int ii = 0; ii < {{ dims.N }}; ii++) {
-        {%- if constraints.constr_type == "BGP" %}
-        // r_constraint[ii].set_param(r_constraint+ii, p);
-        phi_constraint[ii].set_param(phi_constraint+ii, p);
-        {%- endif %}
-        {%- if dims.nh > 0 %}
-        h_constraint[ii].set_param(h_constraint+ii, p);
-        {% endif %}
-    }
-    {%- if constraints.constr_type_e == "BGP" %}
-    // r_e_constraint.set_param(&r_e_constraint, p);
-    phi_e_constraint.set_param(&phi_e_constraint, p);
-    {% endif %}
-    {%- if dims.nh_e > 0 %}
-    h_e_constraint.set_param(&h_e_constraint, p);
-    {% endif %}
   {% endif %}{# if np > 0 #}
 
     // prepare evaluation
@@ -148,7 +130,7 @@ int main()
             ocp_nlp_out_set(nlp_config, nlp_dims, nlp_out, i, "u", u0);
         }
         ocp_nlp_solver_opts_set(nlp_config, nlp_opts, "rti_phase", rti_phase);
-        status = acados_solve();
+        status = {{ model.name }}_acados_solve(acados_ocp_capsule);
         ocp_nlp_get(nlp_config, nlp_solver, "time_tot", &elapsed_time);
         min_time = MIN(elapsed_time, min_time);
     }
@@ -185,10 +167,12 @@ int main()
            sqp_iter, min_time*1000, kkt_norm_inf);
 
     // free solver
-    status = acados_free();
+    status = {{ model.name }}_acados_free(acados_ocp_capsule);
     if (status) {
         printf("acados_free() returned status %d. \n", status);
     }
 
+    {{ model.name }}_acados_free_capsule(acados_ocp_capsule);
+
     return status;
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// memory size probe: creates the solver once with the create path of the generated code
+// (compiled with -D{{ model.name }}_MEMORY_SIZE_PROBE) and writes the number of bytes it uses
+// to acados_solver_{{ model.name }}_memory.h, which sizes the static memory of the solver
+//
+// The size is the one of the platform the probe runs on: the memory of the acados objects
+// depends on the size of pointers and ints and on the alignment of the target. When
+// cross-compiling, the probe has to be compiled for and run on the target (or an emulator of it)
+// and the generated header copied to the build, the size measured on the build host is wrong.
+
+// standard
+#include <stdio.h>
+#include <stdlib.h>
+// acados
+#include "acados_c/ocp_nlp_interface.h"
+#include "acados_solver_{{ model.name }}.h"
+
+
+int main()
+{
+    {{ model.name }}_solver_capsule *capsule = {{ model.name }}_acados_create_capsule();
+    int status = {{ model.name }}_acados_create(capsule);
+
+    if (status)
+    {
+        printf("{{ model.name }}_acados_create() returned status %d. Exiting.\n", status);
+        exit(1);
+    }
+
+    int memory_size = capsule->memory_size;
+
+    FILE *file = fopen("acados_solver_{{ model.name }}_memory.h", "w");
+    if (file == NULL)
+    {
+        printf("memory_size_{{ model.name }}: cannot open acados_solver_{{ model.name }}_memory.h. Exiting.\n");
+        exit(1);
+    }
+    fprintf(file, "// generated by memory_size_{{ model.name }}, do not edit\n\n");
+    fprintf(file, "#ifndef ACADOS_SOLVER_{{ model.name }}_MEMORY_H_\n");
+    fprintf(file, "#define ACADOS_SOLVER_{{ model.name }}_MEMORY_H_\n\n");
+    fprintf(file, "#define {{ model.name }}_STATIC_MEMORY_SIZE %d\n\n", memory_size);
+    fprintf(file, "#endif  // ACADOS_SOLVER_{{ model.name }}_MEMORY_H_\n");
+    fclose(file);
+
+    printf("static memory of {{ model.name }}: %d bytes\n", memory_size);
+
+    {{ model.name }}_acados_free(capsule);
+    {{ model.name }}_acados_free_capsule(capsule);
+
+    return 0;
+}
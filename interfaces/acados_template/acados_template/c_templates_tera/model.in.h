@@ -156,6 +156,28 @@ const int *{{ model.name }}_expl_ode_hess_sparsity_out(int);
 int {{ model.name }}_expl_ode_hess_n_in();
 int {{ model.name }}_expl_ode_hess_n_out();
 
+// discrete dynamics of the unrolled ERK step (code_target SPECIALIZED)
+int {{ model.name }}_dyn_disc_phi_fun(const real_t** arg, real_t** res, int* iw, real_t* w, void *mem);
+int {{ model.name }}_dyn_disc_phi_fun_work(int *, int *, int *, int *);
+const int *{{ model.name }}_dyn_disc_phi_fun_sparsity_in(int);
+const int *{{ model.name }}_dyn_disc_phi_fun_sparsity_out(int);
+int {{ model.name }}_dyn_disc_phi_fun_n_in();
+int {{ model.name }}_dyn_disc_phi_fun_n_out();
+
+int {{ model.name }}_dyn_disc_phi_fun_jac(const real_t** arg, real_t** res, int* iw, real_t* w, void *mem);
+int {{ model.name }}_dyn_disc_phi_fun_jac_work(int *, int *, int *, int *);
+const int *{{ model.name }}_dyn_disc_phi_fun_jac_sparsity_in(int);
+const int *{{ model.name }}_dyn_disc_phi_fun_jac_sparsity_out(int);
+int {{ model.name }}_dyn_disc_phi_fun_jac_n_in();
+int {{ model.name }}_dyn_disc_phi_fun_jac_n_out();
+
+int {{ model.name }}_dyn_disc_phi_fun_jac_hess(const real_t** arg, real_t** res, int* iw, real_t* w, void *mem);
+int {{ model.name }}_dyn_disc_phi_fun_jac_hess_work(int *, int *, int *, int *);
+const int *{{ model.name }}_dyn_disc_phi_fun_jac_hess_sparsity_in(int);
+const int *{{ model.name }}_dyn_disc_phi_fun_jac_hess_sparsity_out(int);
+int {{ model.name }}_dyn_disc_phi_fun_jac_hess_n_in();
+int {{ model.name }}_dyn_disc_phi_fun_jac_hess_n_out();
+
 {% endif %}
 
 #ifdef __cplusplus
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// test of the static memory option: fails if the solver allocates heap memory during
+// initialization or in the solver calls. The allocation functions of the C library are
+// interposed by definitions in this executable, which count the calls and forward them to the
+// next definition (dlsym with RTLD_NEXT, POSIX dynamic linking).
+
+// RTLD_NEXT
+#define _GNU_SOURCE
+
+// standard
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// acados
+#include "acados_c/ocp_nlp_interface.h"
+#include "acados_solver_{{ model.name }}.h"
+
+#define NUM_SOLVES 10
+#define BOOTSTRAP_SIZE 4096
+
+static void *(*next_malloc)(size_t) = NULL;
+static void *(*next_calloc)(size_t, size_t) = NULL;
+static void *(*next_realloc)(void *, size_t) = NULL;
+static void (*next_free)(void *) = NULL;
+
+static int count_allocations = 0;
+static int num_allocations = 0;
+
+// dlsym itself may allocate memory (e.g. glibc calls calloc), which is taken from this buffer
+// while the next definitions are looked up
+static char bootstrap_memory[BOOTSTRAP_SIZE];
+static size_t bootstrap_used = 0;
+static int resolving = 0;
+
+static void *bootstrap_alloc(size_t size)
+{
+    size = (size + 15) / 16 * 16;
+    if (bootstrap_used + size > BOOTSTRAP_SIZE)
+        return NULL;
+    void *ptr = bootstrap_memory + bootstrap_used;
+    bootstrap_used += size;
+    return ptr;
+}
+
+static int is_bootstrap(void *ptr)
+{
+    return (char *) ptr >= bootstrap_memory && (char *) ptr < bootstrap_memory + BOOTSTRAP_SIZE;
+}
+
+static void resolve_next(void)
+{
+    resolving = 1;
+    *(void **) (&next_malloc) = dlsym(RTLD_NEXT, "malloc");
+    *(void **) (&next_calloc) = dlsym(RTLD_NEXT, "calloc");
+    *(void **) (&next_realloc) = dlsym(RTLD_NEXT, "realloc");
+    *(void **) (&next_free) = dlsym(RTLD_NEXT, "free");
+    resolving = 0;
+
+    if (!next_malloc || !next_calloc || !next_realloc || !next_free)
+    {
+        fprintf(stderr, "no_malloc_test: cannot find the allocation functions. Exiting.\n");
+        exit(1);
+    }
+}
+
+void *malloc(size_t size)
+{
+    if (resolving)
+        return bootstrap_alloc(size);
+    if (next_malloc == NULL)
+        resolve_next();
+    num_allocations += count_allocations;
+    return next_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    // the bootstrap memory is static, thus zeroed
+    if (resolving)
+        return bootstrap_alloc(nmemb * size);
+    if (next_calloc == NULL)
+        resolve_next();
+    num_allocations += count_allocations;
+    return next_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (resolving)
+        return bootstrap_alloc(size);
+    if (next_realloc == NULL)
+        resolve_next();
+    num_allocations += count_allocations;
+    if (is_bootstrap(ptr))
+    {
+        // copy what is left of the bootstrap memory after ptr at most
+        void *new_ptr = next_malloc(size);
+        size_t max_size = bootstrap_memory + BOOTSTRAP_SIZE - (char *) ptr;
+        if (new_ptr)
+            memcpy(new_ptr, ptr, size < max_size ? size : max_size);
+        return new_ptr;
+    }
+    return next_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr == NULL || is_bootstrap(ptr))
+        return;
+    if (next_free == NULL)
+        resolve_next();
+    next_free(ptr);
+}
+
+
+int main()
+{
+    int status;
+    int init_allocations, solve_allocations;
+
+    // the first output allocates the stdout buffer, before counting starts
+    printf("no_malloc_test: {{ model.name }}\n");
+
+    // initialization
+    count_allocations = 1;
+    {{ model.name }}_solver_capsule *capsule = {{ model.name }}_acados_create_capsule();
+    status = {{ model.name }}_acados_create(capsule);
+    count_allocations = 0;
+    init_allocations = num_allocations;
+
+    if (capsule == NULL || status)
+    {
+        printf("no_malloc_test: {{ model.name }}_acados_create() returned status %d. Exiting.\n", status);
+        exit(1);
+    }
+
+    // solver calls
+    num_allocations = 0;
+    count_allocations = 1;
+    for (int ii = 0; ii < NUM_SOLVES; ii++)
+    {
+        status = {{ model.name }}_acados_solve(capsule);
+        if (status)
+            break;
+    }
+    count_allocations = 0;
+    solve_allocations = num_allocations;
+
+    // a solver failing early could skip allocations
+    if (status)
+    {
+        printf("no_malloc_test: {{ model.name }}_acados_solve() returned status %d. Exiting.\n", status);
+        exit(1);
+    }
+
+    {{ model.name }}_acados_free(capsule);
+    {{ model.name }}_acados_free_capsule(capsule);
+
+    printf("no_malloc_test: %d allocations in initialization, %d in %d solver calls\n",
+           init_allocations, solve_allocations, NUM_SOLVES);
+
+    if (init_allocations || solve_allocations)
+    {
+        printf("no_malloc_test: FAILED\n");
+        return 1;
+    }
+
+    printf("no_malloc_test: SUCCESS\n");
+    return 0;
+}
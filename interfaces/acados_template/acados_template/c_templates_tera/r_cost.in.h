@@ -46,6 +46,11 @@ const int *{{ model.name }}_r_cost_sparsity_in(int);
 const int *{{ model.name }}_r_cost_sparsity_out(int);
 int {{ model.name }}_r_cost_n_in();
 int {{ model.name }}_r_cost_n_out();
+{% if solver_options.nls_cost_evaluation == "BATCH" %}
+// map over the shooting nodes
+int {{ model.name }}_r_cost_map(const real_t** arg, real_t** res, int* iw, real_t* w, void *mem);
+int {{ model.name }}_r_cost_map_work(int *, int *, int *, int *);
+{% endif %}
 {% endif %}
 
 #ifdef __cplusplus
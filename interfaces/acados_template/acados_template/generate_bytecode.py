@@ -0,0 +1,114 @@
+#
+# Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+# Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+# Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+# Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+#
+# This file is part of acados.
+#
+# The 2-Clause BSD License
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.;
+#
+
+import casadi
+from casadi import Function
+
+# casadi operations supported by external_function_bytecode, in the order of ext_fun_bytecode_op
+# (acados/utils/external_function_generic.h)
+BYTECODE_OPS = ['OP_CONST', 'OP_INPUT', 'OP_OUTPUT', 'OP_ASSIGN',
+    'OP_ADD', 'OP_SUB', 'OP_MUL', 'OP_DIV', 'OP_NEG', 'OP_EXP', 'OP_LOG', 'OP_POW',
+    'OP_SQRT', 'OP_SQ', 'OP_TWICE', 'OP_SIN', 'OP_COS', 'OP_TAN', 'OP_ASIN', 'OP_ACOS',
+    'OP_ATAN', 'OP_LT', 'OP_LE', 'OP_EQ', 'OP_NE', 'OP_NOT', 'OP_AND', 'OP_OR',
+    'OP_FLOOR', 'OP_CEIL', 'OP_FMOD', 'OP_FABS', 'OP_SIGN', 'OP_COPYSIGN', 'OP_IF_ELSE_ZERO',
+    'OP_ERF', 'OP_FMIN', 'OP_FMAX', 'OP_INV', 'OP_SINH', 'OP_COSH', 'OP_TANH', 'OP_ASINH',
+    'OP_ACOSH', 'OP_ATANH', 'OP_ATAN2', 'OP_LOG1P', 'OP_EXPM1', 'OP_HYPOT']
+
+# casadi operations evaluated by an equivalent instruction
+BYTECODE_ALIASES = {'OP_CONSTPOW': 'OP_POW'}
+
+
+def bytecode_op_table():
+    table = dict()
+    for code, name in enumerate(BYTECODE_OPS):
+        if hasattr(casadi, name):
+            table[getattr(casadi, name)] = code
+    for name, alias in BYTECODE_ALIASES.items():
+        if hasattr(casadi, name):
+            table[getattr(casadi, name)] = BYTECODE_OPS.index(alias)
+    return table
+
+
+def generate_bytecode(fun, file_name):
+    """
+    Write the expression graph of the casadi function fun to file_name, to be evaluated by
+    external_function_bytecode (see external_function_bytecode_create_from_file) without
+    generating and compiling C code. MX functions are expanded to SX.
+    """
+
+    if not fun.is_a('SXFunction'):
+        fun = fun.expand()
+
+    op_table = bytecode_op_table()
+    op_input = getattr(casadi, 'OP_INPUT')
+    op_output = getattr(casadi, 'OP_OUTPUT')
+    op_const = getattr(casadi, 'OP_CONST')
+
+    sparsity = [fun.sparsity_in(i).compress() for i in range(fun.n_in())] \
+             + [fun.sparsity_out(i).compress() for i in range(fun.n_out())]
+    sp_len = sum(len(sp) for sp in sparsity)
+
+    instructions = []
+    for k in range(fun.n_instructions()):
+        op = fun.instruction_id(k)
+        if op not in op_table:
+            raise Exception('generate_bytecode: casadi operation {} not supported'.format(op))
+        inp = list(fun.instruction_input(k))
+        out = list(fun.instruction_output(k))
+        cst = 0.0
+        if op == op_const:
+            dst, a, b = out[0], 0, 0
+            cst = fun.instruction_constant(k)
+        elif op == op_input:
+            dst, a, b = out[0], inp[0], inp[1]
+        elif op == op_output:
+            dst, a, b = out[0], inp[0], out[1]
+        else:
+            dst = out[0]
+            a = inp[0] if len(inp) > 0 else 0
+            b = inp[1] if len(inp) > 1 else 0
+        instructions.append((op_table[op], dst, a, b, cst))
+
+    # at least one register, the unused operand of unary instructions points to register 0
+    reg_num = max(fun.sz_w(), 1)
+
+    with open(file_name, 'w') as f:
+        f.write('acados_bytecode 1 {} {} {} {} {}\n'.format(fun.n_in(), fun.n_out(), sp_len,
+            reg_num, len(instructions)))
+        for sp in sparsity:
+            f.write('{} {}\n'.format(len(sp), ' '.join(str(s) for s in sp)))
+        for instr in instructions:
+            f.write('{} {} {} {} {}\n'.format(instr[0], instr[1], instr[2], instr[3],
+                repr(float(instr[4]))))
+
+    return
@@ -0,0 +1,136 @@
+#
+# Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+# Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+# Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+# Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+#
+# This file is part of acados.
+#
+# The 2-Clause BSD License
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.;
+#
+
+
+import os
+from casadi import *
+from .utils import ALLOWED_CASADI_VERSIONS
+
+# Butcher tableaus of the ERK integrator of acados (sim_erk_integrator.c)
+ERK_TABLEAUS = {
+    1: ([[0.0]], [1.0]),
+    2: ([[0.0, 0.0], [0.5, 0.0]], [0.0, 1.0]),
+    4: ([[0.0, 0.0, 0.0, 0.0], [0.5, 0.0, 0.0, 0.0], [0.0, 0.5, 0.0, 0.0], [0.0, 0.0, 1.0, 0.0]],
+        [1.0/6.0, 1.0/3.0, 1.0/3.0, 1.0/6.0]),
+}
+
+def generate_c_code_erk_specialized( model, Ts, num_stages, num_steps, generate_hess ):
+    """
+    generate the explicit Runge-Kutta integration over one shooting interval as discrete
+    dynamics: dimensions, stages and steps are fixed, so that CasADi emits one straight-line
+    function, with the sensitivities by algorithmic differentiation of the unrolled step
+    """
+
+    casadi_version = CasadiMeta.version()
+    casadi_opts = dict(mex=False, casadi_int='int', casadi_real='double')
+    if casadi_version not in (ALLOWED_CASADI_VERSIONS):
+        msg =  'Please download and install CasADi {} '.format(" or ".join(ALLOWED_CASADI_VERSIONS))
+        msg += 'to ensure compatibility with acados.\n'
+        msg += 'Version {} currently in use.'.format(casadi_version)
+        raise Exception(msg)
+
+    if num_stages not in ERK_TABLEAUS:
+        raise Exception('generate_c_code_erk_specialized: sim_method_num_stages must be in {}.'\
+            .format(list(ERK_TABLEAUS.keys())))
+
+    # load model
+    x = model.x
+    u = model.u
+    p = model.p
+    f_expl = model.f_expl_expr
+    model_name = model.name
+
+    nx = x.size()[0]
+
+    if isinstance(f_expl, casadi.SX):
+        lambdaX = SX.sym('lambdaX', nx, 1)
+    elif isinstance(f_expl, casadi.MX):
+        lambdaX = MX.sym('lambdaX', nx, 1)
+    else:
+        raise Exception("Invalid type for f_expl! Possible types are 'SX' and 'MX'. Exiting.")
+
+    ode = Function(model_name + '_expl_ode', [x, u, p], [f_expl])
+
+    ## unrolled integration step
+    A, b = ERK_TABLEAUS[num_stages]
+    h = Ts / num_steps
+    x_next = x
+    for step in range(num_steps):
+        k = []
+        for s in range(num_stages):
+            x_stage = x_next
+            for j in range(s):
+                if A[s][j] != 0.0:
+                    x_stage = x_stage + h * A[s][j] * k[j]
+            k.append(ode(x_stage, u, p))
+        for s in range(num_stages):
+            if b[s] != 0.0:
+                x_next = x_next + h * b[s] * k[s]
+
+    # transposed jacobian and hessian with respect to [u; x], as in the discrete dynamics module
+    ux = vertcat(u, x)
+    jac_ux_t = transpose(jacobian(x_next, ux))
+
+    fun_name = model_name + '_dyn_disc_phi_fun'
+    disc_fun = Function(fun_name, [x, u, p], [x_next])
+
+    fun_name = model_name + '_dyn_disc_phi_fun_jac'
+    disc_fun_jac = Function(fun_name, [x, u, p], [x_next, jac_ux_t])
+
+    if generate_hess:
+        hess_ux = hessian(dot(lambdaX, x_next), ux)[0]
+        fun_name = model_name + '_dyn_disc_phi_fun_jac_hess'
+        disc_fun_jac_hess = Function(fun_name, [x, u, lambdaX, p], [x_next, jac_ux_t, hess_ux])
+
+    ## generate C code
+    if not os.path.exists('c_generated_code'):
+        os.mkdir('c_generated_code')
+
+    os.chdir('c_generated_code')
+    model_dir = model_name + '_model'
+    if not os.path.exists(model_dir):
+        os.mkdir(model_dir)
+    model_dir_location = './' + model_dir
+    os.chdir(model_dir_location)
+
+    fun_name = model_name + '_dyn_disc_phi_fun'
+    disc_fun.generate(fun_name, casadi_opts)
+
+    fun_name = model_name + '_dyn_disc_phi_fun_jac'
+    disc_fun_jac.generate(fun_name, casadi_opts)
+
+    if generate_hess:
+        fun_name = model_name + '_dyn_disc_phi_fun_jac_hess'
+        disc_fun_jac_hess.generate(fun_name, casadi_opts)
+
+    os.chdir('../..')
@@ -103,11 +103,14 @@ def generate_c_code_explicit_ode( model ):
     expl_vde_adj = Function(fun_name, [x, lambdaX, u, p], [adj])
 
     S_forw = vertcat(horzcat(Sx, Sp), horzcat(DM.zeros(nu,nx), DM.eye(nu)))
-    hess = mtimes(transpose(S_forw),jtimes(adj, vertcat(x,u), S_forw))
+    # symmetric second order sweep: use the (sparse) hessian of lambdaX^T f_expl
+    # and only form the lower triangle of S_forw^T * hess_lag * S_forw
+    hess_lag = hessian(dot(lambdaX, f_expl), vertcat(x, u))[0]
+    hess_S = mtimes(hess_lag, S_forw)
     hess2 = []
     for j in range(nx+nu):
         for i in range(j,nx+nu):
-            hess2 = vertcat(hess2, hess[i,j])
+            hess2 = vertcat(hess2, mtimes(transpose(S_forw[:,i]), hess_S[:,j]))
 
     fun_name = model_name + '_expl_ode_hess'
     expl_ode_hess = Function(fun_name, [x, Sx, Sp, lambdaX, u, p], [adj, hess2])
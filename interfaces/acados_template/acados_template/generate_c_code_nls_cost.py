@@ -35,7 +35,7 @@ import os
 from casadi import *
 from .utils import ALLOWED_CASADI_VERSIONS
 
-def generate_c_code_nls_cost( model, cost_name, is_terminal ):
+def generate_c_code_nls_cost( model, cost_name, is_terminal, num_nodes = 0 ):
 
     casadi_version = CasadiMeta.version()
     casadi_opts = dict(mex=False, casadi_int='int', casadi_real='double')
@@ -82,6 +82,11 @@ def generate_c_code_nls_cost( model, cost_name, is_terminal ):
 
     nls_cost_fun.generate( file_name, casadi_opts )
 
+    # map over the shooting nodes, evaluated at once by external_function_casadi_batch
+    if num_nodes > 0:
+        nls_cost_map = nls_cost_fun.map( fun_name + '_map', 'serial', num_nodes, [], [] )
+        nls_cost_map.generate( file_name + '_map', casadi_opts )
+
     os.chdir('../..')
     return
 
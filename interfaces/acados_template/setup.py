@@ -57,6 +57,8 @@ setup(name='acados_template',
    ],
    package_data={'': [
        'c_templates_tera/main.in.c',
+       'c_templates_tera/memory_size.in.c',
+       'c_templates_tera/no_malloc_test.in.c',
        'c_templates_tera/Makefile.in',
        'c_templates_tera/model.in.h',
        'c_templates_tera/main.in.h',
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// hand-written model in the format of casadi generated code, built into the shared libraries loaded
+// by test_ext_fun_load.cpp; LOAD_MODEL_GAIN selects the model of each library
+//
+// load_model_upper: x[2] -> (M x, M), M = [g 1; 0 g] with upper triangular sparsity
+// load_model_lower: x[2] -> (M' x, M'), same dimensions and work, lower triangular sparsity
+// load_model_dim3:  x[3] -> (g x, g I), different dimensions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LOAD_MODEL_GAIN
+#define LOAD_MODEL_GAIN 1.0
+#endif
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(__CYGWIN__)
+#define LOAD_MODEL_EXPORT __declspec(dllexport)
+#else
+#define LOAD_MODEL_EXPORT
+#endif
+
+// sparsity patterns: nrow, ncol, column pointers, row indices
+static const int load_model_s_x2[] = {2, 1, 0, 2, 0, 1};
+static const int load_model_s_upper[] = {2, 2, 0, 1, 3, 0, 0, 1};
+static const int load_model_s_lower[] = {2, 2, 0, 2, 3, 0, 1, 1};
+static const int load_model_s_x3[] = {3, 1, 0, 3, 0, 1, 2};
+static const int load_model_s_diag3[] = {3, 3, 0, 1, 2, 3, 0, 1, 2};
+
+
+
+static int load_model_work_2(int *sz_arg, int *sz_res, int *sz_iw, int *sz_w)
+{
+    if (sz_arg) *sz_arg = 1;
+    if (sz_res) *sz_res = 2;
+    if (sz_iw) *sz_iw = 0;
+    if (sz_w) *sz_w = 0;
+    return 0;
+}
+
+
+
+/* load_model_upper */
+
+LOAD_MODEL_EXPORT int load_model_upper(const double **arg, double **res, int *iw, double *w, void *mem)
+{
+    double x0 = arg[0] ? arg[0][0] : 0;
+    double x1 = arg[0] ? arg[0][1] : 0;
+    if (res[0] != 0)
+    {
+        res[0][0] = LOAD_MODEL_GAIN * x0 + x1;
+        res[0][1] = LOAD_MODEL_GAIN * x1;
+    }
+    // nonzeros column by column: M(0,0), M(0,1), M(1,1)
+    if (res[1] != 0)
+    {
+        res[1][0] = LOAD_MODEL_GAIN;
+        res[1][1] = 1.0;
+        res[1][2] = LOAD_MODEL_GAIN;
+    }
+    return 0;
+}
+
+LOAD_MODEL_EXPORT int load_model_upper_n_in(void) { return 1; }
+
+LOAD_MODEL_EXPORT int load_model_upper_n_out(void) { return 2; }
+
+LOAD_MODEL_EXPORT const int *load_model_upper_sparsity_in(int i)
+{
+    return i == 0 ? load_model_s_x2 : 0;
+}
+
+LOAD_MODEL_EXPORT const int *load_model_upper_sparsity_out(int i)
+{
+    return i == 0 ? load_model_s_x2 : i == 1 ? load_model_s_upper : 0;
+}
+
+LOAD_MODEL_EXPORT int load_model_upper_work(int *sz_arg, int *sz_res, int *sz_iw, int *sz_w)
+{
+    return load_model_work_2(sz_arg, sz_res, sz_iw, sz_w);
+}
+
+
+
+/* load_model_lower */
+
+LOAD_MODEL_EXPORT int load_model_lower(const double **arg, double **res, int *iw, double *w, void *mem)
+{
+    double x0 = arg[0] ? arg[0][0] : 0;
+    double x1 = arg[0] ? arg[0][1] : 0;
+    if (res[0] != 0)
+    {
+        res[0][0] = LOAD_MODEL_GAIN * x0;
+        res[0][1] = x0 + LOAD_MODEL_GAIN * x1;
+    }
+    // nonzeros column by column: M'(0,0), M'(1,0), M'(1,1)
+    if (res[1] != 0)
+    {
+        res[1][0] = LOAD_MODEL_GAIN;
+        res[1][1] = 1.0;
+        res[1][2] = LOAD_MODEL_GAIN;
+    }
+    return 0;
+}
+
+LOAD_MODEL_EXPORT int load_model_lower_n_in(void) { return 1; }
+
+LOAD_MODEL_EXPORT int load_model_lower_n_out(void) { return 2; }
+
+LOAD_MODEL_EXPORT const int *load_model_lower_sparsity_in(int i)
+{
+    return i == 0 ? load_model_s_x2 : 0;
+}
+
+LOAD_MODEL_EXPORT const int *load_model_lower_sparsity_out(int i)
+{
+    return i == 0 ? load_model_s_x2 : i == 1 ? load_model_s_lower : 0;
+}
+
+LOAD_MODEL_EXPORT int load_model_lower_work(int *sz_arg, int *sz_res, int *sz_iw, int *sz_w)
+{
+    return load_model_work_2(sz_arg, sz_res, sz_iw, sz_w);
+}
+
+
+
+/* load_model_dim3 */
+
+LOAD_MODEL_EXPORT int load_model_dim3(const double **arg, double **res, int *iw, double *w, void *mem)
+{
+    for (int ii = 0; ii < 3; ii++)
+    {
+        if (res[0] != 0)
+            res[0][ii] = LOAD_MODEL_GAIN * (arg[0] ? arg[0][ii] : 0);
+        if (res[1] != 0)
+            res[1][ii] = LOAD_MODEL_GAIN;
+    }
+    return 0;
+}
+
+LOAD_MODEL_EXPORT int load_model_dim3_n_in(void) { return 1; }
+
+LOAD_MODEL_EXPORT int load_model_dim3_n_out(void) { return 2; }
+
+LOAD_MODEL_EXPORT const int *load_model_dim3_sparsity_in(int i)
+{
+    return i == 0 ? load_model_s_x3 : 0;
+}
+
+LOAD_MODEL_EXPORT const int *load_model_dim3_sparsity_out(int i)
+{
+    return i == 0 ? load_model_s_x3 : i == 1 ? load_model_s_diag3 : 0;
+}
+
+LOAD_MODEL_EXPORT int load_model_dim3_work(int *sz_arg, int *sz_res, int *sz_iw, int *sz_w)
+{
+    return load_model_work_2(sz_arg, sz_res, sz_iw, sz_w);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// batched evaluation of external functions over nodes against the point-wise evaluation
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "catch/include/catch.hpp"
+
+// acados
+#include "acados/utils/external_function_generic.h"
+
+#include "acados_c/external_function_interface.h"
+
+// wind turbine model
+#include "examples/c/wt_model_nx6/nx6p2/wt_model.h"
+
+#define BATCH_NODES 5
+#define WT_NX 8
+#define WT_NU 2
+#define WT_NP 1
+
+
+
+// map of wt_nx6p2_impl_ode_fun_jac_x_xdot_u over BATCH_NODES points, in the layout of the code
+// generated by casadi from f.map(BATCH_NODES): the nonzeros of the arguments of node k follow the
+// ones of node k-1
+static int map_calls = 0;
+
+static int wt_impl_ode_map(const double **arg, double **res, int *iw, double *w, void *mem)
+{
+    const double *arg_k[12];
+    double *res_k[9];
+    int ii, kk;
+
+    int n_in = wt_nx6p2_impl_ode_fun_jac_x_xdot_u_n_in();
+    int n_out = wt_nx6p2_impl_ode_fun_jac_x_xdot_u_n_out();
+
+    map_calls++;
+
+    for (kk = 0; kk < BATCH_NODES; kk++)
+    {
+        for (ii = 0; ii < n_in; ii++)
+        {
+            const int *sp = wt_nx6p2_impl_ode_fun_jac_x_xdot_u_sparsity_in(ii);
+            arg_k[ii] = arg[ii] + kk * sp[2 + sp[1]];
+        }
+        for (ii = 0; ii < n_out; ii++)
+        {
+            const int *sp = wt_nx6p2_impl_ode_fun_jac_x_xdot_u_sparsity_out(ii);
+            res_k[ii] = res[ii] + kk * sp[2 + sp[1]];
+        }
+        wt_nx6p2_impl_ode_fun_jac_x_xdot_u(arg_k, res_k, iw, w, mem);
+    }
+
+    return 0;
+}
+
+
+
+static int wt_impl_ode_map_work(int *sz_arg, int *sz_res, int *sz_iw, int *sz_w)
+{
+    return wt_nx6p2_impl_ode_fun_jac_x_xdot_u_work(sz_arg, sz_res, sz_iw, sz_w);
+}
+
+
+
+TEST_CASE("external function batch vs single", "[external_function]")
+{
+    // point-wise reference
+    external_function_param_casadi single;
+    single.casadi_fun = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u;
+    single.casadi_work = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_work;
+    single.casadi_sparsity_in = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_sparsity_in;
+    single.casadi_sparsity_out = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_sparsity_out;
+    single.casadi_n_in = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_n_in;
+    single.casadi_n_out = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_n_out;
+    external_function_param_casadi_create(&single, WT_NP);
+
+    // batch over the nodes
+    external_function_casadi_batch batch;
+    external_function_casadi_batch_node nodes[BATCH_NODES];
+    batch.casadi_fun = &wt_impl_ode_map;
+    batch.casadi_work = &wt_impl_ode_map_work;
+    batch.casadi_fun_single = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u;
+    batch.casadi_work_single = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_work;
+    batch.casadi_sparsity_in = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_sparsity_in;
+    batch.casadi_sparsity_out = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_sparsity_out;
+    batch.casadi_n_in = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_n_in;
+    batch.casadi_n_out = &wt_nx6p2_impl_ode_fun_jac_x_xdot_u_n_out;
+    external_function_casadi_batch_create(&batch, BATCH_NODES, WT_NP, nodes);
+
+    // inputs of the nodes (persistent, as the nlp memory)
+    double x[BATCH_NODES][WT_NX], xdot[BATCH_NODES][WT_NX], u[BATCH_NODES][WT_NU];
+    double p[BATCH_NODES][WT_NP];
+
+    srand(1);
+    for (int kk = 0; kk < BATCH_NODES; kk++)
+    {
+        for (int ii = 0; ii < WT_NX; ii++)
+        {
+            x[kk][ii] = 1.0 + rand() / (double) RAND_MAX;
+            xdot[kk][ii] = rand() / (double) RAND_MAX - 0.5;
+        }
+        for (int ii = 0; ii < WT_NU; ii++)
+            u[kk][ii] = 1.0 + rand() / (double) RAND_MAX;
+        p[kk][0] = 10.0 + kk;
+        nodes[kk].set_param(nodes + kk, p[kk]);
+    }
+
+    ext_fun_arg_t type_in[3] = {COLMAJ, COLMAJ, COLMAJ};
+    ext_fun_arg_t type_out[4] = {COLMAJ, COLMAJ, COLMAJ, COLMAJ};
+
+    // evaluates all the nodes with the batch and checks them against the point-wise evaluation
+    auto check_nodes = [&]()
+    {
+        double fun[2][WT_NX], jac_x[2][WT_NX*WT_NX], jac_xdot[2][WT_NX*WT_NX];
+        double jac_u[2][WT_NX*WT_NU];
+        for (int kk = 0; kk < BATCH_NODES; kk++)
+        {
+            void *in[3] = {x[kk], xdot[kk], u[kk]};
+            for (int jj = 0; jj < 2; jj++)
+            {
+                // structural zeros are not written
+                for (int ii = 0; ii < WT_NX*WT_NX; ii++)
+                {
+                    jac_x[jj][ii] = 0.0;
+                    jac_xdot[jj][ii] = 0.0;
+                }
+                for (int ii = 0; ii < WT_NX*WT_NU; ii++)
+                    jac_u[jj][ii] = 0.0;
+                void *out[4] = {fun[jj], jac_x[jj], jac_xdot[jj], jac_u[jj]};
+                if (jj == 0)
+                {
+                    single.set_param(&single, p[kk]);
+                    single.evaluate(&single, type_in, in, type_out, out);
+                }
+                else
+                {
+                    nodes[kk].evaluate(nodes + kk, type_in, in, type_out, out);
+                }
+            }
+            for (int ii = 0; ii < WT_NX; ii++)
+                REQUIRE(fun[0][ii] == fun[1][ii]);
+            for (int ii = 0; ii < WT_NX*WT_NX; ii++)
+            {
+                REQUIRE(jac_x[0][ii] == jac_x[1][ii]);
+                REQUIRE(jac_xdot[0][ii] == jac_xdot[1][ii]);
+            }
+            for (int ii = 0; ii < WT_NX*WT_NU; ii++)
+                REQUIRE(jac_u[0][ii] == jac_u[1][ii]);
+        }
+    };
+
+    // first sweep: the inputs are recorded, the nodes are evaluated point-wise
+    map_calls = 0;
+    check_nodes();
+    REQUIRE(map_calls == 0);
+
+    // new inputs, evaluated with one call of the map before the sweep
+    for (int kk = 0; kk < BATCH_NODES; kk++)
+        x[kk][0] += 0.1;
+    external_function_casadi_batch_evaluate(&batch);
+    REQUIRE(map_calls == 1);
+    REQUIRE(batch.num_refresh == 1);
+    check_nodes();
+    REQUIRE(map_calls == 1);
+
+    // inputs changed after the evaluation of the map, and new parameters: the affected nodes are
+    // evaluated point-wise, never from stale results
+    u[2][1] += 0.2;
+    p[3][0] += 1.0;
+    nodes[3].set_param(nodes + 3, p[3]);
+    check_nodes();
+    REQUIRE(map_calls == 1);
+
+    // all the nodes evaluated by the map again
+    external_function_casadi_batch_evaluate(&batch);
+    REQUIRE(map_calls == 2);
+    check_nodes();
+
+    external_function_casadi_batch_free(&batch);
+    external_function_param_casadi_free(&single);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// runtime loading of generated model libraries and swap of the loaded functions
+
+#include <stdlib.h>
+
+#include "catch/include/catch.hpp"
+
+// acados
+#include "acados/utils/external_function_generic.h"
+
+#include "acados_c/external_function_interface.h"
+
+// paths of the shared libraries built from ext_fun_load_model.c with the gains 1 and 2, set by cmake
+#ifndef EXT_FUN_LOAD_MODEL_A
+#define EXT_FUN_LOAD_MODEL_A "libext_fun_load_model_a.so"
+#endif
+#ifndef EXT_FUN_LOAD_MODEL_B
+#define EXT_FUN_LOAD_MODEL_B "libext_fun_load_model_b.so"
+#endif
+
+
+
+// evaluates load_model_upper at x = [1; 2] and checks the result for the gain g:
+// M x = [g + 2; 2 g], M = [g 1; 0 g]
+static void check_load_model_upper(external_function_casadi *fun, double g)
+{
+    double x[2] = {1.0, 2.0};
+    double y[2] = {0.0, 0.0};
+    double M[4] = {-1.0, -1.0, -1.0, -1.0};
+
+    ext_fun_arg_t type_in[1] = {COLMAJ};
+    void *in[1] = {x};
+    ext_fun_arg_t type_out[2] = {COLMAJ, COLMAJ};
+    void *out[2] = {y, M};
+
+    fun->evaluate(fun, type_in, in, type_out, out);
+
+    REQUIRE(y[0] == g + 2.0);
+    REQUIRE(y[1] == 2.0 * g);
+    // column-major, the structural zero is written as well
+    REQUIRE(M[0] == g);
+    REQUIRE(M[1] == 0.0);
+    REQUIRE(M[2] == 1.0);
+    REQUIRE(M[3] == g);
+}
+
+
+
+TEST_CASE("external function load and swap", "[external_function]")
+{
+    // two libraries with the same symbols: different handles
+    void *lib_a = external_function_library_open(EXT_FUN_LOAD_MODEL_A);
+    void *lib_b = external_function_library_open(EXT_FUN_LOAD_MODEL_B);
+    REQUIRE(lib_a != NULL);
+    REQUIRE(lib_b != NULL);
+    REQUIRE(lib_a != lib_b);
+
+    // missing symbols
+    external_function_casadi missing;
+    REQUIRE(external_function_casadi_load(&missing, lib_a, "load_model_missing") != 0);
+    REQUIRE(external_function_casadi_load(&missing, NULL, "load_model_upper") != 0);
+
+    external_function_casadi fun;
+    REQUIRE(external_function_casadi_load(&fun, lib_a, "load_model_upper") == 0);
+    external_function_casadi_create(&fun);
+    check_load_model_upper(&fun, 1.0);
+
+    int (*casadi_fun)(const double **, double **, int *, double *, void *) = fun.casadi_fun;
+    const int *(*casadi_sparsity_in)(int) = fun.casadi_sparsity_in;
+    const int *(*casadi_sparsity_out)(int) = fun.casadi_sparsity_out;
+    int in_num = fun.in_num;
+    int out_num = fun.out_num;
+
+    // same inputs, outputs and work, but different sparsity of the jacobian: rejected by the
+    // sparsity check, the function is unchanged
+    REQUIRE(external_function_casadi_swap(&fun, lib_a, "load_model_lower") != 0);
+    REQUIRE(fun.casadi_fun == casadi_fun);
+    REQUIRE(fun.casadi_sparsity_in == casadi_sparsity_in);
+    REQUIRE(fun.casadi_sparsity_out == casadi_sparsity_out);
+    REQUIRE(fun.in_num == in_num);
+    REQUIRE(fun.out_num == out_num);
+    check_load_model_upper(&fun, 1.0);
+
+    // different dimensions: rejected
+    REQUIRE(external_function_casadi_swap(&fun, lib_b, "load_model_dim3") != 0);
+    REQUIRE(fun.casadi_fun == casadi_fun);
+
+    // missing function: rejected
+    REQUIRE(external_function_casadi_swap(&fun, lib_b, "load_model_missing") != 0);
+    REQUIRE(fun.casadi_fun == casadi_fun);
+    check_load_model_upper(&fun, 1.0);
+
+    // same function of the other library: accepted, evaluates the new model
+    REQUIRE(external_function_casadi_swap(&fun, lib_b, "load_model_upper") == 0);
+    REQUIRE(fun.casadi_fun != casadi_fun);
+    check_load_model_upper(&fun, 2.0);
+
+    // the old library can be closed once nothing refers to it
+    external_function_library_close(lib_a);
+    check_load_model_upper(&fun, 2.0);
+
+    // the other way around: loaded lower, swap to upper rejected by the sparsity check
+    external_function_casadi fun_lower;
+    REQUIRE(external_function_casadi_load(&fun_lower, lib_b, "load_model_lower") == 0);
+    external_function_casadi_create(&fun_lower);
+    casadi_fun = fun_lower.casadi_fun;
+    REQUIRE(external_function_casadi_swap(&fun_lower, lib_b, "load_model_upper") != 0);
+    REQUIRE(fun_lower.casadi_fun == casadi_fun);
+
+    external_function_casadi_free(&fun);
+    external_function_casadi_free(&fun_lower);
+    external_function_library_close(lib_b);
+}
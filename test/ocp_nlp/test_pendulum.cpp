@@ -0,0 +1,1217 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// small pendulum on cart ocp (ERK, linear least squares, input bounds) to test the features of the
+// ocp_nlp solvers and of the ocp_nlp interface
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "catch/include/catch.hpp"
+
+// std
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+
+// acados
+#include "acados_c/external_function_interface.h"
+#include "acados_c/ocp_nlp_interface.h"
+#include "acados/ocp_nlp/ocp_nlp_sqp.h"
+#include "acados/ocp_nlp/ocp_nlp_sqp_rti.h"
+#include "acados/ocp_qp/ocp_qp_xcond_solver.h"
+
+// pendulum_model
+#include "examples/c/pendulum_model/pendulum_model.h"
+
+#define PENDULUM_N 20
+
+
+
+// nonlinear input constraint h(x, u) = u^2 * (1 + theta^2), external function with the inputs and
+// outputs of the nl_constr_h_fun(_jac) of the BGH constraints; theta is x[1]
+typedef struct
+{
+    void (*evaluate)(void *, ext_fun_arg_t *, void **, ext_fun_arg_t *, void **);
+    bool jac;  // also evaluate the transposed jacobian w.r.t. [u; x]
+} pendulum_constr_h;
+
+
+
+static void pendulum_constr_h_evaluate(void *self_, ext_fun_arg_t *type_in, void **in,
+                                       ext_fun_arg_t *type_out, void **out)
+{
+    pendulum_constr_h *self = (pendulum_constr_h *) self_;
+
+    struct blasfeo_dvec_args *x_in = (struct blasfeo_dvec_args *) in[0];
+    struct blasfeo_dvec_args *u_in = (struct blasfeo_dvec_args *) in[1];
+    double theta = blasfeo_dvecex1(x_in->x, x_in->xi+1);
+    double u = blasfeo_dvecex1(u_in->x, u_in->xi);
+
+    struct blasfeo_dvec_args *fun_out = (struct blasfeo_dvec_args *) out[0];
+    blasfeo_dvecin1(u*u*(1.0 + theta*theta), fun_out->x, fun_out->xi);
+
+    if (self->jac)
+    {
+        // rows [u; x] of the column of h, no algebraic variables
+        struct blasfeo_dmat_args *jac_out = (struct blasfeo_dmat_args *) out[1];
+        for (int ii = 0; ii < 5; ii++)
+            blasfeo_dgein1(0.0, jac_out->A, jac_out->ai+ii, jac_out->aj);
+        blasfeo_dgein1(2.0*u*(1.0 + theta*theta), jac_out->A, jac_out->ai, jac_out->aj);
+        blasfeo_dgein1(2.0*u*u*theta, jac_out->A, jac_out->ai+1+1, jac_out->aj);
+    }
+}
+
+
+
+typedef struct
+{
+    int N;
+    int nx;
+    int nu;
+    ocp_nlp_plan *plan;
+    ocp_nlp_config *config;
+    ocp_nlp_dims *dims;
+    ocp_nlp_in *nlp_in;
+    ocp_nlp_out *nlp_out;
+    void *nlp_opts;
+    ocp_nlp_solver *solver;
+    external_function_casadi expl_vde_for;
+    pendulum_constr_h constr_h_fun;
+    pendulum_constr_h constr_h_fun_jac;
+} pendulum_ocp;
+
+
+
+// creates plan, config, dims, nlp_in, nlp_out and opts of the pendulum ocp, the solver is created
+// by pendulum_ocp_solver_create after the options are set; with_nh adds the nonlinear input
+// constraint u^2 * (1 + theta^2) <= uh_max^2 at the stages < N
+static void pendulum_ocp_create(pendulum_ocp *ocp, ocp_nlp_solver_t nlp_solver,
+                                ocp_qp_solver_t qp_solver,
+                                ocp_nlp_reg_t regularization = NO_REGULARIZE,
+                                bool with_nh = false, double uh_max = 0.0)
+{
+    int N = PENDULUM_N;
+    int nx_ = 4;
+    int nu_ = 1;
+    int ny_ = nx_ + nu_;
+
+    ocp->N = N;
+    ocp->nx = nx_;
+    ocp->nu = nu_;
+
+    int nx[PENDULUM_N+1], nu[PENDULUM_N+1], nz[PENDULUM_N+1], ns[PENDULUM_N+1];
+    int ny[PENDULUM_N+1], nbx[PENDULUM_N+1], nbu[PENDULUM_N+1], np[PENDULUM_N+1];
+    int nh[PENDULUM_N+1];
+    int zero = 0;
+
+    for (int i = 0; i <= N; i++)
+    {
+        nx[i] = nx_;
+        nu[i] = i < N ? nu_ : 0;
+        nz[i] = 0;
+        ns[i] = 0;
+        ny[i] = i < N ? ny_ : nx_;
+        nbx[i] = i == 0 ? nx_ : 0;
+        nbu[i] = i < N ? nu_ : 0;
+        nh[i] = with_nh && i < N ? 1 : 0;
+        // parameters not used by the model, to test their handling in the interface
+        np[i] = 2;
+    }
+
+    /* plan + config */
+
+    ocp->plan = ocp_nlp_plan_create(N);
+    ocp->plan->nlp_solver = nlp_solver;
+    ocp->plan->ocp_qp_solver_plan.qp_solver = qp_solver;
+    ocp->plan->regularization = regularization;
+
+    for (int i = 0; i <= N; i++)
+    {
+        ocp->plan->nlp_cost[i] = LINEAR_LS;
+        ocp->plan->nlp_constraints[i] = BGH;
+    }
+    for (int i = 0; i < N; i++)
+    {
+        ocp->plan->nlp_dynamics[i] = CONTINUOUS_MODEL;
+        ocp->plan->sim_solver_plan[i].sim_solver = ERK;
+    }
+
+    ocp->config = ocp_nlp_config_create(*ocp->plan);
+    ocp_nlp_config *config = ocp->config;
+
+    /* dims */
+
+    ocp->dims = ocp_nlp_dims_create(config);
+    ocp_nlp_dims *dims = ocp->dims;
+
+    ocp_nlp_dims_set_opt_vars(config, dims, "nx", nx);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nu", nu);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nz", nz);
+    ocp_nlp_dims_set_opt_vars(config, dims, "ns", ns);
+    ocp_nlp_dims_set_opt_vars(config, dims, "np", np);
+
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_dims_set_cost(config, dims, i, "ny", &ny[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nbx", &nbx[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nbu", &nbu[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "ng", &zero);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nh", &nh[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nsh", &zero);
+    }
+
+    /* dynamics */
+
+    ocp->expl_vde_for.casadi_fun = &pendulum_ode_expl_vde_forw;
+    ocp->expl_vde_for.casadi_work = &pendulum_ode_expl_vde_forw_work;
+    ocp->expl_vde_for.casadi_sparsity_in = &pendulum_ode_expl_vde_forw_sparsity_in;
+    ocp->expl_vde_for.casadi_sparsity_out = &pendulum_ode_expl_vde_forw_sparsity_out;
+    ocp->expl_vde_for.casadi_n_in = &pendulum_ode_expl_vde_forw_n_in;
+    ocp->expl_vde_for.casadi_n_out = &pendulum_ode_expl_vde_forw_n_out;
+    external_function_casadi_create(&ocp->expl_vde_for);
+
+    /* nlp_in */
+
+    ocp->nlp_in = ocp_nlp_in_create(config, dims);
+    ocp_nlp_in *nlp_in = ocp->nlp_in;
+
+    double Ts = 0.05;
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_in_set(config, dims, nlp_in, i, "Ts", &Ts);
+        REQUIRE(ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "expl_vde_for",
+                                           &ocp->expl_vde_for) == 0);
+    }
+
+    // cost: y = [x; u], W = diag(1e3, 1e3, 1e-2, 1e-2, 1e-2)
+    double Vx[5*4] = {0};
+    double Vu[5*1] = {0};
+    double W[5*5] = {0};
+    double yref[5] = {0};
+    for (int ii = 0; ii < nx_; ii++)
+        Vx[ii+ny_*ii] = 1.0;
+    Vu[nx_] = 1.0;
+    W[0+ny_*0] = 1e3;
+    W[1+ny_*1] = 1e3;
+    W[2+ny_*2] = 1e-2;
+    W[3+ny_*3] = 1e-2;
+    W[4+ny_*4] = 1e-2;
+
+    double VxN[4*4] = {0};
+    double WN[4*4] = {0};
+    for (int ii = 0; ii < nx_; ii++)
+    {
+        VxN[ii+nx_*ii] = 1.0;
+        WN[ii+nx_*ii] = W[ii+ny_*ii];
+    }
+
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "Vx", Vx);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "Vu", Vu);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "W", W);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "yref", yref);
+    }
+    ocp_nlp_cost_model_set(config, dims, nlp_in, N, "Vx", VxN);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, N, "W", WN);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, N, "yref", yref);
+
+    // constraints: initial state, input bounds
+    int idxbx0[4] = {0, 1, 2, 3};
+    double x0[4] = {0.0, 0.3, 0.0, 0.0};
+    int idxbu[1] = {0};
+    double lbu[1] = {-80.0};
+    double ubu[1] = {80.0};
+
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbx", x0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubx", x0);
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "idxbu", idxbu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "lbu", lbu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "ubu", ubu);
+    }
+
+    // nonlinear constraints: the lower bound is never active
+    ocp->constr_h_fun.evaluate = &pendulum_constr_h_evaluate;
+    ocp->constr_h_fun.jac = false;
+    ocp->constr_h_fun_jac.evaluate = &pendulum_constr_h_evaluate;
+    ocp->constr_h_fun_jac.jac = true;
+    double lh[1] = {-1.0};
+    double uh[1] = {uh_max*uh_max};
+    for (int i = 0; i < N; i++)
+    {
+        if (nh[i] == 0)
+            continue;
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "nl_constr_h_fun", &ocp->constr_h_fun);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "nl_constr_h_fun_jac",
+                                      &ocp->constr_h_fun_jac);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "lh", lh);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "uh", uh);
+    }
+
+    /* nlp_out */
+
+    ocp->nlp_out = ocp_nlp_out_create(config, dims);
+
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_out_set(config, dims, ocp->nlp_out, i, "x", x0);
+
+    /* opts */
+
+    ocp->nlp_opts = ocp_nlp_solver_opts_create(config, dims);
+
+    int num_steps = 2;
+    int ns_erk = 4;
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_solver_opts_set_at_stage(config, ocp->nlp_opts, i, "dynamics_num_steps", &num_steps);
+        ocp_nlp_solver_opts_set_at_stage(config, ocp->nlp_opts, i, "dynamics_ns", &ns_erk);
+    }
+
+    ocp->solver = NULL;
+}
+
+
+
+static void pendulum_ocp_solver_create(pendulum_ocp *ocp)
+{
+    ocp_nlp_solver_opts_update(ocp->config, ocp->dims, ocp->nlp_opts);
+    ocp->solver = ocp_nlp_solver_create(ocp->config, ocp->dims, ocp->nlp_opts);
+    REQUIRE(ocp_nlp_precompute(ocp->solver, ocp->nlp_in, ocp->nlp_out) == 0);
+}
+
+
+
+static void pendulum_ocp_set_x0(pendulum_ocp *ocp, double *x0)
+{
+    ocp_nlp_constraints_model_set(ocp->config, ocp->dims, ocp->nlp_in, 0, "lbx", x0);
+    ocp_nlp_constraints_model_set(ocp->config, ocp->dims, ocp->nlp_in, 0, "ubx", x0);
+}
+
+
+
+static void pendulum_ocp_free(pendulum_ocp *ocp)
+{
+    if (ocp->solver != NULL)
+        ocp_nlp_solver_destroy(ocp->solver);
+    ocp_nlp_solver_opts_destroy(ocp->nlp_opts);
+    ocp_nlp_out_destroy(ocp->nlp_out);
+    ocp_nlp_in_destroy(ocp->nlp_in);
+    ocp_nlp_dims_destroy(ocp->dims);
+    ocp_nlp_config_destroy(ocp->config);
+    ocp_nlp_plan_destroy(ocp->plan);
+    external_function_casadi_free(&ocp->expl_vde_for);
+}
+
+
+
+// sets the maximum number of iterations and the same tolerance on all the residuals
+static void pendulum_ocp_set_tol(pendulum_ocp *ocp, int max_iter, double tol)
+{
+    ocp_nlp_solver_opts_set(ocp->config, ocp->nlp_opts, "max_iter", &max_iter);
+    ocp_nlp_solver_opts_set(ocp->config, ocp->nlp_opts, "tol_stat", &tol);
+    ocp_nlp_solver_opts_set(ocp->config, ocp->nlp_opts, "tol_eq", &tol);
+    ocp_nlp_solver_opts_set(ocp->config, ocp->nlp_opts, "tol_ineq", &tol);
+    ocp_nlp_solver_opts_set(ocp->config, ocp->nlp_opts, "tol_comp", &tol);
+}
+
+
+
+// largest stage-wise difference of x, u and, if with_pi, pi between two iterates of the same ocp
+static double ocp_nlp_out_diff(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_out *out0,
+                               ocp_nlp_out *out1, bool with_pi = false)
+{
+    const char *fields[3] = {"x", "u", "pi"};
+    int num_fields = with_pi ? 3 : 2;
+
+    int N = dims->N;
+    double err = 0.0;
+
+    for (int k = 0; k < num_fields; k++)
+    {
+        for (int i = 0; i <= N; i++)
+        {
+            int len = k == 0 ? dims->nx[i] : k == 1 ? dims->nu[i] : (i < N ? dims->nx[i+1] : 0);
+            if (len == 0)
+                continue;
+
+            std::vector<double> val0(len), val1(len);
+            ocp_nlp_out_get(config, dims, out0, i, fields[k], val0.data());
+            ocp_nlp_out_get(config, dims, out1, i, fields[k], val1.data());
+            for (int j = 0; j < len; j++)
+                err = fmax(err, fabs(val0[j] - val1[j]));
+        }
+    }
+
+    return err;
+}
+
+
+
+/************************************************
+* TEST CASE: advanced step
+************************************************/
+
+TEST_CASE("pendulum advanced step", "[NLP solver]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create(&ocp, SQP_RTI, PARTIAL_CONDENSING_HPIPM);
+
+    int as_cache_size = 3;
+    ocp_nlp_solver_opts_set(ocp.config, ocp.nlp_opts, "qp_as_cache_size", &as_cache_size);
+
+    pendulum_ocp_solver_create(&ocp);
+
+    // the option can be set after the solver memory has been created
+    int advanced_step = 1;
+    ocp_nlp_solver_opts_set(ocp.config, ocp.solver->opts, "advanced_step", &advanced_step);
+
+    // converge at the predicted initial state with full rti steps
+    double x0_pred[4] = {0.0, 0.3, 0.0, 0.0};
+    int rti_phase = 0;
+    ocp_nlp_solver_opts_set(ocp.config, ocp.solver->opts, "rti_phase", &rti_phase);
+    for (int ii = 0; ii < 10; ii++)
+        REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    // preparation at the predicted initial state
+    rti_phase = 1;
+    ocp_nlp_solver_opts_set(ocp.config, ocp.solver->opts, "rti_phase", &rti_phase);
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    // the active set cache size is restored after the preparation
+    ocp_nlp_sqp_rti_opts *rti_opts = (ocp_nlp_sqp_rti_opts *) ocp.solver->opts;
+    ocp_qp_xcond_solver_opts *qp_opts = (ocp_qp_xcond_solver_opts *) rti_opts->nlp_opts->qp_solver_opts;
+    REQUIRE(qp_opts->as_cache_opts->size == as_cache_size);
+
+    // advanced step at the measured initial state
+    double x0[4] = {0.01, 0.305, -0.01, 0.02};
+    double u0_as[1];
+    REQUIRE(ocp_nlp_advanced_step(ocp.solver, x0, u0_as) == 0);
+
+    // feedback phase: full qp at the measured initial state, same linearization point
+    pendulum_ocp_set_x0(&ocp, x0);
+    rti_phase = 2;
+    ocp_nlp_solver_opts_set(ocp.config, ocp.solver->opts, "rti_phase", &rti_phase);
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    double u0_rti[1];
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, 0, "u", u0_rti);
+
+    // the qp is linear in the initial state: no active set change, the same control
+    REQUIRE(fabs(u0_as[0] - u0_rti[0]) <= 1e-5 * (1.0 + fabs(u0_rti[0])));
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+
+/************************************************
+* TEST CASE: parameter update
+************************************************/
+
+TEST_CASE("pendulum parameter update", "[NLP solver]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create(&ocp, SQP, PARTIAL_CONDENSING_HPIPM);
+    pendulum_ocp_solver_create(&ocp);
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    // the parameters of the external functions are not seen by the nlp: setting them has to
+    // mark all the models of the stage as modified, and only those
+    int stage = 3;
+    int dynamics_version = ocp.nlp_in->dynamics_version[stage];
+    int cost_version = ocp.nlp_in->cost_version[stage];
+    int constraints_version = ocp.nlp_in->constraints_version[stage];
+    int cost_version_next = ocp.nlp_in->cost_version[stage+1];
+
+    double p[2] = {1.0, 2.0};
+    ocp_nlp_in_set(ocp.config, ocp.dims, ocp.nlp_in, stage, "parameter_values", p);
+
+    REQUIRE(ocp.nlp_in->dynamics_version[stage] == dynamics_version + 1);
+    REQUIRE(ocp.nlp_in->cost_version[stage] == cost_version + 1);
+    REQUIRE(ocp.nlp_in->constraints_version[stage] == constraints_version + 1);
+    REQUIRE(ocp.nlp_in->cost_version[stage+1] == cost_version_next);
+
+    // terminal stage: no dynamics
+    int N = ocp.N;
+    cost_version = ocp.nlp_in->cost_version[N];
+    ocp_nlp_in_set(ocp.config, ocp.dims, ocp.nlp_in, N, "parameter_values", p);
+    REQUIRE(ocp.nlp_in->cost_version[N] == cost_version + 1);
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+
+/************************************************
+* TEST CASE: snapshot
+************************************************/
+
+TEST_CASE("pendulum snapshot", "[NLP solver]")
+{
+    // ocp: saved, perturbed and restored, ocp_ref: same solve, not touched
+    pendulum_ocp ocp, ocp_ref;
+    pendulum_ocp_create(&ocp, SQP, PARTIAL_CONDENSING_HPIPM);
+    pendulum_ocp_solver_create(&ocp);
+    pendulum_ocp_create(&ocp_ref, SQP, PARTIAL_CONDENSING_HPIPM);
+    pendulum_ocp_solver_create(&ocp_ref);
+
+    int N = ocp.N;
+    int nx = ocp.nx;
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+    REQUIRE(ocp_nlp_solve(ocp_ref.solver, ocp_ref.nlp_in, ocp_ref.nlp_out) == 0);
+
+    int size = ocp_nlp_snapshot_calculate_size(ocp.config, ocp.dims, ocp.nlp_in, ocp.nlp_out,
+                                               ocp.solver);
+    std::vector<double> buffer(size / sizeof(double) + 1);
+    REQUIRE(ocp_nlp_snapshot_write(ocp.config, ocp.dims, ocp.nlp_in, ocp.nlp_out, ocp.solver,
+                                   buffer.data(), size) == 0);
+    REQUIRE(ocp_nlp_snapshot_save(ocp.config, ocp.dims, ocp.nlp_in, ocp.nlp_out, ocp.solver,
+                                  "pendulum_snapshot.bin") == 0);
+
+    // perturb iterate and references
+    double x_pert[4] = {1.0, -1.0, 2.0, -2.0};
+    double u_pert[1] = {5.0};
+    double yref_pert[5] = {1.0, 1.0, 1.0, 1.0, 1.0};
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_out_set(ocp.config, ocp.dims, ocp.nlp_out, i, "x", x_pert);
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_out_set(ocp.config, ocp.dims, ocp.nlp_out, i, "u", u_pert);
+        ocp_nlp_cost_model_set(ocp.config, ocp.dims, ocp.nlp_in, i, "yref", yref_pert);
+    }
+
+    // a corrupted snapshot is rejected as a whole and leaves the solver untouched, also if the
+    // mismatch (here the number of sections, checked last) is only detected after all sections
+    std::vector<double> corrupted(buffer);
+    ((int *) corrupted.data())[sizeof(double) / sizeof(int) + 3] = -1;  // num_sec of the header
+    REQUIRE(ocp_nlp_snapshot_restore(ocp.config, ocp.dims, ocp.nlp_in, ocp.nlp_out, ocp.solver,
+                                     corrupted.data(), size) != 0);
+
+    std::vector<double> bad_magic(buffer);
+    ((char *) bad_magic.data())[7] = 'X';  // magic is compared over its full length
+    REQUIRE(ocp_nlp_snapshot_restore(ocp.config, ocp.dims, ocp.nlp_in, ocp.nlp_out, ocp.solver,
+                                     bad_magic.data(), size) != 0);
+
+    double x_tmp[4];
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N, "x", x_tmp);
+    for (int j = 0; j < nx; j++)
+        REQUIRE(x_tmp[j] == x_pert[j]);
+
+    // restore from file: exactly the saved iterate
+    REQUIRE(ocp_nlp_snapshot_load(ocp.config, ocp.dims, ocp.nlp_in, ocp.nlp_out, ocp.solver,
+                                  "pendulum_snapshot.bin") == 0);
+    REQUIRE(ocp_nlp_out_diff(ocp.config, ocp.dims, ocp.nlp_out, ocp_ref.nlp_out, true) == 0.0);
+
+    // the restored references reproduce the saved solution
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    int sqp_iter;
+    ocp_nlp_get(ocp.config, ocp.solver, "sqp_iter", &sqp_iter);
+    REQUIRE(sqp_iter <= 1);
+    REQUIRE(ocp_nlp_out_diff(ocp.config, ocp.dims, ocp.nlp_out, ocp_ref.nlp_out) <= 1e-6);
+
+    remove("pendulum_snapshot.bin");
+
+    pendulum_ocp_free(&ocp);
+    pendulum_ocp_free(&ocp_ref);
+}
+
+
+
+/************************************************
+* TEST CASE: interior point nlp solver
+************************************************/
+
+TEST_CASE("pendulum ipm vs sqp", "[NLP solver]")
+{
+    pendulum_ocp ocp[2];
+    ocp_nlp_solver_t nlp_solver[2] = {SQP, IPM};
+
+    for (int k = 0; k < 2; k++)
+    {
+        pendulum_ocp_create(&ocp[k], nlp_solver[k], PARTIAL_CONDENSING_HPIPM);
+        pendulum_ocp_set_tol(&ocp[k], 100, 1e-8);
+        pendulum_ocp_solver_create(&ocp[k]);
+        REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+    }
+
+    REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out) <= 1e-4);
+
+    pendulum_ocp_free(&ocp[0]);
+    pendulum_ocp_free(&ocp[1]);
+}
+
+
+
+TEST_CASE("pendulum ipm vs sqp nonlinear constraints", "[NLP solver]")
+{
+    // |u| * sqrt(1 + theta^2) <= 10 is active at the beginning of the horizon, the input bounds
+    // of 80 are not
+    pendulum_ocp ocp[2];
+    ocp_nlp_solver_t nlp_solver[2] = {SQP, IPM};
+
+    int N = PENDULUM_N;
+    double uh_max = 10.0;
+
+    for (int k = 0; k < 2; k++)
+    {
+        pendulum_ocp_create(&ocp[k], nlp_solver[k], PARTIAL_CONDENSING_HPIPM, NO_REGULARIZE, true,
+                            uh_max);
+        pendulum_ocp_set_tol(&ocp[k], 200, 1e-8);
+        pendulum_ocp_solver_create(&ocp[k]);
+        REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+    }
+
+    // multipliers [lbu, lh, ubu, uh] (stage 0 also has the bounds on x)
+    int num_active = 0;
+    double lam[2*(4+1+1)];
+    for (int i = 0; i < N; i++)
+    {
+        int nb = i == 0 ? 5 : 1;
+        int ni = nb + 1;
+        ocp_nlp_out_get(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, i, "lam", lam);
+        if (lam[nb] > 1e-6 || lam[ni+nb] > 1e-6)
+            num_active++;
+    }
+    REQUIRE(num_active > 0);
+
+    REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out) <= 1e-4);
+
+    pendulum_ocp_free(&ocp[0]);
+    pendulum_ocp_free(&ocp[1]);
+}
+
+
+
+/************************************************
+* TEST CASE: field handles
+************************************************/
+
+TEST_CASE("pendulum field handles", "[NLP solver]")
+{
+    // ocp[0] is set with the string setters, ocp[1] with the field handles
+    pendulum_ocp ocp[2];
+    for (int k = 0; k < 2; k++)
+    {
+        pendulum_ocp_create(&ocp[k], SQP, PARTIAL_CONDENSING_HPIPM);
+        pendulum_ocp_solver_create(&ocp[k]);
+    }
+
+    int N = ocp[0].N;
+    int nx = ocp[0].nx;
+    int nu = ocp[0].nu;
+    int ny = nx + nu;
+    int np = 2;
+
+    ocp_nlp_field_handle *yref_h = ocp_nlp_cost_model_field_create(ocp[1].config, ocp[1].dims,
+                                                                   ocp[1].nlp_in, "yref");
+    ocp_nlp_field_handle *lbx_h = ocp_nlp_constraints_model_field_create(ocp[1].config,
+        ocp[1].dims, ocp[1].nlp_in, "lbx");
+    ocp_nlp_field_handle *ubx_h = ocp_nlp_constraints_model_field_create(ocp[1].config,
+        ocp[1].dims, ocp[1].nlp_in, "ubx");
+    ocp_nlp_field_handle *p_h = ocp_nlp_in_field_create(ocp[1].config, ocp[1].dims, ocp[1].nlp_in,
+                                                        "parameter_values");
+    ocp_nlp_field_handle *x_h = ocp_nlp_out_field_create(ocp[1].config, ocp[1].dims,
+                                                         ocp[1].nlp_out, "x");
+    ocp_nlp_field_handle *u_h = ocp_nlp_out_field_create(ocp[1].config, ocp[1].dims,
+                                                         ocp[1].nlp_out, "u");
+    ocp_nlp_field_handle *pi_h = ocp_nlp_out_field_create(ocp[1].config, ocp[1].dims,
+                                                          ocp[1].nlp_out, "pi");
+
+    REQUIRE(yref_h->len_tot == N*ny + nx);
+    REQUIRE(lbx_h->len_tot == nx);
+    REQUIRE(p_h->len_tot == (N+1)*np);
+    REQUIRE(x_h->len_tot == (N+1)*nx);
+    REQUIRE(u_h->len_tot == N*nu);
+    REQUIRE(pi_h->len_tot == N*nx);
+
+    // references moving along the horizon, all stages at once through the handle
+    std::vector<double> yref(N*ny + nx);
+    for (int i = 0; i < N*ny + nx; i++)
+        yref[i] = 0.1 * sin(0.3 * i);
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_cost_model_set(ocp[0].config, ocp[0].dims, ocp[0].nlp_in, i, "yref", &yref[i*ny]);
+    ocp_nlp_field_set_all(yref_h, yref.data());
+
+    // initial state at stage 0 only
+    double x0[4] = {0.05, 0.25, -0.1, 0.1};
+    pendulum_ocp_set_x0(&ocp[0], x0);
+    ocp_nlp_field_set(lbx_h, 0, x0);
+    ocp_nlp_field_set(ubx_h, 0, x0);
+
+    // parameters, same modification counters as ocp_nlp_in_set
+    std::vector<double> p((N+1)*np);
+    for (int i = 0; i < (N+1)*np; i++)
+        p[i] = 1.0 + i;
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_in_set(ocp[0].config, ocp[0].dims, ocp[0].nlp_in, i, "parameter_values", &p[i*np]);
+    ocp_nlp_field_set_all(p_h, p.data());
+
+    for (int i = 0; i <= N; i++)
+    {
+        if (i < N)
+            REQUIRE(ocp[1].nlp_in->dynamics_version[i] == ocp[0].nlp_in->dynamics_version[i]);
+        REQUIRE(ocp[1].nlp_in->cost_version[i] == ocp[0].nlp_in->cost_version[i]);
+        REQUIRE(ocp[1].nlp_in->constraints_version[i] == ocp[0].nlp_in->constraints_version[i]);
+        for (int j = 0; j < np; j++)
+            REQUIRE(ocp[1].nlp_in->parameter_values[i][j] == p[i*np+j]);
+    }
+
+    std::vector<double> p_out((N+1)*np);
+    ocp_nlp_field_get_all(p_h, p_out.data());
+    for (int i = 0; i < (N+1)*np; i++)
+        REQUIRE(p_out[i] == p[i]);
+
+    for (int k = 0; k < 2; k++)
+        REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+
+    // same solution with the string setters and with the handles
+    REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out, true)
+            == 0.0);
+
+    // the handles read the same values as ocp_nlp_out_get, all stages at once and stage-wise
+    std::vector<double> x_h_out((N+1)*nx), u_h_out(N*nu), pi_h_out(N*nx);
+    std::vector<double> x_traj((N+1)*nx), u_traj(N*nu), pi_traj(N*nx);
+    ocp_nlp_field_get_all(x_h, x_h_out.data());
+    ocp_nlp_field_get_all(u_h, u_h_out.data());
+    ocp_nlp_field_get_all(pi_h, pi_h_out.data());
+    ocp_nlp_out_get_trajectory(ocp[1].config, ocp[1].dims, ocp[1].nlp_out, "x", x_traj.data());
+    ocp_nlp_out_get_trajectory(ocp[1].config, ocp[1].dims, ocp[1].nlp_out, "u", u_traj.data());
+    ocp_nlp_out_get_trajectory(ocp[1].config, ocp[1].dims, ocp[1].nlp_out, "pi", pi_traj.data());
+    REQUIRE(x_h_out == x_traj);
+    REQUIRE(u_h_out == u_traj);
+    REQUIRE(pi_h_out == pi_traj);
+
+    double x_tmp[4];
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_field_get(x_h, i, x_tmp);
+        for (int j = 0; j < nx; j++)
+            REQUIRE(x_tmp[j] == x_h_out[i*nx+j]);
+    }
+
+    // setting the iterate through the handle is seen by ocp_nlp_out_get
+    double x_pert[4] = {1.0, -1.0, 2.0, -2.0};
+    ocp_nlp_field_set(x_h, N, x_pert);
+    ocp_nlp_out_get(ocp[1].config, ocp[1].dims, ocp[1].nlp_out, N, "x", x_tmp);
+    for (int j = 0; j < nx; j++)
+        REQUIRE(x_tmp[j] == x_pert[j]);
+
+    ocp_nlp_field_handle_destroy(yref_h);
+    ocp_nlp_field_handle_destroy(lbx_h);
+    ocp_nlp_field_handle_destroy(ubx_h);
+    ocp_nlp_field_handle_destroy(p_h);
+    ocp_nlp_field_handle_destroy(x_h);
+    ocp_nlp_field_handle_destroy(u_h);
+    ocp_nlp_field_handle_destroy(pi_h);
+
+    pendulum_ocp_free(&ocp[0]);
+    pendulum_ocp_free(&ocp[1]);
+}
+
+
+
+/************************************************
+* TEST CASE: horizon shift
+************************************************/
+
+TEST_CASE("pendulum shift", "[NLP solver]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create(&ocp, SQP, PARTIAL_CONDENSING_HPIPM);
+    pendulum_ocp_solver_create(&ocp);
+
+    int N = ocp.N;
+    int nx = ocp.nx;
+    int nu = ocp.nu;
+    int ni = 1;  // input bounds, and the initial state bounds at stage 0
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    std::vector<double> x_old((N+1)*nx), u_old(N*nu), pi_old(N*nx), lam_old(N*2*ni);
+    for (int i = 0; i <= N; i++)
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "x", &x_old[i*nx]);
+    for (int i = 0; i < N; i++)
+    {
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "u", &u_old[i*nu]);
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "pi", &pi_old[i*nx]);
+    }
+    for (int i = 1; i < N; i++)
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "lam", &lam_old[i*2*ni]);
+
+    // default shift_policy: SHIFT_COPY
+    ocp_nlp_shift(ocp.solver, ocp.nlp_in, ocp.nlp_out);
+
+    // the windows moved by one stage
+    REQUIRE(ocp.nlp_out->ring_head == 1);
+    REQUIRE(ocp.nlp_out->ring_head_pi == 1);
+
+    double x_tmp[4], u_tmp[1], pi_tmp[4], lam_tmp[2*(4+1)];
+    for (int i = 0; i < N-1; i++)
+    {
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "x", x_tmp);
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "u", u_tmp);
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "pi", pi_tmp);
+        for (int j = 0; j < nx; j++)
+        {
+            REQUIRE(x_tmp[j] == x_old[(i+1)*nx+j]);
+            REQUIRE(pi_tmp[j] == pi_old[(i+1)*nx+j]);
+        }
+        for (int j = 0; j < nu; j++)
+            REQUIRE(u_tmp[j] == u_old[(i+1)*nu+j]);
+    }
+    for (int i = 1; i < N-1; i++)
+    {
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, "lam", lam_tmp);
+        for (int j = 0; j < 2*ni; j++)
+            REQUIRE(lam_tmp[j] == lam_old[(i+1)*2*ni+j]);
+    }
+
+    // stage 0 has the initial state bounds in addition: its multipliers are reset
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, 0, "lam", lam_tmp);
+    for (int j = 0; j < 2*(nx+ni); j++)
+        REQUIRE(lam_tmp[j] == 0.0);
+
+    // last stage: previous terminal state, controls and multipliers of the previous last stage
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N-1, "x", x_tmp);
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N-1, "u", u_tmp);
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N-1, "pi", pi_tmp);
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N-1, "lam", lam_tmp);
+    for (int j = 0; j < nx; j++)
+    {
+        REQUIRE(x_tmp[j] == x_old[N*nx+j]);
+        REQUIRE(pi_tmp[j] == pi_old[(N-1)*nx+j]);
+    }
+    for (int j = 0; j < nu; j++)
+        REQUIRE(u_tmp[j] == u_old[(N-1)*nu+j]);
+    for (int j = 0; j < 2*ni; j++)
+        REQUIRE(lam_tmp[j] == lam_old[(N-1)*2*ni+j]);
+
+    // terminal stage: previous terminal state
+    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N, "x", x_tmp);
+    for (int j = 0; j < nx; j++)
+        REQUIRE(x_tmp[j] == x_old[N*nx+j]);
+
+    // the shifted iterate is a valid initial guess
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    // the windows wrap around the ring buffers
+    for (int i = 0; i < N; i++)
+        ocp_nlp_shift(ocp.solver, ocp.nlp_in, ocp.nlp_out);
+    REQUIRE(ocp.nlp_out->ring_head == 0);
+    REQUIRE(ocp.nlp_out->ring_head_pi == 1);
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+
+/************************************************
+* TEST CASE: merit function line search
+************************************************/
+
+TEST_CASE("pendulum merit line search", "[NLP solver]")
+{
+    // ocp[0]: full steps, ocp[1]: line search with second order correction
+    pendulum_ocp ocp[2];
+
+    int globalization[2] = {FIXED_STEP, MERIT_BACKTRACKING};
+    int use_SOC = 1;
+    double alpha_min = 0.05;
+
+    for (int k = 0; k < 2; k++)
+    {
+        pendulum_ocp_create(&ocp[k], SQP, PARTIAL_CONDENSING_HPIPM);
+        pendulum_ocp_set_tol(&ocp[k], 100, 1e-8);
+        ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "globalization", &globalization[k]);
+        ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "use_SOC", &use_SOC);
+        ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "alpha_min", &alpha_min);
+        pendulum_ocp_solver_create(&ocp[k]);
+        REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+    }
+
+    // same solution
+    REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out) <= 1e-6);
+
+    // line search statistics: step length, merit value, line search iterations, soc
+    int sqp_iter, stat_m, stat_n;
+    double *stat;
+    ocp_nlp_get(ocp[1].config, ocp[1].solver, "sqp_iter", &sqp_iter);
+    ocp_nlp_get(ocp[1].config, ocp[1].solver, "stat_m", &stat_m);
+    ocp_nlp_get(ocp[1].config, ocp[1].solver, "stat_n", &stat_n);
+    ocp_nlp_get(ocp[1].config, ocp[1].solver, "stat", &stat);
+    REQUIRE(stat_n == 10);
+    REQUIRE(sqp_iter >= 1);
+
+    for (int ii = 1; ii <= sqp_iter && ii < stat_m; ii++)
+    {
+        double alpha = stat[stat_n*ii+6];
+        double merit = stat[stat_n*ii+7];
+        double ls_iter = stat[stat_n*ii+8];
+        double soc = stat[stat_n*ii+9];
+        REQUIRE(alpha >= alpha_min);
+        REQUIRE(alpha <= 1.0);
+        REQUIRE(merit >= 0.0);
+        REQUIRE(ls_iter >= 1.0);
+        REQUIRE((soc == 0.0 || soc == 1.0));
+    }
+
+    // full steps close to the solution
+    REQUIRE(stat[stat_n*sqp_iter+6] == 1.0);
+
+    pendulum_ocp_free(&ocp[0]);
+    pendulum_ocp_free(&ocp[1]);
+}
+
+
+
+/************************************************
+* TEST CASE: multi-level iterations
+************************************************/
+
+TEST_CASE("pendulum multi-level iterations", "[NLP solver]")
+{
+    // ocp[0]: full linearization at each sample, ocp[1]: cyclic level schedule
+    pendulum_ocp ocp[2];
+    const char *schedule[2] = {"D", "DBAB"};
+
+    int num_samples = 80;
+
+    for (int k = 0; k < 2; k++)
+    {
+        pendulum_ocp_create(&ocp[k], SQP_RTI, PARTIAL_CONDENSING_HPIPM);
+        ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "mli_schedule",
+                                (void *) schedule[k]);
+        pendulum_ocp_solver_create(&ocp[k]);
+
+        // rti iterations at a fixed initial state converge to the solution of the ocp
+        for (int ii = 0; ii < num_samples; ii++)
+        {
+            REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+
+            int mli_level;
+            ocp_nlp_get(ocp[k].config, ocp[k].solver, "mli_level", &mli_level);
+            char c = schedule[k][ii % strlen(schedule[k])];
+            int level = c == 'A' ? MLI_LEVEL_A : c == 'B' ? MLI_LEVEL_B : MLI_LEVEL_D;
+            REQUIRE(mli_level == level);
+        }
+    }
+
+    // the cheaper levels converge to the same solution
+    REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out) <= 1e-6);
+
+    pendulum_ocp_free(&ocp[0]);
+    pendulum_ocp_free(&ocp[1]);
+
+    // contraction monitor: with kappa_max close to zero any nonzero step forces level D
+    pendulum_ocp ocp_kappa;
+    pendulum_ocp_create(&ocp_kappa, SQP_RTI, PARTIAL_CONDENSING_HPIPM);
+    double kappa_max = 1e-300;
+    ocp_nlp_solver_opts_set(ocp_kappa.config, ocp_kappa.nlp_opts, "mli_schedule", (void *) "DB");
+    ocp_nlp_solver_opts_set(ocp_kappa.config, ocp_kappa.nlp_opts, "mli_kappa_max", &kappa_max);
+    pendulum_ocp_solver_create(&ocp_kappa);
+
+    // the first two samples have no previous step to compare with
+    for (int ii = 0; ii < 2; ii++)
+        REQUIRE(ocp_nlp_solve(ocp_kappa.solver, ocp_kappa.nlp_in, ocp_kappa.nlp_out) == 0);
+    for (int ii = 0; ii < 3; ii++)
+    {
+        REQUIRE(ocp_nlp_solve(ocp_kappa.solver, ocp_kappa.nlp_in, ocp_kappa.nlp_out) == 0);
+        int mli_level;
+        ocp_nlp_get(ocp_kappa.config, ocp_kappa.solver, "mli_level", &mli_level);
+        REQUIRE(mli_level == MLI_LEVEL_D);
+    }
+
+    pendulum_ocp_free(&ocp_kappa);
+}
+
+
+
+/************************************************
+* TEST CASE: quasi-Newton Hessian updates
+************************************************/
+
+TEST_CASE("pendulum quasi-newton hessian", "[NLP solver]")
+{
+    // ocp[0]: gauss-newton hessian, ocp[1]: damped bfgs, ocp[2]: sr1 convexified by mirroring
+    pendulum_ocp ocp[3];
+
+    int qn_update[3] = {QN_NONE, QN_BFGS, QN_SR1};
+    ocp_nlp_reg_t regularization[3] = {NO_REGULARIZE, NO_REGULARIZE, MIRROR};
+
+    for (int k = 0; k < 3; k++)
+    {
+        pendulum_ocp_create(&ocp[k], SQP, PARTIAL_CONDENSING_HPIPM, regularization[k]);
+        pendulum_ocp_set_tol(&ocp[k], 200, 1e-8);
+        ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "qn_update", &qn_update[k]);
+        pendulum_ocp_solver_create(&ocp[k]);
+        REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+    }
+
+    // the hessian approximation does not change the solution
+    for (int k = 1; k < 3; k++)
+        REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[k].nlp_out)
+                <= 1e-6);
+
+    for (int k = 0; k < 3; k++)
+        pendulum_ocp_free(&ocp[k]);
+}
+
+
+
+/************************************************
+* TEST CASE: cholesky-first regularization
+************************************************/
+
+TEST_CASE("pendulum cholesky-first regularization", "[NLP solver]")
+{
+    // projection of the hessian blocks with and without the cholesky test; the smallest
+    // eigenvalue of the pendulum hessian blocks is 1e-2
+    pendulum_ocp ocp[2];
+
+    int N = PENDULUM_N;
+    double reg_epsilon[2] = {1e-4, 1.0};
+    int chol_first[2] = {0, 1};
+    int corrected[PENDULUM_N+1];
+
+    for (int jj = 0; jj < 2; jj++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            pendulum_ocp_create(&ocp[k], SQP, PARTIAL_CONDENSING_HPIPM, PROJECT);
+            ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "reg_epsilon", &reg_epsilon[jj]);
+            ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "reg_chol_first", &chol_first[k]);
+            pendulum_ocp_solver_create(&ocp[k]);
+
+            REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+
+            // without the cholesky test every block is projected, with it only the blocks
+            // that have eigenvalues below epsilon
+            int num_corrected;
+            ocp_nlp_get(ocp[k].config, ocp[k].solver, "reg_num_corrected", &num_corrected);
+            ocp_nlp_get(ocp[k].config, ocp[k].solver, "reg_corrected", corrected);
+            int expected = (!chol_first[k] || jj == 1) ? 1 : 0;
+            REQUIRE(num_corrected == expected * (N+1));
+            for (int i = 0; i <= N; i++)
+                REQUIRE(corrected[i] == expected);
+        }
+
+        // the cholesky test does not change the regularized hessian
+        REQUIRE(ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out)
+                <= 1e-10);
+
+        pendulum_ocp_free(&ocp[0]);
+        pendulum_ocp_free(&ocp[1]);
+    }
+}
+
+
+
+/************************************************
+* TEST CASE: trajectories
+************************************************/
+
+TEST_CASE("pendulum trajectories", "[NLP solver]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create(&ocp, SQP, PARTIAL_CONDENSING_HPIPM);
+    pendulum_ocp_solver_create(&ocp);
+
+    int N = PENDULUM_N;
+    int nx = 4;
+    int nu = 1;
+
+    // nonzero primal and dual values in all the stages
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == 0);
+
+    const char *fields[3] = {"x", "u", "pi"};
+    int len_exp[3] = {nx, nu, nx};
+
+    int len[PENDULUM_N+1];
+    double traj[(PENDULUM_N+1)*4];
+    double traj_new[(PENDULUM_N+1)*4];
+    double stage_val[4];
+
+    // the stage arrays of nlp_out are moved along the ring buffer by the shift
+    for (int jj = 0; jj < 2; jj++)
+    {
+        if (jj == 1)
+            ocp_nlp_shift(ocp.solver, ocp.nlp_in, ocp.nlp_out);
+
+        for (int kk = 0; kk < 3; kk++)
+        {
+            const char *field = fields[kk];
+
+            // stage lengths, no u and pi at the last stage
+            int len_tot = ocp_nlp_dims_get_trajectory(ocp.config, ocp.dims, field, len);
+            REQUIRE(len_tot == N*len_exp[kk] + (kk == 0 ? nx : 0));
+            for (int i = 0; i <= N; i++)
+                REQUIRE(len[i] == (i < N || kk == 0 ? len_exp[kk] : 0));
+
+            // get_trajectory against the stage-wise get
+            ocp_nlp_out_get_trajectory(ocp.config, ocp.dims, ocp.nlp_out, field, traj);
+            int offset = 0;
+            for (int i = 0; i <= N; i++)
+            {
+                if (len[i] > 0)
+                    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, field, stage_val);
+                for (int ii = 0; ii < len[i]; ii++)
+                    REQUIRE(traj[offset+ii] == stage_val[ii]);
+                offset += len[i];
+            }
+
+            // set_trajectory against the stage-wise get
+            for (int ii = 0; ii < len_tot; ii++)
+                traj_new[ii] = 2.0 * traj[ii] + ii;
+            ocp_nlp_out_set_trajectory(ocp.config, ocp.dims, ocp.nlp_out, field, traj_new);
+            offset = 0;
+            for (int i = 0; i <= N; i++)
+            {
+                if (len[i] > 0)
+                    ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, i, field, stage_val);
+                for (int ii = 0; ii < len[i]; ii++)
+                    REQUIRE(stage_val[ii] == traj_new[offset+ii]);
+                offset += len[i];
+            }
+
+            // stage-wise set against get_trajectory: back to the initial values
+            offset = 0;
+            for (int i = 0; i <= N; i++)
+            {
+                if (len[i] > 0)
+                    ocp_nlp_out_set(ocp.config, ocp.dims, ocp.nlp_out, i, field, traj + offset);
+                offset += len[i];
+            }
+            ocp_nlp_out_get_trajectory(ocp.config, ocp.dims, ocp.nlp_out, field, traj_new);
+            for (int ii = 0; ii < len_tot; ii++)
+                REQUIRE(traj_new[ii] == traj[ii]);
+        }
+    }
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+
+/************************************************
+* TEST CASE: partial tightening
+************************************************/
+
+TEST_CASE("pendulum partial tightening", "[NLP solver]")
+{
+    // ocp[0]: hard input bounds, ocp[1]: input bounds of the stages >= tightening_stage replaced by
+    // a log-barrier; line search with second order correction, which rebuilds the qp bounds
+    pendulum_ocp ocp[2];
+
+    int N = PENDULUM_N;
+    double lbu[1] = {-10.0};
+    double ubu[1] = {10.0};
+    int tightening_stage = 1;
+    double tightening_mu[2] = {1e-3, 1e-4};
+    int globalization = MERIT_BACKTRACKING;
+    int use_SOC = 1;
+    double lam[2];
+
+    double err_prev = 0.0;
+
+    for (int jj = 0; jj < 2; jj++)
+    {
+        double mu = tightening_mu[jj];
+
+        for (int k = 0; k < 2; k++)
+        {
+            pendulum_ocp_create(&ocp[k], SQP, PARTIAL_CONDENSING_HPIPM);
+            for (int i = 0; i < N; i++)
+            {
+                ocp_nlp_constraints_model_set(ocp[k].config, ocp[k].dims, ocp[k].nlp_in, i, "lbu", lbu);
+                ocp_nlp_constraints_model_set(ocp[k].config, ocp[k].dims, ocp[k].nlp_in, i, "ubu", ubu);
+            }
+            pendulum_ocp_set_tol(&ocp[k], 100, 1e-8);
+            ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "globalization", &globalization);
+            ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "use_SOC", &use_SOC);
+            if (k == 1)
+            {
+                // the barrier multipliers keep the complementarity residual at mu
+                double tol_comp = 10.0 * mu;
+                ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "tightening_stage", &tightening_stage);
+                ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "tightening_mu", &mu);
+                ocp_nlp_solver_opts_set(ocp[k].config, ocp[k].nlp_opts, "tol_comp", &tol_comp);
+            }
+            pendulum_ocp_solver_create(&ocp[k]);
+
+            // converged
+            REQUIRE(ocp_nlp_solve(ocp[k].solver, ocp[k].nlp_in, ocp[k].nlp_out) == 0);
+        }
+
+        // the input bounds are active in the tightened part of the horizon
+        bool active = false;
+        for (int i = tightening_stage; i < N; i++)
+        {
+            ocp_nlp_out_get(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, i, "lam", lam);
+            active = active || lam[0] > 1e-6 || lam[1] > 1e-6;
+        }
+        REQUIRE(active);
+
+        // complementarity residual of the order of mu: lam * t = mu for the tightened constraints
+        ocp_nlp_res *nlp_res;
+        ocp_nlp_get(ocp[1].config, ocp[1].solver, "nlp_res", &nlp_res);
+        REQUIRE(nlp_res->inf_norm_res_m >= 0.5 * mu);
+        REQUIRE(nlp_res->inf_norm_res_m <= 2.0 * mu);
+        REQUIRE(nlp_res->inf_norm_res_g <= 1e-8);
+        REQUIRE(nlp_res->inf_norm_res_b <= 1e-8);
+        REQUIRE(nlp_res->inf_norm_res_d <= 1e-8);
+
+        // close to the hard-constrained solution, closer for the smaller mu
+        double err = ocp_nlp_out_diff(ocp[0].config, ocp[0].dims, ocp[0].nlp_out, ocp[1].nlp_out);
+        REQUIRE(err <= 1e-1);
+        if (jj > 0)
+            REQUIRE(err <= err_prev);
+        err_prev = err;
+
+        pendulum_ocp_free(&ocp[0]);
+        pendulum_ocp_free(&ocp[1]);
+    }
+}
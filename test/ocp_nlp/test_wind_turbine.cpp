@@ -285,6 +285,7 @@ void setup_and_solve_nlp(std::string const& integrator_str, std::string const& q
     int nu[NN+1] = {}; // inputs
     int nz[NN+1] = {}; // algebraic variables
     int ns[NN+1] = {}; // slacks
+    int np_stage[NN+1] = {}; // parameters of the external functions (wind)
     // cost
     int ny[NN+1] = {}; // measurements
     // constraints
@@ -319,6 +320,7 @@ void setup_and_solve_nlp(std::string const& integrator_str, std::string const& q
         ns[i] = nsh[i];
         ny[i] = 4;
         nz[i] = 0;
+        np_stage[i] = np;
     }
 
     nx[NN] = nx_;
@@ -649,6 +651,7 @@ void setup_and_solve_nlp(std::string const& integrator_str, std::string const& q
     ocp_nlp_dims_set_opt_vars(config, dims, "nu", nu);
     ocp_nlp_dims_set_opt_vars(config, dims, "nz", nz);
     ocp_nlp_dims_set_opt_vars(config, dims, "ns", ns);
+    ocp_nlp_dims_set_opt_vars(config, dims, "np", np_stage);
 
     for (int i = 0; i <= NN; i++)
     {
@@ -1040,6 +1043,7 @@ void setup_and_solve_nlp(std::string const& integrator_str, std::string const& q
                 printf("\nWrong sim name\n\n");
                 exit(1);
             }
+            ocp_nlp_in_set(config, dims, nlp_in, ii, "parameter_values", wind0_ref+idx+ii);
         }
         // update reference
         for (int i = 0; i <= NN; i++)
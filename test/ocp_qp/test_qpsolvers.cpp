@@ -32,6 +32,7 @@
  */
 
 
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -54,6 +55,7 @@ ocp_qp_solver_t hashit(std::string const &inString)
 {
     if (inString == "SPARSE_HPIPM") return PARTIAL_CONDENSING_HPIPM;
     if (inString == "DENSE_HPIPM") return FULL_CONDENSING_HPIPM;
+    if (inString == "SPARSE_PARTITIONED_IPM") return PARTIAL_CONDENSING_PARTITIONED_IPM;
 #ifdef ACADOS_WITH_HPMPC
     if (inString == "SPARSE_HPMPC") return PARTIAL_CONDENSING_HPMPC;
 #endif
@@ -82,6 +84,7 @@ double solver_tolerance(std::string const &inString)
 {
     if (inString == "SPARSE_HPIPM") return 1e-8;
     if (inString == "SPARSE_HPMPC") return 1e-5;
+    if (inString == "SPARSE_PARTITIONED_IPM") return 1e-8;
     if (inString == "SPARSE_QPDUNES") return 1e-8;
     if (inString == "DENSE_HPIPM") return 1e-8;
     if (inString == "DENSE_QPOASES") return 1e-10;
@@ -99,7 +102,7 @@ void set_N2(std::string const &inString, ocp_qp_xcond_solver_config *config, voi
 {
     bool option_found = false;
 
-    if ( inString=="SPARSE_HPIPM" | inString=="SPARSE_HPMPC" | inString == "SPARSE_OOQP" | inString == "SPARSE_OSQP" )
+    if ( inString=="SPARSE_HPIPM" | inString=="SPARSE_PARTITIONED_IPM" | inString=="SPARSE_HPMPC" | inString == "SPARSE_OOQP" | inString == "SPARSE_OSQP" )
     {
 		config->opts_set(config, opts, "cond_N", &N2);
     }
@@ -119,11 +122,39 @@ void set_N2(std::string const &inString, ocp_qp_xcond_solver_config *config, voi
 
 
 
+// largest difference of the primal and dual solutions of two ocp qps
+static double ocp_qp_out_max_err(ocp_qp_dims *dims, ocp_qp_out *qp_out, ocp_qp_out *qp_out_ref)
+{
+    int N = dims->N;
+    double max_err = 0.0;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        int nv = dims->nu[ii] + dims->nx[ii] + 2 * dims->ns[ii];
+        int nc = 2 * dims->nb[ii] + 2 * dims->ng[ii] + 2 * dims->ns[ii];
+        int npi = ii < N ? dims->nx[ii+1] : 0;
+        for (int jj = 0; jj < nv; jj++)
+            max_err = fmax(max_err, fabs(BLASFEO_DVECEL(qp_out->ux + ii, jj) -
+                                         BLASFEO_DVECEL(qp_out_ref->ux + ii, jj)));
+        for (int jj = 0; jj < npi; jj++)
+            max_err = fmax(max_err, fabs(BLASFEO_DVECEL(qp_out->pi + ii, jj) -
+                                         BLASFEO_DVECEL(qp_out_ref->pi + ii, jj)));
+        for (int jj = 0; jj < nc; jj++)
+            max_err = fmax(max_err, fabs(BLASFEO_DVECEL(qp_out->lam + ii, jj) -
+                                         BLASFEO_DVECEL(qp_out_ref->lam + ii, jj)));
+    }
+
+    return max_err;
+}
+
+
+
 TEST_CASE("mass spring example", "[QP solvers]")
 {
     vector<std::string> solvers = {
                                     "DENSE_HPIPM"
                                    ,"SPARSE_HPIPM"
+                                   ,"SPARSE_PARTITIONED_IPM"
 #ifdef ACADOS_WITH_HPMPC
                                    ,"SPARSE_HPMPC"
 #endif
@@ -273,3 +304,474 @@ TEST_CASE("mass spring example", "[QP solvers]")
     }  // END_FOR_SOLVERS
 
 }  // END_TEST_CASE
+
+
+
+TEST_CASE("mass spring example mixed precision", "[QP solvers]")
+{
+    /************************************************
+     * set up dimensions
+     ************************************************/
+
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    // partially condensed horizon shorter than N, the single precision qp has the condensed dims
+    int N2_values[] = {15, 5, 3};
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    double res[4];
+    double max_res;
+
+    for (int N2 : N2_values)
+    {
+        SECTION("N2 = " + std::to_string(N2))
+        {
+            ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+            ocp_qp_xcond_solver_dims *qp_dims = create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+            ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+
+            ocp_qp_out *qp_out_ref = ocp_qp_out_create(qp_dims->orig_dims);
+            ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+            // reference: double precision ipm
+            void *opts_ref = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            config->opts_set(config, opts_ref, "cond_N", &N2);
+            ocp_qp_solver *solver_ref = ocp_qp_create(config, qp_dims, opts_ref);
+            REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+
+            // single precision ipm with iterative refinement in double precision
+            int mixed_precision = 1;
+            void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            config->opts_set(config, opts, "cond_N", &N2);
+            config->opts_set(config, opts, "mixed_precision", &mixed_precision);
+            ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+            REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+
+            ocp_qp_inf_norm_residuals(qp_dims->orig_dims, qp_in, qp_out, res);
+
+            max_res = 0.0;
+            for (int ii = 0; ii < 4; ii++)
+                max_res = (res[ii] > max_res) ? res[ii] : max_res;
+
+            printf("\nmixed precision, N2 = %d, inf norm res: %e, %e, %e, %e\n", N2, res[0], res[1], res[2], res[3]);
+            REQUIRE(max_res <= 1e-8);
+
+            // same solution as the double precision ipm
+            ocp_qp_dims *dims = qp_dims->orig_dims;
+            double max_err = 0.0;
+            for (int ii = 0; ii <= N; ii++)
+            {
+                for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii]; jj++)
+                {
+                    double err = fabs(BLASFEO_DVECEL(qp_out->ux + ii, jj) -
+                                      BLASFEO_DVECEL(qp_out_ref->ux + ii, jj));
+                    max_err = (err > max_err) ? err : max_err;
+                }
+            }
+            REQUIRE(max_err <= 1e-6);
+
+            free(solver);
+            free(opts);
+            free(solver_ref);
+            free(opts_ref);
+            free(qp_out);
+            free(qp_out_ref);
+            free(qp_in);
+            free(qp_dims);
+            free(config);
+        }
+    }
+
+}  // END_TEST_CASE
+
+
+
+TEST_CASE("mass spring example block-parallel partial condensing", "[QP solvers]")
+{
+    /************************************************
+     * set up dimensions
+     ************************************************/
+
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    int N2_values[] = {15, 5, 3};
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    for (int N2 : N2_values)
+    {
+        SECTION("N2 = " + std::to_string(N2))
+        {
+            ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+            ocp_qp_xcond_solver_dims *qp_dims = create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+            ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+
+            ocp_qp_out *qp_out_ref = ocp_qp_out_create(qp_dims->orig_dims);
+            ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+            // reference: serial condensing and expansion
+            void *opts_ref = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            config->opts_set(config, opts_ref, "cond_N", &N2);
+            ocp_qp_solver *solver_ref = ocp_qp_create(config, qp_dims, opts_ref);
+            REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+
+            // blocks condensed and expanded one by one
+            int par_blocks = 1;
+            void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            config->opts_set(config, opts, "cond_N", &N2);
+            config->opts_set(config, opts, "cond_par_blocks", &par_blocks);
+            ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+            REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+
+            // same primal and dual solution
+            REQUIRE(ocp_qp_out_max_err(qp_dims->orig_dims, qp_out, qp_out_ref) <= 1e-10);
+
+            free(solver);
+            free(opts);
+            free(solver_ref);
+            free(opts_ref);
+            free(qp_out);
+            free(qp_out_ref);
+            free(qp_in);
+            free(qp_dims);
+            free(config);
+        }
+    }
+
+}  // END_TEST_CASE
+
+
+
+TEST_CASE("mass spring example lti full condensing", "[QP solvers]")
+{
+    vector<std::string> solvers = {
+                                    "DENSE_HPIPM"
+#ifdef ACADOS_WITH_QPOASES
+                                   ,"DENSE_QPOASES"
+#endif
+                                  };
+
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    ocp_qp_solver_plan plan;
+
+    for (std::string solver_name : solvers)
+    {
+        SECTION(solver_name)
+        {
+            plan.qp_solver = hashit(solver_name);
+            bool qpoases = solver_name == "DENSE_QPOASES";
+
+            ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+            ocp_qp_xcond_solver_dims *qp_dims = create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+            ocp_qp_dims *dims = qp_dims->orig_dims;
+
+            ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(dims);
+
+            ocp_qp_out *qp_out_ref = ocp_qp_out_create(dims);
+            ocp_qp_out *qp_out = ocp_qp_out_create(dims);
+
+            // reference: matrices condensed at every call, cold start
+            void *opts_ref = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            ocp_qp_solver *solver_ref = ocp_qp_create(config, qp_dims, opts_ref);
+
+            // matrices condensed at the first call only; qpOASES hotstart skips the matrix copies
+            int lti = 1;
+            int hotstart = 2;
+            void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            config->opts_set(config, opts, "cond_lti", &lti);
+            if (qpoases)
+                config->opts_set(config, opts, "warm_start", &hotstart);
+            ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+
+            double tol = 1e-9;
+
+            // initial state: bounds on x at stage 0, after the bounds on u; the upper bounds are
+            // stored with negative sign
+            int nb0 = dims->nb[0];
+            auto set_x0 = [&](double x0_0)
+            {
+                for (int jj = 0; jj < nx_; jj++)
+                {
+                    double x0 = jj < 2 ? x0_0 : 0.0;
+                    BLASFEO_DVECEL(qp_in->d + 0, nu_ + jj) = x0;
+                    BLASFEO_DVECEL(qp_in->d + 0, nb0 + nu_ + jj) = -x0;
+                }
+            };
+
+            // scale the state weights: the condensed matrices change
+            auto scale_Q = [&](double alpha)
+            {
+                for (int ii = 0; ii <= N; ii++)
+                    for (int jj = dims->nu[ii]; jj < dims->nu[ii] + dims->nx[ii]; jj++)
+                        BLASFEO_DMATEL(qp_in->RSQrq + ii, jj, jj) *= alpha;
+            };
+
+            // sequence of lti qps with changing initial state
+            double x0_seq[4] = {2.5, 1.5, 0.5, -0.5};
+            for (double x0 : x0_seq)
+            {
+                set_x0(x0);
+                REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+                REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+                REQUIRE(ocp_qp_out_max_err(dims, qp_out, qp_out_ref) <= tol);
+            }
+
+            // new matrices with lti on: the matrices of the first call are kept
+            scale_Q(2.0);
+            set_x0(2.0);
+            REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+            REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+            REQUIRE(ocp_qp_out_max_err(dims, qp_out, qp_out_ref) > 1e-6);
+
+            // lti off: matrices condensed again (and no hotstart)
+            lti = 0;
+            hotstart = 1;
+            config->opts_set(config, opts, "cond_lti", &lti);
+            if (qpoases)
+                config->opts_set(config, opts, "warm_start", &hotstart);
+            REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+            REQUIRE(ocp_qp_out_max_err(dims, qp_out, qp_out_ref) <= tol);
+
+            // lti on again: the first call condenses the current matrices
+            scale_Q(0.25);
+            lti = 1;
+            hotstart = 2;
+            config->opts_set(config, opts, "cond_lti", &lti);
+            if (qpoases)
+                config->opts_set(config, opts, "warm_start", &hotstart);
+            for (double x0 : x0_seq)
+            {
+                set_x0(x0);
+                REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+                REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+                REQUIRE(ocp_qp_out_max_err(dims, qp_out, qp_out_ref) <= tol);
+            }
+
+            free(solver);
+            free(opts);
+            free(solver_ref);
+            free(opts_ref);
+            free(qp_out);
+            free(qp_out_ref);
+            free(qp_in);
+            free(qp_dims);
+            free(config);
+        }
+    }
+
+}  // END_TEST_CASE
+
+
+
+TEST_CASE("mass spring example active set cache", "[QP solvers]")
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+    ocp_qp_xcond_solver_dims *qp_dims = create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+    ocp_qp_dims *dims = qp_dims->orig_dims;
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(dims);
+
+    ocp_qp_out *qp_out_ref = ocp_qp_out_create(dims);
+    ocp_qp_out *qp_out = ocp_qp_out_create(dims);
+
+    // parametric qp for the sensitivities: perturbation of the first dynamics equation
+    ocp_qp_in *param_qp_in = ocp_qp_in_create(dims);
+    d_ocp_qp_copy_all(qp_in, param_qp_in);
+    d_ocp_qp_set_rhs_zero(param_qp_in);
+    BLASFEO_DVECEL(param_qp_in->b + 0, 0) = 1.0;
+
+    ocp_qp_out *sens_ref = ocp_qp_out_create(dims);
+    ocp_qp_out *sens = ocp_qp_out_create(dims);
+
+    // reference: cache disabled
+    void *opts_ref = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    ocp_qp_solver *solver_ref = ocp_qp_create(config, qp_dims, opts_ref);
+    REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+    config->eval_sens(config, qp_dims, param_qp_in, sens_ref, opts_ref, solver_ref->mem, solver_ref->work);
+
+    // cache with 2 slots
+    int cache_size = 2;
+    void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    config->opts_set(config, opts, "as_cache_size", &cache_size);
+    ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+
+    // the cache size set after memory creation is clamped to the allocated slots
+    cache_size = 8;
+    config->opts_set(config, opts, "as_cache_size", &cache_size);
+
+    int hits, entries;
+
+    SECTION("solution and sensitivities after a cache hit")
+    {
+        REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+        REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+
+        config->memory_get(config, solver->mem, "as_cache_hits", &hits);
+        config->memory_get(config, solver->mem, "as_cache_entries", &entries);
+        REQUIRE(hits == 1);
+        REQUIRE(entries <= 2);
+
+        // the factorization of the qp solver has to match the cached solution
+        config->eval_sens(config, qp_dims, param_qp_in, sens, opts, solver->mem, solver->work);
+
+        double max_err = 0.0;
+        double max_err_sens = 0.0;
+        for (int ii = 0; ii <= N; ii++)
+        {
+            for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii]; jj++)
+            {
+                double err = fabs(BLASFEO_DVECEL(qp_out->ux + ii, jj) -
+                                  BLASFEO_DVECEL(qp_out_ref->ux + ii, jj));
+                max_err = (err > max_err) ? err : max_err;
+                err = fabs(BLASFEO_DVECEL(sens->ux + ii, jj) - BLASFEO_DVECEL(sens_ref->ux + ii, jj));
+                max_err_sens = (err > max_err_sens) ? err : max_err_sens;
+            }
+        }
+        REQUIRE(max_err <= 1e-6);
+        REQUIRE(max_err_sens <= 1e-6);
+    }
+
+    free(solver);
+    free(opts);
+    free(solver_ref);
+    free(opts_ref);
+    free(sens);
+    free(sens_ref);
+    free(param_qp_in);
+    free(qp_out);
+    free(qp_out_ref);
+    free(qp_in);
+    free(qp_dims);
+    free(config);
+
+}  // END_TEST_CASE
+
+
+
+TEST_CASE("mass spring example partitioned ipm", "[QP solvers]")
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    // one segment is the plain Riccati recursion, N+1 segments put each stage in its own
+    int num_segments_values[] = {1, 2, 3, 7, 16};
+
+    double tol_stat = 1e-10;
+
+    double res[4];
+    double max_res;
+
+    // reference: hpipm
+    ocp_qp_solver_plan plan_ref;
+    plan_ref.qp_solver = PARTIAL_CONDENSING_HPIPM;
+    ocp_qp_xcond_solver_config *config_ref = ocp_qp_xcond_solver_config_create(plan_ref);
+
+    ocp_qp_xcond_solver_dims *qp_dims_ref = create_ocp_qp_dims_mass_spring(config_ref, N, nx_, nu_, nb_, ng_, ngN);
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims_ref->orig_dims);
+    ocp_qp_out *qp_out_ref = ocp_qp_out_create(qp_dims_ref->orig_dims);
+
+    void *opts_ref = ocp_qp_xcond_solver_opts_create(config_ref, qp_dims_ref);
+    config_ref->opts_set(config_ref, opts_ref, "cond_N", &N);
+    ocp_qp_solver *solver_ref = ocp_qp_create(config_ref, qp_dims_ref, opts_ref);
+    REQUIRE(ocp_qp_solve(solver_ref, qp_in, qp_out_ref) == 0);
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_PARTITIONED_IPM;
+
+    for (int num_segments : num_segments_values)
+    {
+        SECTION("num_segments = " + std::to_string(num_segments))
+        {
+            ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+            ocp_qp_xcond_solver_dims *qp_dims = create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+            ocp_qp_dims *dims = qp_dims->orig_dims;
+
+            ocp_qp_out *qp_out = ocp_qp_out_create(dims);
+
+            void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            config->opts_set(config, opts, "cond_N", &N);
+            config->opts_set(config, opts, "num_segments", &num_segments);
+            config->opts_set(config, opts, "tol_stat", &tol_stat);
+            ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+            REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+
+            ocp_qp_inf_norm_residuals(dims, qp_in, qp_out, res);
+
+            max_res = 0.0;
+            for (int ii = 0; ii < 4; ii++)
+                max_res = (res[ii] > max_res) ? res[ii] : max_res;
+
+            printf("\npartitioned ipm, num_segments = %d, inf norm res: %e, %e, %e, %e\n",
+                   num_segments, res[0], res[1], res[2], res[3]);
+            REQUIRE(max_res <= 1e-8);
+
+            // same solution as hpipm
+            double max_err = 0.0;
+            for (int ii = 0; ii <= N; ii++)
+            {
+                for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii]; jj++)
+                {
+                    double err = fabs(BLASFEO_DVECEL(qp_out->ux + ii, jj) -
+                                      BLASFEO_DVECEL(qp_out_ref->ux + ii, jj));
+                    max_err = (err > max_err) ? err : max_err;
+                }
+            }
+            REQUIRE(max_err <= 1e-6);
+
+            free(solver);
+            free(opts);
+            free(qp_out);
+            free(qp_dims);
+            free(config);
+        }
+    }
+
+    free(solver_ref);
+    free(opts_ref);
+    free(qp_out_ref);
+    free(qp_in);
+    free(qp_dims_ref);
+    free(config_ref);
+
+}  // END_TEST_CASE
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+
+// external
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdlib.h>
+
+#include "catch/include/catch.hpp"
+
+// acados
+#include "acados/utils/external_function_generic.h"
+
+#include "acados_c/external_function_interface.h"
+
+// pendulum_model
+#include "examples/c/pendulum_model/pendulum_model.h"
+
+// bytecode translation of pendulum_ode_impl_ode_fun_jac_x_xdot_z, copied next to unit_tests
+static const char *BYTECODE_FILE = "pendulum_ode_impl_ode_fun_jac_x_xdot_z.bytecode";
+
+
+
+// writes the bytecode file with the sparsity line of its (sparse) jac_x output replaced
+static std::string write_modified_bytecode(const std::string &name, const std::string &jac_x_sp)
+{
+    std::ifstream in(BYTECODE_FILE);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line))
+        lines.push_back(line);
+    REQUIRE(lines.size() > 6);
+
+    // header, 4 input and 1 output sparsity before the jac_x sparsity
+    lines[6] = jac_x_sp;
+
+    std::ofstream out(name);
+    for (size_t ii = 0; ii < lines.size(); ii++)
+        out << lines[ii] << "\n";
+    return name;
+}
+
+
+
+TEST_CASE("pendulum bytecode vs casadi", "[external_function]")
+{
+    const int nx = 4;
+    const int nu = 1;
+
+    external_function_casadi impl_ode_fun_jac_x_xdot_z;
+    impl_ode_fun_jac_x_xdot_z.casadi_fun = &pendulum_ode_impl_ode_fun_jac_x_xdot_z;
+    impl_ode_fun_jac_x_xdot_z.casadi_work = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_work;
+    impl_ode_fun_jac_x_xdot_z.casadi_sparsity_in = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_sparsity_in;
+    impl_ode_fun_jac_x_xdot_z.casadi_sparsity_out = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_sparsity_out;
+    impl_ode_fun_jac_x_xdot_z.casadi_n_in = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_n_in;
+    impl_ode_fun_jac_x_xdot_z.casadi_n_out = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_n_out;
+    external_function_casadi_create(&impl_ode_fun_jac_x_xdot_z);
+
+    external_function_bytecode impl_ode_bytecode;
+
+    SECTION("same outputs")
+    {
+        REQUIRE(external_function_bytecode_create_from_file(&impl_ode_bytecode, BYTECODE_FILE) == 0);
+
+        ext_fun_arg_t type_in[4] = {COLMAJ, COLMAJ, COLMAJ, COLMAJ};
+        ext_fun_arg_t type_out[4] = {COLMAJ, COLMAJ, COLMAJ, COLMAJ};
+
+        double x[nx], xdot[nx], u[nu], z[1];
+        // outputs of the casadi function (0) and of the bytecode (1)
+        double fun[2][nx], jac_x[2][nx*nx], jac_xdot[2][nx*nx], jac_z[2][1];
+
+        srand(1);
+        for (int kk = 0; kk < 10; kk++)
+        {
+            for (int ii = 0; ii < nx; ii++)
+            {
+                x[ii] = rand() / (double) RAND_MAX - 0.5;
+                xdot[ii] = rand() / (double) RAND_MAX - 0.5;
+            }
+            u[0] = rand() / (double) RAND_MAX - 0.5;
+
+            void *in[4] = {x, xdot, u, z};
+            for (int jj = 0; jj < 2; jj++)
+            {
+                // structural zeros are not written
+                for (int ii = 0; ii < nx*nx; ii++)
+                {
+                    jac_x[jj][ii] = 0.0;
+                    jac_xdot[jj][ii] = 0.0;
+                }
+                void *out[4] = {fun[jj], jac_x[jj], jac_xdot[jj], jac_z[jj]};
+                if (jj == 0)
+                    impl_ode_fun_jac_x_xdot_z.evaluate(&impl_ode_fun_jac_x_xdot_z, type_in, in,
+                                                       type_out, out);
+                else
+                    impl_ode_bytecode.evaluate(&impl_ode_bytecode, type_in, in, type_out, out);
+            }
+
+            for (int ii = 0; ii < nx; ii++)
+                REQUIRE(fabs(fun[0][ii] - fun[1][ii]) <= 1e-12);
+            for (int ii = 0; ii < nx*nx; ii++)
+            {
+                REQUIRE(fabs(jac_x[0][ii] - jac_x[1][ii]) <= 1e-12);
+                REQUIRE(fabs(jac_xdot[0][ii] - jac_xdot[1][ii]) <= 1e-12);
+            }
+        }
+
+        external_function_bytecode_free(&impl_ode_bytecode);
+    }
+
+    SECTION("malformed sparsity")
+    {
+        // colind[0] != 0
+        std::string file = write_modified_bytecode("bytecode_bad_colind0.bytecode",
+                                                   "13 4 4 1 1 1 3 6 0 1 3 1 2 3");
+        REQUIRE(external_function_bytecode_create_from_file(&impl_ode_bytecode, file.c_str()) != 0);
+
+        // decreasing colind
+        file = write_modified_bytecode("bytecode_bad_colind.bytecode",
+                                       "13 4 4 0 0 3 1 6 0 1 3 1 2 3");
+        REQUIRE(external_function_bytecode_create_from_file(&impl_ode_bytecode, file.c_str()) != 0);
+
+        // row index >= nrow
+        file = write_modified_bytecode("bytecode_bad_row.bytecode",
+                                       "13 4 4 0 0 1 3 6 0 1 4 1 2 3");
+        REQUIRE(external_function_bytecode_create_from_file(&impl_ode_bytecode, file.c_str()) != 0);
+    }
+
+    external_function_casadi_free(&impl_ode_fun_jac_x_xdot_z);
+}
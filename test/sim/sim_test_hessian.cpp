@@ -861,3 +861,170 @@ TEST_CASE("pendulum model hessians - Finite Differences", "compare against finit
     free(out);
     free(sim_solver);
 }
+
+
+
+TEST_CASE("pendulum ERK hessian accumulation", "[integrators]")
+{
+    for (int ii = 0; ii < nx; ii++)
+        x0_pendulum[ii] = 0.0;
+
+    u_sim_pendulum[0] = 0.1;
+
+    double T = 0.1;  // simulation time
+
+/************************************************
+* external functions
+************************************************/
+    /* EXPLICIT MODEL */
+    // expl_ode_fun
+    external_function_casadi expl_ode_fun;
+    expl_ode_fun.casadi_fun = &pendulum_ode_expl_ode_fun;
+    expl_ode_fun.casadi_work = &pendulum_ode_expl_ode_fun_work;
+    expl_ode_fun.casadi_sparsity_in = &pendulum_ode_expl_ode_fun_sparsity_in;
+    expl_ode_fun.casadi_sparsity_out = &pendulum_ode_expl_ode_fun_sparsity_out;
+    expl_ode_fun.casadi_n_in = &pendulum_ode_expl_ode_fun_n_in;
+    expl_ode_fun.casadi_n_out = &pendulum_ode_expl_ode_fun_n_out;
+    external_function_casadi_create(&expl_ode_fun);
+
+    // expl_vde_for
+    external_function_casadi expl_vde_for;
+    expl_vde_for.casadi_fun = &pendulum_ode_expl_vde_forw;
+    expl_vde_for.casadi_work = &pendulum_ode_expl_vde_forw_work;
+    expl_vde_for.casadi_sparsity_in = &pendulum_ode_expl_vde_forw_sparsity_in;
+    expl_vde_for.casadi_sparsity_out = &pendulum_ode_expl_vde_forw_sparsity_out;
+    expl_vde_for.casadi_n_in = &pendulum_ode_expl_vde_forw_n_in;
+    expl_vde_for.casadi_n_out = &pendulum_ode_expl_vde_forw_n_out;
+    external_function_casadi_create(&expl_vde_for);
+
+    // expl_vde_adj
+    external_function_casadi expl_vde_adj;
+    expl_vde_adj.casadi_fun = &pendulum_ode_expl_vde_adj;
+    expl_vde_adj.casadi_work = &pendulum_ode_expl_vde_adj_work;
+    expl_vde_adj.casadi_sparsity_in = &pendulum_ode_expl_vde_adj_sparsity_in;
+    expl_vde_adj.casadi_sparsity_out = &pendulum_ode_expl_vde_adj_sparsity_out;
+    expl_vde_adj.casadi_n_in = &pendulum_ode_expl_vde_adj_n_in;
+    expl_vde_adj.casadi_n_out = &pendulum_ode_expl_vde_adj_n_out;
+    external_function_casadi_create(&expl_vde_adj);
+
+    // expl_ode_hess
+    external_function_casadi expl_ode_hess;
+    expl_ode_hess.casadi_fun = &pendulum_ode_expl_ode_hess;
+    expl_ode_hess.casadi_work = &pendulum_ode_expl_ode_hess_work;
+    expl_ode_hess.casadi_sparsity_in = &pendulum_ode_expl_ode_hess_sparsity_in;
+    expl_ode_hess.casadi_sparsity_out = &pendulum_ode_expl_ode_hess_sparsity_out;
+    expl_ode_hess.casadi_n_in = &pendulum_ode_expl_ode_hess_n_in;
+    expl_ode_hess.casadi_n_out = &pendulum_ode_expl_ode_hess_n_out;
+    external_function_casadi_create(&expl_ode_hess);
+
+/************************************************
+* ERK solver
+************************************************/
+    sim_solver_plan plan;
+    plan.sim_solver = ERK;
+
+    sim_config *config = sim_config_create(plan);
+    REQUIRE(config->hess_acc);
+
+    void *dims = sim_dims_create(config);
+    sim_dims_set(config, dims, "nx", &nx);
+    sim_dims_set(config, dims, "nu", &nu);
+    sim_dims_set(config, dims, "nz", &nz);
+
+    void *opts_ = sim_opts_create(config, dims);
+    sim_opts *opts = (sim_opts *) opts_;
+    config->opts_initialize_default(config, dims, opts);
+
+    opts->ns        = 4;
+    opts->num_steps = 4;
+    opts->sens_forw = true;
+    opts->sens_adj  = true;
+    opts->sens_hess = true;
+
+    sim_in *in = sim_in_create(config, dims);
+    sim_out *out = sim_out_create(config, dims);
+
+    in->T = T;
+
+    sim_in_set(config, dims, in, "expl_ode_fun", &expl_ode_fun);
+    sim_in_set(config, dims, in, "expl_vde_for", &expl_vde_for);
+    sim_in_set(config, dims, in, "expl_vde_adj", &expl_vde_adj);
+    sim_in_set(config, dims, in, "expl_ode_hess", &expl_ode_hess);
+
+    sim_solver *sim_solver = sim_solver_create(config, dims, opts);
+
+    // seeds forw
+    for (int ii = 0; ii < nx * NF; ii++)
+        in->S_forw[ii] = 0.0;
+    for (int ii = 0; ii < nx; ii++)
+        in->S_forw[ii * (nx + 1)] = 1.0;
+
+    // seeds adj
+    for (int ii = 0; ii < nx; ii++)
+        in->S_adj[ii] = 1.0;
+    for (int ii = nx; ii < nx + nu; ii++)
+        in->S_adj[ii] = 0.0;
+
+    for (int jj = 0; jj < nx; jj++)
+        in->x[jj] = x0_pendulum[jj];
+    for (int jj = 0; jj < nu; jj++)
+        in->u[jj] = u_sim_pendulum[jj];
+
+    // hessian in (x, u) ordering in S_hess
+    acados_return = sim_solve(sim_solver, in, out);
+    REQUIRE(acados_return == 0);
+
+    for (int jj = 0; jj < NF * NF; jj++)
+        S_hess_ref_sol[jj] = out->S_hess[jj];
+
+    // hessian added to a blasfeo matrix in (u, x) ordering, as the ocp_nlp hessian blocks
+    struct blasfeo_dmat hess_acc;
+    blasfeo_allocate_dmat(nu + nx, nu + nx, &hess_acc);
+    blasfeo_dgese(nu + nx, nu + nx, 0.0, &hess_acc, 0, 0);
+    blasfeo_ddiare(nu + nx, 1.0, &hess_acc, 0, 0);
+
+    sim_solver_set(sim_solver, "hess_acc", &hess_acc);
+    acados_return = sim_solve(sim_solver, in, out);
+    REQUIRE(acados_return == 0);
+    sim_solver_set(sim_solver, "hess_acc", NULL);
+
+    double max_error = 0.0;
+    for (int j = 0; j < nx + nu; j++)
+    {
+        int jj = j < nx ? nu + j : j - nx;
+        for (int i = 0; i < nx + nu; i++)
+        {
+            int ii = i < nx ? nu + i : i - nx;
+            double ref = S_hess_ref_sol[i + j * (nx + nu)] + (ii == jj ? 1.0 : 0.0);
+            double err = fabs(BLASFEO_DMATEL(&hess_acc, ii, jj) - ref);
+            max_error = err > max_error ? err : max_error;
+        }
+    }
+
+    if ( PRINT_HESS_RESULTS )
+    {
+        printf("\nERK S_hess =\n");
+        d_print_exp_mat(nx + nu, nx + nu, S_hess_ref_sol, nx + nu);
+        printf("\nERK hess_acc - I =\n");
+        blasfeo_print_exp_dmat(nu + nx, nu + nx, &hess_acc, 0, 0);
+    }
+
+    REQUIRE(max_error < 1e-12);
+
+    blasfeo_free_dmat(&hess_acc);
+
+    // explicit model
+    external_function_casadi_free(&expl_ode_fun);
+    external_function_casadi_free(&expl_vde_for);
+    external_function_casadi_free(&expl_vde_adj);
+    external_function_casadi_free(&expl_ode_hess);
+
+    // free solver
+    free(config);
+    free(dims);
+    free(opts);
+
+    free(in);
+    free(out);
+    free(sim_solver);
+}